@@ -0,0 +1,111 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/miniconda/lib/cmake/GTest/GTestConfig.cmake"
+  "/root/miniconda/lib/cmake/GTest/GTestConfigVersion.cmake"
+  "/root/miniconda/lib/cmake/GTest/GTestTargets-release.cmake"
+  "/root/miniconda/lib/cmake/GTest/GTestTargets.cmake"
+  "/root/miniconda/lib/cmake/yaml-cpp/yaml-cpp-config-version.cmake"
+  "/root/miniconda/lib/cmake/yaml-cpp/yaml-cpp-config.cmake"
+  "/root/miniconda/lib/cmake/yaml-cpp/yaml-cpp-targets-release.cmake"
+  "/root/miniconda/lib/cmake/yaml-cpp/yaml-cpp-targets.cmake"
+  "/root/repo/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeFindDependencyMacro.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCXXSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFileCXX.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/FindGTest.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/GoogleTest.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "CMakeFiles/router_dataplane.dir/DependInfo.cmake"
+  "CMakeFiles/router_analytics_mock.dir/DependInfo.cmake"
+  "CMakeFiles/router_config.dir/DependInfo.cmake"
+  "CMakeFiles/router_simple.dir/DependInfo.cmake"
+  "CMakeFiles/fib_bench.dir/DependInfo.cmake"
+  "CMakeFiles/burst_bench.dir/DependInfo.cmake"
+  "CMakeFiles/token_bucket_bench.dir/DependInfo.cmake"
+  "CMakeFiles/wfq_bench.dir/DependInfo.cmake"
+  "CMakeFiles/drr_bench.dir/DependInfo.cmake"
+  "CMakeFiles/htb_bench.dir/DependInfo.cmake"
+  "CMakeFiles/release_latency_bench.dir/DependInfo.cmake"
+  "CMakeFiles/netem_bench.dir/DependInfo.cmake"
+  "CMakeFiles/netlink_bench.dir/DependInfo.cmake"
+  "CMakeFiles/pcap_reader_bench.dir/DependInfo.cmake"
+  "CMakeFiles/pcap_diff_bench.dir/DependInfo.cmake"
+  "CMakeFiles/pcap_diff_parallel_bench.dir/DependInfo.cmake"
+  "CMakeFiles/pcap_tap_bench.dir/DependInfo.cmake"
+  "CMakeFiles/clickhouse_insert_bench.dir/DependInfo.cmake"
+  "CMakeFiles/clickhouse_flush_latency_bench.dir/DependInfo.cmake"
+  "CMakeFiles/clickhouse_journal_bench.dir/DependInfo.cmake"
+  "CMakeFiles/flow_cache_bench.dir/DependInfo.cmake"
+  "CMakeFiles/metric_rollup_bench.dir/DependInfo.cmake"
+  "CMakeFiles/bgp_session_bench.dir/DependInfo.cmake"
+  "CMakeFiles/bgp_update_bench.dir/DependInfo.cmake"
+  "CMakeFiles/bgp_attribute_store_bench.dir/DependInfo.cmake"
+  "CMakeFiles/bgp_rib_bench.dir/DependInfo.cmake"
+  "CMakeFiles/bgp_update_group_bench.dir/DependInfo.cmake"
+  "CMakeFiles/test_fib.dir/DependInfo.cmake"
+  "CMakeFiles/test_packet_descriptor.dir/DependInfo.cmake"
+  "CMakeFiles/test_wfq.dir/DependInfo.cmake"
+  "CMakeFiles/test_wfq_scheduler.dir/DependInfo.cmake"
+  "CMakeFiles/test_drr.dir/DependInfo.cmake"
+  "CMakeFiles/test_htb.dir/DependInfo.cmake"
+  "CMakeFiles/test_timer_wheel.dir/DependInfo.cmake"
+  "CMakeFiles/test_event_loop.dir/DependInfo.cmake"
+  "CMakeFiles/test_bgp_session.dir/DependInfo.cmake"
+  "CMakeFiles/test_bgp_update.dir/DependInfo.cmake"
+  "CMakeFiles/test_bgp_attributes.dir/DependInfo.cmake"
+  "CMakeFiles/test_bgp_rib.dir/DependInfo.cmake"
+  "CMakeFiles/test_netem.dir/DependInfo.cmake"
+  "CMakeFiles/test_netlink.dir/DependInfo.cmake"
+  "CMakeFiles/test_pcap_reader.dir/DependInfo.cmake"
+  "CMakeFiles/test_pcap_diff.dir/DependInfo.cmake"
+  "CMakeFiles/test_pcap_tap.dir/DependInfo.cmake"
+  "CMakeFiles/test_segment_journal.dir/DependInfo.cmake"
+  "CMakeFiles/test_flow_cache.dir/DependInfo.cmake"
+  "CMakeFiles/test_sketches.dir/DependInfo.cmake"
+  "CMakeFiles/test_metric_rollup.dir/DependInfo.cmake"
+  "CMakeFiles/test_yaml_config.dir/DependInfo.cmake"
+  "CMakeFiles/test_clickhouse_client.dir/DependInfo.cmake"
+  "CMakeFiles/bgp_update_fuzz.dir/DependInfo.cmake"
+  )
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bgp_attribute_store_bench.dir/benchmarks/bgp_attribute_store_bench.cpp.o"
+  "CMakeFiles/bgp_attribute_store_bench.dir/benchmarks/bgp_attribute_store_bench.cpp.o.d"
+  "bgp_attribute_store_bench"
+  "bgp_attribute_store_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bgp_attribute_store_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
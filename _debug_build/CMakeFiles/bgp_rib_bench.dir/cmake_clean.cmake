@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bgp_rib_bench.dir/benchmarks/bgp_rib_bench.cpp.o"
+  "CMakeFiles/bgp_rib_bench.dir/benchmarks/bgp_rib_bench.cpp.o.d"
+  "bgp_rib_bench"
+  "bgp_rib_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bgp_rib_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
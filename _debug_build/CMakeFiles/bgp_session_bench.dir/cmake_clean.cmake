@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bgp_session_bench.dir/benchmarks/bgp_session_bench.cpp.o"
+  "CMakeFiles/bgp_session_bench.dir/benchmarks/bgp_session_bench.cpp.o.d"
+  "bgp_session_bench"
+  "bgp_session_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bgp_session_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
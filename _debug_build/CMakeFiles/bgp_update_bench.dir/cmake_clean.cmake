@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bgp_update_bench.dir/benchmarks/bgp_update_bench.cpp.o"
+  "CMakeFiles/bgp_update_bench.dir/benchmarks/bgp_update_bench.cpp.o.d"
+  "bgp_update_bench"
+  "bgp_update_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bgp_update_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/fuzz/bgp_update_fuzz.cpp" "CMakeFiles/bgp_update_fuzz.dir/fuzz/bgp_update_fuzz.cpp.o" "gcc" "CMakeFiles/bgp_update_fuzz.dir/fuzz/bgp_update_fuzz.cpp.o.d"
+  "/root/repo/fuzz/fuzz_main.cpp" "CMakeFiles/bgp_update_fuzz.dir/fuzz/fuzz_main.cpp.o" "gcc" "CMakeFiles/bgp_update_fuzz.dir/fuzz/fuzz_main.cpp.o.d"
+  "/root/repo/src/protocols/bgp_update.cpp" "CMakeFiles/bgp_update_fuzz.dir/src/protocols/bgp_update.cpp.o" "gcc" "CMakeFiles/bgp_update_fuzz.dir/src/protocols/bgp_update.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
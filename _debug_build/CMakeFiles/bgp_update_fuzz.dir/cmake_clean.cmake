@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bgp_update_fuzz.dir/fuzz/bgp_update_fuzz.cpp.o"
+  "CMakeFiles/bgp_update_fuzz.dir/fuzz/bgp_update_fuzz.cpp.o.d"
+  "CMakeFiles/bgp_update_fuzz.dir/fuzz/fuzz_main.cpp.o"
+  "CMakeFiles/bgp_update_fuzz.dir/fuzz/fuzz_main.cpp.o.d"
+  "CMakeFiles/bgp_update_fuzz.dir/src/protocols/bgp_update.cpp.o"
+  "CMakeFiles/bgp_update_fuzz.dir/src/protocols/bgp_update.cpp.o.d"
+  "bgp_update_fuzz"
+  "bgp_update_fuzz.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bgp_update_fuzz.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/burst_bench.dir/benchmarks/burst_bench.cpp.o"
+  "CMakeFiles/burst_bench.dir/benchmarks/burst_bench.cpp.o.d"
+  "burst_bench"
+  "burst_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/burst_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/clickhouse_flush_latency_bench.dir/benchmarks/clickhouse_flush_latency_bench.cpp.o"
+  "CMakeFiles/clickhouse_flush_latency_bench.dir/benchmarks/clickhouse_flush_latency_bench.cpp.o.d"
+  "clickhouse_flush_latency_bench"
+  "clickhouse_flush_latency_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/clickhouse_flush_latency_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/clickhouse_insert_bench.dir/benchmarks/clickhouse_insert_bench.cpp.o"
+  "CMakeFiles/clickhouse_insert_bench.dir/benchmarks/clickhouse_insert_bench.cpp.o.d"
+  "clickhouse_insert_bench"
+  "clickhouse_insert_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/clickhouse_insert_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/clickhouse_journal_bench.dir/benchmarks/clickhouse_journal_bench.cpp.o"
+  "CMakeFiles/clickhouse_journal_bench.dir/benchmarks/clickhouse_journal_bench.cpp.o.d"
+  "clickhouse_journal_bench"
+  "clickhouse_journal_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/clickhouse_journal_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
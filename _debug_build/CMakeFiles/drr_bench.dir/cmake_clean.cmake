@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/drr_bench.dir/benchmarks/drr_bench.cpp.o"
+  "CMakeFiles/drr_bench.dir/benchmarks/drr_bench.cpp.o.d"
+  "drr_bench"
+  "drr_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/drr_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
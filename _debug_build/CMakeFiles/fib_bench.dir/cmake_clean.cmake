@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/fib_bench.dir/benchmarks/fib_bench.cpp.o"
+  "CMakeFiles/fib_bench.dir/benchmarks/fib_bench.cpp.o.d"
+  "fib_bench"
+  "fib_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/fib_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/flow_cache_bench.dir/benchmarks/flow_cache_bench.cpp.o"
+  "CMakeFiles/flow_cache_bench.dir/benchmarks/flow_cache_bench.cpp.o.d"
+  "flow_cache_bench"
+  "flow_cache_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/flow_cache_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/htb_bench.dir/benchmarks/htb_bench.cpp.o"
+  "CMakeFiles/htb_bench.dir/benchmarks/htb_bench.cpp.o.d"
+  "htb_bench"
+  "htb_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/htb_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
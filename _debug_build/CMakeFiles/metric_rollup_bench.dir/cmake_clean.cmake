@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/metric_rollup_bench.dir/benchmarks/metric_rollup_bench.cpp.o"
+  "CMakeFiles/metric_rollup_bench.dir/benchmarks/metric_rollup_bench.cpp.o.d"
+  "metric_rollup_bench"
+  "metric_rollup_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/metric_rollup_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
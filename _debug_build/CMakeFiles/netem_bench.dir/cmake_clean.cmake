@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/netem_bench.dir/benchmarks/netem_bench.cpp.o"
+  "CMakeFiles/netem_bench.dir/benchmarks/netem_bench.cpp.o.d"
+  "netem_bench"
+  "netem_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/netem_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
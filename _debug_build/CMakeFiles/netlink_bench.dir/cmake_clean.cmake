@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/netlink_bench.dir/benchmarks/netlink_bench.cpp.o"
+  "CMakeFiles/netlink_bench.dir/benchmarks/netlink_bench.cpp.o.d"
+  "netlink_bench"
+  "netlink_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/netlink_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/pcap_diff_bench.dir/benchmarks/pcap_diff_bench.cpp.o"
+  "CMakeFiles/pcap_diff_bench.dir/benchmarks/pcap_diff_bench.cpp.o.d"
+  "pcap_diff_bench"
+  "pcap_diff_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/pcap_diff_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
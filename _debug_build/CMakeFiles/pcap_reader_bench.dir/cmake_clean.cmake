@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/pcap_reader_bench.dir/benchmarks/pcap_reader_bench.cpp.o"
+  "CMakeFiles/pcap_reader_bench.dir/benchmarks/pcap_reader_bench.cpp.o.d"
+  "pcap_reader_bench"
+  "pcap_reader_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/pcap_reader_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/pcap_tap_bench.dir/benchmarks/pcap_tap_bench.cpp.o"
+  "CMakeFiles/pcap_tap_bench.dir/benchmarks/pcap_tap_bench.cpp.o.d"
+  "pcap_tap_bench"
+  "pcap_tap_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/pcap_tap_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/release_latency_bench.dir/benchmarks/release_latency_bench.cpp.o"
+  "CMakeFiles/release_latency_bench.dir/benchmarks/release_latency_bench.cpp.o.d"
+  "release_latency_bench"
+  "release_latency_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/release_latency_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/router_analytics_mock.dir/src/analytics/clickhouse_client.cpp.o"
+  "CMakeFiles/router_analytics_mock.dir/src/analytics/clickhouse_client.cpp.o.d"
+  "librouter_analytics_mock.a"
+  "librouter_analytics_mock.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/router_analytics_mock.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
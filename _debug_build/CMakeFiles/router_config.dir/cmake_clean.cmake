@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/router_config.dir/src/config/yaml_config.cpp.o"
+  "CMakeFiles/router_config.dir/src/config/yaml_config.cpp.o.d"
+  "librouter_config.a"
+  "librouter_config.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/router_config.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
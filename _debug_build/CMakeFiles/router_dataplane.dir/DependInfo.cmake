@@ -0,0 +1,43 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/analytics/flow_cache.cpp" "CMakeFiles/router_dataplane.dir/src/analytics/flow_cache.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/analytics/flow_cache.cpp.o.d"
+  "/root/repo/src/analytics/metric_rollup.cpp" "CMakeFiles/router_dataplane.dir/src/analytics/metric_rollup.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/analytics/metric_rollup.cpp.o.d"
+  "/root/repo/src/analytics/segment_journal.cpp" "CMakeFiles/router_dataplane.dir/src/analytics/segment_journal.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/analytics/segment_journal.cpp.o.d"
+  "/root/repo/src/analytics/sketches.cpp" "CMakeFiles/router_dataplane.dir/src/analytics/sketches.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/analytics/sketches.cpp.o.d"
+  "/root/repo/src/event_loop.cpp" "CMakeFiles/router_dataplane.dir/src/event_loop.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/event_loop.cpp.o.d"
+  "/root/repo/src/netem/emulator.cpp" "CMakeFiles/router_dataplane.dir/src/netem/emulator.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/netem/emulator.cpp.o.d"
+  "/root/repo/src/netem/impairments.cpp" "CMakeFiles/router_dataplane.dir/src/netem/impairments.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/netem/impairments.cpp.o.d"
+  "/root/repo/src/netem/netlink.cpp" "CMakeFiles/router_dataplane.dir/src/netem/netlink.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/netem/netlink.cpp.o.d"
+  "/root/repo/src/network_impairments.cpp" "CMakeFiles/router_dataplane.dir/src/network_impairments.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/network_impairments.cpp.o.d"
+  "/root/repo/src/packet_descriptor.cpp" "CMakeFiles/router_dataplane.dir/src/packet_descriptor.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/packet_descriptor.cpp.o.d"
+  "/root/repo/src/protocols/bgp.cpp" "CMakeFiles/router_dataplane.dir/src/protocols/bgp.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/protocols/bgp.cpp.o.d"
+  "/root/repo/src/protocols/bgp_attributes.cpp" "CMakeFiles/router_dataplane.dir/src/protocols/bgp_attributes.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/protocols/bgp_attributes.cpp.o.d"
+  "/root/repo/src/protocols/bgp_rib.cpp" "CMakeFiles/router_dataplane.dir/src/protocols/bgp_rib.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/protocols/bgp_rib.cpp.o.d"
+  "/root/repo/src/protocols/bgp_session.cpp" "CMakeFiles/router_dataplane.dir/src/protocols/bgp_session.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/protocols/bgp_session.cpp.o.d"
+  "/root/repo/src/protocols/bgp_update.cpp" "CMakeFiles/router_dataplane.dir/src/protocols/bgp_update.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/protocols/bgp_update.cpp.o.d"
+  "/root/repo/src/routing/fib.cpp" "CMakeFiles/router_dataplane.dir/src/routing/fib.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/routing/fib.cpp.o.d"
+  "/root/repo/src/testing/flow_aligner.cpp" "CMakeFiles/router_dataplane.dir/src/testing/flow_aligner.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/testing/flow_aligner.cpp.o.d"
+  "/root/repo/src/testing/pcap_diff.cpp" "CMakeFiles/router_dataplane.dir/src/testing/pcap_diff.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/testing/pcap_diff.cpp.o.d"
+  "/root/repo/src/testing/pcap_reader.cpp" "CMakeFiles/router_dataplane.dir/src/testing/pcap_reader.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/testing/pcap_reader.cpp.o.d"
+  "/root/repo/src/testing/pcap_tap.cpp" "CMakeFiles/router_dataplane.dir/src/testing/pcap_tap.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/testing/pcap_tap.cpp.o.d"
+  "/root/repo/src/timer_wheel.cpp" "CMakeFiles/router_dataplane.dir/src/timer_wheel.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/timer_wheel.cpp.o.d"
+  "/root/repo/src/traffic_shaping/drr.cpp" "CMakeFiles/router_dataplane.dir/src/traffic_shaping/drr.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/traffic_shaping/drr.cpp.o.d"
+  "/root/repo/src/traffic_shaping/htb.cpp" "CMakeFiles/router_dataplane.dir/src/traffic_shaping/htb.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/traffic_shaping/htb.cpp.o.d"
+  "/root/repo/src/traffic_shaping/wfq.cpp" "CMakeFiles/router_dataplane.dir/src/traffic_shaping/wfq.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/traffic_shaping/wfq.cpp.o.d"
+  "/root/repo/src/traffic_shaping_simple.cpp" "CMakeFiles/router_dataplane.dir/src/traffic_shaping_simple.cpp.o" "gcc" "CMakeFiles/router_dataplane.dir/src/traffic_shaping_simple.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,59 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/router_dataplane.dir/src/analytics/flow_cache.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/analytics/flow_cache.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/analytics/metric_rollup.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/analytics/metric_rollup.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/analytics/segment_journal.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/analytics/segment_journal.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/analytics/sketches.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/analytics/sketches.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/event_loop.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/event_loop.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/netem/emulator.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/netem/emulator.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/netem/impairments.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/netem/impairments.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/netem/netlink.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/netem/netlink.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/network_impairments.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/network_impairments.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/packet_descriptor.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/packet_descriptor.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/protocols/bgp.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/protocols/bgp.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/protocols/bgp_attributes.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/protocols/bgp_attributes.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/protocols/bgp_rib.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/protocols/bgp_rib.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/protocols/bgp_session.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/protocols/bgp_session.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/protocols/bgp_update.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/protocols/bgp_update.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/routing/fib.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/routing/fib.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/testing/flow_aligner.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/testing/flow_aligner.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/testing/pcap_diff.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/testing/pcap_diff.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/testing/pcap_reader.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/testing/pcap_reader.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/testing/pcap_tap.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/testing/pcap_tap.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/timer_wheel.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/timer_wheel.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/traffic_shaping/drr.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/traffic_shaping/drr.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/traffic_shaping/htb.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/traffic_shaping/htb.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/traffic_shaping/wfq.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/traffic_shaping/wfq.cpp.o.d"
+  "CMakeFiles/router_dataplane.dir/src/traffic_shaping_simple.cpp.o"
+  "CMakeFiles/router_dataplane.dir/src/traffic_shaping_simple.cpp.o.d"
+  "librouter_dataplane.a"
+  "librouter_dataplane.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/router_dataplane.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/router_simple.dir/src/router_simple.cpp.o"
+  "CMakeFiles/router_simple.dir/src/router_simple.cpp.o.d"
+  "router_simple"
+  "router_simple.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/router_simple.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_bgp_attributes.dir/tests/test_bgp_attributes.cpp.o"
+  "CMakeFiles/test_bgp_attributes.dir/tests/test_bgp_attributes.cpp.o.d"
+  "test_bgp_attributes"
+  "test_bgp_attributes.pdb"
+  "test_bgp_attributes[1]_tests.cmake"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_bgp_attributes.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_bgp_session.dir/tests/test_bgp_session.cpp.o"
+  "CMakeFiles/test_bgp_session.dir/tests/test_bgp_session.cpp.o.d"
+  "test_bgp_session"
+  "test_bgp_session.pdb"
+  "test_bgp_session[1]_tests.cmake"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_bgp_session.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
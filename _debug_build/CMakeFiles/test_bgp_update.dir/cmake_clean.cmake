@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_bgp_update.dir/tests/test_bgp_update.cpp.o"
+  "CMakeFiles/test_bgp_update.dir/tests/test_bgp_update.cpp.o.d"
+  "test_bgp_update"
+  "test_bgp_update.pdb"
+  "test_bgp_update[1]_tests.cmake"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_bgp_update.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_clickhouse_client.dir/tests/test_clickhouse_client.cpp.o"
+  "CMakeFiles/test_clickhouse_client.dir/tests/test_clickhouse_client.cpp.o.d"
+  "test_clickhouse_client"
+  "test_clickhouse_client.pdb"
+  "test_clickhouse_client[1]_tests.cmake"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_clickhouse_client.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_flow_cache.dir/tests/test_flow_cache.cpp.o"
+  "CMakeFiles/test_flow_cache.dir/tests/test_flow_cache.cpp.o.d"
+  "test_flow_cache"
+  "test_flow_cache.pdb"
+  "test_flow_cache[1]_tests.cmake"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_flow_cache.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
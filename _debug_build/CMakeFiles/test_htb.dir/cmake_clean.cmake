@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_htb.dir/tests/test_htb.cpp.o"
+  "CMakeFiles/test_htb.dir/tests/test_htb.cpp.o.d"
+  "test_htb"
+  "test_htb.pdb"
+  "test_htb[1]_tests.cmake"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_htb.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
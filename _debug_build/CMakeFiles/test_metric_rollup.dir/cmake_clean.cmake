@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_metric_rollup.dir/tests/test_metric_rollup.cpp.o"
+  "CMakeFiles/test_metric_rollup.dir/tests/test_metric_rollup.cpp.o.d"
+  "test_metric_rollup"
+  "test_metric_rollup.pdb"
+  "test_metric_rollup[1]_tests.cmake"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_metric_rollup.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_netem.dir/tests/test_netem.cpp.o"
+  "CMakeFiles/test_netem.dir/tests/test_netem.cpp.o.d"
+  "test_netem"
+  "test_netem.pdb"
+  "test_netem[1]_tests.cmake"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_netem.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_netlink.dir/tests/test_netlink.cpp.o"
+  "CMakeFiles/test_netlink.dir/tests/test_netlink.cpp.o.d"
+  "test_netlink"
+  "test_netlink.pdb"
+  "test_netlink[1]_tests.cmake"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_netlink.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
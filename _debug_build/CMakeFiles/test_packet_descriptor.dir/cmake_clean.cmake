@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_packet_descriptor.dir/tests/test_packet_descriptor.cpp.o"
+  "CMakeFiles/test_packet_descriptor.dir/tests/test_packet_descriptor.cpp.o.d"
+  "test_packet_descriptor"
+  "test_packet_descriptor.pdb"
+  "test_packet_descriptor[1]_tests.cmake"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_packet_descriptor.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
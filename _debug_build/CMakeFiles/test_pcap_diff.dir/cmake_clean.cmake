@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_pcap_diff.dir/tests/test_pcap_diff.cpp.o"
+  "CMakeFiles/test_pcap_diff.dir/tests/test_pcap_diff.cpp.o.d"
+  "test_pcap_diff"
+  "test_pcap_diff.pdb"
+  "test_pcap_diff[1]_tests.cmake"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_pcap_diff.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
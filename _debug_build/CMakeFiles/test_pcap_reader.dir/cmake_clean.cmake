@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_pcap_reader.dir/tests/test_pcap_reader.cpp.o"
+  "CMakeFiles/test_pcap_reader.dir/tests/test_pcap_reader.cpp.o.d"
+  "test_pcap_reader"
+  "test_pcap_reader.pdb"
+  "test_pcap_reader[1]_tests.cmake"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_pcap_reader.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
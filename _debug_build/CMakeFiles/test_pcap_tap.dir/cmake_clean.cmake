@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_pcap_tap.dir/tests/test_pcap_tap.cpp.o"
+  "CMakeFiles/test_pcap_tap.dir/tests/test_pcap_tap.cpp.o.d"
+  "test_pcap_tap"
+  "test_pcap_tap.pdb"
+  "test_pcap_tap[1]_tests.cmake"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_pcap_tap.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
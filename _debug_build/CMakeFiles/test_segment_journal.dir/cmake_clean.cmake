@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_segment_journal.dir/tests/test_segment_journal.cpp.o"
+  "CMakeFiles/test_segment_journal.dir/tests/test_segment_journal.cpp.o.d"
+  "test_segment_journal"
+  "test_segment_journal.pdb"
+  "test_segment_journal[1]_tests.cmake"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_segment_journal.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_wfq_scheduler.dir/tests/test_wfq_scheduler.cpp.o"
+  "CMakeFiles/test_wfq_scheduler.dir/tests/test_wfq_scheduler.cpp.o.d"
+  "test_wfq_scheduler"
+  "test_wfq_scheduler.pdb"
+  "test_wfq_scheduler[1]_tests.cmake"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_wfq_scheduler.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_yaml_config.dir/tests/test_yaml_config.cpp.o"
+  "CMakeFiles/test_yaml_config.dir/tests/test_yaml_config.cpp.o.d"
+  "test_yaml_config"
+  "test_yaml_config.pdb"
+  "test_yaml_config[1]_tests.cmake"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_yaml_config.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/token_bucket_bench.dir/benchmarks/token_bucket_bench.cpp.o"
+  "CMakeFiles/token_bucket_bench.dir/benchmarks/token_bucket_bench.cpp.o.d"
+  "token_bucket_bench"
+  "token_bucket_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/token_bucket_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/wfq_bench.dir/benchmarks/wfq_bench.cpp.o"
+  "CMakeFiles/wfq_bench.dir/benchmarks/wfq_bench.cpp.o.d"
+  "wfq_bench"
+  "wfq_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/wfq_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
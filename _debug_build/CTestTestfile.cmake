@@ -0,0 +1,31 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo
+# Build directory: /root/repo/_debug_build
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+include("/root/repo/_debug_build/test_fib[1]_include.cmake")
+include("/root/repo/_debug_build/test_packet_descriptor[1]_include.cmake")
+include("/root/repo/_debug_build/test_wfq[1]_include.cmake")
+include("/root/repo/_debug_build/test_wfq_scheduler[1]_include.cmake")
+include("/root/repo/_debug_build/test_drr[1]_include.cmake")
+include("/root/repo/_debug_build/test_htb[1]_include.cmake")
+include("/root/repo/_debug_build/test_timer_wheel[1]_include.cmake")
+include("/root/repo/_debug_build/test_event_loop[1]_include.cmake")
+include("/root/repo/_debug_build/test_bgp_session[1]_include.cmake")
+include("/root/repo/_debug_build/test_bgp_update[1]_include.cmake")
+include("/root/repo/_debug_build/test_bgp_attributes[1]_include.cmake")
+include("/root/repo/_debug_build/test_bgp_rib[1]_include.cmake")
+include("/root/repo/_debug_build/test_netem[1]_include.cmake")
+include("/root/repo/_debug_build/test_netlink[1]_include.cmake")
+include("/root/repo/_debug_build/test_pcap_reader[1]_include.cmake")
+include("/root/repo/_debug_build/test_pcap_diff[1]_include.cmake")
+include("/root/repo/_debug_build/test_pcap_tap[1]_include.cmake")
+include("/root/repo/_debug_build/test_segment_journal[1]_include.cmake")
+include("/root/repo/_debug_build/test_flow_cache[1]_include.cmake")
+include("/root/repo/_debug_build/test_sketches[1]_include.cmake")
+include("/root/repo/_debug_build/test_metric_rollup[1]_include.cmake")
+include("/root/repo/_debug_build/test_yaml_config[1]_include.cmake")
+include("/root/repo/_debug_build/test_clickhouse_client[1]_include.cmake")
+add_test(bgp_update_fuzz_smoke "/root/repo/_debug_build/bgp_update_fuzz" "-runs=200000" "/root/repo/fuzz/corpus/bgp_update")
+set_tests_properties(bgp_update_fuzz_smoke PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;299;add_test;/root/repo/CMakeLists.txt;0;")
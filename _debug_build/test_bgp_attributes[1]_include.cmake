@@ -0,0 +1,5 @@
+if(EXISTS "/root/repo/_debug_build/test_bgp_attributes[1]_tests.cmake")
+  include("/root/repo/_debug_build/test_bgp_attributes[1]_tests.cmake")
+else()
+  add_test(test_bgp_attributes_NOT_BUILT test_bgp_attributes_NOT_BUILT)
+endif()
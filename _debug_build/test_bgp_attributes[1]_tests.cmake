@@ -0,0 +1,13 @@
+add_test([=[BGPAttributeStoreTest.EqualAttributesShareOneSet]=]  /root/repo/_debug_build/test_bgp_attributes [==[--gtest_filter=BGPAttributeStoreTest.EqualAttributesShareOneSet]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPAttributeStoreTest.EqualAttributesShareOneSet]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BGPAttributeStoreTest.AbsentMedDiffersFromZeroMed]=]  /root/repo/_debug_build/test_bgp_attributes [==[--gtest_filter=BGPAttributeStoreTest.AbsentMedDiffersFromZeroMed]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPAttributeStoreTest.AbsentMedDiffersFromZeroMed]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BGPAttributeStoreTest.ParsedUpdateInternsToTheSameSet]=]  /root/repo/_debug_build/test_bgp_attributes [==[--gtest_filter=BGPAttributeStoreTest.ParsedUpdateInternsToTheSameSet]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPAttributeStoreTest.ParsedUpdateInternsToTheSameSet]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BGPAttributeStoreTest.LastReferenceFreesTheSet]=]  /root/repo/_debug_build/test_bgp_attributes [==[--gtest_filter=BGPAttributeStoreTest.LastReferenceFreesTheSet]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPAttributeStoreTest.LastReferenceFreesTheSet]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BGPAttributeStoreTest.ReferencesOutliveTheStore]=]  /root/repo/_debug_build/test_bgp_attributes [==[--gtest_filter=BGPAttributeStoreTest.ReferencesOutliveTheStore]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPAttributeStoreTest.ReferencesOutliveTheStore]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BGPAttributeStoreTest.ConcurrentInternAndRelease]=]  /root/repo/_debug_build/test_bgp_attributes [==[--gtest_filter=BGPAttributeStoreTest.ConcurrentInternAndRelease]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPAttributeStoreTest.ConcurrentInternAndRelease]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_bgp_attributes_TESTS BGPAttributeStoreTest.EqualAttributesShareOneSet BGPAttributeStoreTest.AbsentMedDiffersFromZeroMed BGPAttributeStoreTest.ParsedUpdateInternsToTheSameSet BGPAttributeStoreTest.LastReferenceFreesTheSet BGPAttributeStoreTest.ReferencesOutliveTheStore BGPAttributeStoreTest.ConcurrentInternAndRelease)
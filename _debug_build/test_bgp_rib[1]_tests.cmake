@@ -0,0 +1,17 @@
+add_test([=[BGPRibTest.DecisionProcessFollowsRfc4271]=]  /root/repo/_debug_build/test_bgp_rib [==[--gtest_filter=BGPRibTest.DecisionProcessFollowsRfc4271]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPRibTest.DecisionProcessFollowsRfc4271]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BGPRibTest.AsSetCountsAsOneHop]=]  /root/repo/_debug_build/test_bgp_rib [==[--gtest_filter=BGPRibTest.AsSetCountsAsOneHop]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPRibTest.AsSetCountsAsOneHop]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BGPRibTest.DecidesOnlyTouchedPrefixes]=]  /root/repo/_debug_build/test_bgp_rib [==[--gtest_filter=BGPRibTest.DecidesOnlyTouchedPrefixes]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPRibTest.DecidesOnlyTouchedPrefixes]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BGPRibTest.AdjRibOutSkipsIbgpToIbgp]=]  /root/repo/_debug_build/test_bgp_rib [==[--gtest_filter=BGPRibTest.AdjRibOutSkipsIbgpToIbgp]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPRibTest.AdjRibOutSkipsIbgpToIbgp]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BGPRibTest.BatchesChangesPerPeer]=]  /root/repo/_debug_build/test_bgp_rib [==[--gtest_filter=BGPRibTest.BatchesChangesPerPeer]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPRibTest.BatchesChangesPerPeer]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BGPRibTest.PeerDownFallsBackAndPeerUpGetsTheTable]=]  /root/repo/_debug_build/test_bgp_rib [==[--gtest_filter=BGPRibTest.PeerDownFallsBackAndPeerUpGetsTheTable]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPRibTest.PeerDownFallsBackAndPeerUpGetsTheTable]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BGPRibTest.PeersOfOnePolicyShareAnUpdateGroup]=]  /root/repo/_debug_build/test_bgp_rib [==[--gtest_filter=BGPRibTest.PeersOfOnePolicyShareAnUpdateGroup]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPRibTest.PeersOfOnePolicyShareAnUpdateGroup]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BGPRibTest.LatePeerCatchesUpThenJoinsTheGroup]=]  /root/repo/_debug_build/test_bgp_rib [==[--gtest_filter=BGPRibTest.LatePeerCatchesUpThenJoinsTheGroup]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPRibTest.LatePeerCatchesUpThenJoinsTheGroup]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_bgp_rib_TESTS BGPRibTest.DecisionProcessFollowsRfc4271 BGPRibTest.AsSetCountsAsOneHop BGPRibTest.DecidesOnlyTouchedPrefixes BGPRibTest.AdjRibOutSkipsIbgpToIbgp BGPRibTest.BatchesChangesPerPeer BGPRibTest.PeerDownFallsBackAndPeerUpGetsTheTable BGPRibTest.PeersOfOnePolicyShareAnUpdateGroup BGPRibTest.LatePeerCatchesUpThenJoinsTheGroup)
@@ -0,0 +1,13 @@
+add_test([=[BGPSessionTest.SpeakersEstablishAndExchangeRoutes]=]  /root/repo/_debug_build/test_bgp_session [==[--gtest_filter=BGPSessionTest.SpeakersEstablishAndExchangeRoutes]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPSessionTest.SpeakersEstablishAndExchangeRoutes]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BGPSessionTest.HoldTimerExpiresOnSilentPeer]=]  /root/repo/_debug_build/test_bgp_session [==[--gtest_filter=BGPSessionTest.HoldTimerExpiresOnSilentPeer]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPSessionTest.HoldTimerExpiresOnSilentPeer]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BGPSessionTest.RejectsWrongPeerAsAndMalformedUpdates]=]  /root/repo/_debug_build/test_bgp_session [==[--gtest_filter=BGPSessionTest.RejectsWrongPeerAsAndMalformedUpdates]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPSessionTest.RejectsWrongPeerAsAndMalformedUpdates]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BGPSessionTest.UpdateGroupMembersAreSentTheSameUpdates]=]  /root/repo/_debug_build/test_bgp_session [==[--gtest_filter=BGPSessionTest.UpdateGroupMembersAreSentTheSameUpdates]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPSessionTest.UpdateGroupMembersAreSentTheSameUpdates]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BGPSessionTest.PathsThroughOurAsAreNotLearned]=]  /root/repo/_debug_build/test_bgp_session [==[--gtest_filter=BGPSessionTest.PathsThroughOurAsAreNotLearned]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPSessionTest.PathsThroughOurAsAreNotLearned]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BGPSessionTest.SimultaneousConnectsSettleOnOneConnection]=]  /root/repo/_debug_build/test_bgp_session [==[--gtest_filter=BGPSessionTest.SimultaneousConnectsSettleOnOneConnection]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPSessionTest.SimultaneousConnectsSettleOnOneConnection]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_bgp_session_TESTS BGPSessionTest.SpeakersEstablishAndExchangeRoutes BGPSessionTest.HoldTimerExpiresOnSilentPeer BGPSessionTest.RejectsWrongPeerAsAndMalformedUpdates BGPSessionTest.UpdateGroupMembersAreSentTheSameUpdates BGPSessionTest.PathsThroughOurAsAreNotLearned BGPSessionTest.SimultaneousConnectsSettleOnOneConnection)
@@ -0,0 +1,13 @@
+add_test([=[BGPUpdateTest.RoundTripsAnnouncementWithEveryAttribute]=]  /root/repo/_debug_build/test_bgp_update [==[--gtest_filter=BGPUpdateTest.RoundTripsAnnouncementWithEveryAttribute]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPUpdateTest.RoundTripsAnnouncementWithEveryAttribute]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BGPUpdateTest.PacksPrefixesSharingAttributesIntoFewMessages]=]  /root/repo/_debug_build/test_bgp_update [==[--gtest_filter=BGPUpdateTest.PacksPrefixesSharingAttributesIntoFewMessages]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPUpdateTest.PacksPrefixesSharingAttributesIntoFewMessages]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BGPUpdateTest.AttributesTooLargeForAMessageAreReported]=]  /root/repo/_debug_build/test_bgp_update [==[--gtest_filter=BGPUpdateTest.AttributesTooLargeForAMessageAreReported]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPUpdateTest.AttributesTooLargeForAMessageAreReported]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BGPUpdateTest.TwoOctetPeersGetAsTransAndLongPathsSplit]=]  /root/repo/_debug_build/test_bgp_update [==[--gtest_filter=BGPUpdateTest.TwoOctetPeersGetAsTransAndLongPathsSplit]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPUpdateTest.TwoOctetPeersGetAsTransAndLongPathsSplit]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BGPUpdateTest.ParsesMultiprotocolReachAndUnreach]=]  /root/repo/_debug_build/test_bgp_update [==[--gtest_filter=BGPUpdateTest.ParsesMultiprotocolReachAndUnreach]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPUpdateTest.ParsesMultiprotocolReachAndUnreach]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BGPUpdateTest.RejectsMalformedUpdatesWithTheirSubcode]=]  /root/repo/_debug_build/test_bgp_update [==[--gtest_filter=BGPUpdateTest.RejectsMalformedUpdatesWithTheirSubcode]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BGPUpdateTest.RejectsMalformedUpdatesWithTheirSubcode]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_bgp_update_TESTS BGPUpdateTest.RoundTripsAnnouncementWithEveryAttribute BGPUpdateTest.PacksPrefixesSharingAttributesIntoFewMessages BGPUpdateTest.AttributesTooLargeForAMessageAreReported BGPUpdateTest.TwoOctetPeersGetAsTransAndLongPathsSplit BGPUpdateTest.ParsesMultiprotocolReachAndUnreach BGPUpdateTest.RejectsMalformedUpdatesWithTheirSubcode)
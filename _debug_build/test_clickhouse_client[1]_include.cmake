@@ -0,0 +1,5 @@
+if(EXISTS "/root/repo/_debug_build/test_clickhouse_client[1]_tests.cmake")
+  include("/root/repo/_debug_build/test_clickhouse_client[1]_tests.cmake")
+else()
+  add_test(test_clickhouse_client_NOT_BUILT test_clickhouse_client_NOT_BUILT)
+endif()
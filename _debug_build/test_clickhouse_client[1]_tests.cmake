@@ -0,0 +1,19 @@
+add_test([=[ClickHouseClientTest.SendsOneColumnarBlockPerFlush]=]  /root/repo/_debug_build/test_clickhouse_client [==[--gtest_filter=ClickHouseClientTest.SendsOneColumnarBlockPerFlush]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ClickHouseClientTest.SendsOneColumnarBlockPerFlush]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ClickHouseClientTest.FailedInsertKeepsRows]=]  /root/repo/_debug_build/test_clickhouse_client [==[--gtest_filter=ClickHouseClientTest.FailedInsertKeepsRows]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ClickHouseClientTest.FailedInsertKeepsRows]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ClickHouseClientTest.QueryRendersColumns]=]  /root/repo/_debug_build/test_clickhouse_client [==[--gtest_filter=ClickHouseClientTest.QueryRendersColumns]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ClickHouseClientTest.QueryRendersColumns]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ClickHouseClientTest.InsertsMetricRollups]=]  /root/repo/_debug_build/test_clickhouse_client [==[--gtest_filter=ClickHouseClientTest.InsertsMetricRollups]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ClickHouseClientTest.InsertsMetricRollups]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ClickHouseClientTest.StalledServerDropsInsteadOfBlocking]=]  /root/repo/_debug_build/test_clickhouse_client [==[--gtest_filter=ClickHouseClientTest.StalledServerDropsInsteadOfBlocking]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ClickHouseClientTest.StalledServerDropsInsteadOfBlocking]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ClickHouseClientTest.PartialBatchesFlushOnInterval]=]  /root/repo/_debug_build/test_clickhouse_client [==[--gtest_filter=ClickHouseClientTest.PartialBatchesFlushOnInterval]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ClickHouseClientTest.PartialBatchesFlushOnInterval]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ClickHouseClientTest.JournalsWhileServerIsDownAndReplaysAfter]=]  /root/repo/_debug_build/test_clickhouse_client [==[--gtest_filter=ClickHouseClientTest.JournalsWhileServerIsDownAndReplaysAfter]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ClickHouseClientTest.JournalsWhileServerIsDownAndReplaysAfter]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ClickHouseClientTest.FailedInsertsSpillAndNothingIsLost]=]  /root/repo/_debug_build/test_clickhouse_client [==[--gtest_filter=ClickHouseClientTest.FailedInsertsSpillAndNothingIsLost]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ClickHouseClientTest.FailedInsertsSpillAndNothingIsLost]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ClickHouseClientTest.UndecodableJournalRecordIsSkippedAlone]=]  /root/repo/_debug_build/test_clickhouse_client [==[--gtest_filter=ClickHouseClientTest.UndecodableJournalRecordIsSkippedAlone]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ClickHouseClientTest.UndecodableJournalRecordIsSkippedAlone]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_clickhouse_client_TESTS ClickHouseClientTest.SendsOneColumnarBlockPerFlush ClickHouseClientTest.FailedInsertKeepsRows ClickHouseClientTest.QueryRendersColumns ClickHouseClientTest.InsertsMetricRollups ClickHouseClientTest.StalledServerDropsInsteadOfBlocking ClickHouseClientTest.PartialBatchesFlushOnInterval ClickHouseClientTest.JournalsWhileServerIsDownAndReplaysAfter ClickHouseClientTest.FailedInsertsSpillAndNothingIsLost ClickHouseClientTest.UndecodableJournalRecordIsSkippedAlone)
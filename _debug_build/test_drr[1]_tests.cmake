@@ -0,0 +1,9 @@
+add_test([=[DeficitRoundRobinTest.SharesBytesByWeightAcrossPacketSizes]=]  /root/repo/_debug_build/test_drr [==[--gtest_filter=DeficitRoundRobinTest.SharesBytesByWeightAcrossPacketSizes]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[DeficitRoundRobinTest.SharesBytesByWeightAcrossPacketSizes]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[DeficitRoundRobinTest.SparseFlowPriority]=]  /root/repo/_debug_build/test_drr [==[--gtest_filter=DeficitRoundRobinTest.SparseFlowPriority]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[DeficitRoundRobinTest.SparseFlowPriority]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[DeficitRoundRobinTest.QueueLimitAndUnknownClass]=]  /root/repo/_debug_build/test_drr [==[--gtest_filter=DeficitRoundRobinTest.QueueLimitAndUnknownClass]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[DeficitRoundRobinTest.QueueLimitAndUnknownClass]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[DeficitRoundRobinTest.TrafficShaperUsesDrr]=]  /root/repo/_debug_build/test_drr [==[--gtest_filter=DeficitRoundRobinTest.TrafficShaperUsesDrr]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[DeficitRoundRobinTest.TrafficShaperUsesDrr]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_drr_TESTS DeficitRoundRobinTest.SharesBytesByWeightAcrossPacketSizes DeficitRoundRobinTest.SparseFlowPriority DeficitRoundRobinTest.QueueLimitAndUnknownClass DeficitRoundRobinTest.TrafficShaperUsesDrr)
@@ -0,0 +1,9 @@
+add_test([=[EventLoopTest.TimersFireInOrderAndNeverEarly]=]  /root/repo/_debug_build/test_event_loop [==[--gtest_filter=EventLoopTest.TimersFireInOrderAndNeverEarly]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[EventLoopTest.TimersFireInOrderAndNeverEarly]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[EventLoopTest.DispatchesReadableDescriptors]=]  /root/repo/_debug_build/test_event_loop [==[--gtest_filter=EventLoopTest.DispatchesReadableDescriptors]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[EventLoopTest.DispatchesReadableDescriptors]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[EventLoopTest.PostedTasksWakeTheLoop]=]  /root/repo/_debug_build/test_event_loop [==[--gtest_filter=EventLoopTest.PostedTasksWakeTheLoop]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[EventLoopTest.PostedTasksWakeTheLoop]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[EventLoopTest.StopBeforeRunReturnsImmediately]=]  /root/repo/_debug_build/test_event_loop [==[--gtest_filter=EventLoopTest.StopBeforeRunReturnsImmediately]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[EventLoopTest.StopBeforeRunReturnsImmediately]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_event_loop_TESTS EventLoopTest.TimersFireInOrderAndNeverEarly EventLoopTest.DispatchesReadableDescriptors EventLoopTest.PostedTasksWakeTheLoop EventLoopTest.StopBeforeRunReturnsImmediately)
@@ -0,0 +1,5 @@
+if(EXISTS "/root/repo/_debug_build/test_fib[1]_tests.cmake")
+  include("/root/repo/_debug_build/test_fib[1]_tests.cmake")
+else()
+  add_test(test_fib_NOT_BUILT test_fib_NOT_BUILT)
+endif()
@@ -0,0 +1,11 @@
+add_test([=[Ipv4FibTest.ParsePrefix]=]  /root/repo/_debug_build/test_fib [==[--gtest_filter=Ipv4FibTest.ParsePrefix]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[Ipv4FibTest.ParsePrefix]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[Ipv4FibTest.EmptyTable]=]  /root/repo/_debug_build/test_fib [==[--gtest_filter=Ipv4FibTest.EmptyTable]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[Ipv4FibTest.EmptyTable]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[Ipv4FibTest.LongestPrefixWins]=]  /root/repo/_debug_build/test_fib [==[--gtest_filter=Ipv4FibTest.LongestPrefixWins]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[Ipv4FibTest.LongestPrefixWins]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[Ipv4FibTest.RemoveFallsBackToShorterPrefix]=]  /root/repo/_debug_build/test_fib [==[--gtest_filter=Ipv4FibTest.RemoveFallsBackToShorterPrefix]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[Ipv4FibTest.RemoveFallsBackToShorterPrefix]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[Ipv4FibTest.MatchesReferenceOnRandomTable]=]  /root/repo/_debug_build/test_fib [==[--gtest_filter=Ipv4FibTest.MatchesReferenceOnRandomTable]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[Ipv4FibTest.MatchesReferenceOnRandomTable]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_fib_TESTS Ipv4FibTest.ParsePrefix Ipv4FibTest.EmptyTable Ipv4FibTest.LongestPrefixWins Ipv4FibTest.RemoveFallsBackToShorterPrefix Ipv4FibTest.MatchesReferenceOnRandomTable)
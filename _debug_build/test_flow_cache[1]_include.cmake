@@ -0,0 +1,5 @@
+if(EXISTS "/root/repo/_debug_build/test_flow_cache[1]_tests.cmake")
+  include("/root/repo/_debug_build/test_flow_cache[1]_tests.cmake")
+else()
+  add_test(test_flow_cache_NOT_BUILT test_flow_cache_NOT_BUILT)
+endif()
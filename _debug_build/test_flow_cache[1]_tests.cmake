@@ -0,0 +1,15 @@
+add_test([=[FlowCacheTest.AggregatesPacketsPerFlow]=]  /root/repo/_debug_build/test_flow_cache [==[--gtest_filter=FlowCacheTest.AggregatesPacketsPerFlow]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[FlowCacheTest.AggregatesPacketsPerFlow]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[FlowCacheTest.IdleTimeoutExportsQuietFlows]=]  /root/repo/_debug_build/test_flow_cache [==[--gtest_filter=FlowCacheTest.IdleTimeoutExportsQuietFlows]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[FlowCacheTest.IdleTimeoutExportsQuietFlows]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[FlowCacheTest.ActiveTimeoutReportsLongFlowsInParts]=]  /root/repo/_debug_build/test_flow_cache [==[--gtest_filter=FlowCacheTest.ActiveTimeoutReportsLongFlowsInParts]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[FlowCacheTest.ActiveTimeoutReportsLongFlowsInParts]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[FlowCacheTest.FullCacheEvictsStalestFlow]=]  /root/repo/_debug_build/test_flow_cache [==[--gtest_filter=FlowCacheTest.FullCacheEvictsStalestFlow]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[FlowCacheTest.FullCacheEvictsStalestFlow]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[FlowCacheTest.RemovalKeepsOtherFlowsReachable]=]  /root/repo/_debug_build/test_flow_cache [==[--gtest_filter=FlowCacheTest.RemovalKeepsOtherFlowsReachable]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[FlowCacheTest.RemovalKeepsOtherFlowsReachable]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[FlowCacheTest.BurstsMatchSinglePacketsAndSweep]=]  /root/repo/_debug_build/test_flow_cache [==[--gtest_filter=FlowCacheTest.BurstsMatchSinglePacketsAndSweep]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[FlowCacheTest.BurstsMatchSinglePacketsAndSweep]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[FlowCacheTest.ConvertsToPacketFlowRows]=]  /root/repo/_debug_build/test_flow_cache [==[--gtest_filter=FlowCacheTest.ConvertsToPacketFlowRows]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[FlowCacheTest.ConvertsToPacketFlowRows]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_flow_cache_TESTS FlowCacheTest.AggregatesPacketsPerFlow FlowCacheTest.IdleTimeoutExportsQuietFlows FlowCacheTest.ActiveTimeoutReportsLongFlowsInParts FlowCacheTest.FullCacheEvictsStalestFlow FlowCacheTest.RemovalKeepsOtherFlowsReachable FlowCacheTest.BurstsMatchSinglePacketsAndSweep FlowCacheTest.ConvertsToPacketFlowRows)
@@ -0,0 +1,5 @@
+if(EXISTS "/root/repo/_debug_build/test_htb[1]_tests.cmake")
+  include("/root/repo/_debug_build/test_htb[1]_tests.cmake")
+else()
+  add_test(test_htb_NOT_BUILT test_htb_NOT_BUILT)
+endif()
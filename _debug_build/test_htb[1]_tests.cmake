@@ -0,0 +1,15 @@
+add_test([=[HierarchicalTokenBucketTest.RejectsInvalidTrees]=]  /root/repo/_debug_build/test_htb [==[--gtest_filter=HierarchicalTokenBucketTest.RejectsInvalidTrees]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[HierarchicalTokenBucketTest.RejectsInvalidTrees]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[HierarchicalTokenBucketTest.GuaranteedRatesAndBorrowing]=]  /root/repo/_debug_build/test_htb [==[--gtest_filter=HierarchicalTokenBucketTest.GuaranteedRatesAndBorrowing]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[HierarchicalTokenBucketTest.GuaranteedRatesAndBorrowing]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[HierarchicalTokenBucketTest.CeilCapsBorrowing]=]  /root/repo/_debug_build/test_htb [==[--gtest_filter=HierarchicalTokenBucketTest.CeilCapsBorrowing]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[HierarchicalTokenBucketTest.CeilCapsBorrowing]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[HierarchicalTokenBucketTest.TenantHierarchy]=]  /root/repo/_debug_build/test_htb [==[--gtest_filter=HierarchicalTokenBucketTest.TenantHierarchy]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[HierarchicalTokenBucketTest.TenantHierarchy]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[HierarchicalTokenBucketTest.InnerClassesCountPacketsSentThrough]=]  /root/repo/_debug_build/test_htb [==[--gtest_filter=HierarchicalTokenBucketTest.InnerClassesCountPacketsSentThrough]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[HierarchicalTokenBucketTest.InnerClassesCountPacketsSentThrough]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[HierarchicalTokenBucketTest.ManagerShapesInterfaceWithTree]=]  /root/repo/_debug_build/test_htb [==[--gtest_filter=HierarchicalTokenBucketTest.ManagerShapesInterfaceWithTree]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[HierarchicalTokenBucketTest.ManagerShapesInterfaceWithTree]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[HierarchicalTokenBucketTest.ManagerReleasesShapedPacketsWhenEligible]=]  /root/repo/_debug_build/test_htb [==[--gtest_filter=HierarchicalTokenBucketTest.ManagerReleasesShapedPacketsWhenEligible]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[HierarchicalTokenBucketTest.ManagerReleasesShapedPacketsWhenEligible]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_htb_TESTS HierarchicalTokenBucketTest.RejectsInvalidTrees HierarchicalTokenBucketTest.GuaranteedRatesAndBorrowing HierarchicalTokenBucketTest.CeilCapsBorrowing HierarchicalTokenBucketTest.TenantHierarchy HierarchicalTokenBucketTest.InnerClassesCountPacketsSentThrough HierarchicalTokenBucketTest.ManagerShapesInterfaceWithTree HierarchicalTokenBucketTest.ManagerReleasesShapedPacketsWhenEligible)
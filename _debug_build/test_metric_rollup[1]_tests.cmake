@@ -0,0 +1,11 @@
+add_test([=[MetricRollupTest.OneRowPerSeriesAndWindow]=]  /root/repo/_debug_build/test_metric_rollup [==[--gtest_filter=MetricRollupTest.OneRowPerSeriesAndWindow]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[MetricRollupTest.OneRowPerSeriesAndWindow]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[MetricRollupTest.LaterSampleClosesWindowAndLateOnesAreDropped]=]  /root/repo/_debug_build/test_metric_rollup [==[--gtest_filter=MetricRollupTest.LaterSampleClosesWindowAndLateOnesAreDropped]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[MetricRollupTest.LaterSampleClosesWindowAndLateOnesAreDropped]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[MetricRollupTest.OutOfOrderSampleBeforeOpenWindowIsDropped]=]  /root/repo/_debug_build/test_metric_rollup [==[--gtest_filter=MetricRollupTest.OutOfOrderSampleBeforeOpenWindowIsDropped]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[MetricRollupTest.OutOfOrderSampleBeforeOpenWindowIsDropped]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[MetricRollupTest.LateSampleForForgottenSeriesIsDropped]=]  /root/repo/_debug_build/test_metric_rollup [==[--gtest_filter=MetricRollupTest.LateSampleForForgottenSeriesIsDropped]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[MetricRollupTest.LateSampleForForgottenSeriesIsDropped]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[MetricRollupTest.CountsUniqueFlowsPerInterface]=]  /root/repo/_debug_build/test_metric_rollup [==[--gtest_filter=MetricRollupTest.CountsUniqueFlowsPerInterface]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[MetricRollupTest.CountsUniqueFlowsPerInterface]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_metric_rollup_TESTS MetricRollupTest.OneRowPerSeriesAndWindow MetricRollupTest.LaterSampleClosesWindowAndLateOnesAreDropped MetricRollupTest.OutOfOrderSampleBeforeOpenWindowIsDropped MetricRollupTest.LateSampleForForgottenSeriesIsDropped MetricRollupTest.CountsUniqueFlowsPerInterface)
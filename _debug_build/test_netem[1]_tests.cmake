@@ -0,0 +1,21 @@
+add_test([=[NetemEmulatorTest.SameSeedReproducesRun]=]  /root/repo/_debug_build/test_netem [==[--gtest_filter=NetemEmulatorTest.SameSeedReproducesRun]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[NetemEmulatorTest.SameSeedReproducesRun]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[NetemEmulatorTest.DelayAndJitterBounds]=]  /root/repo/_debug_build/test_netem [==[--gtest_filter=NetemEmulatorTest.DelayAndJitterBounds]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[NetemEmulatorTest.DelayAndJitterBounds]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[NetemEmulatorTest.RandomLossAndGilbertElliottBursts]=]  /root/repo/_debug_build/test_netem [==[--gtest_filter=NetemEmulatorTest.RandomLossAndGilbertElliottBursts]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[NetemEmulatorTest.RandomLossAndGilbertElliottBursts]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[NetemEmulatorTest.FourStateLossModel]=]  /root/repo/_debug_build/test_netem [==[--gtest_filter=NetemEmulatorTest.FourStateLossModel]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[NetemEmulatorTest.FourStateLossModel]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[NetemEmulatorTest.DuplicateAndCorrupt]=]  /root/repo/_debug_build/test_netem [==[--gtest_filter=NetemEmulatorTest.DuplicateAndCorrupt]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[NetemEmulatorTest.DuplicateAndCorrupt]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[NetemEmulatorTest.ReorderGapSendsEveryNthImmediately]=]  /root/repo/_debug_build/test_netem [==[--gtest_filter=NetemEmulatorTest.ReorderGapSendsEveryNthImmediately]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[NetemEmulatorTest.ReorderGapSendsEveryNthImmediately]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[NetemEmulatorTest.RateLimitPacesAfterBurst]=]  /root/repo/_debug_build/test_netem [==[--gtest_filter=NetemEmulatorTest.RateLimitPacesAfterBurst]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[NetemEmulatorTest.RateLimitPacesAfterBurst]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[NetemEmulatorTest.LimitAndLinkRemoval]=]  /root/repo/_debug_build/test_netem [==[--gtest_filter=NetemEmulatorTest.LimitAndLinkRemoval]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[NetemEmulatorTest.LimitAndLinkRemoval]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[NetemEmulatorTest.ThousandsOfLinksShareOneReleaseOrder]=]  /root/repo/_debug_build/test_netem [==[--gtest_filter=NetemEmulatorTest.ThousandsOfLinksShareOneReleaseOrder]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[NetemEmulatorTest.ThousandsOfLinksShareOneReleaseOrder]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[NetemImpairmentsTest.AccumulatesImpairmentsOnInterface]=]  /root/repo/_debug_build/test_netem [==[--gtest_filter=NetemImpairmentsTest.AccumulatesImpairmentsOnInterface]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[NetemImpairmentsTest.AccumulatesImpairmentsOnInterface]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_netem_TESTS NetemEmulatorTest.SameSeedReproducesRun NetemEmulatorTest.DelayAndJitterBounds NetemEmulatorTest.RandomLossAndGilbertElliottBursts NetemEmulatorTest.FourStateLossModel NetemEmulatorTest.DuplicateAndCorrupt NetemEmulatorTest.ReorderGapSendsEveryNthImmediately NetemEmulatorTest.RateLimitPacesAfterBurst NetemEmulatorTest.LimitAndLinkRemoval NetemEmulatorTest.ThousandsOfLinksShareOneReleaseOrder NetemImpairmentsTest.AccumulatesImpairmentsOnInterface)
@@ -0,0 +1,11 @@
+add_test([=[NetemNetlinkTest.OptionsRoundTrip]=]  /root/repo/_debug_build/test_netlink [==[--gtest_filter=NetemNetlinkTest.OptionsRoundTrip]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[NetemNetlinkTest.OptionsRoundTrip]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[NetemNetlinkTest.BatchesManyInterfacesAndReadsBack]=]  /root/repo/_debug_build/test_netlink [==[--gtest_filter=NetemNetlinkTest.BatchesManyInterfacesAndReadsBack]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[NetemNetlinkTest.BatchesManyInterfacesAndReadsBack]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[NetemNetlinkTest.ReportsPerInterfaceFailures]=]  /root/repo/_debug_build/test_netlink [==[--gtest_filter=NetemNetlinkTest.ReportsPerInterfaceFailures]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[NetemNetlinkTest.ReportsPerInterfaceFailures]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[NetemNetlinkTest.NetemImpairmentsScenarioIsOneBatch]=]  /root/repo/_debug_build/test_netlink [==[--gtest_filter=NetemNetlinkTest.NetemImpairmentsScenarioIsOneBatch]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[NetemNetlinkTest.NetemImpairmentsScenarioIsOneBatch]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[NetworkImpairmentsTest.AppliesAndReadsBackOverNetlink]=]  /root/repo/_debug_build/test_netlink [==[--gtest_filter=NetworkImpairmentsTest.AppliesAndReadsBackOverNetlink]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[NetworkImpairmentsTest.AppliesAndReadsBackOverNetlink]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_netlink_TESTS NetemNetlinkTest.OptionsRoundTrip NetemNetlinkTest.BatchesManyInterfacesAndReadsBack NetemNetlinkTest.ReportsPerInterfaceFailures NetemNetlinkTest.NetemImpairmentsScenarioIsOneBatch NetworkImpairmentsTest.AppliesAndReadsBackOverNetlink)
@@ -0,0 +1,5 @@
+if(EXISTS "/root/repo/_debug_build/test_packet_descriptor[1]_tests.cmake")
+  include("/root/repo/_debug_build/test_packet_descriptor[1]_tests.cmake")
+else()
+  add_test(test_packet_descriptor_NOT_BUILT test_packet_descriptor_NOT_BUILT)
+endif()
@@ -0,0 +1,19 @@
+add_test([=[PacketDescriptorTest.Layout]=]  /root/repo/_debug_build/test_packet_descriptor [==[--gtest_filter=PacketDescriptorTest.Layout]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PacketDescriptorTest.Layout]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PacketDescriptorTest.RoundTripIpv4]=]  /root/repo/_debug_build/test_packet_descriptor [==[--gtest_filter=PacketDescriptorTest.RoundTripIpv4]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PacketDescriptorTest.RoundTripIpv4]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PacketDescriptorTest.RoundTripIpv6]=]  /root/repo/_debug_build/test_packet_descriptor [==[--gtest_filter=PacketDescriptorTest.RoundTripIpv6]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PacketDescriptorTest.RoundTripIpv6]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PacketDescriptorTest.WeightedFairQueueStoresDescriptors]=]  /root/repo/_debug_build/test_packet_descriptor [==[--gtest_filter=PacketDescriptorTest.WeightedFairQueueStoresDescriptors]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PacketDescriptorTest.WeightedFairQueueStoresDescriptors]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PacketDescriptorTest.TrafficShaperBurstVerdicts]=]  /root/repo/_debug_build/test_packet_descriptor [==[--gtest_filter=PacketDescriptorTest.TrafficShaperBurstVerdicts]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PacketDescriptorTest.TrafficShaperBurstVerdicts]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PacketDescriptorTest.BurstEntryPointsStopAtMaxBurstSize]=]  /root/repo/_debug_build/test_packet_descriptor [==[--gtest_filter=PacketDescriptorTest.BurstEntryPointsStopAtMaxBurstSize]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PacketDescriptorTest.BurstEntryPointsStopAtMaxBurstSize]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PacketDescriptorTest.TokenBucketBurstSizeBoundsTheDepth]=]  /root/repo/_debug_build/test_packet_descriptor [==[--gtest_filter=PacketDescriptorTest.TokenBucketBurstSizeBoundsTheDepth]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PacketDescriptorTest.TokenBucketBurstSizeBoundsTheDepth]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PacketDescriptorTest.TokenBucketChargesFractionalCostsExactly]=]  /root/repo/_debug_build/test_packet_descriptor [==[--gtest_filter=PacketDescriptorTest.TokenBucketChargesFractionalCostsExactly]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PacketDescriptorTest.TokenBucketChargesFractionalCostsExactly]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PacketDescriptorTest.TokenBucketStatisticsExactUnderContention]=]  /root/repo/_debug_build/test_packet_descriptor [==[--gtest_filter=PacketDescriptorTest.TokenBucketStatisticsExactUnderContention]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PacketDescriptorTest.TokenBucketStatisticsExactUnderContention]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_packet_descriptor_TESTS PacketDescriptorTest.Layout PacketDescriptorTest.RoundTripIpv4 PacketDescriptorTest.RoundTripIpv6 PacketDescriptorTest.WeightedFairQueueStoresDescriptors PacketDescriptorTest.TrafficShaperBurstVerdicts PacketDescriptorTest.BurstEntryPointsStopAtMaxBurstSize PacketDescriptorTest.TokenBucketBurstSizeBoundsTheDepth PacketDescriptorTest.TokenBucketChargesFractionalCostsExactly PacketDescriptorTest.TokenBucketStatisticsExactUnderContention)
@@ -0,0 +1,17 @@
+add_test([=[PcapFlowAlignerTest.MatchesIdenticalStreams]=]  /root/repo/_debug_build/test_pcap_diff [==[--gtest_filter=PcapFlowAlignerTest.MatchesIdenticalStreams]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PcapFlowAlignerTest.MatchesIdenticalStreams]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PcapFlowAlignerTest.MemoryStaysWithinWindow]=]  /root/repo/_debug_build/test_pcap_diff [==[--gtest_filter=PcapFlowAlignerTest.MemoryStaysWithinWindow]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PcapFlowAlignerTest.MemoryStaysWithinWindow]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PcapDiffFlowTest.SingleLossIsOneDifference]=]  /root/repo/_debug_build/test_pcap_diff [==[--gtest_filter=PcapDiffFlowTest.SingleLossIsOneDifference]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PcapDiffFlowTest.SingleLossIsOneDifference]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PcapDiffFlowTest.ReportsInsertionsReorderingAndChanges]=]  /root/repo/_debug_build/test_pcap_diff [==[--gtest_filter=PcapDiffFlowTest.ReportsInsertionsReorderingAndChanges]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PcapDiffFlowTest.ReportsInsertionsReorderingAndChanges]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PcapDiffFlowTest.MatchesPacketsWithoutIdentityByShape]=]  /root/repo/_debug_build/test_pcap_diff [==[--gtest_filter=PcapDiffFlowTest.MatchesPacketsWithoutIdentityByShape]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PcapDiffFlowTest.MatchesPacketsWithoutIdentityByShape]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PcapDiffFlowTest.CapsStoredDifferences]=]  /root/repo/_debug_build/test_pcap_diff [==[--gtest_filter=PcapDiffFlowTest.CapsStoredDifferences]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PcapDiffFlowTest.CapsStoredDifferences]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PcapDiffParallelTest.ResultsDoNotDependOnThreadCount]=]  /root/repo/_debug_build/test_pcap_diff [==[--gtest_filter=PcapDiffParallelTest.ResultsDoNotDependOnThreadCount]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PcapDiffParallelTest.ResultsDoNotDependOnThreadCount]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PcapDiffParallelTest.IdenticalCapturesMatchOnEveryWorker]=]  /root/repo/_debug_build/test_pcap_diff [==[--gtest_filter=PcapDiffParallelTest.IdenticalCapturesMatchOnEveryWorker]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PcapDiffParallelTest.IdenticalCapturesMatchOnEveryWorker]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_pcap_diff_TESTS PcapFlowAlignerTest.MatchesIdenticalStreams PcapFlowAlignerTest.MemoryStaysWithinWindow PcapDiffFlowTest.SingleLossIsOneDifference PcapDiffFlowTest.ReportsInsertionsReorderingAndChanges PcapDiffFlowTest.MatchesPacketsWithoutIdentityByShape PcapDiffFlowTest.CapsStoredDifferences PcapDiffParallelTest.ResultsDoNotDependOnThreadCount PcapDiffParallelTest.IdenticalCapturesMatchOnEveryWorker)
@@ -0,0 +1,11 @@
+add_test([=[PcapReaderTest.ReadsPcapInBothByteOrders]=]  /root/repo/_debug_build/test_pcap_reader [==[--gtest_filter=PcapReaderTest.ReadsPcapInBothByteOrders]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PcapReaderTest.ReadsPcapInBothByteOrders]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PcapReaderTest.ReadsPcapngSectionsAndInterfaces]=]  /root/repo/_debug_build/test_pcap_reader [==[--gtest_filter=PcapReaderTest.ReadsPcapngSectionsAndInterfaces]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PcapReaderTest.ReadsPcapngSectionsAndInterfaces]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PcapReaderTest.StopsAtTruncatedRecord]=]  /root/repo/_debug_build/test_pcap_reader [==[--gtest_filter=PcapReaderTest.StopsAtTruncatedRecord]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PcapReaderTest.StopsAtTruncatedRecord]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PcapReaderTest.DecodesOtherLinkTypes]=]  /root/repo/_debug_build/test_pcap_reader [==[--gtest_filter=PcapReaderTest.DecodesOtherLinkTypes]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PcapReaderTest.DecodesOtherLinkTypes]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PcapReaderTest.PcapDiffComparesFiles]=]  /root/repo/_debug_build/test_pcap_reader [==[--gtest_filter=PcapReaderTest.PcapDiffComparesFiles]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PcapReaderTest.PcapDiffComparesFiles]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_pcap_reader_TESTS PcapReaderTest.ReadsPcapInBothByteOrders PcapReaderTest.ReadsPcapngSectionsAndInterfaces PcapReaderTest.StopsAtTruncatedRecord PcapReaderTest.DecodesOtherLinkTypes PcapReaderTest.PcapDiffComparesFiles)
@@ -0,0 +1,9 @@
+add_test([=[PcapTapTest.WritesDecodablePcapng]=]  /root/repo/_debug_build/test_pcap_tap [==[--gtest_filter=PcapTapTest.WritesDecodablePcapng]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PcapTapTest.WritesDecodablePcapng]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PcapTapTest.ConcurrentProducersLoseNothingSilently]=]  /root/repo/_debug_build/test_pcap_tap [==[--gtest_filter=PcapTapTest.ConcurrentProducersLoseNothingSilently]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PcapTapTest.ConcurrentProducersLoseNothingSilently]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PcapTapTest.CapturesShapingStages]=]  /root/repo/_debug_build/test_pcap_tap [==[--gtest_filter=PcapTapTest.CapturesShapingStages]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PcapTapTest.CapturesShapingStages]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PcapTapTest.UnknownInterfaceCapturesDrops]=]  /root/repo/_debug_build/test_pcap_tap [==[--gtest_filter=PcapTapTest.UnknownInterfaceCapturesDrops]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PcapTapTest.UnknownInterfaceCapturesDrops]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_pcap_tap_TESTS PcapTapTest.WritesDecodablePcapng PcapTapTest.ConcurrentProducersLoseNothingSilently PcapTapTest.CapturesShapingStages PcapTapTest.UnknownInterfaceCapturesDrops)
@@ -0,0 +1,5 @@
+if(EXISTS "/root/repo/_debug_build/test_segment_journal[1]_tests.cmake")
+  include("/root/repo/_debug_build/test_segment_journal[1]_tests.cmake")
+else()
+  add_test(test_segment_journal_NOT_BUILT test_segment_journal_NOT_BUILT)
+endif()
@@ -0,0 +1,11 @@
+add_test([=[SegmentJournalTest.RoundTripsRecordsWithEachCodec]=]  /root/repo/_debug_build/test_segment_journal [==[--gtest_filter=SegmentJournalTest.RoundTripsRecordsWithEachCodec]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[SegmentJournalTest.RoundTripsRecordsWithEachCodec]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[SegmentJournalTest.RewindRereadsAndCommitDeletesReplayedSegments]=]  /root/repo/_debug_build/test_segment_journal [==[--gtest_filter=SegmentJournalTest.RewindRereadsAndCommitDeletesReplayedSegments]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[SegmentJournalTest.RewindRereadsAndCommitDeletesReplayedSegments]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[SegmentJournalTest.ReopenResumesAfterLastCommit]=]  /root/repo/_debug_build/test_segment_journal [==[--gtest_filter=SegmentJournalTest.ReopenResumesAfterLastCommit]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[SegmentJournalTest.ReopenResumesAfterLastCommit]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[SegmentJournalTest.StaysWithinMaxBytes]=]  /root/repo/_debug_build/test_segment_journal [==[--gtest_filter=SegmentJournalTest.StaysWithinMaxBytes]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[SegmentJournalTest.StaysWithinMaxBytes]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[SegmentJournalTest.RecoveryStopsAtCorruptRecord]=]  /root/repo/_debug_build/test_segment_journal [==[--gtest_filter=SegmentJournalTest.RecoveryStopsAtCorruptRecord]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[SegmentJournalTest.RecoveryStopsAtCorruptRecord]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_segment_journal_TESTS SegmentJournalTest.RoundTripsRecordsWithEachCodec SegmentJournalTest.RewindRereadsAndCommitDeletesReplayedSegments SegmentJournalTest.ReopenResumesAfterLastCommit SegmentJournalTest.StaysWithinMaxBytes SegmentJournalTest.RecoveryStopsAtCorruptRecord)
@@ -0,0 +1,15 @@
+add_test([=[DDSketchTest.QuantilesWithinRelativeAccuracy]=]  /root/repo/_debug_build/test_sketches [==[--gtest_filter=DDSketchTest.QuantilesWithinRelativeAccuracy]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[DDSketchTest.QuantilesWithinRelativeAccuracy]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[DDSketchTest.HandlesZeroAndNegativeValues]=]  /root/repo/_debug_build/test_sketches [==[--gtest_filter=DDSketchTest.HandlesZeroAndNegativeValues]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[DDSketchTest.HandlesZeroAndNegativeValues]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[DDSketchTest.MergeEqualsSketchOfUnion]=]  /root/repo/_debug_build/test_sketches [==[--gtest_filter=DDSketchTest.MergeEqualsSketchOfUnion]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[DDSketchTest.MergeEqualsSketchOfUnion]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[DDSketchTest.SerializeRoundTrips]=]  /root/repo/_debug_build/test_sketches [==[--gtest_filter=DDSketchTest.SerializeRoundTrips]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[DDSketchTest.SerializeRoundTrips]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[DDSketchTest.BoundedBucketsKeepUpperQuantiles]=]  /root/repo/_debug_build/test_sketches [==[--gtest_filter=DDSketchTest.BoundedBucketsKeepUpperQuantiles]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[DDSketchTest.BoundedBucketsKeepUpperQuantiles]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[HyperLogLogTest.EstimatesDistinctCounts]=]  /root/repo/_debug_build/test_sketches [==[--gtest_filter=HyperLogLogTest.EstimatesDistinctCounts]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[HyperLogLogTest.EstimatesDistinctCounts]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[HyperLogLogTest.MergeEqualsSketchOfUnion]=]  /root/repo/_debug_build/test_sketches [==[--gtest_filter=HyperLogLogTest.MergeEqualsSketchOfUnion]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[HyperLogLogTest.MergeEqualsSketchOfUnion]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_sketches_TESTS DDSketchTest.QuantilesWithinRelativeAccuracy DDSketchTest.HandlesZeroAndNegativeValues DDSketchTest.MergeEqualsSketchOfUnion DDSketchTest.SerializeRoundTrips DDSketchTest.BoundedBucketsKeepUpperQuantiles HyperLogLogTest.EstimatesDistinctCounts HyperLogLogTest.MergeEqualsSketchOfUnion)
@@ -0,0 +1,5 @@
+if(EXISTS "/root/repo/_debug_build/test_timer_wheel[1]_tests.cmake")
+  include("/root/repo/_debug_build/test_timer_wheel[1]_tests.cmake")
+else()
+  add_test(test_timer_wheel_NOT_BUILT test_timer_wheel_NOT_BUILT)
+endif()
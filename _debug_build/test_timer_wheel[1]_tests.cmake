@@ -0,0 +1,11 @@
+add_test([=[TimerWheelTest.FiresInExpiryOrderAndNeverEarly]=]  /root/repo/_debug_build/test_timer_wheel [==[--gtest_filter=TimerWheelTest.FiresInExpiryOrderAndNeverEarly]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[TimerWheelTest.FiresInExpiryOrderAndNeverEarly]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[TimerWheelTest.CancelAndStaleIds]=]  /root/repo/_debug_build/test_timer_wheel [==[--gtest_filter=TimerWheelTest.CancelAndStaleIds]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[TimerWheelTest.CancelAndStaleIds]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[TimerWheelTest.CallbackMayRearm]=]  /root/repo/_debug_build/test_timer_wheel [==[--gtest_filter=TimerWheelTest.CallbackMayRearm]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[TimerWheelTest.CallbackMayRearm]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[TimerWheelTest.BeyondWheelSpan]=]  /root/repo/_debug_build/test_timer_wheel [==[--gtest_filter=TimerWheelTest.BeyondWheelSpan]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[TimerWheelTest.BeyondWheelSpan]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[TimerWheelTest.MatchesReferenceUnderRandomLoad]=]  /root/repo/_debug_build/test_timer_wheel [==[--gtest_filter=TimerWheelTest.MatchesReferenceUnderRandomLoad]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[TimerWheelTest.MatchesReferenceUnderRandomLoad]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_timer_wheel_TESTS TimerWheelTest.FiresInExpiryOrderAndNeverEarly TimerWheelTest.CancelAndStaleIds TimerWheelTest.CallbackMayRearm TimerWheelTest.BeyondWheelSpan TimerWheelTest.MatchesReferenceUnderRandomLoad)
@@ -0,0 +1,9 @@
+add_test([=[WeightedFairQueueTest.ServesInFinishTimeOrder]=]  /root/repo/_debug_build/test_wfq [==[--gtest_filter=WeightedFairQueueTest.ServesInFinishTimeOrder]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[WeightedFairQueueTest.ServesInFinishTimeOrder]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[WeightedFairQueueTest.SharesBandwidthByWeight]=]  /root/repo/_debug_build/test_wfq [==[--gtest_filter=WeightedFairQueueTest.SharesBandwidthByWeight]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[WeightedFairQueueTest.SharesBandwidthByWeight]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[WeightedFairQueueTest.LargeWeightsKeepTheirRatio]=]  /root/repo/_debug_build/test_wfq [==[--gtest_filter=WeightedFairQueueTest.LargeWeightsKeepTheirRatio]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[WeightedFairQueueTest.LargeWeightsKeepTheirRatio]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[WeightedFairQueueTest.ClassManagement]=]  /root/repo/_debug_build/test_wfq [==[--gtest_filter=WeightedFairQueueTest.ClassManagement]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[WeightedFairQueueTest.ClassManagement]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_wfq_TESTS WeightedFairQueueTest.ServesInFinishTimeOrder WeightedFairQueueTest.SharesBandwidthByWeight WeightedFairQueueTest.LargeWeightsKeepTheirRatio WeightedFairQueueTest.ClassManagement)
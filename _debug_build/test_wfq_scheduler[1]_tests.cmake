@@ -0,0 +1,11 @@
+add_test([=[WFQTest.StoresAndReturnsPackets]=]  /root/repo/_debug_build/test_wfq_scheduler [==[--gtest_filter=WFQTest.StoresAndReturnsPackets]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[WFQTest.StoresAndReturnsPackets]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[WFQTest.VirtualTimeFollowsLinkRate]=]  /root/repo/_debug_build/test_wfq_scheduler [==[--gtest_filter=WFQTest.VirtualTimeFollowsLinkRate]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[WFQTest.VirtualTimeFollowsLinkRate]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[WFQTest.IdleQueueRefillIsServed]=]  /root/repo/_debug_build/test_wfq_scheduler [==[--gtest_filter=WFQTest.IdleQueueRefillIsServed]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[WFQTest.IdleQueueRefillIsServed]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[WFQTest.LatencyBoundEqualSizes]=]  /root/repo/_debug_build/test_wfq_scheduler [==[--gtest_filter=WFQTest.LatencyBoundEqualSizes]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[WFQTest.LatencyBoundEqualSizes]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[WFQTest.LatencyBoundMixedSizes]=]  /root/repo/_debug_build/test_wfq_scheduler [==[--gtest_filter=WFQTest.LatencyBoundMixedSizes]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[WFQTest.LatencyBoundMixedSizes]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_wfq_scheduler_TESTS WFQTest.StoresAndReturnsPackets WFQTest.VirtualTimeFollowsLinkRate WFQTest.IdleQueueRefillIsServed WFQTest.LatencyBoundEqualSizes WFQTest.LatencyBoundMixedSizes)
@@ -0,0 +1,5 @@
+add_test([=[YAMLConfigTest.DRRRoundTrips]=]  /root/repo/_debug_build/test_yaml_config [==[--gtest_filter=YAMLConfigTest.DRRRoundTrips]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[YAMLConfigTest.DRRRoundTrips]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[YAMLConfigTest.HTBClassesRoundTripAndReachTheShaper]=]  /root/repo/_debug_build/test_yaml_config [==[--gtest_filter=YAMLConfigTest.HTBClassesRoundTripAndReachTheShaper]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[YAMLConfigTest.HTBClassesRoundTripAndReachTheShaper]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_debug_build SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  test_yaml_config_TESTS YAMLConfigTest.DRRRoundTrips YAMLConfigTest.HTBClassesRoundTripAndReachTheShaper)
@@ -0,0 +1,208 @@
+// BGP attribute store benchmark: resident memory of a full table learned
+// from several peers, with and without interned attribute sets.
+//
+// Each peer announces the same prefixes through a few thousand distinct
+// paths (its own AS in front, its address as next hop), as UPDATEs that are
+// parsed and stored the way BGPProtocol stores learned routes. The baseline
+// is the route as it was before the store: its own next hop, origin and
+// metric, AS path vector and attribute map of strings. Each mode runs in a
+// child process of its own, so the RSS it adds is its alone.
+//
+// Usage: bgp_attribute_store_bench [prefixes per peer] [peers] [paths per peer]
+
+#include "protocols/bgp.h"
+#include <iostream>
+#include <iomanip>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace router_sim;
+using RouterSim::Ipv4Prefix;
+
+namespace {
+
+struct Path {
+    BGPPathAttributes attributes;
+    std::vector<Ipv4Prefix> prefixes;
+};
+
+// The prefixes spread over paths, the same for every peer
+std::vector<Path> make_paths(size_t prefixes, size_t paths) {
+    std::mt19937 random(11);
+    std::vector<Path> table(paths);
+    for (auto& path : table) {
+        for (size_t hops = 1 + random() % 6; hops > 0; --hops) {
+            path.attributes.as_path.push_back(1 + random() % 400000);
+        }
+        path.attributes.has_med = random() % 2;
+        path.attributes.med = path.attributes.has_med ? random() % 1000 : 0;
+        path.attributes.communities = {(65000u << 16) | static_cast<uint32_t>(random() % 100)};
+    }
+    for (size_t made = 0; made < prefixes; ++made) {
+        uint32_t roll = random() % 100;
+        uint8_t length = roll < 60 ? 24 : roll < 70 ? 22 : roll < 80 ? 23 : roll < 90 ? 20 : 16 + random() % 4;
+        uint32_t address = (0x01000000 + static_cast<uint32_t>(made) * 256) & ~((1u << (32 - length)) - 1);
+        table[random() % paths].prefixes.emplace_back(address, length);
+    }
+    return table;
+}
+
+// One peer's table as framed UPDATEs
+std::vector<uint8_t> encode_peer(const std::vector<Path>& table, uint32_t peer) {
+    BGPUpdateEncoder encoder;
+    std::vector<uint8_t> buffer;
+    for (const auto& path : table) {
+        BGPPathAttributes attributes = path.attributes;
+        attributes.as_path.insert(attributes.as_path.begin(), 65100 + peer);
+        attributes.next_hop = 0xc0000200 + peer;
+        encoder.encode_announcements(attributes, path.prefixes.data(), path.prefixes.size(), buffer);
+    }
+    return buffer;
+}
+
+template <typename Visit>
+void for_each_update(const std::vector<uint8_t>& buffer, Visit visit) {
+    BGPUpdate update;
+    for (size_t offset = 0; offset < buffer.size();) {
+        size_t length = (buffer[offset + 16] << 8) | buffer[offset + 17];
+        if (update.parse(buffer.data() + offset + BGP_HEADER_SIZE, length - BGP_HEADER_SIZE, true)) {
+            visit(update);
+        }
+        offset += length;
+    }
+}
+
+std::string format_ipv4(uint32_t address) {
+    in_addr value{};
+    value.s_addr = htonl(address);
+    char text[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &value, text, sizeof(text));
+    return text;
+}
+
+std::string route_key(const std::string& prefix, uint8_t length) {
+    return prefix + "/" + std::to_string(length);
+}
+
+size_t resident_kb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmRSS:", 0) == 0) {
+            return std::strtoul(line.c_str() + 6, nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+// --- The route as it was before the store ---
+
+struct LegacyBGPRoute {
+    std::string prefix;
+    uint8_t prefix_length;
+    uint32_t metric;
+    std::string next_hop;
+    std::string origin;
+    std::vector<uint32_t> as_path;
+    std::map<std::string, std::string> attributes;
+    bool is_valid;
+    std::chrono::steady_clock::time_point last_updated;
+};
+
+void print_row(const char* name, size_t routes, size_t before_kb, double seconds, const std::string& extra) {
+    size_t added = resident_kb() - before_kb;
+    std::cout << std::setw(8) << name << ": " << std::setw(8) << added / 1024.0 << " MB RSS, " << std::setw(6)
+              << added * 1024.0 / routes << " bytes/route, " << std::setw(6) << routes / seconds / 1e6
+              << " M routes/s learned" << extra << std::endl;
+}
+
+template <typename Run>
+void in_child(Run run) {
+    std::cout.flush();
+    pid_t child = fork();
+    if (child == 0) {
+        run();
+        std::cout.flush();
+        std::_Exit(0);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t prefixes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 900000;
+    size_t peers = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10;
+    size_t paths = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 5000;
+    auto table = make_paths(prefixes, paths);
+    size_t routes = prefixes * peers;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "=== BGP attribute store: " << peers << " peers x " << prefixes << " prefixes, " << paths
+              << " paths per peer ===" << std::endl;
+
+    // Before
+    in_child([&] {
+        size_t before_kb = resident_kb();
+        std::vector<std::map<std::string, LegacyBGPRoute>> rib(peers);
+        double seconds = 0;
+        for (size_t peer = 0; peer < peers; ++peer) {
+            std::vector<uint8_t> buffer = encode_peer(table, static_cast<uint32_t>(peer));
+            std::string neighbor = format_ipv4(0xc0000200 + static_cast<uint32_t>(peer));
+            auto start = std::chrono::steady_clock::now();
+            for_each_update(buffer, [&](const BGPUpdate& update) {
+                LegacyBGPRoute route;
+                route.metric = update.med();
+                route.next_hop = format_ipv4(update.next_hop());
+                route.origin = update.origin() == BGP_ORIGIN_IGP ? "IGP" : "INCOMPLETE";
+                update.as_path().append_to(route.as_path);
+                route.attributes["neighbor"] = neighbor;
+                route.is_valid = true;
+                route.last_updated = std::chrono::steady_clock::now();
+                for (BGPPrefix prefix : update.nlri()) {
+                    route.prefix = format_ipv4(prefix.ipv4());
+                    route.prefix_length = prefix.length;
+                    rib[peer][route_key(route.prefix, prefix.length)] = route;
+                }
+            });
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        print_row("before", routes, before_kb, seconds, "");
+    });
+
+    // Interned
+    in_child([&] {
+        size_t before_kb = resident_kb();
+        BGPAttributeStore store;
+        std::vector<std::map<std::string, BGPRoute>> rib(peers);
+        double seconds = 0;
+        for (size_t peer = 0; peer < peers; ++peer) {
+            std::vector<uint8_t> buffer = encode_peer(table, static_cast<uint32_t>(peer));
+            auto start = std::chrono::steady_clock::now();
+            for_each_update(buffer, [&](const BGPUpdate& update) {
+                BGPRoute route;
+                route.neighbor = 0xc0000200 + static_cast<uint32_t>(peer);
+                route.attributes = store.intern(update, update.next_hop());
+                for (BGPPrefix prefix : update.nlri()) {
+                    route.prefix = format_ipv4(prefix.ipv4());
+                    route.prefix_length = prefix.length;
+                    rib[peer][route_key(route.prefix, prefix.length)] = route;
+                }
+            });
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        auto stats = store.get_statistics();
+        print_row("interned", routes, before_kb, seconds,
+                  ", " + std::to_string(stats.sets) + " sets in " +
+                      std::to_string(stats.memory_bytes / 1024) + " KB");
+    });
+    return 0;
+}
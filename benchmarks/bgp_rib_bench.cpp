@@ -0,0 +1,207 @@
+// BGP RIB benchmark: initial convergence of full tables from several peers,
+// and reconvergence after one peer flaps.
+//
+// Every peer announces the same prefixes over a few thousand paths of
+// random length, so the best path is spread among them; a smaller peer
+// announces a slice of the table over shorter paths and is best for it.
+// Updates arrive in bursts of one attribute set from each peer (each peer
+// groups the prefixes differently), and after each burst the decision
+// process runs and every update group's Adj-RIB-Out is taken, as BGPProtocol
+// does once per loop turn; the peers are alike, so there is one group but
+// while a peer that came back catches up. A flap is the peer going down,
+// then coming back with its routes; coming back includes sending it the
+// whole table. The baseline for the flap is the decision process run on
+// the whole table after each step, as a RIB that does not track touched
+// prefixes must.
+//
+// Usage: bgp_rib_bench [prefixes] [peers] [paths per peer] [prefixes of the flapping peer]
+
+#include "protocols/bgp_rib.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace router_sim;
+using RouterSim::Ipv4Prefix;
+
+namespace {
+
+struct PeerTable {
+    uint32_t address;
+    std::vector<std::pair<BGPAttributeRef, std::vector<Ipv4Prefix>>> groups;
+};
+
+std::vector<Ipv4Prefix> make_prefixes(size_t count) {
+    std::mt19937 random(5);
+    std::vector<Ipv4Prefix> prefixes;
+    std::unordered_set<uint64_t> seen;
+    while (prefixes.size() < count) {
+        uint32_t roll = random() % 100;
+        uint8_t length = roll < 60 ? 24 : roll < 70 ? 22 : roll < 80 ? 23 : roll < 90 ? 20 : 16 + random() % 4;
+        uint32_t address = (0x01000000 + random() % 0xdf000000) & ~((1u << (32 - length)) - 1);
+        if (seen.insert((uint64_t(address) << 8) | length).second) {
+            prefixes.emplace_back(address, length);
+        }
+    }
+    return prefixes;
+}
+
+// The peer's own AS first, then min_hops or more others
+PeerTable make_peer(BGPAttributeStore& store, const std::vector<Ipv4Prefix>& prefixes, uint32_t index,
+                    size_t paths, size_t min_hops, std::mt19937& random) {
+    PeerTable table;
+    table.address = 0x0a000001 + index;
+    table.groups.resize(std::min(paths, prefixes.size()));
+    for (auto& group : table.groups) {
+        BGPPathAttributes attributes;
+        attributes.as_path.push_back(65100 + index);
+        for (size_t hops = min_hops + random() % 5; hops > 0; --hops) {
+            attributes.as_path.push_back(1 + random() % 400000);
+        }
+        attributes.next_hop = table.address;
+        attributes.has_med = true;
+        attributes.med = random() % 100;
+        group.first = store.intern(attributes);
+    }
+    // Each peer in an order of its own, so a prefix is decided again as better paths come in
+    for (const auto& prefix : prefixes) {
+        table.groups[random() % table.groups.size()].second.push_back(prefix);
+    }
+    return table;
+}
+
+struct Work {
+    double seconds = 0;
+    uint64_t decisions = 0;
+    uint64_t best_changes = 0;
+    uint64_t prefixes_out = 0;
+};
+
+void print_row(const char* name, const Work& work) {
+    std::cout << std::setw(26) << name << ": " << std::setw(9) << work.seconds * 1e3 << " ms, " << std::setw(8)
+              << work.decisions << " decisions, " << std::setw(7) << work.best_changes << " best path changes, "
+              << std::setw(8) << work.prefixes_out << " prefixes out" << std::endl;
+}
+
+class Driver {
+public:
+    explicit Driver(BGPRib& rib) : rib_(rib) {}
+
+    // Decisions and every group's Adj-RIB-Out, after a burst of updates
+    void export_changes(bool rescan) {
+        if (rescan) {
+            rib_.touch_all();
+        }
+        changes_.clear();
+        rib_.run_decisions(changes_);
+        for (uint32_t group : rib_.update_groups()) {
+            if (rib_.take_updates(group, update_)) {
+                prefixes_out_ += update_.withdrawn.size();
+                for (const auto& group : update_.announced) {
+                    prefixes_out_ += group.second.size();
+                }
+            }
+        }
+    }
+
+    void announce(const PeerTable& peer, size_t group) {
+        for (const auto& prefix : peer.groups[group].second) {
+            rib_.update(peer.address, prefix, peer.groups[group].first);
+        }
+    }
+
+    template <typename Run>
+    Work measure(Run run) {
+        auto before = rib_.get_statistics();
+        prefixes_out_ = 0;
+        auto start = std::chrono::steady_clock::now();
+        run();
+        Work work;
+        work.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        auto after = rib_.get_statistics();
+        work.decisions = after.decisions - before.decisions;
+        work.best_changes = after.best_path_changes - before.best_path_changes;
+        work.prefixes_out = prefixes_out_;
+        return work;
+    }
+
+    // Down, then up again with all its routes, each step one burst
+    void flap(const char* name, const PeerTable& peer, uint32_t router_id, bool rescan) {
+        std::string prefix = std::string(name) + (rescan ? " down, rescan" : " down");
+        print_row(prefix.c_str(), measure([&] {
+            rib_.remove_peer(peer.address);
+            export_changes(rescan);
+        }));
+        prefix = std::string(name) + (rescan ? " up, rescan" : " up");
+        print_row(prefix.c_str(), measure([&] {
+            rib_.add_peer(peer.address, router_id, false);
+            for (size_t group = 0; group < peer.groups.size(); ++group) {
+                announce(peer, group);
+            }
+            export_changes(rescan);
+        }));
+    }
+
+private:
+    BGPRib& rib_;
+    std::vector<BGPBestPathChange> changes_;
+    BGPRibOutUpdate update_;
+    uint64_t prefixes_out_ = 0;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t prefix_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 900000;
+    size_t peer_count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10;
+    size_t paths = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 5000;
+    size_t flapping_prefixes = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 1000;
+
+    std::mt19937 random(9);
+    BGPAttributeStore store;
+    auto prefixes = make_prefixes(prefix_count);
+    std::vector<PeerTable> peers;
+    for (size_t i = 0; i < peer_count; ++i) {
+        peers.push_back(make_peer(store, prefixes, static_cast<uint32_t>(i), paths, 1, random));
+    }
+    // The small peer: a slice of the table over shorter paths
+    std::vector<Ipv4Prefix> slice(prefixes.begin(), prefixes.begin() + std::min(flapping_prefixes, prefix_count));
+    peers.push_back(make_peer(store, slice, static_cast<uint32_t>(peer_count), paths, 0, random));
+    const PeerTable& small = peers.back();
+    uint32_t small_router_id = static_cast<uint32_t>(peers.size());
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "=== BGP RIB: " << peer_count << " peers x " << prefix_count << " prefixes, " << paths
+              << " paths per peer, flapping peer with " << slice.size() << " ===" << std::endl;
+
+    BGPRib rib;
+    Driver driver(rib);
+    for (size_t i = 0; i < peers.size(); ++i) {
+        rib.add_peer(peers[i].address, static_cast<uint32_t>(i + 1), false);
+    }
+    Work convergence = driver.measure([&] {
+        for (size_t group = 0; group < paths; ++group) {
+            for (const auto& peer : peers) {
+                if (group < peer.groups.size()) {
+                    driver.announce(peer, group);
+                }
+            }
+            driver.export_changes(false);
+        }
+    });
+    print_row("initial convergence", convergence);
+    auto stats = rib.get_statistics();
+    std::cout << std::setw(26) << "" << "  " << stats.paths / convergence.seconds / 1e6 << " M paths/s, "
+              << stats.prefixes << " prefixes, " << stats.paths << " paths" << std::endl;
+
+    driver.flap("small peer", small, small_router_id, false);
+    driver.flap("small peer", small, small_router_id, true);
+    driver.flap("full peer", peers.front(), 1, false);
+    driver.flap("full peer", peers.front(), 1, true);
+    return 0;
+}
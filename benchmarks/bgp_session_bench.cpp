@@ -0,0 +1,322 @@
+// BGP session engine benchmark: what an idle speaker costs with many
+// neighbors, and how long an UPDATE takes to reach the RIB.
+//
+// The event loop: a BGPProtocol with N passive neighbors on loopback
+// addresses 127.1.x.y, each driven by a raw peer socket here. Once every
+// session is Established the process sits idle for a while (only the
+// speaker's keepalive timers run) and its CPU time and loop wakeups are
+// reported. Then the peers send one UPDATE at a time and the delay from
+// write() to the route callback is recorded.
+//
+// Before: the three sleep-polling threads BGPProtocol used to run, over
+// the same number of neighbors, with the incoming-message poll reading
+// each neighbor's socket (one end of a socketpair) every 100 ms, as
+// process_incoming_messages() would have had to.
+//
+// Usage: bgp_session_bench [neighbors] [idle_seconds] [updates]
+
+#include "protocols/bgp.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace router_sim;
+
+namespace {
+
+const uint16_t PEER_AS = 65001;
+const uint16_t HOLD_TIME = 90;
+const auto UPDATE_GAP = std::chrono::microseconds(500);
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+double cpu_seconds() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+std::string peer_address(size_t i) {
+    return "127.1." + std::to_string(i / 250) + "." + std::to_string(i % 250 + 1);
+}
+
+std::vector<uint8_t> make_message(uint8_t type, const std::vector<uint8_t>& body) {
+    std::vector<uint8_t> message(16, 0xff);
+    size_t length = BGP_HEADER_SIZE + body.size();
+    message.push_back(static_cast<uint8_t>(length >> 8));
+    message.push_back(static_cast<uint8_t>(length));
+    message.push_back(type);
+    message.insert(message.end(), body.begin(), body.end());
+    return message;
+}
+
+std::vector<uint8_t> make_open(size_t i) {
+    uint32_t id = 0x01000000 + static_cast<uint32_t>(i);
+    return make_message(1, {4, PEER_AS >> 8, PEER_AS & 0xff, 0, HOLD_TIME, uint8_t(id >> 24), uint8_t(id >> 16),
+                            uint8_t(id >> 8), uint8_t(id), 8, 2, 6, 65, 4, 0, 0, PEER_AS >> 8, PEER_AS & 0xff});
+}
+
+// 20.k.k/24 from the peer, four-octet AS_PATH
+std::vector<uint8_t> make_update(uint32_t k, uint32_t next_hop) {
+    return make_message(2, {0, 0, 0, 20,
+                            0x40, 1, 1, 0,
+                            0x40, 2, 6, 2, 1, 0, 0, PEER_AS >> 8, PEER_AS & 0xff,
+                            0x40, 3, 4, uint8_t(next_hop >> 24), uint8_t(next_hop >> 16), uint8_t(next_hop >> 8),
+                            uint8_t(next_hop),
+                            24, 20, uint8_t(k >> 8), uint8_t(k)});
+}
+
+struct Latency {
+    double p50_ms;
+    double p99_ms;
+    double max_ms;
+};
+
+Latency summarize(const std::vector<uint64_t>& sent, const std::vector<uint64_t>& installed) {
+    std::vector<double> delays;
+    for (size_t i = 0; i < sent.size(); ++i) {
+        if (installed[i] >= sent[i]) {
+            delays.push_back((installed[i] - sent[i]) / 1e6);
+        }
+    }
+    if (delays.empty()) {
+        return Latency{0, 0, 0};
+    }
+    std::sort(delays.begin(), delays.end());
+    return Latency{delays[delays.size() / 2], delays[delays.size() * 99 / 100], delays.back()};
+}
+
+void print_row(const char* name, double cpu_percent, double wakeups_per_second, const Latency& latency) {
+    std::cout << std::setw(22) << name << ": idle CPU " << std::setw(6) << cpu_percent << " %, "
+              << std::setw(7) << wakeups_per_second << " wakeups/s, UPDATE->RIB p50 " << std::setw(7)
+              << latency.p50_ms << " ms, p99 " << std::setw(7) << latency.p99_ms << " ms, max " << std::setw(7)
+              << latency.max_ms << " ms" << std::endl;
+}
+
+// The removed design: three threads waking every 100 ms, 1 s and 100 ms
+void run_polling(size_t neighbors, int idle_seconds, size_t updates) {
+    std::map<std::string, BGPNeighbor> table;
+    std::vector<int> local(neighbors), remote(neighbors);
+    for (size_t i = 0; i < neighbors; ++i) {
+        BGPNeighbor neighbor{};
+        neighbor.address = peer_address(i);
+        neighbor.state = "Established";
+        neighbor.keepalive_interval = HOLD_TIME / 3;
+        table[neighbor.address] = neighbor;
+        int pair[2];
+        socketpair(AF_UNIX, SOCK_STREAM, 0, pair);
+        fcntl(pair[0], F_SETFL, O_NONBLOCK);
+        local[i] = pair[0];
+        remote[i] = pair[1];
+    }
+
+    std::mutex mutex;
+    std::atomic<bool> running(true);
+    std::atomic<uint64_t> wakeups(0);
+    std::vector<uint64_t> sent(updates, 0), installed(updates, 0);
+    std::atomic<size_t> received(0);
+
+    std::thread main_loop([&] {
+        std::vector<uint8_t> buffer(65536);
+        std::map<std::string, std::chrono::steady_clock::time_point> last_keepalive;
+        while (running.load()) {
+            wakeups++;
+            std::lock_guard<std::mutex> lock(mutex);
+            // process_incoming_messages()
+            size_t i = 0;
+            for (auto& pair : table) {
+                ssize_t n;
+                while ((n = read(local[i], buffer.data(), buffer.size())) > 0) {
+                    for (ssize_t offset = 0; offset + 47 <= n; offset += 47) {
+                        uint32_t k = (buffer[offset + 45] << 8) | buffer[offset + 46];
+                        if (k < updates) {
+                            installed[k] = now_ns();
+                            received++;
+                        }
+                    }
+                }
+                (void)pair;
+                i++;
+            }
+            // send_keepalives()
+            auto now = std::chrono::steady_clock::now();
+            for (auto& pair : table) {
+                if (pair.second.state == "Established" &&
+                    now - last_keepalive[pair.first] >= std::chrono::seconds(pair.second.keepalive_interval)) {
+                    last_keepalive[pair.first] = now;
+                }
+            }
+            mutex.unlock();
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            mutex.lock();
+        }
+    });
+    std::thread neighbor_loop([&] {
+        while (running.load()) {
+            wakeups++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+        }
+    });
+    std::thread route_loop([&] {
+        while (running.load()) {
+            wakeups++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    });
+
+    // Settle, so the first keepalive sweep is not counted as idle
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    double cpu_before = cpu_seconds();
+    uint64_t wakeups_before = wakeups.load();
+    std::this_thread::sleep_for(std::chrono::seconds(idle_seconds));
+    double cpu = cpu_seconds() - cpu_before;
+    double wakeup_rate = double(wakeups.load() - wakeups_before) / idle_seconds;
+
+    for (size_t k = 0; k < updates; ++k) {
+        auto message = make_update(static_cast<uint32_t>(k), 0x7f010000 + static_cast<uint32_t>(k % neighbors));
+        sent[k] = now_ns();
+        ssize_t written = write(remote[k % neighbors], message.data(), message.size());
+        (void)written;
+        std::this_thread::sleep_for(UPDATE_GAP);
+    }
+    while (received.load() < updates) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    running.store(false);
+    main_loop.join();
+    neighbor_loop.join();
+    route_loop.join();
+    for (size_t i = 0; i < neighbors; ++i) {
+        close(local[i]);
+        close(remote[i]);
+    }
+
+    print_row("sleep-polling threads", cpu / idle_seconds * 100, wakeup_rate, summarize(sent, installed));
+}
+
+void run_event_loop(size_t neighbors, int idle_seconds, size_t updates) {
+    // Quiet while thousands of neighbors are added and come up
+    std::streambuf* console = std::cout.rdbuf(nullptr);
+
+    BGPProtocol bgp;
+    bgp.initialize({{"local_as", "65000"}, {"router_id", "10.0.0.1"}, {"listen_address", "127.0.0.1"},
+                    {"listen_port", "0"}, {"hold_time", std::to_string(HOLD_TIME)}});
+    for (size_t i = 0; i < neighbors; ++i) {
+        bgp.add_neighbor(peer_address(i), {{"remote_as", std::to_string(PEER_AS)}, {"passive", "true"}});
+    }
+    std::atomic<size_t> established(0);
+    bgp.set_neighbor_callback([&](const NeighborInfo&, bool up) {
+        if (up) {
+            established++;
+        }
+    });
+    std::vector<uint64_t> sent(updates, 0), installed(updates, 0);
+    std::atomic<size_t> received(0);
+    bgp.set_route_update_callback([&](const RouteInfo& route, bool active) {
+        unsigned a, b, c, d;
+        if (active && sscanf(route.destination.c_str(), "%u.%u.%u.%u", &a, &b, &c, &d) == 4) {
+            size_t k = (b << 8) | c;
+            if (k < updates) {
+                installed[k] = now_ns();
+                received++;
+            }
+        }
+    });
+    bgp.start();
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<int> peers(neighbors);
+    for (size_t i = 0; i < neighbors; ++i) {
+        peers[i] = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        inet_pton(AF_INET, peer_address(i).c_str(), &address.sin_addr);
+        bind(peers[i], reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        address.sin_port = htons(bgp.get_listen_port());
+        inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+        if (connect(peers[i], reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            std::cout.rdbuf(console);
+            std::cerr << "peer " << i << " failed to connect: " << strerror(errno) << std::endl;
+            return;
+        }
+        auto open = make_open(i);
+        auto keepalive = make_message(4, {});
+        open.insert(open.end(), keepalive.begin(), keepalive.end());
+        ssize_t written = write(peers[i], open.data(), open.size());
+        (void)written;
+    }
+    while (established.load() < neighbors &&
+           std::chrono::steady_clock::now() - start < std::chrono::seconds(30)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    double setup = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    double cpu_before = cpu_seconds();
+    auto loop_before = bgp.get_event_loop_statistics();
+    std::this_thread::sleep_for(std::chrono::seconds(idle_seconds));
+    double cpu = cpu_seconds() - cpu_before;
+    auto loop_after = bgp.get_event_loop_statistics();
+
+    for (size_t k = 0; k < updates; ++k) {
+        auto message = make_update(static_cast<uint32_t>(k), 0x7f010000 + static_cast<uint32_t>(k % neighbors));
+        sent[k] = now_ns();
+        ssize_t written = write(peers[k % neighbors], message.data(), message.size());
+        (void)written;
+        std::this_thread::sleep_for(UPDATE_GAP);
+    }
+    while (received.load() < updates && std::chrono::steady_clock::now() - start < std::chrono::seconds(60)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    for (int fd : peers) {
+        close(fd);
+    }
+    bgp.stop();
+    std::cout.rdbuf(console);
+
+    std::cout << established.load() << " of " << neighbors << " sessions Established in " << setup * 1000
+              << " ms; idle: " << (loop_after.timers_fired - loop_before.timers_fired) << " timers fired (keepalives)"
+              << std::endl;
+    print_row("event loop", cpu / idle_seconds * 100,
+              double(loop_after.wakeups - loop_before.wakeups) / idle_seconds, summarize(sent, installed));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t neighbors = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+    int idle_seconds = argc > 2 ? std::atoi(argv[2]) : 30;
+    size_t updates = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 2000;
+    updates = std::min<size_t>(updates, 65536);
+
+    // Two descriptors per neighbor, and some
+    rlimit limit{};
+    getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "=== BGP: " << neighbors << " neighbors, hold time " << HOLD_TIME << " s, " << idle_seconds
+              << " s idle, " << updates << " UPDATEs ===" << std::endl;
+    run_polling(neighbors, idle_seconds, updates);
+    run_event_loop(neighbors, idle_seconds, updates);
+    return 0;
+}
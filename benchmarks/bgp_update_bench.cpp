@@ -0,0 +1,281 @@
+// BGP UPDATE codec benchmark: prefixes per second encoded into and parsed
+// out of UPDATE messages for a full-table-sized set of routes.
+//
+// The table has a realistic mix of prefix lengths (mostly /24) and shares
+// each attribute set (AS_PATH of 2-8 hops, MED, two communities) among a
+// handful of prefixes, as routes from one origin do. The codec encodes
+// each attribute set once into as few messages as fit and parses them
+// back through views into the message buffer. The baseline is the code
+// it replaced: BGPRoute strings in, per-attribute vectors out, and
+// (prefix string, length) pairs per parsed prefix. It never sent
+// communities, hence its smaller output.
+//
+// Usage: bgp_update_bench [prefixes]
+
+#include "protocols/bgp_update.h"
+#include <iostream>
+#include <iomanip>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace router_sim;
+using RouterSim::Ipv4Prefix;
+
+namespace {
+
+// Keeps the parsed values live
+volatile uint64_t sink;
+
+struct RouteGroup {
+    BGPPathAttributes attributes;
+    std::vector<Ipv4Prefix> prefixes;
+};
+
+std::vector<RouteGroup> make_table(size_t count) {
+    std::mt19937 random(7);
+    std::vector<RouteGroup> groups;
+    size_t made = 0;
+    while (made < count) {
+        RouteGroup group;
+        group.attributes.as_path.push_back(65000);
+        for (size_t hops = 1 + random() % 7; hops > 0; --hops) {
+            group.attributes.as_path.push_back(1 + random() % 400000);
+        }
+        group.attributes.next_hop = 0xc0000201;
+        group.attributes.has_med = true;
+        group.attributes.med = random() % 1000;
+        group.attributes.communities = {(65000u << 16) | static_cast<uint32_t>(random() % 100),
+                                        (65000u << 16) | 1000};
+        for (size_t n = std::min<size_t>(1 + random() % 16, count - made); n > 0; --n, ++made) {
+            uint32_t roll = random() % 100;
+            uint8_t length = roll < 60 ? 24 : roll < 70 ? 22 : roll < 80 ? 23 : roll < 90 ? 20 : 16 + random() % 4;
+            uint32_t address = (0x01000000 + random() % 0xdf000000) & ~((1u << (32 - length)) - 1);
+            group.prefixes.emplace_back(address, length);
+        }
+        groups.push_back(std::move(group));
+    }
+    return groups;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// --- The replaced encoder and decoder, as they were in bgp.cpp ---
+
+std::string format_ipv4(uint32_t address) {
+    in_addr value{};
+    value.s_addr = htonl(address);
+    char text[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &value, text, sizeof(text));
+    return text;
+}
+
+struct LegacyRoute {
+    std::string prefix;
+    uint8_t prefix_length;
+    uint32_t metric;
+};
+
+void put_u32(std::vector<uint8_t>& out, uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+void put_attribute(std::vector<uint8_t>& out, uint8_t flags, uint8_t type, const std::vector<uint8_t>& value) {
+    out.push_back(flags);
+    out.push_back(type);
+    out.push_back(static_cast<uint8_t>(value.size()));
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+size_t legacy_encode(const std::vector<LegacyRoute>& routes, const std::vector<uint32_t>& as_path,
+                     std::vector<std::vector<uint8_t>>& messages) {
+    std::map<uint32_t, std::vector<const LegacyRoute*>> by_metric;
+    for (const auto& route : routes) {
+        by_metric[route.metric].push_back(&route);
+    }
+    size_t sent = 0;
+    for (const auto& group : by_metric) {
+        std::vector<uint8_t> attributes;
+        put_attribute(attributes, 0x40, 1, {0});
+        std::vector<uint8_t> path = {2, static_cast<uint8_t>(as_path.size())};
+        for (uint32_t as : as_path) {
+            put_u32(path, as);
+        }
+        put_attribute(attributes, 0x40, 2, path);
+        std::vector<uint8_t> value;
+        put_u32(value, 0xc0000201);
+        put_attribute(attributes, 0x40, 3, value);
+        value.clear();
+        put_u32(value, group.first);
+        put_attribute(attributes, 0x80, 4, value);
+
+        std::vector<uint8_t> prefixes;
+        auto send = [&] {
+            std::vector<uint8_t> body = {0, 0, 0, static_cast<uint8_t>(attributes.size())};
+            body.insert(body.end(), attributes.begin(), attributes.end());
+            body.insert(body.end(), prefixes.begin(), prefixes.end());
+            messages.push_back(std::move(body));
+            prefixes.clear();
+            sent++;
+        };
+        for (const LegacyRoute* route : group.second) {
+            in_addr parsed{};
+            inet_pton(AF_INET, route->prefix.c_str(), &parsed);
+            uint32_t address = ntohl(parsed.s_addr);
+            size_t before = prefixes.size();
+            prefixes.push_back(route->prefix_length);
+            for (int i = 0; i < (route->prefix_length + 7) / 8; ++i) {
+                prefixes.push_back(static_cast<uint8_t>(address >> (24 - 8 * i)));
+            }
+            if (attributes.size() + prefixes.size() > BGP_MAX_MESSAGE_SIZE - BGP_HEADER_SIZE - 4) {
+                std::vector<uint8_t> last(prefixes.begin() + before, prefixes.end());
+                prefixes.resize(before);
+                send();
+                prefixes = last;
+            }
+        }
+        if (!prefixes.empty()) {
+            send();
+        }
+    }
+    return sent;
+}
+
+size_t legacy_parse(const std::vector<uint8_t>& body, uint64_t& checksum) {
+    const uint8_t* message = body.data();
+    const uint8_t* end = message + body.size();
+    size_t withdrawn_length = (message[0] << 8) | message[1];
+    const uint8_t* attributes = message + 4 + withdrawn_length;
+    size_t attributes_length = (message[2 + withdrawn_length] << 8) | message[3 + withdrawn_length];
+    const uint8_t* nlri = attributes + attributes_length;
+
+    std::vector<std::pair<std::string, uint8_t>> reachable;
+    for (const uint8_t* data = nlri; data < end;) {
+        uint8_t length = data[0];
+        uint32_t address = 0;
+        for (size_t i = 0; i < (length + 7u) / 8; ++i) {
+            address |= uint32_t(data[1 + i]) << (24 - 8 * i);
+        }
+        reachable.emplace_back(format_ipv4(address), length);
+        data += 1 + (length + 7) / 8;
+    }
+    std::vector<uint32_t> as_path;
+    uint32_t metric = 0;
+    for (const uint8_t* attribute = attributes; attribute < nlri;) {
+        size_t header = attribute[0] & 0x10 ? 4 : 3;
+        size_t value_length = header == 4 ? (attribute[2] << 8) | attribute[3] : attribute[2];
+        const uint8_t* value = attribute + header;
+        if (attribute[1] == 2) {
+            for (const uint8_t* segment = value; segment < value + value_length; segment += 2 + segment[1] * 4) {
+                for (size_t i = 0; i < segment[1]; ++i) {
+                    const uint8_t* as = segment + 2 + i * 4;
+                    as_path.push_back((uint32_t(as[0]) << 24) | (uint32_t(as[1]) << 16) | (as[2] << 8) | as[3]);
+                }
+            }
+        } else if (attribute[1] == 4) {
+            metric = (uint32_t(value[0]) << 24) | (uint32_t(value[1]) << 16) | (value[2] << 8) | value[3];
+        }
+        attribute = value + value_length;
+    }
+    for (const auto& prefix : reachable) {
+        checksum += prefix.first.size() + prefix.second + as_path.size() + metric;
+    }
+    return reachable.size();
+}
+
+void print_row(const char* name, size_t prefixes, double encode_seconds, double parse_seconds, size_t messages,
+               size_t bytes) {
+    std::cout << std::setw(8) << name << ": encode " << std::setw(7) << prefixes / encode_seconds / 1e6
+              << " M prefixes/s, parse " << std::setw(7) << prefixes / parse_seconds / 1e6 << " M prefixes/s, "
+              << messages << " UPDATEs, " << bytes / 1e6 << " MB" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    auto table = make_table(count);
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "=== BGP UPDATE codec: " << count << " prefixes in " << table.size() << " attribute sets ==="
+              << std::endl;
+
+    // Before
+    {
+        std::vector<std::vector<LegacyRoute>> routes(table.size());
+        for (size_t g = 0; g < table.size(); ++g) {
+            for (const auto& prefix : table[g].prefixes) {
+                routes[g].push_back({format_ipv4(prefix.address), prefix.length, table[g].attributes.med});
+            }
+        }
+        std::vector<std::vector<uint8_t>> messages;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t g = 0; g < table.size(); ++g) {
+            legacy_encode(routes[g], table[g].attributes.as_path, messages);
+        }
+        double encode_seconds = seconds_since(start);
+
+        uint64_t checksum = 0;
+        size_t parsed = 0;
+        start = std::chrono::steady_clock::now();
+        for (const auto& body : messages) {
+            parsed += legacy_parse(body, checksum);
+        }
+        double parse_seconds = seconds_since(start);
+        size_t bytes = 0;
+        for (const auto& body : messages) {
+            bytes += BGP_HEADER_SIZE + body.size();
+        }
+        if (parsed != count) {
+            std::cerr << "legacy parsed " << parsed << " prefixes" << std::endl;
+        }
+        sink = checksum;
+        print_row("before", count, encode_seconds, parse_seconds, messages.size(), bytes);
+    }
+
+    // Views and one reused buffer
+    {
+        BGPUpdateEncoder encoder;
+        std::vector<uint8_t> buffer;
+        buffer.reserve(count * 8);
+        size_t messages = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& group : table) {
+            messages += encoder.encode_announcements(group.attributes, group.prefixes.data(), group.prefixes.size(),
+                                                     buffer);
+        }
+        double encode_seconds = seconds_since(start);
+
+        BGPUpdate update;
+        uint64_t checksum = 0;
+        size_t parsed = 0;
+        start = std::chrono::steady_clock::now();
+        for (size_t offset = 0; offset < buffer.size();) {
+            size_t length = (buffer[offset + 16] << 8) | buffer[offset + 17];
+            if (!update.parse(buffer.data() + offset + BGP_HEADER_SIZE, length - BGP_HEADER_SIZE, true)) {
+                std::cerr << "parse failed: " << update.error_reason() << std::endl;
+                return 1;
+            }
+            size_t path_length = update.as_path().length();
+            for (BGPPrefix prefix : update.nlri()) {
+                checksum += prefix.ipv4() + prefix.length + path_length + update.med() + update.communities()[0];
+                parsed++;
+            }
+            offset += length;
+        }
+        double parse_seconds = seconds_since(start);
+        if (parsed != count) {
+            std::cerr << "parsed " << parsed << " prefixes" << std::endl;
+        }
+        sink = checksum;
+        print_row("views", count, encode_seconds, parse_seconds, messages, buffer.size());
+    }
+    return 0;
+}
@@ -0,0 +1,279 @@
+// BGP update group benchmark: the initial table transfer from a route
+// reflector-like speaker to many iBGP clients, with the clients in update
+// groups and with each client a group of its own.
+//
+// The speaker learns a table from one eBGP peer, then the clients connect
+// at once and each is sent the whole table. Grouped, its UPDATEs are
+// encoded once per group into one buffer that every member's session
+// writes out; ungrouped, each client has an Adj-RIB-Out and an encoding
+// of its own, as when every peer was sent its UPDATEs on its own. The
+// clients (and the eBGP peer) run in a second process, so the CPU time is
+// the speaker's alone: from the table being learned until every client has
+// read every prefix. Exports are batched every 100 ms, so clients that
+// come up together start in one group.
+//
+// Usage: bgp_update_group_bench [prefixes] [clients] [paths]
+
+#include "protocols/bgp.h"
+#include <iostream>
+#include <iomanip>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdlib>
+#include <netinet/in.h>
+#include <random>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace router_sim;
+using RouterSim::Ipv4Prefix;
+
+namespace {
+
+const uint16_t LOCAL_AS = 65000;
+const uint16_t FEEDER_AS = 65001;
+
+// The feeder's table as framed UPDATEs, two-octet AS numbers
+std::vector<uint8_t> make_table(size_t prefixes, size_t paths) {
+    std::mt19937 random(13);
+    std::vector<BGPPathAttributes> attributes(paths);
+    std::vector<std::vector<Ipv4Prefix>> groups(paths);
+    for (auto& path : attributes) {
+        path.as_path.push_back(FEEDER_AS);
+        for (size_t hops = random() % 5; hops > 0; --hops) {
+            path.as_path.push_back(1 + random() % 60000);
+        }
+        path.next_hop = 0x7f000002;
+        path.has_med = true;
+        path.med = random() % 100;
+    }
+    for (size_t made = 0; made < prefixes; ++made) {
+        groups[random() % paths].emplace_back(0x01000000 + static_cast<uint32_t>(made) * 256, 24);
+    }
+    BGPUpdateEncoder encoder;
+    encoder.set_four_octet_as(false);
+    std::vector<uint8_t> buffer;
+    for (size_t i = 0; i < paths; ++i) {
+        encoder.encode_announcements(attributes[i], groups[i].data(), groups[i].size(), buffer);
+    }
+    return buffer;
+}
+
+std::string client_address(size_t index) {
+    return "127.0." + std::to_string(1 + index / 250) + "." + std::to_string(1 + index % 250);
+}
+
+void put_message(std::vector<uint8_t>& out, uint8_t type, const std::vector<uint8_t>& body) {
+    out.insert(out.end(), 16, 0xff);
+    size_t length = BGP_HEADER_SIZE + body.size();
+    out.push_back(static_cast<uint8_t>(length >> 8));
+    out.push_back(static_cast<uint8_t>(length));
+    out.push_back(type);
+    out.insert(out.end(), body.begin(), body.end());
+}
+
+// Connected from source, OPEN (hold time 0: no keepalives) and KEEPALIVE sent
+int connect_peer(uint16_t port, const std::string& source, uint16_t as, uint32_t id) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    inet_pton(AF_INET, source.c_str(), &address.sin_addr);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        close(fd);
+        return -1;
+    }
+    address.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        close(fd);
+        return -1;
+    }
+    std::vector<uint8_t> out;
+    put_message(out, 1, {4, uint8_t(as >> 8), uint8_t(as), 0, 0, uint8_t(id >> 24), uint8_t(id >> 16),
+                         uint8_t(id >> 8), uint8_t(id), 0});
+    put_message(out, 4, {});
+    return write(fd, out.data(), out.size()) == ssize_t(out.size()) ? fd : -1;
+}
+
+struct Client {
+    int fd = -1;
+    std::vector<uint8_t> in;
+    size_t prefixes = 0;
+};
+
+// Takes the complete messages off the front of in, counting NLRI
+void read_updates(Client& client, BGPUpdate& update) {
+    size_t offset = 0;
+    while (client.in.size() - offset >= BGP_HEADER_SIZE) {
+        size_t length = (client.in[offset + 16] << 8) | client.in[offset + 17];
+        if (client.in.size() - offset < length) {
+            break;
+        }
+        if (client.in[offset + 18] == 2 &&
+            update.parse(client.in.data() + offset + BGP_HEADER_SIZE, length - BGP_HEADER_SIZE, false)) {
+            for (BGPPrefix prefix : update.nlri()) {
+                (void)prefix;
+                client.prefixes++;
+            }
+        }
+        offset += length;
+    }
+    client.in.erase(client.in.begin(), client.in.begin() + offset);
+}
+
+// The other end of the benchmark: the feeder once the speaker's port comes
+// from start, then on a byte from start every client until it has the
+// whole table, then a byte to done
+void run_peers(const std::vector<uint8_t>& table, size_t prefixes, size_t clients, int start, int done) {
+    uint16_t port = 0;
+    if (read(start, &port, sizeof(port)) != sizeof(port)) {
+        return;
+    }
+    int feeder = connect_peer(port, "127.0.0.2", FEEDER_AS, 0x02020202);
+    if (feeder < 0 || write(feeder, table.data(), table.size()) != ssize_t(table.size())) {
+        std::cerr << "feeder failed" << std::endl;
+        return;
+    }
+    char byte;
+    if (read(start, &byte, 1) != 1) {
+        return;
+    }
+
+    int epoll_fd = epoll_create1(0);
+    std::vector<Client> peers(clients);
+    for (size_t i = 0; i < clients; ++i) {
+        peers[i].fd = connect_peer(port, client_address(i), LOCAL_AS, static_cast<uint32_t>(0x0a000001 + i));
+        if (peers[i].fd < 0) {
+            std::cerr << "client " << client_address(i) << " failed" << std::endl;
+            return;
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = i;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, peers[i].fd, &event);
+    }
+
+    BGPUpdate update;
+    size_t complete = 0;
+    uint8_t buffer[65536];
+    epoll_event events[64];
+    while (complete < clients) {
+        int ready = epoll_wait(epoll_fd, events, 64, 10000);
+        if (ready <= 0) {
+            std::cerr << "timed out with " << complete << " clients complete" << std::endl;
+            return;
+        }
+        for (int i = 0; i < ready; ++i) {
+            Client& client = peers[events[i].data.u64];
+            ssize_t n = read(client.fd, buffer, sizeof(buffer));
+            if (n <= 0) {
+                std::cerr << "client closed" << std::endl;
+                return;
+            }
+            bool was_complete = client.prefixes >= prefixes;
+            client.in.insert(client.in.end(), buffer, buffer + n);
+            read_updates(client, update);
+            if (!was_complete && client.prefixes >= prefixes) {
+                complete++;
+            }
+        }
+    }
+    byte = 1;
+    (void)!write(done, &byte, 1);
+    // Open until the speaker has measured
+    (void)!read(start, &byte, 1);
+}
+
+double cpu_seconds() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+// One speaker process: the route reflector on this side, the peers in a
+// child forked before the speaker has threads
+void run_speaker(bool update_groups, const std::vector<uint8_t>& table, size_t prefixes, size_t clients) {
+    int start[2], done[2];
+    if (pipe(start) < 0 || pipe(done) < 0) {
+        return;
+    }
+    pid_t child = fork();
+    if (child == 0) {
+        run_peers(table, prefixes, clients, start[0], done[1]);
+        std::_Exit(0);
+    }
+
+    std::streambuf* out = std::cout.rdbuf(nullptr);       // the speaker's neighbor and route log
+    BGPProtocol bgp;
+    bgp.initialize({{"local_as", std::to_string(LOCAL_AS)}, {"router_id", "1.1.1.1"},
+                    {"listen_address", "127.0.0.1"}, {"listen_port", "0"}, {"update_interval_ms", "100"},
+                    {"update_groups", update_groups ? "true" : "false"}});
+    bgp.add_neighbor("127.0.0.2", {{"remote_as", std::to_string(FEEDER_AS)}, {"passive", "true"}});
+    for (size_t i = 0; i < clients; ++i) {
+        bgp.add_neighbor(client_address(i), {{"remote_as", std::to_string(LOCAL_AS)}, {"passive", "true"}});
+    }
+    bgp.start();
+    uint16_t port = bgp.get_listen_port();
+    (void)!write(start[1], &port, sizeof(port));
+    while (bgp.get_rib_statistics().prefixes < prefixes) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    double cpu_before = cpu_seconds();
+    auto wall_before = std::chrono::steady_clock::now();
+    char byte = 1;
+    (void)!write(start[1], &byte, 1);
+    bool completed = read(done[0], &byte, 1) == 1;
+    double cpu = cpu_seconds() - cpu_before;
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_before).count();
+    auto rib = bgp.get_rib_statistics();
+    auto stats = bgp.get_statistics();
+    (void)!write(start[1], &byte, 1);
+    waitpid(child, nullptr, 0);
+    bgp.stop();
+    std::cout.rdbuf(out);
+
+    if (!completed) {
+        std::cout << std::setw(10) << (update_groups ? "grouped" : "per peer") << ": incomplete" << std::endl;
+        return;
+    }
+    std::cout << std::setw(10) << (update_groups ? "grouped" : "per peer") << ": " << std::setw(8) << cpu * 1e3
+              << " ms speaker CPU, " << std::setw(8) << wall * 1e3 << " ms wall, " << std::setw(9)
+              << prefixes * clients / cpu / 1e6 << " M prefixes sent per CPU second, " << rib.update_groups
+              << " update groups after, " << stats.neighbor_up_count << " peers up" << std::endl;
+}
+
+template <typename Run>
+void in_child(Run run) {
+    std::cout.flush();
+    pid_t child = fork();
+    if (child == 0) {
+        run();
+        std::cout.flush();
+        std::_Exit(0);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t prefixes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 50000;
+    size_t clients = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 500;
+    size_t paths = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 2000;
+    auto table = make_table(prefixes, paths);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "=== BGP update groups: " << prefixes << " prefixes over " << paths << " paths to " << clients
+              << " iBGP clients ===" << std::endl;
+    in_child([&] { run_speaker(false, table, prefixes, clients); });
+    in_child([&] { run_speaker(true, table, prefixes, clients); });
+    return 0;
+}
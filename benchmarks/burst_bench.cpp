@@ -0,0 +1,154 @@
+// Burst processing benchmark: compares per-packet calls against the burst
+// entry points of SimpleRouter, TrafficShaper and WeightedFairQueue at
+// burst sizes 1, 8, 32 and 256.
+//
+// Usage: burst_bench [packet_count]
+
+#include "router_simple.h"
+#include "traffic_shaping.h"
+#include "traffic_shaping/wfq.h"
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <chrono>
+#include <vector>
+#include <cstdlib>
+
+using namespace RouterSim;
+
+namespace {
+
+const size_t BURST_SIZES[] = {1, 8, 32, 256};
+
+std::vector<PacketDescriptor> make_packets(size_t count, std::mt19937& rng) {
+    std::vector<PacketDescriptor> packets(count);
+    for (size_t i = 0; i < count; ++i) {
+        PacketDescriptor& packet = packets[i];
+        packet = PacketDescriptor{};
+        packet.set_ipv4(rng(), rng());
+        packet.id = i;
+        packet.size = 64 + rng() % 1400;
+        packet.priority = rng() % 8;
+        packet.dscp = static_cast<uint8_t>((rng() % 4) * 16);
+        packet.protocol = 17;
+    }
+    return packets;
+}
+
+void print_row(const std::string& name, size_t burst, size_t packets, double seconds) {
+    std::cout << "  " << std::left << std::setw(22) << name
+              << std::right << std::setw(6) << burst
+              << std::setw(12) << std::fixed << std::setprecision(2) << packets / seconds / 1e6 << " Mpps"
+              << std::setw(10) << std::setprecision(1) << seconds * 1e9 / packets << " ns/pkt" << std::endl;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t packet_count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    packet_count -= packet_count % 256;
+
+    std::mt19937 rng(1);
+    auto packets = make_packets(packet_count, rng);
+
+    // SimpleRouter with a 100k-prefix table
+    SimpleRouter router;
+    std::cout.setstate(std::ios::failbit);
+    router.start();
+    router.add_route("0.0.0.0/0", "192.0.2.1");
+    for (int i = 0; i < 100000; ++i) {
+        uint32_t address = rng() & 0xFFFFFF00u;
+        router.add_route(format_ipv4_address(address) + "/24", "198.51.100." + std::to_string(i % 200));
+    }
+    std::cout.clear();
+
+    std::cout << "SimpleRouter (100k routes, " << packet_count << " packets)" << std::endl;
+    {
+        auto start = std::chrono::steady_clock::now();
+        size_t forwarded = 0;
+        for (const auto& packet : packets) {
+            forwarded += router.process_packet(packet);
+        }
+        print_row("process_packet", 1, packet_count, seconds_since(start));
+        (void)forwarded;
+    }
+    for (size_t burst : BURST_SIZES) {
+        BurstVerdict verdicts;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < packet_count; i += burst) {
+            router.process_burst(&packets[i], burst, verdicts);
+        }
+        print_row("process_burst", burst, packet_count, seconds_since(start));
+    }
+
+    // TrafficShaper: bucket sized so nothing is rate-limited; the WFQ
+    // counters are reset between chunks outside the timed region
+    const size_t chunk = 31 * 256;
+    TrafficShaper shaper;
+    shaper.initialize();
+    shaper.setTokenBucketConfig(1000000000000000ULL, 1000000000000000ULL, 1000000000000000ULL);
+    shaper.setEnabled(true);
+
+    std::cout << std::endl << "TrafficShaper" << std::endl;
+    {
+        double elapsed = 0;
+        for (size_t base = 0; base + chunk <= packet_count; base += chunk) {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = base; i < base + chunk; ++i) {
+                shaper.processPacket(packets[i]);
+            }
+            elapsed += seconds_since(start);
+            shaper.reset();
+        }
+        print_row("processPacket", 1, packet_count / chunk * chunk, elapsed);
+    }
+    for (size_t burst : BURST_SIZES) {
+        BurstVerdict verdicts;
+        double elapsed = 0;
+        for (size_t base = 0; base + chunk <= packet_count; base += chunk) {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = base; i < base + chunk; i += burst) {
+                shaper.processBurst(&packets[i], burst, verdicts);
+            }
+            elapsed += seconds_since(start);
+            shaper.reset();
+        }
+        print_row("processBurst", burst, packet_count / chunk * chunk, elapsed);
+    }
+
+    // WeightedFairQueue: enqueue then drain
+    std::vector<WFQClass> classes(3);
+    for (uint8_t i = 0; i < 3; ++i) {
+        classes[i].class_id = i + 1;
+        classes[i].weight = 10 / (i + 1);
+    }
+    WeightedFairQueue wfq;
+    wfq.initialize(classes);
+
+    std::cout << std::endl << "WeightedFairQueue (enqueue + dequeue)" << std::endl;
+    {
+        PacketDescriptor out;
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& packet : packets) {
+            wfq.enqueue_packet(packet, wfq.classify_packet(packet));
+            wfq.dequeue_packet(out);
+        }
+        print_row("enqueue/dequeue_packet", 1, packet_count, seconds_since(start));
+    }
+    for (size_t burst : BURST_SIZES) {
+        BurstVerdict verdicts;
+        std::vector<PacketDescriptor> out(burst);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < packet_count; i += burst) {
+            wfq.enqueue_burst(&packets[i], burst, verdicts);
+            wfq.dequeue_burst(out.data(), burst);
+        }
+        print_row("enqueue/dequeue_burst", burst, packet_count, seconds_since(start));
+    }
+
+    return 0;
+}
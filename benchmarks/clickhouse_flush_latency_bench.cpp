@@ -0,0 +1,94 @@
+// ClickHouse flush latency benchmark: what insert_metric() costs the
+// calling thread when the server is slow, with flushes on the caller's
+// thread (background = false, the old behaviour) and on the flusher
+// thread.
+//
+// The in-memory stand-in for clickhouse-cpp in tests/mock is made to take
+// a fixed time per block, like a round trip to a remote server. A caller
+// inserts metrics at a steady rate: below one full batch per round trip,
+// above it (the background flusher then sends larger blocks, up to
+// max_buffered_batches batches), and far enough above that it must drop.
+// Reported per run: caller latency percentiles per insert, rows the
+// server received, and rows dropped on backpressure.
+//
+// Usage: clickhouse_flush_latency_bench [seconds_per_run] [server_ms_per_block]
+
+#include "analytics/clickhouse_client.h"
+#include <clickhouse/client.h>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace RouterSim;
+
+namespace {
+
+void run(const char* mode, bool background, uint64_t rows_per_second, double seconds, uint32_t server_ms) {
+    auto& server = clickhouse::MockServer::instance();
+    server.reset();
+    server.on_insert = [server_ms](const std::string&, const clickhouse::Block&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(server_ms));
+    };
+
+    ClickHouseClient client;
+    ClickHouseFlushOptions options;
+    options.background = background;
+    client.connect(options);
+
+    NetworkMetric metric;
+    metric.router_id = "router-1";
+    metric.interface = "eth0";
+    metric.metric_type = "rx_bytes";
+
+    // Paced in ticks of 100 rows so the caller sleeps between them
+    const uint64_t TICK_ROWS = 100;
+    uint64_t total = static_cast<uint64_t>(rows_per_second * seconds);
+    auto tick = std::chrono::nanoseconds(1000000000ull * TICK_ROWS / rows_per_second);
+    std::vector<double> latencies;
+    latencies.reserve(total);
+    auto next = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < total; ++i) {
+        if (i % TICK_ROWS == 0) {
+            std::this_thread::sleep_until(next);
+            next += tick;
+        }
+        metric.timestamp = i;
+        metric.value = double(i);
+        auto start = std::chrono::steady_clock::now();
+        client.insert_metric(metric);
+        latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    client.disconnect();
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) { return latencies[static_cast<size_t>(p * (latencies.size() - 1))]; };
+    auto stats = client.get_statistics();
+    std::cout << std::setw(10) << mode << ", " << std::setw(7) << rows_per_second << " rows/s: p50 "
+              << std::setw(7) << percentile(0.50) << " us  p99 " << std::setw(7) << percentile(0.99)
+              << " us  p999 " << std::setw(8) << percentile(0.999) << " us  max " << std::setw(8)
+              << latencies.back() << " us, inserted " << stats.rows_inserted << ", dropped "
+              << stats.rows_dropped << std::endl;
+    server.reset();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    double seconds = argc > 1 ? std::atof(argv[1]) : 2.0;
+    uint32_t server_ms = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+    // One full batch per round trip
+    uint64_t capacity = ClickHouseClient::METRIC_BATCH_ROWS * 1000 / std::max<uint32_t>(server_ms, 1);
+
+    std::cout << "server takes " << server_ms << " ms per block, one batch per round trip is " << capacity
+              << " rows/s" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    for (uint64_t rate : {capacity / 2, capacity * 2, capacity * 8}) {
+        run("caller", false, rate, seconds, server_ms);
+        run("background", true, rate, seconds, server_ms);
+    }
+    return 0;
+}
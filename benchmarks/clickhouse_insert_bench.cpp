@@ -0,0 +1,177 @@
+// ClickHouse insert path benchmark, against the in-memory stand-in for
+// clickhouse-cpp in tests/mock (which serializes each block the way the
+// native protocol lays it out, then discards it).
+//
+// "columnar" is ClickHouseClient: rows are appended straight into the
+// table's columns and each full batch is sent as one block. "rows" is the
+// layout it replaced: rows buffered as structs and transposed into freshly
+// built columns at every flush. Reported per table: rows/s through insert
+// plus flush, ns per row, and bytes per row on the wire.
+//
+// Usage: clickhouse_insert_bench [rows]
+
+#include "analytics/clickhouse_client.h"
+#include <clickhouse/client.h>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+using namespace RouterSim;
+
+namespace {
+
+using LowCardinalityString = clickhouse::ColumnLowCardinalityT<clickhouse::ColumnString>;
+
+std::vector<NetworkMetric> make_metrics(size_t count) {
+    std::vector<NetworkMetric> metrics(count);
+    for (size_t i = 0; i < count; ++i) {
+        NetworkMetric& metric = metrics[i];
+        metric.timestamp = 1700000000000ull + i;
+        metric.router_id = "router-" + std::to_string(i % 16);
+        metric.interface = "eth" + std::to_string(i % 48);
+        metric.metric_type = i % 2 ? "rx_bytes" : "tx_bytes";
+        metric.value = double(i) * 1.5;
+        metric.tags = {{"site", "lab"}, {"rack", std::to_string(i % 8)}};
+    }
+    return metrics;
+}
+
+std::vector<PacketFlow> make_flows(size_t count) {
+    std::vector<PacketFlow> flows(count);
+    for (size_t i = 0; i < count; ++i) {
+        PacketFlow& flow = flows[i];
+        flow.timestamp = 1700000000000ull + i;
+        flow.src_ip = "10.0." + std::to_string(i / 256 % 256) + "." + std::to_string(i % 256);
+        flow.dst_ip = "192.168.1." + std::to_string(i % 200);
+        flow.src_port = static_cast<uint16_t>(1024 + i % 60000);
+        flow.dst_port = 443;
+        flow.protocol = 6;
+        flow.bytes = 1500 * (i % 100);
+        flow.packets = i % 100;
+        flow.duration_ms = i % 5000;
+        flow.router_id = "router-" + std::to_string(i % 16);
+    }
+    return flows;
+}
+
+// The replaced layout: transpose buffered structs into new columns per flush
+void insert_metric_rows(clickhouse::Client& client, const std::vector<NetworkMetric>& rows) {
+    auto timestamp = std::make_shared<clickhouse::ColumnUInt64>();
+    auto router_id = std::make_shared<LowCardinalityString>();
+    auto interface = std::make_shared<LowCardinalityString>();
+    auto metric_type = std::make_shared<LowCardinalityString>();
+    auto value = std::make_shared<clickhouse::ColumnFloat64>();
+    auto tags = std::make_shared<clickhouse::ColumnMapT<clickhouse::ColumnString, clickhouse::ColumnString>>(
+        std::make_shared<clickhouse::ColumnString>(), std::make_shared<clickhouse::ColumnString>());
+    for (const auto& metric : rows) {
+        timestamp->Append(metric.timestamp);
+        router_id->Append(metric.router_id);
+        interface->Append(metric.interface);
+        metric_type->Append(metric.metric_type);
+        value->Append(metric.value);
+        tags->Append(metric.tags);
+    }
+    clickhouse::Block block;
+    block.AppendColumn("timestamp", timestamp);
+    block.AppendColumn("router_id", router_id);
+    block.AppendColumn("interface", interface);
+    block.AppendColumn("metric_type", metric_type);
+    block.AppendColumn("value", value);
+    block.AppendColumn("tags", tags);
+    client.Insert("network_metrics", block);
+}
+
+void insert_flow_rows(clickhouse::Client& client, const std::vector<PacketFlow>& rows) {
+    auto timestamp = std::make_shared<clickhouse::ColumnUInt64>();
+    auto src_ip = std::make_shared<clickhouse::ColumnString>();
+    auto dst_ip = std::make_shared<clickhouse::ColumnString>();
+    auto src_port = std::make_shared<clickhouse::ColumnUInt16>();
+    auto dst_port = std::make_shared<clickhouse::ColumnUInt16>();
+    auto protocol = std::make_shared<clickhouse::ColumnUInt8>();
+    auto bytes = std::make_shared<clickhouse::ColumnUInt64>();
+    auto packets = std::make_shared<clickhouse::ColumnUInt64>();
+    auto duration_ms = std::make_shared<clickhouse::ColumnUInt64>();
+    auto router_id = std::make_shared<LowCardinalityString>();
+    for (const auto& flow : rows) {
+        timestamp->Append(flow.timestamp);
+        src_ip->Append(flow.src_ip);
+        dst_ip->Append(flow.dst_ip);
+        src_port->Append(flow.src_port);
+        dst_port->Append(flow.dst_port);
+        protocol->Append(flow.protocol);
+        bytes->Append(flow.bytes);
+        packets->Append(flow.packets);
+        duration_ms->Append(flow.duration_ms);
+        router_id->Append(flow.router_id);
+    }
+    clickhouse::Block block;
+    block.AppendColumn("timestamp", timestamp);
+    block.AppendColumn("src_ip", src_ip);
+    block.AppendColumn("dst_ip", dst_ip);
+    block.AppendColumn("src_port", src_port);
+    block.AppendColumn("dst_port", dst_port);
+    block.AppendColumn("protocol", protocol);
+    block.AppendColumn("bytes", bytes);
+    block.AppendColumn("packets", packets);
+    block.AppendColumn("duration_ms", duration_ms);
+    block.AppendColumn("router_id", router_id);
+    client.Insert("packet_flows", block);
+}
+
+template <typename Row, typename InsertBlock>
+double run_rows(const std::vector<Row>& rows, InsertBlock insert_block) {
+    clickhouse::Client client{clickhouse::ClientOptions()};
+    std::vector<Row> buffer;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& row : rows) {
+        buffer.push_back(row);
+        if (buffer.size() >= ClickHouseClient::METRIC_BATCH_ROWS) {
+            insert_block(client, buffer);
+            buffer.clear();
+        }
+    }
+    if (!buffer.empty()) {
+        insert_block(client, buffer);
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename Row, typename Insert>
+double run_columnar(const std::vector<Row>& rows, Insert insert) {
+    ClickHouseClient client;
+    client.connect();
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& row : rows) {
+        (client.*insert)(row);
+    }
+    client.flush_all_buffers();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char* table, const char* layout, size_t rows, double seconds) {
+    auto& server = clickhouse::MockServer::instance();
+    std::cout << std::setw(13) << table << ", " << std::setw(8) << layout << ": " << std::setw(6)
+              << rows / seconds / 1e6 << " M rows/s, " << std::setw(6) << seconds * 1e9 / rows << " ns/row, "
+              << std::setw(5) << double(server.wire_bytes) / rows << " B/row, " << server.inserts << " blocks"
+              << std::endl;
+    server.reset();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    auto metrics = make_metrics(count);
+    auto flows = make_flows(count);
+
+    std::cout << std::fixed << std::setprecision(2);
+    for (int round = 0; round < 2; ++round) {
+        report("metrics", "rows", count, run_rows(metrics, insert_metric_rows));
+        report("metrics", "columnar", count, run_columnar(metrics, &ClickHouseClient::insert_metric));
+        report("packet_flows", "rows", count, run_rows(flows, insert_flow_rows));
+        report("packet_flows", "columnar", count, run_columnar(flows, &ClickHouseClient::insert_packet_flow));
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+// IPv4 FIB micro-benchmark: builds a synthetic full-size table and reports
+// build time, memory footprint and longest-prefix-match lookups per second.
+//
+// Usage: fib_bench [prefix_count] [lookup_count]
+
+#include "routing/fib.h"
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <chrono>
+#include <vector>
+#include <cstdlib>
+
+using namespace RouterSim;
+
+namespace {
+
+// Rough prefix-length mix of a global IPv4 table
+uint8_t random_prefix_length(std::mt19937& rng) {
+    uint32_t roll = rng() % 1000;
+    if (roll < 600) return 24;
+    if (roll < 700) return 23;
+    if (roll < 800) return 22;
+    if (roll < 850) return 21;
+    if (roll < 890) return 20;
+    if (roll < 960) return 16 + rng() % 4;
+    if (roll < 990) return 8 + rng() % 8;
+    return 25 + rng() % 8;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t prefix_count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 900000;
+    size_t lookup_count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20000000;
+
+    std::mt19937 rng(42);
+    Ipv4Fib fib;
+
+    auto start = std::chrono::steady_clock::now();
+    fib.insert(0, 0, 0);
+    while (fib.size() < prefix_count) {
+        uint8_t length = random_prefix_length(rng);
+        uint32_t address = rng() & (0xFFFFFFFFu << (32 - length));
+        fib.insert(address, length, rng() % 256);
+    }
+    auto inserted = std::chrono::steady_clock::now();
+    fib.build();
+    auto built = std::chrono::steady_clock::now();
+
+    // Pre-generate addresses so the timed loop measures lookups only
+    std::vector<uint32_t> addresses(1 << 20);
+    for (auto& address : addresses) {
+        address = rng();
+    }
+
+    uint64_t checksum = 0;
+    auto lookup_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lookup_count; ++i) {
+        checksum += fib.lookup(addresses[i & (addresses.size() - 1)]);
+    }
+    auto lookup_end = std::chrono::steady_clock::now();
+
+    double insert_ms = std::chrono::duration<double, std::milli>(inserted - start).count();
+    double build_ms = std::chrono::duration<double, std::milli>(built - inserted).count();
+    double lookup_s = std::chrono::duration<double>(lookup_end - lookup_start).count();
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Prefixes:        " << fib.size() << std::endl;
+    std::cout << "Insert time:     " << insert_ms << " ms" << std::endl;
+    std::cout << "Build time:      " << build_ms << " ms" << std::endl;
+    std::cout << "Nodes / leaves:  " << fib.node_count() << " / " << fib.leaf_count() << std::endl;
+    std::cout << "Memory:          " << fib.memory_usage() / (1024.0 * 1024.0) << " MiB" << std::endl;
+    std::cout << "Lookups:         " << lookup_count << std::endl;
+    std::cout << "Lookup rate:     " << lookup_count / lookup_s / 1e6 << " M lookups/sec" << std::endl;
+    std::cout << "Checksum:        " << checksum << std::endl;
+
+    return 0;
+}
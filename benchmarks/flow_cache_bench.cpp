@@ -0,0 +1,158 @@
+// Flow cache benchmark: cost per packet of aggregating into FlowCache, and
+// how many analytics rows are left.
+//
+// Packets are drawn from a Zipf-like flow popularity (a few heavy flows,
+// a long tail of small ones) over populations smaller and larger than the
+// cache, stamped at 10 Mpps and fed in bursts of MAX_BURST_SIZE. Reported
+// per run: ns per packet, hit rate, evictions per new flow, and exported
+// records against packets.
+//
+// Then the path into ClickHouse, against the in-memory stand-in for
+// clickhouse-cpp in tests/mock: one insert_packet_flow() per packet as
+// before, against the cache in front exporting one row per flow.
+//
+// Usage: flow_cache_bench [packets] [cache_capacity]
+
+#include "analytics/flow_cache.h"
+#include "analytics/clickhouse_client.h"
+#include <clickhouse/client.h>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace RouterSim;
+
+namespace {
+
+const uint64_t PACKET_INTERVAL_NS = 100;        // 10 Mpps
+
+std::vector<PacketDescriptor> make_packets(size_t count, uint32_t flows, double skew, uint32_t seed) {
+    std::vector<double> cumulative(flows);
+    double total = 0;
+    for (uint32_t i = 0; i < flows; ++i) {
+        total += 1.0 / std::pow(i + 1, skew);
+        cumulative[i] = total;
+    }
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> uniform(0, total);
+
+    std::vector<PacketDescriptor> packets(count);
+    uint64_t start = packet_clock_ns();
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t flow = static_cast<uint32_t>(
+            std::lower_bound(cumulative.begin(), cumulative.end(), uniform(rng)) - cumulative.begin());
+        // Scatter flow numbers over addresses and ports
+        uint32_t scrambled = flow * 2654435761u;
+        PacketDescriptor& packet = packets[i];
+        packet.set_ipv4(0x0a000000 | (scrambled >> 16), 0xc0a80000 | (flow & 0xffff));
+        packet.src_port = static_cast<uint16_t>(1024 + scrambled % 50000);
+        packet.dst_port = flow % 3 ? 443 : 53;
+        packet.protocol = flow % 3 ? 6 : 17;
+        packet.size = 64 + static_cast<uint32_t>(flow % 1400);
+        packet.timestamp_ns = start + i * PACKET_INTERVAL_NS;
+    }
+    return packets;
+}
+
+void run_cache(const char* name, const std::vector<PacketDescriptor>& packets, size_t capacity) {
+    FlowCacheOptions options;
+    options.capacity = capacity;
+    uint64_t records = 0;
+    FlowCache cache(options, [&records](const FlowRecord&) { records++; });
+
+    for (size_t i = 0; i < packets.size(); i += MAX_BURST_SIZE) {
+        cache.update_burst(&packets[i], std::min(MAX_BURST_SIZE, packets.size() - i));
+    }
+    auto stats = cache.get_statistics();
+    cache.flush();
+    std::cout << std::setw(22) << name << ": " << std::setw(5) << stats.ns_per_packet << " ns/pkt, hit rate "
+              << std::setw(6) << stats.hit_rate * 100 << " %, evictions/new flow " << std::setw(6)
+              << stats.eviction_rate * 100 << " %, " << records << " records for " << packets.size()
+              << " packets (" << double(packets.size()) / records << " packets/row)" << std::endl;
+}
+
+void run_clickhouse(const std::vector<PacketDescriptor>& packets, size_t capacity) {
+    auto& server = clickhouse::MockServer::instance();
+    // Flushing on this thread, so no row is dropped and all of the cost is counted
+    ClickHouseFlushOptions flush;
+    flush.background = false;
+
+    // Before: every packet event is a row
+    server.reset();
+    {
+        ClickHouseClient client;
+        client.connect(flush);
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& packet : packets) {
+            PacketFlow flow;
+            flow.timestamp = packet.timestamp_ns / 1000000;
+            flow.src_ip = format_ip_address(packet.src_addr);
+            flow.dst_ip = format_ip_address(packet.dst_addr);
+            flow.src_port = packet.src_port;
+            flow.dst_port = packet.dst_port;
+            flow.protocol = packet.protocol;
+            flow.bytes = packet.size;
+            flow.packets = 1;
+            flow.router_id = "router-1";
+            client.insert_packet_flow(flow);
+        }
+        client.disconnect();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << std::setw(22) << "row per packet" << ": " << std::setw(5) << seconds * 1e9 / packets.size()
+                  << " ns/pkt, " << server.rows << " rows, " << server.wire_bytes / 1e6 << " MB on the wire"
+                  << std::endl;
+    }
+
+    // After: the cache in front
+    server.reset();
+    {
+        ClickHouseClient client;
+        client.connect(flush);
+        FlowCacheOptions options;
+        options.capacity = capacity;
+        FlowCache cache(options, [&client](const FlowRecord& record) {
+            client.insert_packet_flow(to_packet_flow(record, "router-1"));
+        });
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < packets.size(); i += MAX_BURST_SIZE) {
+            cache.update_burst(&packets[i], std::min(MAX_BURST_SIZE, packets.size() - i));
+        }
+        cache.flush();
+        client.disconnect();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << std::setw(22) << "flow cache" << ": " << std::setw(5) << seconds * 1e9 / packets.size()
+                  << " ns/pkt, " << server.rows << " rows, " << server.wire_bytes / 1e6 << " MB on the wire"
+                  << std::endl;
+    }
+    server.reset();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4000000;
+    size_t capacity = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 65536;
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << count << " packets, cache of " << capacity << " flows" << std::endl;
+    struct Workload {
+        const char* name;
+        uint32_t flows;
+        double skew;
+    };
+    for (const Workload& workload : {Workload{"10k flows, zipf 1.1", 10000, 1.1},
+                                     Workload{"100k flows, zipf 1.1", 100000, 1.1},
+                                     Workload{"1M flows, zipf 1.1", 1000000, 1.1},
+                                     Workload{"1M flows, zipf 0.8", 1000000, 0.8}}) {
+        run_cache(workload.name, make_packets(count, workload.flows, workload.skew, 1), capacity);
+    }
+
+    std::cout << "into ClickHouse, 100k flows, zipf 1.1:" << std::endl;
+    run_clickhouse(make_packets(count / 4, 100000, 1.1, 2), capacity);
+    return 0;
+}
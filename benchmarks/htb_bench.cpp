@@ -0,0 +1,141 @@
+// HTB benchmark: per-packet cost of HierarchicalTokenBucket with 10k leaf
+// classes (interface -> 100 tenants -> 100 classes), with ancestor charges
+// applied per packet and in batches.
+//
+// Half of the leaves are active, so active leaves borrow the idle ones'
+// bandwidth from their tenant and the interface. The link is simulated:
+// each dequeue advances a virtual clock by the packet's transmission time.
+//
+// Usage: htb_bench [packets]
+
+#include "traffic_shaping/htb.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace RouterSim;
+
+namespace {
+
+const uint64_t LINK_RATE = 100000000000ULL;   // 100 Gb/s
+const uint32_t TENANTS = 100;
+const uint32_t LEAVES_PER_TENANT = 100;
+
+// Linux-style default bursts: one timer tick (1 ms) at the rate plus an MTU
+void set_bursts(HTBClassConfig& config) {
+    config.burst = static_cast<uint32_t>(config.rate / 8000 + 1514);
+    config.cburst = static_cast<uint32_t>(std::max(config.ceil, config.rate) / 8000 + 1514);
+}
+
+std::vector<HTBClassConfig> make_tree() {
+    std::vector<HTBClassConfig> classes;
+
+    HTBClassConfig root;
+    root.class_id = 1;
+    root.name = "eth0";
+    root.rate = LINK_RATE;
+    set_bursts(root);
+    classes.push_back(root);
+
+    uint32_t next_id = 2;
+    for (uint32_t t = 0; t < TENANTS; ++t) {
+        HTBClassConfig tenant;
+        tenant.class_id = next_id++;
+        tenant.parent_id = root.class_id;
+        tenant.rate = LINK_RATE / TENANTS;
+        tenant.ceil = LINK_RATE / 10;
+        set_bursts(tenant);
+        classes.push_back(tenant);
+
+        for (uint32_t l = 0; l < LEAVES_PER_TENANT; ++l) {
+            HTBClassConfig leaf;
+            leaf.class_id = next_id++;
+            leaf.parent_id = tenant.class_id;
+            leaf.rate = tenant.rate / LEAVES_PER_TENANT;
+            leaf.ceil = tenant.ceil;
+            set_bursts(leaf);
+            classes.push_back(leaf);
+        }
+    }
+    return classes;
+}
+
+void run(uint32_t charge_batch_bytes, size_t packet_count, const std::vector<HTBClassConfig>& classes,
+         const std::vector<uint32_t>& active_leaves, const std::vector<uint32_t>& sizes) {
+    HierarchicalTokenBucket tree(charge_batch_bytes);
+    tree.initialize(classes);
+
+    std::mt19937 rng(7);
+    uint64_t now = 0;
+    size_t sent = 0;
+    uint64_t bytes = 0;
+
+    // Prefill so the scheduler always has a deep backlog
+    PacketDescriptor packet{};
+    for (size_t i = 0; i < active_leaves.size() * 4; ++i) {
+        packet.size = sizes[i % sizes.size()];
+        tree.enqueue_packet(packet, active_leaves[i % active_leaves.size()], now);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < packet_count; ++i) {
+        packet.size = sizes[i % sizes.size()];
+        tree.enqueue_packet(packet, active_leaves[rng() % active_leaves.size()], now);
+
+        PacketDescriptor out;
+        while (!tree.dequeue_packet(out, now)) {
+            uint64_t wake = tree.next_wakeup_ns();
+            now = wake > now ? wake : now + 1000;
+        }
+        now += out.size * 8ULL * 1000000000ULL / LINK_RATE;
+        sent++;
+        bytes += out.size;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    auto stats = tree.get_statistics();
+    uint64_t borrowed = 0;
+    for (const auto& class_stats : stats.class_statistics) {
+        borrowed += class_stats.packets_borrowed;
+    }
+
+    std::cout << "  batch " << std::left << std::setw(6) << charge_batch_bytes << std::right << std::fixed
+              << std::setprecision(1) << std::setw(8) << seconds * 1e9 / packet_count << " ns/pkt"
+              << std::setprecision(2) << std::setw(9) << packet_count / seconds / 1e6 << " Mpps"
+              << std::setw(9) << bytes * 8.0 / (now / 1e9) / 1e9 << " Gb/s simulated"
+              << std::setprecision(1) << std::setw(7) << 100.0 * borrowed / sent << "% borrowed"
+              << std::setw(7) << 100.0 * stats.ancestor_flushes / sent << "% flushes" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t packet_count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+
+    auto classes = make_tree();
+    std::vector<uint32_t> active_leaves;
+    for (const auto& config : classes) {
+        bool is_leaf = config.parent_id > 1;
+        if (is_leaf && config.class_id % 2 == 0) {
+            active_leaves.push_back(config.class_id);
+        }
+    }
+
+    std::mt19937 rng(1);
+    std::vector<uint32_t> sizes(4096);
+    for (auto& size : sizes) {
+        size = 64 + rng() % 1437;
+    }
+
+    std::cout << "HTB, " << TENANTS * LEAVES_PER_TENANT << " leaves (" << active_leaves.size()
+              << " active), " << packet_count << " packets" << std::endl;
+    for (uint32_t batch : {0u, 1514u, 4096u, 16384u}) {
+        run(batch, packet_count, classes, active_leaves, sizes);
+    }
+
+    return 0;
+}
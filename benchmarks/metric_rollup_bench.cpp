@@ -0,0 +1,191 @@
+// Metric rollup benchmark: what rolling NetworkMetric streams up on the
+// client saves, and what the sketches give away.
+//
+// A simulated fleet of routers and interfaces reports latency, queue depth
+// and byte counters at 1 kHz per series. Reported: samples/s through
+// MetricRollupAggregator, raw rows and wire bytes into the in-memory
+// stand-in for clickhouse-cpp in tests/mock against the rollup rows, the
+// worst p50/p99/p99.9 error against the exact quantiles over all windows,
+// and the HyperLogLog unique-flow error at a few cardinalities.
+//
+// Usage: metric_rollup_bench [seconds] [series] [window_ms]
+
+#include "analytics/metric_rollup.h"
+#include "analytics/flow_cache.h"
+#include <clickhouse/client.h>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace RouterSim;
+
+namespace {
+
+const uint64_t START_MS = 1700000000000ull;
+const char* METRIC_TYPES[] = {"latency_us", "queue_depth", "rx_bytes"};
+
+std::vector<NetworkMetric> make_samples(uint64_t seconds, size_t series) {
+    std::mt19937_64 rng(11);
+    std::lognormal_distribution<double> latency(4.0, 0.7);
+    std::exponential_distribution<double> depth(0.05);
+    std::uniform_int_distribution<int> packet(64, 1500);
+
+    std::vector<NetworkMetric> samples;
+    samples.reserve(seconds * 1000 * series);
+    for (uint64_t ms = 0; ms < seconds * 1000; ++ms) {
+        for (size_t s = 0; s < series; ++s) {
+            NetworkMetric metric;
+            metric.timestamp = START_MS + ms;
+            metric.router_id = "router-" + std::to_string(s / 12);
+            metric.interface = "eth" + std::to_string(s / 3 % 4);
+            metric.metric_type = METRIC_TYPES[s % 3];
+            metric.value = s % 3 == 0 ? latency(rng) : s % 3 == 1 ? std::floor(depth(rng)) : packet(rng);
+            samples.push_back(std::move(metric));
+        }
+    }
+    return samples;
+}
+
+double exact_quantile(std::vector<double>& values, double q) {
+    size_t rank = static_cast<size_t>(q * (values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+
+void run_ingest(const std::vector<NetworkMetric>& samples, uint32_t window_ms) {
+    MetricRollupOptions options;
+    options.window_ms = window_ms;
+    uint64_t rows = 0;
+    MetricRollupAggregator aggregator(options, [&rows](const MetricRollup&) { rows++; });
+
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& sample : samples) {
+        aggregator.add(sample);
+    }
+    aggregator.flush();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "ingest: " << samples.size() / seconds / 1e6 << " M samples/s (" << seconds * 1e9 / samples.size()
+              << " ns/sample), " << rows << " rollups" << std::endl;
+}
+
+void run_clickhouse(const std::vector<NetworkMetric>& samples, uint32_t window_ms) {
+    auto& server = clickhouse::MockServer::instance();
+    ClickHouseFlushOptions flush;
+    flush.background = false;
+
+    server.reset();
+    {
+        ClickHouseClient client;
+        client.connect(flush);
+        for (const auto& sample : samples) {
+            client.insert_metric(sample);
+        }
+        client.disconnect();
+    }
+    uint64_t raw_rows = server.rows;
+    uint64_t raw_bytes = server.wire_bytes;
+
+    server.reset();
+    {
+        ClickHouseClient client;
+        client.connect(flush);
+        MetricRollupOptions options;
+        options.window_ms = window_ms;
+        MetricRollupAggregator aggregator(options,
+                                          [&client](const MetricRollup& row) { client.insert_metric_rollup(row); });
+        for (const auto& sample : samples) {
+            aggregator.add(sample);
+        }
+        aggregator.flush();
+        client.disconnect();
+    }
+    std::cout << "raw: " << raw_rows << " rows, " << raw_bytes / 1e6 << " MB on the wire; rollups: " << server.rows
+              << " rows, " << server.wire_bytes / 1e6 << " MB (" << double(raw_rows) / server.rows << "x fewer rows, "
+              << double(raw_bytes) / server.wire_bytes << "x fewer bytes)" << std::endl;
+    server.reset();
+}
+
+void run_accuracy(const std::vector<NetworkMetric>& samples, uint32_t window_ms) {
+    // Exact values per (series, window)
+    std::map<std::string, std::vector<double>> exact;
+    for (const auto& sample : samples) {
+        if (sample.metric_type == "latency_us") {
+            uint64_t window = sample.timestamp - sample.timestamp % window_ms;
+            exact[sample.router_id + "/" + sample.interface + "/" + std::to_string(window)].push_back(sample.value);
+        }
+    }
+
+    MetricRollupOptions options;
+    options.window_ms = window_ms;
+    double worst[3] = {0, 0, 0};
+    MetricRollupAggregator aggregator(options, [&](const MetricRollup& row) {
+        if (row.metric_type != "latency_us") {
+            return;
+        }
+        auto& values = exact[row.router_id + "/" + row.interface + "/" + std::to_string(row.timestamp)];
+        const double quantiles[3] = {row.p50, row.p99, row.p999};
+        const double qs[3] = {0.5, 0.99, 0.999};
+        for (int i = 0; i < 3; ++i) {
+            double truth = exact_quantile(values, qs[i]);
+            worst[i] = std::max(worst[i], std::fabs(quantiles[i] - truth) / truth);
+        }
+    });
+    for (const auto& sample : samples) {
+        aggregator.add(sample);
+    }
+    aggregator.flush();
+    std::cout << "worst relative error over " << exact.size() << " latency windows (target "
+              << options.relative_accuracy * 100 << " %): p50 " << worst[0] * 100 << " %, p99 " << worst[1] * 100
+              << " %, p99.9 " << worst[2] * 100 << " %" << std::endl;
+}
+
+void run_flows() {
+    std::mt19937_64 rng(3);
+    for (uint64_t distinct : {1000ull, 100000ull, 1000000ull}) {
+        HyperLogLog sketch(MetricRollupOptions().flow_precision);
+        std::vector<uint64_t> flows(distinct);
+        for (auto& flow : flows) {
+            flow = rng();
+        }
+        // Every flow seen a few times, in no particular order
+        for (int pass = 0; pass < 4; ++pass) {
+            for (size_t i = 0; i < distinct; ++i) {
+                PacketDescriptor packet{};
+                uint64_t flow = flows[(i * 7919 + pass) % distinct];
+                packet.set_ipv4(static_cast<uint32_t>(flow), static_cast<uint32_t>(flow >> 32));
+                packet.src_port = static_cast<uint16_t>(flow >> 16);
+                packet.dst_port = 443;
+                packet.protocol = 6;
+                sketch.add(hash_flow_key(FlowKey::from_packet(packet)));
+            }
+        }
+        double estimate = sketch.estimate();
+        std::cout << "unique flows " << std::setw(8) << distinct << ": estimate " << std::setw(10)
+                  << std::llround(estimate) << ", error " << std::setw(6)
+                  << (estimate - double(distinct)) / distinct * 100 << " %" << std::endl;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint64_t seconds = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 60;
+    size_t series = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 48;
+    uint32_t window_ms = argc > 3 ? static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 10)) : 10000;
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "=== Metric rollups: " << series << " series at 1 kHz for " << seconds << " s, " << window_ms
+              << " ms windows ===" << std::endl;
+    auto samples = make_samples(seconds, series);
+    run_ingest(samples, window_ms);
+    run_clickhouse(samples, window_ms);
+    run_accuracy(samples, window_ms);
+    run_flows();
+    return 0;
+}
@@ -0,0 +1,144 @@
+// Netem emulation benchmark: cost of impairing traffic in process with
+// NetemEmulator across thousands of links, and of reconfiguring a link
+// compared with the fork+exec every tc invocation paid before.
+//
+// The data-path run spreads packets over the links at a fixed offered
+// rate; every link has delay with jitter plus a mix of loss, duplication,
+// corruption, reordering and rate limiting. Released packets are drained
+// each simulated millisecond. The tc cost is measured with std::system
+// running /bin/true, a lower bound for a real "tc qdisc change".
+//
+// Usage: netem_bench [links] [packets]
+
+#include "netem/emulator.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace RouterSim;
+
+namespace {
+
+ImpairmentInfo make_impairments(uint32_t index) {
+    ImpairmentInfo info;
+    info.has_delay = true;
+    info.delay.delay_ms = 5 + index % 40;
+    info.delay.jitter_ms = 2;
+    info.delay.distribution = static_cast<DelayDistribution>(index % 4);
+
+    switch (index % 5) {
+        case 0:
+            info.has_loss = true;
+            info.loss.loss_percentage = 1.0;
+            break;
+        case 1:
+            info.has_loss = true;
+            info.loss.loss_type = LossType::GEMODEL;
+            info.loss.p = 1.0;
+            info.loss.r = 20.0;
+            break;
+        case 2:
+            info.has_duplicate = true;
+            info.duplicate.duplicate_percentage = 1.0;
+            info.has_corrupt = true;
+            info.corrupt.corrupt_percentage = 0.5;
+            break;
+        case 3:
+            info.has_reorder = true;
+            info.reorder.reorder_percentage = 5.0;
+            break;
+        case 4:
+            info.has_rate_limit = true;
+            info.rate_limit.rate_kbps = 100000;
+            info.rate_limit.burst_kb = 128;
+            break;
+    }
+    return info;
+}
+
+double elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint32_t links = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+    size_t packets = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2000000;
+
+    NetemEmulator emulator(42);
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < links; ++i) {
+        emulator.add_link("veth" + std::to_string(i), make_impairments(i));
+    }
+    double setup_ns = elapsed_ns(start);
+
+    // One packet every 500 ns of simulated time: 2 Mpps across all links
+    const uint64_t gap_ns = 500;
+    const uint64_t drain_ns = 1000000;
+    std::vector<EmulatedPacket> released;
+    released.reserve(8192);
+    PacketInfo packet;
+    packet.size = 1000;
+    packet.src_ip = "10.0.0.1";
+    packet.dst_ip = "10.0.0.2";
+
+    size_t delivered = 0;
+    uint64_t next_drain = drain_ns;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < packets; ++i) {
+        uint64_t now = i * gap_ns;
+        if (now >= next_drain) {
+            emulator.release(now, released);
+            delivered += released.size();
+            released.clear();
+            next_drain += drain_ns;
+        }
+        packet.id = i;
+        emulator.enqueue(static_cast<uint32_t>((i * 2654435761u) % links), packet, now);
+    }
+    emulator.release(UINT64_MAX, released);
+    delivered += released.size();
+    double run_ns = elapsed_ns(start);
+
+    uint64_t lost = 0, duplicated = 0, reordered = 0;
+    for (uint32_t i = 0; i < links; ++i) {
+        auto stats = emulator.get_link_statistics(i);
+        lost += stats.dropped_loss + stats.dropped_limit;
+        duplicated += stats.duplicated;
+        reordered += stats.reordered;
+    }
+
+    std::cout << "Netem emulation, " << links << " links, " << packets << " packets" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  link setup          " << setup_ns / links << " ns/link" << std::endl;
+    std::cout << "  enqueue + release   " << run_ns / packets << " ns/packet ("
+              << packets / run_ns * 1000.0 << " Mpps)" << std::endl;
+    std::cout << "  delivered " << delivered << ", lost " << lost << ", duplicated " << duplicated
+              << ", reordered " << reordered << std::endl;
+
+    // Reconfiguration: in-process update against spawning a process
+    const int reconfigurations = 200;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reconfigurations; ++i) {
+        emulator.configure_link(i % links, make_impairments(i + 1));
+    }
+    double configure_ns = elapsed_ns(start) / reconfigurations;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reconfigurations; ++i) {
+        if (std::system("/bin/true") != 0) {
+            break;
+        }
+    }
+    double spawn_ns = elapsed_ns(start) / reconfigurations;
+
+    std::cout << "Reconfigure one link" << std::endl;
+    std::cout << "  in process          " << configure_ns << " ns" << std::endl;
+    std::cout << "  fork+exec (no tc)   " << spawn_ns / 1000.0 << " us" << std::endl;
+
+    return 0;
+}
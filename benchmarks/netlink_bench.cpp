@@ -0,0 +1,90 @@
+// Netlink batching benchmark: cost of programming netem on hundreds of
+// interfaces with batched rtnetlink messages, compared with running tc
+// once per interface and option as NetemImpairments used to.
+//
+// The batched run applies the "unreliable_network" scenario through
+// NetemImpairments over MockNetlinkSocket, which stands in for the kernel;
+// the time therefore covers encoding, batching and ack handling but not
+// the kernel's own qdisc setup. The tc cost is measured by running
+// "tc qdisc show dev lo" a few dozen times and scaling by the three tc
+// invocations per interface the scenario used to need.
+//
+// Usage: netlink_bench [interfaces] [tc_samples]
+
+#include "netem/mock_netlink_socket.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace RouterSim;
+
+namespace {
+
+double elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 500;
+    int tc_samples = argc > 2 ? std::atoi(argv[2]) : 50;
+
+    std::vector<std::string> interfaces;
+    for (size_t i = 0; i < count; ++i) {
+        interfaces.push_back("veth" + std::to_string(i));
+    }
+
+    auto socket = std::make_unique<MockNetlinkSocket>(interfaces);
+    MockNetlinkSocket* mock = socket.get();
+    NetemImpairments impairments(std::move(socket));
+    if (!impairments.start()) {
+        std::cerr << "Failed to start impairments" << std::endl;
+        return 1;
+    }
+
+    uint64_t datagrams = mock->datagrams_received();
+    uint64_t messages = mock->messages_received();
+    auto start = std::chrono::steady_clock::now();
+    bool applied = impairments.apply_scenario("unreliable_network");
+    double apply_ns = elapsed_ns(start);
+    datagrams = mock->datagrams_received() - datagrams;
+    messages = mock->messages_received() - messages;
+
+    std::vector<QdiscState> qdiscs;
+    start = std::chrono::steady_clock::now();
+    impairments.read_kernel_qdiscs(qdiscs);
+    double dump_ns = elapsed_ns(start);
+
+    std::cout << "Netem scenario on " << count << " interfaces" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  batched rtnetlink   " << apply_ns / 1000.0 << " us total, " << datagrams
+              << " datagrams, " << messages << " messages" << (applied ? "" : " (failures)") << std::endl;
+    std::cout << "  qdisc dump          " << dump_ns / 1000.0 << " us for " << qdiscs.size() << " qdiscs"
+              << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    int samples = 0;
+    for (; samples < tc_samples; ++samples) {
+        if (std::system("tc qdisc show dev lo > /dev/null 2>&1") != 0) {
+            break;
+        }
+    }
+    if (samples == 0) {
+        std::cout << "  tc not available, skipping comparison" << std::endl;
+        return 0;
+    }
+    double tc_ns = elapsed_ns(start) / samples;
+    double tc_total_ns = tc_ns * 3 * count;
+
+    std::cout << "  tc per invocation   " << tc_ns / 1000.0 << " us (" << samples << " samples)" << std::endl;
+    std::cout << "  tc, extrapolated    " << tc_total_ns / 1e6 << " ms for " << 3 * count << " invocations"
+              << std::endl;
+    std::cout << "  speedup             " << tc_total_ns / apply_ns << "x (excluding kernel qdisc setup)"
+              << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,133 @@
+// Flow-aware pcap diff benchmark: time and memory of PcapFlowAligner as
+// the captures grow, compared with the count of differences a strict
+// index-by-index comparison would report for the same captures.
+//
+// The second capture is the first with 0.1% of packets lost, 0.1% moved
+// a few places later within their flow and 0.05% duplicated, spread over
+// many interleaved TCP flows. Constant ns/packet across sizes shows the
+// linear running time; peak pending packets and flows show the memory
+// bound set by the alignment window.
+//
+// Usage: pcap_diff_bench [max_packets] [flows] [window]
+
+#include "testing/flow_aligner.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <random>
+#include <sys/resource.h>
+
+using namespace RouterSim;
+
+namespace {
+
+PcapPacketInfo make_packet(uint32_t flow, uint32_t sequence) {
+    PcapPacketInfo packet;
+    packet.src_ip = "10." + std::to_string(flow >> 16) + "." + std::to_string(flow >> 8 & 0xff) + "." +
+                    std::to_string(flow & 0xff);
+    packet.dst_ip = "192.168.0.1";
+    packet.protocol = 6;
+    packet.src_port = static_cast<uint16_t>(1024 + flow % 60000);
+    packet.dst_port = 443;
+    packet.ip_id = sequence & 0xffff;
+    packet.tcp_seq = sequence * 1448;
+    packet.tcp_ack = 1;
+    packet.size = 1500;
+    return packet;
+}
+
+long peak_rss_kb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint64_t max_packets = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4000000;
+    uint32_t flows = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10000;
+    size_t window = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : PcapFlowAligner::DEFAULT_WINDOW;
+
+    std::cout << "Flow-aware diff, " << flows << " flows, window " << window << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+
+    for (uint64_t packets = max_packets / 4; packets <= max_packets; packets *= 2) {
+        uint64_t matched = 0, reordered = 0, missing = 0, extra = 0;
+        PcapFlowAligner aligner(
+            window,
+            [&](const PcapPacketInfo&, uint64_t, const PcapPacketInfo&, uint64_t, bool is_reordered) {
+                matched++;
+                reordered += is_reordered;
+            },
+            [&](PcapFlowAligner::Side side, const PcapPacketInfo&, uint64_t) {
+                (side == PcapFlowAligner::FIRST ? missing : extra)++;
+            });
+
+        std::mt19937_64 rng(7);
+        std::uniform_int_distribution<uint32_t> per_mille(0, 1999);
+        std::vector<uint32_t> next_sequence(flows, 0);
+        struct Delayed {
+            PcapPacketInfo packet;
+            uint64_t id;
+            uint64_t release_at;
+        };
+        std::deque<Delayed> delayed;
+
+        // Index comparison: pairs up the n-th packets of both captures
+        std::deque<uint64_t> first_ids, second_ids;
+        uint64_t index_mismatches = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < packets; ++i) {
+            uint32_t flow = static_cast<uint32_t>(i % flows);
+            PcapPacketInfo packet = make_packet(flow, next_sequence[flow]++);
+            uint64_t id = uint64_t(flow) << 32 | packet.tcp_seq;
+            aligner.add(PcapFlowAligner::FIRST, packet);
+            first_ids.push_back(id);
+
+            // What the second capture does with it: lose, delay by three
+            // rounds of the flows, duplicate or pass
+            uint32_t roll = per_mille(rng);
+            if (roll < 2) {
+                continue;
+            } else if (roll < 4) {
+                delayed.push_back({packet, id, i + 3 * uint64_t(flows)});
+            } else {
+                aligner.add(PcapFlowAligner::SECOND, packet);
+                second_ids.push_back(id);
+                if (roll == 4) {
+                    aligner.add(PcapFlowAligner::SECOND, packet);
+                    second_ids.push_back(id);
+                }
+            }
+            while (!delayed.empty() && delayed.front().release_at <= i) {
+                aligner.add(PcapFlowAligner::SECOND, delayed.front().packet);
+                second_ids.push_back(delayed.front().id);
+                delayed.pop_front();
+            }
+
+            while (!first_ids.empty() && !second_ids.empty()) {
+                index_mismatches += first_ids.front() != second_ids.front();
+                first_ids.pop_front();
+                second_ids.pop_front();
+            }
+        }
+        for (auto& late : delayed) {
+            aligner.add(PcapFlowAligner::SECOND, late.packet);
+        }
+        aligner.finish();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        uint64_t total = aligner.packets(PcapFlowAligner::FIRST) + aligner.packets(PcapFlowAligner::SECOND);
+        std::cout << "  " << packets << " packets: " << seconds * 1e9 / total << " ns/packet, peak pending "
+                  << aligner.peak_pending() << ", peak RSS " << peak_rss_kb() / 1024 << " MB" << std::endl;
+        std::cout << "    flow mode: matched " << matched << ", missing " << missing << ", extra " << extra
+                  << ", reordered " << reordered << std::endl;
+        std::cout << "    index mode: " << index_mismatches << " mismatched pairs" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,191 @@
+// Parallel pcap diff benchmark: PcapDiff::compare_pcaps of two capture
+// files on 1, 2, 4 and 8 worker threads, in both comparison modes.
+//
+// The second file is the first with 0.1% of packets lost and 0.1% moved
+// behind the next three packets of their flow, over many interleaved TCP
+// flows. Both files are in the page cache, so this measures decoding and
+// comparison. Every run must report the same differences; the bench checks
+// that too. The speedup is bounded by the cores available: the two
+// decoding threads run alongside the workers.
+//
+// Usage: pcap_diff_parallel_bench [packets] [flows] [directory]
+
+#include "testing/pcap_diff.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace RouterSim;
+
+namespace {
+
+void put16be(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void put32be(std::vector<uint8_t>& out, uint32_t value) {
+    put16be(out, static_cast<uint16_t>(value >> 16));
+    put16be(out, static_cast<uint16_t>(value));
+}
+
+void put32(std::vector<uint8_t>& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+// Ethernet/IPv4/TCP packet `sequence` of flow `flow`, 128 bytes
+void put_frame(std::vector<uint8_t>& out, uint32_t flow, uint32_t sequence, uint64_t timestamp_us) {
+    const uint32_t length = 128;
+    put32(out, static_cast<uint32_t>(timestamp_us / 1000000));
+    put32(out, static_cast<uint32_t>(timestamp_us % 1000000));
+    put32(out, length);
+    put32(out, length);
+
+    size_t start = out.size();
+    out.resize(start + 12, 0x02);
+    put16be(out, 0x0800);
+    out.insert(out.end(), {0x45, 0, 0, static_cast<uint8_t>(length - 14)});
+    put16be(out, static_cast<uint16_t>(sequence));
+    out.insert(out.end(), {0, 0, 64, 6, 0, 0});
+    put32be(out, 0x0a000000 | flow);
+    put32be(out, 0xc0a80001);
+    put16be(out, static_cast<uint16_t>(1024 + flow % 60000));
+    put16be(out, 443);
+    put32be(out, sequence * 1448);
+    put32be(out, 1);
+    out.resize(start + length, 0);
+}
+
+void write_captures(const std::string& path1, const std::string& path2, uint64_t packets, uint32_t flows) {
+    std::vector<uint8_t> header;
+    put32(header, 0xa1b2c3d4);
+    header.insert(header.end(), {2, 0, 4, 0});
+    put32(header, 0);
+    put32(header, 0);
+    put32(header, 65535);
+    put32(header, 1);
+
+    struct Delayed {
+        uint32_t flow;
+        uint32_t sequence;
+        uint64_t release_at;
+    };
+    std::vector<Delayed> delayed;
+    std::mt19937_64 rng(11);
+    std::uniform_int_distribution<uint32_t> per_mille(0, 999);
+    std::vector<uint32_t> next_sequence(flows, 0);
+    std::vector<uint8_t> out1 = header, out2 = header;
+    std::ofstream file1(path1, std::ios::binary), file2(path2, std::ios::binary);
+    uint64_t timestamp_us = 1700000000000000ull;
+
+    for (uint64_t i = 0; i < packets; ++i) {
+        uint32_t flow = static_cast<uint32_t>(i % flows);
+        uint32_t sequence = next_sequence[flow]++;
+        timestamp_us += 3;
+        put_frame(out1, flow, sequence, timestamp_us);
+
+        uint32_t roll = per_mille(rng);
+        if (roll == 1) {
+            delayed.push_back({flow, sequence, i + 3 * uint64_t(flows)});
+        } else if (roll != 0) {
+            put_frame(out2, flow, sequence, timestamp_us);
+        }
+        while (!delayed.empty() && delayed.front().release_at <= i) {
+            put_frame(out2, delayed.front().flow, delayed.front().sequence, timestamp_us);
+            delayed.erase(delayed.begin());
+        }
+
+        if (out1.size() >= (1 << 20)) {
+            file1.write(reinterpret_cast<const char*>(out1.data()), out1.size());
+            file2.write(reinterpret_cast<const char*>(out2.data()), out2.size());
+            out1.clear();
+            out2.clear();
+        }
+    }
+    file1.write(reinterpret_cast<const char*>(out1.data()), out1.size());
+    file2.write(reinterpret_cast<const char*>(out2.data()), out2.size());
+}
+
+bool same_results(PcapDiff& a, PcapDiff& b) {
+    auto differences_a = a.get_differences();
+    auto differences_b = b.get_differences();
+    if (differences_a.size() != differences_b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < differences_a.size(); ++i) {
+        if (differences_a[i].type != differences_b[i].type ||
+            differences_a[i].packet_index != differences_b[i].packet_index ||
+            differences_a[i].description != differences_b[i].description) {
+            return false;
+        }
+    }
+    PcapDiffSummary summary_a = a.get_summary(), summary_b = b.get_summary();
+    return summary_a.matched == summary_b.matched && summary_a.modified == summary_b.modified &&
+           summary_a.missing == summary_b.missing && summary_a.extra == summary_b.extra &&
+           summary_a.reordered == summary_b.reordered;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint64_t packets = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    uint32_t flows = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10000;
+    std::string directory = argc > 3 ? argv[3] : "/tmp";
+
+    std::string path1 = directory + "/pcap_diff_parallel_bench_1.pcap";
+    std::string path2 = directory + "/pcap_diff_parallel_bench_2.pcap";
+    write_captures(path1, path2, packets, flows);
+
+    std::cout << packets << " packets, " << flows << " flows, " << std::thread::hardware_concurrency()
+              << " cores" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+
+    bool consistent = true;
+    for (PcapDiffMode mode : {PcapDiffMode::BY_INDEX, PcapDiffMode::BY_FLOW}) {
+        std::cout << (mode == PcapDiffMode::BY_FLOW ? "by flow" : "by index") << std::endl;
+        PcapDiff reference;
+        double single = 0;
+        for (size_t threads : {1, 2, 4, 8}) {
+            PcapDiffOptions options;
+            options.mode = mode;
+            options.threads = threads;
+            options.timestamp_tolerance_us = UINT64_MAX;
+            options.max_differences = 1000;
+
+            PcapDiff diff;
+            auto start = std::chrono::steady_clock::now();
+            diff.compare_pcaps(path1, path2, options);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (threads == 1) {
+                single = seconds;
+                reference.compare_pcaps(path1, path2, options);
+            } else if (!same_results(diff, reference)) {
+                consistent = false;
+            }
+
+            std::cout << "  " << threads << " threads: " << std::setw(6) << seconds << " s, " << std::setw(6)
+                      << 2 * packets / seconds / 1e6 << " Mpps, speedup " << single / seconds << "x"
+                      << std::endl;
+        }
+        auto summary = reference.get_summary();
+        std::cout << "  matched " << summary.matched << ", missing " << summary.missing << ", extra "
+                  << summary.extra << ", reordered " << summary.reordered << std::endl;
+    }
+
+    std::remove(path1.c_str());
+    std::remove(path2.c_str());
+    if (!consistent) {
+        std::cerr << "Results differ between thread counts" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,200 @@
+// Pcap reader benchmark: parse throughput of the memory-mapped pcap and
+// pcapng reader, which replaced running tshark and parsing its text output.
+//
+// A synthetic capture of mixed Ethernet/IPv4/IPv6 TCP and UDP frames
+// (VLAN-tagged and untagged, 64 to 1500 bytes) is written in both formats.
+// Each file is then walked three ways: records only, records decoded into
+// PcapPacketInfo, and a full PcapDiff::compare_pcaps of the file against
+// itself. The file is in the page cache, so this measures parsing rather
+// than disk bandwidth.
+//
+// Usage: pcap_reader_bench [megabytes] [directory]
+
+#include "testing/pcap_reader.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace RouterSim;
+
+namespace {
+
+void put16be(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void put16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void put32(std::vector<uint8_t>& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+std::vector<uint8_t> make_frame(uint32_t index) {
+    static const uint16_t sizes[] = {64, 128, 576, 1500};
+    bool ipv6 = index % 4 == 3;
+    bool udp = index % 3 == 0;
+    std::vector<uint8_t> frame(12, 0x02);
+    if (index % 5 == 0) {
+        put16be(frame, 0x8100);
+        put16be(frame, 10 + index % 100);
+    }
+    put16be(frame, ipv6 ? 0x86dd : 0x0800);
+
+    if (ipv6) {
+        frame.insert(frame.end(), {0x60, 0, 0, 0, 0, 0, static_cast<uint8_t>(udp ? 17 : 6), 64});
+        for (int i = 0; i < 32; ++i) {
+            frame.push_back(static_cast<uint8_t>(i == 15 || i == 31 ? index : i < 4 ? 0x20 : 0));
+        }
+    } else {
+        frame.insert(frame.end(), {0x45, 0, 0, 0, 0, 1, 0, 0, 64, static_cast<uint8_t>(udp ? 17 : 6), 0, 0,
+                                   10, static_cast<uint8_t>(index >> 8), static_cast<uint8_t>(index), 1,
+                                   10, 0, static_cast<uint8_t>(index % 7), 2});
+    }
+    put16be(frame, static_cast<uint16_t>(1024 + index % 50000));
+    put16be(frame, udp ? 53 : 443);
+    frame.resize(sizes[index % 4], 0);
+    return frame;
+}
+
+// Writes about the requested size; returns the number of frames
+size_t write_capture(const std::string& path, size_t bytes, bool pcapng) {
+    std::vector<uint8_t> out;
+    if (pcapng) {
+        put32(out, 0x0a0d0d0a);
+        put32(out, 28);
+        put32(out, 0x1a2b3c4d);
+        put16(out, 1);
+        put16(out, 0);
+        put32(out, 0xffffffff);
+        put32(out, 0xffffffff);
+        put32(out, 28);
+        put32(out, 1);
+        put32(out, 20);
+        put16(out, 1);
+        put16(out, 0);
+        put32(out, 0);
+        put32(out, 20);
+    } else {
+        put32(out, 0xa1b2c3d4);
+        put16(out, 2);
+        put16(out, 4);
+        put32(out, 0);
+        put32(out, 0);
+        put32(out, 65535);
+        put32(out, 1);
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    size_t frames = 0;
+    size_t written = 0;
+    uint64_t timestamp_us = 1700000000000000ull;
+    while (written < bytes) {
+        std::vector<uint8_t> frame = make_frame(static_cast<uint32_t>(frames));
+        uint32_t length = static_cast<uint32_t>(frame.size());
+        timestamp_us += 7;
+        if (pcapng) {
+            uint32_t block = 32 + ((length + 3) & ~3u);
+            put32(out, 6);
+            put32(out, block);
+            put32(out, 0);
+            put32(out, static_cast<uint32_t>(timestamp_us >> 32));
+            put32(out, static_cast<uint32_t>(timestamp_us));
+            put32(out, length);
+            put32(out, length);
+            out.insert(out.end(), frame.begin(), frame.end());
+            out.resize(out.size() + (block - 32 - length), 0);
+            put32(out, block);
+        } else {
+            put32(out, static_cast<uint32_t>(timestamp_us / 1000000));
+            put32(out, static_cast<uint32_t>(timestamp_us % 1000000));
+            put32(out, length);
+            put32(out, length);
+            out.insert(out.end(), frame.begin(), frame.end());
+        }
+        frames++;
+        if (out.size() >= (1 << 20)) {
+            written += out.size();
+            file.write(reinterpret_cast<const char*>(out.data()), out.size());
+            out.clear();
+        }
+    }
+    file.write(reinterpret_cast<const char*>(out.data()), out.size());
+    return frames;
+}
+
+double elapsed_s(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char* label, size_t bytes, size_t packets, double seconds) {
+    std::cout << "  " << std::left << std::setw(20) << label << std::right << std::setw(8)
+              << bytes / seconds / 1e6 << " MB/s  " << std::setw(6) << packets / seconds / 1e6 << " Mpps"
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 256;
+    std::string directory = argc > 2 ? argv[2] : "/tmp";
+
+    std::cout << std::fixed << std::setprecision(1);
+    for (bool pcapng : {false, true}) {
+        std::string path = directory + "/pcap_reader_bench" + (pcapng ? ".pcapng" : ".pcap");
+        size_t frames = write_capture(path, megabytes << 20, pcapng);
+
+        PcapReader reader;
+        if (!reader.open(path)) {
+            return 1;
+        }
+        size_t bytes = reader.file_size();
+        std::cout << (pcapng ? "pcapng" : "pcap") << ", " << bytes / 1e6 << " MB, " << frames << " frames"
+                  << std::endl;
+
+        // Warm the page cache
+        PcapRecord record;
+        uint64_t checksum = 0;
+        while (reader.next_record(record)) {
+            checksum += record.captured_length;
+        }
+
+        reader.rewind();
+        auto start = std::chrono::steady_clock::now();
+        while (reader.next_record(record)) {
+            checksum += record.data[record.captured_length - 1];
+        }
+        report("records", bytes, frames, elapsed_s(start));
+
+        reader.rewind();
+        PcapPacketInfo packet;
+        start = std::chrono::steady_clock::now();
+        while (reader.next(packet)) {
+            checksum += packet.src_port;
+        }
+        report("decode", bytes, frames, elapsed_s(start));
+
+        PcapDiff diff;
+        start = std::chrono::steady_clock::now();
+        bool same = diff.compare_pcaps(path, path);
+        report("compare (2 files)", 2 * bytes, 2 * frames, elapsed_s(start));
+
+        if (!same || checksum == 0) {
+            std::cerr << "Unexpected differences" << std::endl;
+        }
+        reader.close();
+        std::remove(path.c_str());
+    }
+
+    return 0;
+}
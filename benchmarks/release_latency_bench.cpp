@@ -0,0 +1,213 @@
+// Release latency benchmark: how long shaped packets wait between enqueue
+// and release, with the old 1 ms sleep-polling loop and with the
+// TrafficShapingManager's timer-wheel release thread.
+//
+// A producer thread feeds an HTB-shaped interface (100 Mb/s) with two
+// patterns: Poisson arrivals below the rate, where packets are eligible on
+// arrival, and periodic bursts above the burst size, where packets must
+// wait for tokens. Latency is enqueue to release-callback time. Idle cost
+// is process CPU time over a second with no traffic.
+//
+// Usage: release_latency_bench [packets_per_pattern]
+
+#include "traffic_shaping.h"
+#include "traffic_shaping/htb.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <sys/resource.h>
+
+using namespace RouterSim;
+
+namespace {
+
+const uint64_t RATE = 100000000;   // 100 Mb/s
+const uint32_t PACKET_SIZE = 1000;
+const uint32_t LEAF_ID = 2;
+
+std::vector<HTBClassConfig> make_tree() {
+    HTBClassConfig root;
+    root.class_id = 1;
+    root.rate = RATE;
+    HTBClassConfig leaf;
+    leaf.class_id = LEAF_ID;
+    leaf.parent_id = 1;
+    leaf.rate = RATE;
+    return {root, leaf};
+}
+
+// Reference copy of the previous release loop: dequeue while possible,
+// otherwise sleep 1 ms
+class PollingReleaser {
+public:
+    PollingReleaser(HierarchicalTokenBucket& tree, std::function<void(const PacketDescriptor&)> deliver)
+        : tree_(tree), deliver_(deliver), running_(true), thread_(&PollingReleaser::loop, this) {}
+
+    ~PollingReleaser() {
+        running_ = false;
+        thread_.join();
+    }
+
+private:
+    HierarchicalTokenBucket& tree_;
+    std::function<void(const PacketDescriptor&)> deliver_;
+    std::atomic<bool> running_;
+    std::thread thread_;
+
+    void loop() {
+        PacketDescriptor packet;
+        while (running_) {
+            if (tree_.dequeue_packet(packet)) {
+                deliver_(packet);
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+};
+
+class LatencyRecorder {
+public:
+    void record(uint64_t enqueue_ns) {
+        uint64_t latency = packet_clock_ns() - enqueue_ns;
+        std::lock_guard<std::mutex> lock(mutex_);
+        latencies_.push_back(latency);
+    }
+
+    size_t count() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return latencies_.size();
+    }
+
+    void report(const std::string& label) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::sort(latencies_.begin(), latencies_.end());
+        auto percentile = [&](double p) {
+            return latencies_.empty() ? 0.0 : latencies_[std::min(latencies_.size() - 1,
+                                                                  static_cast<size_t>(p * latencies_.size()))] / 1000.0;
+        };
+        std::cout << "  " << std::left << std::setw(26) << label << std::right << std::fixed
+                  << std::setprecision(1) << "p50 " << std::setw(8) << percentile(0.50) << " us  p99 "
+                  << std::setw(8) << percentile(0.99) << " us  p999 " << std::setw(8) << percentile(0.999)
+                  << " us  (" << latencies_.size() << " packets)" << std::endl;
+        latencies_.clear();
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<uint64_t> latencies_;
+};
+
+// Poisson arrivals at 40% of the rate
+void produce_light(const std::function<void(const PacketDescriptor&)>& enqueue, size_t packets) {
+    std::mt19937 rng(1);
+    double mean_gap_ns = PACKET_SIZE * 8 * 1e9 / RATE / 0.4;
+    std::exponential_distribution<double> gap(1.0 / mean_gap_ns);
+
+    PacketDescriptor packet{};
+    packet.size = PACKET_SIZE;
+    packet.priority = LEAF_ID;
+    auto next = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < packets; ++i) {
+        next += std::chrono::nanoseconds(static_cast<int64_t>(gap(rng)));
+        std::this_thread::sleep_until(next);
+        packet.id = i;
+        packet.timestamp_ns = packet_clock_ns();
+        enqueue(packet);
+    }
+}
+
+// Bursts of 40 packets (twice the bucket) every 10 ms
+void produce_bursts(const std::function<void(const PacketDescriptor&)>& enqueue, size_t packets) {
+    PacketDescriptor packet{};
+    packet.size = PACKET_SIZE;
+    packet.priority = LEAF_ID;
+    auto next = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < packets; i += 40) {
+        next += std::chrono::milliseconds(10);
+        std::this_thread::sleep_until(next);
+        for (size_t j = 0; j < 40 && i + j < packets; ++j) {
+            packet.id = i + j;
+            packet.timestamp_ns = packet_clock_ns();
+            enqueue(packet);
+        }
+    }
+}
+
+void wait_for(LatencyRecorder& recorder, size_t packets) {
+    for (int i = 0; i < 5000 && recorder.count() < packets; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+double cpu_seconds() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+void report_idle_cpu(const std::string& label) {
+    double start = cpu_seconds();
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    std::cout << "  " << std::left << std::setw(26) << label << std::right << std::fixed << std::setprecision(1)
+              << "idle CPU " << (cpu_seconds() - start) * 1e6 << " us/s" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t packets = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4000;
+    LatencyRecorder recorder;
+
+    std::cout << "Release latency, HTB 100 Mb/s, " << PACKET_SIZE << "-byte packets, " << packets
+              << " per pattern" << std::endl;
+
+    std::cout << "Before: 1 ms sleep polling" << std::endl;
+    {
+        HierarchicalTokenBucket tree;
+        tree.initialize(make_tree());
+        PollingReleaser releaser(tree, [&](const PacketDescriptor& packet) { recorder.record(packet.timestamp_ns); });
+        auto enqueue = [&](const PacketDescriptor& packet) { tree.enqueue_packet(packet, LEAF_ID); };
+
+        produce_light(enqueue, packets);
+        wait_for(recorder, packets);
+        recorder.report("light load (40%)");
+        produce_bursts(enqueue, packets);
+        wait_for(recorder, packets);
+        recorder.report("bursts (40 x 1000 B)");
+        report_idle_cpu("idle");
+    }
+
+    std::cout << "After: timer-wheel release thread" << std::endl;
+    {
+        TrafficShapingManager manager;
+        manager.initialize();
+        manager.add_interface("eth0");
+        manager.configure_htb("eth0", make_tree());
+        manager.set_packet_callback([&](const PacketInfo& packet) {
+            recorder.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                packet.timestamp.time_since_epoch()).count()));
+        });
+        manager.start();
+        auto enqueue = [&](const PacketDescriptor& packet) { manager.process_packet("eth0", packet); };
+
+        produce_light(enqueue, packets);
+        wait_for(recorder, packets);
+        recorder.report("light load (40%)");
+        produce_bursts(enqueue, packets);
+        wait_for(recorder, packets);
+        recorder.report("bursts (40 x 1000 B)");
+        report_idle_cpu("idle");
+        manager.stop();
+    }
+
+    return 0;
+}
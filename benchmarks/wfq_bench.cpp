@@ -0,0 +1,181 @@
+// WFQ scheduler benchmark.
+//
+// WeightedFairQueue: dequeue cost with 8, 64 and 256 backlogged classes,
+// for the heap scheduler against the previous std::map scan (kept here as
+// a reference).
+//
+// WFQ (WF2Q+ in traffic_shaping.h): enqueue and dequeue cost separately
+// for 2, 4 and 8 queues filled to the per-queue limit.
+//
+// Usage: wfq_bench [dequeues_per_run]
+
+#include "traffic_shaping.h"
+#include "traffic_shaping/wfq.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <map>
+#include <queue>
+#include <cstdlib>
+
+using namespace RouterSim;
+
+namespace {
+
+const size_t CLASS_COUNTS[] = {8, 64, 256};
+const size_t DEPTH = 32;
+const uint32_t WF2Q_QUEUE_COUNTS[] = {2, 4, 8};
+
+// The scheduler this tree used before the heap: a scan over every class
+// queue on each dequeue, with a linear weight lookup on each enqueue
+class LinearScanQueue {
+public:
+    explicit LinearScanQueue(const std::vector<WFQClass>& classes) : classes_(classes), virtual_time_(0) {
+        for (const auto& wfq_class : classes_) {
+            queues_[wfq_class.class_id];
+        }
+    }
+
+    void enqueue(const PacketDescriptor& packet, uint8_t class_id) {
+        uint32_t weight = 1;
+        for (const auto& wfq_class : classes_) {
+            if (wfq_class.class_id == class_id) {
+                weight = wfq_class.weight;
+                break;
+            }
+        }
+        QueueItem item;
+        item.packet = packet;
+        item.class_id = class_id;
+        item.virtual_finish_time = virtual_time_ + (packet.size * 8) / weight;
+        queues_[class_id].push(item);
+    }
+
+    bool dequeue(PacketDescriptor& packet) {
+        uint64_t min_finish_time = UINT64_MAX;
+        std::queue<QueueItem>* selected = nullptr;
+        for (auto& [class_id, queue] : queues_) {
+            if (!queue.empty() && queue.front().virtual_finish_time < min_finish_time) {
+                min_finish_time = queue.front().virtual_finish_time;
+                selected = &queue;
+            }
+        }
+        if (!selected) {
+            return false;
+        }
+        packet = selected->front().packet;
+        selected->pop();
+        virtual_time_ = std::max(virtual_time_, min_finish_time);
+        return true;
+    }
+
+private:
+    std::vector<WFQClass> classes_;
+    std::map<uint8_t, std::queue<QueueItem>> queues_;
+    uint64_t virtual_time_;
+};
+
+std::vector<WFQClass> make_classes(size_t count) {
+    std::vector<WFQClass> classes(count);
+    for (size_t i = 0; i < count; ++i) {
+        classes[i].class_id = static_cast<uint8_t>(i);
+        classes[i].weight = 1 + i % 16;
+    }
+    return classes;
+}
+
+// Prefills every class, then times draining the whole backlog
+template <typename Enqueue, typename Dequeue>
+double time_dequeues(size_t classes, size_t target, const std::vector<PacketDescriptor>& packets,
+                     Enqueue enqueue, Dequeue dequeue) {
+    double elapsed = 0;
+    size_t done = 0;
+    size_t next = 0;
+    while (done < target) {
+        for (size_t d = 0; d < DEPTH; ++d) {
+            for (size_t c = 0; c < classes; ++c) {
+                enqueue(packets[next++ % packets.size()], static_cast<uint8_t>(c));
+            }
+        }
+        PacketDescriptor out;
+        auto start = std::chrono::steady_clock::now();
+        while (dequeue(out)) {
+            done++;
+        }
+        elapsed += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return elapsed * 1e9 / done;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t target = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+
+    std::mt19937 rng(1);
+    std::vector<PacketDescriptor> packets(65536);
+    for (auto& packet : packets) {
+        packet = PacketDescriptor{};
+        packet.set_ipv4(rng(), rng());
+        packet.size = 64 + rng() % 1400;
+    }
+
+    std::cout << "WFQ dequeue cost (" << DEPTH << " packets queued per class)" << std::endl;
+    std::cout << "  " << std::left << std::setw(10) << "classes"
+              << std::right << std::setw(16) << "map scan" << std::setw(16) << "heap" << std::endl;
+    for (size_t classes : CLASS_COUNTS) {
+        auto config = make_classes(classes);
+
+        LinearScanQueue linear(config);
+        double linear_ns = time_dequeues(classes, target, packets,
+            [&](const PacketDescriptor& p, uint8_t c) { linear.enqueue(p, c); },
+            [&](PacketDescriptor& p) { return linear.dequeue(p); });
+
+        WeightedFairQueue wfq;
+        wfq.initialize(config);
+        double heap_ns = time_dequeues(classes, target, packets,
+            [&](const PacketDescriptor& p, uint8_t c) { wfq.enqueue_packet(p, c); },
+            [&](PacketDescriptor& p) { return wfq.dequeue_packet(p); });
+
+        std::cout << "  " << std::left << std::setw(10) << classes << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(10) << linear_ns << " ns/op"
+                  << std::setw(10) << heap_ns << " ns/op" << std::endl;
+    }
+
+    std::cout << std::endl << "WFQ (WF2Q+, 1 Gb/s link, " << WFQ::MAX_QUEUE_SIZE
+              << " packets per queue)" << std::endl;
+    for (uint32_t queues : WF2Q_QUEUE_COUNTS) {
+        WFQ wfq(queues);
+        for (uint32_t i = 0; i < queues; ++i) {
+            wfq.setQueueWeight(i, 1 + i);
+        }
+
+        double enqueue_seconds = 0;
+        double dequeue_seconds = 0;
+        size_t done = 0;
+        size_t next = 0;
+        size_t round = queues * WFQ::MAX_QUEUE_SIZE;
+        while (done < target) {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < round; ++i) {
+                wfq.enqueue(i % queues, packets[next++ % packets.size()]);
+            }
+            enqueue_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            PacketDescriptor out;
+            start = std::chrono::steady_clock::now();
+            while (wfq.dequeue(out)) {
+                done++;
+            }
+            dequeue_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        std::cout << "  " << std::left << std::setw(10) << queues << std::right << std::fixed
+                  << std::setprecision(1) << "enqueue" << std::setw(8) << enqueue_seconds * 1e9 / done << " ns/op"
+                  << "   dequeue" << std::setw(8) << dequeue_seconds * 1e9 / done << " ns/op" << std::endl;
+    }
+
+    return 0;
+}
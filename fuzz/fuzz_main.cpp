@@ -0,0 +1,152 @@
+// Stand-in for libFuzzer's main() where the compiler has no -fsanitize=fuzzer.
+//
+// Every corpus file is run once, then -runs=N inputs are made from them
+// by random byte flips, inserts, erases, truncations and splices (with a
+// fixed seed, so a failure reproduces). The input that crashed is left in
+// crash-input in the working directory.
+//
+// Usage: <fuzz target> [-runs=N] [-seed=S] [corpus files or directories...]
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+namespace {
+
+const size_t MAX_INPUT_SIZE = 8192;
+const uint8_t INTERESTING_BYTES[] = {0x00, 0x01, 0x02, 0x04, 0x10, 0x20, 0x21, 0x40, 0x7f, 0x80, 0xc0, 0xff};
+
+void read_file(const std::string& path, std::vector<std::vector<uint8_t>>& corpus) {
+    std::ifstream file(path, std::ios::binary);
+    if (file) {
+        corpus.emplace_back(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+}
+
+void read_path(const std::string& path, std::vector<std::vector<uint8_t>>& corpus) {
+    struct stat info{};
+    if (stat(path.c_str(), &info) != 0) {
+        std::cerr << "cannot read " << path << ": " << strerror(errno) << std::endl;
+        return;
+    }
+    if (!S_ISDIR(info.st_mode)) {
+        read_file(path, corpus);
+        return;
+    }
+    // In name order, so -seed picks the same inputs everywhere
+    std::vector<std::string> names;
+    DIR* directory = opendir(path.c_str());
+    while (dirent* entry = directory ? readdir(directory) : nullptr) {
+        if (entry->d_name[0] != '.') {
+            names.push_back(entry->d_name);
+        }
+    }
+    if (directory) {
+        closedir(directory);
+    }
+    std::sort(names.begin(), names.end());
+    for (const auto& name : names) {
+        read_file(path + "/" + name, corpus);
+    }
+}
+
+void mutate(std::vector<uint8_t>& input, const std::vector<std::vector<uint8_t>>& corpus, std::mt19937_64& random) {
+    size_t mutations = 1 + random() % 4;
+    for (size_t m = 0; m < mutations; ++m) {
+        size_t position = input.empty() ? 0 : random() % input.size();
+        switch (random() % 6) {
+            case 0:
+                if (!input.empty()) {
+                    input[position] ^= static_cast<uint8_t>(1u << (random() % 8));
+                }
+                break;
+            case 1:
+                if (!input.empty()) {
+                    input[position] = INTERESTING_BYTES[random() % sizeof(INTERESTING_BYTES)];
+                }
+                break;
+            case 2:
+                if (input.size() < MAX_INPUT_SIZE) {
+                    input.insert(input.begin() + position, static_cast<uint8_t>(random()));
+                }
+                break;
+            case 3:
+                if (!input.empty()) {
+                    input.erase(input.begin() + position);
+                }
+                break;
+            case 4:
+                input.resize(position);
+                break;
+            case 5: {
+                // Splice in a piece of another input
+                const auto& other = corpus[random() % corpus.size()];
+                if (!other.empty()) {
+                    size_t from = random() % other.size();
+                    size_t length = std::min<size_t>(1 + random() % 64, other.size() - from);
+                    if (input.size() + length <= MAX_INPUT_SIZE) {
+                        input.insert(input.begin() + position, other.begin() + from, other.begin() + from + length);
+                    }
+                }
+                break;
+            }
+        }
+    }
+}
+
+std::vector<uint8_t> current;
+
+void save_crash(int) {
+    std::ofstream("crash-input", std::ios::binary).write(reinterpret_cast<const char*>(current.data()),
+                                                          static_cast<std::streamsize>(current.size()));
+    std::_Exit(1);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint64_t runs = 0;
+    uint64_t seed = 1;
+    std::vector<std::vector<uint8_t>> corpus;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument.rfind("-runs=", 0) == 0) {
+            runs = std::strtoull(argument.c_str() + 6, nullptr, 10);
+        } else if (argument.rfind("-seed=", 0) == 0) {
+            seed = std::strtoull(argument.c_str() + 6, nullptr, 10);
+        } else {
+            read_path(argument, corpus);
+        }
+    }
+    if (corpus.empty()) {
+        corpus.emplace_back();
+    }
+    std::signal(SIGABRT, save_crash);
+    std::signal(SIGSEGV, save_crash);
+
+    for (const auto& input : corpus) {
+        current = input;
+        LLVMFuzzerTestOneInput(current.data(), current.size());
+    }
+    std::mt19937_64 random(seed);
+    for (uint64_t run = 0; run < runs; ++run) {
+        current = corpus[random() % corpus.size()];
+        mutate(current, corpus, random);
+        LLVMFuzzerTestOneInput(current.data(), current.size());
+    }
+    std::cout << "Done " << corpus.size() << " corpus inputs and " << runs << " mutated runs" << std::endl;
+    return 0;
+}
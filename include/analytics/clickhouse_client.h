@@ -0,0 +1,296 @@
+#pragma once
+
+#include "analytics/segment_journal.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace clickhouse {
+class Client;
+}
+
+namespace RouterSim {
+
+// Rows of the analytics tables; timestamps are milliseconds since the epoch
+
+struct NetworkMetric {
+    uint64_t timestamp = 0;
+    std::string router_id;
+    std::string interface;
+    std::string metric_type;
+    double value = 0.0;
+    std::map<std::string, std::string> tags;
+};
+
+struct PacketFlow {
+    uint64_t timestamp = 0;
+    std::string src_ip;
+    std::string dst_ip;
+    uint16_t src_port = 0;
+    uint16_t dst_port = 0;
+    uint8_t protocol = 0;
+    uint64_t bytes = 0;
+    uint64_t packets = 0;
+    uint64_t duration_ms = 0;
+    std::string router_id;
+};
+
+struct BGPUpdate {
+    uint64_t timestamp = 0;
+    std::string router_id;
+    std::string neighbor_ip;
+    std::string prefix;
+    uint8_t prefix_length = 0;
+    std::vector<uint32_t> as_path;
+    std::string next_hop;
+    std::string origin;
+    uint32_t local_pref = 0;
+    uint32_t med = 0;
+    std::vector<std::string> communities;
+    std::string action;
+};
+
+struct OSPFUpdate {
+    uint64_t timestamp = 0;
+    std::string router_id;
+    std::string area_id;
+    uint8_t lsa_type = 0;
+    std::string lsa_id;
+    std::string advertising_router;
+    uint32_t sequence_number = 0;
+    uint16_t age = 0;
+    uint16_t checksum = 0;
+    uint16_t length = 0;
+    std::string action;
+};
+
+struct ISISUpdate {
+    uint64_t timestamp = 0;
+    std::string system_id;
+    std::string area_id;
+    uint8_t level = 0;
+    std::string lsp_id;
+    uint32_t sequence_number = 0;
+    uint16_t remaining_lifetime = 0;
+    uint16_t checksum = 0;
+    uint16_t pdu_length = 0;
+    std::string action;
+};
+
+struct TrafficShapingMetric {
+    uint64_t timestamp = 0;
+    std::string router_id;
+    std::string interface;
+    std::string algorithm;
+    uint8_t class_id = 0;
+    uint64_t packets_processed = 0;
+    uint64_t packets_dropped = 0;
+    uint64_t bytes_processed = 0;
+    uint64_t bytes_dropped = 0;
+    uint32_t queue_length = 0;
+    double throughput_bps = 0.0;
+};
+
+struct NetemImpairment {
+    uint64_t timestamp = 0;
+    std::string router_id;
+    std::string interface;
+    std::string impairment_type;
+    std::map<std::string, std::string> parameters;
+    bool active = false;
+};
+
+// One window of a metric series, from MetricRollupAggregator
+struct MetricRollup {
+    uint64_t timestamp = 0;                     // window start
+    uint32_t window_ms = 0;
+    std::string router_id;
+    std::string interface;
+    std::string metric_type;
+    uint64_t count = 0;
+    double sum = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double p999 = 0.0;
+    uint64_t unique_flows = 0;                  // HyperLogLog estimate, unique_flows series only
+    std::string quantile_sketch;                // serialized DDSketch, to merge windows later
+};
+
+struct ClickHouseFlushOptions {
+    bool background = true;                     // flush on a dedicated thread, not the inserter's
+    uint32_t flush_interval_ms = 1000;          // longest a row waits for a partial batch
+    size_t max_buffered_batches = 4;            // per table, before inserts drop rows
+    std::string journal_directory;              // spill to disk here (background only); empty to drop
+    SegmentJournalOptions journal;
+    size_t replay_batch_rows = 65536;           // journaled rows sent per block and per replay pass
+};
+
+// Batched writer for the analytics tables over the native protocol.
+//
+// Every table is buffered as the clickhouse-cpp columns it is inserted
+// with: insert_*() appends the row's fields to those columns in place, and
+// a flush sends them as a single block and clears them, keeping their
+// capacity for the next batch. Router ids, interface names and other
+// short enumerations are LowCardinality(String), so a batch carries each
+// distinct value once plus an index per row.
+//
+// Each table has two column sets. Inserters append to the active one
+// under the table's lock, which is only ever held for the append and the
+// swap. A flush swaps the sets and sends the standby one without the lock,
+// so inserts carry on into the other. With background flushing a full
+// batch wakes the flusher thread and insert_*() never waits for network
+// I/O; partial batches are sent every flush_interval_ms. Without it, the
+// inserter that fills a batch sends it itself, as before.
+//
+// When the server falls behind and a table has max_buffered_batches
+// batches waiting, further rows are dropped and counted rather than
+// blocking the caller. A failed insert keeps its block and is retried
+// before the next swap. flush_*() and flush_all_buffers() send what is
+// buffered on the calling thread; disconnect() stops the flusher and
+// does the same.
+//
+// With a journal directory and background flushing, blocks that cannot
+// go to the server are spilled to a SegmentJournal instead: when an insert
+// fails, while the server is unreachable, and when a table is
+// backlogged. connect() then succeeds even if the server is down, and the
+// flusher reconnects every flush_interval_ms. Once the server is back and
+// no table has a full batch waiting, the flusher replays the journal in
+// passes of replay_batch_rows rows, merging records into large blocks per
+// table.
+// Replay is at least once: a pass that fails part way is retried whole.
+// Rows the journal has no room for are dropped and counted.
+class ClickHouseClient {
+public:
+    // Rows per block before an insert flushes it
+    static constexpr size_t METRIC_BATCH_ROWS = 1000;
+    static constexpr size_t UPDATE_BATCH_ROWS = 100;
+
+    struct Statistics {
+        uint64_t rows_inserted;
+        uint64_t blocks_inserted;
+        uint64_t insert_failures;
+        uint64_t rows_dropped;                  // buffers or journal full
+        uint64_t rows_journaled;
+        uint64_t rows_replayed;                 // from the journal to the server
+        uint64_t records_skipped;               // journal records that did not decode
+        double replay_seconds;                  // spent replaying
+    };
+
+    ClickHouseClient(const std::string& host = "localhost", int port = 9000,
+                     const std::string& database = "default", const std::string& user = "default",
+                     const std::string& password = "");
+    ~ClickHouseClient();
+
+    ClickHouseClient(const ClickHouseClient&) = delete;
+    ClickHouseClient& operator=(const ClickHouseClient&) = delete;
+
+    bool connect(const ClickHouseFlushOptions& options = ClickHouseFlushOptions{});
+    void disconnect();
+    bool is_connected() const;
+
+    void insert_metric(const NetworkMetric& metric);
+    void insert_packet_flow(const PacketFlow& flow);
+    void insert_bgp_update(const BGPUpdate& update);
+    void insert_ospf_update(const OSPFUpdate& update);
+    void insert_isis_update(const ISISUpdate& update);
+    void insert_traffic_shaping_metric(const TrafficShapingMetric& metric);
+    void insert_netem_impairment(const NetemImpairment& impairment);
+    void insert_metric_rollup(const MetricRollup& rollup);
+
+    void flush_all_buffers();
+    void flush_metrics();
+    void flush_packet_flows();
+    void flush_bgp_updates();
+    void flush_ospf_updates();
+    void flush_isis_updates();
+    void flush_traffic_shaping_metrics();
+    void flush_netem_impairments();
+    void flush_metric_rollups();
+
+    std::vector<std::map<std::string, std::string>> query(const std::string& query);
+
+    Statistics get_statistics() const;
+    SegmentJournal::Statistics get_journal_statistics() const;
+
+private:
+    enum TableId {
+        METRICS,
+        PACKET_FLOWS,
+        BGP_UPDATES,
+        OSPF_UPDATES,
+        ISIS_UPDATES,
+        TRAFFIC_SHAPING,
+        NETEM_IMPAIRMENTS,
+        METRIC_ROLLUPS,
+        TABLE_COUNT
+    };
+
+    struct TableColumns;
+    struct MetricColumns;
+    struct PacketFlowColumns;
+    struct BGPUpdateColumns;
+    struct OSPFUpdateColumns;
+    struct ISISUpdateColumns;
+    struct TrafficShapingColumns;
+    struct NetemImpairmentColumns;
+    struct MetricRollupColumns;
+    struct Table;
+
+    std::string host_;
+    int port_;
+    std::string database_;
+    std::string user_;
+    std::string password_;
+    std::string connection_string_;
+    std::atomic<bool> connected_;
+    ClickHouseFlushOptions options_;
+
+    std::unique_ptr<clickhouse::Client> client_;
+    std::atomic<bool> server_available_;
+    std::unique_ptr<SegmentJournal> journal_;
+    // The native client is not thread-safe; tables may flush from several threads
+    std::mutex client_mutex_;
+    std::vector<std::unique_ptr<Table>> tables_;
+
+    std::thread flusher_;
+    std::mutex flusher_mutex_;
+    std::condition_variable flusher_cv_;
+    bool flush_requested_;
+    bool stopping_;
+
+    std::atomic<uint64_t> rows_inserted_;
+    std::atomic<uint64_t> blocks_inserted_;
+    std::atomic<uint64_t> insert_failures_;
+    std::atomic<uint64_t> rows_journaled_;
+    std::atomic<uint64_t> rows_replayed_;
+    std::atomic<uint64_t> records_skipped_;
+    std::atomic<uint64_t> replay_ns_;
+
+    // Connects client_ and creates the tables; throws when the server is unreachable
+    void open_client();
+    void create_tables();
+    template <typename Columns, typename Append>
+    void insert_row(TableId id, Append append);
+    void request_flush(Table& table);
+    void flusher_loop();
+    // Sends a failed block again, or swaps and sends the active one
+    bool flush_table(Table& table);
+    // Sends the columns, or journals them when the server cannot take them now
+    bool deliver(Table& table, TableColumns& columns);
+    bool send_block(const char* table, TableColumns& columns);
+    void spill(Table& table, TableColumns& columns);
+    bool reconnect();
+    // One pass of at most replay_batch_rows journaled rows
+    void replay_journal();
+};
+
+} // namespace RouterSim
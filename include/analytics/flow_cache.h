@@ -0,0 +1,156 @@
+#pragma once
+
+#include "packet_descriptor.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace RouterSim {
+
+struct PacketFlow;
+
+// Directional 5-tuple of a data-path packet
+struct FlowKey {
+    IpAddress src_addr;
+    IpAddress dst_addr;
+    uint16_t src_port;
+    uint16_t dst_port;
+    uint8_t protocol;
+
+    static FlowKey from_packet(const PacketDescriptor& packet) {
+        return FlowKey{packet.src_addr, packet.dst_addr, packet.src_port, packet.dst_port, packet.protocol};
+    }
+
+    bool operator==(const FlowKey& other) const {
+        return src_port == other.src_port && dst_port == other.dst_port && protocol == other.protocol &&
+               src_addr == other.src_addr && dst_addr == other.dst_addr;
+    }
+};
+
+// Well-mixed 64-bit hash, also fit for HyperLogLog
+uint64_t hash_flow_key(const FlowKey& key);
+
+enum class FlowExportReason : uint8_t {
+    ACTIVE_TIMEOUT,                             // long-lived flow, reported in parts
+    IDLE_TIMEOUT,
+    EVICTED,                                    // slot needed for a new flow
+    FLUSHED
+};
+
+struct FlowRecord {
+    FlowKey key;
+    uint64_t packets;
+    uint64_t bytes;
+    uint64_t first_ns;                          // PacketDescriptor::timestamp_ns of the first packet
+    uint64_t last_ns;
+    FlowExportReason reason;
+};
+
+struct FlowCacheOptions {
+    size_t capacity = 65536;                    // flows, rounded up to a power of two
+    uint32_t active_timeout_ms = 60000;
+    uint32_t idle_timeout_ms = 15000;
+    size_t max_probe = 16;                      // slots searched for a flow before evicting
+};
+
+// IPFIX-style flow cache: aggregates packets into per-flow counters and
+// hands a FlowRecord to the export callback only when a flow ends, so a
+// flow costs one analytics row instead of one per packet.
+//
+// Flows live in an open-addressing table with linear probing. A flow is
+// found within max_probe slots of its home slot; a new flow that finds
+// none of those free evicts the least recently seen flow among them.
+// Removal shifts the following entries back, so the table never holds
+// tombstones.
+//
+// Time is the packets' timestamp_ns. A flow is exported once no packet
+// has been seen for idle_timeout_ms, and every active_timeout_ms while it
+// keeps going (counting starts over, the flow stays cached). Timeouts are
+// found by a sweep: update_burst() sweeps a couple of slots per packet,
+// and expire() sweeps the whole table, for callers to run when traffic is
+// light. flush() exports everything.
+//
+// Not thread-safe: one cache per data-path thread.
+class FlowCache {
+public:
+    using ExportCallback = std::function<void(const FlowRecord& record)>;
+
+    struct Statistics {
+        uint64_t packets;
+        uint64_t bytes;
+        uint64_t hits;                          // packets of a cached flow
+        uint64_t misses;                        // packets starting a flow
+        uint64_t evictions;
+        uint64_t active_timeouts;
+        uint64_t idle_timeouts;
+        uint64_t flushed;
+        uint64_t records_exported;
+        size_t flows_active;
+        size_t capacity;
+        double hit_rate;                        // hits / packets
+        double eviction_rate;                   // evictions / misses
+        double ns_per_packet;                   // in update_burst()
+    };
+
+    FlowCache(const FlowCacheOptions& options, ExportCallback on_export);
+
+    void update(const PacketDescriptor& packet);
+    void update_burst(const PacketDescriptor* packets, size_t count);
+
+    // Exports flows past a timeout at now_ns
+    void expire(uint64_t now_ns);
+    void flush();
+
+    size_t size() const { return count_; }
+    size_t capacity() const { return entries_.size(); }
+
+    Statistics get_statistics() const;
+    void reset_statistics();
+
+private:
+    struct Entry {
+        FlowKey key;
+        uint64_t packets;
+        uint64_t bytes;
+        uint64_t first_ns;
+        uint64_t last_ns;
+    };
+
+    // Tags are kept apart from the entries so a probe reads one cache
+    // line; 0 marks a free slot
+    std::vector<uint32_t> tags_;
+    std::vector<Entry> entries_;
+    size_t mask_;
+    size_t max_probe_;
+    size_t count_;
+    size_t sweep_cursor_;
+    uint64_t active_timeout_ns_;
+    uint64_t idle_timeout_ns_;
+    ExportCallback on_export_;
+
+    uint64_t packets_;
+    uint64_t bytes_;
+    uint64_t hits_;
+    uint64_t misses_;
+    uint64_t evictions_;
+    uint64_t active_timeouts_;
+    uint64_t idle_timeouts_;
+    uint64_t flushed_;
+    uint64_t records_exported_;
+    uint64_t burst_packets_;
+    uint64_t burst_ns_;
+
+    void update_hashed(const PacketDescriptor& packet, uint64_t hash);
+    void export_entry(const Entry& entry, FlowExportReason reason);
+    // Frees slot and shifts the entries probing through it back
+    void remove(size_t slot);
+    // Checks count slots from the sweep cursor; full sweep when count covers the table
+    void sweep(uint64_t now_ns, size_t count);
+};
+
+// Analytics row for an exported flow; timestamp in wall-clock milliseconds
+PacketFlow to_packet_flow(const FlowRecord& record, const std::string& router_id);
+
+} // namespace RouterSim
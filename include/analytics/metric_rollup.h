@@ -0,0 +1,101 @@
+#pragma once
+
+#include "analytics/clickhouse_client.h"
+#include "analytics/sketches.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace RouterSim {
+
+struct MetricRollupOptions {
+    uint32_t window_ms = 10000;
+    double relative_accuracy = 0.01;            // of the quantiles
+    uint8_t flow_precision = 12;                // HyperLogLog registers, 2^precision bytes per interface
+};
+
+// Client-side rollups of NetworkMetric streams.
+//
+// Samples are aggregated per (router_id, interface, metric_type) into
+// fixed windows aligned to window_ms: count, sum, min, max and a DDSketch
+// for the quantiles. add_flow() feeds a HyperLogLog per (router_id,
+// interface), rolled up as the "unique_flows" metric type. A series emits
+// one MetricRollup per window instead of a row per sample; the row keeps
+// the serialized sketch so windows can be merged into longer ones later.
+//
+// A window is emitted when a sample of a later window arrives for the
+// same series, or when advance() is called past its end; callers run
+// advance() on a timer so quiet series are not held back. Samples older
+// than their series' current window, or in a window advance() has already
+// closed, are counted as late and dropped; the second holds for series
+// that were forgotten, which are those with nothing to emit on advance().
+//
+// Thread-safe; the emit callback runs under the aggregator's lock.
+class MetricRollupAggregator {
+public:
+    using EmitCallback = std::function<void(const MetricRollup& rollup)>;
+
+    static constexpr const char* UNIQUE_FLOWS = "unique_flows";
+
+    struct Statistics {
+        uint64_t samples;
+        uint64_t flow_samples;
+        uint64_t late_samples;
+        uint64_t rollups_emitted;
+        size_t series;
+    };
+
+    MetricRollupAggregator(const MetricRollupOptions& options, EmitCallback on_emit);
+
+    void add(const NetworkMetric& metric);
+    // flow_hash as from hash_flow_key(); timestamp in milliseconds
+    void add_flow(const std::string& router_id, const std::string& interface, uint64_t timestamp,
+                  uint64_t flow_hash);
+
+    // Emits every window that ended by now (milliseconds)
+    void advance(uint64_t now);
+    void flush();
+
+    Statistics get_statistics() const;
+
+private:
+    struct Series {
+        std::string router_id;
+        std::string interface;
+        std::string metric_type;
+        uint64_t window_start = 0;
+        uint64_t open_from = 0;                 // earliest window still taking samples
+        uint64_t count = 0;
+        double sum = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+        DDSketch sketch;
+        std::unique_ptr<HyperLogLog> flows;     // unique_flows series only
+
+        explicit Series(double relative_accuracy) : sketch(relative_accuracy) {}
+    };
+
+    MetricRollupOptions options_;
+    EmitCallback on_emit_;
+    mutable std::mutex mutex_;
+    // Keyed by the three names joined with '\0'
+    std::unordered_map<std::string, Series> series_;
+    std::string key_;                           // lookup buffer
+    MetricRollup row_;                          // emit buffer
+
+    uint64_t closed_before_;                    // windows starting earlier were closed by advance()
+    uint64_t samples_;
+    uint64_t flow_samples_;
+    uint64_t late_samples_;
+    uint64_t rollups_emitted_;
+
+    // Series for the names, ready to take a sample at timestamp; nullptr when late
+    Series* series_for(const std::string& router_id, const std::string& interface, const std::string& metric_type,
+                       uint64_t timestamp);
+    void emit(Series& series);
+};
+
+} // namespace RouterSim
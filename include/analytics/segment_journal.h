@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace RouterSim {
+
+enum class JournalCompression : uint32_t {
+    NONE = 0,
+    LZ4 = 1,                                    // when built with liblz4
+    ZSTD = 2                                    // when built with libzstd
+};
+
+struct SegmentJournalOptions {
+    size_t segment_bytes = 16 << 20;            // rounded up to whole pages
+    size_t max_bytes = size_t(1) << 30;         // all segments together
+    JournalCompression compression = JournalCompression::LZ4;   // NONE when not built in
+    int zstd_level = 1;
+};
+
+// Append-only journal of opaque records in memory-mapped segment files.
+//
+// A directory holds numbered segments of segment_bytes each. Records are
+// appended to the newest one, compressed when that makes them smaller and
+// checksummed, and a full segment is sealed and a new one started. The
+// journal never holds more than max_bytes of segments: once that many
+// exist, append() refuses records until replay frees a segment.
+//
+// Reading starts at the oldest record not yet replayed. read() moves a
+// cursor forward; commit() marks everything read so far as replayed, which
+// is recorded in the segment header and deletes segments that are done;
+// rewind() returns to the last commit so a failed replay is retried. So
+// records are delivered at least once across crashes and reopening.
+//
+// open() recovers an existing directory: each segment is scanned up to its
+// first torn or corrupt record, and appending continues after the last
+// good one. All methods are safe to call from several threads.
+class SegmentJournal {
+public:
+    struct Record {
+        uint32_t tag;                           // caller's record type
+        uint32_t rows;                          // caller's item count
+        std::vector<uint8_t> data;
+    };
+
+    struct Statistics {
+        uint64_t records_written;
+        uint64_t records_rejected;              // journal full or record too large
+        uint64_t records_replayed;
+        uint64_t rows_pending;                  // written and not yet replayed
+        uint64_t bytes_written;                 // before compression
+        uint64_t bytes_stored;                  // after compression, with record headers
+        uint64_t bytes_on_disk;                 // segment files
+        size_t segments;
+    };
+
+    SegmentJournal();
+    ~SegmentJournal();
+
+    SegmentJournal(const SegmentJournal&) = delete;
+    SegmentJournal& operator=(const SegmentJournal&) = delete;
+
+    bool open(const std::string& directory, const SegmentJournalOptions& options = SegmentJournalOptions{});
+    void close();
+    bool is_open() const;
+
+    // False when the record was not journaled
+    bool append(uint32_t tag, uint32_t rows, const void* data, size_t length);
+
+    // Next record after the cursor; false when there is none
+    bool read(Record& record);
+    void commit();
+    void rewind();
+    // Records not yet replayed exist
+    bool has_pending() const;
+
+    Statistics get_statistics() const;
+
+    // Whether the codec was compiled in
+    static bool supports(JournalCompression compression);
+
+private:
+    struct Segment {
+        uint64_t sequence;
+        std::string path;
+        uint8_t* map;
+        size_t size;
+        size_t write_offset;                    // end of the last good record
+    };
+
+    static constexpr size_t HEADER_SIZE = 64;
+    static constexpr size_t RECORD_HEADER_SIZE = 32;
+
+    mutable std::mutex mutex_;
+    std::string directory_;
+    SegmentJournalOptions options_;
+    std::deque<Segment> segments_;              // oldest first, the last one is appended to
+    size_t read_segment_;                       // cursor: index into segments_
+    size_t read_offset_;
+    uint64_t next_sequence_;
+    std::vector<uint8_t> scratch_;
+
+    uint64_t records_written_;
+    uint64_t records_rejected_;
+    uint64_t records_replayed_;
+    uint64_t read_records_;                     // since the last commit
+    uint64_t read_rows_;
+    uint64_t rows_pending_;
+    uint64_t bytes_written_;
+    uint64_t bytes_stored_;
+
+    bool create_segment();
+    bool map_segment(const std::string& path, uint64_t sequence, bool create, Segment& segment);
+    bool recover_segment(Segment& segment);
+    void unmap_segment(Segment& segment, bool remove);
+    // Record at offset in segment, when whole and intact; its length with padding
+    bool parse_record(const Segment& segment, size_t offset, size_t& length, uint32_t* rows = nullptr) const;
+    static uint64_t& replayed_offset(Segment& segment);
+};
+
+} // namespace RouterSim
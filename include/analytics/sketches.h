@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace RouterSim {
+
+// Quantile sketch with relative error guarantees (DDSketch, Masson et al.,
+// VLDB 2019).
+//
+// Values fall into logarithmic buckets: bucket i holds (gamma^(i-1),
+// gamma^i] with gamma = (1 + a) / (1 - a), so any quantile is answered
+// within a relative error a of an actual sample, whatever the spread.
+// Negative values go to a mirrored set of buckets and values too close to
+// 0 to index are counted as 0. Sketches with the same accuracy merge
+// exactly, which is what makes them usable for rollups: the sketch of an
+// hour is the merge of its minutes.
+//
+// Memory is at most max_buckets counters per sign. A sketch that would
+// need more folds its lowest buckets together, so the accuracy of the
+// smallest values goes first and the upper quantiles keep theirs.
+class DDSketch {
+public:
+    explicit DDSketch(double relative_accuracy = 0.01, size_t max_buckets = 2048);
+
+    void add(double value, uint64_t count = 1);
+    // False when the accuracies differ
+    bool merge(const DDSketch& other);
+    // q in [0, 1]; 0 when empty
+    double quantile(double q) const;
+
+    uint64_t count() const { return zero_count_ + positive_.total + negative_.total; }
+    bool empty() const { return count() == 0; }
+    double relative_accuracy() const { return relative_accuracy_; }
+    size_t bucket_count() const { return positive_.counts.size() + negative_.counts.size(); }
+    void clear();
+
+    // Compact binary form: varint counts per bucket
+    void serialize(std::string& out) const;
+    bool deserialize(const void* data, size_t length);
+
+private:
+    struct Store {
+        std::vector<uint64_t> counts;
+        int32_t offset = 0;                     // index of counts[0]
+        uint64_t total = 0;
+
+        void add(int32_t index, uint64_t count, size_t max_buckets);
+        void clear();
+    };
+
+    double relative_accuracy_;
+    double gamma_;
+    double log_gamma_;
+    double min_indexable_;
+    size_t max_buckets_;
+    Store positive_;
+    Store negative_;
+    uint64_t zero_count_;
+
+    void set_accuracy(double relative_accuracy);
+    int32_t index(double magnitude) const;
+    double value(int32_t index) const;
+};
+
+// Distinct count estimate (HyperLogLog, Flajolet et al. 2007).
+//
+// 2^precision one-byte registers; the standard error is 1.04 /
+// sqrt(2^precision), about 1.6% at the default of 12 (4 KiB). Small
+// counts use linear counting. Takes 64-bit hashes, which must already be
+// well mixed; sketches of the same precision merge exactly.
+class HyperLogLog {
+public:
+    explicit HyperLogLog(uint8_t precision = 12);
+
+    void add(uint64_t hash);
+    // False when the precisions differ
+    bool merge(const HyperLogLog& other);
+    double estimate() const;
+
+    uint8_t precision() const { return precision_; }
+    void clear();
+
+private:
+    uint8_t precision_;
+    std::vector<uint8_t> registers_;
+};
+
+} // namespace RouterSim
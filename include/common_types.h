@@ -9,6 +9,7 @@
 #include <memory>
 #include <mutex>
 #include <atomic>
+#include "packet_descriptor.h"
 
 namespace RouterSim {
 
@@ -31,6 +32,10 @@ struct PacketInfo {
     }
 };
 
+// Conversions between the string-based PacketInfo and the data-path descriptor
+PacketDescriptor to_packet_descriptor(const PacketInfo& packet);
+PacketInfo to_packet_info(const PacketDescriptor& descriptor);
+
 // Route information
 struct RouteInfo {
     std::string destination;
@@ -126,7 +131,9 @@ enum class Protocol {
 enum class ShapingAlgorithm {
     TOKEN_BUCKET,
     WEIGHTED_FAIR_QUEUE,
-    RATE_LIMITING
+    RATE_LIMITING,
+    DEFICIT_ROUND_ROBIN,
+    HIERARCHICAL_TOKEN_BUCKET
 };
 
 // Token bucket configuration
@@ -139,6 +146,29 @@ struct TokenBucketConfig {
     TokenBucketConfig() : capacity(1000), rate(100), burst_size(500), allow_burst(true) {}
 };
 
+// Deficit round robin configuration; a class's quantum is quantum * weight
+struct DRRConfig {
+    uint32_t quantum;
+    bool sparse_flow_priority;   // DRR++: newly active classes are served first
+    
+    DRRConfig() : quantum(1514), sparse_flow_priority(false) {}
+};
+
+// HTB class configuration. Rates are bits per second, bursts bytes.
+// parent_id 0 marks a root class; class ids must be non-zero.
+struct HTBClassConfig {
+    uint32_t class_id;
+    uint32_t parent_id;
+    std::string name;
+    uint64_t rate;       // guaranteed rate
+    uint64_t ceil;       // maximum rate when borrowing; 0 means rate
+    uint32_t burst;      // bytes that may be sent at line speed above rate
+    uint32_t cburst;     // same for ceil
+    uint32_t quantum;    // share of borrowed bandwidth among siblings
+    
+    HTBClassConfig() : class_id(0), parent_id(0), rate(0), ceil(0), burst(15140), cburst(15140), quantum(1514) {}
+};
+
 // WFQ class configuration
 struct WFQClass {
     uint8_t class_id;
@@ -147,70 +177,19 @@ struct WFQClass {
     uint64_t max_bandwidth;
     std::string name;
     bool is_active;
+    std::map<std::string, std::string> attributes;
     
     WFQClass() : class_id(0), weight(1), min_bandwidth(0), max_bandwidth(0), is_active(true) {}
 };
 
 // Queue item for WFQ
 struct QueueItem {
-    PacketInfo packet;
+    PacketDescriptor packet;
     uint8_t class_id;
     uint64_t virtual_finish_time;
-    std::chrono::steady_clock::time_point arrival_time;
-    
-    QueueItem() : class_id(0), virtual_finish_time(0) {
-        arrival_time = std::chrono::steady_clock::now();
-    }
-};
-
-// Delay configuration for netem
-struct DelayConfig {
-    uint32_t delay_ms;
-    uint32_t jitter_ms;
-    std::string distribution;
-    
-    DelayConfig() : delay_ms(0), jitter_ms(0), distribution("normal") {}
-};
-
-// Loss configuration for netem
-struct LossConfig {
-    std::string loss_type;
-    double loss_percentage;
-    
-    LossConfig() : loss_type("random"), loss_percentage(0.0) {}
-};
-
-// Delay distribution types
-enum class DelayDistribution {
-    NORMAL,
-    UNIFORM,
-    PARETO
-};
-
-// Loss types
-enum class LossType {
-    RANDOM,
-    STATE,
-    GEOMETRIC
-};
-
-// PCAP data structures
-struct PcapData {
-    std::vector<PacketInfo> packets;
-    std::string filename;
-    std::chrono::system_clock::time_point capture_time;
-    
-    PcapData() {
-        capture_time = std::chrono::system_clock::now();
-    }
-};
-
-struct PcapDiffOptions {
-    bool ignore_timestamps;
-    bool ignore_sequence_numbers;
-    double tolerance_percentage;
+    uint64_t enqueue_time_ns;
     
-    PcapDiffOptions() : ignore_timestamps(false), ignore_sequence_numbers(false), tolerance_percentage(0.0) {}
+    QueueItem() : packet(), class_id(0), virtual_finish_time(0), enqueue_time_ns(0) {}
 };
 
 // Callback types
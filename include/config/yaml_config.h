@@ -2,6 +2,7 @@
 
 #include "traffic_shaping.h"
 #include "netem/impairments.h"
+#include <yaml-cpp/yaml.h>
 #include <string>
 #include <vector>
 #include <map>
@@ -37,6 +38,9 @@ struct TrafficShapingConfig {
     ShapingAlgorithm algorithm = ShapingAlgorithm::TOKEN_BUCKET;
     TokenBucketConfig token_bucket_config;
     std::vector<WFQClass> wfq_classes;
+    DRRConfig drr_config;
+    std::vector<HTBClassConfig> htb_classes;   // parents before children
+    uint32_t htb_charge_batch_bytes = HierarchicalTokenBucket::DEFAULT_CHARGE_BATCH_BYTES;
 };
 
 struct NetemConfig {
@@ -85,6 +89,11 @@ public:
     TrafficShapingConfig get_traffic_shaping_config() const;
     std::vector<NetemConfig> get_netem_configs() const;
 
+    // Configures the interface's shaper from the traffic_shaping section:
+    // the algorithm with its token bucket, class weights and DRR settings,
+    // or the HTB class tree
+    bool apply_traffic_shaping(TrafficShapingManager& manager, const std::string& interface_name) const;
+
 private:
     // Internal state
     bool initialized_;
@@ -100,6 +109,7 @@ private:
     void parse_interfaces_config(const YAML::Node& node);
     void parse_protocols_config(const YAML::Node& node);
     void parse_traffic_shaping_config(const YAML::Node& node);
+    void parse_htb_class(const YAML::Node& node, uint32_t parent_id, uint32_t& next_class_id);
     void parse_netem_config(const YAML::Node& node);
     void parse_scenarios_config(const YAML::Node& node);
 
@@ -108,6 +118,7 @@ private:
     YAML::Node serialize_interfaces_config() const;
     YAML::Node serialize_protocols_config() const;
     YAML::Node serialize_traffic_shaping_config() const;
+    YAML::Node serialize_htb_class(uint32_t class_id) const;
     YAML::Node serialize_netem_config() const;
     YAML::Node serialize_scenarios_config() const;
 };
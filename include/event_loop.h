@@ -0,0 +1,103 @@
+#pragma once
+
+#include "timer_wheel.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace RouterSim {
+
+// Single-threaded reactor: epoll for descriptors, a TimerWheel for timers
+// and an eventfd for work handed over from other threads. The thread that
+// calls run() sleeps until a descriptor is ready, a timer is due or a task
+// is posted; nothing wakes it on a fixed period.
+//
+// Everything except post(), stop() and get_statistics() must be called on
+// the loop thread (or before run() starts). Callbacks may add and remove
+// descriptors and timers, including their own.
+class EventLoop {
+public:
+    using IoCallback = std::function<void(uint32_t events)>;
+    using TimerCallback = std::function<void()>;
+    using Task = std::function<void()>;
+    using TimerId = TimerWheel::TimerId;
+
+    static constexpr uint64_t DEFAULT_TIMER_RESOLUTION_NS = 1000000;   // 1 ms
+    static constexpr int MAX_EVENTS = 64;
+
+    struct Statistics {
+        uint64_t wakeups;           // returns from epoll_wait
+        uint64_t io_events;
+        uint64_t timers_fired;
+        uint64_t tasks_run;
+    };
+
+    explicit EventLoop(uint64_t timer_resolution_ns = DEFAULT_TIMER_RESOLUTION_NS);
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    bool is_open() const { return epoll_fd_ >= 0; }
+
+    // events are EPOLLIN / EPOLLOUT / ...; EPOLLERR and EPOLLHUP are always reported
+    bool add(int fd, uint32_t events, IoCallback callback);
+    bool modify(int fd, uint32_t events);
+    bool remove(int fd);
+
+    TimerId schedule(uint64_t delay_ns, TimerCallback callback);
+    bool cancel(TimerId id);
+
+    // Thread-safe; runs the task on the loop thread
+    void post(Task task);
+
+    // Dispatches until stop(), even one called before run()
+    void run();
+    // One wait of at most timeout_ms (-1: until something happens)
+    void run_once(int timeout_ms = -1);
+    // Thread-safe
+    void stop();
+
+    bool in_loop_thread() const { return std::this_thread::get_id() == loop_thread_; }
+    uint64_t now_ns() const;
+    Statistics get_statistics() const;
+
+private:
+    struct Handler {
+        uint32_t generation;
+        IoCallback callback;
+    };
+
+    int epoll_fd_;
+    int wake_fd_;
+    std::atomic<bool> stop_requested_;
+    std::thread::id loop_thread_;
+
+    // Descriptor -> handler; the generation in each epoll event tells a
+    // reused descriptor number from the one the event was for
+    std::unordered_map<int, std::shared_ptr<Handler>> handlers_;
+    uint32_t next_generation_;
+
+    TimerWheel timers_;
+    std::unordered_map<TimerId, TimerCallback> timer_callbacks_;
+
+    std::mutex tasks_mutex_;
+    std::vector<Task> tasks_;
+    std::vector<Task> running_tasks_;
+
+    std::atomic<uint64_t> wakeups_;
+    std::atomic<uint64_t> io_events_;
+    std::atomic<uint64_t> timers_fired_;
+    std::atomic<uint64_t> tasks_run_;
+
+    int wait_timeout_ms(int timeout_ms) const;
+    void run_timers();
+    void run_tasks();
+};
+
+} // namespace RouterSim
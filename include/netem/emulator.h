@@ -0,0 +1,157 @@
+#pragma once
+
+#include "common_types.h"
+#include "netem/impairments.h"
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace RouterSim {
+
+// A packet leaving an emulated link
+struct EmulatedPacket {
+    PacketInfo packet;
+    uint64_t release_ns;     // time the link delivers it
+    uint32_t link_id;
+    bool duplicate;          // extra copy made by the duplicate impairment
+    bool corrupted;          // PacketInfo has no payload, so corruption is flagged
+};
+
+struct NetemLinkStatistics {
+    std::string name;
+    uint64_t packets_in;
+    uint64_t packets_out;
+    uint64_t bytes_out;
+    uint64_t dropped_loss;
+    uint64_t dropped_limit;
+    uint64_t duplicated;
+    uint64_t corrupted;
+    uint64_t reordered;
+    size_t queue_length;
+};
+
+// In-process netem: applies delay/jitter, loss (random, 4-state Markov or
+// Gilbert-Elliott), duplication, corruption, reordering and rate limiting
+// to PacketInfo streams without tc, root or real interfaces.
+//
+// Impaired packets of every link wait in one release queue ordered by
+// release time (ties in arrival order), so thousands of links share a
+// single heap. Behaviour follows Linux netem: loss is decided before
+// duplication can rescue a packet, reordered packets skip the delay, and
+// jitter may reorder packets as it does with netem's time-sorted queue.
+//
+// Each link draws from its own generator seeded from the emulator seed
+// and the link name, so a link's impairments are reproducible regardless
+// of other links' traffic or the order links were added in. The random
+// variates are computed here rather than by <random> distributions, whose
+// output differs between standard libraries.
+class NetemEmulator {
+public:
+    static constexpr size_t DEFAULT_LIMIT = 1000;      // packets per link, as netem
+    static constexpr uint64_t DEFAULT_SEED = 1;
+    static constexpr uint32_t INVALID_LINK = UINT32_MAX;
+
+    explicit NetemEmulator(uint64_t seed = DEFAULT_SEED);
+    ~NetemEmulator();
+
+    // Link management. Reconfiguring keeps queued packets and loss state
+    uint32_t add_link(const std::string& name, const ImpairmentInfo& impairments, size_t limit = DEFAULT_LIMIT);
+    bool configure_link(uint32_t link_id, const ImpairmentInfo& impairments);
+    bool remove_link(uint32_t link_id);
+    uint32_t find_link(const std::string& name) const;
+    size_t link_count() const;
+    void clear();
+
+    // Applies the link's impairments at now_ns; false if nothing was queued
+    bool enqueue(uint32_t link_id, const PacketInfo& packet, uint64_t now_ns);
+
+    // Delivers packets due at or before now_ns in release-time order
+    size_t release(uint64_t now_ns, std::vector<EmulatedPacket>& released, size_t max_packets = SIZE_MAX);
+    uint64_t next_release_ns() const;      // 0 when nothing is queued
+    size_t queue_size() const;
+
+    // Statistics
+    NetemLinkStatistics get_link_statistics(uint32_t link_id) const;
+    void reset_statistics();
+
+private:
+    enum class LossState : uint8_t {
+        GOOD = 1,            // 4-state model: transmitting in gap period
+        BAD = 2,             // 4-state model: transmitting in burst period
+        LOST_IN_BURST = 3,
+        LOST_IN_GAP = 4
+    };
+
+    struct Link {
+        std::string name;
+        ImpairmentInfo impairments;
+        size_t limit = DEFAULT_LIMIT;
+        bool active = false;
+        uint32_t generation = 0;
+
+        uint64_t rng_state[4] = {};
+        LossState loss_state = LossState::GOOD;
+        uint32_t reorder_counter = 0;
+        uint64_t rate_tat_ns = 0;            // rate limiter theoretical arrival time
+        size_t queued = 0;
+
+        uint64_t packets_in = 0;
+        uint64_t packets_out = 0;
+        uint64_t bytes_out = 0;
+        uint64_t dropped_loss = 0;
+        uint64_t dropped_limit = 0;
+        uint64_t duplicated = 0;
+        uint64_t corrupted = 0;
+        uint64_t reordered = 0;
+    };
+
+    struct Pending {
+        PacketInfo packet;
+        uint32_t link_id;
+        uint32_t link_generation;
+        bool duplicate;
+        bool corrupted;
+    };
+
+    struct ReleaseEntry {
+        uint64_t release_ns;
+        uint64_t sequence;
+        uint32_t slot;
+
+        bool operator>(const ReleaseEntry& other) const {
+            return release_ns != other.release_ns ? release_ns > other.release_ns : sequence > other.sequence;
+        }
+    };
+
+    uint64_t seed_;
+    std::vector<Link> links_;
+    std::vector<uint32_t> free_links_;
+    std::unordered_map<std::string, uint32_t> link_ids_;
+    std::vector<Pending> pending_;
+    std::vector<uint32_t> free_slots_;
+    std::priority_queue<ReleaseEntry, std::vector<ReleaseEntry>, std::greater<ReleaseEntry>> release_queue_;
+    uint64_t sequence_;
+    size_t queued_;
+
+    mutable std::mutex mutex_;
+
+    // Internal methods
+    bool is_active(uint32_t link_id) const;
+    void seed_link(Link& link) const;
+    bool enqueue_copy(uint32_t link_id, const PacketInfo& packet, uint64_t now_ns, bool duplicate);
+    bool is_lost(Link& link);
+    uint64_t sample_delay_ns(Link& link);
+    uint64_t rate_departure_ns(Link& link, uint32_t size, uint64_t now_ns);
+
+    // xoshiro256** generator and variates
+    static uint64_t next_random(uint64_t state[4]);
+    static double uniform(uint64_t state[4]);
+    static bool chance(uint64_t state[4], double percentage);
+    static double standard_normal(uint64_t state[4]);
+    static double standard_pareto(uint64_t state[4]);
+};
+
+} // namespace RouterSim
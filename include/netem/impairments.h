@@ -1,57 +1,67 @@
 #pragma once
 
+#include "common_types.h"
 #include <string>
 #include <vector>
 #include <map>
 #include <memory>
-#include <random>
 #include <cstdint>
 
 namespace RouterSim {
 
 // Netem impairment configurations
+enum class DelayDistribution {
+    UNIFORM,
+    NORMAL,
+    PARETO,
+    PARETONORMAL
+};
+
+enum class LossType {
+    RANDOM,
+    STATE,
+    GEMODEL
+};
+
+enum class ReorderType {
+    PERCENTAGE,
+    GAP
+};
+
 struct DelayConfig {
-    uint32_t delay_ms;
-    uint32_t jitter_ms;
-    enum class DelayDistribution {
-        UNIFORM,
-        NORMAL,
-        PARETO,
-        PARETONORMAL
-    } distribution;
+    uint32_t delay_ms = 0;
+    uint32_t jitter_ms = 0;
+    DelayDistribution distribution = DelayDistribution::UNIFORM;
 };
 
 struct LossConfig {
-    enum class LossType {
-        RANDOM,
-        STATE,
-        GEMODEL
-    } loss_type;
-    double loss_percentage;
-    double p13, p31, p32, p23, p14; // State model parameters
-    double p, r, h, k, 1_minus_h; // Gilbert-Elliot model parameters
+    LossType loss_type = LossType::RANDOM;
+    double loss_percentage = 0.0;
+    // 4-state Markov model transition probabilities, in percent
+    double p13 = 0.0, p31 = 100.0, p32 = 0.0, p23 = 100.0, p14 = 0.0;
+    // Gilbert-Elliott model, in percent: p good->bad, r bad->good, h and k
+    // the chance a packet survives in the bad and good state. The defaults
+    // give the simple Gilbert model once p is set.
+    double p = 0.0, r = 100.0, h = 0.0, k = 100.0;
 };
 
 struct DuplicateConfig {
-    double duplicate_percentage;
+    double duplicate_percentage = 0.0;
 };
 
 struct CorruptConfig {
-    double corrupt_percentage;
+    double corrupt_percentage = 0.0;
 };
 
 struct ReorderConfig {
-    enum class ReorderType {
-        PERCENTAGE,
-        GAP
-    } reorder_type;
-    double reorder_percentage;
-    uint32_t gap;
+    ReorderType reorder_type = ReorderType::PERCENTAGE;
+    double reorder_percentage = 0.0;   // GAP with 0% reorders every gap-th packet
+    uint32_t gap = 0;
 };
 
 struct RateLimitConfig {
-    uint32_t rate_kbps;
-    uint32_t burst_kb;
+    uint32_t rate_kbps = 0;
+    uint32_t burst_kb = 0;             // kbit sent back to back before pacing
 };
 
 struct ImpairmentInfo {
@@ -69,9 +79,26 @@ struct ImpairmentInfo {
     bool has_rate_limit = false;
 };
 
+class NetemEmulator;
+class NetemNetlinkBackend;
+class NetlinkSocket;
+struct EmulatedPacket;
+struct NetemLinkStatistics;
+struct QdiscState;
+
+// Impairs traffic in process: each impaired interface is a NetemEmulator
+// link. Packets enter through process_packet() and come back from
+// release_packets() once due. add_* calls accumulate on an interface the
+// way options accumulate on one netem qdisc.
+//
+// Constructed with a netlink socket, it programs kernel netem root qdiscs
+// instead and the data path methods are unused. Scenarios then send the
+// changes for all interfaces as one batch.
 class NetemImpairments {
 public:
     NetemImpairments();
+    explicit NetemImpairments(uint64_t seed);
+    explicit NetemImpairments(std::unique_ptr<NetlinkSocket> kernel_socket);
     ~NetemImpairments();
 
     // Core management
@@ -95,6 +122,15 @@ public:
     // Information
     std::vector<std::string> get_impaired_interfaces() const;
     ImpairmentInfo get_interface_impairments(const std::string& interface) const;
+    NetemLinkStatistics get_interface_statistics(const std::string& interface) const;
+    bool is_kernel_backed() const { return kernel_ != nullptr; }
+    bool read_kernel_qdiscs(std::vector<QdiscState>& qdiscs);
+
+    // Data path: false if the interface is not impaired or the packet
+    // was dropped; released packets come out in release-time order
+    bool process_packet(const std::string& interface, const PacketInfo& packet, uint64_t now_ns);
+    size_t release_packets(uint64_t now_ns, std::vector<EmulatedPacket>& released);
+    uint64_t next_release_ns() const;
 
     // Scenario management
     bool apply_scenario(const std::string& scenario_name);
@@ -108,10 +144,14 @@ private:
     bool initialized_;
     bool running_;
     std::map<std::string, ImpairmentInfo> active_impairments_;
-    std::mt19937 rng_;
+    std::unique_ptr<NetemEmulator> emulator_;
+    std::unique_ptr<NetemNetlinkBackend> kernel_;
+    bool batching_;
 
     // Helper methods
     void cleanup();
+    bool apply_impairments(const std::string& interface, const ImpairmentInfo& info);
+    bool commit_batch();
     std::string get_distribution_string(DelayDistribution distribution) const;
     std::vector<std::string> get_available_interfaces() const;
 };
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "netem/impairments.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace RouterSim {
+
+// Transport for rtnetlink. One datagram may carry several netlink
+// messages; replies arrive as one or more datagrams.
+class NetlinkSocket {
+public:
+    virtual ~NetlinkSocket() = default;
+
+    virtual bool send(const std::vector<uint8_t>& datagram) = 0;
+    virtual bool receive(std::vector<uint8_t>& datagram) = 0;
+};
+
+// NETLINK_ROUTE socket to the kernel; changing qdiscs needs CAP_NET_ADMIN
+class KernelNetlinkSocket : public NetlinkSocket {
+public:
+    KernelNetlinkSocket();
+    ~KernelNetlinkSocket() override;
+
+    bool is_open() const { return fd_ >= 0; }
+    bool send(const std::vector<uint8_t>& datagram) override;
+    bool receive(std::vector<uint8_t>& datagram) override;
+
+private:
+    int fd_;
+};
+
+// Root qdisc of an interface as read back over rtnetlink
+struct QdiscState {
+    std::string interface;
+    int ifindex = 0;
+    std::string kind;
+    uint32_t handle = 0;
+    ImpairmentInfo impairments;    // decoded when kind is "netem"
+    uint64_t bytes = 0;
+    uint64_t packets = 0;
+    uint32_t drops = 0;
+    uint32_t queue_length = 0;
+};
+
+// Programs root netem qdiscs over rtnetlink instead of running tc.
+//
+// Changes are queued and sent by commit(). The RTM_NEWQDISC/RTM_DELQDISC
+// messages are packed into datagrams of up to MAX_BATCH_BYTES, and every
+// message is acknowledged separately, so a failure on one interface does
+// not hold back the others. A scenario across hundreds of interfaces then
+// costs a handful of system calls rather than a fork+exec per interface
+// and option. A later change to an interface replaces a queued one.
+//
+// Netem has no burst allowance, so RateLimitConfig::burst_kb only applies
+// to the in-process emulator. Non-uniform delay distributions are sent as
+// generated NETEM_DIST_SCALE tables, as tc loads them from its .dist files.
+class NetemNetlinkBackend {
+public:
+    static constexpr size_t MAX_BATCH_BYTES = 32 * 1024;
+    static constexpr uint32_t DEFAULT_LIMIT = 1000;
+
+    explicit NetemNetlinkBackend(std::unique_ptr<NetlinkSocket> socket);
+    ~NetemNetlinkBackend();
+
+    // Interface names and indexes, from an RTM_GETLINK dump
+    bool refresh_interfaces();
+    std::vector<std::string> get_interfaces() const;
+    int get_ifindex(const std::string& interface) const;
+
+    // Batched changes
+    void queue_apply(const std::string& interface, const ImpairmentInfo& impairments);
+    void queue_remove(const std::string& interface);
+    size_t pending_changes() const { return pending_.size(); }
+    bool commit(std::vector<std::string>* failed = nullptr);
+
+    // Single changes, sent together with anything already queued
+    bool apply(const std::string& interface, const ImpairmentInfo& impairments);
+    bool remove(const std::string& interface);
+
+    // Read back, from an RTM_GETQDISC dump
+    bool dump_qdiscs(std::vector<QdiscState>& qdiscs);
+    bool get_qdisc(const std::string& interface, QdiscState& state);
+
+    uint64_t datagrams_sent() const { return datagrams_sent_; }
+    uint64_t messages_sent() const { return messages_sent_; }
+
+    // TCA_OPTIONS payload of a netem qdisc
+    static void encode_netem_options(const ImpairmentInfo& impairments, uint32_t limit, std::vector<uint8_t>& options);
+    static bool decode_netem_options(const uint8_t* data, size_t length, ImpairmentInfo& impairments);
+
+private:
+    struct PendingChange {
+        std::string interface;
+        bool remove;
+        ImpairmentInfo impairments;
+    };
+
+    struct InFlight {
+        std::string interface;
+        bool remove;
+    };
+
+    std::unique_ptr<NetlinkSocket> socket_;
+    std::map<std::string, int> ifindex_;
+    std::vector<PendingChange> pending_;
+    std::unordered_map<std::string, size_t> pending_index_;
+    uint32_t sequence_;
+    uint64_t datagrams_sent_;
+    uint64_t messages_sent_;
+
+    bool send_batch(const std::vector<uint8_t>& datagram, std::map<uint32_t, InFlight>& in_flight,
+                    std::vector<std::string>* failed);
+    bool dump(uint16_t type, const void* header, size_t header_length,
+              std::vector<std::vector<uint8_t>>& messages);
+};
+
+} // namespace RouterSim
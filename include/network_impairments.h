@@ -1,7 +1,10 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <atomic>
 
@@ -19,10 +22,20 @@ struct ImpairmentConfig {
     uint64_t bandwidth_bps = 0;      // Bandwidth limit in bits per second
 };
 
+class NetlinkSocket;
+class NetemNetlinkBackend;
+struct ImpairmentInfo;
+
 // Network Impairments Class
+//
+// Programs kernel netem root qdiscs over rtnetlink. Each apply* call
+// updates the interface's combined configuration and replaces its qdisc;
+// the batch overload of applyComplexImpairment sends all interfaces in one
+// netlink transaction. Statistics are read back from the kernel.
 class NetworkImpairments {
 public:
     NetworkImpairments();
+    explicit NetworkImpairments(std::unique_ptr<NetlinkSocket> socket);
     ~NetworkImpairments();
     
     // Core functionality
@@ -39,6 +52,7 @@ public:
     
     // Complex impairment (combines multiple effects)
     bool applyComplexImpairment(const std::string& interface, const ImpairmentConfig& config);
+    bool applyComplexImpairment(const std::vector<std::string>& interfaces, const ImpairmentConfig& config);
     
     // Management
     bool clearImpairments(const std::string& interface);
@@ -71,14 +85,15 @@ public:
 
 private:
     // Internal methods
-    bool checkTCAvailability() const;
-    bool checkNetemModule() const;
-    std::string executeCommand(const std::string& command) const;
+    ImpairmentConfig currentConfig(const std::string& interface) const;
+    static ImpairmentInfo toImpairmentInfo(const ImpairmentConfig& config);
     
     // State
     std::atomic<bool> enabled_;
+    std::unique_ptr<NetemNetlinkBackend> backend_;
+    std::map<std::string, ImpairmentConfig> configs_;
     
-    // Statistics
+    // Counter values at the last reset()
     uint64_t total_packets_processed_;
     uint64_t total_bytes_processed_;
     uint64_t packets_dropped_;
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <bitset>
+#include <cstddef>
+
+namespace RouterSim {
+
+// IP address stored as 16 bytes in network order. IPv4 addresses use the
+// IPv4-mapped IPv6 form (::ffff:a.b.c.d) so both families share one layout.
+struct IpAddress {
+    uint8_t bytes[16];
+
+    static IpAddress from_ipv4(uint32_t address) {
+        IpAddress result{};
+        result.bytes[10] = 0xFF;
+        result.bytes[11] = 0xFF;
+        result.bytes[12] = static_cast<uint8_t>(address >> 24);
+        result.bytes[13] = static_cast<uint8_t>(address >> 16);
+        result.bytes[14] = static_cast<uint8_t>(address >> 8);
+        result.bytes[15] = static_cast<uint8_t>(address);
+        return result;
+    }
+
+    static IpAddress from_ipv6(const uint8_t address[16]) {
+        IpAddress result;
+        std::memcpy(result.bytes, address, 16);
+        return result;
+    }
+
+    bool is_ipv4() const {
+        static const uint8_t prefix[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF};
+        return std::memcmp(bytes, prefix, sizeof(prefix)) == 0;
+    }
+
+    // Host-order IPv4 address; only meaningful when is_ipv4()
+    uint32_t ipv4() const {
+        return (uint32_t(bytes[12]) << 24) | (uint32_t(bytes[13]) << 16) |
+               (uint32_t(bytes[14]) << 8) | uint32_t(bytes[15]);
+    }
+
+    bool operator==(const IpAddress& other) const {
+        return std::memcmp(bytes, other.bytes, sizeof(bytes)) == 0;
+    }
+    bool operator!=(const IpAddress& other) const { return !(*this == other); }
+};
+
+// Fixed-size packet descriptor for the data path. Trivially copyable and
+// exactly one cache line, so it can be passed by value, stored in flat
+// arrays and queued without heap allocation. Construction does not read
+// the clock; the ingress stage stamps timestamp_ns once.
+struct alignas(64) PacketDescriptor {
+    IpAddress src_addr;
+    IpAddress dst_addr;
+    uint64_t id;
+    uint64_t timestamp_ns;   // ingress time, steady clock nanoseconds
+    uint32_t size;
+    uint32_t priority;
+    uint16_t src_port;
+    uint16_t dst_port;
+    uint8_t protocol;
+    uint8_t dscp;
+    uint8_t ip_version;      // 4 or 6
+    uint8_t flags;
+
+    bool is_ipv4() const { return ip_version == 4; }
+    uint32_t src_ipv4() const { return src_addr.ipv4(); }
+    uint32_t dst_ipv4() const { return dst_addr.ipv4(); }
+
+    void set_ipv4(uint32_t src, uint32_t dst) {
+        src_addr = IpAddress::from_ipv4(src);
+        dst_addr = IpAddress::from_ipv4(dst);
+        ip_version = 4;
+    }
+};
+
+static_assert(sizeof(PacketDescriptor) == 64, "PacketDescriptor must fit one cache line");
+static_assert(std::is_trivially_copyable<PacketDescriptor>::value,
+              "PacketDescriptor must be trivially copyable");
+
+// Burst processing: bit i of a BurstVerdict is set when packet i was accepted.
+// Burst entry points handle at most MAX_BURST_SIZE packets per call.
+constexpr size_t MAX_BURST_SIZE = 256;
+using BurstVerdict = std::bitset<MAX_BURST_SIZE>;
+
+// Timestamp source for PacketDescriptor::timestamp_ns
+inline uint64_t packet_clock_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Address helpers (accept dotted IPv4 or textual IPv6)
+bool parse_ip_address(const std::string& text, IpAddress& address);
+std::string format_ip_address(const IpAddress& address);
+
+} // namespace RouterSim
@@ -1,9 +1,15 @@
 #pragma once
 
-#include "../common_types.h"
+#include "../protocol_interface.h"
+#include "../event_loop.h"
+#include "bgp_session.h"
+#include "bgp_update.h"
+#include "bgp_attributes.h"
+#include "bgp_rib.h"
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 #include <thread>
 #include <atomic>
 #include <mutex>
@@ -13,16 +19,20 @@
 namespace router_sim {
 
 // BGP-specific structures
+
+// A route: its prefix and a reference to its path attributes, interned in
+// the speaker's BGPAttributeStore and shared with every other route that
+// has the same ones
 struct BGPRoute {
     std::string prefix;
-    uint8_t prefix_length;
-    uint32_t metric;
-    std::string next_hop;
-    std::string origin;
-    std::vector<uint32_t> as_path;
-    std::map<std::string, std::string> attributes;
-    bool is_valid;
-    std::chrono::steady_clock::time_point last_updated;
+    uint8_t prefix_length = 0;
+    uint32_t neighbor = 0;                      // learned from, host order; 0 for our own
+    BGPAttributeRef attributes;
+
+    uint32_t metric() const { return attributes ? attributes->med : 0; }
+    std::string next_hop() const;               // dotted; empty for our own routes
+    std::string origin() const;                 // "IGP", "EGP" or "INCOMPLETE"
+    const std::vector<uint32_t>& as_path() const;
 };
 
 struct BGPNeighbor {
@@ -36,6 +46,8 @@ struct BGPNeighbor {
     std::string last_error;
     std::chrono::steady_clock::time_point last_hello;
     std::map<std::string, std::string> capabilities;
+    uint16_t port;
+    bool passive;
 };
 
 struct BGPConfig {
@@ -45,16 +57,37 @@ struct BGPConfig {
     std::map<std::string, uint32_t> neighbor_as;
     uint32_t hold_time;
     uint32_t keepalive_interval;
+    uint32_t connect_retry_time;
+    std::string listen_address;
+    uint16_t listen_port;                       // 0 picks a free port, see get_listen_port()
     bool enable_graceful_restart;
     std::map<std::string, std::string> parameters;
     bool enabled;
-    uint32_t update_interval_ms;
+    uint32_t update_interval_ms;                // how long changes are batched before they are sent; 0: a loop turn
+    bool update_groups;                         // peers of one export policy share their UPDATEs
 };
 
 // Callback types
 using RouteUpdateCallback = std::function<void(const RouteInfo&, bool)>;
 using NeighborCallback = std::function<void(const NeighborInfo&, bool)>;
 
+// BGP speaker. All sessions, their timers and the listening socket live on
+// one EventLoop thread: it sleeps until a socket is readable or a
+// ConnectRetry, Hold or Keepalive timer is due, so UPDATEs reach the RIB
+// as soon as they arrive and an idle speaker does not wake up.
+//
+// Routes go through a BGPRib: UPDATEs change the sender's Adj-RIB-In, and
+// once per loop turn (or update_interval_ms) the decision process runs on
+// the prefixes they touched, the route callback gets the Loc-RIB changes
+// and each established peer is sent what changed in its Adj-RIB-Out.
+// Peers that would be sent the same bytes (iBGP or eBGP, with or without
+// four-octet AS numbers) are one update group: its UPDATEs are encoded
+// once into a shared buffer that each member's session writes out as is.
+// UPDATEs whose AS_PATH holds our own AS are taken as withdrawals.
+//
+// The public methods may be called from any thread; changes to neighbors
+// and advertised routes are handed to the loop thread. The route and
+// neighbor callbacks run on the loop thread.
 class BGPProtocol {
 public:
     BGPProtocol();
@@ -70,10 +103,12 @@ public:
     bool advertise_route(const std::string& prefix, uint8_t prefix_length, uint32_t metric);
     bool withdraw_route(const std::string& prefix, uint8_t prefix_length);
     std::vector<std::string> get_advertised_routes() const;
+    // Prefixes whose best path is a learned one
     std::vector<std::string> get_learned_routes() const;
+    // Our own routes, then the learned best paths
     std::vector<BGPRoute> get_bgp_routes() const;
 
-    // Neighbor management
+    // Neighbor management. Keys: remote_as, port, passive, hold_time
     bool add_neighbor(const std::string& address, const std::map<std::string, std::string>& config);
     bool remove_neighbor(const std::string& address);
     std::vector<NeighborInfo> get_neighbors() const;
@@ -93,6 +128,12 @@ public:
 
     // Statistics
     ProtocolStatistics get_statistics() const;
+    RouterSim::EventLoop::Statistics get_event_loop_statistics() const;
+    BGPAttributeStore::Statistics get_attribute_statistics() const;
+    BGPRib::Statistics get_rib_statistics() const;
+
+    // Port the listening socket is bound to while running
+    uint16_t get_listen_port() const;
 
 private:
     // Internal state
@@ -102,22 +143,31 @@ private:
     mutable std::mutex routes_mutex_;
     mutable std::mutex neighbors_mutex_;
     mutable std::mutex policies_mutex_;
+    mutable std::mutex statistics_mutex_;
 
-    // Route storage
-    std::map<std::string, BGPRoute> advertised_routes_;
-    std::map<std::string, BGPRoute> learned_routes_;
+    // Route storage, under routes_mutex_; every route's attributes are interned here
+    BGPAttributeStore attribute_store_;
+    BGPRib rib_;
+    bool export_scheduled_;                     // loop thread only
 
-    // Neighbor storage
+    // Neighbor storage. Sessions are created, used and destroyed on the
+    // loop thread; neighbors_mutex_ guards the map for readers elsewhere.
     std::map<std::string, BGPNeighbor> neighbors_;
+    std::map<std::string, std::unique_ptr<BGPSession>> sessions_;
 
     // Policy storage
     std::map<std::string, std::string> export_policies_;
     std::map<std::string, std::string> import_policies_;
 
-    // Threading
-    std::thread bgp_thread_;
-    std::thread neighbor_thread_;
-    std::thread route_thread_;
+    // UPDATE codec state, reused by every session on the loop thread
+    BGPUpdate received_update_;
+    BGPUpdateEncoder update_encoder_;
+
+    // Event loop
+    RouterSim::EventLoop loop_;
+    std::thread loop_thread_;
+    int listen_fd_;
+    std::atomic<uint16_t> listen_port_;
 
     // Callbacks
     RouteUpdateCallback route_update_callback_;
@@ -126,28 +176,25 @@ private:
     // Statistics
     ProtocolStatistics statistics_;
 
-    // Internal methods
-    void bgp_main_loop();
-    void neighbor_management_loop();
-    void route_processing_loop();
+    // Session management, on the loop thread
+    bool open_listener();
+    void accept_connections();
+    void create_session(const BGPNeighbor& neighbor);
+    void on_session_state(const std::string& neighbor_address, BGPState from, BGPState to);
+
+    // Runs the decision process and sends the changes, at most once per
+    // update interval; export_routes() does it now. Loop thread.
+    void schedule_export();
+    void export_routes();
 
     // BGP message handling
-    bool establish_session(const std::string& neighbor_address);
-    bool send_open_message(const std::string& neighbor_address);
-    bool send_keepalive(const std::string& neighbor_address);
-    bool send_update_message(const std::string& neighbor_address, const std::vector<BGPRoute>& routes);
-    void process_bgp_message(const std::string& neighbor_address, const std::vector<uint8_t>& message);
-    void process_open_message(const std::string& neighbor_address, const std::vector<uint8_t>& message);
-    void process_update_message(const std::string& neighbor_address, const std::vector<uint8_t>& message);
-    void process_notification_message(const std::string& neighbor_address, const std::vector<uint8_t>& message);
+    // Encodes the update once and queues it to each of its peers
+    bool send_update_message(const BGPRibOutUpdate& update);
+    // 0, or the UPDATE Message Error subcode the session answers with
+    uint8_t process_update_message(const std::string& neighbor_address, const uint8_t* message, size_t length);
 
     // Policy application
     bool apply_route_policy(const std::string& policy_name, BGPRoute& route);
-    
-    // Internal processing methods
-    void process_incoming_messages();
-    void send_keepalives();
-    void process_route_updates();
 };
 
-} // namespace router_sim
\ No newline at end of file
+} // namespace router_sim
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "bgp_update.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace router_sim {
+
+bool operator==(const BGPPathAttributes& a, const BGPPathAttributes& b);
+inline bool operator!=(const BGPPathAttributes& a, const BGPPathAttributes& b) {
+    return !(a == b);
+}
+uint64_t hash_path_attributes(const BGPPathAttributes& attributes);
+
+struct BGPAttributeTable;
+
+// One interned attribute set, shared by every route that carries it
+struct BGPAttributeEntry {
+    BGPPathAttributes attributes;
+    uint32_t as_path_length;                    // for path selection: a whole AS_SET counts one
+    uint64_t hash;
+    std::atomic<uint32_t> references;
+    bool linked;                                // still in the table, findable by intern()
+    BGPAttributeEntry* next;                    // hash chain
+    std::shared_ptr<BGPAttributeTable> table;   // outlives the store while routes still point here
+};
+
+// Counted reference to an interned, immutable attribute set. Copying one
+// is an atomic increment; two references to equal attributes from the
+// same store are the same pointer, so comparing them is one compare.
+class BGPAttributeRef {
+public:
+    BGPAttributeRef() : entry_(nullptr) {}
+    BGPAttributeRef(const BGPAttributeRef& other) : entry_(other.entry_) {
+        if (entry_) {
+            entry_->references.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    BGPAttributeRef(BGPAttributeRef&& other) noexcept : entry_(other.entry_) { other.entry_ = nullptr; }
+    BGPAttributeRef& operator=(BGPAttributeRef other) noexcept {
+        std::swap(entry_, other.entry_);
+        return *this;
+    }
+    ~BGPAttributeRef() { reset(); }
+
+    void reset();
+
+    const BGPPathAttributes& operator*() const { return entry_->attributes; }
+    const BGPPathAttributes* operator->() const { return &entry_->attributes; }
+    const BGPPathAttributes* get() const { return entry_ ? &entry_->attributes : nullptr; }
+    explicit operator bool() const { return entry_ != nullptr; }
+    bool operator==(const BGPAttributeRef& other) const { return entry_ == other.entry_; }
+    bool operator!=(const BGPAttributeRef& other) const { return entry_ != other.entry_; }
+
+    uint32_t use_count() const { return entry_ ? entry_->references.load(std::memory_order_relaxed) : 0; }
+    uint64_t hash() const { return entry_ ? entry_->hash : 0; }
+    // AS_PATH length as RFC 4271 9.1.2.2 counts it, which as_path's size
+    // is not when the path had sets or confederation segments
+    uint32_t as_path_length() const { return entry_ ? entry_->as_path_length : 0; }
+
+private:
+    friend class BGPAttributeStore;
+
+    // Adopts a reference already counted
+    explicit BGPAttributeRef(BGPAttributeEntry* entry) : entry_(entry) {}
+
+    BGPAttributeEntry* entry_;
+};
+
+// Hash-consing store for path attributes.
+//
+// intern() returns the one shared copy of an attribute set, adding it on
+// first sight. A full table is a few hundred thousand routes per peer but
+// only thousands of distinct attribute sets, so routes hold a
+// BGPAttributeRef (one pointer) instead of their own AS path, community
+// list and next hop. A set is freed when its last reference goes.
+//
+// Interning a parsed BGPUpdate hashes and compares its views directly:
+// a set already in the store costs no allocation. AS_SET segments are
+// flattened into the AS list, as BGPPathAttributes has no sets; the path
+// length for route selection is kept beside it and is part of the set's
+// identity.
+//
+// Thread-safe. Lookups and the last release of a set take the store's
+// mutex; copying and dropping references do not. References may outlive
+// the store.
+class BGPAttributeStore {
+public:
+    struct Statistics {
+        uint64_t sets;                          // distinct attribute sets alive
+        uint64_t lookups;
+        uint64_t hits;                          // lookups that found the set already interned
+        uint64_t memory_bytes;                  // sets, their lists and the hash table
+    };
+
+    BGPAttributeStore();
+    ~BGPAttributeStore();
+
+    BGPAttributeStore(const BGPAttributeStore&) = delete;
+    BGPAttributeStore& operator=(const BGPAttributeStore&) = delete;
+
+    BGPAttributeRef intern(const BGPPathAttributes& attributes);
+    // The attributes of a parsed UPDATE, with next_hop in place of its
+    // NEXT_HOP (which MP_REACH_NLRI routes do not have)
+    BGPAttributeRef intern(const BGPUpdate& update, uint32_t next_hop);
+
+    size_t size() const;
+    Statistics get_statistics() const;
+
+private:
+    std::shared_ptr<BGPAttributeTable> table_;
+};
+
+} // namespace router_sim
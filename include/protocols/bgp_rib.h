@@ -0,0 +1,169 @@
+#pragma once
+
+#include "bgp_attributes.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace router_sim {
+
+// Degree of preference of routes without LOCAL_PREF, and of every route
+// learned over eBGP (whose LOCAL_PREF is not ours to trust)
+const uint32_t BGP_DEFAULT_LOCAL_PREF = 100;
+
+// One peer's path to a prefix
+struct BGPRibPath {
+    uint32_t peer = 0;                          // neighbor address, host order; 0 for our own routes
+    bool ibgp = false;                          // learned over iBGP
+    BGPAttributeRef attributes;                 // null: no path
+};
+
+struct BGPRibRoute {
+    RouterSim::Ipv4Prefix prefix;
+    BGPRibPath path;
+};
+
+// A prefix whose Loc-RIB best path changed; best has null attributes
+// when no path is left
+struct BGPBestPathChange {
+    RouterSim::Ipv4Prefix prefix;
+    BGPRibPath previous;
+    BGPRibPath best;
+};
+
+// What is to be sent to the peers of an update group: withdrawals, and
+// announcements grouped by attribute set, one run of UPDATEs each
+struct BGPRibOutUpdate {
+    std::vector<uint32_t> peers;
+    std::vector<RouterSim::Ipv4Prefix> withdrawn;
+    std::vector<std::pair<BGPAttributeRef, std::vector<RouterSim::Ipv4Prefix>>> announced;
+
+    bool empty() const { return withdrawn.empty() && announced.empty(); }
+};
+
+// Adj-RIB-In, Loc-RIB and Adj-RIB-Out of a BGP speaker (RFC 4271 3.2).
+//
+// update() and withdraw() change a peer's Adj-RIB-In and only mark the
+// prefix; run_decisions() then runs the decision process on the marked
+// prefixes alone, over the paths of that prefix, and queues each change
+// of best path to every update group's Adj-RIB-Out. take_updates() diffs a
+// group's queue against what it was last sent, so a prefix that changed
+// and changed back between two calls costs nothing on the wire. The work
+// of an UPDATE or of a peer going down is proportional to the prefixes it
+// touches, not to the size of the table.
+//
+// Peers with the same export policy (iBGP or not, and the caller's
+// export_policy) share an update group: one Adj-RIB-Out and one set of
+// UPDATEs for all of them. A peer that comes up while its group is in use
+// starts a group of its own, which is sent the whole table and then
+// merges back once both are up to date.
+//
+// Our own routes are the Adj-RIB-In of LOCAL_PEER and are preferred over
+// learned ones. iBGP-learned routes are not sent to iBGP peers. A route
+// does go back to the eBGP peer it came from, as the group's UPDATEs are
+// the same for every member; that peer drops it on finding its own AS in
+// the path (RFC 4271 9.1.2).
+//
+// Not thread-safe.
+class BGPRib {
+public:
+    static constexpr uint32_t LOCAL_PEER = 0;
+
+    struct Statistics {
+        uint64_t prefixes;                      // in the Loc-RIB
+        uint64_t paths;                         // in all Adj-RIBs-In
+        uint64_t peers;
+        uint64_t update_groups;
+        uint64_t decisions;                     // prefixes the decision process ran on
+        uint64_t best_path_changes;
+    };
+
+    BGPRib();
+
+    BGPRib(const BGPRib&) = delete;
+    BGPRib& operator=(const BGPRib&) = delete;
+
+    // A peer whose routes are learned and to which the Loc-RIB is
+    // exported, from its whole current content on. Peers with different
+    // export_policy values are never in one update group. False if it
+    // exists.
+    bool add_peer(uint32_t peer, uint32_t router_id, bool ibgp, uint32_t export_policy = 0);
+    // Withdraws every path the peer announced and takes it out of its group
+    bool remove_peer(uint32_t peer);
+    bool has_peer(uint32_t peer) const { return peers_.count(peer) != 0; }
+
+    // Update groups by id; 0 for LOCAL_PEER and unknown peers
+    uint32_t group_of(uint32_t peer) const;
+    std::vector<uint32_t> update_groups() const;
+
+    // Adj-RIB-In changes. False for an unknown peer, or a withdrawal of a
+    // path the peer does not have.
+    bool update(uint32_t peer, const RouterSim::Ipv4Prefix& prefix, BGPAttributeRef attributes);
+    bool withdraw(uint32_t peer, const RouterSim::Ipv4Prefix& prefix);
+
+    // Marks every prefix, as after a change of policy
+    void touch_all();
+
+    // Runs the decision process on every prefix marked since the last call
+    // and appends the best paths that changed; returns how many did
+    size_t run_decisions(std::vector<BGPBestPathChange>& changes);
+
+    // The group's queued changes that differ from its Adj-RIB-Out, which
+    // then holds them, and the peers to send them to. False if there are
+    // none. The group may be merged into another afterwards.
+    bool take_updates(uint32_t group, BGPRibOutUpdate& update);
+
+    // In prefix order
+    std::vector<BGPRibRoute> adj_rib_in(uint32_t peer) const;
+    std::vector<BGPRibRoute> loc_rib() const;
+    std::vector<BGPRibRoute> adj_rib_out(uint32_t peer) const;     // its group's
+
+    Statistics get_statistics() const;
+
+private:
+    struct Destination {
+        std::vector<BGPRibPath> paths;          // one per peer that has announced the prefix
+        BGPRibPath best;
+        bool touched = false;
+    };
+
+    struct Peer {
+        uint32_t router_id;
+        bool ibgp;
+        uint32_t group;
+        std::unordered_set<uint64_t> adj_rib_in;                    // the prefixes of its paths
+    };
+
+    struct UpdateGroup {
+        bool ibgp;
+        uint32_t export_policy;
+        bool sent;                                                  // taken at least once
+        std::vector<uint32_t> peers;
+        std::unordered_map<uint64_t, BGPAttributeRef> adj_rib_out;  // as last taken
+        std::vector<uint64_t> pending;                              // best path changed since
+    };
+
+    std::unordered_map<uint64_t, Destination> destinations_;
+    std::unordered_map<uint32_t, Peer> peers_;
+    std::unordered_map<uint32_t, UpdateGroup> groups_;
+    uint32_t next_group_;
+    std::vector<uint64_t> touched_;
+    uint64_t paths_;
+    uint64_t decisions_;
+    uint64_t best_path_changes_;
+
+    // Reused by the decision process and take_updates()
+    std::vector<const BGPRibPath*> candidates_;
+    std::vector<const BGPRibPath*> kept_;
+    std::unordered_map<const BGPPathAttributes*, size_t> groups_by_attributes_;
+
+    void touch(uint64_t key, Destination& destination);
+    const BGPRibPath* select_best(const std::vector<BGPRibPath>& paths);
+    BGPAttributeRef exported(uint64_t key, const UpdateGroup& to) const;
+    void merge_group(uint32_t group);
+};
+
+} // namespace router_sim
@@ -0,0 +1,218 @@
+#pragma once
+
+#include "../event_loop.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace router_sim {
+
+// RFC 4271 message framing
+constexpr size_t BGP_HEADER_SIZE = 19;
+constexpr size_t BGP_MAX_MESSAGE_SIZE = 4096;
+constexpr uint16_t BGP_PORT = 179;
+
+enum class BGPMessageType : uint8_t {
+    OPEN = 1,
+    UPDATE = 2,
+    NOTIFICATION = 3,
+    KEEPALIVE = 4
+};
+
+// RFC 4271 section 8.2.2
+enum class BGPState {
+    IDLE,
+    CONNECT,
+    ACTIVE,
+    OPEN_SENT,
+    OPEN_CONFIRM,
+    ESTABLISHED
+};
+
+// "Idle", "Connect", ... as in BGPNeighbor::state
+const char* bgp_state_name(BGPState state);
+
+struct BGPSessionConfig {
+    uint32_t local_as = 0;
+    uint32_t router_id = 0;                     // host order
+    std::string peer_address;                   // dotted IPv4
+    uint16_t peer_port = BGP_PORT;
+    uint32_t peer_as = 0;                       // 0 accepts any
+    uint16_t hold_time = 180;                   // seconds, proposed in OPEN; 0 or at least 3
+    uint32_t connect_retry_time = 120;          // seconds
+    bool passive = false;                       // only accept(), never connect
+};
+
+// One neighbor's BGP finite state machine on an EventLoop.
+//
+// The session owns its TCP connection and its ConnectRetry, Hold and
+// Keepalive timers, all on the loop: it does work only when its socket is
+// ready or one of its timers is due. OPEN, KEEPALIVE and NOTIFICATION are
+// handled here; UPDATE bodies go to the update callback as they arrive.
+// An error or a NOTIFICATION drops the session to Idle, after which it
+// starts again on its own: a passive session waits in Active for the peer
+// to reconnect, an active one connects when ConnectRetry fires.
+//
+// A connection from the peer while our own is being opened is a collision
+// (RFC 4271 section 6.8): both are kept, with an OPEN sent on each, until
+// the peer's BGP Identifier is known from its OPEN on either one. The
+// connection opened by the speaker with the higher identifier stays and
+// the other is closed with a Cease, so two active speakers dialling each
+// other at once settle on the same connection.
+//
+// Only the hold timer's expiry is scheduled, not each restart of it: the
+// timer checks the time of the last message when it fires and re-arms for
+// what is left, so a stream of UPDATEs does not churn the timer wheel.
+//
+// Loop thread only, except get_statistics(). Callbacks run on the loop
+// thread and must not destroy the session.
+class BGPSession {
+public:
+    // Body of one UPDATE, after the header, still in the receive buffer.
+    // Returns 0 to accept it, or the UPDATE Message Error subcode to send
+    // in the NOTIFICATION that drops the session.
+    using UpdateCallback = std::function<uint8_t(const uint8_t* body, size_t length)>;
+    using StateCallback = std::function<void(BGPState from, BGPState to)>;
+
+    struct Statistics {
+        uint64_t messages_sent;
+        uint64_t messages_received;
+        uint64_t updates_sent;
+        uint64_t updates_received;
+        uint64_t keepalives_sent;
+        uint64_t keepalives_received;
+        uint64_t notifications_sent;
+        uint64_t notifications_received;
+        uint64_t established_transitions;
+        uint64_t collisions_resolved;
+    };
+
+    BGPSession(RouterSim::EventLoop& loop, const BGPSessionConfig& config, UpdateCallback on_update,
+               StateCallback on_state_change);
+    ~BGPSession();
+
+    BGPSession(const BGPSession&) = delete;
+    BGPSession& operator=(const BGPSession&) = delete;
+
+    // ManualStart / ManualStop; stop() sends a Cease NOTIFICATION when connected
+    void start();
+    void stop();
+
+    // Hands over an accepted connection from the peer. While our own
+    // connection is in Connect, OpenSent or OpenConfirm it is held as a
+    // collision; refused (and the descriptor closed) when the session is
+    // stopped, Established, or already on a connection the peer opened.
+    bool accept(int fd);
+
+    // Queues one UPDATE; false unless Established
+    bool send_update(const uint8_t* body, size_t length);
+    // Queues count complete UPDATE messages, headers included, as
+    // BGPUpdateEncoder lays them out; false unless Established
+    bool send_updates(const uint8_t* messages, size_t length, size_t count);
+    // The same from a buffer other sessions may be sending too: it is held,
+    // not copied, until written out
+    bool send_updates(std::shared_ptr<const std::vector<uint8_t>> messages, size_t count);
+
+    BGPState state() const { return state_; }
+    const BGPSessionConfig& config() const { return config_; }
+    uint16_t negotiated_hold_time() const { return hold_time_; }
+    // Both OPENs carried the four-octet AS number capability (RFC 6793)
+    bool four_octet_as() const { return four_octet_as_; }
+    uint32_t peer_router_id() const { return peer_router_id_; }
+    const std::string& last_error() const { return last_error_; }
+    Statistics get_statistics() const;
+
+private:
+    RouterSim::EventLoop& loop_;
+    BGPSessionConfig config_;
+    UpdateCallback on_update_;
+    StateCallback on_state_change_;
+
+    BGPState state_;
+    bool started_;
+    int fd_;
+    bool inbound_;                              // fd_ was opened by the peer
+    bool connecting_;                           // non-blocking connect() in flight
+    bool want_write_;                           // EPOLLOUT armed for the send buffer
+
+    RouterSim::EventLoop::TimerId connect_retry_timer_;
+    RouterSim::EventLoop::TimerId hold_timer_;
+    RouterSim::EventLoop::TimerId keepalive_timer_;
+    uint64_t last_received_ns_;
+    uint16_t hold_time_;                        // negotiated; the OpenSent value before that
+    bool four_octet_as_;
+    uint32_t peer_router_id_;
+    std::string last_error_;
+
+    // Queued for the socket in order: runs of our own messages, and UPDATE
+    // buffers shared with the other sessions of an update group
+    struct OutChunk {
+        std::vector<uint8_t> own;
+        std::shared_ptr<const std::vector<uint8_t>> shared;
+
+        const std::vector<uint8_t>& bytes() const { return shared ? *shared : own; }
+    };
+
+    std::vector<uint8_t> in_;
+    size_t in_used_;
+    std::deque<OutChunk> out_;
+    size_t out_sent_;                           // of the front chunk
+
+    // The peer's connection held beside ours in a collision, our OPEN
+    // already sent on it, and what it has sent so far
+    int collision_fd_;
+    std::vector<uint8_t> collision_in_;
+
+    std::atomic<uint64_t> messages_sent_;
+    std::atomic<uint64_t> messages_received_;
+    std::atomic<uint64_t> updates_sent_;
+    std::atomic<uint64_t> updates_received_;
+    std::atomic<uint64_t> keepalives_sent_;
+    std::atomic<uint64_t> keepalives_received_;
+    std::atomic<uint64_t> notifications_sent_;
+    std::atomic<uint64_t> notifications_received_;
+    std::atomic<uint64_t> established_transitions_;
+    std::atomic<uint64_t> collisions_resolved_;
+
+    void set_state(BGPState state);
+    void connect();
+    void attach(int fd, bool inbound);
+    void on_io(uint32_t events);
+    void on_connected();
+    void read_messages();
+    void process_messages();
+    void handle_message(BGPMessageType type, const uint8_t* body, size_t length);
+    void handle_open(const uint8_t* body, size_t length);
+
+    void send_message(BGPMessageType type, const uint8_t* body, size_t length);
+    std::vector<uint8_t>& own_chunk();
+    std::vector<uint8_t> open_body() const;
+    void send_open();
+    void send_keepalive();
+    void send_notification(uint8_t code, uint8_t subcode);
+    void flush();
+
+    // Closes the connection and falls back to Idle, then restarts
+    void drop(const std::string& error);
+    void close_connection();
+
+    // Connection collisions
+    bool hold_collision(int fd);
+    void read_collision();
+    // True when the peer's connection won and replaced ours
+    bool resolve_collision(uint32_t peer_router_id);
+    void adopt_collision();
+    void close_collision();
+
+    void arm_connect_retry();
+    void arm_hold_timer(uint64_t delay_ns);
+    void arm_keepalive_timer();
+    void on_hold_timer();
+    void cancel_timer(RouterSim::EventLoop::TimerId& timer);
+};
+
+} // namespace router_sim
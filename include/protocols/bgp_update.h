@@ -0,0 +1,328 @@
+#pragma once
+
+#include "bgp_session.h"
+#include "../routing/fib.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace router_sim {
+
+// Path attribute type codes (RFC 4271 section 4.3, RFC 1997, RFC 4760)
+enum class BGPAttributeType : uint8_t {
+    ORIGIN = 1,
+    AS_PATH = 2,
+    NEXT_HOP = 3,
+    MULTI_EXIT_DISC = 4,
+    LOCAL_PREF = 5,
+    ATOMIC_AGGREGATE = 6,
+    AGGREGATOR = 7,
+    COMMUNITIES = 8,
+    MP_REACH_NLRI = 14,
+    MP_UNREACH_NLRI = 15
+};
+
+// UPDATE Message Error subcodes (RFC 4271 section 6.3)
+enum class BGPUpdateError : uint8_t {
+    NONE = 0,
+    MALFORMED_ATTRIBUTE_LIST = 1,
+    UNRECOGNIZED_WELL_KNOWN_ATTRIBUTE = 2,
+    MISSING_WELL_KNOWN_ATTRIBUTE = 3,
+    ATTRIBUTE_FLAGS_ERROR = 4,
+    ATTRIBUTE_LENGTH_ERROR = 5,
+    INVALID_ORIGIN = 6,
+    OPTIONAL_ATTRIBUTE_ERROR = 9,
+    INVALID_NETWORK_FIELD = 10,
+    MALFORMED_AS_PATH = 11
+};
+
+constexpr uint8_t BGP_ATTRIBUTE_OPTIONAL = 0x80;
+constexpr uint8_t BGP_ATTRIBUTE_TRANSITIVE = 0x40;
+constexpr uint8_t BGP_ATTRIBUTE_PARTIAL = 0x20;
+constexpr uint8_t BGP_ATTRIBUTE_EXTENDED_LENGTH = 0x10;
+
+constexpr uint8_t BGP_ORIGIN_IGP = 0;
+constexpr uint8_t BGP_ORIGIN_EGP = 1;
+constexpr uint8_t BGP_ORIGIN_INCOMPLETE = 2;
+
+constexpr uint8_t BGP_AS_SET = 1;
+constexpr uint8_t BGP_AS_SEQUENCE = 2;
+constexpr uint8_t BGP_AS_CONFED_SEQUENCE = 3;
+constexpr uint8_t BGP_AS_CONFED_SET = 4;
+
+constexpr uint16_t BGP_AFI_IPV4 = 1;
+constexpr uint16_t BGP_AFI_IPV6 = 2;
+constexpr uint8_t BGP_SAFI_UNICAST = 1;
+
+// The views below point into the message they were parsed from and are
+// valid only as long as that buffer is. parse() checks every length once,
+// so walking a view afterwards does no bounds checks of its own.
+
+// One NLRI prefix: its length in bits and its significant octets
+struct BGPPrefix {
+    uint8_t length;
+    const uint8_t* bytes;
+
+    // IPv4 address in host order, the octets not on the wire zero
+    uint32_t ipv4() const {
+        uint32_t address = 0;
+        for (unsigned i = 0; i < (length + 7u) / 8; ++i) {
+            address |= uint32_t(bytes[i]) << (24 - 8 * i);
+        }
+        return address;
+    }
+};
+
+class BGPPrefixRange {
+public:
+    class iterator {
+    public:
+        explicit iterator(const uint8_t* position) : position_(position) {}
+        BGPPrefix operator*() const { return BGPPrefix{position_[0], position_ + 1}; }
+        iterator& operator++() {
+            position_ += 1 + (position_[0] + 7) / 8;
+            return *this;
+        }
+        bool operator==(const iterator& other) const { return position_ == other.position_; }
+        bool operator!=(const iterator& other) const { return position_ != other.position_; }
+
+    private:
+        const uint8_t* position_;
+    };
+
+    BGPPrefixRange() : begin_(nullptr), end_(nullptr) {}
+    BGPPrefixRange(const uint8_t* begin, const uint8_t* end) : begin_(begin), end_(end) {}
+
+    iterator begin() const { return iterator(begin_); }
+    iterator end() const { return iterator(end_); }
+    bool empty() const { return begin_ == end_; }
+    // Walks the range
+    size_t count() const;
+    const uint8_t* data() const { return begin_; }
+    size_t size_bytes() const { return static_cast<size_t>(end_ - begin_); }
+
+private:
+    const uint8_t* begin_;
+    const uint8_t* end_;
+};
+
+// AS_PATH value with two- or four-octet AS numbers
+class BGPAsPath {
+public:
+    BGPAsPath() : data_(nullptr), size_(0), as_size_(4) {}
+    BGPAsPath(const uint8_t* data, size_t size, size_t as_size) : data_(data), size_(size), as_size_(as_size) {}
+
+    bool empty() const { return size_ == 0; }
+    // For path selection: each AS of a sequence counts, a whole set counts one
+    size_t length() const;
+    // Leftmost AS, the one the route was learned from; 0 when empty
+    uint32_t first() const;
+    bool contains(uint32_t as) const;
+    void append_to(std::vector<uint32_t>& out) const;
+
+    // visit(segment_type, as) for every AS in order
+    template <typename Visit>
+    void for_each(Visit visit) const {
+        for (const uint8_t* segment = data_; segment < data_ + size_; segment += 2 + segment[1] * as_size_) {
+            for (size_t i = 0; i < segment[1]; ++i) {
+                visit(segment[0], read_as(segment + 2 + i * as_size_));
+            }
+        }
+    }
+
+    const uint8_t* data() const { return data_; }
+    size_t size_bytes() const { return size_; }
+    size_t as_size() const { return as_size_; }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t as_size_;
+
+    uint32_t read_as(const uint8_t* as) const {
+        return as_size_ == 4 ? (uint32_t(as[0]) << 24) | (uint32_t(as[1]) << 16) | (uint32_t(as[2]) << 8) | as[3]
+                             : (uint32_t(as[0]) << 8) | as[1];
+    }
+};
+
+// COMMUNITIES value (RFC 1997), ASN:value packed in 32 bits
+class BGPCommunities {
+public:
+    BGPCommunities() : data_(nullptr), count_(0) {}
+    BGPCommunities(const uint8_t* data, size_t count) : data_(data), count_(count) {}
+
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    uint32_t operator[](size_t i) const {
+        const uint8_t* value = data_ + 4 * i;
+        return (uint32_t(value[0]) << 24) | (uint32_t(value[1]) << 16) | (uint32_t(value[2]) << 8) | value[3];
+    }
+
+private:
+    const uint8_t* data_;
+    size_t count_;
+};
+
+// MP_REACH_NLRI / MP_UNREACH_NLRI (RFC 4760). Prefixes of IPv4 and IPv6
+// are checked against the address length; other families are left opaque.
+struct BGPMpReach {
+    uint16_t afi = 0;
+    uint8_t safi = 0;
+    const uint8_t* next_hop = nullptr;
+    uint8_t next_hop_length = 0;
+    BGPPrefixRange nlri;
+};
+
+struct BGPMpUnreach {
+    uint16_t afi = 0;
+    uint8_t safi = 0;
+    BGPPrefixRange withdrawn;
+};
+
+// One path attribute as received, recognized or not
+struct BGPAttribute {
+    uint8_t flags;
+    uint8_t type;
+    const uint8_t* value;
+    uint16_t length;
+};
+
+class BGPAttributeRange {
+public:
+    class iterator {
+    public:
+        explicit iterator(const uint8_t* position) : position_(position) {}
+        BGPAttribute operator*() const;
+        iterator& operator++() {
+            BGPAttribute attribute = **this;
+            position_ = attribute.value + attribute.length;
+            return *this;
+        }
+        bool operator!=(const iterator& other) const { return position_ != other.position_; }
+
+    private:
+        const uint8_t* position_;
+    };
+
+    BGPAttributeRange() : begin_(nullptr), end_(nullptr) {}
+    BGPAttributeRange(const uint8_t* begin, const uint8_t* end) : begin_(begin), end_(end) {}
+
+    iterator begin() const { return iterator(begin_); }
+    iterator end() const { return iterator(end_); }
+    bool empty() const { return begin_ == end_; }
+    const uint8_t* data() const { return begin_; }
+    size_t size_bytes() const { return static_cast<size_t>(end_ - begin_); }
+
+private:
+    const uint8_t* begin_;
+    const uint8_t* end_;
+};
+
+// Zero-copy view of one received UPDATE.
+//
+// parse() validates the withdrawn routes, every path attribute and the
+// NLRI in a single pass over the body and records where each part is;
+// nothing is copied or allocated, and one BGPUpdate can be reused for
+// every message of a session. A malformed message is reported with the
+// UPDATE Message Error subcode to send in the NOTIFICATION.
+//
+// Attributes this codec does not interpret (AGGREGATOR, AS4_PATH,
+// extended or large communities, ...) are checked for framing only and
+// stay reachable through attributes().
+class BGPUpdate {
+public:
+    BGPUpdate();
+
+    // body is the message after its 19-byte header; as AS numbers are
+    // two or four octets depending on the capability both OPENs carried
+    bool parse(const uint8_t* body, size_t length, bool four_octet_as);
+
+    BGPUpdateError error() const { return error_; }
+    const char* error_reason() const { return error_reason_; }
+
+    const BGPPrefixRange& withdrawn() const { return withdrawn_; }
+    const BGPPrefixRange& nlri() const { return nlri_; }
+    const BGPAttributeRange& attributes() const { return attributes_; }
+    // Withdraws only, no attributes and no NLRI
+    bool is_withdraw_only() const { return attributes_.empty() && nlri_.empty(); }
+    // No routes at all: the End-of-RIB marker for IPv4 unicast (RFC 4724)
+    bool is_end_of_rib() const { return withdrawn_.empty() && is_withdraw_only(); }
+
+    bool has(BGPAttributeType type) const { return has_type(static_cast<uint8_t>(type)); }
+    bool has_type(uint8_t type) const { return (seen_[type >> 6] >> (type & 63)) & 1; }
+
+    uint8_t origin() const { return origin_; }
+    const BGPAsPath& as_path() const { return as_path_; }
+    uint32_t next_hop() const { return next_hop_; }      // host order
+    uint32_t med() const { return med_; }
+    uint32_t local_pref() const { return local_pref_; }
+    const BGPCommunities& communities() const { return communities_; }
+    const BGPMpReach& mp_reach() const { return mp_reach_; }
+    const BGPMpUnreach& mp_unreach() const { return mp_unreach_; }
+
+private:
+    BGPUpdateError error_;
+    const char* error_reason_;
+    uint64_t seen_[4];
+
+    BGPPrefixRange withdrawn_;
+    BGPPrefixRange nlri_;
+    BGPAttributeRange attributes_;
+    uint8_t origin_;
+    BGPAsPath as_path_;
+    uint32_t next_hop_;
+    uint32_t med_;
+    uint32_t local_pref_;
+    BGPCommunities communities_;
+    BGPMpReach mp_reach_;
+    BGPMpUnreach mp_unreach_;
+
+    bool fail(BGPUpdateError error, const char* reason);
+    bool parse_attribute(uint8_t flags, uint8_t type, const uint8_t* value, size_t length, size_t as_size);
+};
+
+// Path attributes to announce
+struct BGPPathAttributes {
+    uint8_t origin = BGP_ORIGIN_IGP;
+    std::vector<uint32_t> as_path;              // one AS_SEQUENCE, empty when originated over iBGP
+    uint32_t next_hop = 0;                      // host order
+    bool has_med = false;
+    uint32_t med = 0;
+    bool has_local_pref = false;
+    uint32_t local_pref = 0;
+    std::vector<uint32_t> communities;
+};
+
+// Packs routes into UPDATE messages.
+//
+// The attributes are encoded once per call and every message repeats
+// them with as many prefixes as fit under BGP_MAX_MESSAGE_SIZE. Messages
+// are appended to the caller's buffer complete with their headers, ready
+// for BGPSession::send_updates(); reusing that buffer (and the encoder)
+// keeps the steady state free of allocation.
+//
+// Attributes too large to leave room for a prefix in any message cannot be
+// sent at all: the call appends nothing and counts its prefixes as dropped.
+class BGPUpdateEncoder {
+public:
+    explicit BGPUpdateEncoder(bool four_octet_as = true);
+
+    void set_four_octet_as(bool four_octet_as) { four_octet_as_ = four_octet_as; }
+
+    // Both return the number of messages appended to out
+    size_t encode_announcements(const BGPPathAttributes& attributes, const RouterSim::Ipv4Prefix* prefixes,
+                                size_t count, std::vector<uint8_t>& out);
+    size_t encode_withdrawals(const RouterSim::Ipv4Prefix* prefixes, size_t count, std::vector<uint8_t>& out);
+
+    // Prefixes not announced because their attributes alone overflow a message
+    uint64_t prefixes_dropped() const { return prefixes_dropped_; }
+
+private:
+    bool four_octet_as_;
+    uint64_t prefixes_dropped_;
+    std::vector<uint8_t> attributes_;
+
+    void encode_attributes(const BGPPathAttributes& attributes);
+};
+
+} // namespace router_sim
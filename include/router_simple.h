@@ -0,0 +1,308 @@
+#pragma once
+
+#include "routing/fib.h"
+#include "packet_descriptor.h"
+#include "testing/pcap_tap.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <algorithm>
+
+namespace RouterSim {
+
+// Simple packet structure
+struct Packet {
+    uint64_t id;
+    uint32_t size;
+    std::string src_ip;
+    std::string dst_ip;
+    uint8_t protocol;
+    std::chrono::steady_clock::time_point timestamp;
+    
+    Packet() : id(0), size(0), protocol(0) {
+        timestamp = std::chrono::steady_clock::now();
+    }
+};
+
+// Simple route structure
+struct Route {
+    std::string destination;
+    std::string next_hop;
+    uint32_t metric;
+    std::string protocol;
+    
+    Route() : metric(0) {}
+};
+
+// Simple router core
+class SimpleRouter {
+public:
+    SimpleRouter() : running_(false), capture_tap_(nullptr) {}
+    
+    bool initialize() {
+        std::cout << "Initializing simple router..." << std::endl;
+        return true;
+    }
+    
+    bool start() {
+        if (running_) {
+            return true;
+        }
+        
+        std::cout << "Starting router..." << std::endl;
+        running_ = true;
+        return true;
+    }
+    
+    bool stop() {
+        if (!running_) {
+            return true;
+        }
+        
+        std::cout << "Stopping router..." << std::endl;
+        running_ = false;
+        return true;
+    }
+    
+    bool is_running() const {
+        return running_;
+    }
+    
+    bool add_route(const std::string& destination, const std::string& next_hop, uint32_t metric = 1) {
+        Ipv4Prefix prefix;
+        if (!parse_ipv4_prefix(destination, prefix)) {
+            std::cerr << "Invalid route destination: " << destination << std::endl;
+            return false;
+        }
+        
+        std::lock_guard<std::mutex> lock(routes_mutex_);
+        
+        if (!fib_.insert(prefix.address, prefix.length, intern_next_hop(next_hop))) {
+            return false;
+        }
+        
+        Route route;
+        route.destination = format_ipv4_prefix(prefix);
+        route.next_hop = next_hop;
+        route.metric = metric;
+        route.protocol = "STATIC";
+        
+        routes_[route.destination] = route;
+        std::cout << "Added route: " << destination << " -> " << next_hop << std::endl;
+        return true;
+    }
+    
+    std::vector<Route> get_routes() const {
+        std::lock_guard<std::mutex> lock(routes_mutex_);
+        std::vector<Route> result;
+        
+        for (const auto& [dest, route] : routes_) {
+            result.push_back(route);
+        }
+        
+        return result;
+    }
+    
+    bool process_packet(const Packet& packet) {
+        if (!running_) {
+            return false;
+        }
+        
+        // Simple packet processing
+        std::cout << "Processing packet: " << packet.src_ip << " -> " << packet.dst_ip 
+                  << " (size: " << packet.size << ")" << std::endl;
+        
+        // Look up route
+        std::string next_hop = find_next_hop(packet.dst_ip);
+        if (!next_hop.empty()) {
+            std::cout << "  Next hop: " << next_hop << std::endl;
+            return true;
+        } else {
+            std::cout << "  No route found" << std::endl;
+            return false;
+        }
+    }
+    
+    // Data-path entry point: no string parsing, allocation or logging
+    bool process_packet(const PacketDescriptor& packet) {
+        if (!running_) {
+            return false;
+        }
+        
+        if (lookup_next_hop(packet) != Ipv4Fib::INVALID_NEXT_HOP) {
+            return true;
+        }
+        PcapTap* tap = capture_tap_.load(std::memory_order_acquire);
+        if (tap) {
+            tap->capture(CaptureStage::DROPPED, packet);
+        }
+        return false;
+    }
+    
+    // Packets without a route are captured as DROPPED; nullptr detaches
+    void set_capture_tap(PcapTap* tap) {
+        capture_tap_.store(tap, std::memory_order_release);
+    }
+    
+    // Returns an index usable with get_next_hop_address(), or INVALID_NEXT_HOP
+    uint32_t lookup_next_hop(const PacketDescriptor& packet) {
+        if (!packet.is_ipv4()) {
+            return Ipv4Fib::INVALID_NEXT_HOP;
+        }
+        
+        std::lock_guard<std::mutex> lock(routes_mutex_);
+        fib_.build();
+        return fib_.lookup(packet.dst_ipv4());
+    }
+    
+    // Burst variant: one lock and one FIB check for the whole batch. If
+    // next_hops is non-null it receives the next-hop index for each packet.
+    size_t process_burst(const PacketDescriptor* packets, size_t count, BurstVerdict& verdicts,
+                         uint32_t* next_hops = nullptr) {
+        count = std::min(count, MAX_BURST_SIZE);
+        verdicts.reset();
+        if (!running_) {
+            return 0;
+        }
+        
+        uint32_t addresses[MAX_BURST_SIZE];
+        uint32_t results[MAX_BURST_SIZE];
+        for (size_t i = 0; i < count; ++i) {
+            addresses[i] = packets[i].dst_ipv4();
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(routes_mutex_);
+            fib_.build();
+            fib_.lookup_burst(addresses, results, count);
+        }
+        
+        for (size_t i = 0; i < count; ++i) {
+            if (!packets[i].is_ipv4()) {
+                results[i] = Ipv4Fib::INVALID_NEXT_HOP;
+            }
+            if (results[i] != Ipv4Fib::INVALID_NEXT_HOP) {
+                verdicts.set(i);
+            }
+            if (next_hops) {
+                next_hops[i] = results[i];
+            }
+        }
+        
+        size_t accepted = verdicts.count();
+        PcapTap* tap = capture_tap_.load(std::memory_order_acquire);
+        if (tap && accepted < count) {
+            BurstVerdict dropped = ~verdicts;
+            tap->capture_burst(CaptureStage::DROPPED, packets, count, &dropped);
+        }
+        return accepted;
+    }
+    
+    std::string get_next_hop_address(uint32_t index) const {
+        std::lock_guard<std::mutex> lock(routes_mutex_);
+        return index < next_hops_.size() ? next_hops_[index] : "";
+    }
+    
+    void print_routes() const {
+        auto routes = get_routes();
+        std::cout << "\nRouting Table:" << std::endl;
+        std::cout << "Destination\tNext Hop\tMetric\tProtocol" << std::endl;
+        std::cout << "----------------------------------------" << std::endl;
+        
+        for (const auto& route : routes) {
+            std::cout << route.destination << "\t\t" << route.next_hop 
+                      << "\t\t" << route.metric << "\t" << route.protocol << std::endl;
+        }
+    }
+
+private:
+    std::atomic<bool> running_;
+    std::atomic<PcapTap*> capture_tap_;
+    std::map<std::string, Route> routes_;
+    Ipv4Fib fib_;
+    std::vector<std::string> next_hops_;
+    std::unordered_map<std::string, uint32_t> next_hop_index_;
+    mutable std::mutex routes_mutex_;
+    
+    uint32_t intern_next_hop(const std::string& next_hop) {
+        auto it = next_hop_index_.find(next_hop);
+        if (it != next_hop_index_.end()) {
+            return it->second;
+        }
+        
+        uint32_t index = static_cast<uint32_t>(next_hops_.size());
+        next_hops_.push_back(next_hop);
+        next_hop_index_[next_hop] = index;
+        return index;
+    }
+    
+    std::string find_next_hop(const std::string& destination) {
+        uint32_t address = 0;
+        if (!parse_ipv4_address(destination, address)) {
+            return "";
+        }
+        
+        std::lock_guard<std::mutex> lock(routes_mutex_);
+        
+        // Longest prefix match; the FIB is recompiled lazily after route changes
+        fib_.build();
+        uint32_t index = fib_.lookup(address);
+        if (index == Ipv4Fib::INVALID_NEXT_HOP) {
+            return "";
+        }
+        
+        return next_hops_[index];
+    }
+};
+
+// Simple traffic shaper
+class SimpleTrafficShaper {
+public:
+    SimpleTrafficShaper() : enabled_(false), rate_limit_(1000000) {} // 1 Mbps
+    
+    bool initialize() {
+        std::cout << "Initializing traffic shaper..." << std::endl;
+        return true;
+    }
+    
+    bool process_packet(const Packet& packet) {
+        if (!enabled_) {
+            return true;
+        }
+        
+        // Simple rate limiting
+        auto now = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_packet_time_);
+        
+        if (elapsed.count() > 0) {
+            uint64_t allowed_bytes = (rate_limit_ * elapsed.count()) / 1000;
+            if (packet.size <= allowed_bytes) {
+                last_packet_time_ = now;
+                return true;
+            }
+        }
+        
+        return false;
+    }
+    
+    void set_enabled(bool enabled) {
+        enabled_ = enabled;
+    }
+    
+    void set_rate_limit(uint64_t rate) {
+        rate_limit_ = rate;
+    }
+
+private:
+    bool enabled_;
+    uint64_t rate_limit_;
+    std::chrono::steady_clock::time_point last_packet_time_;
+};
+
+} // namespace RouterSim
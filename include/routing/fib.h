@@ -0,0 +1,154 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace RouterSim {
+
+// IPv4 prefix in host byte order
+struct Ipv4Prefix {
+    uint32_t address;
+    uint8_t length;
+
+    Ipv4Prefix() : address(0), length(0) {}
+    Ipv4Prefix(uint32_t addr, uint8_t len) : address(addr), length(len) {}
+};
+
+// Address helpers
+bool parse_ipv4_address(const std::string& text, uint32_t& address);
+bool parse_ipv4_prefix(const std::string& text, Ipv4Prefix& prefix);
+std::string format_ipv4_address(uint32_t address);
+std::string format_ipv4_prefix(const Ipv4Prefix& prefix);
+
+// IPv4 forwarding table with longest prefix match.
+//
+// Routes are kept in a binary radix trie (the RIB side) which is cheap to
+// update. Lookups run against a compiled Poptrie-style structure: a 2^16
+// direct-pointing array for the first 16 bits followed by 6-bit stride nodes
+// whose children and leaves are addressed by popcount over 64-bit bitmaps, so
+// a lookup touches at most four nodes. The compiled form is rebuilt by build()
+// after the RIB changes.
+class Ipv4Fib {
+public:
+    static constexpr uint32_t INVALID_NEXT_HOP = 0xFFFFFFFF;
+    static constexpr uint32_t MAX_NEXT_HOP = 0x7FFFFFFE;
+
+    Ipv4Fib();
+    ~Ipv4Fib();
+
+    // Route management (next_hop is an index into the caller's next-hop table)
+    bool insert(uint32_t prefix, uint8_t length, uint32_t next_hop);
+    bool remove(uint32_t prefix, uint8_t length);
+    uint32_t find_exact(uint32_t prefix, uint8_t length) const;
+    void clear();
+
+    // Compile the lookup structure; a no-op when nothing changed
+    void build();
+    bool needs_build() const { return dirty_; }
+
+    // Longest prefix match against the last build()
+    uint32_t lookup(uint32_t address) const;
+    void lookup_burst(const uint32_t* addresses, uint32_t* next_hops, size_t count) const;
+
+    // Information
+    size_t size() const { return route_count_; }
+    size_t memory_usage() const;
+    size_t node_count() const { return nodes_.size(); }
+    size_t leaf_count() const { return leaves_.size(); }
+
+private:
+    static constexpr uint32_t NO_NODE = 0xFFFFFFFF;
+    static constexpr uint32_t LEAF_FLAG = 0x80000000;
+    static constexpr unsigned DIRECT_BITS = 16;
+    static constexpr unsigned STRIDE = 6;
+
+    struct RibNode {
+        uint32_t child[2];
+        uint32_t next_hop;  // stored as next_hop + 1, 0 = no route
+    };
+
+    struct Node {
+        uint64_t vector = 0;    // bit set = internal child
+        uint64_t leafvec = 0;   // bit set = start of a run of equal leaves
+        uint32_t base0 = 0;     // first leaf index
+        uint32_t base1 = 0;     // first child node index
+    };
+
+    // RIB
+    std::vector<RibNode> rib_;
+    size_t route_count_;
+    bool dirty_;
+
+    // Compiled lookup structure
+    std::vector<uint32_t> direct_;
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> leaves_;  // next_hop + 1, 0 = no route
+
+    // Internal methods
+    uint32_t new_rib_node();
+    bool rib_has_children(uint32_t node) const;
+    void fill_direct(uint32_t node, unsigned depth, uint32_t bits, uint32_t next_hop);
+    void compile_node(uint32_t node, unsigned offset, uint32_t next_hop, uint32_t index);
+
+    static unsigned extract(uint32_t address, unsigned offset) {
+        if (offset + STRIDE <= 32) {
+            return (address >> (32 - offset - STRIDE)) & 0x3F;
+        }
+        return (address << (offset + STRIDE - 32)) & 0x3F;
+    }
+};
+
+inline uint32_t Ipv4Fib::lookup(uint32_t address) const {
+    if (direct_.empty()) {
+        return INVALID_NEXT_HOP;
+    }
+
+    uint32_t entry = direct_[address >> DIRECT_BITS];
+    if (entry & LEAF_FLAG) {
+        return (entry & ~LEAF_FLAG) - 1;
+    }
+
+    unsigned offset = DIRECT_BITS;
+    const Node* node = &nodes_[entry];
+    for (;;) {
+        uint64_t bit = 1ULL << extract(address, offset);
+        uint64_t mask = (bit << 1) - 1;
+        if (node->vector & bit) {
+            node = &nodes_[node->base1 + __builtin_popcountll(node->vector & mask) - 1];
+            offset += STRIDE;
+        } else {
+            return leaves_[node->base0 + __builtin_popcountll(node->leafvec & mask) - 1] - 1;
+        }
+    }
+}
+
+// Two passes so the direct-array loads and first node fetches for the whole
+// burst are in flight before any dependent walk starts.
+inline void Ipv4Fib::lookup_burst(const uint32_t* addresses, uint32_t* next_hops, size_t count) const {
+    if (direct_.empty()) {
+        for (size_t i = 0; i < count; ++i) {
+            next_hops[i] = INVALID_NEXT_HOP;
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t entry = direct_[addresses[i] >> DIRECT_BITS];
+        if (!(entry & LEAF_FLAG)) {
+            __builtin_prefetch(&nodes_[entry]);
+        }
+        next_hops[i] = entry;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (next_hops[i] & LEAF_FLAG) {
+            next_hops[i] = (next_hops[i] & ~LEAF_FLAG) - 1;
+        } else {
+            next_hops[i] = lookup(addresses[i]);
+        }
+    }
+}
+
+} // namespace RouterSim
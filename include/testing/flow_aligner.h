@@ -0,0 +1,124 @@
+#pragma once
+
+#include "testing/pcap_diff.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+namespace RouterSim {
+
+// Directional 5-tuple
+struct PcapFlowKey {
+    std::string src_ip;
+    std::string dst_ip;
+    uint8_t protocol = 0;
+    uint16_t src_port = 0;
+    uint16_t dst_port = 0;
+
+    bool operator==(const PcapFlowKey& other) const {
+        return protocol == other.protocol && src_port == other.src_port && dst_port == other.dst_port &&
+               src_ip == other.src_ip && dst_ip == other.dst_ip;
+    }
+};
+
+struct PcapFlowKeyHash {
+    size_t operator()(const PcapFlowKey& key) const;
+};
+
+// Pairs up the packets of two captures of the same traffic, flow by flow.
+//
+// Packets from both captures are fed in capture order, ideally in step.
+// Each one is looked up among the unmatched packets of the same flow from
+// the other capture by its identity: IP ID and TCP sequence/ack numbers
+// where the headers carry them, otherwise size and DSCP, in which case
+// the earliest unmatched candidate is taken (a greedy longest common
+// subsequence within the window). A packet still without a partner once
+// either capture is `window` packets past it is reported as unmatched, so
+// memory stays proportional to the window whatever the capture length,
+// and a single loss costs one report instead of shifting every later
+// comparison.
+//
+// A match is flagged as reordered when a packet that follows it in the
+// same flow of the first capture was matched before it; moving one packet
+// counts once, whichever capture is fed ahead.
+//
+// When packets are added in index order, the first capture's before the
+// second's on equal indexes, two packets match exactly when their indexes
+// are less than `window` apart. The outcome then depends only on the order
+// within each flow, so captures can be split by flow across several
+// aligners and give the same matches as a single one; only the timing of
+// unmatched reports differs.
+class PcapFlowAligner {
+public:
+    enum Side { FIRST = 0, SECOND = 1 };
+
+    // Indexes are 0-based positions within each capture
+    using MatchCallback = std::function<void(const PcapPacketInfo& first, uint64_t first_index,
+                                             const PcapPacketInfo& second, uint64_t second_index,
+                                             bool reordered)>;
+    using UnmatchedCallback = std::function<void(Side side, const PcapPacketInfo& packet, uint64_t index)>;
+
+    static constexpr size_t DEFAULT_WINDOW = 65536;
+
+    PcapFlowAligner(size_t window, MatchCallback on_match, UnmatchedCallback on_unmatched);
+
+    // Indexes count from 0 in each capture; without one, the next is used
+    void add(Side side, PcapPacketInfo packet);
+    void add(Side side, PcapPacketInfo packet, uint64_t index);
+
+    // Reports everything still unmatched, first capture before second
+    void finish();
+
+    uint64_t packets(Side side) const { return counts_[side]; }
+    size_t pending() const { return pending_; }
+    size_t peak_pending() const { return peak_pending_; }
+    size_t active_flows() const { return flows_.size(); }
+
+    static PcapFlowKey flow_key(const PcapPacketInfo& packet);
+    static uint64_t identity(const PcapPacketInfo& packet);
+
+private:
+    struct Pending {
+        PcapPacketInfo packet;
+        uint64_t identity;
+    };
+
+    struct Queue {
+        std::map<uint64_t, Pending> packets;                        // by position
+        std::unordered_map<uint64_t, std::deque<uint64_t>> by_identity;
+        uint64_t highest_matched = 0;                               // position + 1, first capture only
+    };
+
+    struct Flow {
+        Queue queues[2];
+        size_t references = 0;                                      // entries in fifo_
+    };
+
+    using FlowTable = std::unordered_map<PcapFlowKey, Flow, PcapFlowKeyHash>;
+
+    struct FifoEntry {
+        FlowTable::value_type* flow;                                // stable across rehashing
+        uint64_t position;
+    };
+
+    size_t window_;
+    MatchCallback on_match_;
+    UnmatchedCallback on_unmatched_;
+    FlowTable flows_;
+    std::deque<FifoEntry> fifo_[2];
+    uint64_t positions_[2];                                         // next index
+    uint64_t counts_[2];
+    size_t pending_;
+    size_t peak_pending_;
+
+    void expire(uint64_t position);
+    void expire(Side side, uint64_t limit);
+    void release(Side side, const FifoEntry& entry);
+    void report_unmatched(Side side, Queue& queue, std::map<uint64_t, Pending>::iterator pending);
+};
+
+} // namespace RouterSim
@@ -6,34 +6,39 @@
 #include <chrono>
 #include <cstdint>
 #include <cstdio>
+#include <functional>
 
 namespace RouterSim {
 
-// PCAP comparison structures
-struct PacketInfo {
-    uint64_t packet_number;
+// PCAP comparison structures. Named apart from the data-path PacketInfo
+// in common_types.h, which lives in the same namespace.
+struct PcapPacketInfo {
+    uint64_t packet_number = 0;                       // 1-based, as frame.number
     std::chrono::system_clock::time_point timestamp;
     std::string src_ip;
     std::string dst_ip;
-    uint8_t protocol;
-    uint16_t src_port;
-    uint16_t dst_port;
-    uint32_t size;
-    std::vector<uint8_t> data;
-    uint8_t dscp;
-    uint8_t ttl;
+    uint8_t protocol = 0;                             // IPv4 protocol / IPv6 next header
+    uint16_t src_port = 0;
+    uint16_t dst_port = 0;
+    uint32_t size = 0;                                // original length on the wire
+    std::vector<uint8_t> data;                        // captured bytes, when requested
+    uint8_t dscp = 0;
+    uint8_t ttl = 0;                                  // TTL / hop limit
+    uint32_t ip_id = 0;                               // IPv4 ID / IPv6 fragment ID
+    uint32_t tcp_seq = 0;
+    uint32_t tcp_ack = 0;
 };
 
 struct PcapStatistics {
-    uint64_t total_packets;
-    uint64_t total_bytes;
+    uint64_t total_packets = 0;
+    uint64_t total_bytes = 0;
     std::map<uint8_t, uint64_t> protocol_counts;
     std::chrono::system_clock::time_point start_time;
     std::chrono::system_clock::time_point end_time;
 };
 
 struct PcapData {
-    std::vector<PacketInfo> packets;
+    std::vector<PcapPacketInfo> packets;
     PcapStatistics stats;
 };
 
@@ -43,11 +48,30 @@ struct PcapDifference {
     std::string description;
 };
 
+// BY_INDEX compares the n-th packet of one capture with the n-th of the
+// other. BY_FLOW pairs packets within each 5-tuple flow (PcapFlowAligner)
+// and reports missing, extra and reordered packets instead of letting one
+// loss shift every later comparison.
+enum class PcapDiffMode { BY_INDEX, BY_FLOW };
+
 struct PcapDiffOptions {
     bool compare_payload = false;
     bool compare_protocols = true;
     uint64_t timestamp_tolerance_us = 1000; // 1ms tolerance
     std::vector<uint8_t> ignore_protocols;
+    PcapDiffMode mode = PcapDiffMode::BY_INDEX;
+    size_t alignment_window = 65536;        // packets a partner may lag in BY_FLOW mode
+    size_t max_differences = 0;             // differences kept, 0 = all; the rest are only counted
+    size_t threads = 1;                     // comparison workers, 0 = one per core; see below
+};
+
+struct PcapDiffSummary {
+    uint64_t matched = 0;                   // packet pairs compared
+    uint64_t modified = 0;                  // pairs with at least one field difference
+    uint64_t missing = 0;                   // only in the first capture
+    uint64_t extra = 0;                     // only in the second capture
+    uint64_t reordered = 0;
+    uint64_t differences_dropped = 0;       // beyond max_differences
 };
 
 // PCAP capture structures
@@ -58,6 +82,11 @@ struct CaptureOptions {
     bool promiscuous = true;
 };
 
+// With more than one thread, packets are decoded by one thread per capture
+// and handed out in batches to the workers: by flow in BY_FLOW mode, by
+// runs of packet indexes in BY_INDEX mode. The results are the same for
+// any thread count. In BY_FLOW mode differences are listed by packet
+// index, and max_differences keeps those with the lowest indexes.
 class PcapDiff {
 public:
     PcapDiff();
@@ -72,22 +101,55 @@ public:
 
     // Results
     std::vector<PcapDifference> get_differences() const;
+    PcapDiffSummary get_summary() const { return results_.summary; }
     void print_differences() const;
     bool save_differences(const std::string& output_file) const;
 
+    // Loads a whole capture; compare_pcaps streams instead. Returns false
+    // when the file cannot be read or ends in a truncated record.
+    bool read_pcap_file(const std::string& file_path, PcapData& pcap_data, bool copy_data = false);
+
 private:
+    using PacketSource = std::function<bool(PcapPacketInfo& packet)>;
+
+    // Differences of one comparison, or of one worker's share of it
+    struct Results {
+        std::vector<PcapDifference> differences;
+        PcapDiffSummary summary;
+        uint64_t found = 0;
+        size_t limit = 0;                   // max_differences
+        bool by_index_order = false;        // keep the lowest packet indexes rather than the first found
+
+        void add(const PcapDifference& difference);
+        void finish();
+        void merge(std::vector<Results>& shards);
+    };
+
     bool initialized_;
-    std::vector<PcapDifference> differences_;
+    Results results_;
 
     // Internal methods
-    void compare_packet(const PacketInfo& packet1, const PacketInfo& packet2, 
-                       size_t packet_index, const PcapDiffOptions& options);
-    void compare_protocol_fields(const PacketInfo& packet1, const PacketInfo& packet2, 
-                                size_t packet_index);
+    void reset_results(const PcapDiffOptions& options);
+    void compare_packets(const PacketSource& next1, const PacketSource& next2, const PcapDiffOptions& options,
+                         PcapStatistics* stats1, PcapStatistics* stats2);
+    void compare_indexes(const PacketSource& next1, const PacketSource& next2, const PcapDiffOptions& options,
+                         PcapStatistics* stats1, PcapStatistics* stats2);
+    void compare_flows(const PacketSource& next1, const PacketSource& next2, const PcapDiffOptions& options,
+                       PcapStatistics* stats1, PcapStatistics* stats2);
+    void compare_sharded(const PacketSource& next1, const PacketSource& next2, const PcapDiffOptions& options,
+                         size_t shards, PcapStatistics* stats1, PcapStatistics* stats2);
+    void add_count_mismatch(uint64_t packets1, uint64_t packets2);
+    static void on_flow_match(Results& results, const PcapPacketInfo& first, uint64_t first_index,
+                              const PcapPacketInfo& second, uint64_t second_index, bool reordered,
+                              const PcapDiffOptions& options);
+    static void on_flow_unmatched(Results& results, bool in_first, const PcapPacketInfo& packet, uint64_t index);
+    static void compare_packet(Results& results, const PcapPacketInfo& packet1, const PcapPacketInfo& packet2,
+                               size_t packet_index, const PcapDiffOptions& options);
+    static void compare_protocol_fields(Results& results, const PcapPacketInfo& packet1,
+                                        const PcapPacketInfo& packet2, size_t packet_index);
     void compare_statistics(const PcapStatistics& stats1, const PcapStatistics& stats2);
-    bool read_pcap_file(const std::string& file_path, PcapData& pcap_data);
     void calculate_statistics(PcapData& pcap_data);
-    std::vector<uint8_t> hex_string_to_bytes(const std::string& hex_string);
+    static void add_to_statistics(PcapStatistics& stats, const PcapPacketInfo& packet);
 };
 
 class PcapCapture {
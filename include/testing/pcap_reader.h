@@ -0,0 +1,108 @@
+#pragma once
+
+#include "testing/pcap_diff.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace RouterSim {
+
+// Link-layer header types (LINKTYPE_* from the tcpdump.org registry)
+enum class LinkType : uint32_t {
+    NULL_LOOPBACK = 0,
+    ETHERNET = 1,
+    RAW = 101,
+    LINUX_SLL = 113,
+    IPV4 = 228,
+    IPV6 = 229,
+    LINUX_SLL2 = 276
+};
+
+// One captured frame. data points into the mapped file and stays valid
+// until the reader is closed or reopened.
+struct PcapRecord {
+    uint64_t timestamp_ns = 0;          // since the epoch
+    uint32_t captured_length = 0;
+    uint32_t original_length = 0;
+    uint32_t link_type = 0;
+    uint32_t interface_id = 0;          // pcapng interface, 0 for pcap
+    const uint8_t* data = nullptr;
+};
+
+// Streaming reader for pcap (micro- and nanosecond, either byte order) and
+// pcapng files. The file is memory-mapped and records are handed out one
+// at a time as views into the mapping, so a capture of any size is read
+// without copying it or building a packet vector.
+//
+// pcapng sections may switch byte order and every interface carries its
+// own link type, snap length and timestamp resolution. Enhanced, simple
+// and obsolete packet blocks are returned; all other blocks are skipped.
+// Reading stops at the first record that runs past the end of the file or
+// is otherwise malformed, and truncated() reports it.
+class PcapReader {
+public:
+    enum class Format { NONE, PCAP, PCAPNG };
+
+    PcapReader();
+    ~PcapReader();
+
+    PcapReader(const PcapReader&) = delete;
+    PcapReader& operator=(const PcapReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool is_open() const { return format_ != Format::NONE; }
+    Format format() const { return format_; }
+
+    // Starts again from the first record
+    void rewind();
+
+    bool next_record(PcapRecord& record);
+
+    // Next record decoded into packet, whose strings and buffer are reused.
+    // The frame bytes are copied into packet.data only when copy_data is set.
+    bool next(PcapPacketInfo& packet, bool copy_data = false);
+
+    uint64_t records_read() const { return records_read_; }
+    size_t bytes_read() const { return offset_; }
+    size_t file_size() const { return size_; }
+    bool truncated() const { return truncated_; }
+
+    // Decodes Ethernet (with 802.1Q/802.1ad tags), Linux cooked, BSD
+    // loopback and raw IP frames down to IPv4/IPv6, TCP/UDP ports and TCP
+    // sequence numbers. Fields of layers that are absent or cut short by
+    // the snap length stay zero.
+    // Returns false when the frame carries no IP packet.
+    static bool decode(const PcapRecord& record, PcapPacketInfo& packet, bool copy_data = false);
+
+private:
+    struct Interface {
+        uint32_t link_type;
+        uint32_t snap_length;
+        uint64_t units_per_second;      // timestamp resolution
+        int64_t offset_seconds;
+    };
+
+    const uint8_t* map_;
+    size_t size_;
+    size_t offset_;
+    size_t first_record_;
+    Format format_;
+    bool swapped_;
+    bool nanosecond_;
+    uint32_t link_type_;
+    std::vector<Interface> interfaces_;
+    uint64_t records_read_;
+    bool truncated_;
+
+    uint16_t read16(size_t offset) const;
+    uint32_t read32(size_t offset) const;
+    uint64_t read64(size_t offset) const;
+    bool next_pcap_record(PcapRecord& record);
+    bool next_pcapng_record(PcapRecord& record);
+    bool read_section_header(size_t offset, size_t length);
+    bool read_interface_block(size_t offset, size_t length);
+};
+
+} // namespace RouterSim
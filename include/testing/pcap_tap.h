@@ -0,0 +1,131 @@
+#pragma once
+
+#include "packet_descriptor.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/uio.h>
+
+namespace RouterSim {
+
+// Where in the simulator a packet was seen; one pcapng interface each
+enum class CaptureStage : uint32_t {
+    PRE_SHAPING = 0,
+    POST_SHAPING = 1,
+    DROPPED = 2
+};
+
+struct PcapTapOptions {
+    size_t ring_slots = 65536;                  // rounded up to a power of two
+    uint32_t snaplen = 262144;                  // bytes kept per packet
+    size_t write_bytes = 1 << 20;               // flushed per writev, at most 16 MB
+    uint32_t flush_interval_ms = 100;           // longest a captured packet waits to reach the file
+    bool direct_io = false;                     // O_DIRECT, when the filesystem supports it
+};
+
+// In-process capture of the data path to a pcapng file.
+//
+// Packets are tapped as descriptors, which carry no payload: each one is
+// written as an Ethernet/IPv4 or IPv6/TCP or UDP frame built from its
+// addresses, ports, protocol, DSCP and id, zero-filled to its size and
+// truncated to the snap length. Each CaptureStage is its own interface in
+// the file, with nanosecond timestamps taken from the descriptor.
+//
+// capture() never blocks or allocates: it claims slots in a bounded
+// multi-producer ring with one compare-and-swap per call (per burst for
+// capture_burst) and copies the descriptors in. When the ring is full the
+// packets are counted as dropped rather than stalling the data path. A
+// writer thread drains the ring, formats the blocks into page-aligned
+// buffers and writes them out with writev in write_bytes batches, or
+// after flush_interval_ms when traffic is light. With direct_io, whole
+// pages go through O_DIRECT and the tail is written normally on stop().
+class PcapTap {
+public:
+    struct Statistics {
+        uint64_t packets_captured;              // written to the file
+        uint64_t packets_dropped;               // ring full
+        uint64_t bytes_written;
+        uint64_t write_calls;
+        bool direct_io;
+    };
+
+    PcapTap();
+    ~PcapTap();
+
+    PcapTap(const PcapTap&) = delete;
+    PcapTap& operator=(const PcapTap&) = delete;
+
+    bool start(const std::string& path, const PcapTapOptions& options = PcapTapOptions{});
+    // Writes everything captured so far and closes the file
+    bool stop();
+    bool is_running() const { return running_.load(std::memory_order_acquire); }
+
+    // Safe from any number of threads; false when the packet was dropped
+    bool capture(CaptureStage stage, const PacketDescriptor& packet);
+    // Captures the packets whose bit is set in mask, or all of them
+    size_t capture_burst(CaptureStage stage, const PacketDescriptor* packets, size_t count,
+                         const BurstVerdict* mask = nullptr);
+
+    Statistics get_statistics() const;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence;
+        CaptureStage stage;
+        PacketDescriptor packet;
+    };
+
+    // Page-aligned output buffer, filled by the writer thread only
+    struct Buffer {
+        uint8_t* data;
+        size_t used;
+    };
+
+    static constexpr size_t IO_ALIGNMENT = 4096;
+    static constexpr size_t BUFFER_SIZE = 256 * 1024;
+    static constexpr size_t MAX_BUFFERS = 64;
+    static constexpr size_t MAX_FRAME_HEADERS = 14 + 40 + 20;
+
+    std::unique_ptr<Slot[]> ring_;
+    size_t ring_mask_;
+    alignas(64) std::atomic<uint64_t> tail_;                    // next slot to claim
+    alignas(64) uint64_t head_;                                 // next slot to drain, writer only
+    alignas(64) std::atomic<uint64_t> dropped_;
+    std::atomic<bool> writer_sleeping_;
+
+    PcapTapOptions options_;
+    int fd_;
+    bool direct_io_;
+    int64_t wall_offset_ns_;                                    // system clock minus packet clock
+    std::vector<Buffer> buffers_;
+    size_t current_;                                            // buffer being filled
+
+    std::atomic<bool> running_;
+    std::atomic<bool> stopping_;
+    std::thread writer_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+
+    std::atomic<uint64_t> captured_;
+    std::atomic<uint64_t> bytes_written_;
+    std::atomic<uint64_t> write_calls_;
+    bool write_failed_;
+
+    void writer_loop();
+    size_t drain();
+    void wake_writer();
+    void append_packet(CaptureStage stage, const PacketDescriptor& packet);
+    void append(const void* data, size_t length);
+    void append_zeros(size_t length);
+    bool write_buffers(bool final);
+    bool write_all(const iovec* vectors, int count);
+    void release_buffers();
+};
+
+} // namespace RouterSim
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace RouterSim {
+
+// Hierarchical timing wheel (Varghese & Lauck) with LEVELS wheels of SLOTS
+// slots each. Level 0 slots are one tick wide; each higher level is SLOTS
+// times coarser and is cascaded down when level 0 wraps. Scheduling and
+// cancelling are O(1); advancing skips empty slots using per-level
+// occupancy bitmaps, so an idle wheel costs nothing to catch up.
+//
+// Expiry times are rounded up to the next tick, so timers never fire
+// early and fire at most one tick late. Timers further out than the wheel
+// span are parked on the top level and re-cascaded until they are due.
+// The wheel is not thread-safe; callers serialise access.
+class TimerWheel {
+public:
+    using TimerId = uint64_t;
+    using ExpiryCallback = std::function<void(TimerId id, uint64_t cookie)>;
+
+    static constexpr TimerId INVALID_TIMER = 0;
+    static constexpr uint64_t NO_EXPIRY = UINT64_MAX;
+    static constexpr uint32_t LEVELS = 4;
+    static constexpr uint32_t SLOT_BITS = 8;
+    static constexpr uint32_t SLOTS = 1u << SLOT_BITS;
+    static constexpr uint64_t DEFAULT_RESOLUTION_NS = 1000;
+
+    explicit TimerWheel(uint64_t resolution_ns = DEFAULT_RESOLUTION_NS, uint64_t start_ns = 0);
+
+    // Arms a timer; the cookie is handed back when it fires
+    TimerId schedule(uint64_t expiry_ns, uint64_t cookie);
+    bool cancel(TimerId id);
+    bool is_pending(TimerId id) const;
+
+    // Fires every timer due at or before now_ns, in expiry order. The
+    // callback may schedule and cancel timers, including the one firing.
+    size_t advance(uint64_t now_ns, const ExpiryCallback& callback);
+
+    // Time the earliest pending timer will fire, or NO_EXPIRY
+    uint64_t next_expiry_ns() const;
+
+    size_t size() const { return pending_; }
+    bool empty() const { return pending_ == 0; }
+    uint64_t resolution_ns() const { return resolution_ns_; }
+    uint64_t now_ns() const { return tick_to_ns(current_tick_); }
+
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+    static constexpr uint32_t WORDS = SLOTS / 64;
+
+    struct Node {
+        uint64_t expiry_tick;
+        uint64_t cookie;
+        uint32_t prev;
+        uint32_t next;
+        uint32_t generation;
+        uint16_t slot;        // level * SLOTS + slot index, while armed
+        bool armed;
+    };
+
+    uint64_t resolution_ns_;
+    uint64_t start_ns_;
+    uint64_t current_tick_;   // last tick processed
+    size_t pending_;
+
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> free_nodes_;
+    uint32_t heads_[LEVELS * SLOTS];
+    uint64_t occupied_[LEVELS][WORDS];
+
+    uint64_t ns_to_tick(uint64_t time_ns) const;
+    uint64_t tick_to_ns(uint64_t tick) const;
+    Node* lookup(TimerId id);
+    const Node* lookup(TimerId id) const;
+
+    void place(uint32_t index, uint64_t reference_tick);
+    void link(uint32_t index, uint32_t level, uint32_t slot);
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+    void cascade(uint32_t level, uint32_t slot, uint64_t tick);
+
+    // Occupied slot at or cyclically after from_slot, or SLOTS if none
+    uint32_t find_occupied(uint32_t level, uint32_t from_slot) const;
+    uint64_t next_event_tick(uint64_t from_tick) const;
+};
+
+} // namespace RouterSim
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "common_types.h"
+#include "traffic_shaping/drr.h"
+#include "traffic_shaping/htb.h"
+#include "timer_wheel.h"
 #include <memory>
 #include <vector>
 #include <mutex>
@@ -9,10 +12,25 @@
 #include <limits>
 #include <functional>
 #include <map>
+#include <deque>
+#include <thread>
+#include <condition_variable>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace RouterSim {
 
+class PcapTap;
+
 // Token Bucket Implementation
+//
+// Lock-free on the packet path. The bucket is kept as a single atomic
+// "theoretical arrival time" (GCRA form of a token bucket): a consume of n
+// tokens advances it by n * cost-per-token and succeeds if it stays within
+// depth * cost-per-token of now, the depth being the capacity or a smaller
+// burst size. Refill is implicit, so consume() is one
+// clock read plus a compare-and-swap. Statistics are exact and sharded per
+// thread to keep counter updates off a shared cache line.
 class TokenBucket {
 public:
     TokenBucket(uint64_t capacity, uint64_t refill_rate, uint64_t burst_size);
@@ -21,6 +39,9 @@ public:
     // Core functionality
     bool consume(uint64_t tokens);
     bool consumePacket(const PacketInfo& packet);
+    bool consumePacket(const PacketDescriptor& packet);
+    // The first MAX_BURST_SIZE packets at most; the rest are not looked at
+    size_t consumeBurst(const PacketDescriptor* packets, size_t count, BurstVerdict& verdicts);
     void refillTokens();
     
     // Configuration
@@ -48,38 +69,73 @@ public:
     Statistics getStatistics() const;
 
 private:
-    uint64_t capacity_;
-    uint64_t refill_rate_;
-    uint64_t burst_size_;
-    uint64_t tokens_;
-    std::chrono::steady_clock::time_point last_refill_time_;
+    // Time is tracked in ticks of 1/16 ns since construction, which 64
+    // bits hold for 36 years; the cost of a token carries 8 more bits, so a
+    // consume is charged to within a tick at any rate
+    static constexpr uint64_t TICKS_PER_NS = 16;
+    static constexpr size_t STAT_SHARDS = 16;
+    
+    struct alignas(64) StatShard {
+        std::atomic<uint64_t> packets_processed{0};
+        std::atomic<uint64_t> bytes_processed{0};
+        std::atomic<uint64_t> packets_dropped{0};
+        std::atomic<uint64_t> bytes_dropped{0};
+    };
     
-    // Statistics
-    uint64_t total_packets_processed_;
-    uint64_t total_bytes_processed_;
-    uint64_t packets_dropped_;
-    uint64_t bytes_dropped_;
+    std::atomic<uint64_t> capacity_;
+    std::atomic<uint64_t> refill_rate_;
+    std::atomic<uint64_t> burst_size_;
     
-    mutable std::mutex mutex_;
+    // Derived from capacity and rate; updated together under config_mutex_
+    std::atomic<uint64_t> cost_per_token_;   // 1/256 ticks per token
+    std::atomic<uint64_t> tolerance_;        // ticks of depth() tokens
+    
+    alignas(64) std::atomic<uint64_t> theoretical_arrival_;
+    std::chrono::steady_clock::time_point epoch_;
+    
+    StatShard stats_[STAT_SHARDS];
+    
+    std::mutex config_mutex_;
+    
+    uint64_t now_ticks() const;
+    uint64_t depth() const;
+    void update_derived(uint64_t available);
+    StatShard& local_shard();
+    void record(bool admitted, uint64_t bytes);
 };
 
 // Weighted Fair Queueing Implementation
+//
+// Packet-storing WF2Q+ scheduler. Each queue is guaranteed weight /
+// total_weight of the configured link rate. System virtual time is
+// measured in nanoseconds of link time: it advances by the transmission
+// time of every dequeued packet and never falls behind the smallest start
+// tag of a backlogged queue. dequeue() serves the eligible queue (start
+// tag <= virtual time) with the smallest finish tag, which bounds each
+// queue's delay to within one maximum-size packet of its GPS service.
 class WFQ {
 public:
     static const uint32_t MAX_QUEUE_SIZE = 1000;
+    static const uint64_t DEFAULT_LINK_RATE_BPS = 1000000000ULL;
     
-    WFQ(uint32_t max_queues);
+    WFQ(uint32_t max_queues, uint64_t link_rate_bps = DEFAULT_LINK_RATE_BPS);
     ~WFQ();
     
     // Core functionality
     bool enqueue(uint32_t queue_id, const PacketInfo& packet);
+    bool enqueue(uint32_t queue_id, const PacketDescriptor& packet);
+    // The first MAX_BURST_SIZE packets at most, those whose bit is set
+    size_t enqueueBurst(const PacketDescriptor* packets, size_t count, BurstVerdict& verdicts);
     bool dequeue(PacketInfo& packet);
+    bool dequeue(PacketDescriptor& packet);
     
     // Configuration
     void setQueueWeight(uint32_t queue_id, uint32_t weight);
+    void setLinkRate(uint64_t link_rate_bps);
     
     // Information
     uint32_t getMaxQueues() const { return max_queues_; }
+    uint64_t getLinkRate() const;
     uint32_t getQueueWeight(uint32_t queue_id) const;
     uint32_t getQueueSize(uint32_t queue_id) const;
     uint64_t getQueueBytes(uint32_t queue_id) const;
@@ -96,6 +152,7 @@ public:
     struct Statistics {
         uint32_t max_queues;
         uint32_t total_weight;
+        uint64_t link_rate_bps;
         double virtual_time;
         uint64_t total_packets_processed;
         uint64_t total_bytes_processed;
@@ -110,16 +167,18 @@ public:
 private:
     struct Queue {
         uint32_t weight;
-        uint32_t packets;
+        std::deque<PacketDescriptor> packets;
         uint64_t bytes;
-        double finish_time;
+        double start_time;     // virtual start tag of the head packet
+        double finish_time;    // virtual finish tag of the head packet
     };
     
     uint32_t max_queues_;
     std::vector<Queue> queues_;
     uint32_t total_weight_;
+    uint64_t link_rate_bps_;
     double virtual_time_;
-    std::chrono::steady_clock::time_point last_update_time_;
+    uint32_t backlogged_queues_;
     
     // Statistics
     uint64_t total_packets_processed_;
@@ -129,10 +188,12 @@ private:
     
     mutable std::mutex mutex_;
     
-    void updateVirtualTime();
+    bool enqueueLocked(uint32_t queue_id, const PacketDescriptor& packet);
+    double serviceTime(const Queue& queue, uint32_t size) const;
+    void updateVirtualTime(uint32_t transmitted_size);
 };
 
-// Traffic Shaper - Combines Token Bucket and WFQ
+// Traffic Shaper - Combines Token Bucket and a scheduler (WFQ or DRR)
 class TrafficShaper {
 public:
     TrafficShaper();
@@ -141,11 +202,17 @@ public:
     // Core functionality
     bool initialize();
     bool processPacket(const PacketInfo& packet);
+    bool processPacket(const PacketDescriptor& packet);
+    size_t processBurst(const PacketDescriptor* packets, size_t count, BurstVerdict& verdicts);
     bool dequeuePacket(PacketInfo& packet);
+    bool dequeuePacket(PacketDescriptor& packet);
     
     // Configuration
     void setTokenBucketConfig(uint64_t capacity, uint64_t refill_rate, uint64_t burst_size);
     void setQueueWeight(uint32_t queue_id, uint32_t weight);
+    void setAlgorithm(ShapingAlgorithm algorithm);
+    ShapingAlgorithm getAlgorithm() const;
+    void setDRRConfig(const DRRConfig& config);
     void setEnabled(bool enabled);
     bool isEnabled() const;
     
@@ -156,16 +223,22 @@ public:
         uint64_t total_bytes_processed;
         uint64_t packets_dropped;
         uint64_t bytes_dropped;
+        ShapingAlgorithm algorithm;
         TokenBucket::Statistics token_bucket_stats;
         WFQ::Statistics wfq_stats;
+        DRRStatistics drr_stats;
     };
     
     Statistics getStatistics() const;
     void reset();
 
 private:
+    static constexpr uint32_t SCHEDULER_QUEUES = 8;
+    
     std::unique_ptr<TokenBucket> token_bucket_;
     std::unique_ptr<WFQ> wfq_;
+    std::unique_ptr<DeficitRoundRobin> drr_;
+    ShapingAlgorithm algorithm_;
     bool enabled_;
     
     // Statistics
@@ -175,9 +248,22 @@ private:
     uint64_t bytes_dropped_;
     
     mutable std::mutex mutex_;
+    
+    bool enqueueScheduled(const PacketDescriptor& packet);
 };
 
 // Traffic Shaping Manager - Manages multiple traffic shapers
+//
+// While running, a release thread delivers queued packets to the packet
+// callback. It is event driven: an enqueue wakes it at once, and an
+// interface whose head packet is held back by its shaper arms a timer-wheel
+// entry for the time its tokens allow the next send. With nothing eligible
+// the thread sleeps until the earliest timer, so idle interfaces cost no
+// polling.
+//
+// A PcapTap set with set_capture_tap() sees every packet offered to an
+// interface (PRE_SHAPING), every one the shaper refuses (DROPPED) and
+// every one released (POST_SHAPING).
 class TrafficShapingManager {
 public:
     TrafficShapingManager();
@@ -195,9 +281,18 @@ public:
     bool configure_interface(const std::string& interface_name, 
                             ShapingAlgorithm algorithm,
                             const std::map<std::string, std::string>& config);
+    bool configure_htb(const std::string& interface_name,
+                       const std::vector<HTBClassConfig>& classes,
+                       uint32_t charge_batch_bytes = HierarchicalTokenBucket::DEFAULT_CHARGE_BATCH_BYTES);
+    // The interface's HTB classes, parents first; empty without a tree
+    std::vector<HTBClassConfig> get_htb_classes(const std::string& interface_name) const;
     
     // Packet processing
     bool process_packet(const std::string& interface_name, const PacketInfo& packet);
+    bool process_packet(const std::string& interface_name, const PacketDescriptor& packet);
+    size_t process_burst(const std::string& interface_name, const PacketDescriptor* packets,
+                         size_t count, BurstVerdict& verdicts);
+    bool dequeue_packet(const std::string& interface_name, PacketDescriptor& packet);
     
     // Statistics
     std::map<std::string, TrafficStats> get_interface_statistics() const;
@@ -210,16 +305,30 @@ public:
     // Callbacks
     void set_packet_callback(PacketCallback callback);
     void set_drop_callback(DropCallback callback);
+    // The tap must outlive the manager or be cleared first; nullptr detaches
+    void set_capture_tap(PcapTap* tap);
 
 private:
     std::atomic<bool> running_;
     std::atomic<bool> initialized_;
     std::map<std::string, std::unique_ptr<TrafficShaper>> interfaces_;
+    // Interfaces shaped by an HTB tree instead of their flat TrafficShaper
+    std::map<std::string, std::unique_ptr<HierarchicalTokenBucket>> htb_trees_;
     mutable std::mutex interfaces_mutex_;
     
+    // Release scheduling, guarded by release_mutex_
+    std::thread processing_thread_;
+    std::mutex release_mutex_;
+    std::condition_variable release_cv_;
+    TimerWheel release_timers_;
+    std::unordered_set<std::string> ready_interfaces_;
+    std::unordered_map<std::string, TimerWheel::TimerId> release_timer_of_;
+    std::unordered_map<TimerWheel::TimerId, std::string> timer_interface_;
+    
     // Callbacks
     PacketCallback packet_callback_;
     DropCallback drop_callback_;
+    std::atomic<PcapTap*> capture_tap_;
     
     // Statistics
     TrafficStats global_stats_;
@@ -227,6 +336,9 @@ private:
     
     // Internal methods
     void processing_loop();
+    void wake_interface(const std::string& interface_name);
+    uint64_t release_packets(const std::string& interface_name, std::vector<PacketDescriptor>& released);
+    void schedule_release(const std::string& interface_name, uint64_t wake_ns);
     bool process_packet_internal(const PacketInfo& packet);
     void update_statistics(const PacketInfo& packet, bool dropped);
     void notify_packet_processed(const PacketInfo& packet);
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "common_types.h"
+#include <array>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace RouterSim {
+
+struct DRRClassStatistics {
+    uint8_t class_id;
+    uint32_t quantum;
+    int64_t deficit;
+    uint64_t packets_queued;
+    uint64_t packets_dequeued;
+    uint64_t packets_dropped;
+    uint64_t bytes_dequeued;
+    size_t current_queue_length;
+};
+
+struct DRRStatistics {
+    uint64_t total_packets_queued;
+    uint64_t total_packets_dequeued;
+    uint64_t total_packets_dropped;
+    uint64_t total_bytes_dequeued;
+    uint64_t sparse_dequeues;        // packets served from the new-flow list
+    size_t current_queue_length;
+    std::map<uint8_t, DRRClassStatistics> class_statistics;
+};
+
+// Deficit Round Robin (Shreedhar & Varghese) over up to 256 classes, with
+// optional DRR++ sparse-flow priority. Each active class sits on a round
+// robin list and may send up to its accumulated deficit per visit; work per
+// packet is O(1) as long as the quantum is at least one MTU.
+//
+// With sparse_flow_priority set, a class that becomes active is first put
+// on a "new" list that is served before the "old" list, giving short
+// interactive flows low latency. A class that empties while on the new list
+// passes through the old list once before it can become new again, so a
+// flow cannot stay sparse by sending one packet per round.
+class DeficitRoundRobin {
+public:
+    static const size_t MAX_QUEUE_SIZE = 1000;
+
+    DeficitRoundRobin();
+    explicit DeficitRoundRobin(const DRRConfig& config);
+    ~DeficitRoundRobin();
+
+    // Core operations
+    bool initialize(const std::vector<WFQClass>& classes);
+    bool enqueue_packet(const PacketInfo& packet, uint8_t class_id);
+    bool enqueue_packet(const PacketDescriptor& packet, uint8_t class_id);
+    bool dequeue_packet(PacketInfo& packet);
+    bool dequeue_packet(PacketDescriptor& packet);
+    size_t dequeue_burst(PacketDescriptor* packets, size_t max_count);
+    bool is_empty() const;
+    size_t queue_size() const;
+    size_t queue_size(uint8_t class_id) const;
+
+    // Class management; the class weight scales the base quantum
+    bool add_class(const WFQClass& wfq_class);
+    bool update_class(const WFQClass& wfq_class);
+    std::vector<WFQClass> get_classes() const;
+
+    // Configuration
+    void set_config(const DRRConfig& config);
+    DRRConfig get_config() const;
+
+    // Statistics
+    DRRStatistics get_statistics() const;
+    void reset_statistics();
+
+private:
+    static constexpr uint16_t NO_SLOT = 0xFFFF;
+
+    enum class ListState : uint8_t { IDLE, NEW, OLD };
+
+    struct ClassState {
+        WFQClass config;
+        std::deque<PacketDescriptor> queue;
+        uint32_t quantum = 0;
+        int64_t deficit = 0;
+        ListState list = ListState::IDLE;
+        uint64_t packets_queued = 0;
+        uint64_t packets_dequeued = 0;
+        uint64_t packets_dropped = 0;
+        uint64_t bytes_dequeued = 0;
+    };
+
+    DRRConfig config_;
+    std::vector<ClassState> states_;
+    std::array<uint16_t, 256> slot_of_;
+    std::deque<uint16_t> new_list_;
+    std::deque<uint16_t> old_list_;
+    size_t total_queued_;
+    uint64_t sparse_dequeues_;
+
+    mutable std::mutex mutex_;
+
+    // Internal methods
+    void insert_class(const WFQClass& wfq_class);
+    uint32_t class_quantum(const WFQClass& wfq_class) const;
+    bool select_next_packet(PacketDescriptor& packet);
+};
+
+} // namespace RouterSim
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "common_types.h"
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace RouterSim {
+
+struct HTBClassStatistics {
+    uint32_t class_id;
+    uint32_t parent_id;
+    std::string name;
+    bool is_leaf;
+    int64_t tokens_ns;            // rate bucket, ns of transmission time
+    int64_t ctokens_ns;           // ceil bucket
+    uint64_t packets_sent;        // leaves: sent; inner classes: sent through
+    uint64_t bytes_sent;
+    uint64_t packets_borrowed;    // leaves: sent on borrowed bandwidth
+    uint64_t packets_lent;        // inner classes: packets they lent for
+    uint64_t packets_dropped;
+    size_t queue_length;
+};
+
+struct HTBStatistics {
+    uint64_t packets_queued;
+    uint64_t packets_sent;
+    uint64_t bytes_sent;
+    uint64_t packets_dropped;
+    uint64_t ancestor_flushes;    // batched charges applied to the tree
+    size_t queue_length;
+    std::vector<HTBClassStatistics> class_statistics;
+};
+
+// Hierarchical token bucket shaping tree (interface -> tenant -> class).
+//
+// Every class has a rate bucket (guaranteed rate) and a ceil bucket
+// (upper bound). Only leaves queue packets. A leaf below its rate sends on
+// its own tokens; a leaf over its rate but under its ceil borrows from the
+// nearest ancestor that is under its own rate, provided every class on the
+// way is under its ceil. Siblings share borrowed bandwidth by quantum.
+//
+// The tree is never scanned. Tokens refill lazily from the last update
+// time; backlogged leaves sit on a "green" (own rate) or "yellow"
+// (borrowing) round-robin list, and throttled leaves wait in a heap keyed
+// by the time their tokens recover. Packets a leaf sends on its own rate
+// charge only the leaf; their ancestor charges are applied in batches of
+// charge_batch_bytes, clamped so the bytes outstanding under a class never
+// exceed its burst. Borrowed packets charge the path at once. A batch size
+// of 0 charges every packet immediately.
+class HierarchicalTokenBucket {
+public:
+    static const size_t MAX_QUEUE_SIZE = 1000;
+    static const size_t MAX_DEPTH = 8;
+    static const uint32_t DEFAULT_CHARGE_BATCH_BYTES = 4096;
+
+    explicit HierarchicalTokenBucket(uint32_t charge_batch_bytes = DEFAULT_CHARGE_BATCH_BYTES);
+    ~HierarchicalTokenBucket();
+
+    // Tree construction; parents must be added before their children and
+    // a class can only gain children while it has no packets queued
+    bool initialize(const std::vector<HTBClassConfig>& classes);
+    bool add_class(const HTBClassConfig& config);
+    bool update_class(const HTBClassConfig& config);
+    std::vector<HTBClassConfig> get_classes() const;
+    void set_charge_batch_bytes(uint32_t charge_batch_bytes);
+
+    // Packet classification to a leaf class_id; default uses packet.priority
+    void set_classifier(std::function<uint32_t(const PacketDescriptor&)> classifier);
+    uint32_t classify_packet(const PacketDescriptor& packet) const;
+
+    // Core operations. now_ns is steady-clock nanoseconds; the overloads
+    // without it read packet_clock_ns()
+    bool enqueue_packet(const PacketDescriptor& packet, uint32_t class_id, uint64_t now_ns);
+    bool enqueue_packet(const PacketDescriptor& packet, uint32_t class_id);
+    bool dequeue_packet(PacketDescriptor& packet, uint64_t now_ns);
+    bool dequeue_packet(PacketDescriptor& packet);
+    bool is_empty() const;
+    size_t queue_size() const;
+
+    // Earliest time a throttled leaf may become sendable (0 when none)
+    uint64_t next_wakeup_ns() const;
+
+    // Statistics
+    HTBStatistics get_statistics() const;
+    void reset_statistics();
+
+private:
+    static constexpr int32_t NO_CLASS = -1;
+    static constexpr int OWN_RATE = -1;
+
+    enum class LeafState : uint8_t { IDLE, GREEN, YELLOW, WAITING };
+
+    struct ClassNode {
+        HTBClassConfig config;
+        int32_t parent = NO_CLASS;
+        uint32_t depth = 0;
+        uint32_t children = 0;
+        uint32_t leaves = 0;
+
+        // Buckets in ns of transmission time at rate / ceil
+        int64_t tokens = 0;
+        int64_t ctokens = 0;
+        int64_t buffer = 0;
+        int64_t cbuffer = 0;
+        uint64_t last_update_ns = 0;
+
+        // Leaf scheduling state
+        std::deque<PacketDescriptor> queue;
+        LeafState state = LeafState::IDLE;
+        uint32_t generation = 0;
+        int64_t deficit = 0;
+        uint64_t wake_ns = 0;
+        uint32_t wake_generation = 0;
+
+        // Ancestor charges not yet applied: ceil bytes for every ancestor,
+        // rate bytes per ancestor level (borrowed traffic skips borrowers),
+        // and the packets those bytes were sent in
+        uint32_t charge_batch_bytes = 0;
+        uint32_t pending_ceil_bytes = 0;
+        uint32_t pending_packets = 0;
+        uint32_t pending_rate_bytes[MAX_DEPTH] = {};
+
+        uint64_t packets_sent = 0;
+        uint64_t bytes_sent = 0;
+        uint64_t packets_borrowed = 0;
+        uint64_t packets_lent = 0;
+        uint64_t packets_dropped = 0;
+    };
+
+    struct ListEntry {
+        int32_t index;
+        uint32_t generation;
+    };
+
+    struct WaitEntry {
+        uint64_t wake_ns;
+        int32_t index;
+        uint32_t generation;
+
+        bool operator>(const WaitEntry& other) const { return wake_ns > other.wake_ns; }
+    };
+
+    std::vector<ClassNode> classes_;
+    std::unordered_map<uint32_t, int32_t> index_of_;
+    std::deque<ListEntry> green_;
+    std::deque<ListEntry> yellow_;
+    std::priority_queue<WaitEntry, std::vector<WaitEntry>, std::greater<WaitEntry>> waiting_;
+    std::function<uint32_t(const PacketDescriptor&)> classifier_;
+    uint32_t charge_batch_bytes_;
+    size_t total_queued_;
+    uint64_t packets_queued_;
+    uint64_t packets_dropped_;
+    uint64_t ancestor_flushes_;
+
+    mutable std::mutex mutex_;
+
+    // Internal methods
+    bool add_class_locked(const HTBClassConfig& config);
+    void configure_buckets(ClassNode& node);
+    void update_charge_batches();
+    void refill(ClassNode& node, uint64_t now_ns);
+    void classify_leaf(int32_t index, uint64_t now_ns);
+    void wait_until(int32_t index, uint64_t wake_ns);
+    int find_lender(int32_t index, uint64_t now_ns, uint64_t& wake_ns);
+    void send(int32_t index, int lender_level, PacketDescriptor& packet, uint64_t now_ns);
+    void flush_charges(int32_t index, uint64_t now_ns);
+    static int64_t transmit_ns(uint64_t bytes, uint64_t rate_bps);
+};
+
+} // namespace RouterSim
@@ -4,27 +4,11 @@
 #include <queue>
 #include <map>
 #include <functional>
+#include <array>
 
 namespace RouterSim {
 
-// WFQ-specific structures
-struct WFQClass {
-    uint8_t class_id;
-    uint32_t weight;
-    uint64_t min_bandwidth;
-    uint64_t max_bandwidth;
-    std::string name;
-    bool is_active;
-    std::map<std::string, std::string> attributes;
-};
-
-struct QueueItem {
-    PacketInfo packet;
-    uint8_t class_id;
-    std::chrono::steady_clock::time_point enqueue_time;
-    uint64_t virtual_finish_time;
-};
-
+// WFQ-specific structures (WFQClass and QueueItem live in common_types.h)
 struct ClassStatistics {
     uint8_t class_id;
     uint64_t packets_queued;
@@ -52,7 +36,11 @@ public:
     // Core WFQ operations
     bool initialize(const std::vector<WFQClass>& classes);
     bool enqueue_packet(const PacketInfo& packet, uint8_t class_id);
+    bool enqueue_packet(const PacketDescriptor& packet, uint8_t class_id);
     bool dequeue_packet(PacketInfo& packet);
+    bool dequeue_packet(PacketDescriptor& packet);
+    size_t enqueue_burst(const PacketDescriptor* packets, size_t count, BurstVerdict& verdicts);
+    size_t dequeue_burst(PacketDescriptor* packets, size_t max_count);
     bool is_empty() const;
     size_t queue_size() const;
     size_t queue_size(uint8_t class_id) const;
@@ -65,23 +53,58 @@ public:
 
     // Packet classification
     void set_classifier(std::function<uint8_t(const PacketInfo&)> classifier);
+    void set_descriptor_classifier(std::function<uint8_t(const PacketDescriptor&)> classifier);
     uint8_t classify_packet(const PacketInfo& packet) const;
+    uint8_t classify_packet(const PacketDescriptor& packet) const;
 
     // Statistics
     WFQStatistics get_statistics() const;
     void reset_statistics();
 
 private:
+    static constexpr uint16_t NO_SLOT = 0xFFFF;
+    // Virtual time is fixed point, so large weights keep their resolution
+    static constexpr uint64_t VIRTUAL_TIME_SCALE = 1 << 16;
+    
+    // Per-class state, stored densely; slot_of_ maps class_id to a slot
+    struct ClassState {
+        WFQClass config;
+        std::queue<QueueItem> queue;
+        uint64_t last_finish_time = 0;
+        uint64_t packets_queued = 0;
+        uint64_t packets_dequeued = 0;
+        uint64_t bytes_queued = 0;
+        uint64_t bytes_dequeued = 0;
+    };
+    
+    // Head-of-line entry; every backlogged class has exactly one in the heap
+    struct HeapEntry {
+        uint64_t finish_time;
+        uint16_t slot;
+        uint8_t class_id;
+        
+        bool operator>(const HeapEntry& other) const {
+            return finish_time != other.finish_time ? finish_time > other.finish_time
+                                                    : class_id > other.class_id;
+        }
+    };
+    
     // Internal state
-    std::vector<WFQClass> classes_;
-    std::map<uint8_t, std::queue<QueueItem>> queues_;
+    std::vector<ClassState> states_;
+    std::array<uint16_t, 256> slot_of_;
+    std::vector<HeapEntry> heap_;
+    size_t total_queued_;
     uint64_t virtual_time_;
-    std::function<uint8_t(const PacketInfo&)> classifier_;
+    std::function<uint8_t(const PacketDescriptor&)> classifier_;
     
     mutable std::mutex mutex_;
 
     // Internal methods
-    uint64_t calculate_virtual_finish_time(const PacketInfo& packet, uint8_t class_id) const;
+    void reset_classes();
+    void insert_class(const WFQClass& wfq_class);
+    void rebuild_heap();
+    bool push_item(const PacketDescriptor& packet, uint16_t slot);
+    uint64_t calculate_virtual_finish_time(const PacketDescriptor& packet, const ClassState& state) const;
     bool select_next_packet(QueueItem& item);
 };
 
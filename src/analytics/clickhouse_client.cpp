@@ -1,4 +1,7 @@
 #include "analytics/clickhouse_client.h"
+#include <clickhouse/client.h>
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 #include <chrono>
@@ -7,9 +10,410 @@
 
 namespace RouterSim {
 
+namespace {
+
+using namespace clickhouse;
+
+using LowCardinalityString = ColumnLowCardinalityT<ColumnString>;
+using StringMap = ColumnMapT<ColumnString, ColumnString>;
+
+// Renders a value of the column types the tables use
+std::string column_value(const ColumnRef& column, size_t row) {
+    if (auto string = column->As<ColumnString>()) {
+        return std::string(string->At(row));
+    }
+    if (auto low_cardinality = column->As<LowCardinalityString>()) {
+        return std::string(low_cardinality->At(row));
+    }
+    if (auto uint8 = column->As<ColumnUInt8>()) {
+        return std::to_string(uint8->At(row));
+    }
+    if (auto uint16 = column->As<ColumnUInt16>()) {
+        return std::to_string(uint16->At(row));
+    }
+    if (auto uint32 = column->As<ColumnUInt32>()) {
+        return std::to_string(uint32->At(row));
+    }
+    if (auto uint64 = column->As<ColumnUInt64>()) {
+        return std::to_string(uint64->At(row));
+    }
+    if (auto float64 = column->As<ColumnFloat64>()) {
+        std::ostringstream value;
+        value << float64->At(row);
+        return value.str();
+    }
+    return std::string();
+}
+
+// Journal records carry a block's columns back to back: fixed-width values
+// as they are, strings as a varint length and bytes, arrays and maps as a
+// varint count and their elements
+
+void put_varint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+void put_string(std::string& out, std::string_view value) {
+    put_varint(out, value.size());
+    out.append(value.data(), value.size());
+}
+
+template <typename T>
+void put_value(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+struct RecordReader {
+    const uint8_t* data;
+    const uint8_t* end;
+    bool ok;
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64 && data < end; shift += 7) {
+            uint8_t byte = *data++;
+            value |= uint64_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        ok = false;
+        return 0;
+    }
+
+    std::string_view string() {
+        uint64_t length = varint();
+        if (!ok || length > uint64_t(end - data)) {
+            ok = false;
+            return std::string_view();
+        }
+        std::string_view value(reinterpret_cast<const char*>(data), length);
+        data += length;
+        return value;
+    }
+
+    template <typename T>
+    T value() {
+        T value{};
+        if (sizeof(T) > size_t(end - data)) {
+            ok = false;
+            return value;
+        }
+        std::memcpy(&value, data, sizeof(T));
+        data += sizeof(T);
+        return value;
+    }
+};
+
+template <typename C>
+bool save_fixed(const ColumnRef& column, std::string& out) {
+    auto typed = column->As<C>();
+    if (!typed) {
+        return false;
+    }
+    for (size_t row = 0; row < typed->Size(); ++row) {
+        put_value(out, typed->At(row));
+    }
+    return true;
+}
+
+template <typename C>
+bool load_fixed(const ColumnRef& column, RecordReader& in, size_t rows) {
+    auto typed = column->As<C>();
+    if (!typed) {
+        return false;
+    }
+    for (size_t row = 0; row < rows && in.ok; ++row) {
+        typed->Append(in.value<typename C::ValueType>());
+    }
+    return true;
+}
+
+template <typename C>
+bool save_strings(const ColumnRef& column, std::string& out) {
+    auto typed = column->As<C>();
+    if (!typed) {
+        return false;
+    }
+    for (size_t row = 0; row < typed->Size(); ++row) {
+        put_string(out, typed->At(row));
+    }
+    return true;
+}
+
+template <typename C>
+bool load_strings(const ColumnRef& column, RecordReader& in, size_t rows) {
+    auto typed = column->As<C>();
+    if (!typed) {
+        return false;
+    }
+    for (size_t row = 0; row < rows && in.ok; ++row) {
+        typed->Append(in.string());
+    }
+    return true;
+}
+
+void save_column(const ColumnRef& column, std::string& out) {
+    if (save_fixed<ColumnUInt64>(column, out) || save_fixed<ColumnUInt32>(column, out) ||
+        save_fixed<ColumnUInt16>(column, out) || save_fixed<ColumnUInt8>(column, out) ||
+        save_fixed<ColumnFloat64>(column, out) || save_strings<ColumnString>(column, out) ||
+        save_strings<LowCardinalityString>(column, out)) {
+        return;
+    }
+    if (auto array = column->As<ColumnArrayT<ColumnUInt32>>()) {
+        for (size_t row = 0; row < array->Size(); ++row) {
+            put_varint(out, array->GetSize(row));
+            for (uint32_t value : array->At(row)) {
+                put_value(out, value);
+            }
+        }
+    } else if (auto array = column->As<ColumnArrayT<ColumnString>>()) {
+        for (size_t row = 0; row < array->Size(); ++row) {
+            put_varint(out, array->GetSize(row));
+            for (std::string_view value : array->At(row)) {
+                put_string(out, value);
+            }
+        }
+    } else if (auto map = column->As<StringMap>()) {
+        for (size_t row = 0; row < map->Size(); ++row) {
+            put_varint(out, map->GetSize(row));
+            for (const auto& entry : map->At(row)) {
+                put_string(out, entry.first);
+                put_string(out, entry.second);
+            }
+        }
+    }
+}
+
+bool load_column(const ColumnRef& column, RecordReader& in, size_t rows) {
+    if (load_fixed<ColumnUInt64>(column, in, rows) || load_fixed<ColumnUInt32>(column, in, rows) ||
+        load_fixed<ColumnUInt16>(column, in, rows) || load_fixed<ColumnUInt8>(column, in, rows) ||
+        load_fixed<ColumnFloat64>(column, in, rows) || load_strings<ColumnString>(column, in, rows) ||
+        load_strings<LowCardinalityString>(column, in, rows)) {
+        return in.ok;
+    }
+    if (auto array = column->As<ColumnArrayT<ColumnUInt32>>()) {
+        std::vector<uint32_t> values;
+        for (size_t row = 0; row < rows && in.ok; ++row) {
+            values.resize(std::min<uint64_t>(in.varint(), in.end - in.data));
+            for (auto& value : values) {
+                value = in.value<uint32_t>();
+            }
+            array->Append(values);
+        }
+    } else if (auto array = column->As<ColumnArrayT<ColumnString>>()) {
+        std::vector<std::string_view> values;
+        for (size_t row = 0; row < rows && in.ok; ++row) {
+            values.resize(std::min<uint64_t>(in.varint(), in.end - in.data));
+            for (auto& value : values) {
+                value = in.string();
+            }
+            array->Append(values);
+        }
+    } else if (auto map = column->As<StringMap>()) {
+        std::vector<std::pair<std::string_view, std::string_view>> entries;
+        for (size_t row = 0; row < rows && in.ok; ++row) {
+            entries.resize(std::min<uint64_t>(in.varint(), in.end - in.data));
+            for (auto& entry : entries) {
+                entry.first = in.string();
+                entry.second = in.string();
+            }
+            map->Append(entries);
+        }
+    } else {
+        return false;
+    }
+    return in.ok;
+}
+
+} // namespace
+
+// One table's buffered rows: typed columns that rows are appended to, and
+// the block that names them in table order and is sent as-is
+struct ClickHouseClient::TableColumns {
+    Block block;
+
+    virtual ~TableColumns() = default;
+
+    template <typename T>
+    std::shared_ptr<T> add(const char* name, std::shared_ptr<T> column) {
+        block.AppendColumn(name, column);
+        return column;
+    }
+
+    template <typename T>
+    std::shared_ptr<T> add(const char* name) {
+        return add(name, std::make_shared<T>());
+    }
+
+    std::shared_ptr<StringMap> add_map(const char* name) {
+        return add(name, std::make_shared<StringMap>(std::make_shared<ColumnString>(),
+                                                      std::make_shared<ColumnString>()));
+    }
+
+    size_t rows() const { return block.GetColumnCount() == 0 ? 0 : block[0]->Size(); }
+
+    void clear() {
+        for (size_t i = 0; i < block.GetColumnCount(); ++i) {
+            block[i]->Clear();
+        }
+        block.RefreshRowCount();
+    }
+};
+
+struct ClickHouseClient::MetricColumns : TableColumns {
+    std::shared_ptr<ColumnUInt64> timestamp = add<ColumnUInt64>("timestamp");
+    std::shared_ptr<LowCardinalityString> router_id = add<LowCardinalityString>("router_id");
+    std::shared_ptr<LowCardinalityString> interface = add<LowCardinalityString>("interface");
+    std::shared_ptr<LowCardinalityString> metric_type = add<LowCardinalityString>("metric_type");
+    std::shared_ptr<ColumnFloat64> value = add<ColumnFloat64>("value");
+    std::shared_ptr<StringMap> tags = add_map("tags");
+};
+
+struct ClickHouseClient::PacketFlowColumns : TableColumns {
+    std::shared_ptr<ColumnUInt64> timestamp = add<ColumnUInt64>("timestamp");
+    std::shared_ptr<ColumnString> src_ip = add<ColumnString>("src_ip");
+    std::shared_ptr<ColumnString> dst_ip = add<ColumnString>("dst_ip");
+    std::shared_ptr<ColumnUInt16> src_port = add<ColumnUInt16>("src_port");
+    std::shared_ptr<ColumnUInt16> dst_port = add<ColumnUInt16>("dst_port");
+    std::shared_ptr<ColumnUInt8> protocol = add<ColumnUInt8>("protocol");
+    std::shared_ptr<ColumnUInt64> bytes = add<ColumnUInt64>("bytes");
+    std::shared_ptr<ColumnUInt64> packets = add<ColumnUInt64>("packets");
+    std::shared_ptr<ColumnUInt64> duration_ms = add<ColumnUInt64>("duration_ms");
+    std::shared_ptr<LowCardinalityString> router_id = add<LowCardinalityString>("router_id");
+};
+
+struct ClickHouseClient::BGPUpdateColumns : TableColumns {
+    std::shared_ptr<ColumnUInt64> timestamp = add<ColumnUInt64>("timestamp");
+    std::shared_ptr<LowCardinalityString> router_id = add<LowCardinalityString>("router_id");
+    std::shared_ptr<ColumnString> neighbor_ip = add<ColumnString>("neighbor_ip");
+    std::shared_ptr<ColumnString> prefix = add<ColumnString>("prefix");
+    std::shared_ptr<ColumnUInt8> prefix_length = add<ColumnUInt8>("prefix_length");
+    std::shared_ptr<ColumnArrayT<ColumnUInt32>> as_path = add<ColumnArrayT<ColumnUInt32>>("as_path");
+    std::shared_ptr<ColumnString> next_hop = add<ColumnString>("next_hop");
+    std::shared_ptr<LowCardinalityString> origin = add<LowCardinalityString>("origin");
+    std::shared_ptr<ColumnUInt32> local_pref = add<ColumnUInt32>("local_pref");
+    std::shared_ptr<ColumnUInt32> med = add<ColumnUInt32>("med");
+    std::shared_ptr<ColumnArrayT<ColumnString>> communities = add<ColumnArrayT<ColumnString>>("communities");
+    std::shared_ptr<LowCardinalityString> action = add<LowCardinalityString>("action");
+};
+
+struct ClickHouseClient::OSPFUpdateColumns : TableColumns {
+    std::shared_ptr<ColumnUInt64> timestamp = add<ColumnUInt64>("timestamp");
+    std::shared_ptr<LowCardinalityString> router_id = add<LowCardinalityString>("router_id");
+    std::shared_ptr<ColumnString> area_id = add<ColumnString>("area_id");
+    std::shared_ptr<ColumnUInt8> lsa_type = add<ColumnUInt8>("lsa_type");
+    std::shared_ptr<ColumnString> lsa_id = add<ColumnString>("lsa_id");
+    std::shared_ptr<ColumnString> advertising_router = add<ColumnString>("advertising_router");
+    std::shared_ptr<ColumnUInt32> sequence_number = add<ColumnUInt32>("sequence_number");
+    std::shared_ptr<ColumnUInt16> age = add<ColumnUInt16>("age");
+    std::shared_ptr<ColumnUInt16> checksum = add<ColumnUInt16>("checksum");
+    std::shared_ptr<ColumnUInt16> length = add<ColumnUInt16>("length");
+    std::shared_ptr<LowCardinalityString> action = add<LowCardinalityString>("action");
+};
+
+struct ClickHouseClient::ISISUpdateColumns : TableColumns {
+    std::shared_ptr<ColumnUInt64> timestamp = add<ColumnUInt64>("timestamp");
+    std::shared_ptr<ColumnString> system_id = add<ColumnString>("system_id");
+    std::shared_ptr<ColumnString> area_id = add<ColumnString>("area_id");
+    std::shared_ptr<ColumnUInt8> level = add<ColumnUInt8>("level");
+    std::shared_ptr<ColumnString> lsp_id = add<ColumnString>("lsp_id");
+    std::shared_ptr<ColumnUInt32> sequence_number = add<ColumnUInt32>("sequence_number");
+    std::shared_ptr<ColumnUInt16> remaining_lifetime = add<ColumnUInt16>("remaining_lifetime");
+    std::shared_ptr<ColumnUInt16> checksum = add<ColumnUInt16>("checksum");
+    std::shared_ptr<ColumnUInt16> pdu_length = add<ColumnUInt16>("pdu_length");
+    std::shared_ptr<LowCardinalityString> action = add<LowCardinalityString>("action");
+};
+
+struct ClickHouseClient::TrafficShapingColumns : TableColumns {
+    std::shared_ptr<ColumnUInt64> timestamp = add<ColumnUInt64>("timestamp");
+    std::shared_ptr<LowCardinalityString> router_id = add<LowCardinalityString>("router_id");
+    std::shared_ptr<LowCardinalityString> interface = add<LowCardinalityString>("interface");
+    std::shared_ptr<LowCardinalityString> algorithm = add<LowCardinalityString>("algorithm");
+    std::shared_ptr<ColumnUInt8> class_id = add<ColumnUInt8>("class_id");
+    std::shared_ptr<ColumnUInt64> packets_processed = add<ColumnUInt64>("packets_processed");
+    std::shared_ptr<ColumnUInt64> packets_dropped = add<ColumnUInt64>("packets_dropped");
+    std::shared_ptr<ColumnUInt64> bytes_processed = add<ColumnUInt64>("bytes_processed");
+    std::shared_ptr<ColumnUInt64> bytes_dropped = add<ColumnUInt64>("bytes_dropped");
+    std::shared_ptr<ColumnUInt32> queue_length = add<ColumnUInt32>("queue_length");
+    std::shared_ptr<ColumnFloat64> throughput_bps = add<ColumnFloat64>("throughput_bps");
+};
+
+struct ClickHouseClient::NetemImpairmentColumns : TableColumns {
+    std::shared_ptr<ColumnUInt64> timestamp = add<ColumnUInt64>("timestamp");
+    std::shared_ptr<LowCardinalityString> router_id = add<LowCardinalityString>("router_id");
+    std::shared_ptr<LowCardinalityString> interface = add<LowCardinalityString>("interface");
+    std::shared_ptr<LowCardinalityString> impairment_type = add<LowCardinalityString>("impairment_type");
+    std::shared_ptr<StringMap> parameters = add_map("parameters");
+    std::shared_ptr<ColumnUInt8> active = add<ColumnUInt8>("active");
+};
+
+struct ClickHouseClient::MetricRollupColumns : TableColumns {
+    std::shared_ptr<ColumnUInt64> timestamp = add<ColumnUInt64>("timestamp");
+    std::shared_ptr<ColumnUInt32> window_ms = add<ColumnUInt32>("window_ms");
+    std::shared_ptr<LowCardinalityString> router_id = add<LowCardinalityString>("router_id");
+    std::shared_ptr<LowCardinalityString> interface = add<LowCardinalityString>("interface");
+    std::shared_ptr<LowCardinalityString> metric_type = add<LowCardinalityString>("metric_type");
+    std::shared_ptr<ColumnUInt64> count = add<ColumnUInt64>("count");
+    std::shared_ptr<ColumnFloat64> sum = add<ColumnFloat64>("sum");
+    std::shared_ptr<ColumnFloat64> min = add<ColumnFloat64>("min");
+    std::shared_ptr<ColumnFloat64> max = add<ColumnFloat64>("max");
+    std::shared_ptr<ColumnFloat64> p50 = add<ColumnFloat64>("p50");
+    std::shared_ptr<ColumnFloat64> p90 = add<ColumnFloat64>("p90");
+    std::shared_ptr<ColumnFloat64> p99 = add<ColumnFloat64>("p99");
+    std::shared_ptr<ColumnFloat64> p999 = add<ColumnFloat64>("p999");
+    std::shared_ptr<ColumnUInt64> unique_flows = add<ColumnUInt64>("unique_flows");
+    std::shared_ptr<ColumnString> quantile_sketch = add<ColumnString>("quantile_sketch");
+};
+
+// A table's double buffer: inserters fill active, flushes send standby
+struct ClickHouseClient::Table {
+    uint32_t id;
+    const char* name;
+    size_t batch_rows;
+    std::mutex mutex;                               // guards active
+    std::unique_ptr<TableColumns> active;
+    std::mutex flush_mutex;                         // guards standby, one flush at a time
+    std::unique_ptr<TableColumns> standby;
+    std::string spilled;                            // standby encoded for the journal
+    std::unique_ptr<TableColumns> replay;           // flusher only
+    std::unique_ptr<TableColumns> decoded;          // flusher only: the journal record being read
+    std::atomic<bool> full{false};                  // flusher already asked to take active
+    std::atomic<uint64_t> dropped{0};
+
+    template <typename Columns>
+    static std::unique_ptr<Table> create(TableId id, const char* name, size_t batch_rows) {
+        auto table = std::make_unique<Table>();
+        table->id = id;
+        table->name = name;
+        table->batch_rows = batch_rows;
+        table->active = std::make_unique<Columns>();
+        table->standby = std::make_unique<Columns>();
+        table->replay = std::make_unique<Columns>();
+        table->decoded = std::make_unique<Columns>();
+        return table;
+    }
+};
+
 ClickHouseClient::ClickHouseClient(const std::string& host, int port, const std::string& database, const std::string& user, const std::string& password)
-    : host_(host), port_(port), database_(database), user_(user), password_(password), connected_(false) {
-    
+    : host_(host), port_(port), database_(database), user_(user), password_(password), connected_(false),
+      server_available_(false), flush_requested_(false), stopping_(false), rows_inserted_(0), blocks_inserted_(0),
+      insert_failures_(0), rows_journaled_(0), rows_replayed_(0), records_skipped_(0), replay_ns_(0) {
+
+    tables_.resize(TABLE_COUNT);
+    tables_[METRICS] = Table::create<MetricColumns>(METRICS, "network_metrics", METRIC_BATCH_ROWS);
+    tables_[PACKET_FLOWS] = Table::create<PacketFlowColumns>(PACKET_FLOWS, "packet_flows", METRIC_BATCH_ROWS);
+    tables_[BGP_UPDATES] = Table::create<BGPUpdateColumns>(BGP_UPDATES, "bgp_updates", UPDATE_BATCH_ROWS);
+    tables_[OSPF_UPDATES] = Table::create<OSPFUpdateColumns>(OSPF_UPDATES, "ospf_updates", UPDATE_BATCH_ROWS);
+    tables_[ISIS_UPDATES] = Table::create<ISISUpdateColumns>(ISIS_UPDATES, "isis_updates", UPDATE_BATCH_ROWS);
+    tables_[TRAFFIC_SHAPING] = Table::create<TrafficShapingColumns>(TRAFFIC_SHAPING, "traffic_shaping_metrics", METRIC_BATCH_ROWS);
+    tables_[NETEM_IMPAIRMENTS] = Table::create<NetemImpairmentColumns>(NETEM_IMPAIRMENTS, "netem_impairments", UPDATE_BATCH_ROWS);
+    tables_[METRIC_ROLLUPS] = Table::create<MetricRollupColumns>(METRIC_ROLLUPS, "metric_rollups", UPDATE_BATCH_ROWS);
+
     // Initialize connection string
     connection_string_ = "tcp://" + user_ + ":" + password_ + "@" + host_ + ":" + std::to_string(port_) + "/" + database_;
 }
@@ -18,39 +422,75 @@ ClickHouseClient::~ClickHouseClient() {
     disconnect();
 }
 
-bool ClickHouseClient::connect() {
+bool ClickHouseClient::connect(const ClickHouseFlushOptions& options) {
     if (connected_) {
         return true;
     }
 
+    options_ = options;
+    options_.max_buffered_batches = std::max<size_t>(options_.max_buffered_batches, 1);
+    options_.replay_batch_rows = std::max<size_t>(options_.replay_batch_rows, 1);
+    // Only the flusher reconnects and replays
+    if (options_.background && !options_.journal_directory.empty()) {
+        journal_ = std::make_unique<SegmentJournal>();
+        if (!journal_->open(options_.journal_directory, options_.journal)) {
+            journal_.reset();
+        }
+    }
+
     try {
-        // Create connection
-        client_ = std::make_unique<clickhouse::Client>(clickhouse::ClientOptions()
-            .SetHost(host_)
-            .SetPort(port_)
-            .SetUser(user_)
-            .SetPassword(password_)
-            .SetDefaultDatabase(database_));
-
-        // Test connection
-        client_->Execute("SELECT 1");
-        
-        // Create tables if they don't exist
-        create_tables();
-        
-        connected_ = true;
+        open_client();
+        server_available_ = true;
         std::cout << "Connected to ClickHouse at " << host_ << ":" << port_ << std::endl;
-        return true;
     } catch (const std::exception& e) {
         std::cerr << "Failed to connect to ClickHouse: " << e.what() << std::endl;
-        return false;
+        if (!journal_) {
+            journal_.reset();
+            return false;
+        }
+        std::cerr << "Journaling to " << options_.journal_directory << " until ClickHouse is reachable" << std::endl;
+    }
+
+    connected_ = true;
+    if (options_.background) {
+        stopping_ = false;
+        flusher_ = std::thread(&ClickHouseClient::flusher_loop, this);
     }
+    return true;
+}
+
+void ClickHouseClient::open_client() {
+    // Create connection
+    client_ = std::make_unique<clickhouse::Client>(clickhouse::ClientOptions()
+        .SetHost(host_)
+        .SetPort(port_)
+        .SetUser(user_)
+        .SetPassword(password_)
+        .SetDefaultDatabase(database_));
+
+    // Test connection
+    client_->Execute("SELECT 1");
+
+    // Create tables if they don't exist
+    create_tables();
 }
 
 void ClickHouseClient::disconnect() {
     if (connected_) {
+        if (flusher_.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(flusher_mutex_);
+                stopping_ = true;
+            }
+            flusher_cv_.notify_one();
+            flusher_.join();
+        }
+
         // Flush any remaining data
         flush_all_buffers();
+        if (journal_) {
+            journal_->close();
+        }
         connected_ = false;
         std::cout << "Disconnected from ClickHouse" << std::endl;
     }
@@ -60,102 +500,166 @@ bool ClickHouseClient::is_connected() const {
     return connected_;
 }
 
-void ClickHouseClient::insert_metric(const NetworkMetric& metric) {
+template <typename Columns, typename Append>
+void ClickHouseClient::insert_row(TableId id, Append append) {
     if (!connected_) {
         return;
     }
 
-    std::lock_guard<std::mutex> lock(metrics_mutex_);
-    metrics_buffer_.push_back(metric);
-    
+    Table& table = *tables_[id];
+    size_t rows;
+    {
+        std::lock_guard<std::mutex> lock(table.mutex);
+        rows = table.active->rows();
+        if (rows >= table.batch_rows * options_.max_buffered_batches) {
+            // The standby batch is still on its way; dropping beats stalling the caller
+            table.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        append(static_cast<Columns&>(*table.active));
+        rows++;
+    }
+
     // Flush if buffer is full
-    if (metrics_buffer_.size() >= 1000) {
-        flush_metrics();
+    if (rows >= table.batch_rows) {
+        if (options_.background) {
+            request_flush(table);
+        } else {
+            flush_table(table);
+        }
     }
 }
 
-void ClickHouseClient::insert_packet_flow(const PacketFlow& flow) {
-    if (!connected_) {
+void ClickHouseClient::request_flush(Table& table) {
+    if (table.full.load(std::memory_order_relaxed) || table.full.exchange(true)) {
         return;
     }
-
-    std::lock_guard<std::mutex> lock(flows_mutex_);
-    packet_flows_buffer_.push_back(flow);
-    
-    // Flush if buffer is full
-    if (packet_flows_buffer_.size() >= 1000) {
-        flush_packet_flows();
+    {
+        std::lock_guard<std::mutex> lock(flusher_mutex_);
+        flush_requested_ = true;
     }
+    flusher_cv_.notify_one();
 }
 
-void ClickHouseClient::insert_bgp_update(const BGPUpdate& update) {
-    if (!connected_) {
-        return;
-    }
+void ClickHouseClient::insert_metric(const NetworkMetric& metric) {
+    insert_row<MetricColumns>(METRICS, [&](MetricColumns& columns) {
+        columns.timestamp->Append(metric.timestamp);
+        columns.router_id->Append(metric.router_id);
+        columns.interface->Append(metric.interface);
+        columns.metric_type->Append(metric.metric_type);
+        columns.value->Append(metric.value);
+        columns.tags->Append(metric.tags);
+    });
+}
 
-    std::lock_guard<std::mutex> lock(bgp_mutex_);
-    bgp_updates_buffer_.push_back(update);
-    
-    // Flush if buffer is full
-    if (bgp_updates_buffer_.size() >= 100) {
-        flush_bgp_updates();
-    }
+void ClickHouseClient::insert_packet_flow(const PacketFlow& flow) {
+    insert_row<PacketFlowColumns>(PACKET_FLOWS, [&](PacketFlowColumns& columns) {
+        columns.timestamp->Append(flow.timestamp);
+        columns.src_ip->Append(flow.src_ip);
+        columns.dst_ip->Append(flow.dst_ip);
+        columns.src_port->Append(flow.src_port);
+        columns.dst_port->Append(flow.dst_port);
+        columns.protocol->Append(flow.protocol);
+        columns.bytes->Append(flow.bytes);
+        columns.packets->Append(flow.packets);
+        columns.duration_ms->Append(flow.duration_ms);
+        columns.router_id->Append(flow.router_id);
+    });
 }
 
-void ClickHouseClient::insert_ospf_update(const OSPFUpdate& update) {
-    if (!connected_) {
-        return;
-    }
+void ClickHouseClient::insert_bgp_update(const BGPUpdate& update) {
+    insert_row<BGPUpdateColumns>(BGP_UPDATES, [&](BGPUpdateColumns& columns) {
+        columns.timestamp->Append(update.timestamp);
+        columns.router_id->Append(update.router_id);
+        columns.neighbor_ip->Append(update.neighbor_ip);
+        columns.prefix->Append(update.prefix);
+        columns.prefix_length->Append(update.prefix_length);
+        columns.as_path->Append(update.as_path);
+        columns.next_hop->Append(update.next_hop);
+        columns.origin->Append(update.origin);
+        columns.local_pref->Append(update.local_pref);
+        columns.med->Append(update.med);
+        columns.communities->Append(update.communities);
+        columns.action->Append(update.action);
+    });
+}
 
-    std::lock_guard<std::mutex> lock(ospf_mutex_);
-    ospf_updates_buffer_.push_back(update);
-    
-    // Flush if buffer is full
-    if (ospf_updates_buffer_.size() >= 100) {
-        flush_ospf_updates();
-    }
+void ClickHouseClient::insert_ospf_update(const OSPFUpdate& update) {
+    insert_row<OSPFUpdateColumns>(OSPF_UPDATES, [&](OSPFUpdateColumns& columns) {
+        columns.timestamp->Append(update.timestamp);
+        columns.router_id->Append(update.router_id);
+        columns.area_id->Append(update.area_id);
+        columns.lsa_type->Append(update.lsa_type);
+        columns.lsa_id->Append(update.lsa_id);
+        columns.advertising_router->Append(update.advertising_router);
+        columns.sequence_number->Append(update.sequence_number);
+        columns.age->Append(update.age);
+        columns.checksum->Append(update.checksum);
+        columns.length->Append(update.length);
+        columns.action->Append(update.action);
+    });
 }
 
 void ClickHouseClient::insert_isis_update(const ISISUpdate& update) {
-    if (!connected_) {
-        return;
-    }
-
-    std::lock_guard<std::mutex> lock(isis_mutex_);
-    isis_updates_buffer_.push_back(update);
-    
-    // Flush if buffer is full
-    if (isis_updates_buffer_.size() >= 100) {
-        flush_isis_updates();
-    }
+    insert_row<ISISUpdateColumns>(ISIS_UPDATES, [&](ISISUpdateColumns& columns) {
+        columns.timestamp->Append(update.timestamp);
+        columns.system_id->Append(update.system_id);
+        columns.area_id->Append(update.area_id);
+        columns.level->Append(update.level);
+        columns.lsp_id->Append(update.lsp_id);
+        columns.sequence_number->Append(update.sequence_number);
+        columns.remaining_lifetime->Append(update.remaining_lifetime);
+        columns.checksum->Append(update.checksum);
+        columns.pdu_length->Append(update.pdu_length);
+        columns.action->Append(update.action);
+    });
 }
 
 void ClickHouseClient::insert_traffic_shaping_metric(const TrafficShapingMetric& metric) {
-    if (!connected_) {
-        return;
-    }
-
-    std::lock_guard<std::mutex> lock(traffic_mutex_);
-    traffic_shaping_buffer_.push_back(metric);
-    
-    // Flush if buffer is full
-    if (traffic_shaping_buffer_.size() >= 1000) {
-        flush_traffic_shaping_metrics();
-    }
+    insert_row<TrafficShapingColumns>(TRAFFIC_SHAPING, [&](TrafficShapingColumns& columns) {
+        columns.timestamp->Append(metric.timestamp);
+        columns.router_id->Append(metric.router_id);
+        columns.interface->Append(metric.interface);
+        columns.algorithm->Append(metric.algorithm);
+        columns.class_id->Append(metric.class_id);
+        columns.packets_processed->Append(metric.packets_processed);
+        columns.packets_dropped->Append(metric.packets_dropped);
+        columns.bytes_processed->Append(metric.bytes_processed);
+        columns.bytes_dropped->Append(metric.bytes_dropped);
+        columns.queue_length->Append(metric.queue_length);
+        columns.throughput_bps->Append(metric.throughput_bps);
+    });
 }
 
 void ClickHouseClient::insert_netem_impairment(const NetemImpairment& impairment) {
-    if (!connected_) {
-        return;
-    }
+    insert_row<NetemImpairmentColumns>(NETEM_IMPAIRMENTS, [&](NetemImpairmentColumns& columns) {
+        columns.timestamp->Append(impairment.timestamp);
+        columns.router_id->Append(impairment.router_id);
+        columns.interface->Append(impairment.interface);
+        columns.impairment_type->Append(impairment.impairment_type);
+        columns.parameters->Append(impairment.parameters);
+        columns.active->Append(impairment.active ? 1 : 0);
+    });
+}
 
-    std::lock_guard<std::mutex> lock(netem_mutex_);
-    netem_impairments_buffer_.push_back(impairment);
-    
-    // Flush if buffer is full
-    if (netem_impairments_buffer_.size() >= 100) {
-        flush_netem_impairments();
-    }
+void ClickHouseClient::insert_metric_rollup(const MetricRollup& rollup) {
+    insert_row<MetricRollupColumns>(METRIC_ROLLUPS, [&](MetricRollupColumns& columns) {
+        columns.timestamp->Append(rollup.timestamp);
+        columns.window_ms->Append(rollup.window_ms);
+        columns.router_id->Append(rollup.router_id);
+        columns.interface->Append(rollup.interface);
+        columns.metric_type->Append(rollup.metric_type);
+        columns.count->Append(rollup.count);
+        columns.sum->Append(rollup.sum);
+        columns.min->Append(rollup.min);
+        columns.max->Append(rollup.max);
+        columns.p50->Append(rollup.p50);
+        columns.p90->Append(rollup.p90);
+        columns.p99->Append(rollup.p99);
+        columns.p999->Append(rollup.p999);
+        columns.unique_flows->Append(rollup.unique_flows);
+        columns.quantile_sketch->Append(rollup.quantile_sketch);
+    });
 }
 
 void ClickHouseClient::flush_all_buffers() {
@@ -166,6 +670,7 @@ void ClickHouseClient::flush_all_buffers() {
     flush_isis_updates();
     flush_traffic_shaping_metrics();
     flush_netem_impairments();
+    flush_metric_rollups();
 }
 
 void ClickHouseClient::create_tables() {
@@ -174,9 +679,9 @@ void ClickHouseClient::create_tables() {
         client_->Execute(R"(
             CREATE TABLE IF NOT EXISTS network_metrics (
                 timestamp UInt64,
-                router_id String,
-                interface String,
-                metric_type String,
+                router_id LowCardinality(String),
+                interface LowCardinality(String),
+                metric_type LowCardinality(String),
                 value Float64,
                 tags Map(String, String),
                 date Date MATERIALIZED toDate(timestamp / 1000)
@@ -197,7 +702,7 @@ void ClickHouseClient::create_tables() {
                 bytes UInt64,
                 packets UInt64,
                 duration_ms UInt64,
-                router_id String,
+                router_id LowCardinality(String),
                 date Date MATERIALIZED toDate(timestamp / 1000)
             ) ENGINE = MergeTree()
             PARTITION BY date
@@ -208,17 +713,17 @@ void ClickHouseClient::create_tables() {
         client_->Execute(R"(
             CREATE TABLE IF NOT EXISTS bgp_updates (
                 timestamp UInt64,
-                router_id String,
+                router_id LowCardinality(String),
                 neighbor_ip String,
                 prefix String,
                 prefix_length UInt8,
                 as_path Array(UInt32),
                 next_hop String,
-                origin String,
+                origin LowCardinality(String),
                 local_pref UInt32,
                 med UInt32,
                 communities Array(String),
-                action String,
+                action LowCardinality(String),
                 date Date MATERIALIZED toDate(timestamp / 1000)
             ) ENGINE = MergeTree()
             PARTITION BY date
@@ -229,7 +734,7 @@ void ClickHouseClient::create_tables() {
         client_->Execute(R"(
             CREATE TABLE IF NOT EXISTS ospf_updates (
                 timestamp UInt64,
-                router_id String,
+                router_id LowCardinality(String),
                 area_id String,
                 lsa_type UInt8,
                 lsa_id String,
@@ -238,7 +743,7 @@ void ClickHouseClient::create_tables() {
                 age UInt16,
                 checksum UInt16,
                 length UInt16,
-                action String,
+                action LowCardinality(String),
                 date Date MATERIALIZED toDate(timestamp / 1000)
             ) ENGINE = MergeTree()
             PARTITION BY date
@@ -257,7 +762,7 @@ void ClickHouseClient::create_tables() {
                 remaining_lifetime UInt16,
                 checksum UInt16,
                 pdu_length UInt16,
-                action String,
+                action LowCardinality(String),
                 date Date MATERIALIZED toDate(timestamp / 1000)
             ) ENGINE = MergeTree()
             PARTITION BY date
@@ -268,9 +773,9 @@ void ClickHouseClient::create_tables() {
         client_->Execute(R"(
             CREATE TABLE IF NOT EXISTS traffic_shaping_metrics (
                 timestamp UInt64,
-                router_id String,
-                interface String,
-                algorithm String,
+                router_id LowCardinality(String),
+                interface LowCardinality(String),
+                algorithm LowCardinality(String),
                 class_id UInt8,
                 packets_processed UInt64,
                 packets_dropped UInt64,
@@ -288,9 +793,9 @@ void ClickHouseClient::create_tables() {
         client_->Execute(R"(
             CREATE TABLE IF NOT EXISTS netem_impairments (
                 timestamp UInt64,
-                router_id String,
-                interface String,
-                impairment_type String,
+                router_id LowCardinality(String),
+                interface LowCardinality(String),
+                impairment_type LowCardinality(String),
                 parameters Map(String, String),
                 active UInt8,
                 date Date MATERIALIZED toDate(timestamp / 1000)
@@ -299,254 +804,283 @@ void ClickHouseClient::create_tables() {
             ORDER BY (router_id, interface, impairment_type, timestamp)
         )");
 
+        // Create metric rollups table
+        client_->Execute(R"(
+            CREATE TABLE IF NOT EXISTS metric_rollups (
+                timestamp UInt64,
+                window_ms UInt32,
+                router_id LowCardinality(String),
+                interface LowCardinality(String),
+                metric_type LowCardinality(String),
+                count UInt64,
+                sum Float64,
+                min Float64,
+                max Float64,
+                p50 Float64,
+                p90 Float64,
+                p99 Float64,
+                p999 Float64,
+                unique_flows UInt64,
+                quantile_sketch String,
+                date Date MATERIALIZED toDate(timestamp / 1000)
+            ) ENGINE = MergeTree()
+            PARTITION BY date
+            ORDER BY (router_id, interface, metric_type, timestamp)
+        )");
+
         std::cout << "ClickHouse tables created successfully" << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "Failed to create ClickHouse tables: " << e.what() << std::endl;
     }
 }
 
-void ClickHouseClient::flush_metrics() {
-    std::lock_guard<std::mutex> lock(metrics_mutex_);
-    if (metrics_buffer_.empty()) {
-        return;
-    }
+void ClickHouseClient::flusher_loop() {
+    auto interval = std::chrono::milliseconds(std::max<uint32_t>(options_.flush_interval_ms, 1));
+    auto deadline = std::chrono::steady_clock::now() + interval;
 
-    try {
-        clickhouse::Block block;
-        
-        for (const auto& metric : metrics_buffer_) {
-            block.AppendColumn("timestamp", std::vector<uint64_t>{metric.timestamp});
-            block.AppendColumn("router_id", std::vector<std::string>{metric.router_id});
-            block.AppendColumn("interface", std::vector<std::string>{metric.interface});
-            block.AppendColumn("metric_type", std::vector<std::string>{metric.metric_type});
-            block.AppendColumn("value", std::vector<double>{metric.value});
-            
-            // Convert tags map to ClickHouse format
-            std::vector<std::string> tag_keys, tag_values;
-            for (const auto& [key, value] : metric.tags) {
-                tag_keys.push_back(key);
-                tag_values.push_back(value);
+    std::unique_lock<std::mutex> lock(flusher_mutex_);
+    while (!stopping_) {
+        // A journal being replayed keeps the flusher going between passes
+        bool replaying = journal_ && server_available_ && journal_->has_pending();
+        if (!replaying) {
+            flusher_cv_.wait_until(lock, deadline, [this] { return stopping_ || flush_requested_; });
+        }
+        if (stopping_) {
+            break;
+        }
+        flush_requested_ = false;
+        bool timed_out = std::chrono::steady_clock::now() >= deadline;
+        lock.unlock();
+
+        // Full batches go as soon as they fill, the rest when the interval is up
+        bool backlogged = false;
+        for (auto& table : tables_) {
+            if (timed_out || table->full.load(std::memory_order_relaxed)) {
+                flush_table(*table);
             }
-            block.AppendColumn("tags", std::make_pair(tag_keys, tag_values));
+            backlogged = backlogged || table->full.load(std::memory_order_relaxed);
         }
 
-        client_->Insert("network_metrics", block);
-        metrics_buffer_.clear();
-    } catch (const std::exception& e) {
-        std::cerr << "Failed to flush metrics: " << e.what() << std::endl;
+        if (journal_) {
+            if (timed_out && !server_available_) {
+                reconnect();
+            }
+            // Live rows first: replay only while every table keeps up
+            if (server_available_ && !backlogged && journal_->has_pending()) {
+                replay_journal();
+            }
+        }
+
+        lock.lock();
+        if (timed_out) {
+            deadline = std::chrono::steady_clock::now() + interval;
+        }
     }
 }
 
-void ClickHouseClient::flush_packet_flows() {
-    std::lock_guard<std::mutex> lock(flows_mutex_);
-    if (packet_flows_buffer_.empty()) {
-        return;
+bool ClickHouseClient::flush_table(Table& table) {
+    std::lock_guard<std::mutex> flush_lock(table.flush_mutex);
+    while (true) {
+        bool swapped = false;
+        if (table.standby->rows() == 0) {
+            std::lock_guard<std::mutex> lock(table.mutex);
+            std::swap(table.active, table.standby);
+            table.full.store(false, std::memory_order_relaxed);
+            swapped = true;
+        }
+        if (table.standby->rows() == 0) {
+            return true;
+        }
+        if (!deliver(table, *table.standby)) {
+            return false;
+        }
+        if (swapped) {
+            return true;
+        }
     }
+}
 
-    try {
-        clickhouse::Block block;
-        
-        for (const auto& flow : packet_flows_buffer_) {
-            block.AppendColumn("timestamp", std::vector<uint64_t>{flow.timestamp});
-            block.AppendColumn("src_ip", std::vector<std::string>{flow.src_ip});
-            block.AppendColumn("dst_ip", std::vector<std::string>{flow.dst_ip});
-            block.AppendColumn("src_port", std::vector<uint16_t>{flow.src_port});
-            block.AppendColumn("dst_port", std::vector<uint16_t>{flow.dst_port});
-            block.AppendColumn("protocol", std::vector<uint8_t>{flow.protocol});
-            block.AppendColumn("bytes", std::vector<uint64_t>{flow.bytes});
-            block.AppendColumn("packets", std::vector<uint64_t>{flow.packets});
-            block.AppendColumn("duration_ms", std::vector<uint64_t>{flow.duration_ms});
-            block.AppendColumn("router_id", std::vector<std::string>{flow.router_id});
-        }
+bool ClickHouseClient::deliver(Table& table, TableColumns& columns) {
+    if (!journal_) {
+        return send_block(table.name, columns);
+    }
 
-        client_->Insert("packet_flows", block);
-        packet_flows_buffer_.clear();
-    } catch (const std::exception& e) {
-        std::cerr << "Failed to flush packet flows: " << e.what() << std::endl;
+    bool backlogged;
+    {
+        std::lock_guard<std::mutex> lock(table.mutex);
+        backlogged = table.active->rows() >= table.batch_rows * options_.max_buffered_batches;
+    }
+    if (!server_available_ || backlogged || !send_block(table.name, columns)) {
+        spill(table, columns);
     }
+    return true;
 }
 
-void ClickHouseClient::flush_bgp_updates() {
-    std::lock_guard<std::mutex> lock(bgp_mutex_);
-    if (bgp_updates_buffer_.empty()) {
-        return;
+bool ClickHouseClient::send_block(const char* table, TableColumns& columns) {
+    size_t rows = columns.rows();
+    std::lock_guard<std::mutex> lock(client_mutex_);
+    if (!client_) {
+        return false;
     }
-
     try {
-        clickhouse::Block block;
-        
-        for (const auto& update : bgp_updates_buffer_) {
-            block.AppendColumn("timestamp", std::vector<uint64_t>{update.timestamp});
-            block.AppendColumn("router_id", std::vector<std::string>{update.router_id});
-            block.AppendColumn("neighbor_ip", std::vector<std::string>{update.neighbor_ip});
-            block.AppendColumn("prefix", std::vector<std::string>{update.prefix});
-            block.AppendColumn("prefix_length", std::vector<uint8_t>{update.prefix_length});
-            block.AppendColumn("as_path", std::vector<std::vector<uint32_t>>{update.as_path});
-            block.AppendColumn("next_hop", std::vector<std::string>{update.next_hop});
-            block.AppendColumn("origin", std::vector<std::string>{update.origin});
-            block.AppendColumn("local_pref", std::vector<uint32_t>{update.local_pref});
-            block.AppendColumn("med", std::vector<uint32_t>{update.med});
-            block.AppendColumn("communities", std::vector<std::vector<std::string>>{update.communities});
-            block.AppendColumn("action", std::vector<std::string>{update.action});
-        }
-
-        client_->Insert("bgp_updates", block);
-        bgp_updates_buffer_.clear();
+        columns.block.RefreshRowCount();
+        client_->Insert(table, columns.block);
+        columns.clear();
+        rows_inserted_ += rows;
+        blocks_inserted_++;
+        return true;
     } catch (const std::exception& e) {
-        std::cerr << "Failed to flush BGP updates: " << e.what() << std::endl;
+        insert_failures_++;
+        server_available_ = false;
+        std::cerr << "Failed to flush " << table << ": " << e.what() << std::endl;
+        return false;
     }
 }
 
-void ClickHouseClient::flush_ospf_updates() {
-    std::lock_guard<std::mutex> lock(ospf_mutex_);
-    if (ospf_updates_buffer_.empty()) {
-        return;
+void ClickHouseClient::spill(Table& table, TableColumns& columns) {
+    size_t rows = columns.rows();
+    table.spilled.clear();
+    for (size_t i = 0; i < columns.block.GetColumnCount(); ++i) {
+        save_column(columns.block[i], table.spilled);
     }
+    if (journal_->append(table.id, static_cast<uint32_t>(rows), table.spilled.data(), table.spilled.size())) {
+        rows_journaled_ += rows;
+    } else {
+        table.dropped.fetch_add(rows, std::memory_order_relaxed);
+    }
+    columns.clear();
+}
 
+bool ClickHouseClient::reconnect() {
+    std::lock_guard<std::mutex> lock(client_mutex_);
     try {
-        clickhouse::Block block;
-        
-        for (const auto& update : ospf_updates_buffer_) {
-            block.AppendColumn("timestamp", std::vector<uint64_t>{update.timestamp});
-            block.AppendColumn("router_id", std::vector<std::string>{update.router_id});
-            block.AppendColumn("area_id", std::vector<std::string>{update.area_id});
-            block.AppendColumn("lsa_type", std::vector<uint8_t>{update.lsa_type});
-            block.AppendColumn("lsa_id", std::vector<std::string>{update.lsa_id});
-            block.AppendColumn("advertising_router", std::vector<std::string>{update.advertising_router});
-            block.AppendColumn("sequence_number", std::vector<uint32_t>{update.sequence_number});
-            block.AppendColumn("age", std::vector<uint16_t>{update.age});
-            block.AppendColumn("checksum", std::vector<uint16_t>{update.checksum});
-            block.AppendColumn("length", std::vector<uint16_t>{update.length});
-            block.AppendColumn("action", std::vector<std::string>{update.action});
-        }
-
-        client_->Insert("ospf_updates", block);
-        ospf_updates_buffer_.clear();
-    } catch (const std::exception& e) {
-        std::cerr << "Failed to flush OSPF updates: " << e.what() << std::endl;
+        open_client();
+    } catch (const std::exception&) {
+        return false;
     }
+    server_available_ = true;
+    std::cout << "Reconnected to ClickHouse at " << host_ << ":" << port_ << std::endl;
+    return true;
 }
 
-void ClickHouseClient::flush_isis_updates() {
-    std::lock_guard<std::mutex> lock(isis_mutex_);
-    if (isis_updates_buffer_.empty()) {
-        return;
-    }
+void ClickHouseClient::replay_journal() {
+    auto start = std::chrono::steady_clock::now();
+    SegmentJournal::Record record;
+    uint64_t rows_read = 0;
+    bool sent = true;
 
-    try {
-        clickhouse::Block block;
-        
-        for (const auto& update : isis_updates_buffer_) {
-            block.AppendColumn("timestamp", std::vector<uint64_t>{update.timestamp});
-            block.AppendColumn("system_id", std::vector<std::string>{update.system_id});
-            block.AppendColumn("area_id", std::vector<std::string>{update.area_id});
-            block.AppendColumn("level", std::vector<uint8_t>{update.level});
-            block.AppendColumn("lsp_id", std::vector<std::string>{update.lsp_id});
-            block.AppendColumn("sequence_number", std::vector<uint32_t>{update.sequence_number});
-            block.AppendColumn("remaining_lifetime", std::vector<uint16_t>{update.remaining_lifetime});
-            block.AppendColumn("checksum", std::vector<uint16_t>{update.checksum});
-            block.AppendColumn("pdu_length", std::vector<uint16_t>{update.pdu_length});
-            block.AppendColumn("action", std::vector<std::string>{update.action});
+    // Records of a table are merged until its block has replay_batch_rows rows
+    while (sent && rows_read < options_.replay_batch_rows && journal_->read(record)) {
+        if (record.tag >= TABLE_COUNT) {
+            continue;
+        }
+        Table& table = *tables_[record.tag];
+        // Decoded apart so a record of another schema leaves the merged rows intact
+        table.decoded->clear();
+        RecordReader in{record.data.data(), record.data.data() + record.data.size(), true};
+        bool loaded = true;
+        for (size_t i = 0; i < table.decoded->block.GetColumnCount() && loaded; ++i) {
+            loaded = load_column(table.decoded->block[i], in, record.rows);
+        }
+        if (!loaded || in.data != in.end) {
+            std::cerr << "Skipping undecodable journal record for " << table.name << std::endl;
+            records_skipped_++;
+            continue;
+        }
+        for (size_t i = 0; i < table.replay->block.GetColumnCount(); ++i) {
+            table.replay->block[i]->Append(table.decoded->block[i]);
+        }
+        rows_read += record.rows;
+        if (table.replay->rows() >= options_.replay_batch_rows) {
+            sent = send_block(table.name, *table.replay);
+        }
+    }
+    for (auto& table : tables_) {
+        if (sent && table->replay->rows() > 0) {
+            sent = send_block(table->name, *table->replay);
         }
+        table->replay->clear();
+        table->decoded->clear();
+    }
 
-        client_->Insert("isis_updates", block);
-        isis_updates_buffer_.clear();
-    } catch (const std::exception& e) {
-        std::cerr << "Failed to flush IS-IS updates: " << e.what() << std::endl;
+    if (sent) {
+        journal_->commit();
+        rows_replayed_ += rows_read;
+    } else {
+        journal_->rewind();
     }
+    replay_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
 }
 
-void ClickHouseClient::flush_traffic_shaping_metrics() {
-    std::lock_guard<std::mutex> lock(traffic_mutex_);
-    if (traffic_shaping_buffer_.empty()) {
-        return;
-    }
+void ClickHouseClient::flush_metrics() {
+    flush_table(*tables_[METRICS]);
+}
 
-    try {
-        clickhouse::Block block;
-        
-        for (const auto& metric : traffic_shaping_buffer_) {
-            block.AppendColumn("timestamp", std::vector<uint64_t>{metric.timestamp});
-            block.AppendColumn("router_id", std::vector<std::string>{metric.router_id});
-            block.AppendColumn("interface", std::vector<std::string>{metric.interface});
-            block.AppendColumn("algorithm", std::vector<std::string>{metric.algorithm});
-            block.AppendColumn("class_id", std::vector<uint8_t>{metric.class_id});
-            block.AppendColumn("packets_processed", std::vector<uint64_t>{metric.packets_processed});
-            block.AppendColumn("packets_dropped", std::vector<uint64_t>{metric.packets_dropped});
-            block.AppendColumn("bytes_processed", std::vector<uint64_t>{metric.bytes_processed});
-            block.AppendColumn("bytes_dropped", std::vector<uint64_t>{metric.bytes_dropped});
-            block.AppendColumn("queue_length", std::vector<uint32_t>{metric.queue_length});
-            block.AppendColumn("throughput_bps", std::vector<double>{metric.throughput_bps});
-        }
+void ClickHouseClient::flush_packet_flows() {
+    flush_table(*tables_[PACKET_FLOWS]);
+}
 
-        client_->Insert("traffic_shaping_metrics", block);
-        traffic_shaping_buffer_.clear();
-    } catch (const std::exception& e) {
-        std::cerr << "Failed to flush traffic shaping metrics: " << e.what() << std::endl;
-    }
+void ClickHouseClient::flush_bgp_updates() {
+    flush_table(*tables_[BGP_UPDATES]);
 }
 
-void ClickHouseClient::flush_netem_impairments() {
-    std::lock_guard<std::mutex> lock(netem_mutex_);
-    if (netem_impairments_buffer_.empty()) {
-        return;
-    }
+void ClickHouseClient::flush_ospf_updates() {
+    flush_table(*tables_[OSPF_UPDATES]);
+}
 
-    try {
-        clickhouse::Block block;
-        
-        for (const auto& impairment : netem_impairments_buffer_) {
-            block.AppendColumn("timestamp", std::vector<uint64_t>{impairment.timestamp});
-            block.AppendColumn("router_id", std::vector<std::string>{impairment.router_id});
-            block.AppendColumn("interface", std::vector<std::string>{impairment.interface});
-            block.AppendColumn("impairment_type", std::vector<std::string>{impairment.impairment_type});
-            
-            // Convert parameters map to ClickHouse format
-            std::vector<std::string> param_keys, param_values;
-            for (const auto& [key, value] : impairment.parameters) {
-                param_keys.push_back(key);
-                param_values.push_back(value);
-            }
-            block.AppendColumn("parameters", std::make_pair(param_keys, param_values));
-            block.AppendColumn("active", std::vector<uint8_t>{impairment.active ? 1 : 0});
-        }
+void ClickHouseClient::flush_isis_updates() {
+    flush_table(*tables_[ISIS_UPDATES]);
+}
 
-        client_->Insert("netem_impairments", block);
-        netem_impairments_buffer_.clear();
-    } catch (const std::exception& e) {
-        std::cerr << "Failed to flush netem impairments: " << e.what() << std::endl;
-    }
+void ClickHouseClient::flush_traffic_shaping_metrics() {
+    flush_table(*tables_[TRAFFIC_SHAPING]);
+}
+
+void ClickHouseClient::flush_netem_impairments() {
+    flush_table(*tables_[NETEM_IMPAIRMENTS]);
+}
+
+void ClickHouseClient::flush_metric_rollups() {
+    flush_table(*tables_[METRIC_ROLLUPS]);
 }
 
 std::vector<std::map<std::string, std::string>> ClickHouseClient::query(const std::string& query) {
     std::vector<std::map<std::string, std::string>> results;
-    
+
     if (!connected_) {
         return results;
     }
 
+    std::lock_guard<std::mutex> lock(client_mutex_);
     try {
-        auto result = client_->Select(query);
-        
-        while (result->HasNext()) {
-            auto row = result->Next();
-            std::map<std::string, std::string> row_data;
-            
-            // This is a simplified implementation
-            // In practice, you would need to handle different column types
-            for (size_t i = 0; i < row.GetColumnCount(); ++i) {
-                std::string column_name = row.GetColumnName(i);
-                std::string value = row.GetColumnAsString(i);
-                row_data[column_name] = value;
+        client_->Select(query, [&](const Block& block) {
+            for (size_t row = 0; row < block.GetRowCount(); ++row) {
+                std::map<std::string, std::string> row_data;
+                for (size_t i = 0; i < block.GetColumnCount(); ++i) {
+                    row_data[block.GetColumnName(i)] = column_value(block[i], row);
+                }
+                results.push_back(std::move(row_data));
             }
-            
-            results.push_back(row_data);
-        }
+        });
     } catch (const std::exception& e) {
         std::cerr << "Query failed: " << e.what() << std::endl;
     }
-    
+
     return results;
 }
 
+ClickHouseClient::Statistics ClickHouseClient::get_statistics() const {
+    uint64_t dropped = 0;
+    for (const auto& table : tables_) {
+        dropped += table->dropped.load(std::memory_order_relaxed);
+    }
+    return Statistics{rows_inserted_.load(), blocks_inserted_.load(), insert_failures_.load(), dropped,
+                      rows_journaled_.load(), rows_replayed_.load(), records_skipped_.load(),
+                      replay_ns_.load() / 1e9};
+}
+
+SegmentJournal::Statistics ClickHouseClient::get_journal_statistics() const {
+    return journal_ ? journal_->get_statistics() : SegmentJournal::Statistics{};
+}
+
 } // namespace RouterSim
@@ -0,0 +1,262 @@
+#include "analytics/flow_cache.h"
+#include "analytics/clickhouse_client.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+namespace RouterSim {
+
+namespace {
+
+const uint64_t NS_PER_MS = 1000000;
+// Slots checked for timeouts per packet in update_burst(): the table is
+// swept once per capacity / 2 packets
+const size_t SWEEP_SLOTS_PER_PACKET = 2;
+// Hashed and prefetched ahead of the table updates in update_burst()
+const size_t PREFETCH_BATCH = 16;
+
+uint64_t mix(uint64_t hash, uint64_t word) {
+    hash = (hash ^ word) * 0x9e3779b97f4a7c15ull;
+    return hash ^ (hash >> 32);
+}
+
+// Steady-clock packet timestamps to wall-clock nanoseconds
+int64_t wall_clock_offset_ns() {
+    static const int64_t offset =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+            .count() -
+        static_cast<int64_t>(packet_clock_ns());
+    return offset;
+}
+
+} // namespace
+
+FlowCache::FlowCache(const FlowCacheOptions& options, ExportCallback on_export)
+    : count_(0), sweep_cursor_(0), active_timeout_ns_(uint64_t(options.active_timeout_ms) * NS_PER_MS),
+      idle_timeout_ns_(uint64_t(options.idle_timeout_ms) * NS_PER_MS), on_export_(std::move(on_export)) {
+    size_t capacity = 1;
+    while (capacity < std::max<size_t>(options.capacity, 2)) {
+        capacity <<= 1;
+    }
+    tags_.assign(capacity, 0);
+    entries_.resize(capacity);
+    mask_ = capacity - 1;
+    max_probe_ = std::min(std::max<size_t>(options.max_probe, 1), capacity);
+    reset_statistics();
+}
+
+uint64_t hash_flow_key(const FlowKey& key) {
+    uint64_t words[4];
+    std::memcpy(&words[0], key.src_addr.bytes, 16);
+    std::memcpy(&words[2], key.dst_addr.bytes, 16);
+    uint64_t hash = mix(0, (uint64_t(key.src_port) << 24) | (uint64_t(key.dst_port) << 8) | key.protocol);
+    for (uint64_t word : words) {
+        hash = mix(hash, word);
+    }
+    hash ^= hash >> 29;
+    hash *= 0xbf58476d1ce4e5b9ull;
+    return hash ^ (hash >> 32);
+}
+
+void FlowCache::update(const PacketDescriptor& packet) {
+    update_hashed(packet, hash_flow_key(FlowKey::from_packet(packet)));
+}
+
+void FlowCache::update_burst(const PacketDescriptor* packets, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    // Two passes per batch so the tag and entry loads for the whole batch
+    // are in flight before the first probe
+    uint64_t hashes[PREFETCH_BATCH];
+    for (size_t base = 0; base < count; base += PREFETCH_BATCH) {
+        size_t batch = std::min(PREFETCH_BATCH, count - base);
+        for (size_t i = 0; i < batch; ++i) {
+            hashes[i] = hash_flow_key(FlowKey::from_packet(packets[base + i]));
+            size_t home = hashes[i] & mask_;
+            __builtin_prefetch(&tags_[home]);
+            __builtin_prefetch(&entries_[home]);
+        }
+        for (size_t i = 0; i < batch; ++i) {
+            update_hashed(packets[base + i], hashes[i]);
+        }
+    }
+    sweep(packets[count - 1].timestamp_ns, count * SWEEP_SLOTS_PER_PACKET);
+
+    burst_packets_ += count;
+    burst_ns_ += static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+void FlowCache::update_hashed(const PacketDescriptor& packet, uint64_t hash) {
+    uint64_t now = packet.timestamp_ns;
+    uint32_t tag = static_cast<uint32_t>(hash >> 32) | 1;
+    size_t home = hash & mask_;
+    packets_++;
+    bytes_ += packet.size;
+
+    size_t victim = home;
+    uint64_t oldest = std::numeric_limits<uint64_t>::max();
+    for (size_t i = 0; i < max_probe_; ++i) {
+        size_t slot = (home + i) & mask_;
+        if (tags_[slot] == 0) {
+            // Entries are contiguous from their home slot: the flow is new
+            tags_[slot] = tag;
+            entries_[slot] = Entry{FlowKey::from_packet(packet), 1, packet.size, now, now};
+            count_++;
+            misses_++;
+            return;
+        }
+        Entry& entry = entries_[slot];
+        if (tags_[slot] == tag && entry.key == FlowKey::from_packet(packet)) {
+            if (entry.packets > 0 && now >= entry.first_ns && now - entry.first_ns >= active_timeout_ns_) {
+                export_entry(entry, FlowExportReason::ACTIVE_TIMEOUT);
+                active_timeouts_++;
+                entry.packets = 0;
+                entry.bytes = 0;
+            }
+            if (entry.packets == 0) {
+                entry.first_ns = now;
+            }
+            entry.packets++;
+            entry.bytes += packet.size;
+            entry.last_ns = std::max(entry.last_ns, now);
+            hits_++;
+            return;
+        }
+        if (entry.last_ns < oldest) {
+            oldest = entry.last_ns;
+            victim = slot;
+        }
+    }
+
+    // Every slot the flow may use is taken: it replaces the stalest
+    export_entry(entries_[victim], FlowExportReason::EVICTED);
+    evictions_++;
+    tags_[victim] = tag;
+    entries_[victim] = Entry{FlowKey::from_packet(packet), 1, packet.size, now, now};
+    misses_++;
+}
+
+void FlowCache::export_entry(const Entry& entry, FlowExportReason reason) {
+    // A flow's active timeout may have just reported everything it had
+    if (entry.packets == 0) {
+        return;
+    }
+    if (reason == FlowExportReason::FLUSHED) {
+        flushed_++;
+    }
+    if (on_export_) {
+        on_export_(FlowRecord{entry.key, entry.packets, entry.bytes, entry.first_ns, entry.last_ns, reason});
+    }
+    records_exported_++;
+}
+
+void FlowCache::remove(size_t slot) {
+    tags_[slot] = 0;
+    count_--;
+    size_t hole = slot;
+    for (size_t next = (slot + 1) & mask_; tags_[next] != 0 && next != slot; next = (next + 1) & mask_) {
+        size_t home = hash_flow_key(entries_[next].key) & mask_;
+        // Moves back when the hole lies between its home slot and where it is
+        if (((next - home) & mask_) >= ((next - hole) & mask_)) {
+            tags_[hole] = tags_[next];
+            entries_[hole] = entries_[next];
+            tags_[next] = 0;
+            hole = next;
+        }
+    }
+}
+
+void FlowCache::sweep(uint64_t now_ns, size_t count) {
+    count = std::min(count, entries_.size());
+    for (size_t checked = 0; checked < count;) {
+        size_t slot = sweep_cursor_;
+        if (tags_[slot] != 0) {
+            Entry& entry = entries_[slot];
+            if (now_ns >= entry.last_ns && now_ns - entry.last_ns >= idle_timeout_ns_) {
+                export_entry(entry, FlowExportReason::IDLE_TIMEOUT);
+                idle_timeouts_++;
+                // An entry may have shifted into the slot: look at it again
+                remove(slot);
+                continue;
+            }
+            if (entry.packets > 0 && now_ns >= entry.first_ns && now_ns - entry.first_ns >= active_timeout_ns_) {
+                export_entry(entry, FlowExportReason::ACTIVE_TIMEOUT);
+                active_timeouts_++;
+                entry.packets = 0;
+                entry.bytes = 0;
+            }
+        }
+        sweep_cursor_ = (slot + 1) & mask_;
+        checked++;
+    }
+}
+
+void FlowCache::expire(uint64_t now_ns) {
+    sweep(now_ns, entries_.size());
+}
+
+void FlowCache::flush() {
+    for (size_t slot = 0; slot < entries_.size(); ++slot) {
+        if (tags_[slot] != 0) {
+            export_entry(entries_[slot], FlowExportReason::FLUSHED);
+            tags_[slot] = 0;
+        }
+    }
+    count_ = 0;
+}
+
+FlowCache::Statistics FlowCache::get_statistics() const {
+    Statistics stats{};
+    stats.packets = packets_;
+    stats.bytes = bytes_;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    stats.active_timeouts = active_timeouts_;
+    stats.idle_timeouts = idle_timeouts_;
+    stats.flushed = flushed_;
+    stats.records_exported = records_exported_;
+    stats.flows_active = count_;
+    stats.capacity = entries_.size();
+    stats.hit_rate = packets_ ? double(hits_) / packets_ : 0.0;
+    stats.eviction_rate = misses_ ? double(evictions_) / misses_ : 0.0;
+    stats.ns_per_packet = burst_packets_ ? double(burst_ns_) / burst_packets_ : 0.0;
+    return stats;
+}
+
+void FlowCache::reset_statistics() {
+    packets_ = 0;
+    bytes_ = 0;
+    hits_ = 0;
+    misses_ = 0;
+    evictions_ = 0;
+    active_timeouts_ = 0;
+    idle_timeouts_ = 0;
+    flushed_ = 0;
+    records_exported_ = 0;
+    burst_packets_ = 0;
+    burst_ns_ = 0;
+}
+
+PacketFlow to_packet_flow(const FlowRecord& record, const std::string& router_id) {
+    PacketFlow flow;
+    flow.timestamp = static_cast<uint64_t>((static_cast<int64_t>(record.first_ns) + wall_clock_offset_ns()) /
+                                           static_cast<int64_t>(NS_PER_MS));
+    flow.src_ip = format_ip_address(record.key.src_addr);
+    flow.dst_ip = format_ip_address(record.key.dst_addr);
+    flow.src_port = record.key.src_port;
+    flow.dst_port = record.key.dst_port;
+    flow.protocol = record.key.protocol;
+    flow.bytes = record.bytes;
+    flow.packets = record.packets;
+    flow.duration_ms = (record.last_ns - record.first_ns) / NS_PER_MS;
+    flow.router_id = router_id;
+    return flow;
+}
+
+} // namespace RouterSim
@@ -0,0 +1,153 @@
+#include "analytics/metric_rollup.h"
+#include <algorithm>
+#include <cmath>
+
+namespace RouterSim {
+
+MetricRollupAggregator::MetricRollupAggregator(const MetricRollupOptions& options, EmitCallback on_emit)
+    : options_(options), on_emit_(std::move(on_emit)), closed_before_(0), samples_(0), flow_samples_(0),
+      late_samples_(0), rollups_emitted_(0) {
+    options_.window_ms = std::max<uint32_t>(options_.window_ms, 1);
+}
+
+MetricRollupAggregator::Series* MetricRollupAggregator::series_for(const std::string& router_id,
+                                                                   const std::string& interface,
+                                                                   const std::string& metric_type,
+                                                                   uint64_t timestamp) {
+    uint64_t window = timestamp - timestamp % options_.window_ms;
+    if (window < closed_before_) {
+        late_samples_++;
+        return nullptr;
+    }
+
+    key_.assign(router_id);
+    key_.push_back('\0');
+    key_ += interface;
+    key_.push_back('\0');
+    key_ += metric_type;
+    auto found = series_.find(key_);
+    if (found == series_.end()) {
+        found = series_.emplace(key_, Series(options_.relative_accuracy)).first;
+        found->second.router_id = router_id;
+        found->second.interface = interface;
+        found->second.metric_type = metric_type;
+    }
+
+    Series& series = found->second;
+    if (window < series.open_from || (series.count > 0 && window < series.window_start)) {
+        late_samples_++;
+        return nullptr;
+    }
+    if (series.count > 0 && window > series.window_start) {
+        emit(series);
+    }
+    if (series.count == 0) {
+        series.window_start = window;
+    }
+    return &series;
+}
+
+void MetricRollupAggregator::add(const NetworkMetric& metric) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    samples_++;
+    Series* series = series_for(metric.router_id, metric.interface, metric.metric_type, metric.timestamp);
+    if (!series) {
+        return;
+    }
+    if (series->count == 0) {
+        series->min = metric.value;
+        series->max = metric.value;
+    } else {
+        series->min = std::min(series->min, metric.value);
+        series->max = std::max(series->max, metric.value);
+    }
+    series->count++;
+    series->sum += metric.value;
+    series->sketch.add(metric.value);
+}
+
+void MetricRollupAggregator::add_flow(const std::string& router_id, const std::string& interface,
+                                      uint64_t timestamp, uint64_t flow_hash) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flow_samples_++;
+    Series* series = series_for(router_id, interface, UNIQUE_FLOWS, timestamp);
+    if (!series) {
+        return;
+    }
+    if (!series->flows) {
+        series->flows = std::make_unique<HyperLogLog>(options_.flow_precision);
+    }
+    series->count++;
+    series->flows->add(flow_hash);
+}
+
+void MetricRollupAggregator::emit(Series& series) {
+    row_.timestamp = series.window_start;
+    row_.window_ms = options_.window_ms;
+    row_.router_id = series.router_id;
+    row_.interface = series.interface;
+    row_.metric_type = series.metric_type;
+    row_.count = series.count;
+    row_.sum = series.sum;
+    row_.min = series.min;
+    row_.max = series.max;
+    // Bucket midpoints can fall just outside what was seen
+    auto quantile = [&series](double q) {
+        return series.sketch.empty() ? 0.0 : std::min(std::max(series.sketch.quantile(q), series.min), series.max);
+    };
+    row_.p50 = quantile(0.50);
+    row_.p90 = quantile(0.90);
+    row_.p99 = quantile(0.99);
+    row_.p999 = quantile(0.999);
+    row_.unique_flows = series.flows ? static_cast<uint64_t>(std::llround(series.flows->estimate())) : 0;
+    row_.quantile_sketch.clear();
+    if (!series.sketch.empty()) {
+        series.sketch.serialize(row_.quantile_sketch);
+    }
+    if (on_emit_) {
+        on_emit_(row_);
+    }
+    rollups_emitted_++;
+
+    series.open_from = series.window_start + options_.window_ms;
+    series.count = 0;
+    series.sum = 0.0;
+    series.min = 0.0;
+    series.max = 0.0;
+    series.sketch.clear();
+    if (series.flows) {
+        series.flows->clear();
+    }
+}
+
+void MetricRollupAggregator::advance(uint64_t now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_before_ = std::max(closed_before_, now - now % options_.window_ms);
+    for (auto it = series_.begin(); it != series_.end();) {
+        Series& series = it->second;
+        if (series.count == 0) {
+            it = series_.erase(it);
+            continue;
+        }
+        if (series.window_start + options_.window_ms <= now) {
+            emit(series);
+        }
+        ++it;
+    }
+}
+
+void MetricRollupAggregator::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : series_) {
+        if (entry.second.count > 0) {
+            emit(entry.second);
+        }
+    }
+}
+
+MetricRollupAggregator::Statistics MetricRollupAggregator::get_statistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return Statistics{samples_, flow_samples_, late_samples_, rollups_emitted_, series_.size()};
+}
+
+} // namespace RouterSim
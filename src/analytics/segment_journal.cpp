@@ -0,0 +1,529 @@
+#include "analytics/segment_journal.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef ROUTERSIM_HAVE_LZ4
+#include <lz4.h>
+#endif
+#ifdef ROUTERSIM_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace RouterSim {
+
+namespace {
+
+// Segment and record headers are in host byte order: the journal is local state
+const uint32_t SEGMENT_MAGIC = 0x314a5352;         // "RSJ1"
+const uint32_t RECORD_MAGIC = 0x31434552;          // "REC1"
+const uint32_t FORMAT_VERSION = 1;
+const size_t PAGE_SIZE = 4096;
+const size_t RECORD_ALIGNMENT = 8;
+
+// Segment header fields
+const size_t SEGMENT_SEQUENCE = 8;
+const size_t SEGMENT_SIZE = 16;
+const size_t SEGMENT_REPLAYED = 24;
+
+// Record header fields
+const size_t RECORD_CODEC = 4;
+const size_t RECORD_STORED = 8;
+const size_t RECORD_RAW = 12;
+const size_t RECORD_TAG = 16;
+const size_t RECORD_ROWS = 20;
+const size_t RECORD_CRC = 24;
+
+std::array<uint32_t, 256> make_crc_table() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = crc & 1 ? (crc >> 1) ^ 0xedb88320 : crc >> 1;
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+const std::array<uint32_t, 256> CRC_TABLE = make_crc_table();
+
+uint32_t crc32(uint32_t crc, const uint8_t* data, size_t length) {
+    crc = ~crc;
+    for (size_t i = 0; i < length; ++i) {
+        crc = CRC_TABLE[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+uint32_t load32(const uint8_t* in) {
+    uint32_t value;
+    std::memcpy(&value, in, sizeof(value));
+    return value;
+}
+
+uint64_t load64(const uint8_t* in) {
+    uint64_t value;
+    std::memcpy(&value, in, sizeof(value));
+    return value;
+}
+
+void store32(uint8_t* out, uint32_t value) {
+    std::memcpy(out, &value, sizeof(value));
+}
+
+void store64(uint8_t* out, uint64_t value) {
+    std::memcpy(out, &value, sizeof(value));
+}
+
+size_t padded(size_t length) {
+    return (length + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+}
+
+// Checksum over the header fields after the magic and the stored payload
+uint32_t record_crc(const uint8_t* record, size_t stored) {
+    uint32_t crc = crc32(0, record + RECORD_CODEC, RECORD_CRC - RECORD_CODEC);
+    return crc32(crc, record + 32, stored);
+}
+
+// Compressed size in out, or 0 when the codec is unavailable or does not help
+size_t compress(JournalCompression codec, int level, const uint8_t* data, size_t length,
+                std::vector<uint8_t>& out) {
+    // Unused when no codec is built in
+    (void)level;
+    (void)data;
+    (void)length;
+    (void)out;
+    switch (codec) {
+#ifdef ROUTERSIM_HAVE_LZ4
+    case JournalCompression::LZ4: {
+        out.resize(static_cast<size_t>(LZ4_compressBound(static_cast<int>(length))));
+        int stored = LZ4_compress_default(reinterpret_cast<const char*>(data), reinterpret_cast<char*>(out.data()),
+                                          static_cast<int>(length), static_cast<int>(out.size()));
+        return stored > 0 && size_t(stored) < length ? size_t(stored) : 0;
+    }
+#endif
+#ifdef ROUTERSIM_HAVE_ZSTD
+    case JournalCompression::ZSTD: {
+        out.resize(ZSTD_compressBound(length));
+        size_t stored = ZSTD_compress(out.data(), out.size(), data, length, level);
+        return !ZSTD_isError(stored) && stored < length ? stored : 0;
+    }
+#endif
+    default:
+        return 0;
+    }
+}
+
+bool decompress(JournalCompression codec, const uint8_t* data, size_t stored, uint8_t* out, size_t raw) {
+    switch (codec) {
+    case JournalCompression::NONE:
+        if (stored != raw) {
+            return false;
+        }
+        std::memcpy(out, data, raw);
+        return true;
+#ifdef ROUTERSIM_HAVE_LZ4
+    case JournalCompression::LZ4:
+        return LZ4_decompress_safe(reinterpret_cast<const char*>(data), reinterpret_cast<char*>(out),
+                                   static_cast<int>(stored), static_cast<int>(raw)) == static_cast<int>(raw);
+#endif
+#ifdef ROUTERSIM_HAVE_ZSTD
+    case JournalCompression::ZSTD:
+        return ZSTD_decompress(out, raw, data, stored) == raw;
+#endif
+    default:
+        return false;
+    }
+}
+
+std::string segment_path(const std::string& directory, uint64_t sequence) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "/segment-%020" PRIu64 ".journal", sequence);
+    return directory + name;
+}
+
+} // namespace
+
+SegmentJournal::SegmentJournal()
+    : read_segment_(0), read_offset_(HEADER_SIZE), next_sequence_(1), records_written_(0), records_rejected_(0),
+      records_replayed_(0), read_records_(0), read_rows_(0), rows_pending_(0), bytes_written_(0), bytes_stored_(0) {
+}
+
+SegmentJournal::~SegmentJournal() {
+    close();
+}
+
+bool SegmentJournal::supports(JournalCompression compression) {
+    switch (compression) {
+    case JournalCompression::NONE:
+        return true;
+    case JournalCompression::LZ4:
+#ifdef ROUTERSIM_HAVE_LZ4
+        return true;
+#else
+        return false;
+#endif
+    case JournalCompression::ZSTD:
+#ifdef ROUTERSIM_HAVE_ZSTD
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+bool SegmentJournal::open(const std::string& directory, const SegmentJournalOptions& options) {
+    close();
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (::mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::cerr << "Failed to create journal directory " << directory << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    DIR* dir = ::opendir(directory.c_str());
+    if (!dir) {
+        std::cerr << "Failed to open journal directory " << directory << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    std::vector<uint64_t> sequences;
+    while (dirent* entry = ::readdir(dir)) {
+        uint64_t sequence;
+        char tail;
+        if (std::sscanf(entry->d_name, "segment-%" SCNu64 ".journa%c", &sequence, &tail) == 2 && tail == 'l') {
+            sequences.push_back(sequence);
+        }
+    }
+    ::closedir(dir);
+    std::sort(sequences.begin(), sequences.end());
+
+    directory_ = directory;
+    options_ = options;
+    options_.segment_bytes = (std::max(options.segment_bytes, 2 * PAGE_SIZE) + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+    options_.max_bytes = std::max(options.max_bytes, options_.segment_bytes);
+    if (!supports(options_.compression)) {
+        options_.compression = JournalCompression::NONE;
+    }
+    rows_pending_ = 0;
+
+    for (uint64_t sequence : sequences) {
+        Segment segment;
+        if (!map_segment(segment_path(directory_, sequence), sequence, false, segment)) {
+            continue;
+        }
+        if (!recover_segment(segment)) {
+            unmap_segment(segment, false);
+            continue;
+        }
+        // Fully replayed ones are only kept while they are being appended to
+        if (replayed_offset(segment) >= segment.write_offset && sequence != sequences.back()) {
+            unmap_segment(segment, true);
+            continue;
+        }
+        segments_.push_back(segment);
+    }
+    next_sequence_ = sequences.empty() ? 1 : sequences.back() + 1;
+
+    read_segment_ = 0;
+    read_offset_ = segments_.empty() ? HEADER_SIZE : replayed_offset(segments_.front());
+    read_records_ = 0;
+    read_rows_ = 0;
+    return true;
+}
+
+void SegmentJournal::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& segment : segments_) {
+        unmap_segment(segment, false);
+    }
+    segments_.clear();
+    directory_.clear();
+}
+
+bool SegmentJournal::is_open() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !directory_.empty();
+}
+
+bool SegmentJournal::map_segment(const std::string& path, uint64_t sequence, bool create, Segment& segment) {
+    int fd = ::open(path.c_str(), O_RDWR | (create ? O_CREAT | O_EXCL : 0), 0644);
+    if (fd < 0) {
+        std::cerr << "Failed to open journal segment " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    size_t size = options_.segment_bytes;
+    struct stat info;
+    if (create ? ::ftruncate(fd, static_cast<off_t>(size)) != 0 : ::fstat(fd, &info) != 0) {
+        std::cerr << "Failed to size journal segment " << path << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+    if (!create) {
+        size = static_cast<size_t>(info.st_size);
+        if (size < HEADER_SIZE) {
+            ::close(fd);
+            return false;
+        }
+    }
+    void* map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        std::cerr << "Failed to map journal segment " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    segment.sequence = sequence;
+    segment.path = path;
+    segment.map = static_cast<uint8_t*>(map);
+    segment.size = size;
+    segment.write_offset = HEADER_SIZE;
+    if (create) {
+        store32(segment.map, SEGMENT_MAGIC);
+        store32(segment.map + 4, FORMAT_VERSION);
+        store64(segment.map + SEGMENT_SEQUENCE, sequence);
+        store64(segment.map + SEGMENT_SIZE, size);
+        store64(segment.map + SEGMENT_REPLAYED, HEADER_SIZE);
+    }
+    return true;
+}
+
+bool SegmentJournal::recover_segment(Segment& segment) {
+    if (load32(segment.map) != SEGMENT_MAGIC || load32(segment.map + 4) != FORMAT_VERSION ||
+        load64(segment.map + SEGMENT_SEQUENCE) != segment.sequence) {
+        std::cerr << "Ignoring journal segment " << segment.path << ": bad header" << std::endl;
+        return false;
+    }
+
+    uint64_t replayed = replayed_offset(segment);
+    size_t offset = HEADER_SIZE;
+    size_t length;
+    uint32_t rows;
+    while (parse_record(segment, offset, length, &rows)) {
+        if (offset >= replayed) {
+            rows_pending_ += rows;
+        }
+        offset += length;
+    }
+    segment.write_offset = offset;
+    // Whatever follows the last good record must not parse after the next append
+    uint8_t* tail = segment.map + offset;
+    size_t tail_length = segment.size - offset;
+    if (std::find_if(tail, tail + tail_length, [](uint8_t byte) { return byte != 0; }) != tail + tail_length) {
+        std::memset(tail, 0, tail_length);
+    }
+    // A torn tail may have been replayed past; never read beyond the good records
+    if (replayed < HEADER_SIZE || replayed > offset) {
+        replayed_offset(segment) = std::min<uint64_t>(std::max<uint64_t>(replayed, HEADER_SIZE), offset);
+    }
+    return true;
+}
+
+void SegmentJournal::unmap_segment(Segment& segment, bool remove) {
+    if (segment.map) {
+        ::munmap(segment.map, segment.size);
+        segment.map = nullptr;
+    }
+    if (remove) {
+        ::unlink(segment.path.c_str());
+    }
+}
+
+uint64_t& SegmentJournal::replayed_offset(Segment& segment) {
+    return *reinterpret_cast<uint64_t*>(segment.map + SEGMENT_REPLAYED);
+}
+
+bool SegmentJournal::parse_record(const Segment& segment, size_t offset, size_t& length, uint32_t* rows) const {
+    if (offset + RECORD_HEADER_SIZE > segment.size) {
+        return false;
+    }
+    const uint8_t* record = segment.map + offset;
+    if (load32(record) != RECORD_MAGIC) {
+        return false;
+    }
+    size_t stored = load32(record + RECORD_STORED);
+    length = RECORD_HEADER_SIZE + padded(stored);
+    if (length > segment.size - offset || load32(record + RECORD_CRC) != record_crc(record, stored)) {
+        return false;
+    }
+    if (rows) {
+        *rows = load32(record + RECORD_ROWS);
+    }
+    return true;
+}
+
+bool SegmentJournal::create_segment() {
+    // A last segment that is fully replayed was only kept to be appended to
+    if (segments_.size() == 1 && replayed_offset(segments_.front()) >= segments_.front().write_offset) {
+        unmap_segment(segments_.front(), true);
+        segments_.pop_front();
+        read_segment_ = 0;
+        read_offset_ = HEADER_SIZE;
+    }
+    if ((segments_.size() + 1) * options_.segment_bytes > options_.max_bytes) {
+        return false;
+    }
+    if (!segments_.empty()) {
+        Segment& sealed = segments_.back();
+        ::msync(sealed.map, sealed.size, MS_ASYNC);
+    }
+    Segment segment;
+    if (!map_segment(segment_path(directory_, next_sequence_), next_sequence_, true, segment)) {
+        return false;
+    }
+    next_sequence_++;
+    segments_.push_back(segment);
+    return true;
+}
+
+bool SegmentJournal::append(uint32_t tag, uint32_t rows, const void* data, size_t length) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (directory_.empty()) {
+        return false;
+    }
+
+    const uint8_t* payload = static_cast<const uint8_t*>(data);
+    JournalCompression codec = JournalCompression::NONE;
+    size_t stored = length;
+    size_t compressed = compress(options_.compression, options_.zstd_level, payload, length, scratch_);
+    if (compressed > 0) {
+        codec = options_.compression;
+        payload = scratch_.data();
+        stored = compressed;
+    }
+
+    size_t needed = RECORD_HEADER_SIZE + padded(stored);
+    if (needed > options_.segment_bytes - HEADER_SIZE || length > UINT32_MAX) {
+        records_rejected_++;
+        return false;
+    }
+    if (segments_.empty() || segments_.back().write_offset + needed > segments_.back().size) {
+        if (!create_segment()) {
+            records_rejected_++;
+            return false;
+        }
+    }
+
+    Segment& segment = segments_.back();
+    uint8_t* record = segment.map + segment.write_offset;
+    store32(record + RECORD_CODEC, static_cast<uint32_t>(codec));
+    store32(record + RECORD_STORED, static_cast<uint32_t>(stored));
+    store32(record + RECORD_RAW, static_cast<uint32_t>(length));
+    store32(record + RECORD_TAG, tag);
+    store32(record + RECORD_ROWS, rows);
+    store32(record + 28, 0);
+    std::memcpy(record + RECORD_HEADER_SIZE, payload, stored);
+    std::memset(record + RECORD_HEADER_SIZE + stored, 0, padded(stored) - stored);
+    store32(record + RECORD_CRC, record_crc(record, stored));
+    // The magic goes last, so a torn record never parses
+    store32(record, RECORD_MAGIC);
+    segment.write_offset += needed;
+
+    records_written_++;
+    rows_pending_ += rows;
+    bytes_written_ += length;
+    bytes_stored_ += needed;
+    return true;
+}
+
+bool SegmentJournal::read(Record& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (read_segment_ < segments_.size()) {
+        Segment& segment = segments_[read_segment_];
+        size_t length;
+        if (read_offset_ < segment.write_offset && parse_record(segment, read_offset_, length)) {
+            const uint8_t* header = segment.map + read_offset_;
+            size_t raw = load32(header + RECORD_RAW);
+            record.tag = load32(header + RECORD_TAG);
+            record.rows = load32(header + RECORD_ROWS);
+            record.data.resize(raw);
+            read_offset_ += length;
+            read_records_++;
+            read_rows_ += record.rows;
+            if (!decompress(static_cast<JournalCompression>(load32(header + RECORD_CODEC)),
+                            header + RECORD_HEADER_SIZE, load32(header + RECORD_STORED), record.data.data(), raw)) {
+                std::cerr << "Skipping undecodable journal record in " << segment.path << std::endl;
+                continue;
+            }
+            return true;
+        }
+        if (read_segment_ + 1 >= segments_.size()) {
+            break;
+        }
+        read_segment_++;
+        read_offset_ = replayed_offset(segments_[read_segment_]);
+    }
+    return false;
+}
+
+void SegmentJournal::commit() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (segments_.empty()) {
+        return;
+    }
+
+    // Segments behind the cursor are done, and so is the cursor's own once read to the end
+    size_t done = read_segment_;
+    if (read_segment_ + 1 < segments_.size() && read_offset_ >= segments_[read_segment_].write_offset) {
+        done++;
+    }
+    for (size_t i = 0; i < done; ++i) {
+        unmap_segment(segments_.front(), true);
+        segments_.pop_front();
+    }
+    if (done > read_segment_) {
+        read_offset_ = replayed_offset(segments_.front());
+    } else {
+        replayed_offset(segments_.front()) = read_offset_;
+    }
+    read_segment_ = 0;
+
+    records_replayed_ += read_records_;
+    rows_pending_ -= std::min(rows_pending_, read_rows_);
+    read_records_ = 0;
+    read_rows_ = 0;
+}
+
+void SegmentJournal::rewind() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    read_segment_ = 0;
+    read_offset_ = segments_.empty() ? HEADER_SIZE : replayed_offset(segments_.front());
+    read_records_ = 0;
+    read_rows_ = 0;
+}
+
+bool SegmentJournal::has_pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (segments_.empty()) {
+        return false;
+    }
+    const Segment& front = segments_.front();
+    return segments_.size() > 1 || load64(front.map + SEGMENT_REPLAYED) < front.write_offset;
+}
+
+SegmentJournal::Statistics SegmentJournal::get_statistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Statistics stats{};
+    stats.records_written = records_written_;
+    stats.records_rejected = records_rejected_;
+    stats.records_replayed = records_replayed_;
+    stats.rows_pending = rows_pending_;
+    stats.bytes_written = bytes_written_;
+    stats.bytes_stored = bytes_stored_;
+    for (const auto& segment : segments_) {
+        stats.bytes_on_disk += segment.size;
+    }
+    stats.segments = segments_.size();
+    return stats;
+}
+
+} // namespace RouterSim
@@ -0,0 +1,263 @@
+#include "analytics/sketches.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace RouterSim {
+
+namespace {
+
+const uint8_t SKETCH_FORMAT_VERSION = 1;
+const uint8_t MIN_PRECISION = 4;
+const uint8_t MAX_PRECISION = 18;
+
+void put_varint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool get_varint(const uint8_t*& data, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && data < end; shift += 7) {
+        uint8_t byte = *data++;
+        value |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+} // namespace
+
+void DDSketch::Store::add(int32_t index, uint64_t count, size_t max_buckets) {
+    total += count;
+    if (counts.empty()) {
+        offset = index;
+        counts.push_back(count);
+        return;
+    }
+
+    int64_t low = std::min<int64_t>(offset, index);
+    int64_t high = std::max<int64_t>(offset + static_cast<int64_t>(counts.size()) - 1, index);
+    if (low == offset && high == offset + static_cast<int64_t>(counts.size()) - 1) {
+        counts[index - offset] += count;
+        return;
+    }
+
+    // Grow to cover index; past max_buckets the lowest buckets fold into one
+    low = std::max<int64_t>(low, high - static_cast<int64_t>(max_buckets) + 1);
+    std::vector<uint64_t> grown(static_cast<size_t>(high - low + 1), 0);
+    for (size_t i = 0; i < counts.size(); ++i) {
+        int64_t at = std::max<int64_t>(offset + static_cast<int64_t>(i), low);
+        grown[static_cast<size_t>(at - low)] += counts[i];
+    }
+    grown[static_cast<size_t>(std::max<int64_t>(index, low) - low)] += count;
+    counts.swap(grown);
+    offset = static_cast<int32_t>(low);
+}
+
+void DDSketch::Store::clear() {
+    counts.clear();
+    offset = 0;
+    total = 0;
+}
+
+DDSketch::DDSketch(double relative_accuracy, size_t max_buckets)
+    : max_buckets_(std::max<size_t>(max_buckets, 1)), zero_count_(0) {
+    set_accuracy(relative_accuracy);
+}
+
+void DDSketch::set_accuracy(double relative_accuracy) {
+    relative_accuracy_ = std::min(std::max(relative_accuracy, 1e-6), 0.5);
+    gamma_ = (1 + relative_accuracy_) / (1 - relative_accuracy_);
+    log_gamma_ = std::log(gamma_);
+    // Smallest magnitude whose index stays well inside int32
+    min_indexable_ = std::max(std::numeric_limits<double>::min() * gamma_,
+                              std::exp((std::numeric_limits<int32_t>::min() + 1) * log_gamma_));
+}
+
+int32_t DDSketch::index(double magnitude) const {
+    return static_cast<int32_t>(std::ceil(std::log(magnitude) / log_gamma_));
+}
+
+double DDSketch::value(int32_t index) const {
+    // Middle of the bucket in relative terms: within relative_accuracy of both ends
+    return 2 * std::exp(index * log_gamma_) / (gamma_ + 1);
+}
+
+void DDSketch::add(double value, uint64_t count) {
+    if (count == 0 || std::isnan(value)) {
+        return;
+    }
+    if (value >= min_indexable_) {
+        positive_.add(index(std::min(value, std::numeric_limits<double>::max())), count, max_buckets_);
+    } else if (value <= -min_indexable_) {
+        negative_.add(index(std::min(-value, std::numeric_limits<double>::max())), count, max_buckets_);
+    } else {
+        zero_count_ += count;
+    }
+}
+
+bool DDSketch::merge(const DDSketch& other) {
+    if (other.relative_accuracy_ != relative_accuracy_) {
+        return false;
+    }
+    for (size_t i = 0; i < other.positive_.counts.size(); ++i) {
+        if (other.positive_.counts[i]) {
+            positive_.add(other.positive_.offset + static_cast<int32_t>(i), other.positive_.counts[i], max_buckets_);
+        }
+    }
+    for (size_t i = 0; i < other.negative_.counts.size(); ++i) {
+        if (other.negative_.counts[i]) {
+            negative_.add(other.negative_.offset + static_cast<int32_t>(i), other.negative_.counts[i], max_buckets_);
+        }
+    }
+    zero_count_ += other.zero_count_;
+    return true;
+}
+
+double DDSketch::quantile(double q) const {
+    uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+    double rank = std::min(std::max(q, 0.0), 1.0) * double(total - 1);
+
+    // Ascending: most negative first, then zeros, then positives
+    uint64_t seen = 0;
+    for (size_t i = negative_.counts.size(); i-- > 0;) {
+        seen += negative_.counts[i];
+        if (double(seen) > rank) {
+            return -value(negative_.offset + static_cast<int32_t>(i));
+        }
+    }
+    seen += zero_count_;
+    if (double(seen) > rank) {
+        return 0;
+    }
+    for (size_t i = 0; i < positive_.counts.size(); ++i) {
+        seen += positive_.counts[i];
+        if (double(seen) > rank) {
+            return value(positive_.offset + static_cast<int32_t>(i));
+        }
+    }
+    return positive_.counts.empty() ? 0 : value(positive_.offset + static_cast<int32_t>(positive_.counts.size()) - 1);
+}
+
+void DDSketch::clear() {
+    positive_.clear();
+    negative_.clear();
+    zero_count_ = 0;
+}
+
+void DDSketch::serialize(std::string& out) const {
+    out.push_back(static_cast<char>(SKETCH_FORMAT_VERSION));
+    out.append(reinterpret_cast<const char*>(&relative_accuracy_), sizeof(relative_accuracy_));
+    put_varint(out, zero_count_);
+    for (const Store* store : {&positive_, &negative_}) {
+        put_varint(out, zigzag(store->offset));
+        put_varint(out, store->counts.size());
+        for (uint64_t count : store->counts) {
+            put_varint(out, count);
+        }
+    }
+}
+
+bool DDSketch::deserialize(const void* data, size_t length) {
+    const uint8_t* in = static_cast<const uint8_t*>(data);
+    const uint8_t* end = in + length;
+    double relative_accuracy;
+    if (length < 1 + sizeof(relative_accuracy) || in[0] != SKETCH_FORMAT_VERSION) {
+        return false;
+    }
+    std::memcpy(&relative_accuracy, in + 1, sizeof(relative_accuracy));
+    in += 1 + sizeof(relative_accuracy);
+
+    DDSketch sketch(relative_accuracy, max_buckets_);
+    uint64_t value;
+    if (!get_varint(in, end, sketch.zero_count_)) {
+        return false;
+    }
+    for (Store* store : {&sketch.positive_, &sketch.negative_}) {
+        uint64_t size;
+        if (!get_varint(in, end, value) || !get_varint(in, end, size) || size > uint64_t(end - in)) {
+            return false;
+        }
+        int64_t offset = unzigzag(value);
+        for (uint64_t i = 0; i < size; ++i) {
+            if (!get_varint(in, end, value)) {
+                return false;
+            }
+            if (value) {
+                store->add(static_cast<int32_t>(offset + static_cast<int64_t>(i)), value, max_buckets_);
+            }
+        }
+    }
+    if (in != end) {
+        return false;
+    }
+    *this = std::move(sketch);
+    return true;
+}
+
+HyperLogLog::HyperLogLog(uint8_t precision)
+    : precision_(std::min(std::max(precision, MIN_PRECISION), MAX_PRECISION)),
+      registers_(size_t(1) << precision_, 0) {
+}
+
+void HyperLogLog::add(uint64_t hash) {
+    size_t index = static_cast<size_t>(hash >> (64 - precision_));
+    // Leading zeros of the remaining bits; the sentinel bit caps the rank
+    uint64_t rest = (hash << precision_) | (uint64_t(1) << (precision_ - 1));
+    uint8_t rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+    registers_[index] = std::max(registers_[index], rank);
+}
+
+bool HyperLogLog::merge(const HyperLogLog& other) {
+    if (other.precision_ != precision_) {
+        return false;
+    }
+    for (size_t i = 0; i < registers_.size(); ++i) {
+        registers_[i] = std::max(registers_[i], other.registers_[i]);
+    }
+    return true;
+}
+
+double HyperLogLog::estimate() const {
+    double m = double(registers_.size());
+    double sum = 0;
+    size_t zeros = 0;
+    for (uint8_t rank : registers_) {
+        sum += std::ldexp(1.0, -rank);
+        zeros += rank == 0;
+    }
+    double alpha = registers_.size() == 16 ? 0.673
+                 : registers_.size() == 32 ? 0.697
+                 : registers_.size() == 64 ? 0.709
+                 : 0.7213 / (1 + 1.079 / m);
+    double estimate = alpha * m * m / sum;
+    // 64-bit hashes need no large range correction
+    if (estimate <= 2.5 * m && zeros > 0) {
+        return m * std::log(m / double(zeros));
+    }
+    return estimate;
+}
+
+void HyperLogLog::clear() {
+    std::fill(registers_.begin(), registers_.end(), 0);
+}
+
+} // namespace RouterSim
@@ -2,6 +2,7 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 #include <yaml-cpp/yaml.h>
 
 namespace RouterSim {
@@ -170,6 +171,38 @@ std::vector<NetemConfig> YAMLConfig::get_netem_configs() const {
     return netem_configs_;
 }
 
+bool YAMLConfig::apply_traffic_shaping(TrafficShapingManager& manager, const std::string& interface_name) const {
+    const TrafficShapingConfig& config = traffic_shaping_config_;
+    std::map<std::string, std::string> parameters;
+    
+    switch (config.algorithm) {
+        case ShapingAlgorithm::TOKEN_BUCKET:
+            parameters["capacity"] = std::to_string(config.token_bucket_config.capacity);
+            parameters["rate"] = std::to_string(config.token_bucket_config.rate);
+            parameters["burst_size"] = std::to_string(config.token_bucket_config.burst_size);
+            break;
+        case ShapingAlgorithm::DEFICIT_ROUND_ROBIN:
+            parameters["quantum"] = std::to_string(config.drr_config.quantum);
+            parameters["sparse_flow_priority"] = config.drr_config.sparse_flow_priority ? "true" : "false";
+            // DRR takes its class weights from wfq_classes too
+            [[fallthrough]];
+        case ShapingAlgorithm::WEIGHTED_FAIR_QUEUE:
+            for (const auto& wfq_class : config.wfq_classes) {
+                parameters["weight_" + std::to_string(wfq_class.class_id)] = std::to_string(wfq_class.weight);
+            }
+            break;
+        case ShapingAlgorithm::HIERARCHICAL_TOKEN_BUCKET:
+            if (!manager.configure_htb(interface_name, config.htb_classes, config.htb_charge_batch_bytes)) {
+                return false;
+            }
+            break;
+        case ShapingAlgorithm::RATE_LIMITING:
+            break;
+    }
+    
+    return manager.configure_interface(interface_name, config.algorithm, parameters);
+}
+
 void YAMLConfig::parse_router_config(const YAML::Node& node) {
     if (node["hostname"]) {
         router_config_.hostname = node["hostname"].as<std::string>();
@@ -258,10 +291,12 @@ void YAMLConfig::parse_traffic_shaping_config(const YAML::Node& node) {
             traffic_shaping_config_.algorithm = ShapingAlgorithm::TOKEN_BUCKET;
         } else if (algo == "weighted_fair_queue") {
             traffic_shaping_config_.algorithm = ShapingAlgorithm::WEIGHTED_FAIR_QUEUE;
-        } else if (algo == "priority_queue") {
-            traffic_shaping_config_.algorithm = ShapingAlgorithm::PRIORITY_QUEUE;
         } else if (algo == "rate_limiting") {
             traffic_shaping_config_.algorithm = ShapingAlgorithm::RATE_LIMITING;
+        } else if (algo == "deficit_round_robin" || algo == "drr") {
+            traffic_shaping_config_.algorithm = ShapingAlgorithm::DEFICIT_ROUND_ROBIN;
+        } else if (algo == "hierarchical_token_bucket" || algo == "htb") {
+            traffic_shaping_config_.algorithm = ShapingAlgorithm::HIERARCHICAL_TOKEN_BUCKET;
         }
     }
     
@@ -307,6 +342,70 @@ void YAMLConfig::parse_traffic_shaping_config(const YAML::Node& node) {
             traffic_shaping_config_.wfq_classes.push_back(wfq_class);
         }
     }
+    
+    // DRR uses wfq_classes for its classes; weight scales the quantum
+    if (node["drr"]) {
+        const YAML::Node& drr = node["drr"];
+        if (drr["quantum"]) {
+            traffic_shaping_config_.drr_config.quantum = drr["quantum"].as<uint32_t>();
+        }
+        if (drr["sparse_flow_priority"]) {
+            traffic_shaping_config_.drr_config.sparse_flow_priority = drr["sparse_flow_priority"].as<bool>();
+        }
+    }
+    
+    // HTB tree: nested classes, flattened parents-first into htb_classes
+    if (node["htb"]) {
+        const YAML::Node& htb = node["htb"];
+        if (htb["charge_batch_bytes"]) {
+            traffic_shaping_config_.htb_charge_batch_bytes = htb["charge_batch_bytes"].as<uint32_t>();
+        }
+        if (htb["classes"]) {
+            uint32_t next_class_id = 1;
+            for (const auto& class_node : htb["classes"]) {
+                parse_htb_class(class_node, 0, next_class_id);
+            }
+        }
+    }
+}
+
+void YAMLConfig::parse_htb_class(const YAML::Node& node, uint32_t parent_id, uint32_t& next_class_id) {
+    HTBClassConfig htb_class;
+    htb_class.parent_id = parent_id;
+    
+    // Classes without an explicit id are numbered in document order
+    if (node["class_id"]) {
+        htb_class.class_id = node["class_id"].as<uint32_t>();
+        next_class_id = std::max(next_class_id, htb_class.class_id + 1);
+    } else {
+        htb_class.class_id = next_class_id++;
+    }
+    if (node["name"]) {
+        htb_class.name = node["name"].as<std::string>();
+    }
+    if (node["rate"]) {
+        htb_class.rate = node["rate"].as<uint64_t>();
+    }
+    if (node["ceil"]) {
+        htb_class.ceil = node["ceil"].as<uint64_t>();
+    }
+    if (node["burst"]) {
+        htb_class.burst = node["burst"].as<uint32_t>();
+    }
+    if (node["cburst"]) {
+        htb_class.cburst = node["cburst"].as<uint32_t>();
+    }
+    if (node["quantum"]) {
+        htb_class.quantum = node["quantum"].as<uint32_t>();
+    }
+    
+    traffic_shaping_config_.htb_classes.push_back(htb_class);
+    
+    if (node["children"]) {
+        for (const auto& child : node["children"]) {
+            parse_htb_class(child, htb_class.class_id, next_class_id);
+        }
+    }
 }
 
 void YAMLConfig::parse_netem_config(const YAML::Node& node) {
@@ -446,7 +545,7 @@ void YAMLConfig::parse_scenarios_config(const YAML::Node& node) {
             scenario.netem_configs = netem_configs_;
         }
         
-        scenarios_[scenario_name] = scenario;
+        scenarios_[scenario_name] = std::move(scenario);
     }
 }
 
@@ -504,12 +603,15 @@ YAML::Node YAMLConfig::serialize_traffic_shaping_config() const {
         case ShapingAlgorithm::WEIGHTED_FAIR_QUEUE:
             algo = "weighted_fair_queue";
             break;
-        case ShapingAlgorithm::PRIORITY_QUEUE:
-            algo = "priority_queue";
-            break;
         case ShapingAlgorithm::RATE_LIMITING:
             algo = "rate_limiting";
             break;
+        case ShapingAlgorithm::DEFICIT_ROUND_ROBIN:
+            algo = "deficit_round_robin";
+            break;
+        case ShapingAlgorithm::HIERARCHICAL_TOKEN_BUCKET:
+            algo = "hierarchical_token_bucket";
+            break;
     }
     node["algorithm"] = algo;
     
@@ -533,6 +635,46 @@ YAML::Node YAMLConfig::serialize_traffic_shaping_config() const {
     }
     node["wfq_classes"] = wfq_classes;
     
+    YAML::Node drr;
+    drr["quantum"] = traffic_shaping_config_.drr_config.quantum;
+    drr["sparse_flow_priority"] = traffic_shaping_config_.drr_config.sparse_flow_priority;
+    node["drr"] = drr;
+    
+    YAML::Node htb;
+    htb["charge_batch_bytes"] = traffic_shaping_config_.htb_charge_batch_bytes;
+    YAML::Node htb_classes;
+    for (const auto& htb_class : traffic_shaping_config_.htb_classes) {
+        if (htb_class.parent_id == 0) {
+            htb_classes.push_back(serialize_htb_class(htb_class.class_id));
+        }
+    }
+    htb["classes"] = htb_classes;
+    node["htb"] = htb;
+    
+    return node;
+}
+
+YAML::Node YAMLConfig::serialize_htb_class(uint32_t class_id) const {
+    YAML::Node node;
+    YAML::Node children;
+    
+    for (const auto& htb_class : traffic_shaping_config_.htb_classes) {
+        if (htb_class.class_id == class_id) {
+            node["class_id"] = htb_class.class_id;
+            node["name"] = htb_class.name;
+            node["rate"] = htb_class.rate;
+            node["ceil"] = htb_class.ceil;
+            node["burst"] = htb_class.burst;
+            node["cburst"] = htb_class.cburst;
+            node["quantum"] = htb_class.quantum;
+        } else if (htb_class.parent_id == class_id) {
+            children.push_back(serialize_htb_class(htb_class.class_id));
+        }
+    }
+    if (children.size() > 0) {
+        node["children"] = children;
+    }
+    
     return node;
 }
 
@@ -0,0 +1,226 @@
+#include "event_loop.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace RouterSim {
+
+namespace {
+
+uint64_t steady_now_ns() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+uint64_t pack(int fd, uint32_t generation) {
+    return (static_cast<uint64_t>(generation) << 32) | static_cast<uint32_t>(fd);
+}
+
+} // namespace
+
+EventLoop::EventLoop(uint64_t timer_resolution_ns)
+    : epoll_fd_(-1), wake_fd_(-1), stop_requested_(false), loop_thread_(std::this_thread::get_id()),
+      next_generation_(1), timers_(timer_resolution_ns, steady_now_ns()), wakeups_(0), io_events_(0),
+      timers_fired_(0), tasks_run_(0) {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        std::cerr << "Failed to create epoll instance: " << strerror(errno) << std::endl;
+        return;
+    }
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = pack(wake_fd_, 0);
+    if (wake_fd_ < 0 || epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event) < 0) {
+        std::cerr << "Failed to create event loop wakeup descriptor: " << strerror(errno) << std::endl;
+        if (wake_fd_ >= 0) {
+            close(wake_fd_);
+            wake_fd_ = -1;
+        }
+        close(epoll_fd_);
+        epoll_fd_ = -1;
+    }
+}
+
+EventLoop::~EventLoop() {
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+    }
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+    }
+}
+
+bool EventLoop::add(int fd, uint32_t events, IoCallback callback) {
+    if (epoll_fd_ < 0 || fd < 0 || handlers_.count(fd)) {
+        return false;
+    }
+    uint32_t generation = next_generation_++;
+    if (next_generation_ == 0) {
+        next_generation_ = 1;
+    }
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = pack(fd, generation);
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+        std::cerr << "Failed to watch descriptor " << fd << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    handlers_[fd] = std::make_shared<Handler>(Handler{generation, std::move(callback)});
+    return true;
+}
+
+bool EventLoop::modify(int fd, uint32_t events) {
+    auto found = handlers_.find(fd);
+    if (found == handlers_.end()) {
+        return false;
+    }
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = pack(fd, found->second->generation);
+    return epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event) == 0;
+}
+
+bool EventLoop::remove(int fd) {
+    auto found = handlers_.find(fd);
+    if (found == handlers_.end()) {
+        return false;
+    }
+    handlers_.erase(found);
+    // Fails harmlessly when the descriptor was already closed
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    return true;
+}
+
+EventLoop::TimerId EventLoop::schedule(uint64_t delay_ns, TimerCallback callback) {
+    TimerId id = timers_.schedule(steady_now_ns() + delay_ns, 0);
+    timer_callbacks_[id] = std::move(callback);
+    return id;
+}
+
+bool EventLoop::cancel(TimerId id) {
+    if (!timers_.cancel(id)) {
+        return false;
+    }
+    timer_callbacks_.erase(id);
+    return true;
+}
+
+void EventLoop::post(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    uint64_t one = 1;
+    ssize_t written = write(wake_fd_, &one, sizeof(one));
+    (void)written;
+}
+
+void EventLoop::run() {
+    loop_thread_ = std::this_thread::get_id();
+    while (!stop_requested_.load()) {
+        run_once();
+    }
+    stop_requested_.store(false);
+}
+
+void EventLoop::stop() {
+    stop_requested_.store(true);
+    uint64_t one = 1;
+    ssize_t written = write(wake_fd_, &one, sizeof(one));
+    (void)written;
+}
+
+int EventLoop::wait_timeout_ms(int timeout_ms) const {
+    uint64_t next = timers_.next_expiry_ns();
+    if (next == TimerWheel::NO_EXPIRY) {
+        return timeout_ms;
+    }
+    uint64_t now = steady_now_ns();
+    // Rounded up: waking before the timer's tick would only wait again
+    uint64_t wait_ms = next > now ? (next - now + 999999) / 1000000 : 0;
+    if (timeout_ms >= 0) {
+        wait_ms = std::min<uint64_t>(wait_ms, static_cast<uint64_t>(timeout_ms));
+    }
+    return static_cast<int>(std::min<uint64_t>(wait_ms, INT32_MAX));
+}
+
+void EventLoop::run_once(int timeout_ms) {
+    if (epoll_fd_ < 0) {
+        return;
+    }
+    epoll_event events[MAX_EVENTS];
+    int count = epoll_wait(epoll_fd_, events, MAX_EVENTS, wait_timeout_ms(timeout_ms));
+    if (count < 0 && errno != EINTR) {
+        std::cerr << "epoll_wait failed: " << strerror(errno) << std::endl;
+        return;
+    }
+    wakeups_++;
+
+    for (int i = 0; i < count; ++i) {
+        int fd = static_cast<int>(events[i].data.u64 & 0xffffffffu);
+        uint32_t generation = static_cast<uint32_t>(events[i].data.u64 >> 32);
+        if (fd == wake_fd_ && generation == 0) {
+            uint64_t value;
+            ssize_t drained = read(wake_fd_, &value, sizeof(value));
+            (void)drained;
+            continue;
+        }
+        auto found = handlers_.find(fd);
+        if (found == handlers_.end() || found->second->generation != generation) {
+            // Removed, or its number reused, by an earlier callback in this batch
+            continue;
+        }
+        // Held so the handler survives its own remove()
+        std::shared_ptr<Handler> handler = found->second;
+        io_events_++;
+        handler->callback(events[i].events);
+    }
+
+    run_timers();
+    run_tasks();
+}
+
+void EventLoop::run_timers() {
+    timers_.advance(steady_now_ns(), [this](TimerId id, uint64_t) {
+        auto found = timer_callbacks_.find(id);
+        if (found == timer_callbacks_.end()) {
+            return;
+        }
+        TimerCallback callback = std::move(found->second);
+        timer_callbacks_.erase(found);
+        timers_fired_++;
+        callback();
+    });
+}
+
+void EventLoop::run_tasks() {
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex_);
+        if (tasks_.empty()) {
+            return;
+        }
+        running_tasks_.swap(tasks_);
+    }
+    for (auto& task : running_tasks_) {
+        tasks_run_++;
+        task();
+    }
+    running_tasks_.clear();
+}
+
+uint64_t EventLoop::now_ns() const {
+    return steady_now_ns();
+}
+
+EventLoop::Statistics EventLoop::get_statistics() const {
+    return Statistics{wakeups_.load(), io_events_.load(), timers_fired_.load(), tasks_run_.load()};
+}
+
+} // namespace RouterSim
@@ -0,0 +1,448 @@
+#include "netem/emulator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace RouterSim {
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// Pareto with shape 3 has mean 1.5 and standard deviation sqrt(0.75)
+const double PARETO_SHAPE = 3.0;
+const double PARETO_MEAN = 1.5;
+const double PARETO_STDDEV = 0.8660254037844386;
+
+uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// FNV-1a, stable across platforms unlike std::hash
+uint64_t hash_name(const std::string& name) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (unsigned char c : name) {
+        hash = (hash ^ c) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+} // namespace
+
+NetemEmulator::NetemEmulator(uint64_t seed) : seed_(seed), sequence_(0), queued_(0) {
+}
+
+NetemEmulator::~NetemEmulator() = default;
+
+uint32_t NetemEmulator::add_link(const std::string& name, const ImpairmentInfo& impairments, size_t limit) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (link_ids_.count(name)) {
+        return INVALID_LINK;
+    }
+
+    uint32_t link_id;
+    if (!free_links_.empty()) {
+        link_id = free_links_.back();
+        free_links_.pop_back();
+    } else {
+        link_id = static_cast<uint32_t>(links_.size());
+        links_.emplace_back();
+    }
+
+    // Keep the generation so packets of a removed link stay stale
+    uint32_t generation = links_[link_id].generation;
+    links_[link_id] = Link();
+    Link& link = links_[link_id];
+    link.name = name;
+    link.impairments = impairments;
+    link.limit = limit;
+    link.active = true;
+    link.generation = generation;
+    seed_link(link);
+
+    link_ids_[name] = link_id;
+    return link_id;
+}
+
+bool NetemEmulator::configure_link(uint32_t link_id, const ImpairmentInfo& impairments) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!is_active(link_id)) {
+        return false;
+    }
+
+    Link& link = links_[link_id];
+    if (!impairments.has_loss || !link.impairments.has_loss ||
+        impairments.loss.loss_type != link.impairments.loss.loss_type) {
+        link.loss_state = LossState::GOOD;
+    }
+    if (!impairments.has_rate_limit) {
+        link.rate_tat_ns = 0;
+    }
+    link.impairments = impairments;
+    return true;
+}
+
+bool NetemEmulator::remove_link(uint32_t link_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!is_active(link_id)) {
+        return false;
+    }
+
+    // Queued packets are discarded lazily when they reach the queue head
+    Link& link = links_[link_id];
+    queued_ -= link.queued;
+    link.queued = 0;
+    link.active = false;
+    link.generation++;
+    link_ids_.erase(link.name);
+    free_links_.push_back(link_id);
+    return true;
+}
+
+uint32_t NetemEmulator::find_link(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = link_ids_.find(name);
+    return it != link_ids_.end() ? it->second : INVALID_LINK;
+}
+
+size_t NetemEmulator::link_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return link_ids_.size();
+}
+
+void NetemEmulator::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    links_.clear();
+    free_links_.clear();
+    link_ids_.clear();
+    pending_.clear();
+    free_slots_.clear();
+    release_queue_ = decltype(release_queue_)();
+    queued_ = 0;
+}
+
+bool NetemEmulator::enqueue(uint32_t link_id, const PacketInfo& packet, uint64_t now_ns) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!is_active(link_id)) {
+        return false;
+    }
+
+    links_[link_id].packets_in++;
+    return enqueue_copy(link_id, packet, now_ns, false);
+}
+
+size_t NetemEmulator::release(uint64_t now_ns, std::vector<EmulatedPacket>& released, size_t max_packets) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    size_t count = 0;
+    while (count < max_packets && !release_queue_.empty() && release_queue_.top().release_ns <= now_ns) {
+        ReleaseEntry entry = release_queue_.top();
+        release_queue_.pop();
+
+        Pending& pending = pending_[entry.slot];
+        free_slots_.push_back(entry.slot);
+
+        Link& link = links_[pending.link_id];
+        if (!link.active || link.generation != pending.link_generation) {
+            continue;
+        }
+
+        link.queued--;
+        queued_--;
+        link.packets_out++;
+        link.bytes_out += pending.packet.size;
+        released.push_back({std::move(pending.packet), entry.release_ns, pending.link_id,
+                            pending.duplicate, pending.corrupted});
+        count++;
+    }
+
+    return count;
+}
+
+uint64_t NetemEmulator::next_release_ns() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Entries of removed links may still sit in the heap; an early wake is harmless
+    return queued_ == 0 ? 0 : release_queue_.top().release_ns;
+}
+
+size_t NetemEmulator::queue_size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queued_;
+}
+
+NetemLinkStatistics NetemEmulator::get_link_statistics(uint32_t link_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    NetemLinkStatistics stats{};
+    if (!is_active(link_id)) {
+        return stats;
+    }
+
+    const Link& link = links_[link_id];
+    stats.name = link.name;
+    stats.packets_in = link.packets_in;
+    stats.packets_out = link.packets_out;
+    stats.bytes_out = link.bytes_out;
+    stats.dropped_loss = link.dropped_loss;
+    stats.dropped_limit = link.dropped_limit;
+    stats.duplicated = link.duplicated;
+    stats.corrupted = link.corrupted;
+    stats.reordered = link.reordered;
+    stats.queue_length = link.queued;
+    return stats;
+}
+
+void NetemEmulator::reset_statistics() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& link : links_) {
+        link.packets_in = 0;
+        link.packets_out = 0;
+        link.bytes_out = 0;
+        link.dropped_loss = 0;
+        link.dropped_limit = 0;
+        link.duplicated = 0;
+        link.corrupted = 0;
+        link.reordered = 0;
+    }
+}
+
+bool NetemEmulator::is_active(uint32_t link_id) const {
+    return link_id < links_.size() && links_[link_id].active;
+}
+
+void NetemEmulator::seed_link(Link& link) const {
+    uint64_t state = seed_ ^ hash_name(link.name);
+    for (auto& word : link.rng_state) {
+        word = splitmix64(state);
+    }
+}
+
+// One pass of netem_enqueue(); duplicates re-enter with duplication off
+bool NetemEmulator::enqueue_copy(uint32_t link_id, const PacketInfo& packet, uint64_t now_ns, bool duplicate) {
+    Link& link = links_[link_id];
+    const ImpairmentInfo& info = link.impairments;
+
+    int count = 1;
+    if (!duplicate && info.has_duplicate && chance(link.rng_state, info.duplicate.duplicate_percentage)) {
+        count++;
+    }
+    if (info.has_loss && is_lost(link)) {
+        count--;
+    }
+    if (count == 0) {
+        link.dropped_loss++;
+        return false;
+    }
+    if (count > 1) {
+        link.duplicated++;
+        enqueue_copy(link_id, packet, now_ns, true);
+    }
+
+    bool corrupted = info.has_corrupt && chance(link.rng_state, info.corrupt.corrupt_percentage);
+    if (corrupted) {
+        link.corrupted++;
+    }
+
+    if (link.queued >= link.limit) {
+        link.dropped_limit++;
+        return false;
+    }
+
+    // Reordering as netem: with gap G, after G-1 delayed packets the next
+    // one is sent immediately with the configured probability
+    uint32_t gap = 0;
+    double reorder_percentage = 0.0;
+    if (info.has_reorder) {
+        if (info.reorder.reorder_type == ReorderType::GAP) {
+            gap = info.reorder.gap;
+            reorder_percentage = info.reorder.reorder_percentage > 0.0 ? info.reorder.reorder_percentage : 100.0;
+        } else {
+            gap = 1;
+            reorder_percentage = info.reorder.reorder_percentage;
+        }
+    }
+
+    uint64_t release_ns;
+    if (gap == 0 || link.reorder_counter + 1 < gap || !chance(link.rng_state, reorder_percentage)) {
+        release_ns = now_ns + sample_delay_ns(link);
+        if (info.has_rate_limit && info.rate_limit.rate_kbps > 0) {
+            release_ns = rate_departure_ns(link, packet.size, release_ns);
+        }
+        link.reorder_counter++;
+    } else {
+        release_ns = now_ns;
+        link.reorder_counter = 0;
+        link.reordered++;
+    }
+
+    uint32_t slot;
+    if (!free_slots_.empty()) {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+        pending_[slot] = {packet, link_id, link.generation, duplicate, corrupted};
+    } else {
+        slot = static_cast<uint32_t>(pending_.size());
+        pending_.push_back({packet, link_id, link.generation, duplicate, corrupted});
+    }
+
+    release_queue_.push({release_ns, sequence_++, slot});
+    link.queued++;
+    queued_++;
+    return true;
+}
+
+bool NetemEmulator::is_lost(Link& link) {
+    const LossConfig& loss = link.impairments.loss;
+    uint64_t* rng = link.rng_state;
+
+    switch (loss.loss_type) {
+        case LossType::RANDOM:
+            return chance(rng, loss.loss_percentage);
+
+        case LossType::STATE: {
+            // netem loss_4state(): states 1-4 of the Salsano et al. model
+            double rnd = uniform(rng) * 100.0;
+            switch (link.loss_state) {
+                case LossState::GOOD:
+                    if (rnd < loss.p14) {
+                        link.loss_state = LossState::LOST_IN_GAP;
+                        return true;
+                    }
+                    if (rnd < loss.p14 + loss.p13) {
+                        link.loss_state = LossState::LOST_IN_BURST;
+                        return true;
+                    }
+                    return false;
+                case LossState::BAD:
+                    if (rnd < loss.p23) {
+                        link.loss_state = LossState::LOST_IN_BURST;
+                        return true;
+                    }
+                    return false;
+                case LossState::LOST_IN_BURST:
+                    if (rnd < loss.p32) {
+                        link.loss_state = LossState::BAD;
+                        return false;
+                    }
+                    if (rnd < loss.p32 + loss.p31) {
+                        link.loss_state = LossState::GOOD;
+                        return false;
+                    }
+                    return true;
+                case LossState::LOST_IN_GAP:
+                    link.loss_state = LossState::GOOD;
+                    return false;
+            }
+            return false;
+        }
+
+        case LossType::GEMODEL:
+            // netem loss_gilb_ell(): the state a packet arrives in decides its fate
+            if (link.loss_state == LossState::BAD) {
+                if (chance(rng, loss.r)) {
+                    link.loss_state = LossState::GOOD;
+                }
+                return !chance(rng, loss.h);
+            }
+            if (chance(rng, loss.p)) {
+                link.loss_state = LossState::BAD;
+            }
+            return !chance(rng, loss.k);
+    }
+
+    return false;
+}
+
+uint64_t NetemEmulator::sample_delay_ns(Link& link) {
+    const ImpairmentInfo& info = link.impairments;
+    if (!info.has_delay) {
+        return 0;
+    }
+
+    double mu = info.delay.delay_ms * 1e6;
+    double sigma = info.delay.jitter_ms * 1e6;
+    if (sigma == 0.0) {
+        return static_cast<uint64_t>(mu);
+    }
+
+    double offset;
+    switch (info.delay.distribution) {
+        case DelayDistribution::NORMAL:
+            offset = standard_normal(link.rng_state);
+            break;
+        case DelayDistribution::PARETO:
+            offset = standard_pareto(link.rng_state);
+            break;
+        case DelayDistribution::PARETONORMAL:
+            offset = 0.25 * standard_normal(link.rng_state) + 0.75 * standard_pareto(link.rng_state);
+            break;
+        case DelayDistribution::UNIFORM:
+        default:
+            offset = 2.0 * uniform(link.rng_state) - 1.0;
+            break;
+    }
+
+    double delay = mu + sigma * offset;
+    return delay > 0.0 ? static_cast<uint64_t>(delay) : 0;
+}
+
+// GCRA with a burst allowance: back-to-back packets within burst_kb leave
+// at once, later ones at the configured rate. Without a burst every packet
+// waits for its own serialisation, as netem's rate option does.
+uint64_t NetemEmulator::rate_departure_ns(Link& link, uint32_t size, uint64_t now_ns) {
+    const RateLimitConfig& rate = link.impairments.rate_limit;
+    uint64_t transmit_ns = static_cast<uint64_t>(size) * 8 * 1000000 / rate.rate_kbps;
+    uint64_t burst_ns = static_cast<uint64_t>(rate.burst_kb) * 1000000000 / rate.rate_kbps;
+
+    link.rate_tat_ns = std::max(link.rate_tat_ns, now_ns) + transmit_ns;
+    return link.rate_tat_ns > now_ns + burst_ns ? link.rate_tat_ns - burst_ns : now_ns;
+}
+
+uint64_t NetemEmulator::next_random(uint64_t state[4]) {
+    uint64_t result = rotl(state[1] * 5, 7) * 9;
+    uint64_t t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotl(state[3], 45);
+    return result;
+}
+
+double NetemEmulator::uniform(uint64_t state[4]) {
+    return (next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+bool NetemEmulator::chance(uint64_t state[4], double percentage) {
+    if (percentage <= 0.0) {
+        return false;
+    }
+    if (percentage >= 100.0) {
+        return true;
+    }
+    return uniform(state) * 100.0 < percentage;
+}
+
+double NetemEmulator::standard_normal(uint64_t state[4]) {
+    double u1 = 1.0 - uniform(state);
+    double u2 = uniform(state);
+    return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * PI * u2);
+}
+
+double NetemEmulator::standard_pareto(uint64_t state[4]) {
+    double u = 1.0 - uniform(state);
+    return (std::pow(u, -1.0 / PARETO_SHAPE) - PARETO_MEAN) / PARETO_STDDEV;
+}
+
+} // namespace RouterSim
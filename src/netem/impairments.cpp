@@ -1,16 +1,21 @@
 #include "netem/impairments.h"
+#include "netem/emulator.h"
+#include "netem/netlink.h"
 #include <iostream>
-#include <sstream>
-#include <cstdlib>
-#include <chrono>
-#include <random>
-#include <algorithm>
+#include <net/if.h>
 
 namespace RouterSim {
 
-NetemImpairments::NetemImpairments() : initialized_(false), running_(false) {
-    // Initialize random number generator
-    rng_.seed(std::chrono::steady_clock::now().time_since_epoch().count());
+NetemImpairments::NetemImpairments() : NetemImpairments(NetemEmulator::DEFAULT_SEED) {
+}
+
+NetemImpairments::NetemImpairments(uint64_t seed)
+    : initialized_(false), running_(false), emulator_(std::make_unique<NetemEmulator>(seed)), batching_(false) {
+}
+
+NetemImpairments::NetemImpairments(std::unique_ptr<NetlinkSocket> kernel_socket)
+    : initialized_(false), running_(false), emulator_(std::make_unique<NetemEmulator>()),
+      kernel_(std::make_unique<NetemNetlinkBackend>(std::move(kernel_socket))), batching_(false) {
 }
 
 NetemImpairments::~NetemImpairments() {
@@ -22,10 +27,8 @@ bool NetemImpairments::initialize() {
         return true;
     }
 
-    // Check if tc/netem is available
-    int result = std::system("which tc > /dev/null 2>&1");
-    if (result != 0) {
-        std::cerr << "tc (traffic control) not found. Please install iproute2 package." << std::endl;
+    if (kernel_ && !kernel_->refresh_interfaces()) {
+        std::cerr << "Failed to list interfaces over rtnetlink" << std::endl;
         return false;
     }
 
@@ -72,26 +75,16 @@ bool NetemImpairments::add_delay(const std::string& interface, const DelayConfig
         return false;
     }
 
-    std::ostringstream cmd;
-    cmd << "tc qdisc add dev " << interface << " root netem delay " 
-        << config.delay_ms << "ms";
-    
-    if (config.jitter_ms > 0) {
-        cmd << " " << config.jitter_ms << "ms";
-    }
-    
-    if (config.distribution != DelayDistribution::UNIFORM) {
-        cmd << " distribution " << get_distribution_string(config.distribution);
-    }
-
-    int result = std::system(cmd.str().c_str());
-    if (result == 0) {
-        active_impairments_[interface].delay = config;
-        std::cout << "Added delay impairment to interface " << interface << std::endl;
-        return true;
+    ImpairmentInfo info = get_interface_impairments(interface);
+    info.delay = config;
+    info.has_delay = true;
+    if (!apply_impairments(interface, info)) {
+        return false;
     }
 
-    return false;
+    std::cout << "Added delay impairment to interface " << interface << " ("
+              << get_distribution_string(config.distribution) << ")" << std::endl;
+    return true;
 }
 
 bool NetemImpairments::add_loss(const std::string& interface, const LossConfig& config) {
@@ -99,27 +92,15 @@ bool NetemImpairments::add_loss(const std::string& interface, const LossConfig&
         return false;
     }
 
-    std::ostringstream cmd;
-    cmd << "tc qdisc add dev " << interface << " root netem loss ";
-    
-    if (config.loss_type == LossType::RANDOM) {
-        cmd << config.loss_percentage << "%";
-    } else if (config.loss_type == LossType::STATE) {
-        cmd << "state " << config.p13 << "% " << config.p31 << "% " 
-            << config.p32 << "% " << config.p23 << "% " << config.p14 << "%";
-    } else if (config.loss_type == LossType::GEMODEL) {
-        cmd << "gemodel " << config.p << " " << config.r << " " 
-            << config.h << " " << config.k << " " << config.1_minus_h;
-    }
-
-    int result = std::system(cmd.str().c_str());
-    if (result == 0) {
-        active_impairments_[interface].loss = config;
-        std::cout << "Added loss impairment to interface " << interface << std::endl;
-        return true;
+    ImpairmentInfo info = get_interface_impairments(interface);
+    info.loss = config;
+    info.has_loss = true;
+    if (!apply_impairments(interface, info)) {
+        return false;
     }
 
-    return false;
+    std::cout << "Added loss impairment to interface " << interface << std::endl;
+    return true;
 }
 
 bool NetemImpairments::add_duplicate(const std::string& interface, const DuplicateConfig& config) {
@@ -127,18 +108,15 @@ bool NetemImpairments::add_duplicate(const std::string& interface, const Duplica
         return false;
     }
 
-    std::ostringstream cmd;
-    cmd << "tc qdisc add dev " << interface << " root netem duplicate " 
-        << config.duplicate_percentage << "%";
-
-    int result = std::system(cmd.str().c_str());
-    if (result == 0) {
-        active_impairments_[interface].duplicate = config;
-        std::cout << "Added duplicate impairment to interface " << interface << std::endl;
-        return true;
+    ImpairmentInfo info = get_interface_impairments(interface);
+    info.duplicate = config;
+    info.has_duplicate = true;
+    if (!apply_impairments(interface, info)) {
+        return false;
     }
 
-    return false;
+    std::cout << "Added duplicate impairment to interface " << interface << std::endl;
+    return true;
 }
 
 bool NetemImpairments::add_corrupt(const std::string& interface, const CorruptConfig& config) {
@@ -146,18 +124,15 @@ bool NetemImpairments::add_corrupt(const std::string& interface, const CorruptCo
         return false;
     }
 
-    std::ostringstream cmd;
-    cmd << "tc qdisc add dev " << interface << " root netem corrupt " 
-        << config.corrupt_percentage << "%";
-
-    int result = std::system(cmd.str().c_str());
-    if (result == 0) {
-        active_impairments_[interface].corrupt = config;
-        std::cout << "Added corrupt impairment to interface " << interface << std::endl;
-        return true;
+    ImpairmentInfo info = get_interface_impairments(interface);
+    info.corrupt = config;
+    info.has_corrupt = true;
+    if (!apply_impairments(interface, info)) {
+        return false;
     }
 
-    return false;
+    std::cout << "Added corrupt impairment to interface " << interface << std::endl;
+    return true;
 }
 
 bool NetemImpairments::add_reorder(const std::string& interface, const ReorderConfig& config) {
@@ -165,23 +140,15 @@ bool NetemImpairments::add_reorder(const std::string& interface, const ReorderCo
         return false;
     }
 
-    std::ostringstream cmd;
-    cmd << "tc qdisc add dev " << interface << " root netem reorder ";
-    
-    if (config.reorder_type == ReorderType::PERCENTAGE) {
-        cmd << config.reorder_percentage << "%";
-    } else if (config.reorder_type == ReorderType::GAP) {
-        cmd << "gap " << config.gap;
-    }
-
-    int result = std::system(cmd.str().c_str());
-    if (result == 0) {
-        active_impairments_[interface].reorder = config;
-        std::cout << "Added reorder impairment to interface " << interface << std::endl;
-        return true;
+    ImpairmentInfo info = get_interface_impairments(interface);
+    info.reorder = config;
+    info.has_reorder = true;
+    if (!apply_impairments(interface, info)) {
+        return false;
     }
 
-    return false;
+    std::cout << "Added reorder impairment to interface " << interface << std::endl;
+    return true;
 }
 
 bool NetemImpairments::add_rate_limit(const std::string& interface, const RateLimitConfig& config) {
@@ -189,18 +156,20 @@ bool NetemImpairments::add_rate_limit(const std::string& interface, const RateLi
         return false;
     }
 
-    std::ostringstream cmd;
-    cmd << "tc qdisc add dev " << interface << " root tbf rate " 
-        << config.rate_kbps << "kbit burst " << config.burst_kb << "kbit";
+    if (config.rate_kbps == 0) {
+        std::cerr << "Rate limit for interface " << interface << " must be non-zero" << std::endl;
+        return false;
+    }
 
-    int result = std::system(cmd.str().c_str());
-    if (result == 0) {
-        active_impairments_[interface].rate_limit = config;
-        std::cout << "Added rate limit impairment to interface " << interface << std::endl;
-        return true;
+    ImpairmentInfo info = get_interface_impairments(interface);
+    info.rate_limit = config;
+    info.has_rate_limit = true;
+    if (!apply_impairments(interface, info)) {
+        return false;
     }
 
-    return false;
+    std::cout << "Added rate limit impairment to interface " << interface << std::endl;
+    return true;
 }
 
 bool NetemImpairments::remove_impairment(const std::string& interface) {
@@ -208,17 +177,22 @@ bool NetemImpairments::remove_impairment(const std::string& interface) {
         return false;
     }
 
-    std::ostringstream cmd;
-    cmd << "tc qdisc del dev " << interface << " root";
-
-    int result = std::system(cmd.str().c_str());
-    if (result == 0) {
-        active_impairments_.erase(interface);
-        std::cout << "Removed impairments from interface " << interface << std::endl;
-        return true;
+    auto it = active_impairments_.find(interface);
+    if (it == active_impairments_.end()) {
+        return false;
     }
 
-    return false;
+    // Still tracked if the kernel refuses, so the removal can be retried
+    if (kernel_) {
+        if (!kernel_->remove(interface)) {
+            return false;
+        }
+    } else {
+        emulator_->remove_link(emulator_->find_link(interface));
+    }
+    active_impairments_.erase(it);
+    std::cout << "Removed impairments from interface " << interface << std::endl;
+    return true;
 }
 
 bool NetemImpairments::clear_all_impairments() {
@@ -226,14 +200,8 @@ bool NetemImpairments::clear_all_impairments() {
         return false;
     }
 
-    bool success = true;
-    for (const auto& [interface, _] : active_impairments_) {
-        if (!remove_impairment(interface)) {
-            success = false;
-        }
-    }
-
-    return success;
+    cleanup();
+    return true;
 }
 
 std::vector<std::string> NetemImpairments::get_impaired_interfaces() const {
@@ -252,6 +220,30 @@ ImpairmentInfo NetemImpairments::get_interface_impairments(const std::string& in
     return ImpairmentInfo{};
 }
 
+NetemLinkStatistics NetemImpairments::get_interface_statistics(const std::string& interface) const {
+    return emulator_->get_link_statistics(emulator_->find_link(interface));
+}
+
+bool NetemImpairments::read_kernel_qdiscs(std::vector<QdiscState>& qdiscs) {
+    return kernel_ && kernel_->dump_qdiscs(qdiscs);
+}
+
+bool NetemImpairments::process_packet(const std::string& interface, const PacketInfo& packet, uint64_t now_ns) {
+    uint32_t link = emulator_->find_link(interface);
+    if (link == NetemEmulator::INVALID_LINK) {
+        return false;
+    }
+    return emulator_->enqueue(link, packet, now_ns);
+}
+
+size_t NetemImpairments::release_packets(uint64_t now_ns, std::vector<EmulatedPacket>& released) {
+    return emulator_->release(now_ns, released);
+}
+
+uint64_t NetemImpairments::next_release_ns() const {
+    return emulator_->next_release_ns();
+}
+
 bool NetemImpairments::apply_scenario(const std::string& scenario_name) {
     // Predefined scenarios
     if (scenario_name == "high_latency") {
@@ -274,11 +266,12 @@ bool NetemImpairments::apply_high_latency_scenario() {
     delay_config.jitter_ms = 10;
     delay_config.distribution = DelayDistribution::NORMAL;
 
+    batching_ = true;
     for (const auto& interface : get_available_interfaces()) {
         add_delay(interface, delay_config);
     }
 
-    return true;
+    return commit_batch();
 }
 
 bool NetemImpairments::apply_packet_loss_scenario() {
@@ -287,15 +280,17 @@ bool NetemImpairments::apply_packet_loss_scenario() {
     loss_config.loss_type = LossType::RANDOM;
     loss_config.loss_percentage = 5.0;
 
+    batching_ = true;
     for (const auto& interface : get_available_interfaces()) {
         add_loss(interface, loss_config);
     }
 
-    return true;
+    return commit_batch();
 }
 
 bool NetemImpairments::apply_unreliable_network_scenario() {
     // Apply multiple impairments for unreliable network
+    batching_ = true;
     for (const auto& interface : get_available_interfaces()) {
         // Add delay
         DelayConfig delay_config;
@@ -315,7 +310,7 @@ bool NetemImpairments::apply_unreliable_network_scenario() {
         add_duplicate(interface, dup_config);
     }
 
-    return true;
+    return commit_batch();
 }
 
 bool NetemImpairments::apply_congested_network_scenario() {
@@ -324,47 +319,92 @@ bool NetemImpairments::apply_congested_network_scenario() {
     rate_config.rate_kbps = 1000; // 1 Mbps
     rate_config.burst_kb = 100;
 
+    batching_ = true;
     for (const auto& interface : get_available_interfaces()) {
         add_rate_limit(interface, rate_config);
     }
 
-    return true;
+    return commit_batch();
 }
 
 std::vector<std::string> NetemImpairments::get_available_interfaces() const {
     std::vector<std::string> interfaces;
-    
-    // Get list of network interfaces
-    std::ostringstream cmd;
-    cmd << "ip link show | grep -E '^[0-9]+:' | cut -d: -f2 | tr -d ' '";
-    
-    FILE* pipe = popen(cmd.str().c_str(), "r");
-    if (pipe) {
-        char buffer[128];
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
-            std::string interface(buffer);
-            interface.erase(interface.find_last_not_of(" \n\r\t") + 1);
-            if (!interface.empty() && interface != "lo") {
+
+    if (kernel_) {
+        for (const auto& interface : kernel_->get_interfaces()) {
+            if (interface != "lo") {
+                interfaces.push_back(interface);
+            }
+        }
+        return interfaces;
+    }
+
+    struct if_nameindex* names = if_nameindex();
+    if (names) {
+        for (struct if_nameindex* entry = names; entry->if_index != 0; ++entry) {
+            std::string interface(entry->if_name);
+            if (interface != "lo") {
                 interfaces.push_back(interface);
             }
         }
-        pclose(pipe);
+        if_freenameindex(names);
     }
 
     return interfaces;
 }
 
 void NetemImpairments::cleanup() {
-    // Remove all impairments
     for (const auto& [interface, _] : active_impairments_) {
-        std::ostringstream cmd;
-        cmd << "tc qdisc del dev " << interface << " root 2>/dev/null";
-        std::system(cmd.str().c_str());
+        if (kernel_) {
+            kernel_->queue_remove(interface);
+        } else {
+            emulator_->remove_link(emulator_->find_link(interface));
+        }
+    }
+    if (kernel_) {
+        kernel_->commit();
     }
     
     active_impairments_.clear();
 }
 
+bool NetemImpairments::apply_impairments(const std::string& interface, const ImpairmentInfo& info) {
+    if (kernel_) {
+        // Batched changes are recorded now and withdrawn if the commit fails
+        kernel_->queue_apply(interface, info);
+        if (!batching_ && !kernel_->commit()) {
+            return false;
+        }
+        active_impairments_[interface] = info;
+        return true;
+    }
+
+    uint32_t link = emulator_->find_link(interface);
+    bool applied = link == NetemEmulator::INVALID_LINK ? emulator_->add_link(interface, info) != NetemEmulator::INVALID_LINK
+                                                       : emulator_->configure_link(link, info);
+    if (!applied) {
+        std::cerr << "Failed to configure impairments on interface " << interface << std::endl;
+        return false;
+    }
+
+    active_impairments_[interface] = info;
+    return true;
+}
+
+bool NetemImpairments::commit_batch() {
+    batching_ = false;
+    if (!kernel_) {
+        return true;
+    }
+
+    std::vector<std::string> failed;
+    bool success = kernel_->commit(&failed);
+    for (const auto& interface : failed) {
+        active_impairments_.erase(interface);
+    }
+    return success;
+}
+
 std::string NetemImpairments::get_distribution_string(DelayDistribution distribution) const {
     switch (distribution) {
         case DelayDistribution::UNIFORM:
@@ -0,0 +1,785 @@
+#include "netem/netlink.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <linux/gen_stats.h>
+#include <linux/if_link.h>
+#include <linux/netlink.h>
+#include <linux/pkt_sched.h>
+#include <linux/rtnetlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace RouterSim {
+
+namespace {
+
+const size_t DIST_TABLE_SIZE = 4096;
+const int SOCKET_BUFFER_BYTES = 4 * 1024 * 1024;
+const uint64_t PSCHED_SHIFT = 6;            // legacy tc_netem_qopt times are 64 ns ticks
+
+// Appends netlink messages and attributes to a buffer, keeping 4-byte alignment
+class MessageWriter {
+public:
+    explicit MessageWriter(std::vector<uint8_t>& buffer) : buffer_(buffer), start_(buffer.size()) {}
+
+    void begin(uint16_t type, uint16_t flags, uint32_t sequence) {
+        start_ = buffer_.size();
+        nlmsghdr header{};
+        header.nlmsg_type = type;
+        header.nlmsg_flags = flags;
+        header.nlmsg_seq = sequence;
+        append(&header, sizeof(header));
+    }
+
+    void end() {
+        uint32_t length = static_cast<uint32_t>(buffer_.size() - start_);
+        std::memcpy(buffer_.data() + start_, &length, sizeof(length));
+    }
+
+    void append(const void* data, size_t length) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        buffer_.insert(buffer_.end(), bytes, bytes + length);
+        buffer_.resize(NLMSG_ALIGN(buffer_.size()), 0);
+    }
+
+    void attribute(uint16_t type, const void* data, size_t length) {
+        rtattr header{};
+        header.rta_type = type;
+        header.rta_len = static_cast<unsigned short>(RTA_LENGTH(length));
+        buffer_.insert(buffer_.end(), reinterpret_cast<const uint8_t*>(&header),
+                       reinterpret_cast<const uint8_t*>(&header) + sizeof(header));
+        append(data, length);
+    }
+
+    template <typename T>
+    void attribute(uint16_t type, const T& value) {
+        attribute(type, &value, sizeof(value));
+    }
+
+    void string_attribute(uint16_t type, const std::string& value) {
+        attribute(type, value.c_str(), value.size() + 1);
+    }
+
+    size_t begin_nested(uint16_t type) {
+        size_t offset = buffer_.size();
+        attribute(type, nullptr, 0);
+        return offset;
+    }
+
+    void end_nested(size_t offset) {
+        unsigned short length = static_cast<unsigned short>(buffer_.size() - offset);
+        std::memcpy(buffer_.data() + offset, &length, sizeof(length));
+    }
+
+private:
+    std::vector<uint8_t>& buffer_;
+    size_t start_;
+};
+
+using Attributes = std::map<uint16_t, std::pair<const uint8_t*, size_t>>;
+
+Attributes parse_attributes(const uint8_t* data, size_t length) {
+    Attributes attributes;
+    while (length >= sizeof(rtattr)) {
+        rtattr header;
+        std::memcpy(&header, data, sizeof(header));
+        if (header.rta_len < sizeof(rtattr) || header.rta_len > length) {
+            break;
+        }
+        attributes[header.rta_type & NLA_TYPE_MASK] = {data + RTA_LENGTH(0), header.rta_len - RTA_LENGTH(0)};
+        size_t step = RTA_ALIGN(header.rta_len);
+        if (step >= length) {
+            break;
+        }
+        data += step;
+        length -= step;
+    }
+    return attributes;
+}
+
+template <typename T>
+bool read_attribute(const Attributes& attributes, uint16_t type, T& value) {
+    auto it = attributes.find(type);
+    if (it == attributes.end() || it->second.second < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&value, it->second.first, sizeof(T));
+    return true;
+}
+
+std::string read_string(const Attributes& attributes, uint16_t type) {
+    auto it = attributes.find(type);
+    if (it == attributes.end()) {
+        return "";
+    }
+    const char* text = reinterpret_cast<const char*>(it->second.first);
+    return std::string(text, strnlen(text, it->second.second));
+}
+
+// Calls visit(header, payload, payload_length) for each message; stops when it returns false
+template <typename Visitor>
+void for_each_message(const std::vector<uint8_t>& datagram, Visitor visit) {
+    size_t offset = 0;
+    while (offset + sizeof(nlmsghdr) <= datagram.size()) {
+        nlmsghdr header;
+        std::memcpy(&header, datagram.data() + offset, sizeof(header));
+        if (header.nlmsg_len < NLMSG_HDRLEN || offset + header.nlmsg_len > datagram.size()) {
+            return;
+        }
+        if (!visit(header, datagram.data() + offset + NLMSG_HDRLEN, header.nlmsg_len - NLMSG_HDRLEN)) {
+            return;
+        }
+        offset += NLMSG_ALIGN(header.nlmsg_len);
+    }
+}
+
+// Probabilities are fractions of UINT32_MAX, as tc encodes percentages
+uint32_t encode_percent(double percentage) {
+    if (percentage <= 0.0) {
+        return 0;
+    }
+    if (percentage >= 100.0) {
+        return UINT32_MAX;
+    }
+    return static_cast<uint32_t>(std::llround(percentage / 100.0 * UINT32_MAX));
+}
+
+double decode_percent(uint32_t value) {
+    return value * 100.0 / UINT32_MAX;
+}
+
+int16_t to_table_entry(double value) {
+    double scaled = std::round(value * NETEM_DIST_SCALE);
+    return static_cast<int16_t>(std::max(-32768.0, std::min(32767.0, scaled)));
+}
+
+double normal_quantile(double u) {
+    double low = -8.0, high = 8.0;
+    for (int i = 0; i < 60; ++i) {
+        double mid = (low + high) / 2;
+        if (0.5 * std::erfc(-mid / std::sqrt(2.0)) < u) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    return (low + high) / 2;
+}
+
+// Standardised Pareto with shape 3, the same variate NetemEmulator draws
+double pareto_quantile(double u) {
+    return (std::pow(1.0 - u, -1.0 / 3.0) - 1.5) / 0.8660254037844386;
+}
+
+// Quantile tables of the standardised distributions, like tc's .dist files
+std::vector<int16_t> make_distribution_table(DelayDistribution distribution) {
+    std::vector<int16_t> table(DIST_TABLE_SIZE);
+    if (distribution == DelayDistribution::PARETONORMAL) {
+        // Quantiles of 0.25 N + 0.75 P from a grid over both variates
+        const size_t grid = 256;
+        std::vector<double> sums;
+        sums.reserve(grid * grid);
+        for (size_t i = 0; i < grid; ++i) {
+            double normal = normal_quantile((i + 0.5) / grid);
+            for (size_t j = 0; j < grid; ++j) {
+                sums.push_back(0.25 * normal + 0.75 * pareto_quantile((j + 0.5) / grid));
+            }
+        }
+        std::sort(sums.begin(), sums.end());
+        for (size_t i = 0; i < DIST_TABLE_SIZE; ++i) {
+            table[i] = to_table_entry(sums[(2 * i + 1) * sums.size() / (2 * DIST_TABLE_SIZE)]);
+        }
+        return table;
+    }
+
+    for (size_t i = 0; i < DIST_TABLE_SIZE; ++i) {
+        double u = (i + 0.5) / DIST_TABLE_SIZE;
+        table[i] = to_table_entry(distribution == DelayDistribution::PARETO ? pareto_quantile(u) : normal_quantile(u));
+    }
+    return table;
+}
+
+const std::vector<int16_t>& distribution_table(DelayDistribution distribution) {
+    static const std::vector<int16_t> normal = make_distribution_table(DelayDistribution::NORMAL);
+    static const std::vector<int16_t> pareto = make_distribution_table(DelayDistribution::PARETO);
+    static const std::vector<int16_t> paretonormal = make_distribution_table(DelayDistribution::PARETONORMAL);
+    switch (distribution) {
+        case DelayDistribution::PARETO:
+            return pareto;
+        case DelayDistribution::PARETONORMAL:
+            return paretonormal;
+        default:
+            return normal;
+    }
+}
+
+DelayDistribution identify_distribution(const uint8_t* data, size_t length) {
+    for (auto distribution : {DelayDistribution::NORMAL, DelayDistribution::PARETO, DelayDistribution::PARETONORMAL}) {
+        const auto& table = distribution_table(distribution);
+        if (length == table.size() * sizeof(int16_t) && std::memcmp(data, table.data(), length) == 0) {
+            return distribution;
+        }
+    }
+    return DelayDistribution::UNIFORM;
+}
+
+} // namespace
+
+// KernelNetlinkSocket implementation
+KernelNetlinkSocket::KernelNetlinkSocket() : fd_(-1) {
+    fd_ = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd_ < 0) {
+        std::cerr << "Failed to open rtnetlink socket: " << std::strerror(errno) << std::endl;
+        return;
+    }
+
+    // Room for a whole batch of acknowledgements, which are capped to the
+    // request header instead of echoing each message back
+    int size = SOCKET_BUFFER_BYTES;
+    setsockopt(fd_, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+    if (setsockopt(fd_, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size)) < 0) {
+        setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    }
+    int one = 1;
+    setsockopt(fd_, SOL_NETLINK, NETLINK_CAP_ACK, &one, sizeof(one));
+
+    sockaddr_nl local{};
+    local.nl_family = AF_NETLINK;
+    if (bind(fd_, reinterpret_cast<sockaddr*>(&local), sizeof(local)) < 0) {
+        std::cerr << "Failed to bind rtnetlink socket: " << std::strerror(errno) << std::endl;
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+KernelNetlinkSocket::~KernelNetlinkSocket() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+bool KernelNetlinkSocket::send(const std::vector<uint8_t>& datagram) {
+    if (fd_ < 0) {
+        return false;
+    }
+
+    sockaddr_nl kernel{};
+    kernel.nl_family = AF_NETLINK;
+    ssize_t sent;
+    do {
+        sent = sendto(fd_, datagram.data(), datagram.size(), 0, reinterpret_cast<sockaddr*>(&kernel), sizeof(kernel));
+    } while (sent < 0 && errno == EINTR);
+
+    if (sent != static_cast<ssize_t>(datagram.size())) {
+        std::cerr << "rtnetlink send failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool KernelNetlinkSocket::receive(std::vector<uint8_t>& datagram) {
+    if (fd_ < 0) {
+        return false;
+    }
+
+    ssize_t length;
+    do {
+        length = recv(fd_, nullptr, 0, MSG_PEEK | MSG_TRUNC);
+    } while (length < 0 && errno == EINTR);
+    if (length < 0) {
+        std::cerr << "rtnetlink receive failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    datagram.resize(static_cast<size_t>(length));
+    do {
+        length = recv(fd_, datagram.data(), datagram.size(), 0);
+    } while (length < 0 && errno == EINTR);
+    if (length < 0) {
+        std::cerr << "rtnetlink receive failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    datagram.resize(static_cast<size_t>(length));
+    return true;
+}
+
+// NetemNetlinkBackend implementation
+NetemNetlinkBackend::NetemNetlinkBackend(std::unique_ptr<NetlinkSocket> socket)
+    : socket_(std::move(socket)), sequence_(1), datagrams_sent_(0), messages_sent_(0) {
+}
+
+NetemNetlinkBackend::~NetemNetlinkBackend() = default;
+
+bool NetemNetlinkBackend::refresh_interfaces() {
+    ifinfomsg request{};
+    request.ifi_family = AF_UNSPEC;
+    std::vector<std::vector<uint8_t>> messages;
+    if (!dump(RTM_GETLINK, &request, sizeof(request), messages)) {
+        return false;
+    }
+
+    ifindex_.clear();
+    for (const auto& message : messages) {
+        ifinfomsg info;
+        if (message.size() < sizeof(info)) {
+            continue;
+        }
+        std::memcpy(&info, message.data(), sizeof(info));
+        Attributes attributes = parse_attributes(message.data() + NLMSG_ALIGN(sizeof(info)),
+                                                 message.size() - NLMSG_ALIGN(sizeof(info)));
+        std::string name = read_string(attributes, IFLA_IFNAME);
+        if (!name.empty()) {
+            ifindex_[name] = info.ifi_index;
+        }
+    }
+    return true;
+}
+
+std::vector<std::string> NetemNetlinkBackend::get_interfaces() const {
+    std::vector<std::string> interfaces;
+    for (const auto& [name, _] : ifindex_) {
+        interfaces.push_back(name);
+    }
+    return interfaces;
+}
+
+int NetemNetlinkBackend::get_ifindex(const std::string& interface) const {
+    auto it = ifindex_.find(interface);
+    return it != ifindex_.end() ? it->second : 0;
+}
+
+void NetemNetlinkBackend::queue_apply(const std::string& interface, const ImpairmentInfo& impairments) {
+    auto it = pending_index_.find(interface);
+    if (it != pending_index_.end()) {
+        pending_[it->second] = {interface, false, impairments};
+        return;
+    }
+    pending_index_[interface] = pending_.size();
+    pending_.push_back({interface, false, impairments});
+}
+
+void NetemNetlinkBackend::queue_remove(const std::string& interface) {
+    auto it = pending_index_.find(interface);
+    if (it != pending_index_.end()) {
+        pending_[it->second] = {interface, true, ImpairmentInfo{}};
+        return;
+    }
+    pending_index_[interface] = pending_.size();
+    pending_.push_back({interface, true, ImpairmentInfo{}});
+}
+
+bool NetemNetlinkBackend::commit(std::vector<std::string>* failed) {
+    if (pending_.empty()) {
+        return true;
+    }
+
+    // Interfaces may have appeared since the last link dump
+    bool unknown = std::any_of(pending_.begin(), pending_.end(),
+                               [&](const PendingChange& change) { return get_ifindex(change.interface) == 0; });
+    if (unknown) {
+        refresh_interfaces();
+    }
+
+    bool success = true;
+    std::vector<uint8_t> datagram;
+    std::vector<uint8_t> message;
+    std::vector<uint8_t> options;
+    std::map<uint32_t, InFlight> in_flight;
+
+    for (const auto& change : pending_) {
+        int ifindex = get_ifindex(change.interface);
+        if (ifindex == 0) {
+            std::cerr << "Unknown interface " << change.interface << std::endl;
+            if (failed) {
+                failed->push_back(change.interface);
+            }
+            success = false;
+            continue;
+        }
+
+        tcmsg tc{};
+        tc.tcm_family = AF_UNSPEC;
+        tc.tcm_ifindex = ifindex;
+        tc.tcm_parent = TC_H_ROOT;
+
+        uint32_t sequence = sequence_++;
+        message.clear();
+        MessageWriter writer(message);
+        if (change.remove) {
+            writer.begin(RTM_DELQDISC, NLM_F_REQUEST | NLM_F_ACK, sequence);
+            writer.append(&tc, sizeof(tc));
+        } else {
+            writer.begin(RTM_NEWQDISC, NLM_F_REQUEST | NLM_F_ACK | NLM_F_CREATE | NLM_F_REPLACE, sequence);
+            writer.append(&tc, sizeof(tc));
+            writer.string_attribute(TCA_KIND, "netem");
+            options.clear();
+            encode_netem_options(change.impairments, DEFAULT_LIMIT, options);
+            writer.attribute(TCA_OPTIONS, options.data(), options.size());
+        }
+        writer.end();
+
+        if (!datagram.empty() && datagram.size() + message.size() > MAX_BATCH_BYTES) {
+            success &= send_batch(datagram, in_flight, failed);
+            datagram.clear();
+        }
+        datagram.insert(datagram.end(), message.begin(), message.end());
+        in_flight[sequence] = {change.interface, change.remove};
+    }
+
+    if (!datagram.empty()) {
+        success &= send_batch(datagram, in_flight, failed);
+    }
+
+    pending_.clear();
+    pending_index_.clear();
+    return success;
+}
+
+bool NetemNetlinkBackend::apply(const std::string& interface, const ImpairmentInfo& impairments) {
+    queue_apply(interface, impairments);
+    return commit();
+}
+
+bool NetemNetlinkBackend::remove(const std::string& interface) {
+    queue_remove(interface);
+    return commit();
+}
+
+bool NetemNetlinkBackend::dump_qdiscs(std::vector<QdiscState>& qdiscs) {
+    if (ifindex_.empty() && !refresh_interfaces()) {
+        return false;
+    }
+
+    tcmsg request{};
+    request.tcm_family = AF_UNSPEC;
+    std::vector<std::vector<uint8_t>> messages;
+    if (!dump(RTM_GETQDISC, &request, sizeof(request), messages)) {
+        return false;
+    }
+
+    std::map<int, std::string> names;
+    for (const auto& [name, index] : ifindex_) {
+        names[index] = name;
+    }
+
+    qdiscs.clear();
+    for (const auto& message : messages) {
+        tcmsg tc;
+        if (message.size() < sizeof(tc)) {
+            continue;
+        }
+        std::memcpy(&tc, message.data(), sizeof(tc));
+        if (tc.tcm_parent != TC_H_ROOT) {
+            continue;
+        }
+
+        Attributes attributes = parse_attributes(message.data() + NLMSG_ALIGN(sizeof(tc)),
+                                                 message.size() - NLMSG_ALIGN(sizeof(tc)));
+        QdiscState state;
+        state.ifindex = tc.tcm_ifindex;
+        state.interface = names.count(tc.tcm_ifindex) ? names[tc.tcm_ifindex] : std::to_string(tc.tcm_ifindex);
+        state.handle = tc.tcm_handle;
+        state.kind = read_string(attributes, TCA_KIND);
+
+        auto options = attributes.find(TCA_OPTIONS);
+        if (state.kind == "netem" && options != attributes.end()) {
+            decode_netem_options(options->second.first, options->second.second, state.impairments);
+        }
+
+        auto stats = attributes.find(TCA_STATS2);
+        if (stats != attributes.end()) {
+            Attributes nested = parse_attributes(stats->second.first, stats->second.second);
+            auto basic = nested.find(TCA_STATS_BASIC);
+            if (basic != nested.end() && basic->second.second >= 12) {
+                std::memcpy(&state.bytes, basic->second.first, sizeof(uint64_t));
+                uint32_t packets;
+                std::memcpy(&packets, basic->second.first + sizeof(uint64_t), sizeof(packets));
+                state.packets = packets;
+            }
+            gnet_stats_queue queue;
+            if (read_attribute(nested, TCA_STATS_QUEUE, queue)) {
+                state.drops = queue.drops;
+                state.queue_length = queue.qlen;
+            }
+        }
+        qdiscs.push_back(state);
+    }
+    return true;
+}
+
+bool NetemNetlinkBackend::get_qdisc(const std::string& interface, QdiscState& state) {
+    std::vector<QdiscState> qdiscs;
+    if (!dump_qdiscs(qdiscs)) {
+        return false;
+    }
+    for (const auto& qdisc : qdiscs) {
+        if (qdisc.interface == interface) {
+            state = qdisc;
+            return true;
+        }
+    }
+    return false;
+}
+
+void NetemNetlinkBackend::encode_netem_options(const ImpairmentInfo& impairments, uint32_t limit,
+                                               std::vector<uint8_t>& options) {
+    uint64_t latency_ns = impairments.has_delay ? impairments.delay.delay_ms * 1000000ULL : 0;
+    uint64_t jitter_ns = impairments.has_delay ? impairments.delay.jitter_ms * 1000000ULL : 0;
+
+    tc_netem_qopt qopt{};
+    qopt.latency = static_cast<uint32_t>(std::min<uint64_t>(latency_ns >> PSCHED_SHIFT, UINT32_MAX));
+    qopt.jitter = static_cast<uint32_t>(std::min<uint64_t>(jitter_ns >> PSCHED_SHIFT, UINT32_MAX));
+    qopt.limit = limit;
+    if (impairments.has_loss && impairments.loss.loss_type == LossType::RANDOM) {
+        qopt.loss = encode_percent(impairments.loss.loss_percentage);
+    }
+    if (impairments.has_duplicate) {
+        qopt.duplicate = encode_percent(impairments.duplicate.duplicate_percentage);
+    }
+
+    // tc turns "reorder P%" into gap 1, and "gap N" without a probability into 100%
+    tc_netem_reorder reorder{};
+    if (impairments.has_reorder) {
+        if (impairments.reorder.reorder_type == ReorderType::GAP) {
+            qopt.gap = impairments.reorder.gap;
+            reorder.probability = impairments.reorder.reorder_percentage > 0.0
+                                      ? encode_percent(impairments.reorder.reorder_percentage) : UINT32_MAX;
+        } else {
+            qopt.gap = 1;
+            reorder.probability = encode_percent(impairments.reorder.reorder_percentage);
+        }
+    }
+
+    MessageWriter writer(options);
+    writer.append(&qopt, sizeof(qopt));
+    if (impairments.has_delay) {
+        writer.attribute(TCA_NETEM_LATENCY64, static_cast<int64_t>(latency_ns));
+        writer.attribute(TCA_NETEM_JITTER64, static_cast<int64_t>(jitter_ns));
+        if (jitter_ns > 0 && impairments.delay.distribution != DelayDistribution::UNIFORM) {
+            const auto& table = distribution_table(impairments.delay.distribution);
+            writer.attribute(TCA_NETEM_DELAY_DIST, table.data(), table.size() * sizeof(int16_t));
+        }
+    }
+    if (reorder.probability != 0) {
+        writer.attribute(TCA_NETEM_REORDER, reorder);
+    }
+    if (impairments.has_corrupt) {
+        tc_netem_corrupt corrupt{};
+        corrupt.probability = encode_percent(impairments.corrupt.corrupt_percentage);
+        writer.attribute(TCA_NETEM_CORRUPT, corrupt);
+    }
+    if (impairments.has_loss && impairments.loss.loss_type != LossType::RANDOM) {
+        const LossConfig& loss = impairments.loss;
+        size_t nested = writer.begin_nested(TCA_NETEM_LOSS);
+        if (loss.loss_type == LossType::STATE) {
+            tc_netem_gimodel model{};
+            model.p13 = encode_percent(loss.p13);
+            model.p31 = encode_percent(loss.p31);
+            model.p32 = encode_percent(loss.p32);
+            model.p14 = encode_percent(loss.p14);
+            model.p23 = encode_percent(loss.p23);
+            writer.attribute(NETEM_LOSS_GI, model);
+        } else {
+            // The kernel takes h as the chance to survive the bad state
+            // and k1 as the chance to be lost in the good one
+            tc_netem_gemodel model{};
+            model.p = encode_percent(loss.p);
+            model.r = encode_percent(loss.r);
+            model.h = encode_percent(loss.h);
+            model.k1 = encode_percent(100.0 - loss.k);
+            writer.attribute(NETEM_LOSS_GE, model);
+        }
+        writer.end_nested(nested);
+    }
+    if (impairments.has_rate_limit && impairments.rate_limit.rate_kbps > 0) {
+        uint64_t bytes_per_second = impairments.rate_limit.rate_kbps * 1000ULL / 8;
+        tc_netem_rate rate{};
+        rate.rate = static_cast<uint32_t>(std::min<uint64_t>(bytes_per_second, UINT32_MAX));
+        writer.attribute(TCA_NETEM_RATE, rate);
+        if (bytes_per_second >= UINT32_MAX) {
+            writer.attribute(TCA_NETEM_RATE64, bytes_per_second);
+        }
+    }
+}
+
+bool NetemNetlinkBackend::decode_netem_options(const uint8_t* data, size_t length, ImpairmentInfo& impairments) {
+    tc_netem_qopt qopt;
+    if (length < sizeof(qopt)) {
+        return false;
+    }
+    std::memcpy(&qopt, data, sizeof(qopt));
+    Attributes attributes = parse_attributes(data + NLMSG_ALIGN(sizeof(qopt)), length - NLMSG_ALIGN(sizeof(qopt)));
+
+    impairments = ImpairmentInfo{};
+
+    int64_t latency_ns = static_cast<int64_t>(qopt.latency) << PSCHED_SHIFT;
+    int64_t jitter_ns = static_cast<int64_t>(qopt.jitter) << PSCHED_SHIFT;
+    read_attribute(attributes, TCA_NETEM_LATENCY64, latency_ns);
+    read_attribute(attributes, TCA_NETEM_JITTER64, jitter_ns);
+    auto table = attributes.find(TCA_NETEM_DELAY_DIST);
+    if (latency_ns > 0 || jitter_ns > 0 || table != attributes.end()) {
+        impairments.has_delay = true;
+        impairments.delay.delay_ms = static_cast<uint32_t>(latency_ns / 1000000);
+        impairments.delay.jitter_ms = static_cast<uint32_t>(jitter_ns / 1000000);
+        if (table != attributes.end()) {
+            impairments.delay.distribution = identify_distribution(table->second.first, table->second.second);
+        }
+    }
+
+    auto loss = attributes.find(TCA_NETEM_LOSS);
+    if (loss != attributes.end()) {
+        Attributes models = parse_attributes(loss->second.first, loss->second.second);
+        tc_netem_gimodel state;
+        tc_netem_gemodel gemodel;
+        if (read_attribute(models, NETEM_LOSS_GI, state)) {
+            impairments.has_loss = true;
+            impairments.loss.loss_type = LossType::STATE;
+            impairments.loss.p13 = decode_percent(state.p13);
+            impairments.loss.p31 = decode_percent(state.p31);
+            impairments.loss.p32 = decode_percent(state.p32);
+            impairments.loss.p14 = decode_percent(state.p14);
+            impairments.loss.p23 = decode_percent(state.p23);
+        } else if (read_attribute(models, NETEM_LOSS_GE, gemodel)) {
+            impairments.has_loss = true;
+            impairments.loss.loss_type = LossType::GEMODEL;
+            impairments.loss.p = decode_percent(gemodel.p);
+            impairments.loss.r = decode_percent(gemodel.r);
+            impairments.loss.h = decode_percent(gemodel.h);
+            impairments.loss.k = 100.0 - decode_percent(gemodel.k1);
+        }
+    }
+    if (!impairments.has_loss && qopt.loss != 0) {
+        impairments.has_loss = true;
+        impairments.loss.loss_percentage = decode_percent(qopt.loss);
+    }
+
+    if (qopt.duplicate != 0) {
+        impairments.has_duplicate = true;
+        impairments.duplicate.duplicate_percentage = decode_percent(qopt.duplicate);
+    }
+
+    tc_netem_corrupt corrupt;
+    if (read_attribute(attributes, TCA_NETEM_CORRUPT, corrupt) && corrupt.probability != 0) {
+        impairments.has_corrupt = true;
+        impairments.corrupt.corrupt_percentage = decode_percent(corrupt.probability);
+    }
+
+    tc_netem_reorder reorder;
+    if (qopt.gap != 0 && read_attribute(attributes, TCA_NETEM_REORDER, reorder) && reorder.probability != 0) {
+        impairments.has_reorder = true;
+        impairments.reorder.reorder_percentage = decode_percent(reorder.probability);
+        if (qopt.gap > 1) {
+            impairments.reorder.reorder_type = ReorderType::GAP;
+            impairments.reorder.gap = qopt.gap;
+        }
+    }
+
+    tc_netem_rate rate;
+    if (read_attribute(attributes, TCA_NETEM_RATE, rate) && rate.rate != 0) {
+        uint64_t bytes_per_second = rate.rate;
+        read_attribute(attributes, TCA_NETEM_RATE64, bytes_per_second);
+        impairments.has_rate_limit = true;
+        impairments.rate_limit.rate_kbps = static_cast<uint32_t>(bytes_per_second * 8 / 1000);
+    }
+
+    return true;
+}
+
+bool NetemNetlinkBackend::send_batch(const std::vector<uint8_t>& datagram, std::map<uint32_t, InFlight>& in_flight,
+                                     std::vector<std::string>* failed) {
+    bool sent = socket_->send(datagram);
+    if (sent) {
+        datagrams_sent_++;
+        messages_sent_ += in_flight.size();
+    }
+
+    bool success = sent;
+    std::vector<uint8_t> reply;
+    while (sent && !in_flight.empty() && socket_->receive(reply)) {
+        for_each_message(reply, [&](const nlmsghdr& header, const uint8_t* payload, size_t length) {
+            auto it = in_flight.find(header.nlmsg_seq);
+            if (header.nlmsg_type != NLMSG_ERROR || it == in_flight.end() || length < sizeof(int)) {
+                return true;
+            }
+
+            // Deleting a qdisc that is already gone is not a failure
+            int error;
+            std::memcpy(&error, payload, sizeof(error));
+            if (error != 0 && !(it->second.remove && error == -ENOENT)) {
+                std::cerr << "Failed to " << (it->second.remove ? "remove" : "configure") << " netem on "
+                          << it->second.interface << ": " << std::strerror(-error) << std::endl;
+                if (failed) {
+                    failed->push_back(it->second.interface);
+                }
+                success = false;
+            }
+            in_flight.erase(it);
+            return true;
+        });
+    }
+
+    for (const auto& [sequence, request] : in_flight) {
+        std::cerr << "No acknowledgement for netem change on " << request.interface << std::endl;
+        if (failed) {
+            failed->push_back(request.interface);
+        }
+    }
+    success &= in_flight.empty();
+    in_flight.clear();
+    return success;
+}
+
+bool NetemNetlinkBackend::dump(uint16_t type, const void* header, size_t header_length,
+                               std::vector<std::vector<uint8_t>>& messages) {
+    std::vector<uint8_t> request;
+    MessageWriter writer(request);
+    uint32_t sequence = sequence_++;
+    writer.begin(type, NLM_F_REQUEST | NLM_F_DUMP, sequence);
+    writer.append(header, header_length);
+    writer.end();
+
+    if (!socket_->send(request)) {
+        return false;
+    }
+    datagrams_sent_++;
+    messages_sent_++;
+
+    // Replies to a dump of RTM_GETx are RTM_NEWx messages
+    uint16_t reply_type = type - 2;
+    bool done = false;
+    bool success = true;
+    std::vector<uint8_t> reply;
+    while (!done && socket_->receive(reply)) {
+        for_each_message(reply, [&](const nlmsghdr& message, const uint8_t* payload, size_t length) {
+            if (message.nlmsg_seq != sequence) {
+                return true;
+            }
+            if (message.nlmsg_type == NLMSG_DONE) {
+                done = true;
+                return false;
+            }
+            if (message.nlmsg_type == NLMSG_ERROR) {
+                int error = 0;
+                if (length >= sizeof(error)) {
+                    std::memcpy(&error, payload, sizeof(error));
+                }
+                std::cerr << "rtnetlink dump failed: " << std::strerror(-error) << std::endl;
+                success = false;
+                done = true;
+                return false;
+            }
+            if (message.nlmsg_type == reply_type) {
+                messages.emplace_back(payload, payload + length);
+            }
+            return true;
+        });
+    }
+
+    return done && success;
+}
+
+} // namespace RouterSim
@@ -0,0 +1,256 @@
+#include "network_impairments.h"
+#include "netem/netlink.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+namespace RouterSim {
+
+NetworkImpairments::NetworkImpairments() : NetworkImpairments(std::make_unique<KernelNetlinkSocket>()) {
+}
+
+NetworkImpairments::NetworkImpairments(std::unique_ptr<NetlinkSocket> socket)
+    : enabled_(false), backend_(std::make_unique<NetemNetlinkBackend>(std::move(socket))),
+      total_packets_processed_(0), total_bytes_processed_(0), packets_dropped_(0), bytes_dropped_(0) {
+}
+
+NetworkImpairments::~NetworkImpairments() {
+    cleanup();
+}
+
+bool NetworkImpairments::initialize() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!backend_->refresh_interfaces()) {
+        std::cerr << "Failed to list interfaces over rtnetlink" << std::endl;
+        return false;
+    }
+
+    enabled_ = true;
+    return true;
+}
+
+void NetworkImpairments::cleanup() {
+    if (enabled_) {
+        clearAllImpairments();
+    }
+    enabled_ = false;
+}
+
+bool NetworkImpairments::applyDelay(const std::string& interface, uint32_t delay_ms, uint32_t jitter_ms) {
+    ImpairmentConfig config = currentConfig(interface);
+    config.delay_ms = delay_ms;
+    config.jitter_ms = jitter_ms;
+    return applyComplexImpairment(interface, config);
+}
+
+bool NetworkImpairments::applyLoss(const std::string& interface, double loss_percentage) {
+    ImpairmentConfig config = currentConfig(interface);
+    config.loss_percentage = loss_percentage;
+    return applyComplexImpairment(interface, config);
+}
+
+bool NetworkImpairments::applyBandwidth(const std::string& interface, uint64_t bandwidth_bps) {
+    ImpairmentConfig config = currentConfig(interface);
+    config.bandwidth_bps = bandwidth_bps;
+    return applyComplexImpairment(interface, config);
+}
+
+bool NetworkImpairments::applyDuplication(const std::string& interface, double duplication_percentage) {
+    ImpairmentConfig config = currentConfig(interface);
+    config.duplication_percentage = duplication_percentage;
+    return applyComplexImpairment(interface, config);
+}
+
+bool NetworkImpairments::applyReordering(const std::string& interface, double reorder_percentage, uint32_t gap) {
+    ImpairmentConfig config = currentConfig(interface);
+    config.reorder_percentage = reorder_percentage;
+    config.reorder_gap = gap;
+    return applyComplexImpairment(interface, config);
+}
+
+bool NetworkImpairments::applyCorruption(const std::string& interface, double corruption_percentage) {
+    ImpairmentConfig config = currentConfig(interface);
+    config.corruption_percentage = corruption_percentage;
+    return applyComplexImpairment(interface, config);
+}
+
+bool NetworkImpairments::applyComplexImpairment(const std::string& interface, const ImpairmentConfig& config) {
+    return applyComplexImpairment(std::vector<std::string>{interface}, config);
+}
+
+bool NetworkImpairments::applyComplexImpairment(const std::vector<std::string>& interfaces,
+                                                const ImpairmentConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!enabled_) {
+        return false;
+    }
+
+    ImpairmentInfo info = toImpairmentInfo(config);
+    for (const auto& interface : interfaces) {
+        backend_->queue_apply(interface, info);
+    }
+
+    std::vector<std::string> failed;
+    bool success = backend_->commit(&failed);
+    for (const auto& interface : interfaces) {
+        if (std::find(failed.begin(), failed.end(), interface) == failed.end()) {
+            configs_[interface] = config;
+        }
+    }
+    return success;
+}
+
+bool NetworkImpairments::clearImpairments(const std::string& interface) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!enabled_) {
+        return false;
+    }
+
+    configs_.erase(interface);
+    return backend_->remove(interface);
+}
+
+bool NetworkImpairments::clearAllImpairments() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!enabled_) {
+        return false;
+    }
+
+    for (const auto& [interface, _] : configs_) {
+        backend_->queue_remove(interface);
+    }
+    configs_.clear();
+    return backend_->commit();
+}
+
+std::vector<std::string> NetworkImpairments::getNetworkInterfaces() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    backend_->refresh_interfaces();
+    return backend_->get_interfaces();
+}
+
+std::string NetworkImpairments::getInterfaceStatus(const std::string& interface) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    QdiscState state;
+    if (!backend_->get_qdisc(interface, state)) {
+        return "unknown";
+    }
+    if (state.kind != "netem") {
+        return state.kind;
+    }
+
+    // Same wording as "tc qdisc show"
+    const ImpairmentInfo& info = state.impairments;
+    std::ostringstream status;
+    status << "netem";
+    if (info.has_delay) {
+        status << " delay " << info.delay.delay_ms << "ms";
+        if (info.delay.jitter_ms > 0) {
+            status << " " << info.delay.jitter_ms << "ms";
+        }
+    }
+    if (info.has_loss) {
+        status << " loss " << info.loss.loss_percentage << "%";
+    }
+    if (info.has_duplicate) {
+        status << " duplicate " << info.duplicate.duplicate_percentage << "%";
+    }
+    if (info.has_reorder) {
+        status << " reorder " << info.reorder.reorder_percentage << "%";
+        if (info.reorder.gap > 1) {
+            status << " gap " << info.reorder.gap;
+        }
+    }
+    if (info.has_corrupt) {
+        status << " corrupt " << info.corrupt.corrupt_percentage << "%";
+    }
+    if (info.has_rate_limit) {
+        status << " rate " << info.rate_limit.rate_kbps << "Kbit";
+    }
+    return status.str();
+}
+
+NetworkImpairments::Statistics NetworkImpairments::getStatistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    Statistics stats{};
+    stats.enabled = enabled_;
+
+    std::vector<QdiscState> qdiscs;
+    if (!backend_->dump_qdiscs(qdiscs)) {
+        return stats;
+    }
+
+    for (const auto& qdisc : qdiscs) {
+        if (!configs_.count(qdisc.interface)) {
+            continue;
+        }
+        stats.total_packets_processed += qdisc.packets;
+        stats.total_bytes_processed += qdisc.bytes;
+        stats.packets_dropped += qdisc.drops;
+        stats.interface_stats.push_back({qdisc.interface, qdisc.kind});
+    }
+
+    // The kernel counts dropped packets only, so bytes_dropped stays at zero
+    stats.total_packets_processed -= std::min(stats.total_packets_processed, total_packets_processed_);
+    stats.total_bytes_processed -= std::min(stats.total_bytes_processed, total_bytes_processed_);
+    stats.packets_dropped -= std::min(stats.packets_dropped, packets_dropped_);
+    stats.bytes_dropped = 0;
+    return stats;
+}
+
+void NetworkImpairments::reset() {
+    Statistics current = getStatistics();
+    std::lock_guard<std::mutex> lock(mutex_);
+    total_packets_processed_ += current.total_packets_processed;
+    total_bytes_processed_ += current.total_bytes_processed;
+    packets_dropped_ += current.packets_dropped;
+    bytes_dropped_ += current.bytes_dropped;
+}
+
+ImpairmentConfig NetworkImpairments::currentConfig(const std::string& interface) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = configs_.find(interface);
+    return it != configs_.end() ? it->second : ImpairmentConfig{};
+}
+
+ImpairmentInfo NetworkImpairments::toImpairmentInfo(const ImpairmentConfig& config) {
+    ImpairmentInfo info;
+    if (config.delay_ms > 0 || config.jitter_ms > 0) {
+        info.has_delay = true;
+        info.delay.delay_ms = config.delay_ms;
+        info.delay.jitter_ms = config.jitter_ms;
+    }
+    if (config.loss_percentage > 0.0) {
+        info.has_loss = true;
+        info.loss.loss_percentage = config.loss_percentage;
+    }
+    if (config.duplication_percentage > 0.0) {
+        info.has_duplicate = true;
+        info.duplicate.duplicate_percentage = config.duplication_percentage;
+    }
+    if (config.reorder_percentage > 0.0 || config.reorder_gap > 0) {
+        info.has_reorder = true;
+        info.reorder.reorder_percentage = config.reorder_percentage;
+        if (config.reorder_gap > 0) {
+            info.reorder.reorder_type = ReorderType::GAP;
+            info.reorder.gap = config.reorder_gap;
+        }
+    }
+    if (config.corruption_percentage > 0.0) {
+        info.has_corrupt = true;
+        info.corrupt.corrupt_percentage = config.corruption_percentage;
+    }
+    if (config.bandwidth_bps > 0) {
+        info.has_rate_limit = true;
+        info.rate_limit.rate_kbps = static_cast<uint32_t>(std::max<uint64_t>(1, config.bandwidth_bps / 1000));
+    }
+    return info;
+}
+
+} // namespace RouterSim
@@ -0,0 +1,80 @@
+#include "common_types.h"
+#include <arpa/inet.h>
+
+namespace RouterSim {
+
+bool parse_ip_address(const std::string& text, IpAddress& address) {
+    struct in_addr v4;
+    if (inet_pton(AF_INET, text.c_str(), &v4) == 1) {
+        address = IpAddress::from_ipv4(ntohl(v4.s_addr));
+        return true;
+    }
+
+    struct in6_addr v6;
+    if (inet_pton(AF_INET6, text.c_str(), &v6) == 1) {
+        address = IpAddress::from_ipv6(v6.s6_addr);
+        return true;
+    }
+
+    return false;
+}
+
+std::string format_ip_address(const IpAddress& address) {
+    char buffer[INET6_ADDRSTRLEN];
+
+    if (address.is_ipv4()) {
+        struct in_addr v4;
+        v4.s_addr = htonl(address.ipv4());
+        inet_ntop(AF_INET, &v4, buffer, sizeof(buffer));
+    } else {
+        inet_ntop(AF_INET6, address.bytes, buffer, sizeof(buffer));
+    }
+
+    return buffer;
+}
+
+PacketDescriptor to_packet_descriptor(const PacketInfo& packet) {
+    PacketDescriptor descriptor{};
+    descriptor.id = packet.id;
+    descriptor.timestamp_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        packet.timestamp.time_since_epoch()).count());
+    descriptor.size = packet.size;
+    descriptor.priority = packet.priority;
+    descriptor.src_port = packet.src_port;
+    // PacketInfo carries the destination port under two names
+    descriptor.dst_port = packet.dst_port ? packet.dst_port : packet.dest_port;
+    descriptor.protocol = packet.protocol;
+    descriptor.dscp = packet.dscp;
+
+    // Unparseable or empty addresses map to 0.0.0.0
+    if (!parse_ip_address(packet.src_ip, descriptor.src_addr)) {
+        descriptor.src_addr = IpAddress::from_ipv4(0);
+    }
+    if (!parse_ip_address(packet.dst_ip, descriptor.dst_addr)) {
+        descriptor.dst_addr = IpAddress::from_ipv4(0);
+    }
+    descriptor.ip_version = descriptor.dst_addr.is_ipv4() ? 4 : 6;
+
+    return descriptor;
+}
+
+PacketInfo to_packet_info(const PacketDescriptor& descriptor) {
+    PacketInfo packet;
+    packet.id = descriptor.id;
+    packet.size = descriptor.size;
+    packet.priority = descriptor.priority;
+    packet.src_ip = format_ip_address(descriptor.src_addr);
+    packet.dst_ip = format_ip_address(descriptor.dst_addr);
+    packet.src_port = descriptor.src_port;
+    packet.dest_port = descriptor.dst_port;
+    packet.dst_port = descriptor.dst_port;
+    packet.protocol = descriptor.protocol;
+    packet.dscp = descriptor.dscp;
+    packet.timestamp = std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::nanoseconds(descriptor.timestamp_ns)));
+
+    return packet;
+}
+
+} // namespace RouterSim
@@ -3,61 +3,170 @@
 #include <sstream>
 #include <algorithm>
 #include <chrono>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 namespace router_sim {
 
-BGPProtocol::BGPProtocol() : running_(false) {
+namespace {
+
+const uint32_t EBGP_ADMIN_DISTANCE = 20;
+const uint32_t IBGP_ADMIN_DISTANCE = 200;
+
+std::string route_key(const std::string& prefix, uint8_t prefix_length) {
+    return prefix + "/" + std::to_string(prefix_length);
+}
+
+bool parse_ipv4(const std::string& text, uint32_t& address) {
+    in_addr parsed{};
+    if (inet_pton(AF_INET, text.c_str(), &parsed) != 1) {
+        return false;
+    }
+    address = ntohl(parsed.s_addr);
+    return true;
+}
+
+std::string format_ipv4(uint32_t address) {
+    in_addr value{};
+    value.s_addr = htonl(address);
+    char text[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &value, text, sizeof(text));
+    return text;
+}
+
+const char* origin_name(uint8_t origin) {
+    return origin == BGP_ORIGIN_IGP ? "IGP" : origin == BGP_ORIGIN_EGP ? "EGP" : "INCOMPLETE";
+}
+
+BGPRoute bgp_route(const BGPRibRoute& rib_route) {
+    BGPRoute route;
+    route.prefix = format_ipv4(rib_route.prefix.address);
+    route.prefix_length = rib_route.prefix.length;
+    route.neighbor = rib_route.path.peer;
+    route.attributes = rib_route.path.attributes;
+    return route;
+}
+
+RouteInfo route_info(const RouterSim::Ipv4Prefix& prefix, const BGPRibPath& path, bool active) {
+    RouteInfo info;
+    info.destination = format_ipv4(prefix.address);
+    info.prefix_length = prefix.length;
+    info.next_hop = format_ipv4(path.attributes->next_hop);
+    info.protocol = "BGP";
+    info.metric = path.attributes->has_med ? path.attributes->med : 0;
+    info.admin_distance = path.ibgp ? IBGP_ADMIN_DISTANCE : EBGP_ADMIN_DISTANCE;
+    info.is_active = active;
+    info.attributes["neighbor"] = format_ipv4(path.peer);
+    return info;
+}
+
+} // namespace
+
+std::string BGPRoute::next_hop() const {
+    return attributes && attributes->next_hop != 0 ? format_ipv4(attributes->next_hop) : "";
+}
+
+std::string BGPRoute::origin() const {
+    return origin_name(attributes ? attributes->origin : BGP_ORIGIN_IGP);
+}
+
+const std::vector<uint32_t>& BGPRoute::as_path() const {
+    static const std::vector<uint32_t> empty;
+    return attributes ? attributes->as_path : empty;
+}
+
+BGPProtocol::BGPProtocol() : running_(false), export_scheduled_(false), listen_fd_(-1), listen_port_(0) {
     config_.local_as = 0;
     config_.router_id = "";
     config_.enable_graceful_restart = false;
     config_.hold_time = 180;
     config_.keepalive_interval = 60;
+    config_.connect_retry_time = 120;
+    config_.listen_address = "0.0.0.0";
+    config_.listen_port = BGP_PORT;
+    config_.enabled = true;
+    config_.update_interval_ms = 0;
+    config_.update_groups = true;
 }
 
 BGPProtocol::~BGPProtocol() {
     stop();
 }
 
-bool BGPProtocol::initialize(const ProtocolConfig& config) {
-    std::lock_guard<std::mutex> lock(config_mutex_);
-    
-    // Convert generic config to BGP-specific config
-    config_.parameters = config.parameters;
-    config_.enabled = config.enabled;
-    config_.update_interval_ms = config.update_interval_ms;
-    
-    // Parse BGP-specific parameters
-    auto it = config.parameters.find("local_as");
-    if (it != config.parameters.end()) {
-        config_.local_as = std::stoul(it->second);
-    }
-    
-    it = config.parameters.find("router_id");
-    if (it != config.parameters.end()) {
-        config_.router_id = it->second;
-    }
-    
-    it = config.parameters.find("neighbors");
-    if (it != config.parameters.end()) {
-        // Parse comma-separated neighbors
-        std::stringstream ss(it->second);
-        std::string neighbor;
-        while (std::getline(ss, neighbor, ',')) {
-            config_.neighbors.push_back(neighbor);
-        }
-    }
-    
-    it = config.parameters.find("hold_time");
-    if (it != config.parameters.end()) {
-        config_.hold_time = std::stoul(it->second);
-    }
-    
-    it = config.parameters.find("keepalive_interval");
-    if (it != config.parameters.end()) {
-        config_.keepalive_interval = std::stoul(it->second);
-    }
-    
-    std::cout << "BGP protocol initialized with AS " << config_.local_as 
+bool BGPProtocol::initialize(const std::map<std::string, std::string>& config) {
+    std::vector<std::string> neighbors;
+    {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+
+        config_.parameters = config;
+
+        // Parse BGP-specific parameters
+        auto it = config.find("local_as");
+        if (it != config.end()) {
+            config_.local_as = std::stoul(it->second);
+        }
+
+        it = config.find("router_id");
+        if (it != config.end()) {
+            config_.router_id = it->second;
+        }
+
+        it = config.find("neighbors");
+        if (it != config.end()) {
+            // Parse comma-separated neighbors
+            std::stringstream ss(it->second);
+            std::string neighbor;
+            while (std::getline(ss, neighbor, ',')) {
+                neighbors.push_back(neighbor);
+            }
+        }
+
+        it = config.find("hold_time");
+        if (it != config.end()) {
+            config_.hold_time = std::stoul(it->second);
+        }
+
+        it = config.find("keepalive_interval");
+        if (it != config.end()) {
+            config_.keepalive_interval = std::stoul(it->second);
+        }
+
+        it = config.find("connect_retry_time");
+        if (it != config.end()) {
+            config_.connect_retry_time = std::stoul(it->second);
+        }
+
+        it = config.find("listen_address");
+        if (it != config.end()) {
+            config_.listen_address = it->second;
+        }
+
+        it = config.find("listen_port");
+        if (it != config.end()) {
+            config_.listen_port = static_cast<uint16_t>(std::stoul(it->second));
+        }
+
+        it = config.find("update_interval_ms");
+        if (it != config.end()) {
+            config_.update_interval_ms = std::stoul(it->second);
+        }
+
+        it = config.find("update_groups");
+        if (it != config.end()) {
+            config_.update_groups = it->second != "false";
+        }
+    }
+
+    for (const auto& neighbor : neighbors) {
+        add_neighbor(neighbor, {});
+    }
+
+    std::cout << "BGP protocol initialized with AS " << config_.local_as
               << " and router ID " << config_.router_id << "\n";
     return true;
 }
@@ -66,14 +175,29 @@ bool BGPProtocol::start() {
     if (running_.load()) {
         return true;
     }
+    if (!loop_.is_open()) {
+        return false;
+    }
 
     std::cout << "Starting BGP protocol...\n";
+    if (!open_listener()) {
+        return false;
+    }
     running_.store(true);
-
-    // Start BGP threads
-    bgp_thread_ = std::thread(&BGPProtocol::bgp_main_loop, this);
-    neighbor_thread_ = std::thread(&BGPProtocol::neighbor_management_loop, this);
-    route_thread_ = std::thread(&BGPProtocol::route_processing_loop, this);
+    export_scheduled_ = false;
+
+    // The loop is not running yet, so the sessions can be set up from here
+    std::vector<BGPNeighbor> neighbors;
+    {
+        std::lock_guard<std::mutex> lock(neighbors_mutex_);
+        for (const auto& pair : neighbors_) {
+            neighbors.push_back(pair.second);
+        }
+    }
+    for (const auto& neighbor : neighbors) {
+        create_session(neighbor);
+    }
+    loop_thread_ = std::thread([this] { loop_.run(); });
 
     std::cout << "BGP protocol started\n";
     return true;
@@ -85,18 +209,30 @@ bool BGPProtocol::stop() {
     }
 
     std::cout << "Stopping BGP protocol...\n";
-    running_.store(false);
-
-    // Wait for threads to finish
-    if (bgp_thread_.joinable()) {
-        bgp_thread_.join();
+    // Cease every session from the loop, then leave it
+    loop_.post([this] {
+        for (auto& pair : sessions_) {
+            pair.second->stop();
+        }
+        loop_.stop();
+    });
+    if (loop_thread_.joinable()) {
+        loop_thread_.join();
     }
-    if (neighbor_thread_.joinable()) {
-        neighbor_thread_.join();
+
+    std::map<std::string, std::unique_ptr<BGPSession>> sessions;
+    {
+        std::lock_guard<std::mutex> lock(neighbors_mutex_);
+        sessions.swap(sessions_);
     }
-    if (route_thread_.joinable()) {
-        route_thread_.join();
+    sessions.clear();
+    if (listen_fd_ >= 0) {
+        loop_.remove(listen_fd_);
+        close(listen_fd_);
+        listen_fd_ = -1;
     }
+    listen_port_.store(0);
+    running_.store(false);
 
     std::cout << "BGP protocol stopped\n";
     return true;
@@ -106,74 +242,258 @@ bool BGPProtocol::is_running() const {
     return running_.load();
 }
 
+uint16_t BGPProtocol::get_listen_port() const {
+    return listen_port_.load();
+}
+
+bool BGPProtocol::open_listener() {
+    std::string address_text;
+    uint16_t port;
+    {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        address_text = config_.listen_address;
+        port = config_.listen_port;
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    if (inet_pton(AF_INET, address_text.c_str(), &address.sin_addr) != 1) {
+        std::cerr << "BGP: invalid listen address " << address_text << std::endl;
+        return false;
+    }
+    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        std::cerr << "BGP: failed to create listening socket: " << strerror(errno) << std::endl;
+        return false;
+    }
+    int one = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    socklen_t length = sizeof(address);
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(listen_fd_, SOMAXCONN) < 0 ||
+        getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &length) < 0) {
+        std::cerr << "BGP: failed to listen on " << address_text << ":" << port << ": " << strerror(errno)
+                  << std::endl;
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    listen_port_.store(ntohs(address.sin_port));
+    return loop_.add(listen_fd_, EPOLLIN, [this](uint32_t) { accept_connections(); });
+}
+
+void BGPProtocol::accept_connections() {
+    while (true) {
+        sockaddr_in peer{};
+        socklen_t length = sizeof(peer);
+        int fd = accept4(listen_fd_, reinterpret_cast<sockaddr*>(&peer), &length, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                std::cerr << "BGP: accept failed: " << strerror(errno) << std::endl;
+            }
+            return;
+        }
+        auto session = sessions_.find(format_ipv4(ntohl(peer.sin_addr.s_addr)));
+        if (session == sessions_.end()) {
+            // Not a configured neighbor
+            close(fd);
+            continue;
+        }
+        session->second->accept(fd);
+    }
+}
+
+void BGPProtocol::create_session(const BGPNeighbor& neighbor) {
+    BGPSessionConfig session_config;
+    {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        session_config.local_as = config_.local_as;
+        parse_ipv4(config_.router_id, session_config.router_id);
+        session_config.connect_retry_time = config_.connect_retry_time;
+    }
+    session_config.peer_address = neighbor.address;
+    session_config.peer_port = neighbor.port;
+    session_config.peer_as = neighbor.as_number;
+    session_config.hold_time = static_cast<uint16_t>(neighbor.hold_time);
+    session_config.passive = neighbor.passive;
+
+    const std::string address = neighbor.address;
+    auto session = std::make_unique<BGPSession>(
+        loop_, session_config,
+        [this, address](const uint8_t* body, size_t length) {
+            return process_update_message(address, body, length);
+        },
+        [this, address](BGPState from, BGPState to) { on_session_state(address, from, to); });
+    BGPSession* started = session.get();
+    {
+        std::lock_guard<std::mutex> lock(neighbors_mutex_);
+        sessions_[address] = std::move(session);
+    }
+    // State callbacks take neighbors_mutex_
+    started->start();
+}
+
+void BGPProtocol::on_session_state(const std::string& neighbor_address, BGPState from, BGPState to) {
+    auto session = sessions_.find(neighbor_address);
+    NeighborInfo info;
+    {
+        std::lock_guard<std::mutex> lock(neighbors_mutex_);
+        auto it = neighbors_.find(neighbor_address);
+        if (it != neighbors_.end()) {
+            BGPNeighbor& neighbor = it->second;
+            neighbor.state = bgp_state_name(to);
+            if (session != sessions_.end()) {
+                neighbor.last_error = session->second->last_error();
+                if (to == BGPState::ESTABLISHED) {
+                    neighbor.hold_time = session->second->negotiated_hold_time();
+                    neighbor.keepalive_interval = neighbor.hold_time / 3;
+                    neighbor.last_hello = std::chrono::steady_clock::now();
+                    neighbor.capabilities["four_octet_as"] = session->second->four_octet_as() ? "true" : "false";
+                }
+            }
+            info.address = neighbor.address;
+            info.state = neighbor.state;
+            info.hold_time = neighbor.hold_time;
+            info.capabilities = neighbor.capabilities;
+        }
+    }
+    info.protocol = "BGP";
+
+    if (to == BGPState::ESTABLISHED) {
+        {
+            std::lock_guard<std::mutex> lock(statistics_mutex_);
+            statistics_.neighbor_up_count++;
+        }
+        std::cout << "BGP: Neighbor " << neighbor_address << " established\n";
+        // Its Adj-RIB-Out starts as the whole Loc-RIB. The UPDATEs it is
+        // sent depend on iBGP and four-octet AS numbers alone, unless update
+        // groups are off and each peer is a policy of its own.
+        uint32_t peer = 0;
+        if (session != sessions_.end() && parse_ipv4(neighbor_address, peer)) {
+            const BGPSessionConfig& session_config = session->second->config();
+            bool update_groups;
+            {
+                std::lock_guard<std::mutex> lock(config_mutex_);
+                update_groups = config_.update_groups;
+            }
+            uint32_t export_policy = !update_groups ? peer : session->second->four_octet_as() ? 1 : 0;
+            std::lock_guard<std::mutex> lock(routes_mutex_);
+            rib_.add_peer(peer, session->second->peer_router_id(),
+                          session_config.peer_as != 0 && session_config.peer_as == session_config.local_as,
+                          export_policy);
+        }
+        schedule_export();
+        if (neighbor_callback_) {
+            neighbor_callback_(info, true);
+        }
+    } else if (from == BGPState::ESTABLISHED) {
+        {
+            std::lock_guard<std::mutex> lock(statistics_mutex_);
+            statistics_.neighbor_down_count++;
+        }
+        std::cout << "BGP: Neighbor " << neighbor_address << " down"
+                  << (session != sessions_.end() ? ": " + session->second->last_error() : "") << "\n";
+        // Its routes are withdrawn from the other peers at once
+        uint32_t peer = 0;
+        parse_ipv4(neighbor_address, peer);
+        {
+            std::lock_guard<std::mutex> lock(routes_mutex_);
+            rib_.remove_peer(peer);
+        }
+        export_routes();
+        if (neighbor_callback_) {
+            neighbor_callback_(info, false);
+        }
+    }
+}
+
 std::vector<std::string> BGPProtocol::get_advertised_routes() const {
     std::lock_guard<std::mutex> lock(routes_mutex_);
-    
+
     std::vector<std::string> result;
-    for (const auto& pair : advertised_routes_) {
-        result.push_back(pair.first);
+    for (const auto& route : rib_.adj_rib_in(BGPRib::LOCAL_PEER)) {
+        result.push_back(route_key(format_ipv4(route.prefix.address), route.prefix.length));
     }
     return result;
 }
 
 std::vector<std::string> BGPProtocol::get_learned_routes() const {
     std::lock_guard<std::mutex> lock(routes_mutex_);
-    
+
     std::vector<std::string> result;
-    for (const auto& pair : learned_routes_) {
-        result.push_back(pair.first);
+    for (const auto& route : rib_.loc_rib()) {
+        if (route.path.peer != BGPRib::LOCAL_PEER) {
+            result.push_back(route_key(format_ipv4(route.prefix.address), route.prefix.length));
+        }
     }
     return result;
 }
 
-bool BGPProtocol::advertise_route(const std::string& prefix, uint8_t prefix_length, 
+bool BGPProtocol::advertise_route(const std::string& prefix, uint8_t prefix_length,
                                  uint32_t metric) {
-    std::lock_guard<std::mutex> lock(routes_mutex_);
-    
-    BGPRoute route;
-    route.prefix = prefix;
-    route.prefix_length = prefix_length;
-    route.metric = metric;
-    route.is_valid = true;
-    
-    std::string key = prefix + "/" + std::to_string(prefix_length);
-    advertised_routes_[key] = route;
-    
-    std::cout << "BGP: Advertised route " << prefix << "/" 
+    uint32_t address;
+    if (prefix_length > 32 || !parse_ipv4(prefix, address)) {
+        return false;
+    }
+
+    BGPPathAttributes attributes;
+    attributes.has_med = true;
+    attributes.med = metric;
+    BGPAttributeRef interned = attribute_store_.intern(attributes);
+    {
+        std::lock_guard<std::mutex> lock(routes_mutex_);
+        rib_.update(BGPRib::LOCAL_PEER, RouterSim::Ipv4Prefix(address, prefix_length), std::move(interned));
+    }
+    {
+        std::lock_guard<std::mutex> lock(statistics_mutex_);
+        statistics_.routes_advertised++;
+    }
+
+    if (running_.load()) {
+        loop_.post([this] { schedule_export(); });
+    }
+
+    std::cout << "BGP: Advertised route " << prefix << "/"
               << static_cast<int>(prefix_length) << " with metric " << metric << "\n";
     return true;
 }
 
 bool BGPProtocol::withdraw_route(const std::string& prefix, uint8_t prefix_length) {
-    std::lock_guard<std::mutex> lock(routes_mutex_);
-    
-    std::string key = prefix + "/" + std::to_string(prefix_length);
-    auto it = advertised_routes_.find(key);
-    if (it == advertised_routes_.end()) {
+    uint32_t address;
+    if (prefix_length > 32 || !parse_ipv4(prefix, address)) {
         return false;
     }
+    {
+        std::lock_guard<std::mutex> lock(routes_mutex_);
+        if (!rib_.withdraw(BGPRib::LOCAL_PEER, RouterSim::Ipv4Prefix(address, prefix_length))) {
+            return false;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(statistics_mutex_);
+        statistics_.routes_withdrawn++;
+    }
 
-    advertised_routes_.erase(it);
-    std::cout << "BGP: Withdrew route " << prefix << "/" 
+    if (running_.load()) {
+        loop_.post([this] { schedule_export(); });
+    }
+
+    std::cout << "BGP: Withdrew route " << prefix << "/"
               << static_cast<int>(prefix_length) << "\n";
     return true;
 }
 
-void BGPProtocol::update_configuration(const ProtocolConfig& config) {
+void BGPProtocol::update_configuration(const std::map<std::string, std::string>& config) {
     std::lock_guard<std::mutex> lock(config_mutex_);
-    config_.parameters = config.parameters;
-    config_.enabled = config.enabled;
-    config_.update_interval_ms = config.update_interval_ms;
+    for (const auto& pair : config) {
+        config_.parameters[pair.first] = pair.second;
+    }
 }
 
-ProtocolConfig BGPProtocol::get_configuration() const {
+std::map<std::string, std::string> BGPProtocol::get_configuration() const {
     std::lock_guard<std::mutex> lock(config_mutex_);
-    
-    ProtocolConfig config;
-    config.parameters = config_.parameters;
-    config.enabled = config_.enabled;
-    config.update_interval_ms = config_.update_interval_ms;
-    return config;
+    return config_.parameters;
 }
 
 void BGPProtocol::set_route_update_callback(RouteUpdateCallback callback) {
@@ -184,66 +504,137 @@ void BGPProtocol::set_neighbor_callback(NeighborCallback callback) {
     neighbor_callback_ = callback;
 }
 
-bool BGPProtocol::add_neighbor(const std::string& address, uint32_t as_number) {
-    std::lock_guard<std::mutex> lock(neighbors_mutex_);
-    
+bool BGPProtocol::add_neighbor(const std::string& address, const std::map<std::string, std::string>& config) {
+    uint32_t parsed;
+    if (!parse_ipv4(address, parsed)) {
+        std::cerr << "BGP: invalid neighbor address " << address << std::endl;
+        return false;
+    }
+
     BGPNeighbor neighbor;
     neighbor.address = address;
-    neighbor.as_number = as_number;
+    neighbor.as_number = 0;
     neighbor.state = "Idle";
-    neighbor.hold_time = config_.hold_time;
-    neighbor.keepalive_interval = config_.keepalive_interval;
+    {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        neighbor.hold_time = config_.hold_time;
+        neighbor.keepalive_interval = config_.keepalive_interval;
+    }
     neighbor.messages_sent = 0;
     neighbor.messages_received = 0;
     neighbor.last_error = "";
+    neighbor.port = BGP_PORT;
+    neighbor.passive = false;
+
+    auto it = config.find("remote_as");
+    if (it != config.end()) {
+        neighbor.as_number = std::stoul(it->second);
+    }
+    it = config.find("port");
+    if (it != config.end()) {
+        neighbor.port = static_cast<uint16_t>(std::stoul(it->second));
+    }
+    it = config.find("passive");
+    if (it != config.end()) {
+        neighbor.passive = it->second == "true" || it->second == "1";
+    }
+    it = config.find("hold_time");
+    if (it != config.end()) {
+        neighbor.hold_time = std::stoul(it->second);
+    }
 
-    neighbors_[address] = neighbor;
-    config_.neighbors.push_back(address);
-    config_.neighbor_as[address] = as_number;
-    
-    std::cout << "BGP: Added neighbor " << address << " with AS " << as_number << "\n";
+    {
+        std::lock_guard<std::mutex> lock(neighbors_mutex_);
+        if (neighbors_.count(address)) {
+            return false;
+        }
+        neighbors_[address] = neighbor;
+    }
+    {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        config_.neighbors.push_back(address);
+        config_.neighbor_as[address] = neighbor.as_number;
+    }
+
+    if (running_.load()) {
+        loop_.post([this, neighbor] { create_session(neighbor); });
+    }
+
+    std::cout << "BGP: Added neighbor " << address << " with AS " << neighbor.as_number << "\n";
     return true;
 }
 
 bool BGPProtocol::remove_neighbor(const std::string& address) {
-    std::lock_guard<std::mutex> lock(neighbors_mutex_);
-    
-    auto it = neighbors_.find(address);
-    if (it == neighbors_.end()) {
-        return false;
+    {
+        std::lock_guard<std::mutex> lock(neighbors_mutex_);
+        auto it = neighbors_.find(address);
+        if (it == neighbors_.end()) {
+            return false;
+        }
+        neighbors_.erase(it);
+    }
+    {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        auto config_it = std::find(config_.neighbors.begin(), config_.neighbors.end(), address);
+        if (config_it != config_.neighbors.end()) {
+            config_.neighbors.erase(config_it);
+        }
+        config_.neighbor_as.erase(address);
     }
 
-    neighbors_.erase(it);
-    
-    // Remove from config
-    auto config_it = std::find(config_.neighbors.begin(), config_.neighbors.end(), address);
-    if (config_it != config_.neighbors.end()) {
-        config_.neighbors.erase(config_it);
+    if (running_.load()) {
+        loop_.post([this, address] {
+            auto it = sessions_.find(address);
+            if (it == sessions_.end()) {
+                return;
+            }
+            it->second->stop();
+            std::unique_ptr<BGPSession> session;
+            {
+                std::lock_guard<std::mutex> lock(neighbors_mutex_);
+                session = std::move(it->second);
+                sessions_.erase(it);
+            }
+        });
     }
-    config_.neighbor_as.erase(address);
-    
+
     std::cout << "BGP: Removed neighbor " << address << "\n";
     return true;
 }
 
-std::vector<BGPNeighbor> BGPProtocol::get_neighbors() const {
+std::vector<NeighborInfo> BGPProtocol::get_neighbors() const {
     std::lock_guard<std::mutex> lock(neighbors_mutex_);
-    
-    std::vector<BGPNeighbor> result;
+
+    std::vector<NeighborInfo> result;
     for (const auto& pair : neighbors_) {
-        result.push_back(pair.second);
+        NeighborInfo info;
+        info.address = pair.second.address;
+        info.protocol = "BGP";
+        info.state = pair.second.state;
+        info.last_hello = pair.second.last_hello;
+        info.hold_time = pair.second.hold_time;
+        info.capabilities = pair.second.capabilities;
+        info.attributes["remote_as"] = std::to_string(pair.second.as_number);
+        result.push_back(info);
     }
     return result;
 }
 
 BGPNeighbor BGPProtocol::get_neighbor(const std::string& address) const {
     std::lock_guard<std::mutex> lock(neighbors_mutex_);
-    
+
     auto it = neighbors_.find(address);
     if (it == neighbors_.end()) {
         return BGPNeighbor{};
     }
-    return it->second;
+    BGPNeighbor neighbor = it->second;
+    auto session = sessions_.find(address);
+    if (session != sessions_.end()) {
+        auto stats = session->second->get_statistics();
+        neighbor.messages_sent = stats.messages_sent;
+        neighbor.messages_received = stats.messages_received;
+    }
+    return neighbor;
 }
 
 bool BGPProtocol::set_export_policy(const std::string& policy_name, const std::string& policy_definition) {
@@ -258,22 +649,52 @@ bool BGPProtocol::set_import_policy(const std::string& policy_name, const std::s
     return true;
 }
 
-std::vector<BGPProtocol::BGPRoute> BGPProtocol::get_bgp_routes() const {
+std::vector<BGPRoute> BGPProtocol::get_bgp_routes() const {
     std::lock_guard<std::mutex> lock(routes_mutex_);
-    
+
     std::vector<BGPRoute> result;
-    for (const auto& pair : advertised_routes_) {
-        result.push_back(pair.second);
+    for (const auto& route : rib_.adj_rib_in(BGPRib::LOCAL_PEER)) {
+        result.push_back(bgp_route(route));
     }
-    for (const auto& pair : learned_routes_) {
-        result.push_back(pair.second);
+    for (const auto& route : rib_.loc_rib()) {
+        if (route.path.peer != BGPRib::LOCAL_PEER) {
+            result.push_back(bgp_route(route));
+        }
     }
     return result;
 }
 
+ProtocolStatistics BGPProtocol::get_statistics() const {
+    ProtocolStatistics stats;
+    {
+        std::lock_guard<std::mutex> lock(statistics_mutex_);
+        stats = statistics_;
+    }
+    std::lock_guard<std::mutex> lock(neighbors_mutex_);
+    for (const auto& pair : sessions_) {
+        auto session_stats = pair.second->get_statistics();
+        stats.messages_sent += session_stats.messages_sent;
+        stats.messages_received += session_stats.messages_received;
+    }
+    return stats;
+}
+
+RouterSim::EventLoop::Statistics BGPProtocol::get_event_loop_statistics() const {
+    return loop_.get_statistics();
+}
+
+BGPAttributeStore::Statistics BGPProtocol::get_attribute_statistics() const {
+    return attribute_store_.get_statistics();
+}
+
+BGPRib::Statistics BGPProtocol::get_rib_statistics() const {
+    std::lock_guard<std::mutex> lock(routes_mutex_);
+    return rib_.get_statistics();
+}
+
 bool BGPProtocol::apply_route_policy(const std::string& policy_name, BGPRoute& route) {
     std::lock_guard<std::mutex> lock(policies_mutex_);
-    
+
     auto it = export_policies_.find(policy_name);
     if (it == export_policies_.end()) {
         it = import_policies_.find(policy_name);
@@ -281,135 +702,177 @@ bool BGPProtocol::apply_route_policy(const std::string& policy_name, BGPRoute& r
             return false;
         }
     }
-    
+
     // TODO: Implement policy evaluation logic
+    (void)route;
     return true;
 }
 
-void BGPProtocol::bgp_main_loop() {
-    std::cout << "BGP main loop started\n";
-    
-    while (running_.load()) {
-        // Process incoming BGP messages
-        process_incoming_messages();
-        
-        // Send keepalive messages to established neighbors
-        send_keepalives();
-        
-        // Process route updates
-        process_route_updates();
-        
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+void BGPProtocol::schedule_export() {
+    if (export_scheduled_) {
+        return;
     }
-    
-    std::cout << "BGP main loop stopped\n";
-}
-
-void BGPProtocol::neighbor_management_loop() {
-    std::cout << "BGP neighbor management loop started\n";
-    
-    while (running_.load()) {
-        // TODO: Implement neighbor management
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    export_scheduled_ = true;
+    uint32_t interval_ms;
+    {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        interval_ms = config_.update_interval_ms;
     }
-    
-    std::cout << "BGP neighbor management loop stopped\n";
-}
-
-void BGPProtocol::route_processing_loop() {
-    std::cout << "BGP route processing loop started\n";
-    
-    while (running_.load()) {
-        // TODO: Implement route processing
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // Everything that comes in until then goes out in one batch
+    if (interval_ms > 0) {
+        loop_.schedule(uint64_t(interval_ms) * 1000000, [this] { export_routes(); });
+    } else {
+        loop_.post([this] { export_routes(); });
     }
-    
-    std::cout << "BGP route processing loop stopped\n";
 }
 
-bool BGPProtocol::establish_session(const std::string& neighbor_address) {
-    // TODO: Implement BGP session establishment
-    return true;
-}
-
-bool BGPProtocol::send_open_message(const std::string& neighbor_address) {
-    // TODO: Implement BGP OPEN message sending
-    return true;
-}
-
-bool BGPProtocol::send_keepalive(const std::string& neighbor_address) {
-    // TODO: Implement BGP KEEPALIVE message sending
-    return true;
-}
-
-bool BGPProtocol::send_update_message(const std::string& neighbor_address, 
-                                     const std::vector<BGPRoute>& routes) {
-    // TODO: Implement BGP UPDATE message sending
-    return true;
-}
-
-void BGPProtocol::process_bgp_message(const std::string& neighbor_address, 
-                                     const std::vector<uint8_t>& message) {
-    // TODO: Implement BGP message processing
-}
-
-void BGPProtocol::process_open_message(const std::string& neighbor_address, 
-                                      const std::vector<uint8_t>& message) {
-    // TODO: Implement BGP OPEN message processing
-}
-
-void BGPProtocol::process_update_message(const std::string& neighbor_address, 
-                                        const std::vector<uint8_t>& message) {
-    // TODO: Implement BGP UPDATE message processing
-}
+void BGPProtocol::export_routes() {
+    export_scheduled_ = false;
+    std::vector<BGPBestPathChange> changes;
+    std::vector<BGPRibOutUpdate> updates;
+    {
+        std::lock_guard<std::mutex> lock(routes_mutex_);
+        rib_.run_decisions(changes);
+        BGPRibOutUpdate update;
+        for (uint32_t group : rib_.update_groups()) {
+            if (rib_.take_updates(group, update)) {
+                updates.push_back(std::move(update));
+            }
+        }
+    }
 
-void BGPProtocol::process_notification_message(const std::string& neighbor_address, 
-                                              const std::vector<uint8_t>& message) {
-    // TODO: Implement BGP NOTIFICATION message processing
+    // The FIB hears of learned best paths: a new one replaces the old
+    if (route_update_callback_) {
+        for (const auto& change : changes) {
+            if (change.best.attributes && change.best.peer != BGPRib::LOCAL_PEER) {
+                route_update_callback_(route_info(change.prefix, change.best, true), true);
+            } else if (change.previous.attributes && change.previous.peer != BGPRib::LOCAL_PEER) {
+                route_update_callback_(route_info(change.prefix, change.previous, false), false);
+            }
+        }
+    }
+    for (const auto& update : updates) {
+        send_update_message(update);
+    }
 }
 
-void BGPProtocol::process_incoming_messages() {
-    // Process incoming BGP messages from all neighbors
-    std::lock_guard<std::mutex> lock(neighbors_mutex_);
-    
-    for (auto& [address, neighbor] : neighbors_) {
-        if (neighbor.state == "Established") {
-            // Simulate receiving messages
-            // In a real implementation, this would read from network sockets
+bool BGPProtocol::send_update_message(const BGPRibOutUpdate& update) {
+    std::vector<BGPSession*> sessions;
+    for (uint32_t peer : update.peers) {
+        auto session = sessions_.find(format_ipv4(peer));
+        if (session != sessions_.end() && session->second->state() == BGPState::ESTABLISHED) {
+            sessions.push_back(session->second.get());
         }
     }
+    if (sessions.empty()) {
+        return false;
+    }
+    // The members differ in nothing the encoding depends on
+    const BGPSession& session = *sessions.front();
+    const BGPSessionConfig& session_config = session.config();
+    bool ibgp = session_config.peer_as != 0 && session_config.peer_as == session_config.local_as;
+
+    update_encoder_.set_four_octet_as(session.four_octet_as());
+    auto buffer = std::make_shared<std::vector<uint8_t>>();
+    size_t messages = update_encoder_.encode_withdrawals(update.withdrawn.data(), update.withdrawn.size(),
+                                                         *buffer);
+    uint64_t dropped = update_encoder_.prefixes_dropped();
+    for (const auto& group : update.announced) {
+        // Next hop self, our AS in front towards eBGP, LOCAL_PREF only over iBGP
+        BGPPathAttributes attributes = *group.first;
+        if (!ibgp) {
+            attributes.as_path.insert(attributes.as_path.begin(), session_config.local_as);
+        }
+        attributes.next_hop = session_config.router_id;
+        attributes.local_pref = ibgp && attributes.has_local_pref ? attributes.local_pref : BGP_DEFAULT_LOCAL_PREF;
+        attributes.has_local_pref = ibgp;
+        messages += update_encoder_.encode_announcements(attributes, group.second.data(), group.second.size(),
+                                                         *buffer);
+    }
+    if (update_encoder_.prefixes_dropped() > dropped) {
+        std::cerr << "BGP: " << update_encoder_.prefixes_dropped() - dropped << " prefixes not sent to "
+                  << sessions.size() << " peers from " << session_config.peer_address
+                  << ": path attributes exceed the UPDATE message size" << std::endl;
+    }
+    if (messages == 0) {
+        return true;
+    }
+    std::shared_ptr<const std::vector<uint8_t>> shared = std::move(buffer);
+    bool sent = true;
+    for (BGPSession* member : sessions) {
+        sent = member->send_updates(shared, messages) && sent;
+    }
+    return sent;
 }
 
-void BGPProtocol::send_keepalives() {
-    std::lock_guard<std::mutex> lock(neighbors_mutex_);
-    
-    auto now = std::chrono::steady_clock::now();
-    
-    for (auto& [address, neighbor] : neighbors_) {
-        if (neighbor.state == "Established") {
-            auto time_since_last_keepalive = std::chrono::duration_cast<std::chrono::seconds>(
-                now - neighbor.last_keepalive_sent).count();
-            
-            if (time_since_last_keepalive >= neighbor.keepalive_interval) {
-                send_keepalive(address);
-                neighbor.last_keepalive_sent = now;
-            }
+uint8_t BGPProtocol::process_update_message(const std::string& neighbor_address,
+                                           const uint8_t* message, size_t length) {
+    auto session = sessions_.find(neighbor_address);
+    if (session == sessions_.end()) {
+        return 0;
+    }
+    BGPUpdate& update = received_update_;
+    if (!update.parse(message, length, session->second->four_octet_as())) {
+        std::cerr << "BGP: Malformed UPDATE from " << neighbor_address << ": " << update.error_reason() << std::endl;
+        return static_cast<uint8_t>(update.error());
+    }
+
+    // IPv4 unicast may also come in the multiprotocol attributes
+    const BGPMpReach& mp_reach = update.mp_reach();
+    const BGPMpUnreach& mp_unreach = update.mp_unreach();
+    bool mp_ipv4 = update.has(BGPAttributeType::MP_REACH_NLRI) && mp_reach.afi == BGP_AFI_IPV4 &&
+                   mp_reach.safi == BGP_SAFI_UNICAST && mp_reach.next_hop_length == 4;
+    bool mp_ipv4_withdrawn = update.has(BGPAttributeType::MP_UNREACH_NLRI) && mp_unreach.afi == BGP_AFI_IPV4 &&
+                             mp_unreach.safi == BGP_SAFI_UNICAST;
+
+    BGPAttributeRef attributes;
+    if (!update.nlri().empty()) {
+        attributes = attribute_store_.intern(update, update.next_hop());
+    } else if (mp_ipv4) {
+        uint32_t next_hop = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            next_hop = (next_hop << 8) | mp_reach.next_hop[i];
         }
+        attributes = attribute_store_.intern(update, next_hop);
     }
-}
 
-void BGPProtocol::process_route_updates() {
-    std::lock_guard<std::mutex> lock(routes_mutex_);
-    
-    // Process route updates and apply policies
-    for (auto& [key, route] : advertised_routes_) {
-        if (route.is_valid && route_update_callback_) {
-            // Apply export policies
-            if (apply_route_policy("export", route)) {
-                route_update_callback_(route.prefix, route.prefix_length, route.metric);
+    // A path through our own AS is a loop (RFC 4271 9.1.2): as good as withdrawn
+    bool looped = update.as_path().contains(session->second->config().local_as);
+
+    // Only the Adj-RIB-In changes here; the decision process runs once the
+    // loop has taken in what else arrived with this UPDATE
+    uint32_t peer = 0;
+    parse_ipv4(neighbor_address, peer);
+    auto withdraw = [&](const BGPPrefixRange& prefixes) {
+        for (BGPPrefix prefix : prefixes) {
+            rib_.withdraw(peer, RouterSim::Ipv4Prefix(prefix.ipv4(), prefix.length));
+        }
+    };
+    auto announce = [&](const BGPPrefixRange& prefixes) {
+        for (BGPPrefix prefix : prefixes) {
+            rib_.update(peer, RouterSim::Ipv4Prefix(prefix.ipv4(), prefix.length), attributes);
+        }
+    };
+    {
+        std::lock_guard<std::mutex> lock(routes_mutex_);
+        withdraw(update.withdrawn());
+        if (mp_ipv4_withdrawn) {
+            withdraw(mp_unreach.withdrawn);
+        }
+        if (looped) {
+            withdraw(update.nlri());
+            if (mp_ipv4) {
+                withdraw(mp_reach.nlri);
+            }
+        } else {
+            announce(update.nlri());
+            if (mp_ipv4) {
+                announce(mp_reach.nlri);
             }
         }
     }
+    schedule_export();
+    return 0;
 }
 
 } // namespace router_sim
@@ -0,0 +1,250 @@
+#include "protocols/bgp_attributes.h"
+#include <mutex>
+
+namespace router_sim {
+
+struct BGPAttributeTable {
+    std::mutex mutex;
+    std::vector<BGPAttributeEntry*> buckets;    // power of two, chained through BGPAttributeEntry::next
+    size_t size = 0;
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
+    uint64_t list_bytes = 0;                    // AS path and community storage of the linked sets
+};
+
+namespace {
+
+const size_t INITIAL_BUCKETS = 1024;
+const uint64_t ABSENT = uint64_t(1) << 32;
+
+// Both forms of the attributes feed it the same sequence of values
+class Hasher {
+public:
+    void add(uint64_t value) {
+        hash_ = (hash_ ^ value) * 0x9e3779b97f4a7c15ull;
+        hash_ ^= hash_ >> 29;
+    }
+    uint64_t value() const { return hash_; }
+
+private:
+    uint64_t hash_ = 0xcbf29ce484222325ull;
+};
+
+size_t list_bytes(const BGPPathAttributes& attributes) {
+    return (attributes.as_path.capacity() + attributes.communities.capacity()) * sizeof(uint32_t);
+}
+
+void unlink(BGPAttributeTable& table, BGPAttributeEntry* entry) {
+    BGPAttributeEntry** link = &table.buckets[entry->hash & (table.buckets.size() - 1)];
+    while (*link != entry) {
+        link = &(*link)->next;
+    }
+    *link = entry->next;
+    entry->linked = false;
+    table.size--;
+    table.list_bytes -= list_bytes(entry->attributes);
+}
+
+void grow(BGPAttributeTable& table) {
+    std::vector<BGPAttributeEntry*> buckets(table.buckets.size() * 2, nullptr);
+    for (BGPAttributeEntry* head : table.buckets) {
+        while (head) {
+            BGPAttributeEntry* next = head->next;
+            BGPAttributeEntry*& bucket = buckets[head->hash & (buckets.size() - 1)];
+            head->next = bucket;
+            bucket = head;
+            head = next;
+        }
+    }
+    table.buckets.swap(buckets);
+}
+
+// The set equal(...) accepts, or a new one from make(); under the table's mutex
+template <typename Equal, typename Make>
+BGPAttributeEntry* find_or_add(const std::shared_ptr<BGPAttributeTable>& table, uint64_t hash,
+                               uint32_t as_path_length, Equal equal, Make make) {
+    table->lookups++;
+    for (BGPAttributeEntry* entry = table->buckets[hash & (table->buckets.size() - 1)]; entry;
+         entry = entry->next) {
+        if (entry->hash != hash || entry->as_path_length != as_path_length || !equal(entry->attributes)) {
+            continue;
+        }
+        // Counted up only while still referenced: once its last reference
+        // is gone that reference's owner frees it, so it is replaced, not
+        // revived
+        uint32_t references = entry->references.load(std::memory_order_relaxed);
+        while (references > 0 &&
+               !entry->references.compare_exchange_weak(references, references + 1, std::memory_order_relaxed)) {
+        }
+        if (references > 0) {
+            table->hits++;
+            return entry;
+        }
+        unlink(*table, entry);
+        break;
+    }
+
+    BGPAttributeEntry* entry = new BGPAttributeEntry();
+    entry->attributes = make();
+    entry->as_path_length = as_path_length;
+    entry->hash = hash;
+    entry->references.store(1, std::memory_order_relaxed);
+    entry->linked = true;
+    entry->table = table;
+    if (table->size >= table->buckets.size()) {
+        grow(*table);
+    }
+    BGPAttributeEntry*& bucket = table->buckets[hash & (table->buckets.size() - 1)];
+    entry->next = bucket;
+    bucket = entry;
+    table->size++;
+    table->list_bytes += list_bytes(entry->attributes);
+    return entry;
+}
+
+void release_entry(BGPAttributeEntry* entry) {
+    {
+        std::lock_guard<std::mutex> lock(entry->table->mutex);
+        if (entry->linked) {
+            unlink(*entry->table, entry);
+        }
+    }
+    // May drop the last hold on a table whose store is gone
+    delete entry;
+}
+
+} // namespace
+
+bool operator==(const BGPPathAttributes& a, const BGPPathAttributes& b) {
+    return a.origin == b.origin && a.next_hop == b.next_hop && a.has_med == b.has_med &&
+           (!a.has_med || a.med == b.med) && a.has_local_pref == b.has_local_pref &&
+           (!a.has_local_pref || a.local_pref == b.local_pref) && a.as_path == b.as_path &&
+           a.communities == b.communities;
+}
+
+uint64_t hash_path_attributes(const BGPPathAttributes& attributes) {
+    Hasher hasher;
+    hasher.add(attributes.origin);
+    for (uint32_t as : attributes.as_path) {
+        hasher.add(as);
+    }
+    hasher.add(attributes.as_path.size());
+    hasher.add(attributes.next_hop);
+    hasher.add(attributes.has_med ? attributes.med : ABSENT);
+    hasher.add(attributes.has_local_pref ? attributes.local_pref : ABSENT);
+    for (uint32_t community : attributes.communities) {
+        hasher.add(community);
+    }
+    hasher.add(attributes.communities.size());
+    return hasher.value();
+}
+
+void BGPAttributeRef::reset() {
+    if (entry_ && entry_->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        release_entry(entry_);
+    }
+    entry_ = nullptr;
+}
+
+BGPAttributeStore::BGPAttributeStore() : table_(std::make_shared<BGPAttributeTable>()) {
+    table_->buckets.assign(INITIAL_BUCKETS, nullptr);
+}
+
+BGPAttributeStore::~BGPAttributeStore() = default;
+
+BGPAttributeRef BGPAttributeStore::intern(const BGPPathAttributes& attributes) {
+    uint64_t hash = hash_path_attributes(attributes);
+    // A single AS_SEQUENCE: every AS counts
+    uint32_t as_path_length = static_cast<uint32_t>(attributes.as_path.size());
+    std::lock_guard<std::mutex> lock(table_->mutex);
+    return BGPAttributeRef(find_or_add(
+        table_, hash, as_path_length, [&](const BGPPathAttributes& interned) { return interned == attributes; },
+        [&] {
+            BGPPathAttributes copy = attributes;
+            copy.as_path.shrink_to_fit();
+            copy.communities.shrink_to_fit();
+            copy.med = copy.has_med ? copy.med : 0;
+            copy.local_pref = copy.has_local_pref ? copy.local_pref : 0;
+            return copy;
+        }));
+}
+
+BGPAttributeRef BGPAttributeStore::intern(const BGPUpdate& update, uint32_t next_hop) {
+    bool has_med = update.has(BGPAttributeType::MULTI_EXIT_DISC);
+    bool has_local_pref = update.has(BGPAttributeType::LOCAL_PREF);
+    const BGPCommunities& communities = update.communities();
+
+    Hasher hasher;
+    hasher.add(update.origin());
+    size_t as_count = 0;
+    update.as_path().for_each([&](uint8_t, uint32_t as) {
+        hasher.add(as);
+        as_count++;
+    });
+    hasher.add(as_count);
+    hasher.add(next_hop);
+    hasher.add(has_med ? update.med() : ABSENT);
+    hasher.add(has_local_pref ? update.local_pref() : ABSENT);
+    for (size_t i = 0; i < communities.size(); ++i) {
+        hasher.add(communities[i]);
+    }
+    hasher.add(communities.size());
+
+    auto equal = [&](const BGPPathAttributes& interned) {
+        if (interned.origin != update.origin() || interned.next_hop != next_hop || interned.has_med != has_med ||
+            interned.med != update.med() || interned.has_local_pref != has_local_pref ||
+            interned.local_pref != update.local_pref() || interned.as_path.size() != as_count ||
+            interned.communities.size() != communities.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < communities.size(); ++i) {
+            if (interned.communities[i] != communities[i]) {
+                return false;
+            }
+        }
+        size_t i = 0;
+        bool same = true;
+        update.as_path().for_each([&](uint8_t, uint32_t as) { same = same && interned.as_path[i++] == as; });
+        return same;
+    };
+    auto make = [&] {
+        BGPPathAttributes attributes;
+        attributes.origin = update.origin();
+        attributes.as_path.reserve(as_count);
+        update.as_path().append_to(attributes.as_path);
+        attributes.next_hop = next_hop;
+        attributes.has_med = has_med;
+        attributes.med = update.med();
+        attributes.has_local_pref = has_local_pref;
+        attributes.local_pref = update.local_pref();
+        attributes.communities.reserve(communities.size());
+        for (size_t i = 0; i < communities.size(); ++i) {
+            attributes.communities.push_back(communities[i]);
+        }
+        return attributes;
+    };
+
+    // Paths that flatten alike but count differently, a set against a
+    // sequence of the same ASes, are different sets
+    uint32_t as_path_length = static_cast<uint32_t>(update.as_path().length());
+    std::lock_guard<std::mutex> lock(table_->mutex);
+    return BGPAttributeRef(find_or_add(table_, hasher.value(), as_path_length, equal, make));
+}
+
+size_t BGPAttributeStore::size() const {
+    std::lock_guard<std::mutex> lock(table_->mutex);
+    return table_->size;
+}
+
+BGPAttributeStore::Statistics BGPAttributeStore::get_statistics() const {
+    std::lock_guard<std::mutex> lock(table_->mutex);
+    Statistics stats;
+    stats.sets = table_->size;
+    stats.lookups = table_->lookups;
+    stats.hits = table_->hits;
+    stats.memory_bytes = table_->size * sizeof(BGPAttributeEntry) + table_->list_bytes +
+                         table_->buckets.capacity() * sizeof(BGPAttributeEntry*);
+    return stats;
+}
+
+} // namespace router_sim
@@ -0,0 +1,392 @@
+#include "protocols/bgp_rib.h"
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+namespace router_sim {
+
+namespace {
+
+uint64_t prefix_key(const RouterSim::Ipv4Prefix& prefix) {
+    return (uint64_t(prefix.address) << 8) | prefix.length;
+}
+
+RouterSim::Ipv4Prefix key_prefix(uint64_t key) {
+    return RouterSim::Ipv4Prefix(static_cast<uint32_t>(key >> 8), static_cast<uint8_t>(key));
+}
+
+uint32_t local_pref(const BGPRibPath& path) {
+    return path.ibgp && path.attributes->has_local_pref ? path.attributes->local_pref : BGP_DEFAULT_LOCAL_PREF;
+}
+
+uint32_t med(const BGPRibPath& path) {
+    return path.attributes->has_med ? path.attributes->med : 0;
+}
+
+uint32_t neighbor_as(const BGPRibPath& path) {
+    return path.attributes->as_path.empty() ? 0 : path.attributes->as_path.front();
+}
+
+// Keeps the candidates with the lowest key
+template <typename Key>
+void keep_lowest(std::vector<const BGPRibPath*>& candidates, Key key) {
+    if (candidates.size() < 2) {
+        return;
+    }
+    auto lowest = key(*candidates.front());
+    for (const BGPRibPath* path : candidates) {
+        lowest = std::min(lowest, key(*path));
+    }
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                    [&](const BGPRibPath* path) { return key(*path) != lowest; }),
+                     candidates.end());
+}
+
+std::vector<BGPRibRoute> sorted(std::vector<BGPRibRoute> routes) {
+    std::sort(routes.begin(), routes.end(), [](const BGPRibRoute& a, const BGPRibRoute& b) {
+        return prefix_key(a.prefix) < prefix_key(b.prefix);
+    });
+    return routes;
+}
+
+} // namespace
+
+BGPRib::BGPRib() : next_group_(1), paths_(0), decisions_(0), best_path_changes_(0) {
+    peers_[LOCAL_PEER] = Peer{0, false, 0, {}};
+}
+
+bool BGPRib::add_peer(uint32_t peer, uint32_t router_id, bool ibgp, uint32_t export_policy) {
+    if (peer == LOCAL_PEER || peers_.count(peer)) {
+        return false;
+    }
+    Peer& added = peers_[peer];
+    added.router_id = router_id;
+    added.ibgp = ibgp;
+
+    // A group not sent anything yet still has the whole table queued
+    for (auto& pair : groups_) {
+        UpdateGroup& group = pair.second;
+        if (!group.sent && group.ibgp == ibgp && group.export_policy == export_policy) {
+            group.peers.push_back(peer);
+            added.group = pair.first;
+            return true;
+        }
+    }
+    added.group = next_group_++;
+    UpdateGroup& group = groups_[added.group];
+    group.ibgp = ibgp;
+    group.export_policy = export_policy;
+    group.sent = false;
+    group.peers.push_back(peer);
+    group.pending.reserve(destinations_.size());
+    for (const auto& pair : destinations_) {
+        if (pair.second.best.attributes) {
+            group.pending.push_back(pair.first);
+        }
+    }
+    return true;
+}
+
+bool BGPRib::remove_peer(uint32_t peer) {
+    auto it = peers_.find(peer);
+    if (peer == LOCAL_PEER || it == peers_.end()) {
+        return false;
+    }
+    for (uint64_t key : it->second.adj_rib_in) {
+        Destination& destination = destinations_[key];
+        auto path = std::find_if(destination.paths.begin(), destination.paths.end(),
+                                 [&](const BGPRibPath& candidate) { return candidate.peer == peer; });
+        if (path != destination.paths.end()) {
+            *path = std::move(destination.paths.back());
+            destination.paths.pop_back();
+            paths_--;
+        }
+        touch(key, destination);
+    }
+    auto group = groups_.find(it->second.group);
+    if (group != groups_.end()) {
+        auto& members = group->second.peers;
+        members.erase(std::find(members.begin(), members.end(), peer));
+        if (members.empty()) {
+            groups_.erase(group);
+        }
+    }
+    peers_.erase(it);
+    return true;
+}
+
+uint32_t BGPRib::group_of(uint32_t peer) const {
+    auto it = peers_.find(peer);
+    return it == peers_.end() ? 0 : it->second.group;
+}
+
+std::vector<uint32_t> BGPRib::update_groups() const {
+    std::vector<uint32_t> groups;
+    for (const auto& pair : groups_) {
+        groups.push_back(pair.first);
+    }
+    std::sort(groups.begin(), groups.end());
+    return groups;
+}
+
+bool BGPRib::update(uint32_t peer, const RouterSim::Ipv4Prefix& prefix, BGPAttributeRef attributes) {
+    auto from = peers_.find(peer);
+    if (from == peers_.end() || !attributes) {
+        return false;
+    }
+    uint64_t key = prefix_key(prefix);
+    Destination& destination = destinations_[key];
+    auto path = std::find_if(destination.paths.begin(), destination.paths.end(),
+                             [&](const BGPRibPath& candidate) { return candidate.peer == peer; });
+    if (path == destination.paths.end()) {
+        BGPRibPath added;
+        added.peer = peer;
+        added.ibgp = from->second.ibgp;
+        added.attributes = std::move(attributes);
+        destination.paths.push_back(std::move(added));
+        from->second.adj_rib_in.insert(key);
+        paths_++;
+    } else if (path->attributes != attributes) {
+        path->attributes = std::move(attributes);
+    } else {
+        return true;                            // implicit re-announcement of the same path
+    }
+    touch(key, destination);
+    return true;
+}
+
+bool BGPRib::withdraw(uint32_t peer, const RouterSim::Ipv4Prefix& prefix) {
+    uint64_t key = prefix_key(prefix);
+    auto from = peers_.find(peer);
+    auto destination = destinations_.find(key);
+    if (from == peers_.end() || destination == destinations_.end()) {
+        return false;
+    }
+    auto& paths = destination->second.paths;
+    auto path = std::find_if(paths.begin(), paths.end(),
+                             [&](const BGPRibPath& candidate) { return candidate.peer == peer; });
+    if (path == paths.end()) {
+        return false;
+    }
+    *path = std::move(paths.back());
+    paths.pop_back();
+    paths_--;
+    from->second.adj_rib_in.erase(key);
+    touch(key, destination->second);
+    return true;
+}
+
+void BGPRib::touch_all() {
+    for (auto& pair : destinations_) {
+        touch(pair.first, pair.second);
+    }
+}
+
+void BGPRib::touch(uint64_t key, Destination& destination) {
+    if (!destination.touched) {
+        destination.touched = true;
+        touched_.push_back(key);
+    }
+}
+
+size_t BGPRib::run_decisions(std::vector<BGPBestPathChange>& changes) {
+    size_t changed = 0;
+    for (uint64_t key : touched_) {
+        auto it = destinations_.find(key);
+        if (it == destinations_.end()) {
+            continue;
+        }
+        Destination& destination = it->second;
+        destination.touched = false;
+        decisions_++;
+
+        const BGPRibPath* best = select_best(destination.paths);
+        BGPRibPath selected = best ? *best : BGPRibPath();
+        if (selected.peer != destination.best.peer || selected.attributes != destination.best.attributes) {
+            BGPBestPathChange change;
+            change.prefix = key_prefix(key);
+            change.previous = std::move(destination.best);
+            change.best = selected;
+            changes.push_back(std::move(change));
+            destination.best = std::move(selected);
+            changed++;
+            for (auto& pair : groups_) {
+                pair.second.pending.push_back(key);
+            }
+        }
+        if (destination.paths.empty()) {
+            destinations_.erase(it);
+        }
+    }
+    touched_.clear();
+    best_path_changes_ += changed;
+    return changed;
+}
+
+// The decision process of RFC 4271 9.1.2.2, after our own routes. Every
+// step keeps the paths it prefers and the next one breaks their tie; IGP
+// cost to the next hop is skipped, as there is none to go by.
+const BGPRibPath* BGPRib::select_best(const std::vector<BGPRibPath>& paths) {
+    if (paths.size() < 2) {
+        return paths.empty() ? nullptr : &paths.front();
+    }
+    candidates_.clear();
+    for (const BGPRibPath& path : paths) {
+        candidates_.push_back(&path);
+    }
+    keep_lowest(candidates_, [](const BGPRibPath& path) { return path.peer == LOCAL_PEER ? 0 : 1; });
+    keep_lowest(candidates_, [](const BGPRibPath& path) {
+        return std::numeric_limits<uint32_t>::max() - local_pref(path);
+    });
+    keep_lowest(candidates_, [](const BGPRibPath& path) { return path.attributes.as_path_length(); });
+    keep_lowest(candidates_, [](const BGPRibPath& path) { return path.attributes->origin; });
+
+    // MED only compares paths from the same neighboring AS
+    if (candidates_.size() > 1) {
+        auto beaten = [this](const BGPRibPath* path) {
+            for (const BGPRibPath* other : candidates_) {
+                if (neighbor_as(*other) == neighbor_as(*path) && med(*other) < med(*path)) {
+                    return true;
+                }
+            }
+            return false;
+        };
+        kept_.clear();
+        std::copy_if(candidates_.begin(), candidates_.end(), std::back_inserter(kept_),
+                     [&](const BGPRibPath* path) { return !beaten(path); });
+        candidates_.swap(kept_);
+    }
+
+    keep_lowest(candidates_, [](const BGPRibPath& path) { return path.ibgp ? 1 : 0; });
+    keep_lowest(candidates_, [this](const BGPRibPath& path) {
+        auto peer = peers_.find(path.peer);
+        return peer == peers_.end() ? std::numeric_limits<uint32_t>::max() : peer->second.router_id;
+    });
+    keep_lowest(candidates_, [](const BGPRibPath& path) { return path.peer; });
+    return candidates_.front();
+}
+
+BGPAttributeRef BGPRib::exported(uint64_t key, const UpdateGroup& to) const {
+    auto it = destinations_.find(key);
+    if (it == destinations_.end() || !it->second.best.attributes) {
+        return BGPAttributeRef();
+    }
+    const BGPRibPath& best = it->second.best;
+    if (best.ibgp && to.ibgp) {
+        return BGPAttributeRef();
+    }
+    return best.attributes;
+}
+
+bool BGPRib::take_updates(uint32_t group, BGPRibOutUpdate& update) {
+    update.peers.clear();
+    update.withdrawn.clear();
+    update.announced.clear();
+    auto it = groups_.find(group);
+    if (it == groups_.end()) {
+        return false;
+    }
+    UpdateGroup& to = it->second;
+    update.peers = to.peers;
+    groups_by_attributes_.clear();
+    for (uint64_t key : to.pending) {
+        BGPAttributeRef attributes = exported(key, to);
+        auto sent = to.adj_rib_out.find(key);
+        if (sent == to.adj_rib_out.end() ? !attributes : sent->second == attributes) {
+            continue;                           // already queued, or changed back
+        }
+        if (!attributes) {
+            to.adj_rib_out.erase(sent);
+            update.withdrawn.push_back(key_prefix(key));
+            continue;
+        }
+        auto run = groups_by_attributes_.emplace(attributes.get(), update.announced.size());
+        if (run.second) {
+            update.announced.emplace_back(attributes, std::vector<RouterSim::Ipv4Prefix>());
+        }
+        update.announced[run.first->second].second.push_back(key_prefix(key));
+        if (sent == to.adj_rib_out.end()) {
+            to.adj_rib_out.emplace(key, std::move(attributes));
+        } else {
+            sent->second = std::move(attributes);
+        }
+    }
+    to.pending.clear();
+    to.sent = true;
+    bool changed = !update.empty();
+    merge_group(group);
+    return changed;
+}
+
+// Two groups of one policy with nothing queued both hold the export of the
+// Loc-RIB as it is now: the same Adj-RIB-Out, so one can go
+void BGPRib::merge_group(uint32_t group) {
+    UpdateGroup& from = groups_.at(group);
+    for (auto& pair : groups_) {
+        UpdateGroup& into = pair.second;
+        if (pair.first == group || !into.sent || !into.pending.empty() || into.ibgp != from.ibgp ||
+            into.export_policy != from.export_policy) {
+            continue;
+        }
+        for (uint32_t peer : from.peers) {
+            peers_[peer].group = pair.first;
+            into.peers.push_back(peer);
+        }
+        groups_.erase(group);
+        return;
+    }
+}
+
+std::vector<BGPRibRoute> BGPRib::adj_rib_in(uint32_t peer) const {
+    std::vector<BGPRibRoute> routes;
+    auto it = peers_.find(peer);
+    if (it == peers_.end()) {
+        return routes;
+    }
+    for (uint64_t key : it->second.adj_rib_in) {
+        for (const BGPRibPath& path : destinations_.at(key).paths) {
+            if (path.peer == peer) {
+                routes.push_back({key_prefix(key), path});
+            }
+        }
+    }
+    return sorted(std::move(routes));
+}
+
+std::vector<BGPRibRoute> BGPRib::loc_rib() const {
+    std::vector<BGPRibRoute> routes;
+    for (const auto& pair : destinations_) {
+        if (pair.second.best.attributes) {
+            routes.push_back({key_prefix(pair.first), pair.second.best});
+        }
+    }
+    return sorted(std::move(routes));
+}
+
+std::vector<BGPRibRoute> BGPRib::adj_rib_out(uint32_t peer) const {
+    std::vector<BGPRibRoute> routes;
+    auto it = groups_.find(group_of(peer));
+    if (it == groups_.end()) {
+        return routes;
+    }
+    for (const auto& pair : it->second.adj_rib_out) {
+        BGPRibRoute route;
+        route.prefix = key_prefix(pair.first);
+        route.path.attributes = pair.second;
+        routes.push_back(std::move(route));
+    }
+    return sorted(std::move(routes));
+}
+
+BGPRib::Statistics BGPRib::get_statistics() const {
+    Statistics stats;
+    stats.prefixes = destinations_.size();
+    stats.paths = paths_;
+    stats.peers = peers_.size() - 1;
+    stats.update_groups = groups_.size();
+    stats.decisions = decisions_;
+    stats.best_path_changes = best_path_changes_;
+    return stats;
+}
+
+} // namespace router_sim
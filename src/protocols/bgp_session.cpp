@@ -0,0 +1,788 @@
+#include "protocols/bgp_session.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <random>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace router_sim {
+
+namespace {
+
+const uint64_t NS_PER_SECOND = 1000000000ull;
+const uint8_t BGP_VERSION = 4;
+// Hold time while waiting for the peer's OPEN (RFC 4271 section 8.2.2)
+const uint64_t OPEN_SENT_HOLD_TIME_NS = 240 * NS_PER_SECOND;
+const size_t READ_CHUNK = 65536;
+const uint16_t AS_TRANS = 23456;
+
+const uint8_t OPEN_PARAMETER_CAPABILITIES = 2;
+const uint8_t CAPABILITY_MULTIPROTOCOL = 1;
+const uint8_t CAPABILITY_FOUR_OCTET_AS = 65;
+
+// NOTIFICATION error codes and the subcodes used here
+const uint8_t MESSAGE_HEADER_ERROR = 1;
+const uint8_t CONNECTION_NOT_SYNCHRONIZED = 1;
+const uint8_t BAD_MESSAGE_LENGTH = 2;
+const uint8_t BAD_MESSAGE_TYPE = 3;
+const uint8_t OPEN_MESSAGE_ERROR = 2;
+const uint8_t UNSUPPORTED_VERSION_NUMBER = 1;
+const uint8_t BAD_PEER_AS = 2;
+const uint8_t BAD_BGP_IDENTIFIER = 3;
+const uint8_t UNACCEPTABLE_HOLD_TIME = 6;
+const uint8_t UPDATE_MESSAGE_ERROR = 3;
+const uint8_t HOLD_TIMER_EXPIRED = 4;
+const uint8_t FSM_ERROR = 5;
+const uint8_t CEASE = 6;
+const uint8_t ADMINISTRATIVE_SHUTDOWN = 2;
+const uint8_t CONNECTION_COLLISION_RESOLUTION = 7;
+
+uint16_t get_u16(const uint8_t* data) {
+    return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+
+uint32_t get_u32(const uint8_t* data) {
+    return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | data[3];
+}
+
+void put_u16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void put_u32(std::vector<uint8_t>& out, uint32_t value) {
+    put_u16(out, static_cast<uint16_t>(value >> 16));
+    put_u16(out, static_cast<uint16_t>(value));
+}
+
+// One message, header included, on the end of out
+void put_message(std::vector<uint8_t>& out, BGPMessageType type, const uint8_t* body, size_t length) {
+    out.insert(out.end(), 16, 0xff);
+    put_u16(out, static_cast<uint16_t>(BGP_HEADER_SIZE + length));
+    out.push_back(static_cast<uint8_t>(type));
+    out.insert(out.end(), body, body + length);
+}
+
+// Our messages on a held connection go out in one write; it is new, so
+// its send buffer has room
+bool send_all(int fd, const std::vector<uint8_t>& bytes) {
+    return send(fd, bytes.data(), bytes.size(), MSG_NOSIGNAL | MSG_DONTWAIT) == ssize_t(bytes.size());
+}
+
+// KeepaliveTimer jitter: up to 25% shorter (RFC 4271 section 10), so
+// sessions brought up together do not keep sending in lockstep
+uint64_t jittered(uint64_t interval_ns) {
+    thread_local std::minstd_rand rng(std::random_device{}());
+    return interval_ns - interval_ns / 4 * (rng() % 1024) / 1024;
+}
+
+} // namespace
+
+const char* bgp_state_name(BGPState state) {
+    switch (state) {
+        case BGPState::IDLE: return "Idle";
+        case BGPState::CONNECT: return "Connect";
+        case BGPState::ACTIVE: return "Active";
+        case BGPState::OPEN_SENT: return "OpenSent";
+        case BGPState::OPEN_CONFIRM: return "OpenConfirm";
+        case BGPState::ESTABLISHED: return "Established";
+    }
+    return "Unknown";
+}
+
+BGPSession::BGPSession(RouterSim::EventLoop& loop, const BGPSessionConfig& config, UpdateCallback on_update,
+                       StateCallback on_state_change)
+    : loop_(loop), config_(config), on_update_(std::move(on_update)), on_state_change_(std::move(on_state_change)),
+      state_(BGPState::IDLE), started_(false), fd_(-1), inbound_(false), connecting_(false), want_write_(false),
+      connect_retry_timer_(RouterSim::TimerWheel::INVALID_TIMER), hold_timer_(RouterSim::TimerWheel::INVALID_TIMER),
+      keepalive_timer_(RouterSim::TimerWheel::INVALID_TIMER), last_received_ns_(0), hold_time_(0),
+      four_octet_as_(false), peer_router_id_(0), in_used_(0), out_sent_(0), collision_fd_(-1), messages_sent_(0),
+      messages_received_(0), updates_sent_(0), updates_received_(0), keepalives_sent_(0), keepalives_received_(0),
+      notifications_sent_(0), notifications_received_(0), established_transitions_(0), collisions_resolved_(0) {
+    // Zero, or at least three seconds
+    if (config_.hold_time > 0 && config_.hold_time < 3) {
+        config_.hold_time = 3;
+    }
+    config_.connect_retry_time = std::max<uint32_t>(config_.connect_retry_time, 1);
+}
+
+BGPSession::~BGPSession() {
+    cancel_timer(connect_retry_timer_);
+    cancel_timer(hold_timer_);
+    cancel_timer(keepalive_timer_);
+    close_connection();
+    close_collision();
+}
+
+void BGPSession::start() {
+    if (started_) {
+        return;
+    }
+    started_ = true;
+    if (config_.passive) {
+        set_state(BGPState::ACTIVE);
+    } else {
+        connect();
+    }
+}
+
+void BGPSession::stop() {
+    if (!started_) {
+        return;
+    }
+    started_ = false;
+    if (state_ == BGPState::OPEN_SENT || state_ == BGPState::OPEN_CONFIRM || state_ == BGPState::ESTABLISHED) {
+        send_notification(CEASE, ADMINISTRATIVE_SHUTDOWN);
+    }
+    close_connection();
+    close_collision();
+    cancel_timer(connect_retry_timer_);
+    cancel_timer(hold_timer_);
+    cancel_timer(keepalive_timer_);
+    set_state(BGPState::IDLE);
+}
+
+void BGPSession::set_state(BGPState state) {
+    if (state == state_) {
+        return;
+    }
+    BGPState from = state_;
+    state_ = state;
+    if (state == BGPState::ESTABLISHED) {
+        established_transitions_++;
+    }
+    if (on_state_change_) {
+        on_state_change_(from, state);
+    }
+}
+
+void BGPSession::connect() {
+    arm_connect_retry();
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(config_.peer_port);
+    if (inet_pton(AF_INET, config_.peer_address.c_str(), &address.sin_addr) != 1) {
+        last_error_ = "invalid neighbor address " + config_.peer_address;
+        set_state(BGPState::ACTIVE);
+        return;
+    }
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        last_error_ = std::string("socket: ") + strerror(errno);
+        set_state(BGPState::ACTIVE);
+        return;
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 && errno != EINPROGRESS) {
+        last_error_ = std::string("connect: ") + strerror(errno);
+        close(fd);
+        set_state(BGPState::ACTIVE);
+        return;
+    }
+
+    attach(fd, false);
+    // Writable once the handshake completes, either way
+    connecting_ = true;
+    want_write_ = true;
+    loop_.modify(fd_, EPOLLIN | EPOLLOUT);
+    set_state(BGPState::CONNECT);
+}
+
+bool BGPSession::accept(int fd) {
+    if (started_ && (state_ == BGPState::IDLE || state_ == BGPState::ACTIVE)) {
+        close_connection();
+        attach(fd, true);
+        on_connected();
+        return true;
+    }
+    if (started_ && !inbound_ && collision_fd_ < 0 &&
+        (state_ == BGPState::CONNECT || state_ == BGPState::OPEN_SENT || state_ == BGPState::OPEN_CONFIRM)) {
+        return hold_collision(fd);
+    }
+    close(fd);
+    return false;
+}
+
+void BGPSession::attach(int fd, bool inbound) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fd_ = fd;
+    inbound_ = inbound;
+    loop_.add(fd_, EPOLLIN, [this](uint32_t events) { on_io(events); });
+}
+
+void BGPSession::on_connected() {
+    cancel_timer(connect_retry_timer_);
+    connecting_ = false;
+    if (want_write_) {
+        loop_.modify(fd_, EPOLLIN);
+        want_write_ = false;
+    }
+    hold_time_ = config_.hold_time;
+    last_received_ns_ = loop_.now_ns();
+    int fd = fd_;
+    send_open();
+    if (fd_ != fd) {
+        return;
+    }
+    set_state(BGPState::OPEN_SENT);
+    arm_hold_timer(OPEN_SENT_HOLD_TIME_NS);
+}
+
+void BGPSession::on_io(uint32_t events) {
+    if (connecting_) {
+        int error = 0;
+        socklen_t length = sizeof(error);
+        getsockopt(fd_, SOL_SOCKET, SO_ERROR, &error, &length);
+        if (error != 0) {
+            last_error_ = std::string("connect: ") + strerror(error);
+            close_connection();
+            if (collision_fd_ >= 0) {
+                adopt_collision();
+                return;
+            }
+            // ConnectRetry is still running and tries again
+            set_state(BGPState::ACTIVE);
+            return;
+        }
+        on_connected();
+        return;
+    }
+    if (events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+        read_messages();
+        if (fd_ < 0) {
+            return;
+        }
+    }
+    if (events & EPOLLOUT) {
+        flush();
+    }
+}
+
+void BGPSession::read_messages() {
+    if (in_.size() < in_used_ + READ_CHUNK) {
+        in_.resize(in_used_ + READ_CHUNK);
+    }
+    ssize_t received = read(fd_, in_.data() + in_used_, in_.size() - in_used_);
+    if (received == 0) {
+        drop("connection closed by peer");
+        return;
+    }
+    if (received < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            drop(std::string("read: ") + strerror(errno));
+        }
+        return;
+    }
+    in_used_ += static_cast<size_t>(received);
+    last_received_ns_ = loop_.now_ns();
+    process_messages();
+}
+
+void BGPSession::process_messages() {
+    int fd = fd_;
+    size_t offset = 0;
+    while (in_used_ - offset >= BGP_HEADER_SIZE) {
+        const uint8_t* message = in_.data() + offset;
+        if (std::any_of(message, message + 16, [](uint8_t byte) { return byte != 0xff; })) {
+            send_notification(MESSAGE_HEADER_ERROR, CONNECTION_NOT_SYNCHRONIZED);
+            drop("bad message marker");
+            return;
+        }
+        uint16_t length = get_u16(message + 16);
+        if (length < BGP_HEADER_SIZE || length > BGP_MAX_MESSAGE_SIZE) {
+            send_notification(MESSAGE_HEADER_ERROR, BAD_MESSAGE_LENGTH);
+            drop("bad message length");
+            return;
+        }
+        if (in_used_ - offset < length) {
+            break;
+        }
+        messages_received_++;
+        handle_message(static_cast<BGPMessageType>(message[18]), message + BGP_HEADER_SIZE,
+                       length - BGP_HEADER_SIZE);
+        // Dropped, or given up for the peer's connection with its own input
+        if (fd_ != fd) {
+            return;
+        }
+        offset += length;
+    }
+    if (offset > 0) {
+        std::memmove(in_.data(), in_.data() + offset, in_used_ - offset);
+        in_used_ -= offset;
+    }
+}
+
+void BGPSession::handle_message(BGPMessageType type, const uint8_t* body, size_t length) {
+    switch (type) {
+        case BGPMessageType::OPEN:
+            if (state_ != BGPState::OPEN_SENT) {
+                send_notification(FSM_ERROR, 0);
+                drop("unexpected OPEN");
+                return;
+            }
+            handle_open(body, length);
+            return;
+
+        case BGPMessageType::KEEPALIVE:
+            keepalives_received_++;
+            if (length != 0) {
+                send_notification(MESSAGE_HEADER_ERROR, BAD_MESSAGE_LENGTH);
+                drop("bad KEEPALIVE length");
+                return;
+            }
+            if (state_ == BGPState::OPEN_CONFIRM) {
+                set_state(BGPState::ESTABLISHED);
+            } else if (state_ != BGPState::ESTABLISHED) {
+                send_notification(FSM_ERROR, 0);
+                drop("unexpected KEEPALIVE");
+            }
+            return;
+
+        case BGPMessageType::UPDATE:
+            if (state_ != BGPState::ESTABLISHED) {
+                send_notification(FSM_ERROR, 0);
+                drop("unexpected UPDATE");
+                return;
+            }
+            updates_received_++;
+            if (on_update_) {
+                uint8_t subcode = on_update_(body, length);
+                if (subcode != 0) {
+                    send_notification(UPDATE_MESSAGE_ERROR, subcode);
+                    drop("malformed UPDATE");
+                }
+            }
+            return;
+
+        case BGPMessageType::NOTIFICATION:
+            notifications_received_++;
+            drop(length >= 2 ? "NOTIFICATION " + std::to_string(body[0]) + "/" + std::to_string(body[1])
+                             : "NOTIFICATION");
+            return;
+    }
+    send_notification(MESSAGE_HEADER_ERROR, BAD_MESSAGE_TYPE);
+    drop("bad message type");
+}
+
+void BGPSession::handle_open(const uint8_t* body, size_t length) {
+    if (length < 10 || length != 10u + body[9]) {
+        send_notification(MESSAGE_HEADER_ERROR, BAD_MESSAGE_LENGTH);
+        drop("bad OPEN length");
+        return;
+    }
+    if (body[0] != BGP_VERSION) {
+        send_notification(OPEN_MESSAGE_ERROR, UNSUPPORTED_VERSION_NUMBER);
+        drop("unsupported BGP version " + std::to_string(body[0]));
+        return;
+    }
+    uint32_t peer_as = get_u16(body + 1);
+    uint16_t hold_time = get_u16(body + 3);
+    uint32_t router_id = get_u32(body + 5);
+
+    bool four_octet_as = false;
+    const uint8_t* parameter = body + 10;
+    const uint8_t* end = body + length;
+    while (end - parameter >= 2) {
+        uint8_t type = parameter[0];
+        const uint8_t* value = parameter + 2;
+        const uint8_t* next = value + parameter[1];
+        if (next > end) {
+            break;
+        }
+        for (const uint8_t* capability = value; type == OPEN_PARAMETER_CAPABILITIES && next - capability >= 2;
+             capability += 2 + capability[1]) {
+            if (capability[0] == CAPABILITY_FOUR_OCTET_AS && capability[1] == 4 && next - capability >= 6) {
+                peer_as = get_u32(capability + 2);
+                four_octet_as = true;
+            }
+        }
+        parameter = next;
+    }
+
+    if (config_.peer_as != 0 && peer_as != config_.peer_as) {
+        send_notification(OPEN_MESSAGE_ERROR, BAD_PEER_AS);
+        drop("bad peer AS " + std::to_string(peer_as));
+        return;
+    }
+    if (hold_time == 1 || hold_time == 2) {
+        send_notification(OPEN_MESSAGE_ERROR, UNACCEPTABLE_HOLD_TIME);
+        drop("unacceptable hold time");
+        return;
+    }
+    if (router_id == 0) {
+        send_notification(OPEN_MESSAGE_ERROR, BAD_BGP_IDENTIFIER);
+        drop("bad BGP identifier");
+        return;
+    }
+    if (collision_fd_ >= 0 && resolve_collision(router_id)) {
+        return;
+    }
+
+    four_octet_as_ = four_octet_as;
+    peer_router_id_ = router_id;
+    hold_time_ = std::min(config_.hold_time, hold_time);
+    int fd = fd_;
+    send_keepalive();
+    if (fd_ != fd) {
+        return;
+    }
+    set_state(BGPState::OPEN_CONFIRM);
+    if (hold_time_ > 0) {
+        arm_hold_timer(hold_time_ * NS_PER_SECOND);
+        arm_keepalive_timer();
+    } else {
+        cancel_timer(hold_timer_);
+    }
+}
+
+void BGPSession::send_message(BGPMessageType type, const uint8_t* body, size_t length) {
+    if (fd_ < 0) {
+        return;
+    }
+    put_message(own_chunk(), type, body, length);
+    messages_sent_++;
+    flush();
+}
+
+// Our messages go on the end of the last chunk when it is ours too
+std::vector<uint8_t>& BGPSession::own_chunk() {
+    if (out_.empty() || out_.back().shared) {
+        out_.emplace_back();
+    }
+    return out_.back().own;
+}
+
+std::vector<uint8_t> BGPSession::open_body() const {
+    std::vector<uint8_t> body;
+    body.push_back(BGP_VERSION);
+    put_u16(body, config_.local_as > 0xffff ? AS_TRANS : static_cast<uint16_t>(config_.local_as));
+    put_u16(body, config_.hold_time);
+    put_u32(body, config_.router_id);
+    // One capabilities parameter: IPv4 unicast and four-octet AS numbers
+    body.push_back(14);
+    body.push_back(OPEN_PARAMETER_CAPABILITIES);
+    body.push_back(12);
+    body.push_back(CAPABILITY_MULTIPROTOCOL);
+    body.push_back(4);
+    put_u16(body, 1);                           // AFI IPv4
+    body.push_back(0);
+    body.push_back(1);                          // SAFI unicast
+    body.push_back(CAPABILITY_FOUR_OCTET_AS);
+    body.push_back(4);
+    put_u32(body, config_.local_as);
+    return body;
+}
+
+void BGPSession::send_open() {
+    std::vector<uint8_t> body = open_body();
+    send_message(BGPMessageType::OPEN, body.data(), body.size());
+}
+
+void BGPSession::send_keepalive() {
+    keepalives_sent_++;
+    send_message(BGPMessageType::KEEPALIVE, nullptr, 0);
+}
+
+void BGPSession::send_notification(uint8_t code, uint8_t subcode) {
+    if (fd_ < 0) {
+        return;
+    }
+    notifications_sent_++;
+    const uint8_t body[2] = {code, subcode};
+    send_message(BGPMessageType::NOTIFICATION, body, sizeof(body));
+}
+
+bool BGPSession::send_update(const uint8_t* body, size_t length) {
+    if (state_ != BGPState::ESTABLISHED || BGP_HEADER_SIZE + length > BGP_MAX_MESSAGE_SIZE) {
+        return false;
+    }
+    updates_sent_++;
+    send_message(BGPMessageType::UPDATE, body, length);
+    return true;
+}
+
+bool BGPSession::send_updates(const uint8_t* messages, size_t length, size_t count) {
+    if (state_ != BGPState::ESTABLISHED || fd_ < 0) {
+        return false;
+    }
+    std::vector<uint8_t>& out = own_chunk();
+    out.insert(out.end(), messages, messages + length);
+    updates_sent_ += count;
+    messages_sent_ += count;
+    flush();
+    return true;
+}
+
+bool BGPSession::send_updates(std::shared_ptr<const std::vector<uint8_t>> messages, size_t count) {
+    if (state_ != BGPState::ESTABLISHED || fd_ < 0) {
+        return false;
+    }
+    if (messages && !messages->empty()) {
+        out_.emplace_back();
+        out_.back().shared = std::move(messages);
+    }
+    updates_sent_ += count;
+    messages_sent_ += count;
+    flush();
+    return true;
+}
+
+// One gathering write for as many chunks as it takes; sendmsg() rather
+// than writev() for MSG_NOSIGNAL
+void BGPSession::flush() {
+    constexpr size_t MAX_IOVECS = 64;
+    iovec iovecs[MAX_IOVECS];
+    while (!out_.empty()) {
+        size_t count = 0;
+        for (auto chunk = out_.begin(); chunk != out_.end() && count < MAX_IOVECS; ++chunk, ++count) {
+            const std::vector<uint8_t>& bytes = chunk->bytes();
+            size_t skip = count == 0 ? out_sent_ : 0;
+            iovecs[count].iov_base = const_cast<uint8_t*>(bytes.data()) + skip;
+            iovecs[count].iov_len = bytes.size() - skip;
+        }
+        msghdr message{};
+        message.msg_iov = iovecs;
+        message.msg_iovlen = count;
+        ssize_t sent = sendmsg(fd_, &message, MSG_NOSIGNAL);
+        if (sent > 0) {
+            for (size_t left = static_cast<size_t>(sent); left > 0;) {
+                size_t rest = out_.front().bytes().size() - out_sent_;
+                if (left < rest) {
+                    out_sent_ += left;
+                    break;
+                }
+                left -= rest;
+                out_.pop_front();
+                out_sent_ = 0;
+            }
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (!want_write_) {
+                loop_.modify(fd_, EPOLLIN | EPOLLOUT);
+                want_write_ = true;
+            }
+            return;
+        }
+        drop(std::string("send: ") + strerror(errno));
+        return;
+    }
+    out_sent_ = 0;
+    if (want_write_) {
+        loop_.modify(fd_, EPOLLIN);
+        want_write_ = false;
+    }
+}
+
+void BGPSession::drop(const std::string& error) {
+    last_error_ = error;
+    if (started_ && collision_fd_ >= 0) {
+        // The peer's connection is still up; carry on with that one
+        adopt_collision();
+        return;
+    }
+    close_connection();
+    cancel_timer(connect_retry_timer_);
+    cancel_timer(hold_timer_);
+    cancel_timer(keepalive_timer_);
+    four_octet_as_ = false;
+    set_state(BGPState::IDLE);
+    if (!started_) {
+        return;
+    }
+    if (config_.passive) {
+        set_state(BGPState::ACTIVE);
+    } else {
+        arm_connect_retry();
+    }
+}
+
+void BGPSession::close_connection() {
+    if (fd_ >= 0) {
+        loop_.remove(fd_);
+        close(fd_);
+        fd_ = -1;
+    }
+    inbound_ = false;
+    connecting_ = false;
+    want_write_ = false;
+    in_used_ = 0;
+    out_.clear();
+    out_sent_ = 0;
+}
+
+bool BGPSession::hold_collision(int fd) {
+    std::vector<uint8_t> body = open_body();
+    std::vector<uint8_t> open;
+    put_message(open, BGPMessageType::OPEN, body.data(), body.size());
+    if (!send_all(fd, open)) {
+        close(fd);
+        return false;
+    }
+    messages_sent_++;
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    collision_fd_ = fd;
+    collision_in_.clear();
+    loop_.add(fd, EPOLLIN, [this](uint32_t) { read_collision(); });
+    // In OpenConfirm the peer's identifier is already known
+    if (state_ == BGPState::OPEN_CONFIRM) {
+        resolve_collision(peer_router_id_);
+    }
+    return true;
+}
+
+// Only the peer's OPEN is expected until the collision is resolved; what
+// follows it stays buffered for when the connection is adopted
+void BGPSession::read_collision() {
+    size_t used = collision_in_.size();
+    collision_in_.resize(used + BGP_MAX_MESSAGE_SIZE);
+    ssize_t received = read(collision_fd_, collision_in_.data() + used, BGP_MAX_MESSAGE_SIZE);
+    collision_in_.resize(used + static_cast<size_t>(std::max<ssize_t>(received, 0)));
+    if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        close_collision();
+        return;
+    }
+    if (collision_in_.size() < BGP_HEADER_SIZE) {
+        return;
+    }
+    uint16_t length = get_u16(collision_in_.data() + 16);
+    if (collision_in_[18] != static_cast<uint8_t>(BGPMessageType::OPEN) || length < BGP_HEADER_SIZE + 10 ||
+        length > BGP_MAX_MESSAGE_SIZE) {
+        close_collision();
+        return;
+    }
+    if (collision_in_.size() >= length) {
+        resolve_collision(get_u32(collision_in_.data() + BGP_HEADER_SIZE + 5));
+    }
+}
+
+bool BGPSession::resolve_collision(uint32_t peer_router_id) {
+    collisions_resolved_++;
+    if (config_.router_id < peer_router_id) {
+        // Ours was opened by the lower identifier
+        if (!connecting_) {
+            send_notification(CEASE, CONNECTION_COLLISION_RESOLUTION);
+        }
+        adopt_collision();
+        return true;
+    }
+    const uint8_t body[2] = {CEASE, CONNECTION_COLLISION_RESOLUTION};
+    std::vector<uint8_t> notification;
+    put_message(notification, BGPMessageType::NOTIFICATION, body, sizeof(body));
+    if (send_all(collision_fd_, notification)) {
+        messages_sent_++;
+        notifications_sent_++;
+    }
+    close_collision();
+    return false;
+}
+
+// Our connection is closed and the held one takes its place in OpenSent,
+// the peer's messages so far processed as if just read
+void BGPSession::adopt_collision() {
+    if (collision_fd_ < 0) {
+        return;
+    }
+    int fd = collision_fd_;
+    collision_fd_ = -1;
+    loop_.remove(fd);
+    close_connection();
+    cancel_timer(connect_retry_timer_);
+    cancel_timer(keepalive_timer_);
+    four_octet_as_ = false;
+
+    attach(fd, true);
+    in_.swap(collision_in_);
+    in_used_ = in_.size();
+    collision_in_.clear();
+    hold_time_ = config_.hold_time;
+    last_received_ns_ = loop_.now_ns();
+    set_state(BGPState::OPEN_SENT);
+    arm_hold_timer(OPEN_SENT_HOLD_TIME_NS);
+    if (fd_ == fd) {
+        process_messages();
+    }
+}
+
+void BGPSession::close_collision() {
+    if (collision_fd_ >= 0) {
+        loop_.remove(collision_fd_);
+        close(collision_fd_);
+        collision_fd_ = -1;
+    }
+    collision_in_.clear();
+}
+
+void BGPSession::arm_connect_retry() {
+    cancel_timer(connect_retry_timer_);
+    connect_retry_timer_ = loop_.schedule(config_.connect_retry_time * NS_PER_SECOND, [this] {
+        connect_retry_timer_ = RouterSim::TimerWheel::INVALID_TIMER;
+        if (!started_ || config_.passive ||
+            (state_ != BGPState::IDLE && state_ != BGPState::CONNECT && state_ != BGPState::ACTIVE)) {
+            return;
+        }
+        close_connection();
+        connect();
+    });
+}
+
+void BGPSession::arm_hold_timer(uint64_t delay_ns) {
+    cancel_timer(hold_timer_);
+    hold_timer_ = loop_.schedule(delay_ns, [this] { on_hold_timer(); });
+}
+
+void BGPSession::on_hold_timer() {
+    hold_timer_ = RouterSim::TimerWheel::INVALID_TIMER;
+    uint64_t hold_ns = state_ == BGPState::OPEN_SENT ? OPEN_SENT_HOLD_TIME_NS : hold_time_ * NS_PER_SECOND;
+    uint64_t deadline = last_received_ns_ + hold_ns;
+    uint64_t now = loop_.now_ns();
+    if (now < deadline) {
+        // Heard from the peer since it was armed
+        arm_hold_timer(deadline - now);
+        return;
+    }
+    send_notification(HOLD_TIMER_EXPIRED, 0);
+    drop("hold timer expired");
+}
+
+void BGPSession::arm_keepalive_timer() {
+    cancel_timer(keepalive_timer_);
+    keepalive_timer_ = loop_.schedule(jittered(hold_time_ * NS_PER_SECOND / 3), [this] {
+        keepalive_timer_ = RouterSim::TimerWheel::INVALID_TIMER;
+        if (state_ != BGPState::OPEN_CONFIRM && state_ != BGPState::ESTABLISHED) {
+            return;
+        }
+        send_keepalive();
+        if (fd_ >= 0) {
+            arm_keepalive_timer();
+        }
+    });
+}
+
+void BGPSession::cancel_timer(RouterSim::EventLoop::TimerId& timer) {
+    if (timer != RouterSim::TimerWheel::INVALID_TIMER) {
+        loop_.cancel(timer);
+        timer = RouterSim::TimerWheel::INVALID_TIMER;
+    }
+}
+
+BGPSession::Statistics BGPSession::get_statistics() const {
+    return Statistics{messages_sent_.load(),      messages_received_.load(),      updates_sent_.load(),
+                      updates_received_.load(),   keepalives_sent_.load(),        keepalives_received_.load(),
+                      notifications_sent_.load(), notifications_received_.load(), established_transitions_.load(),
+                      collisions_resolved_.load()};
+}
+
+} // namespace router_sim
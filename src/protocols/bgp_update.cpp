@@ -0,0 +1,487 @@
+#include "protocols/bgp_update.h"
+#include <algorithm>
+#include <cstring>
+
+namespace router_sim {
+
+namespace {
+
+const uint16_t AS_TRANS = 23456;
+const size_t MAX_SEGMENT_LENGTH = 255;
+
+// Flag bits that must match for each recognized attribute
+const uint8_t WELL_KNOWN_FLAGS_MASK = BGP_ATTRIBUTE_OPTIONAL | BGP_ATTRIBUTE_TRANSITIVE | BGP_ATTRIBUTE_PARTIAL;
+const uint8_t OPTIONAL_FLAGS_MASK = BGP_ATTRIBUTE_OPTIONAL | BGP_ATTRIBUTE_TRANSITIVE;
+
+uint16_t get_u16(const uint8_t* data) {
+    return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+
+uint32_t get_u32(const uint8_t* data) {
+    return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | data[3];
+}
+
+void put_u16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void put_u32(std::vector<uint8_t>& out, uint32_t value) {
+    put_u16(out, static_cast<uint16_t>(value >> 16));
+    put_u16(out, static_cast<uint16_t>(value));
+}
+
+// Flags, type and a one- or two-octet length, as the value needs
+void put_attribute_header(std::vector<uint8_t>& out, uint8_t flags, BGPAttributeType type, size_t length) {
+    if (length > 255) {
+        out.push_back(flags | BGP_ATTRIBUTE_EXTENDED_LENGTH);
+        out.push_back(static_cast<uint8_t>(type));
+        put_u16(out, static_cast<uint16_t>(length));
+    } else {
+        out.push_back(flags);
+        out.push_back(static_cast<uint8_t>(type));
+        out.push_back(static_cast<uint8_t>(length));
+    }
+}
+
+// A run of prefixes of at most max_bits each that ends exactly at end
+bool valid_prefixes(const uint8_t* data, const uint8_t* end, unsigned max_bits) {
+    while (data < end) {
+        unsigned length = data[0];
+        if (length > max_bits || size_t(end - data) < 1 + (length + 7) / 8) {
+            return false;
+        }
+        data += 1 + (length + 7) / 8;
+    }
+    return true;
+}
+
+bool valid_as_path(const uint8_t* data, size_t length, size_t as_size) {
+    const uint8_t* end = data + length;
+    while (data < end) {
+        if (end - data < 2 || data[0] < BGP_AS_SET || data[0] > BGP_AS_CONFED_SET || data[1] == 0 ||
+            size_t(end - data - 2) < data[1] * as_size) {
+            return false;
+        }
+        data += 2 + data[1] * as_size;
+    }
+    return true;
+}
+
+unsigned max_prefix_bits(uint16_t afi) {
+    return afi == BGP_AFI_IPV4 ? 32 : afi == BGP_AFI_IPV6 ? 128 : 255;
+}
+
+uint8_t* write_header(uint8_t* message) {
+    std::memset(message, 0xff, 16);
+    message[18] = static_cast<uint8_t>(BGPMessageType::UPDATE);
+    return message + BGP_HEADER_SIZE;
+}
+
+void finish_header(uint8_t* message, size_t length) {
+    message[16] = static_cast<uint8_t>(length >> 8);
+    message[17] = static_cast<uint8_t>(length);
+}
+
+// Packs prefixes from next on while they fit before limit; lengths over
+// 32 are skipped
+uint8_t* write_prefixes(uint8_t* out, const uint8_t* limit, const RouterSim::Ipv4Prefix* prefixes, size_t count,
+                        size_t& next) {
+    for (; next < count; ++next) {
+        const RouterSim::Ipv4Prefix& prefix = prefixes[next];
+        unsigned octets = (prefix.length + 7u) / 8;
+        if (prefix.length > 32) {
+            continue;
+        }
+        if (out + 1 + octets > limit) {
+            break;
+        }
+        *out++ = prefix.length;
+        for (unsigned i = 0; i < octets; ++i) {
+            *out++ = static_cast<uint8_t>(prefix.address >> (24 - 8 * i));
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+size_t BGPPrefixRange::count() const {
+    size_t count = 0;
+    for (auto it = begin(); it != end(); ++it) {
+        count++;
+    }
+    return count;
+}
+
+size_t BGPAsPath::length() const {
+    size_t length = 0;
+    for (const uint8_t* segment = data_; segment < data_ + size_; segment += 2 + segment[1] * as_size_) {
+        if (segment[0] == BGP_AS_SEQUENCE) {
+            length += segment[1];
+        } else if (segment[0] == BGP_AS_SET) {
+            length++;
+        }
+        // Confederation segments do not count (RFC 5065)
+    }
+    return length;
+}
+
+uint32_t BGPAsPath::first() const {
+    return size_ >= 2 + as_size_ ? read_as(data_ + 2) : 0;
+}
+
+bool BGPAsPath::contains(uint32_t as) const {
+    bool found = false;
+    for_each([&](uint8_t, uint32_t path_as) { found = found || path_as == as; });
+    return found;
+}
+
+void BGPAsPath::append_to(std::vector<uint32_t>& out) const {
+    for_each([&](uint8_t, uint32_t as) { out.push_back(as); });
+}
+
+BGPAttribute BGPAttributeRange::iterator::operator*() const {
+    BGPAttribute attribute;
+    attribute.flags = position_[0];
+    attribute.type = position_[1];
+    if (attribute.flags & BGP_ATTRIBUTE_EXTENDED_LENGTH) {
+        attribute.length = get_u16(position_ + 2);
+        attribute.value = position_ + 4;
+    } else {
+        attribute.length = position_[2];
+        attribute.value = position_ + 3;
+    }
+    return attribute;
+}
+
+BGPUpdate::BGPUpdate()
+    : error_(BGPUpdateError::NONE), error_reason_(""), seen_{0, 0, 0, 0}, origin_(BGP_ORIGIN_IGP), next_hop_(0),
+      med_(0), local_pref_(0) {
+}
+
+bool BGPUpdate::fail(BGPUpdateError error, const char* reason) {
+    error_ = error;
+    error_reason_ = reason;
+    return false;
+}
+
+bool BGPUpdate::parse(const uint8_t* body, size_t length, bool four_octet_as) {
+    error_ = BGPUpdateError::NONE;
+    error_reason_ = "";
+    seen_[0] = seen_[1] = seen_[2] = seen_[3] = 0;
+    origin_ = BGP_ORIGIN_IGP;
+    as_path_ = BGPAsPath();
+    next_hop_ = med_ = local_pref_ = 0;
+    communities_ = BGPCommunities();
+    mp_reach_ = BGPMpReach();
+    mp_unreach_ = BGPMpUnreach();
+    withdrawn_ = nlri_ = BGPPrefixRange();
+    attributes_ = BGPAttributeRange();
+
+    if (length < 4) {
+        return fail(BGPUpdateError::MALFORMED_ATTRIBUTE_LIST, "UPDATE too short");
+    }
+    const uint8_t* end = body + length;
+    size_t withdrawn_length = get_u16(body);
+    if (withdrawn_length > length - 4) {
+        return fail(BGPUpdateError::MALFORMED_ATTRIBUTE_LIST, "withdrawn routes overrun the message");
+    }
+    const uint8_t* withdrawn = body + 2;
+    const uint8_t* attributes = withdrawn + withdrawn_length + 2;
+    size_t attributes_length = get_u16(withdrawn + withdrawn_length);
+    if (attributes_length > size_t(end - attributes)) {
+        return fail(BGPUpdateError::MALFORMED_ATTRIBUTE_LIST, "path attributes overrun the message");
+    }
+    const uint8_t* nlri = attributes + attributes_length;
+
+    if (!valid_prefixes(withdrawn, withdrawn + withdrawn_length, 32)) {
+        return fail(BGPUpdateError::INVALID_NETWORK_FIELD, "bad withdrawn prefix");
+    }
+    if (!valid_prefixes(nlri, end, 32)) {
+        return fail(BGPUpdateError::INVALID_NETWORK_FIELD, "bad NLRI prefix");
+    }
+    withdrawn_ = BGPPrefixRange(withdrawn, withdrawn + withdrawn_length);
+    nlri_ = BGPPrefixRange(nlri, end);
+    attributes_ = BGPAttributeRange(attributes, nlri);
+
+    size_t as_size = four_octet_as ? 4 : 2;
+    for (const uint8_t* attribute = attributes; attribute < nlri;) {
+        size_t header = attribute[0] & BGP_ATTRIBUTE_EXTENDED_LENGTH ? 4 : 3;
+        if (size_t(nlri - attribute) < header) {
+            return fail(BGPUpdateError::MALFORMED_ATTRIBUTE_LIST, "truncated attribute header");
+        }
+        uint8_t flags = attribute[0];
+        uint8_t type = attribute[1];
+        size_t value_length = header == 4 ? get_u16(attribute + 2) : attribute[2];
+        const uint8_t* value = attribute + header;
+        if (value_length > size_t(nlri - value)) {
+            return fail(BGPUpdateError::ATTRIBUTE_LENGTH_ERROR, "attribute overruns the list");
+        }
+        if (has_type(type)) {
+            return fail(BGPUpdateError::MALFORMED_ATTRIBUTE_LIST, "attribute repeated");
+        }
+        seen_[type >> 6] |= uint64_t(1) << (type & 63);
+        if (!parse_attribute(flags, type, value, value_length, as_size)) {
+            return false;
+        }
+        attribute = value + value_length;
+    }
+
+    if (!nlri_.empty() && (!has(BGPAttributeType::ORIGIN) || !has(BGPAttributeType::AS_PATH) ||
+                           !has(BGPAttributeType::NEXT_HOP))) {
+        return fail(BGPUpdateError::MISSING_WELL_KNOWN_ATTRIBUTE, "NLRI without ORIGIN, AS_PATH or NEXT_HOP");
+    }
+    if (has(BGPAttributeType::MP_REACH_NLRI) &&
+        (!has(BGPAttributeType::ORIGIN) || !has(BGPAttributeType::AS_PATH))) {
+        return fail(BGPUpdateError::MISSING_WELL_KNOWN_ATTRIBUTE, "MP_REACH_NLRI without ORIGIN or AS_PATH");
+    }
+    return true;
+}
+
+bool BGPUpdate::parse_attribute(uint8_t flags, uint8_t type, const uint8_t* value, size_t length,
+                                size_t as_size) {
+    auto well_known = [&] { return (flags & WELL_KNOWN_FLAGS_MASK) == BGP_ATTRIBUTE_TRANSITIVE; };
+    auto optional = [&](uint8_t expected) { return (flags & OPTIONAL_FLAGS_MASK) == expected; };
+    const uint8_t optional_transitive = BGP_ATTRIBUTE_OPTIONAL | BGP_ATTRIBUTE_TRANSITIVE;
+
+    switch (static_cast<BGPAttributeType>(type)) {
+        case BGPAttributeType::ORIGIN:
+            if (!well_known()) {
+                return fail(BGPUpdateError::ATTRIBUTE_FLAGS_ERROR, "ORIGIN flags");
+            }
+            if (length != 1) {
+                return fail(BGPUpdateError::ATTRIBUTE_LENGTH_ERROR, "ORIGIN length");
+            }
+            if (value[0] > BGP_ORIGIN_INCOMPLETE) {
+                return fail(BGPUpdateError::INVALID_ORIGIN, "ORIGIN value");
+            }
+            origin_ = value[0];
+            return true;
+
+        case BGPAttributeType::AS_PATH:
+            if (!well_known()) {
+                return fail(BGPUpdateError::ATTRIBUTE_FLAGS_ERROR, "AS_PATH flags");
+            }
+            if (!valid_as_path(value, length, as_size)) {
+                return fail(BGPUpdateError::MALFORMED_AS_PATH, "AS_PATH segments");
+            }
+            as_path_ = BGPAsPath(value, length, as_size);
+            return true;
+
+        case BGPAttributeType::NEXT_HOP:
+            if (!well_known()) {
+                return fail(BGPUpdateError::ATTRIBUTE_FLAGS_ERROR, "NEXT_HOP flags");
+            }
+            if (length != 4) {
+                return fail(BGPUpdateError::ATTRIBUTE_LENGTH_ERROR, "NEXT_HOP length");
+            }
+            next_hop_ = get_u32(value);
+            return true;
+
+        case BGPAttributeType::MULTI_EXIT_DISC:
+            if (!optional(BGP_ATTRIBUTE_OPTIONAL)) {
+                return fail(BGPUpdateError::ATTRIBUTE_FLAGS_ERROR, "MULTI_EXIT_DISC flags");
+            }
+            if (length != 4) {
+                return fail(BGPUpdateError::ATTRIBUTE_LENGTH_ERROR, "MULTI_EXIT_DISC length");
+            }
+            med_ = get_u32(value);
+            return true;
+
+        case BGPAttributeType::LOCAL_PREF:
+            if (!well_known()) {
+                return fail(BGPUpdateError::ATTRIBUTE_FLAGS_ERROR, "LOCAL_PREF flags");
+            }
+            if (length != 4) {
+                return fail(BGPUpdateError::ATTRIBUTE_LENGTH_ERROR, "LOCAL_PREF length");
+            }
+            local_pref_ = get_u32(value);
+            return true;
+
+        case BGPAttributeType::ATOMIC_AGGREGATE:
+            if (!well_known()) {
+                return fail(BGPUpdateError::ATTRIBUTE_FLAGS_ERROR, "ATOMIC_AGGREGATE flags");
+            }
+            if (length != 0) {
+                return fail(BGPUpdateError::ATTRIBUTE_LENGTH_ERROR, "ATOMIC_AGGREGATE length");
+            }
+            return true;
+
+        case BGPAttributeType::AGGREGATOR:
+            if (!optional(optional_transitive)) {
+                return fail(BGPUpdateError::ATTRIBUTE_FLAGS_ERROR, "AGGREGATOR flags");
+            }
+            if (length != as_size + 4) {
+                return fail(BGPUpdateError::ATTRIBUTE_LENGTH_ERROR, "AGGREGATOR length");
+            }
+            return true;
+
+        case BGPAttributeType::COMMUNITIES:
+            if (!optional(optional_transitive)) {
+                return fail(BGPUpdateError::ATTRIBUTE_FLAGS_ERROR, "COMMUNITIES flags");
+            }
+            if (length % 4 != 0) {
+                return fail(BGPUpdateError::OPTIONAL_ATTRIBUTE_ERROR, "COMMUNITIES length");
+            }
+            communities_ = BGPCommunities(value, length / 4);
+            return true;
+
+        case BGPAttributeType::MP_REACH_NLRI: {
+            if (!optional(BGP_ATTRIBUTE_OPTIONAL)) {
+                return fail(BGPUpdateError::ATTRIBUTE_FLAGS_ERROR, "MP_REACH_NLRI flags");
+            }
+            // AFI, SAFI, next hop length, next hop, reserved octet, NLRI
+            if (length < 5 || size_t(value[3]) + 5 > length) {
+                return fail(BGPUpdateError::OPTIONAL_ATTRIBUTE_ERROR, "MP_REACH_NLRI length");
+            }
+            mp_reach_.afi = get_u16(value);
+            mp_reach_.safi = value[2];
+            mp_reach_.next_hop_length = value[3];
+            mp_reach_.next_hop = value + 4;
+            const uint8_t* nlri = value + 5 + value[3];
+            if ((mp_reach_.afi == BGP_AFI_IPV4 && value[3] != 4 && value[3] != 16 && value[3] != 32) ||
+                (mp_reach_.afi == BGP_AFI_IPV6 && value[3] != 16 && value[3] != 32) ||
+                !valid_prefixes(nlri, value + length, max_prefix_bits(mp_reach_.afi))) {
+                return fail(BGPUpdateError::OPTIONAL_ATTRIBUTE_ERROR, "MP_REACH_NLRI contents");
+            }
+            mp_reach_.nlri = BGPPrefixRange(nlri, value + length);
+            return true;
+        }
+
+        case BGPAttributeType::MP_UNREACH_NLRI:
+            if (!optional(BGP_ATTRIBUTE_OPTIONAL)) {
+                return fail(BGPUpdateError::ATTRIBUTE_FLAGS_ERROR, "MP_UNREACH_NLRI flags");
+            }
+            if (length < 3) {
+                return fail(BGPUpdateError::OPTIONAL_ATTRIBUTE_ERROR, "MP_UNREACH_NLRI length");
+            }
+            mp_unreach_.afi = get_u16(value);
+            mp_unreach_.safi = value[2];
+            if (!valid_prefixes(value + 3, value + length, max_prefix_bits(mp_unreach_.afi))) {
+                return fail(BGPUpdateError::OPTIONAL_ATTRIBUTE_ERROR, "MP_UNREACH_NLRI contents");
+            }
+            mp_unreach_.withdrawn = BGPPrefixRange(value + 3, value + length);
+            return true;
+    }
+
+    if (!(flags & BGP_ATTRIBUTE_OPTIONAL)) {
+        return fail(BGPUpdateError::UNRECOGNIZED_WELL_KNOWN_ATTRIBUTE, "unrecognized well-known attribute");
+    }
+    return true;
+}
+
+BGPUpdateEncoder::BGPUpdateEncoder(bool four_octet_as) : four_octet_as_(four_octet_as), prefixes_dropped_(0) {
+}
+
+void BGPUpdateEncoder::encode_attributes(const BGPPathAttributes& attributes) {
+    attributes_.clear();
+    put_attribute_header(attributes_, BGP_ATTRIBUTE_TRANSITIVE, BGPAttributeType::ORIGIN, 1);
+    attributes_.push_back(attributes.origin);
+
+    // Sequences of at most 255 AS numbers; AS_TRANS stands in for four-octet
+    // numbers when the peer only knows two-octet ones
+    size_t as_size = four_octet_as_ ? 4 : 2;
+    size_t segments = (attributes.as_path.size() + MAX_SEGMENT_LENGTH - 1) / MAX_SEGMENT_LENGTH;
+    put_attribute_header(attributes_, BGP_ATTRIBUTE_TRANSITIVE, BGPAttributeType::AS_PATH,
+                         segments * 2 + attributes.as_path.size() * as_size);
+    for (size_t i = 0; i < attributes.as_path.size(); ++i) {
+        if (i % MAX_SEGMENT_LENGTH == 0) {
+            attributes_.push_back(BGP_AS_SEQUENCE);
+            attributes_.push_back(
+                static_cast<uint8_t>(std::min(MAX_SEGMENT_LENGTH, attributes.as_path.size() - i)));
+        }
+        uint32_t as = attributes.as_path[i];
+        if (four_octet_as_) {
+            put_u32(attributes_, as);
+        } else {
+            put_u16(attributes_, as > 0xffff ? AS_TRANS : static_cast<uint16_t>(as));
+        }
+    }
+
+    put_attribute_header(attributes_, BGP_ATTRIBUTE_TRANSITIVE, BGPAttributeType::NEXT_HOP, 4);
+    put_u32(attributes_, attributes.next_hop);
+    if (attributes.has_med) {
+        put_attribute_header(attributes_, BGP_ATTRIBUTE_OPTIONAL, BGPAttributeType::MULTI_EXIT_DISC, 4);
+        put_u32(attributes_, attributes.med);
+    }
+    if (attributes.has_local_pref) {
+        put_attribute_header(attributes_, BGP_ATTRIBUTE_TRANSITIVE, BGPAttributeType::LOCAL_PREF, 4);
+        put_u32(attributes_, attributes.local_pref);
+    }
+    if (!attributes.communities.empty()) {
+        put_attribute_header(attributes_, BGP_ATTRIBUTE_OPTIONAL | BGP_ATTRIBUTE_TRANSITIVE,
+                             BGPAttributeType::COMMUNITIES, attributes.communities.size() * 4);
+        for (uint32_t community : attributes.communities) {
+            put_u32(attributes_, community);
+        }
+    }
+}
+
+size_t BGPUpdateEncoder::encode_announcements(const BGPPathAttributes& attributes,
+                                              const RouterSim::Ipv4Prefix* prefixes, size_t count,
+                                              std::vector<uint8_t>& out) {
+    encode_attributes(attributes);
+    // Room for at least one /32 next to the attributes
+    if (BGP_HEADER_SIZE + 4 + attributes_.size() + 5 > BGP_MAX_MESSAGE_SIZE) {
+        prefixes_dropped_ += count;
+        return 0;
+    }
+
+    size_t messages = 0;
+    size_t next = 0;
+    while (next < count) {
+        size_t start = out.size();
+        out.resize(start + BGP_MAX_MESSAGE_SIZE);
+        uint8_t* message = out.data() + start;
+        uint8_t* limit = message + BGP_MAX_MESSAGE_SIZE;
+        uint8_t* position = write_header(message);
+        *position++ = 0;
+        *position++ = 0;
+        *position++ = static_cast<uint8_t>(attributes_.size() >> 8);
+        *position++ = static_cast<uint8_t>(attributes_.size());
+        std::memcpy(position, attributes_.data(), attributes_.size());
+        position += attributes_.size();
+
+        uint8_t* nlri = position;
+        position = write_prefixes(position, limit, prefixes, count, next);
+        if (position == nlri) {
+            out.resize(start);
+            continue;
+        }
+        finish_header(message, position - message);
+        out.resize(start + (position - message));
+        messages++;
+    }
+    return messages;
+}
+
+size_t BGPUpdateEncoder::encode_withdrawals(const RouterSim::Ipv4Prefix* prefixes, size_t count,
+                                            std::vector<uint8_t>& out) {
+    size_t messages = 0;
+    size_t next = 0;
+    while (next < count) {
+        size_t start = out.size();
+        out.resize(start + BGP_MAX_MESSAGE_SIZE);
+        uint8_t* message = out.data() + start;
+        // The empty path attributes length goes last
+        uint8_t* limit = message + BGP_MAX_MESSAGE_SIZE - 2;
+        uint8_t* withdrawn_length = write_header(message);
+        uint8_t* position = write_prefixes(withdrawn_length + 2, limit, prefixes, count, next);
+        size_t withdrawn = position - (withdrawn_length + 2);
+        if (withdrawn == 0) {
+            out.resize(start);
+            continue;
+        }
+        withdrawn_length[0] = static_cast<uint8_t>(withdrawn >> 8);
+        withdrawn_length[1] = static_cast<uint8_t>(withdrawn);
+        *position++ = 0;
+        *position++ = 0;
+        finish_header(message, position - message);
+        out.resize(start + (position - message));
+        messages++;
+    }
+    return messages;
+}
+
+} // namespace router_sim
@@ -0,0 +1,298 @@
+#include "routing/fib.h"
+#include <cstdio>
+#include <cstdlib>
+#include <array>
+
+namespace RouterSim {
+
+bool parse_ipv4_address(const std::string& text, uint32_t& address) {
+    uint32_t result = 0;
+    size_t pos = 0;
+
+    for (int octet = 0; octet < 4; ++octet) {
+        if (octet > 0) {
+            if (pos >= text.size() || text[pos] != '.') {
+                return false;
+            }
+            ++pos;
+        }
+
+        uint32_t value = 0;
+        size_t digits = 0;
+        while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9' && digits < 3) {
+            value = value * 10 + (text[pos] - '0');
+            ++pos;
+            ++digits;
+        }
+
+        if (digits == 0 || value > 255) {
+            return false;
+        }
+        result = (result << 8) | value;
+    }
+
+    if (pos != text.size()) {
+        return false;
+    }
+
+    address = result;
+    return true;
+}
+
+bool parse_ipv4_prefix(const std::string& text, Ipv4Prefix& prefix) {
+    size_t slash = text.find('/');
+    uint32_t address = 0;
+    uint32_t length = 32;
+
+    if (!parse_ipv4_address(text.substr(0, slash), address)) {
+        return false;
+    }
+
+    if (slash != std::string::npos) {
+        std::string len_text = text.substr(slash + 1);
+        if (len_text.empty() || len_text.size() > 2) {
+            return false;
+        }
+        length = 0;
+        for (char c : len_text) {
+            if (c < '0' || c > '9') {
+                return false;
+            }
+            length = length * 10 + (c - '0');
+        }
+        if (length > 32) {
+            return false;
+        }
+    }
+
+    // Mask off host bits
+    prefix.address = length == 0 ? 0 : address & (0xFFFFFFFFu << (32 - length));
+    prefix.length = static_cast<uint8_t>(length);
+    return true;
+}
+
+std::string format_ipv4_address(uint32_t address) {
+    char buffer[16];
+    std::snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u",
+                  (address >> 24) & 0xFF, (address >> 16) & 0xFF,
+                  (address >> 8) & 0xFF, address & 0xFF);
+    return buffer;
+}
+
+std::string format_ipv4_prefix(const Ipv4Prefix& prefix) {
+    return format_ipv4_address(prefix.address) + "/" + std::to_string(prefix.length);
+}
+
+Ipv4Fib::Ipv4Fib() : route_count_(0), dirty_(true) {
+    clear();
+}
+
+Ipv4Fib::~Ipv4Fib() = default;
+
+uint32_t Ipv4Fib::new_rib_node() {
+    RibNode node;
+    node.child[0] = NO_NODE;
+    node.child[1] = NO_NODE;
+    node.next_hop = 0;
+    rib_.push_back(node);
+    return static_cast<uint32_t>(rib_.size() - 1);
+}
+
+bool Ipv4Fib::insert(uint32_t prefix, uint8_t length, uint32_t next_hop) {
+    if (length > 32 || next_hop > MAX_NEXT_HOP) {
+        return false;
+    }
+
+    uint32_t node = 0;
+    for (unsigned depth = 0; depth < length; ++depth) {
+        unsigned bit = (prefix >> (31 - depth)) & 1;
+        if (rib_[node].child[bit] == NO_NODE) {
+            uint32_t child = new_rib_node();
+            rib_[node].child[bit] = child;
+        }
+        node = rib_[node].child[bit];
+    }
+
+    if (rib_[node].next_hop == 0) {
+        route_count_++;
+    }
+    rib_[node].next_hop = next_hop + 1;
+    dirty_ = true;
+    return true;
+}
+
+bool Ipv4Fib::remove(uint32_t prefix, uint8_t length) {
+    if (length > 32) {
+        return false;
+    }
+
+    uint32_t node = 0;
+    for (unsigned depth = 0; depth < length && node != NO_NODE; ++depth) {
+        node = rib_[node].child[(prefix >> (31 - depth)) & 1];
+    }
+
+    if (node == NO_NODE || rib_[node].next_hop == 0) {
+        return false;
+    }
+
+    // Empty RIB nodes are left in place; they are skipped by build()
+    rib_[node].next_hop = 0;
+    route_count_--;
+    dirty_ = true;
+    return true;
+}
+
+uint32_t Ipv4Fib::find_exact(uint32_t prefix, uint8_t length) const {
+    if (length > 32) {
+        return INVALID_NEXT_HOP;
+    }
+
+    uint32_t node = 0;
+    for (unsigned depth = 0; depth < length && node != NO_NODE; ++depth) {
+        node = rib_[node].child[(prefix >> (31 - depth)) & 1];
+    }
+
+    return node == NO_NODE ? INVALID_NEXT_HOP : rib_[node].next_hop - 1;
+}
+
+void Ipv4Fib::clear() {
+    rib_.clear();
+    new_rib_node();
+    route_count_ = 0;
+    direct_.clear();
+    nodes_.clear();
+    leaves_.clear();
+    dirty_ = true;
+}
+
+size_t Ipv4Fib::memory_usage() const {
+    return rib_.capacity() * sizeof(RibNode) +
+           direct_.capacity() * sizeof(uint32_t) +
+           nodes_.capacity() * sizeof(Node) +
+           leaves_.capacity() * sizeof(uint32_t);
+}
+
+bool Ipv4Fib::rib_has_children(uint32_t node) const {
+    return rib_[node].child[0] != NO_NODE || rib_[node].child[1] != NO_NODE;
+}
+
+void Ipv4Fib::build() {
+    if (!dirty_) {
+        return;
+    }
+
+    direct_.assign(1u << DIRECT_BITS, 0);
+    nodes_.clear();
+    leaves_.clear();
+
+    fill_direct(0, 0, 0, rib_[0].next_hop);
+
+    nodes_.shrink_to_fit();
+    leaves_.shrink_to_fit();
+    dirty_ = false;
+}
+
+void Ipv4Fib::fill_direct(uint32_t node, unsigned depth, uint32_t bits, uint32_t next_hop) {
+    if (depth == DIRECT_BITS) {
+        if (rib_has_children(node)) {
+            uint32_t index = static_cast<uint32_t>(nodes_.size());
+            nodes_.emplace_back();
+            compile_node(node, DIRECT_BITS, next_hop, index);
+            direct_[bits] = index;
+        } else {
+            direct_[bits] = LEAF_FLAG | next_hop;
+        }
+        return;
+    }
+
+    for (unsigned bit = 0; bit < 2; ++bit) {
+        uint32_t child = rib_[node].child[bit];
+        uint32_t child_bits = (bits << 1) | bit;
+
+        if (child == NO_NODE) {
+            // Whole sub-range inherits the current next hop
+            unsigned span = DIRECT_BITS - depth - 1;
+            uint32_t first = child_bits << span;
+            uint32_t last = first + (1u << span);
+            for (uint32_t i = first; i < last; ++i) {
+                direct_[i] = LEAF_FLAG | next_hop;
+            }
+        } else {
+            uint32_t child_next_hop = rib_[child].next_hop ? rib_[child].next_hop : next_hop;
+            fill_direct(child, depth + 1, child_bits, child_next_hop);
+        }
+    }
+}
+
+void Ipv4Fib::compile_node(uint32_t node, unsigned offset, uint32_t next_hop, uint32_t index) {
+    // Resolve each of the 64 slots by walking STRIDE bits down the RIB
+    std::array<uint32_t, 64> slot_node;
+    std::array<uint32_t, 64> slot_next_hop;
+    uint64_t vector = 0;
+
+    for (unsigned slot = 0; slot < 64; ++slot) {
+        uint32_t current = node;
+        uint32_t current_next_hop = next_hop;
+        unsigned step = 0;
+
+        for (; step < STRIDE; ++step) {
+            uint32_t child = rib_[current].child[(slot >> (STRIDE - 1 - step)) & 1];
+            if (child == NO_NODE) {
+                break;
+            }
+            current = child;
+            if (rib_[current].next_hop) {
+                current_next_hop = rib_[current].next_hop;
+            }
+        }
+
+        slot_next_hop[slot] = current_next_hop;
+        slot_node[slot] = NO_NODE;
+        if (step == STRIDE && rib_has_children(current)) {
+            slot_node[slot] = current;
+            vector |= 1ULL << slot;
+        }
+    }
+
+    nodes_[index].vector = vector;
+    nodes_[index].base0 = static_cast<uint32_t>(leaves_.size());
+    nodes_[index].base1 = 0;
+
+    // Run-length compress leaves; internal slots do not break a run
+    uint64_t leafvec = 0;
+    bool have_previous = false;
+    uint32_t previous = 0;
+    for (unsigned slot = 0; slot < 64; ++slot) {
+        if (vector & (1ULL << slot)) {
+            continue;
+        }
+        if (!have_previous || slot_next_hop[slot] != previous) {
+            leafvec |= 1ULL << slot;
+            leaves_.push_back(slot_next_hop[slot]);
+            previous = slot_next_hop[slot];
+            have_previous = true;
+        }
+    }
+    nodes_[index].leafvec = leafvec;
+
+    // Children occupy one contiguous block, reserved before recursing
+    uint32_t child_count = static_cast<uint32_t>(__builtin_popcountll(vector));
+    if (child_count == 0) {
+        return;
+    }
+
+    uint32_t base1 = static_cast<uint32_t>(nodes_.size());
+    nodes_.resize(nodes_.size() + child_count);
+    nodes_[index].base1 = base1;
+
+    uint32_t position = 0;
+    for (unsigned slot = 0; slot < 64; ++slot) {
+        if (slot_node[slot] == NO_NODE) {
+            continue;
+        }
+        compile_node(slot_node[slot], offset + STRIDE, slot_next_hop[slot], base1 + position);
+        position++;
+    }
+}
+
+} // namespace RouterSim
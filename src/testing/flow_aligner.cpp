@@ -0,0 +1,174 @@
+#include "testing/flow_aligner.h"
+#include <algorithm>
+
+namespace RouterSim {
+
+namespace {
+
+const uint64_t FNV_OFFSET = 14695981039346656037ull;
+const uint64_t FNV_PRIME = 1099511628211ull;
+const uint8_t PROTOCOL_TCP = 6;
+
+uint64_t fnv1a(uint64_t hash, const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < length; ++i) {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+template <typename T>
+uint64_t mix(uint64_t hash, T value) {
+    return fnv1a(hash, &value, sizeof(value));
+}
+
+} // namespace
+
+size_t PcapFlowKeyHash::operator()(const PcapFlowKey& key) const {
+    uint64_t hash = fnv1a(FNV_OFFSET, key.src_ip.data(), key.src_ip.size());
+    hash = fnv1a(mix(hash, '>'), key.dst_ip.data(), key.dst_ip.size());
+    hash = mix(hash, key.protocol);
+    hash = mix(hash, key.src_port);
+    hash = mix(hash, key.dst_port);
+    return static_cast<size_t>(hash);
+}
+
+PcapFlowAligner::PcapFlowAligner(size_t window, MatchCallback on_match, UnmatchedCallback on_unmatched)
+    : window_(std::max<size_t>(window, 1)), on_match_(std::move(on_match)),
+      on_unmatched_(std::move(on_unmatched)), positions_{0, 0}, counts_{0, 0}, pending_(0), peak_pending_(0) {
+}
+
+PcapFlowKey PcapFlowAligner::flow_key(const PcapPacketInfo& packet) {
+    PcapFlowKey key;
+    key.src_ip = packet.src_ip;
+    key.dst_ip = packet.dst_ip;
+    key.protocol = packet.protocol;
+    key.src_port = packet.src_port;
+    key.dst_port = packet.dst_port;
+    return key;
+}
+
+uint64_t PcapFlowAligner::identity(const PcapPacketInfo& packet) {
+    uint64_t hash = mix(FNV_OFFSET, packet.protocol);
+    if (packet.protocol == PROTOCOL_TCP) {
+        hash = mix(hash, packet.ip_id);
+        hash = mix(hash, packet.tcp_seq);
+        return mix(hash, packet.tcp_ack);
+    }
+    if (packet.ip_id != 0) {
+        return mix(hash, packet.ip_id);
+    }
+    // Nothing in the headers tells packets apart: fall back to their shape
+    hash = mix(hash, packet.size);
+    return mix(hash, packet.dscp);
+}
+
+void PcapFlowAligner::add(Side side, PcapPacketInfo packet) {
+    add(side, std::move(packet), positions_[side]);
+}
+
+void PcapFlowAligner::add(Side side, PcapPacketInfo packet, uint64_t index) {
+    Side other = side == FIRST ? SECOND : FIRST;
+    positions_[side] = index + 1;
+    counts_[side]++;
+    uint64_t id = identity(packet);
+    PcapFlowKey key = flow_key(packet);
+
+    auto flow = flows_.find(key);
+    if (flow != flows_.end()) {
+        Queue& queue = flow->second.queues[other];
+        auto candidates = queue.by_identity.find(id);
+        while (candidates != queue.by_identity.end()) {
+            uint64_t match_position = candidates->second.front();
+            if (match_position + window_ <= index) {
+                // Out of reach, and would have expired already with other traffic
+                report_unmatched(other, queue, queue.packets.find(match_position));
+                candidates = queue.by_identity.find(id);
+                continue;
+            }
+
+            candidates->second.pop_front();
+            if (candidates->second.empty()) {
+                queue.by_identity.erase(candidates);
+            }
+
+            // A later packet of this flow in the first capture already found its partner
+            Queue& first_queue = flow->second.queues[FIRST];
+            uint64_t first_position = side == FIRST ? index : match_position;
+            bool reordered = first_position + 1 < first_queue.highest_matched;
+            first_queue.highest_matched = std::max(first_queue.highest_matched, first_position + 1);
+
+            auto match = queue.packets.find(match_position);
+            if (side == FIRST) {
+                on_match_(packet, index, match->second.packet, match_position, reordered);
+            } else {
+                on_match_(match->second.packet, match_position, packet, index, reordered);
+            }
+            queue.packets.erase(match);
+            pending_--;
+            expire(index + 1);
+            return;
+        }
+    } else {
+        flow = flows_.emplace(std::move(key), Flow{}).first;
+    }
+
+    Queue& queue = flow->second.queues[side];
+    queue.packets.emplace(index, Pending{std::move(packet), id});
+    queue.by_identity[id].push_back(index);
+    flow->second.references++;
+    fifo_[side].push_back({&*flow, index});
+    pending_++;
+    peak_pending_ = std::max(peak_pending_, pending_);
+    expire(index + 1);
+}
+
+void PcapFlowAligner::finish() {
+    expire(FIRST, UINT64_MAX);
+    expire(SECOND, UINT64_MAX);
+}
+
+void PcapFlowAligner::expire(uint64_t position) {
+    if (position > window_) {
+        expire(FIRST, position - window_);
+        expire(SECOND, position - window_);
+    }
+}
+
+void PcapFlowAligner::expire(Side side, uint64_t limit) {
+    auto& fifo = fifo_[side];
+    while (!fifo.empty() && fifo.front().position < limit) {
+        FifoEntry entry = fifo.front();
+        fifo.pop_front();
+        release(side, entry);
+    }
+}
+
+void PcapFlowAligner::release(Side side, const FifoEntry& entry) {
+    Flow& flow = entry.flow->second;
+    Queue& queue = flow.queues[side];
+
+    // Matched entries leave their FIFO slot behind; only report the rest
+    auto pending = queue.packets.find(entry.position);
+    if (pending != queue.packets.end()) {
+        report_unmatched(side, queue, pending);
+    }
+
+    if (--flow.references == 0) {
+        flows_.erase(flows_.find(entry.flow->first));
+    }
+}
+
+void PcapFlowAligner::report_unmatched(Side side, Queue& queue, std::map<uint64_t, Pending>::iterator pending) {
+    // The oldest unmatched packet is first in line for its identity
+    auto candidates = queue.by_identity.find(pending->second.identity);
+    candidates->second.pop_front();
+    if (candidates->second.empty()) {
+        queue.by_identity.erase(candidates);
+    }
+    on_unmatched_(side, pending->second.packet, pending->first);
+    queue.packets.erase(pending);
+    pending_--;
+}
+
+} // namespace RouterSim
@@ -1,36 +1,86 @@
 #include "testing/pcap_diff.h"
+#include "testing/flow_aligner.h"
+#include "testing/pcap_reader.h"
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <iomanip>
 #include <cstring>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 namespace RouterSim {
 
-PcapDiff::PcapDiff() : initialized_(false) {
-}
+namespace {
 
-PcapDiff::~PcapDiff() = default;
+std::string describe_flow(const PcapPacketInfo& packet) {
+    return packet.src_ip + ":" + std::to_string(packet.src_port) + " -> " + packet.dst_ip + ":" +
+           std::to_string(packet.dst_port) + " proto " + std::to_string(packet.protocol);
+}
 
-bool PcapDiff::initialize() {
-    if (initialized_) {
-        return true;
+// Differences are listed by packet index, then type and description
+bool listed_before(const PcapDifference& a, const PcapDifference& b) {
+    if (a.packet_index != b.packet_index) {
+        return a.packet_index < b.packet_index;
+    }
+    if (a.type != b.type) {
+        return a.type < b.type;
     }
+    return a.description < b.description;
+}
 
-    // Check if required tools are available
-    int result = std::system("which tcpdump > /dev/null 2>&1");
-    if (result != 0) {
-        std::cerr << "tcpdump not found. Please install tcpdump package." << std::endl;
-        return false;
+const uint64_t ROUND_PACKETS = 4096;       // indexes per batch handed to each worker
+const size_t QUEUE_BATCHES = 4;
+
+struct IndexedPacket {
+    uint64_t index;
+    PcapPacketInfo packet;
+};
+
+struct Batch {
+    std::vector<IndexedPacket> packets;
+    bool last = false;                      // no batches follow from this capture
+};
+
+class BatchQueue {
+public:
+    void push(Batch batch) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this] { return batches_.size() < QUEUE_BATCHES; });
+        batches_.push_back(std::move(batch));
+        not_empty_.notify_one();
     }
 
-    result = std::system("which tshark > /dev/null 2>&1");
-    if (result != 0) {
-        std::cerr << "tshark not found. Please install wireshark package." << std::endl;
-        return false;
+    Batch pop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return !batches_.empty(); });
+        Batch batch = std::move(batches_.front());
+        batches_.pop_front();
+        not_full_.notify_one();
+        return batch;
     }
 
+private:
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    std::deque<Batch> batches_;
+};
+
+} // namespace
+
+PcapDiff::PcapDiff() : initialized_(false) {
+}
+
+PcapDiff::~PcapDiff() = default;
+
+bool PcapDiff::initialize() {
+    // Captures are parsed in process; no external tools are needed
     initialized_ = true;
     return true;
 }
@@ -43,50 +93,379 @@ bool PcapDiff::compare_pcaps(const std::string& pcap1_path, const std::string& p
         }
     }
 
-    // Read both PCAP files
-    PcapData pcap1, pcap2;
-    if (!read_pcap_file(pcap1_path, pcap1)) {
+    PcapReader reader1, reader2;
+    if (!reader1.open(pcap1_path)) {
         std::cerr << "Failed to read PCAP file: " << pcap1_path << std::endl;
         return false;
     }
 
-    if (!read_pcap_file(pcap2_path, pcap2)) {
+    if (!reader2.open(pcap2_path)) {
         std::cerr << "Failed to read PCAP file: " << pcap2_path << std::endl;
         return false;
     }
 
-    // Compare the data
-    return compare_pcap_data(pcap1, pcap2, options);
+    reset_results(options);
+    PcapStatistics stats1, stats2;
+    compare_packets([&](PcapPacketInfo& packet) { return reader1.next(packet, options.compare_payload); },
+                    [&](PcapPacketInfo& packet) { return reader2.next(packet, options.compare_payload); },
+                    options, &stats1, &stats2);
+
+    if (reader1.truncated()) {
+        std::cerr << "PCAP file is truncated: " << pcap1_path << std::endl;
+    }
+    if (reader2.truncated()) {
+        std::cerr << "PCAP file is truncated: " << pcap2_path << std::endl;
+    }
+
+    add_count_mismatch(stats1.total_packets, stats2.total_packets);
+    compare_statistics(stats1, stats2);
+
+    return results_.found == 0;
 }
 
 bool PcapDiff::compare_pcap_data(const PcapData& pcap1, const PcapData& pcap2, 
                                 const PcapDiffOptions& options) {
-    differences_.clear();
+    reset_results(options);
+
+    // Compare packets
+    size_t index1 = 0, index2 = 0;
+    compare_packets(
+        [&](PcapPacketInfo& packet) {
+            if (index1 == pcap1.packets.size()) {
+                return false;
+            }
+            packet = pcap1.packets[index1++];
+            return true;
+        },
+        [&](PcapPacketInfo& packet) {
+            if (index2 == pcap2.packets.size()) {
+                return false;
+            }
+            packet = pcap2.packets[index2++];
+            return true;
+        },
+        options, nullptr, nullptr);
 
     // Compare packet counts
-    if (pcap1.packets.size() != pcap2.packets.size()) {
-        PcapDifference diff;
-        diff.type = "Packet Count Mismatch";
-        diff.description = "Different number of packets: " + 
-                          std::to_string(pcap1.packets.size()) + " vs " + 
-                          std::to_string(pcap2.packets.size());
-        differences_.push_back(diff);
+    add_count_mismatch(pcap1.packets.size(), pcap2.packets.size());
+
+    // Compare statistics
+    compare_statistics(pcap1.stats, pcap2.stats);
+
+    return results_.found == 0;
+}
+
+void PcapDiff::reset_results(const PcapDiffOptions& options) {
+    results_ = Results{};
+    results_.limit = options.max_differences;
+    results_.by_index_order = options.mode == PcapDiffMode::BY_FLOW;
+}
+
+void PcapDiff::Results::add(const PcapDifference& difference) {
+    found++;
+    if (limit == 0 || differences.size() < limit) {
+        differences.push_back(difference);
+        if (by_index_order && limit > 0) {
+            std::push_heap(differences.begin(), differences.end(), listed_before);
+        }
+        return;
     }
 
-    // Compare packets
-    size_t min_packets = std::min(pcap1.packets.size(), pcap2.packets.size());
-    for (size_t i = 0; i < min_packets; ++i) {
-        compare_packet(pcap1.packets[i], pcap2.packets[i], i, options);
+    summary.differences_dropped++;
+    // Kept as a max-heap: swap out the last one listed
+    if (by_index_order && listed_before(difference, differences.front())) {
+        std::pop_heap(differences.begin(), differences.end(), listed_before);
+        differences.back() = difference;
+        std::push_heap(differences.begin(), differences.end(), listed_before);
     }
+}
 
-    // Compare statistics
-    compare_statistics(pcap1.stats, pcap2.stats);
+void PcapDiff::Results::finish() {
+    if (by_index_order) {
+        std::sort(differences.begin(), differences.end(), listed_before);
+        by_index_order = false;
+    }
+}
+
+void PcapDiff::Results::merge(std::vector<Results>& shards) {
+    for (auto& shard : shards) {
+        found += shard.found;
+        summary.matched += shard.summary.matched;
+        summary.modified += shard.summary.modified;
+        summary.missing += shard.summary.missing;
+        summary.extra += shard.summary.extra;
+        summary.reordered += shard.summary.reordered;
+        differences.insert(differences.end(), std::make_move_iterator(shard.differences.begin()),
+                           std::make_move_iterator(shard.differences.end()));
+    }
+
+    // Shards cover disjoint packets, each already in order within a packet
+    if (by_index_order) {
+        std::sort(differences.begin(), differences.end(), listed_before);
+        by_index_order = false;
+    } else {
+        std::stable_sort(differences.begin(), differences.end(),
+                         [](const PcapDifference& a, const PcapDifference& b) {
+                             return a.packet_index < b.packet_index;
+                         });
+    }
+    if (limit > 0 && differences.size() > limit) {
+        differences.resize(limit);
+    }
+    summary.differences_dropped = found - differences.size();
+}
+
+void PcapDiff::add_count_mismatch(uint64_t packets1, uint64_t packets2) {
+    if (packets1 == packets2) {
+        return;
+    }
+
+    PcapDifference diff;
+    diff.type = "Packet Count Mismatch";
+    diff.description = "Different number of packets: " + std::to_string(packets1) + " vs " +
+                       std::to_string(packets2);
+    size_t kept = results_.differences.size();
+    results_.add(diff);
+    if (results_.differences.size() > kept) {
+        std::rotate(results_.differences.begin(), results_.differences.end() - 1, results_.differences.end());
+    }
+}
 
-    return differences_.empty();
+void PcapDiff::compare_packets(const PacketSource& next1, const PacketSource& next2,
+                               const PcapDiffOptions& options, PcapStatistics* stats1, PcapStatistics* stats2) {
+    size_t shards = options.threads == 0 ? std::thread::hardware_concurrency() : options.threads;
+    if (shards > 1) {
+        compare_sharded(next1, next2, options, shards, stats1, stats2);
+    } else if (options.mode == PcapDiffMode::BY_FLOW) {
+        compare_flows(next1, next2, options, stats1, stats2);
+    } else {
+        compare_indexes(next1, next2, options, stats1, stats2);
+    }
+    results_.finish();
 }
 
-void PcapDiff::compare_packet(const PacketInfo& packet1, const PacketInfo& packet2, 
-                             size_t packet_index, const PcapDiffOptions& options) {
+void PcapDiff::compare_indexes(const PacketSource& next1, const PacketSource& next2,
+                               const PcapDiffOptions& options, PcapStatistics* stats1, PcapStatistics* stats2) {
+    // Stream both captures in step; only the current pair of packets is held
+    PcapPacketInfo packet1, packet2;
+    bool more1 = next1(packet1);
+    bool more2 = next2(packet2);
+    uint64_t count1 = 0, count2 = 0;
+    while (more1 || more2) {
+        if (more1 && more2) {
+            uint64_t found = results_.found;
+            compare_packet(results_, packet1, packet2, count1, options);
+            results_.summary.modified += results_.found != found;
+        }
+        if (more1) {
+            if (stats1) {
+                add_to_statistics(*stats1, packet1);
+            }
+            count1++;
+            more1 = next1(packet1);
+        }
+        if (more2) {
+            if (stats2) {
+                add_to_statistics(*stats2, packet2);
+            }
+            count2++;
+            more2 = next2(packet2);
+        }
+    }
+    results_.summary.matched = std::min(count1, count2);
+    results_.summary.missing = count1 - results_.summary.matched;
+    results_.summary.extra = count2 - results_.summary.matched;
+}
+
+void PcapDiff::compare_flows(const PacketSource& next1, const PacketSource& next2, const PcapDiffOptions& options,
+                             PcapStatistics* stats1, PcapStatistics* stats2) {
+    PcapFlowAligner aligner(
+        options.alignment_window,
+        [&](const PcapPacketInfo& first, uint64_t first_index, const PcapPacketInfo& second,
+            uint64_t second_index, bool reordered) {
+            on_flow_match(results_, first, first_index, second, second_index, reordered, options);
+        },
+        [&](PcapFlowAligner::Side side, const PcapPacketInfo& packet, uint64_t index) {
+            on_flow_unmatched(results_, side == PcapFlowAligner::FIRST, packet, index);
+        });
+
+    // Feed both captures in step so a partner is never far behind
+    PcapPacketInfo packet1, packet2;
+    bool more1 = next1(packet1);
+    bool more2 = next2(packet2);
+    while (more1 || more2) {
+        if (more1) {
+            if (stats1) {
+                add_to_statistics(*stats1, packet1);
+            }
+            aligner.add(PcapFlowAligner::FIRST, std::move(packet1));
+            more1 = next1(packet1);
+        }
+        if (more2) {
+            if (stats2) {
+                add_to_statistics(*stats2, packet2);
+            }
+            aligner.add(PcapFlowAligner::SECOND, std::move(packet2));
+            more2 = next2(packet2);
+        }
+    }
+    aligner.finish();
+}
+
+void PcapDiff::compare_sharded(const PacketSource& next1, const PacketSource& next2,
+                               const PcapDiffOptions& options, size_t shards, PcapStatistics* stats1,
+                               PcapStatistics* stats2) {
+    // One queue per worker and capture. Every round of ROUND_PACKETS
+    // indexes, each reader hands every worker a batch, possibly empty, so
+    // a worker pairs the two captures by taking one batch from each; the
+    // readers never get more than QUEUE_BATCHES rounds ahead.
+    std::vector<BatchQueue> queues(2 * shards);
+    std::vector<Results> shard_results(shards, results_);
+    uint64_t counts[2] = {0, 0};
+    bool by_flow = options.mode == PcapDiffMode::BY_FLOW;
+
+    auto read = [&](int side, const PacketSource& next, PcapStatistics* stats) {
+        std::vector<Batch> batches(shards);
+        PcapPacketInfo packet;
+        uint64_t index = 0;
+        while (next(packet)) {
+            if (index > 0 && index % ROUND_PACKETS == 0) {
+                for (size_t shard = 0; shard < shards; ++shard) {
+                    queues[2 * shard + side].push(std::move(batches[shard]));
+                    batches[shard] = Batch{};
+                }
+            }
+            if (stats) {
+                add_to_statistics(*stats, packet);
+            }
+            size_t shard = by_flow ? PcapFlowKeyHash{}(PcapFlowAligner::flow_key(packet)) % shards
+                                   : index / ROUND_PACKETS % shards;
+            batches[shard].packets.push_back({index++, std::move(packet)});
+        }
+        counts[side] = index;
+        for (size_t shard = 0; shard < shards; ++shard) {
+            batches[shard].last = true;
+            queues[2 * shard + side].push(std::move(batches[shard]));
+        }
+    };
+
+    auto work = [&](size_t shard) {
+        Results& results = shard_results[shard];
+        std::unique_ptr<PcapFlowAligner> aligner;
+        if (by_flow) {
+            aligner.reset(new PcapFlowAligner(
+                options.alignment_window,
+                [&](const PcapPacketInfo& first, uint64_t first_index, const PcapPacketInfo& second,
+                    uint64_t second_index, bool reordered) {
+                    on_flow_match(results, first, first_index, second, second_index, reordered, options);
+                },
+                [&](PcapFlowAligner::Side side, const PcapPacketInfo& packet, uint64_t index) {
+                    on_flow_unmatched(results, side == PcapFlowAligner::FIRST, packet, index);
+                }));
+        }
+
+        Batch batches[2];
+        bool done[2] = {false, false};
+        while (!done[0] || !done[1]) {
+            for (int side = 0; side < 2; ++side) {
+                if (done[side]) {
+                    batches[side].packets.clear();
+                } else {
+                    batches[side] = queues[2 * shard + side].pop();
+                    done[side] = batches[side].last;
+                }
+            }
+
+            // Merge by index, the first capture first on ties, as compare_flows feeds them
+            auto& first = batches[0].packets;
+            auto& second = batches[1].packets;
+            size_t i = 0, j = 0;
+            if (aligner) {
+                while (i < first.size() || j < second.size()) {
+                    if (j == second.size() || (i < first.size() && first[i].index <= second[j].index)) {
+                        aligner->add(PcapFlowAligner::FIRST, std::move(first[i].packet), first[i].index);
+                        i++;
+                    } else {
+                        aligner->add(PcapFlowAligner::SECOND, std::move(second[j].packet), second[j].index);
+                        j++;
+                    }
+                }
+                continue;
+            }
+            while (i < first.size() && j < second.size()) {
+                if (first[i].index < second[j].index) {
+                    i++;
+                } else if (second[j].index < first[i].index) {
+                    j++;
+                } else {
+                    uint64_t found = results.found;
+                    compare_packet(results, first[i].packet, second[j].packet, first[i].index, options);
+                    results.summary.modified += results.found != found;
+                    i++;
+                    j++;
+                }
+            }
+        }
+        if (aligner) {
+            aligner->finish();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t shard = 0; shard < shards; ++shard) {
+        threads.emplace_back(work, shard);
+    }
+    threads.emplace_back(read, 0, std::cref(next1), stats1);
+    threads.emplace_back(read, 1, std::cref(next2), stats2);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    results_.merge(shard_results);
+    if (!by_flow) {
+        results_.summary.matched = std::min(counts[0], counts[1]);
+        results_.summary.missing = counts[0] - results_.summary.matched;
+        results_.summary.extra = counts[1] - results_.summary.matched;
+    }
+}
+
+void PcapDiff::on_flow_match(Results& results, const PcapPacketInfo& first, uint64_t first_index,
+                             const PcapPacketInfo& second, uint64_t second_index, bool reordered,
+                             const PcapDiffOptions& options) {
+    results.summary.matched++;
+    uint64_t found = results.found;
+    compare_packet(results, first, second, first_index, options);
+    if (results.found != found) {
+        results.summary.modified++;
+    }
+    if (reordered) {
+        results.summary.reordered++;
+        PcapDifference diff;
+        diff.type = "Packet Reordered";
+        diff.packet_index = first_index;
+        diff.description = "Arrived as packet " + std::to_string(second_index) +
+                           " of the second capture, after later packets of " + describe_flow(first);
+        results.add(diff);
+    }
+}
+
+void PcapDiff::on_flow_unmatched(Results& results, bool in_first, const PcapPacketInfo& packet, uint64_t index) {
+    PcapDifference diff;
+    diff.packet_index = index;
+    if (in_first) {
+        results.summary.missing++;
+        diff.type = "Missing Packet";
+        diff.description = "Not in the second capture: " + describe_flow(packet);
+    } else {
+        results.summary.extra++;
+        diff.type = "Extra Packet";
+        diff.description = "Only in the second capture (index is in that capture): " + describe_flow(packet);
+    }
+    results.add(diff);
+}
+
+void PcapDiff::compare_packet(Results& results, const PcapPacketInfo& packet1, const PcapPacketInfo& packet2,
+                              size_t packet_index, const PcapDiffOptions& options) {
     // Compare packet size
     if (packet1.size != packet2.size) {
         PcapDifference diff;
@@ -94,19 +473,19 @@ void PcapDiff::compare_packet(const PacketInfo& packet1, const PacketInfo& packe
         diff.packet_index = packet_index;
         diff.description = "Different packet sizes: " + std::to_string(packet1.size) + 
                           " vs " + std::to_string(packet2.size);
-        differences_.push_back(diff);
+        results.add(diff);
     }
 
     // Compare timestamps (with tolerance)
     auto time_diff = std::abs(std::chrono::duration_cast<std::chrono::microseconds>(
         packet1.timestamp - packet2.timestamp).count());
-    if (time_diff > options.timestamp_tolerance_us) {
+    if (static_cast<uint64_t>(time_diff) > options.timestamp_tolerance_us) {
         PcapDifference diff;
         diff.type = "Timestamp Mismatch";
         diff.packet_index = packet_index;
         diff.description = "Different timestamps: " + 
                           std::to_string(time_diff) + " us difference";
-        differences_.push_back(diff);
+        results.add(diff);
     }
 
     // Compare packet data (if enabled)
@@ -116,25 +495,25 @@ void PcapDiff::compare_packet(const PacketInfo& packet1, const PacketInfo& packe
             diff.type = "Payload Mismatch";
             diff.packet_index = packet_index;
             diff.description = "Different packet payloads";
-            differences_.push_back(diff);
+            results.add(diff);
         }
     }
 
     // Compare protocol-specific fields
     if (options.compare_protocols) {
-        compare_protocol_fields(packet1, packet2, packet_index);
+        compare_protocol_fields(results, packet1, packet2, packet_index);
     }
 }
 
-void PcapDiff::compare_protocol_fields(const PacketInfo& packet1, const PacketInfo& packet2, 
-                                      size_t packet_index) {
+void PcapDiff::compare_protocol_fields(Results& results, const PcapPacketInfo& packet1,
+                                       const PcapPacketInfo& packet2, size_t packet_index) {
     // Compare IP fields
     if (packet1.src_ip != packet2.src_ip) {
         PcapDifference diff;
         diff.type = "Source IP Mismatch";
         diff.packet_index = packet_index;
         diff.description = "Different source IPs: " + packet1.src_ip + " vs " + packet2.src_ip;
-        differences_.push_back(diff);
+        results.add(diff);
     }
 
     if (packet1.dst_ip != packet2.dst_ip) {
@@ -142,7 +521,7 @@ void PcapDiff::compare_protocol_fields(const PacketInfo& packet1, const PacketIn
         diff.type = "Destination IP Mismatch";
         diff.packet_index = packet_index;
         diff.description = "Different destination IPs: " + packet1.dst_ip + " vs " + packet2.dst_ip;
-        differences_.push_back(diff);
+        results.add(diff);
     }
 
     if (packet1.protocol != packet2.protocol) {
@@ -151,7 +530,7 @@ void PcapDiff::compare_protocol_fields(const PacketInfo& packet1, const PacketIn
         diff.packet_index = packet_index;
         diff.description = "Different protocols: " + std::to_string(packet1.protocol) + 
                           " vs " + std::to_string(packet2.protocol);
-        differences_.push_back(diff);
+        results.add(diff);
     }
 
     // Compare TCP/UDP fields
@@ -161,7 +540,7 @@ void PcapDiff::compare_protocol_fields(const PacketInfo& packet1, const PacketIn
         diff.packet_index = packet_index;
         diff.description = "Different source ports: " + std::to_string(packet1.src_port) + 
                           " vs " + std::to_string(packet2.src_port);
-        differences_.push_back(diff);
+        results.add(diff);
     }
 
     if (packet1.dst_port != packet2.dst_port) {
@@ -170,7 +549,7 @@ void PcapDiff::compare_protocol_fields(const PacketInfo& packet1, const PacketIn
         diff.packet_index = packet_index;
         diff.description = "Different destination ports: " + std::to_string(packet1.dst_port) + 
                           " vs " + std::to_string(packet2.dst_port);
-        differences_.push_back(diff);
+        results.add(diff);
     }
 }
 
@@ -182,7 +561,7 @@ void PcapDiff::compare_statistics(const PcapStatistics& stats1, const PcapStatis
         diff.description = "Different total packet counts: " + 
                           std::to_string(stats1.total_packets) + " vs " + 
                           std::to_string(stats2.total_packets);
-        differences_.push_back(diff);
+        results_.add(diff);
     }
 
     // Compare total bytes
@@ -192,7 +571,7 @@ void PcapDiff::compare_statistics(const PcapStatistics& stats1, const PcapStatis
         diff.description = "Different total byte counts: " + 
                           std::to_string(stats1.total_bytes) + " vs " + 
                           std::to_string(stats2.total_bytes);
-        differences_.push_back(diff);
+        results_.add(diff);
     }
 
     // Compare protocol distributions
@@ -202,116 +581,73 @@ void PcapDiff::compare_statistics(const PcapStatistics& stats1, const PcapStatis
             PcapDifference diff;
             diff.type = "Protocol Distribution Mismatch";
             diff.description = "Protocol " + std::to_string(protocol) + " missing in second file";
-            differences_.push_back(diff);
+            results_.add(diff);
         } else if (it->second != count1) {
             PcapDifference diff;
             diff.type = "Protocol Distribution Mismatch";
             diff.description = "Different counts for protocol " + std::to_string(protocol) + 
                               ": " + std::to_string(count1) + " vs " + std::to_string(it->second);
-            differences_.push_back(diff);
+            results_.add(diff);
         }
     }
 }
 
-bool PcapDiff::read_pcap_file(const std::string& file_path, PcapData& pcap_data) {
-    // Use tshark to parse PCAP file
-    std::ostringstream cmd;
-    cmd << "tshark -r " << file_path << " -T fields -e frame.number -e frame.time_epoch "
-        << "-e ip.src -e ip.dst -e ip.proto -e tcp.srcport -e tcp.dstport "
-        << "-e udp.srcport -e udp.dstport -e frame.len -e frame.data";
-
-    FILE* pipe = popen(cmd.str().c_str(), "r");
-    if (!pipe) {
+bool PcapDiff::read_pcap_file(const std::string& file_path, PcapData& pcap_data, bool copy_data) {
+    PcapReader reader;
+    if (!reader.open(file_path)) {
         return false;
     }
 
-    char buffer[4096];
-    while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
-        std::string line(buffer);
-        std::istringstream iss(line);
-        std::string token;
-        std::vector<std::string> tokens;
-
-        while (std::getline(iss, token, '\t')) {
-            tokens.push_back(token);
-        }
-
-        if (tokens.size() >= 8) {
-            PacketInfo packet;
-            packet.packet_number = std::stoul(tokens[0]);
-            
-            // Parse timestamp
-            double epoch_time = std::stod(tokens[1]);
-            auto time_point = std::chrono::system_clock::from_time_t(static_cast<time_t>(epoch_time));
-            packet.timestamp = time_point;
-
-            packet.src_ip = tokens[2];
-            packet.dst_ip = tokens[3];
-            packet.protocol = std::stoi(tokens[4]);
-            
-            // Parse ports (handle both TCP and UDP)
-            if (!tokens[5].empty()) {
-                packet.src_port = std::stoi(tokens[5]);
-            }
-            if (!tokens[6].empty()) {
-                packet.dst_port = std::stoi(tokens[6]);
-            }
-            
-            packet.size = std::stoul(tokens[7]);
-            
-            // Parse payload data
-            if (tokens.size() > 8 && !tokens[8].empty()) {
-                packet.data = hex_string_to_bytes(tokens[8]);
-            }
-
-            pcap_data.packets.push_back(packet);
-        }
+    pcap_data.packets.clear();
+    PcapPacketInfo packet;
+    while (reader.next(packet, copy_data)) {
+        pcap_data.packets.push_back(packet);
     }
 
-    pclose(pipe);
-
     // Calculate statistics
     calculate_statistics(pcap_data);
 
-    return true;
+    return !reader.truncated();
 }
 
 void PcapDiff::calculate_statistics(PcapData& pcap_data) {
-    pcap_data.stats.total_packets = pcap_data.packets.size();
-    pcap_data.stats.total_bytes = 0;
-
+    pcap_data.stats = PcapStatistics{};
     for (const auto& packet : pcap_data.packets) {
-        pcap_data.stats.total_bytes += packet.size;
-        pcap_data.stats.protocol_counts[packet.protocol]++;
+        add_to_statistics(pcap_data.stats, packet);
     }
 }
 
-std::vector<uint8_t> PcapDiff::hex_string_to_bytes(const std::string& hex_string) {
-    std::vector<uint8_t> bytes;
-    
-    for (size_t i = 0; i < hex_string.length(); i += 2) {
-        std::string byte_string = hex_string.substr(i, 2);
-        if (byte_string.length() == 2) {
-            uint8_t byte = static_cast<uint8_t>(std::stoul(byte_string, nullptr, 16));
-            bytes.push_back(byte);
-        }
+void PcapDiff::add_to_statistics(PcapStatistics& stats, const PcapPacketInfo& packet) {
+    if (stats.total_packets == 0 || packet.timestamp < stats.start_time) {
+        stats.start_time = packet.timestamp;
     }
-    
-    return bytes;
+    if (stats.total_packets == 0 || packet.timestamp > stats.end_time) {
+        stats.end_time = packet.timestamp;
+    }
+    stats.total_packets++;
+    stats.total_bytes += packet.size;
+    stats.protocol_counts[packet.protocol]++;
 }
 
 std::vector<PcapDifference> PcapDiff::get_differences() const {
-    return differences_;
+    return results_.differences;
 }
 
 void PcapDiff::print_differences() const {
-    if (differences_.empty()) {
+    if (results_.found == 0) {
         std::cout << "No differences found between PCAP files." << std::endl;
         return;
     }
 
-    std::cout << "Found " << differences_.size() << " differences:" << std::endl;
-    for (const auto& diff : differences_) {
+    std::cout << "Matched " << results_.summary.matched << " packets (" << results_.summary.modified << " modified, "
+              << results_.summary.reordered << " reordered), " << results_.summary.missing << " missing, "
+              << results_.summary.extra << " extra" << std::endl;
+    std::cout << "Found " << results_.found << " differences";
+    if (results_.summary.differences_dropped > 0) {
+        std::cout << ", showing the first " << results_.differences.size();
+    }
+    std::cout << ":" << std::endl;
+    for (const auto& diff : results_.differences) {
         std::cout << "  [" << diff.type << "]";
         if (diff.packet_index != SIZE_MAX) {
             std::cout << " Packet " << diff.packet_index;
@@ -328,10 +664,15 @@ bool PcapDiff::save_differences(const std::string& output_file) const {
 
     file << "PCAP Diff Report" << std::endl;
     file << "================" << std::endl;
-    file << "Total differences: " << differences_.size() << std::endl;
+    file << "Total differences: " << results_.found << std::endl;
+    file << "Matched: " << results_.summary.matched << ", modified: " << results_.summary.modified << ", reordered: "
+         << results_.summary.reordered << ", missing: " << results_.summary.missing << ", extra: " << results_.summary.extra << std::endl;
+    if (results_.summary.differences_dropped > 0) {
+        file << "Listed: " << results_.differences.size() << std::endl;
+    }
     file << std::endl;
 
-    for (const auto& diff : differences_) {
+    for (const auto& diff : results_.differences) {
         file << "Type: " << diff.type << std::endl;
         if (diff.packet_index != SIZE_MAX) {
             file << "Packet: " << diff.packet_index << std::endl;
@@ -344,7 +685,7 @@ bool PcapDiff::save_differences(const std::string& output_file) const {
 }
 
 // PcapCapture implementation
-PcapCapture::PcapCapture() : initialized_(false), capturing_(false) {
+PcapCapture::PcapCapture() : initialized_(false), capturing_(false), capture_process_(nullptr) {
 }
 
 PcapCapture::~PcapCapture() {
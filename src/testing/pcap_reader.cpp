@@ -0,0 +1,587 @@
+#include "testing/pcap_reader.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace RouterSim {
+
+namespace {
+
+const uint32_t PCAP_MAGIC_MICRO = 0xa1b2c3d4;
+const uint32_t PCAP_MAGIC_NANO = 0xa1b23c4d;
+const size_t PCAP_HEADER_BYTES = 24;
+const size_t PCAP_RECORD_HEADER_BYTES = 16;
+
+const uint32_t PCAPNG_SECTION_HEADER = 0x0a0d0d0a;
+const uint32_t PCAPNG_INTERFACE_DESCRIPTION = 0x00000001;
+const uint32_t PCAPNG_OBSOLETE_PACKET = 0x00000002;
+const uint32_t PCAPNG_SIMPLE_PACKET = 0x00000003;
+const uint32_t PCAPNG_ENHANCED_PACKET = 0x00000006;
+const uint32_t PCAPNG_BYTE_ORDER_MAGIC = 0x1a2b3c4d;
+const size_t PCAPNG_MIN_BLOCK_BYTES = 12;
+const uint16_t PCAPNG_OPTION_END = 0;
+const uint16_t PCAPNG_IF_TSRESOL = 9;
+const uint16_t PCAPNG_IF_TSOFFSET = 14;
+
+const uint16_t ETHERTYPE_IPV4 = 0x0800;
+const uint16_t ETHERTYPE_IPV6 = 0x86dd;
+const uint16_t ETHERTYPE_VLAN = 0x8100;
+const uint16_t ETHERTYPE_QINQ = 0x88a8;
+const uint16_t ETHERTYPE_QINQ_OLD = 0x9100;
+
+const uint8_t PROTOCOL_HOPOPTS = 0;
+const uint8_t PROTOCOL_TCP = 6;
+const uint8_t PROTOCOL_UDP = 17;
+const uint8_t PROTOCOL_ROUTING = 43;
+const uint8_t PROTOCOL_FRAGMENT = 44;
+const uint8_t PROTOCOL_AH = 51;
+const uint8_t PROTOCOL_DSTOPTS = 60;
+const uint8_t PROTOCOL_SCTP = 132;
+const uint8_t PROTOCOL_UDPLITE = 136;
+const int MAX_IPV6_EXTENSION_HEADERS = 8;
+
+const uint64_t NANOSECONDS_PER_SECOND = 1000000000ull;
+
+uint16_t load_be16(const uint8_t* data) {
+    return static_cast<uint16_t>(data[0] << 8 | data[1]);
+}
+
+uint32_t load_be32(const uint8_t* data) {
+    return static_cast<uint32_t>(data[0]) << 24 | static_cast<uint32_t>(data[1]) << 16 |
+           static_cast<uint32_t>(data[2]) << 8 | data[3];
+}
+
+// Family values used by BSD loopback headers across platforms
+bool is_ipv6_family(uint32_t family) {
+    return family == 24 || family == 28 || family == 30 || family == AF_INET6;
+}
+
+void format_ipv4(const uint8_t* address, std::string& out) {
+    char buffer[16];
+    char* p = buffer;
+    for (int i = 0; i < 4; ++i) {
+        unsigned value = address[i];
+        if (value >= 100) {
+            *p++ = static_cast<char>('0' + value / 100);
+        }
+        if (value >= 10) {
+            *p++ = static_cast<char>('0' + value / 10 % 10);
+        }
+        *p++ = static_cast<char>('0' + value % 10);
+        if (i < 3) {
+            *p++ = '.';
+        }
+    }
+    out.assign(buffer, p);
+}
+
+void format_ipv6(const uint8_t* address, std::string& out) {
+    char buffer[INET6_ADDRSTRLEN];
+    if (inet_ntop(AF_INET6, address, buffer, sizeof(buffer))) {
+        out.assign(buffer);
+    } else {
+        out.clear();
+    }
+}
+
+void decode_ports(const uint8_t* data, size_t length, PcapPacketInfo& packet) {
+    bool has_ports = packet.protocol == PROTOCOL_TCP || packet.protocol == PROTOCOL_UDP ||
+                     packet.protocol == PROTOCOL_SCTP || packet.protocol == PROTOCOL_UDPLITE;
+    if (has_ports && length >= 4) {
+        packet.src_port = load_be16(data);
+        packet.dst_port = load_be16(data + 2);
+    }
+    if (packet.protocol == PROTOCOL_TCP && length >= 12) {
+        packet.tcp_seq = load_be32(data + 4);
+        packet.tcp_ack = load_be32(data + 8);
+    }
+}
+
+bool decode_ipv4(const uint8_t* data, size_t length, PcapPacketInfo& packet) {
+    if (length < 20 || data[0] >> 4 != 4) {
+        return false;
+    }
+    size_t header_length = (data[0] & 0x0f) * 4u;
+    packet.dscp = data[1] >> 2;
+    packet.ttl = data[8];
+    packet.protocol = data[9];
+    packet.ip_id = load_be16(data + 4);
+    format_ipv4(data + 12, packet.src_ip);
+    format_ipv4(data + 16, packet.dst_ip);
+
+    // Only the first fragment carries the transport header
+    bool later_fragment = (load_be16(data + 6) & 0x1fff) != 0;
+    if (header_length >= 20 && header_length <= length && !later_fragment) {
+        decode_ports(data + header_length, length - header_length, packet);
+    }
+    return true;
+}
+
+bool decode_ipv6(const uint8_t* data, size_t length, PcapPacketInfo& packet) {
+    if (length < 40 || data[0] >> 4 != 6) {
+        return false;
+    }
+    uint8_t traffic_class = static_cast<uint8_t>((data[0] & 0x0f) << 4 | data[1] >> 4);
+    packet.dscp = traffic_class >> 2;
+    packet.ttl = data[7];
+    format_ipv6(data + 8, packet.src_ip);
+    format_ipv6(data + 24, packet.dst_ip);
+
+    // Walk extension headers to the upper-layer protocol
+    uint8_t next_header = data[6];
+    size_t offset = 40;
+    bool later_fragment = false;
+    for (int i = 0; i < MAX_IPV6_EXTENSION_HEADERS; ++i) {
+        size_t header_length;
+        if (next_header == PROTOCOL_HOPOPTS || next_header == PROTOCOL_ROUTING ||
+            next_header == PROTOCOL_DSTOPTS) {
+            if (offset + 2 > length) {
+                break;
+            }
+            header_length = (data[offset + 1] + 1u) * 8;
+        } else if (next_header == PROTOCOL_FRAGMENT) {
+            if (offset + 8 > length) {
+                break;
+            }
+            header_length = 8;
+            later_fragment = (load_be16(data + offset + 2) >> 3) != 0;
+            packet.ip_id = load_be32(data + offset + 4);
+        } else if (next_header == PROTOCOL_AH) {
+            if (offset + 2 > length) {
+                break;
+            }
+            header_length = (data[offset + 1] + 2u) * 4;
+        } else {
+            break;
+        }
+        next_header = data[offset];
+        offset += header_length;
+    }
+
+    packet.protocol = next_header;
+    if (offset <= length && !later_fragment) {
+        decode_ports(data + offset, length - offset, packet);
+    }
+    return true;
+}
+
+uint64_t to_nanoseconds(uint64_t units, uint64_t units_per_second, int64_t offset_seconds) {
+    uint64_t seconds = units / units_per_second;
+    uint64_t remainder = units % units_per_second;
+    uint64_t fraction_ns;
+    if (units_per_second <= NANOSECONDS_PER_SECOND && NANOSECONDS_PER_SECOND % units_per_second == 0) {
+        fraction_ns = remainder * (NANOSECONDS_PER_SECOND / units_per_second);
+    } else {
+        fraction_ns = static_cast<uint64_t>(static_cast<long double>(remainder) * NANOSECONDS_PER_SECOND /
+                                            units_per_second);
+    }
+    return (seconds + offset_seconds) * NANOSECONDS_PER_SECOND + fraction_ns;
+}
+
+} // namespace
+
+PcapReader::PcapReader()
+    : map_(nullptr), size_(0), offset_(0), first_record_(0), format_(Format::NONE), swapped_(false),
+      nanosecond_(false), link_type_(0), records_read_(0), truncated_(false) {
+}
+
+PcapReader::~PcapReader() {
+    close();
+}
+
+bool PcapReader::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Failed to open " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size < static_cast<off_t>(PCAPNG_MIN_BLOCK_BYTES)) {
+        std::cerr << "Not a capture file: " << path << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(status.st_size);
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        std::cerr << "Failed to map " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    madvise(map, size, MADV_SEQUENTIAL);
+    map_ = static_cast<const uint8_t*>(map);
+    size_ = size;
+
+    uint32_t magic;
+    std::memcpy(&magic, map_, sizeof(magic));
+    if (magic == PCAPNG_SECTION_HEADER) {
+        format_ = Format::PCAPNG;
+        first_record_ = 0;
+    } else if (size_ >= PCAP_HEADER_BYTES &&
+               (magic == PCAP_MAGIC_MICRO || magic == __builtin_bswap32(PCAP_MAGIC_MICRO) ||
+                magic == PCAP_MAGIC_NANO || magic == __builtin_bswap32(PCAP_MAGIC_NANO))) {
+        format_ = Format::PCAP;
+        swapped_ = magic != PCAP_MAGIC_MICRO && magic != PCAP_MAGIC_NANO;
+        nanosecond_ = magic == PCAP_MAGIC_NANO || magic == __builtin_bswap32(PCAP_MAGIC_NANO);
+        // The upper bits hold FCS information in newer files
+        link_type_ = read32(20) & 0xffff;
+        first_record_ = PCAP_HEADER_BYTES;
+    } else {
+        std::cerr << "Not a pcap or pcapng file: " << path << std::endl;
+        close();
+        return false;
+    }
+
+    rewind();
+    return true;
+}
+
+void PcapReader::close() {
+    if (map_) {
+        munmap(const_cast<uint8_t*>(map_), size_);
+    }
+    map_ = nullptr;
+    size_ = 0;
+    offset_ = 0;
+    first_record_ = 0;
+    format_ = Format::NONE;
+    swapped_ = false;
+    nanosecond_ = false;
+    link_type_ = 0;
+    interfaces_.clear();
+    records_read_ = 0;
+    truncated_ = false;
+}
+
+void PcapReader::rewind() {
+    offset_ = first_record_;
+    records_read_ = 0;
+    truncated_ = false;
+    interfaces_.clear();
+}
+
+bool PcapReader::next_record(PcapRecord& record) {
+    bool found = false;
+    if (format_ == Format::PCAP) {
+        found = next_pcap_record(record);
+    } else if (format_ == Format::PCAPNG) {
+        found = next_pcapng_record(record);
+    }
+    if (found) {
+        records_read_++;
+    }
+    return found;
+}
+
+bool PcapReader::next(PcapPacketInfo& packet, bool copy_data) {
+    PcapRecord record;
+    if (!next_record(record)) {
+        return false;
+    }
+    decode(record, packet, copy_data);
+    packet.packet_number = records_read_;
+    return true;
+}
+
+bool PcapReader::decode(const PcapRecord& record, PcapPacketInfo& packet, bool copy_data) {
+    packet.timestamp = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(record.timestamp_ns)));
+    packet.size = record.original_length;
+    packet.src_ip.clear();
+    packet.dst_ip.clear();
+    packet.protocol = 0;
+    packet.src_port = 0;
+    packet.dst_port = 0;
+    packet.dscp = 0;
+    packet.ttl = 0;
+    packet.ip_id = 0;
+    packet.tcp_seq = 0;
+    packet.tcp_ack = 0;
+    if (copy_data) {
+        packet.data.assign(record.data, record.data + record.captured_length);
+    } else {
+        packet.data.clear();
+    }
+
+    const uint8_t* data = record.data;
+    size_t length = record.captured_length;
+    uint16_t ethertype = 0;
+    size_t offset = 0;
+
+    switch (static_cast<LinkType>(record.link_type)) {
+        case LinkType::ETHERNET:
+            if (length < 14) {
+                return false;
+            }
+            ethertype = load_be16(data + 12);
+            offset = 14;
+            while ((ethertype == ETHERTYPE_VLAN || ethertype == ETHERTYPE_QINQ ||
+                    ethertype == ETHERTYPE_QINQ_OLD) && offset + 4 <= length) {
+                ethertype = load_be16(data + offset + 2);
+                offset += 4;
+            }
+            break;
+        case LinkType::LINUX_SLL:
+            if (length < 16) {
+                return false;
+            }
+            ethertype = load_be16(data + 14);
+            offset = 16;
+            break;
+        case LinkType::LINUX_SLL2:
+            if (length < 20) {
+                return false;
+            }
+            ethertype = load_be16(data);
+            offset = 20;
+            break;
+        case LinkType::NULL_LOOPBACK: {
+            if (length < 4) {
+                return false;
+            }
+            // The family is in the capturing host's byte order
+            uint32_t family;
+            std::memcpy(&family, data, sizeof(family));
+            uint32_t swapped = __builtin_bswap32(family);
+            if (family == AF_INET || swapped == AF_INET) {
+                ethertype = ETHERTYPE_IPV4;
+            } else if (is_ipv6_family(family) || is_ipv6_family(swapped)) {
+                ethertype = ETHERTYPE_IPV6;
+            }
+            offset = 4;
+            break;
+        }
+        case LinkType::RAW:
+        case LinkType::IPV4:
+        case LinkType::IPV6:
+            if (length < 1) {
+                return false;
+            }
+            ethertype = data[0] >> 4 == 6 ? ETHERTYPE_IPV6 : ETHERTYPE_IPV4;
+            break;
+        default:
+            return false;
+    }
+
+    if (ethertype == ETHERTYPE_IPV4) {
+        return decode_ipv4(data + offset, length - offset, packet);
+    }
+    if (ethertype == ETHERTYPE_IPV6) {
+        return decode_ipv6(data + offset, length - offset, packet);
+    }
+    return false;
+}
+
+uint16_t PcapReader::read16(size_t offset) const {
+    uint16_t value;
+    std::memcpy(&value, map_ + offset, sizeof(value));
+    return swapped_ ? __builtin_bswap16(value) : value;
+}
+
+uint32_t PcapReader::read32(size_t offset) const {
+    uint32_t value;
+    std::memcpy(&value, map_ + offset, sizeof(value));
+    return swapped_ ? __builtin_bswap32(value) : value;
+}
+
+uint64_t PcapReader::read64(size_t offset) const {
+    uint64_t value;
+    std::memcpy(&value, map_ + offset, sizeof(value));
+    return swapped_ ? __builtin_bswap64(value) : value;
+}
+
+bool PcapReader::next_pcap_record(PcapRecord& record) {
+    if (offset_ + PCAP_RECORD_HEADER_BYTES > size_) {
+        truncated_ = offset_ != size_;
+        offset_ = size_;
+        return false;
+    }
+
+    uint32_t seconds = read32(offset_);
+    uint32_t fraction = read32(offset_ + 4);
+    uint32_t captured = read32(offset_ + 8);
+    uint32_t original = read32(offset_ + 12);
+    size_t data_offset = offset_ + PCAP_RECORD_HEADER_BYTES;
+    if (captured > size_ - data_offset) {
+        truncated_ = true;
+        offset_ = size_;
+        return false;
+    }
+
+    record.timestamp_ns = seconds * NANOSECONDS_PER_SECOND + (nanosecond_ ? fraction : fraction * 1000ull);
+    record.captured_length = captured;
+    record.original_length = std::max(original, captured);
+    record.link_type = link_type_;
+    record.interface_id = 0;
+    record.data = map_ + data_offset;
+    offset_ = data_offset + captured;
+    return true;
+}
+
+bool PcapReader::next_pcapng_record(PcapRecord& record) {
+    while (offset_ < size_) {
+        if (offset_ + PCAPNG_MIN_BLOCK_BYTES > size_) {
+            break;
+        }
+
+        uint32_t type = read32(offset_);
+        if (type == PCAPNG_SECTION_HEADER) {
+            // The section's byte order is only known once its magic is read
+            if (offset_ + 16 > size_) {
+                break;
+            }
+            uint32_t magic;
+            std::memcpy(&magic, map_ + offset_ + 8, sizeof(magic));
+            if (magic != PCAPNG_BYTE_ORDER_MAGIC && magic != __builtin_bswap32(PCAPNG_BYTE_ORDER_MAGIC)) {
+                break;
+            }
+            swapped_ = magic != PCAPNG_BYTE_ORDER_MAGIC;
+        }
+
+        size_t block = offset_;
+        size_t length = read32(block + 4);
+        if (length < PCAPNG_MIN_BLOCK_BYTES || length % 4 != 0 || length > size_ - block) {
+            break;
+        }
+        size_t body_end = block + length - 4;
+        offset_ = block + length;
+
+        switch (type) {
+            case PCAPNG_SECTION_HEADER:
+                if (!read_section_header(block, length)) {
+                    truncated_ = true;
+                    offset_ = size_;
+                    return false;
+                }
+                break;
+            case PCAPNG_INTERFACE_DESCRIPTION:
+                if (!read_interface_block(block, length)) {
+                    truncated_ = true;
+                    offset_ = size_;
+                    return false;
+                }
+                break;
+            case PCAPNG_ENHANCED_PACKET:
+            case PCAPNG_OBSOLETE_PACKET: {
+                if (length < 32) {
+                    break;
+                }
+                uint32_t interface_id = type == PCAPNG_ENHANCED_PACKET ? read32(block + 8) : read16(block + 8);
+                uint32_t captured = read32(block + 20);
+                uint32_t original = read32(block + 24);
+                if (interface_id >= interfaces_.size() || captured > body_end - (block + 28)) {
+                    truncated_ = true;
+                    offset_ = size_;
+                    return false;
+                }
+                const Interface& interface = interfaces_[interface_id];
+                uint64_t units = static_cast<uint64_t>(read32(block + 12)) << 32 | read32(block + 16);
+                record.timestamp_ns = to_nanoseconds(units, interface.units_per_second, interface.offset_seconds);
+                record.captured_length = captured;
+                record.original_length = std::max(original, captured);
+                record.link_type = interface.link_type;
+                record.interface_id = interface_id;
+                record.data = map_ + block + 28;
+                return true;
+            }
+            case PCAPNG_SIMPLE_PACKET: {
+                if (length < 16 || interfaces_.empty()) {
+                    truncated_ = true;
+                    offset_ = size_;
+                    return false;
+                }
+                // No timestamp; the captured length follows from the block and snap lengths
+                const Interface& interface = interfaces_[0];
+                uint32_t original = read32(block + 8);
+                size_t captured = std::min<size_t>(original, body_end - (block + 12));
+                if (interface.snap_length > 0) {
+                    captured = std::min<size_t>(captured, interface.snap_length);
+                }
+                record.timestamp_ns = 0;
+                record.captured_length = static_cast<uint32_t>(captured);
+                record.original_length = original;
+                record.link_type = interface.link_type;
+                record.interface_id = 0;
+                record.data = map_ + block + 12;
+                return true;
+            }
+            default:
+                break;
+        }
+    }
+
+    truncated_ = offset_ != size_;
+    offset_ = size_;
+    return false;
+}
+
+bool PcapReader::read_section_header(size_t offset, size_t length) {
+    if (length < 28 || read16(offset + 12) != 1) {
+        return false;
+    }
+    // Interface ids restart in every section
+    interfaces_.clear();
+    return true;
+}
+
+bool PcapReader::read_interface_block(size_t offset, size_t length) {
+    if (length < 20) {
+        return false;
+    }
+
+    Interface interface;
+    interface.link_type = read16(offset + 8);
+    interface.snap_length = read32(offset + 12);
+    interface.units_per_second = 1000000;
+    interface.offset_seconds = 0;
+
+    size_t option = offset + 16;
+    size_t end = offset + length - 4;
+    while (option + 4 <= end) {
+        uint16_t code = read16(option);
+        uint16_t option_length = read16(option + 2);
+        size_t value = option + 4;
+        if (code == PCAPNG_OPTION_END || option_length > end - value) {
+            break;
+        }
+
+        if (code == PCAPNG_IF_TSRESOL && option_length >= 1) {
+            // MSB set: negative power of two, otherwise of ten
+            uint8_t resolution = map_[value];
+            uint32_t exponent = resolution & 0x7f;
+            if (resolution & 0x80) {
+                if (exponent > 63) {
+                    return false;
+                }
+                interface.units_per_second = 1ull << exponent;
+            } else {
+                if (exponent > 19) {
+                    return false;
+                }
+                interface.units_per_second = 1;
+                for (uint32_t i = 0; i < exponent; ++i) {
+                    interface.units_per_second *= 10;
+                }
+            }
+        } else if (code == PCAPNG_IF_TSOFFSET && option_length >= 8) {
+            interface.offset_seconds = static_cast<int64_t>(read64(value));
+        }
+        option = value + ((option_length + 3u) & ~3u);
+    }
+
+    interfaces_.push_back(interface);
+    return true;
+}
+
+} // namespace RouterSim
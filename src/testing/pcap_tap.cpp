@@ -0,0 +1,527 @@
+#include "testing/pcap_tap.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace RouterSim {
+
+namespace {
+
+const uint32_t PCAPNG_SECTION_HEADER = 0x0a0d0d0a;
+const uint32_t PCAPNG_INTERFACE_DESCRIPTION = 1;
+const uint32_t PCAPNG_ENHANCED_PACKET = 6;
+const uint32_t PCAPNG_BYTE_ORDER_MAGIC = 0x1a2b3c4d;
+const uint16_t PCAPNG_IF_NAME = 2;
+const uint16_t PCAPNG_IF_TSRESOL = 9;
+const uint16_t LINKTYPE_ETHERNET = 1;
+const uint8_t TSRESOL_NANOSECONDS = 9;
+
+const uint8_t PROTOCOL_TCP = 6;
+const uint8_t PROTOCOL_UDP = 17;
+const size_t ETHERNET_HEADER = 14;
+const size_t ENHANCED_PACKET_OVERHEAD = 32;
+
+const char* const STAGE_NAMES[] = {"pre-shaping", "post-shaping", "dropped"};
+
+void store16be(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value >> 8);
+    out[1] = static_cast<uint8_t>(value);
+}
+
+void store32be(uint8_t* out, uint32_t value) {
+    store16be(out, static_cast<uint16_t>(value >> 16));
+    store16be(out + 2, static_cast<uint16_t>(value));
+}
+
+// pcapng blocks are written in host byte order, as the section header says
+void store16(uint8_t* out, uint16_t value) {
+    std::memcpy(out, &value, sizeof(value));
+}
+
+void store32(uint8_t* out, uint32_t value) {
+    std::memcpy(out, &value, sizeof(value));
+}
+
+uint16_t ipv4_checksum(const uint8_t* header) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i < 20; i += 2) {
+        sum += uint32_t(header[i]) << 8 | header[i + 1];
+    }
+    while (sum >> 16) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    return static_cast<uint16_t>(~sum);
+}
+
+// Ethernet, IP and TCP/UDP headers for a descriptor; returns their length
+size_t build_headers(const PacketDescriptor& packet, uint8_t* out, size_t& frame_length) {
+    size_t l3_length = packet.is_ipv4() ? 20 : 40;
+    size_t l4_length = packet.protocol == PROTOCOL_TCP ? 20 : packet.protocol == PROTOCOL_UDP ? 8 : 0;
+    size_t length = ETHERNET_HEADER + l3_length + l4_length;
+    frame_length = std::max<size_t>(packet.size, length);
+    std::memset(out, 0, length);
+
+    static const uint8_t macs[12] = {0x02, 0, 0, 0, 0, 0x02, 0x02, 0, 0, 0, 0, 0x01};
+    std::memcpy(out, macs, sizeof(macs));
+    store16be(out + 12, packet.is_ipv4() ? 0x0800 : 0x86dd);
+
+    uint8_t* ip = out + ETHERNET_HEADER;
+    size_t ip_length = frame_length - ETHERNET_HEADER;
+    if (packet.is_ipv4()) {
+        ip[0] = 0x45;
+        ip[1] = static_cast<uint8_t>(packet.dscp << 2);
+        store16be(ip + 2, static_cast<uint16_t>(std::min<size_t>(ip_length, 0xffff)));
+        store16be(ip + 4, static_cast<uint16_t>(packet.id));
+        ip[6] = 0x40;                                           // don't fragment
+        ip[8] = 64;
+        ip[9] = packet.protocol;
+        std::memcpy(ip + 12, packet.src_addr.bytes + 12, 4);
+        std::memcpy(ip + 16, packet.dst_addr.bytes + 12, 4);
+        store16be(ip + 10, ipv4_checksum(ip));
+    } else {
+        ip[0] = static_cast<uint8_t>(0x60 | packet.dscp >> 2);
+        ip[1] = static_cast<uint8_t>(packet.dscp << 6);
+        store16be(ip + 4, static_cast<uint16_t>(std::min<size_t>(ip_length - 40, 0xffff)));
+        ip[6] = packet.protocol;
+        ip[7] = 64;
+        std::memcpy(ip + 8, packet.src_addr.bytes, 16);
+        std::memcpy(ip + 24, packet.dst_addr.bytes, 16);
+    }
+
+    uint8_t* l4 = ip + l3_length;
+    if (l4_length > 0) {
+        store16be(l4, packet.src_port);
+        store16be(l4 + 2, packet.dst_port);
+    }
+    if (packet.protocol == PROTOCOL_TCP) {
+        store32be(l4 + 4, static_cast<uint32_t>(packet.id));
+        l4[12] = 0x50;
+        l4[13] = 0x10;                                          // ACK
+        store16be(l4 + 14, 0xffff);
+    } else if (packet.protocol == PROTOCOL_UDP) {
+        store16be(l4 + 4, static_cast<uint16_t>(std::min<size_t>(ip_length - l3_length, 0xffff)));
+    }
+    return length;
+}
+
+} // namespace
+
+PcapTap::PcapTap()
+    : ring_mask_(0), tail_(0), head_(0), dropped_(0), writer_sleeping_(false), fd_(-1), direct_io_(false),
+      wall_offset_ns_(0), current_(0), running_(false), stopping_(false), captured_(0), bytes_written_(0),
+      write_calls_(0), write_failed_(false) {
+}
+
+PcapTap::~PcapTap() {
+    stop();
+}
+
+bool PcapTap::start(const std::string& path, const PcapTapOptions& options) {
+    if (running_ || writer_.joinable()) {
+        return false;
+    }
+
+    options_ = options;
+    size_t slots = 2;
+    while (slots < options.ring_slots) {
+        slots <<= 1;
+    }
+    ring_.reset(new Slot[slots]);
+    for (size_t i = 0; i < slots; ++i) {
+        ring_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    ring_mask_ = slots - 1;
+    tail_.store(0, std::memory_order_relaxed);
+    head_ = 0;
+
+    // O_DIRECT is refused by some filesystems (tmpfs); fall back to buffered
+    direct_io_ = false;
+    int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    fd_ = -1;
+    if (options.direct_io) {
+        fd_ = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        direct_io_ = fd_ >= 0;
+    }
+    if (fd_ < 0) {
+        fd_ = ::open(path.c_str(), flags, 0644);
+    }
+    if (fd_ < 0) {
+        std::cerr << "Failed to open capture file " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    size_t buffer_count = (options.write_bytes + BUFFER_SIZE - 1) / BUFFER_SIZE;
+    buffer_count = std::min(std::max<size_t>(buffer_count, 1), MAX_BUFFERS);
+    for (size_t i = 0; i < buffer_count; ++i) {
+        void* data = nullptr;
+        if (posix_memalign(&data, IO_ALIGNMENT, BUFFER_SIZE) != 0) {
+            release_buffers();
+            ::close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        buffers_.push_back({static_cast<uint8_t*>(data), 0});
+    }
+    current_ = 0;
+
+    wall_offset_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::system_clock::now().time_since_epoch()).count() -
+                      static_cast<int64_t>(packet_clock_ns());
+    dropped_.store(0, std::memory_order_relaxed);
+    captured_.store(0, std::memory_order_relaxed);
+    bytes_written_.store(0, std::memory_order_relaxed);
+    write_calls_.store(0, std::memory_order_relaxed);
+    write_failed_ = false;
+
+    // Section header, then one interface per stage
+    uint8_t block[64] = {};
+    store32(block, PCAPNG_SECTION_HEADER);
+    store32(block + 4, 28);
+    store32(block + 8, PCAPNG_BYTE_ORDER_MAGIC);
+    store16(block + 12, 1);
+    store16(block + 14, 0);
+    std::memset(block + 16, 0xff, 8);                           // section length unknown
+    store32(block + 24, 28);
+    append(block, 28);
+
+    for (const char* name : STAGE_NAMES) {
+        size_t name_length = std::strlen(name);
+        size_t padded_name = (name_length + 3) & ~size_t(3);
+        uint32_t length = static_cast<uint32_t>(36 + padded_name);
+        std::memset(block, 0, sizeof(block));
+        store32(block, PCAPNG_INTERFACE_DESCRIPTION);
+        store32(block + 4, length);
+        store16(block + 8, LINKTYPE_ETHERNET);
+        store32(block + 12, options.snaplen);
+        store16(block + 16, PCAPNG_IF_NAME);
+        store16(block + 18, static_cast<uint16_t>(name_length));
+        std::memcpy(block + 20, name, name_length);
+        uint8_t* option = block + 20 + padded_name;
+        store16(option, PCAPNG_IF_TSRESOL);
+        store16(option + 2, 1);
+        option[4] = TSRESOL_NANOSECONDS;
+        store32(option + 12, length);                           // after opt_endofopt
+        append(block, length);
+    }
+
+    stopping_.store(false, std::memory_order_relaxed);
+    running_.store(true, std::memory_order_release);
+    writer_ = std::thread(&PcapTap::writer_loop, this);
+    return true;
+}
+
+bool PcapTap::stop() {
+    if (!writer_.joinable()) {
+        return true;
+    }
+
+    running_.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stopping_.store(true, std::memory_order_release);
+    }
+    wake_cv_.notify_one();
+    writer_.join();
+
+    ::close(fd_);
+    fd_ = -1;
+    release_buffers();
+    return !write_failed_;
+}
+
+bool PcapTap::capture(CaptureStage stage, const PacketDescriptor& packet) {
+    if (!running_.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    uint64_t position = tail_.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &ring_[position & ring_mask_];
+        int64_t lag = static_cast<int64_t>(slot->sequence.load(std::memory_order_acquire) - position);
+        if (lag == 0) {
+            if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (lag < 0) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            position = tail_.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->stage = stage;
+    slot->packet = packet;
+    slot->sequence.store(position + 1, std::memory_order_release);
+    if ((position & (ring_mask_ >> 2)) == 0) {
+        wake_writer();
+    }
+    return true;
+}
+
+size_t PcapTap::capture_burst(CaptureStage stage, const PacketDescriptor* packets, size_t count,
+                              const BurstVerdict* mask) {
+    if (!running_.load(std::memory_order_acquire)) {
+        return 0;
+    }
+
+    count = std::min(count, MAX_BURST_SIZE);
+    uint16_t selected[MAX_BURST_SIZE];
+    size_t wanted = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (!mask || mask->test(i)) {
+            selected[wanted++] = static_cast<uint16_t>(i);
+        }
+    }
+    if (wanted == 0) {
+        return 0;
+    }
+
+    // Slots are freed in order, so if the last one is free they all are
+    uint64_t position = tail_.load(std::memory_order_relaxed);
+    for (;;) {
+        if (wanted > ring_mask_ + 1) {
+            break;
+        }
+        uint64_t last = position + wanted - 1;
+        int64_t lag = static_cast<int64_t>(ring_[last & ring_mask_].sequence.load(std::memory_order_acquire) - last);
+        if (lag < 0) {
+            break;
+        }
+        if (lag == 0 && tail_.compare_exchange_weak(position, position + wanted, std::memory_order_relaxed)) {
+            for (size_t i = 0; i < wanted; ++i) {
+                Slot& slot = ring_[(position + i) & ring_mask_];
+                slot.stage = stage;
+                slot.packet = packets[selected[i]];
+                slot.sequence.store(position + i + 1, std::memory_order_release);
+            }
+            // Wake the writer once per quarter of the ring
+            uint64_t quarter = ring_mask_ >> 2;
+            if (((position + quarter) & ~quarter) <= last) {
+                wake_writer();
+            }
+            return wanted;
+        }
+        if (lag > 0) {
+            position = tail_.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Not enough room for the whole burst: take what fits
+    size_t captured = 0;
+    for (size_t i = 0; i < wanted; ++i) {
+        captured += capture(stage, packets[selected[i]]);
+    }
+    return captured;
+}
+
+PcapTap::Statistics PcapTap::get_statistics() const {
+    Statistics stats;
+    stats.packets_captured = captured_.load(std::memory_order_relaxed);
+    stats.packets_dropped = dropped_.load(std::memory_order_relaxed);
+    stats.bytes_written = bytes_written_.load(std::memory_order_relaxed);
+    stats.write_calls = write_calls_.load(std::memory_order_relaxed);
+    stats.direct_io = direct_io_;
+    return stats;
+}
+
+void PcapTap::wake_writer() {
+    // Pairs with the writer publishing writer_sleeping_ before its last look at the ring
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (writer_sleeping_.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_cv_.notify_one();
+    }
+}
+
+void PcapTap::writer_loop() {
+    auto interval = std::chrono::milliseconds(std::max<uint32_t>(options_.flush_interval_ms, 1));
+    auto next_flush = std::chrono::steady_clock::now() + interval;
+
+    for (;;) {
+        bool stopping = stopping_.load(std::memory_order_acquire);
+        drain();
+        if (stopping) {
+            break;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now >= next_flush) {
+            write_buffers(false);
+            next_flush = now + interval;
+        }
+
+        // Producers only wake the writer every quarter ring; light traffic
+        // waits for the flush interval instead
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        writer_sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (ring_[head_ & ring_mask_].sequence.load(std::memory_order_acquire) != head_ + 1 &&
+            !stopping_.load(std::memory_order_acquire)) {
+            wake_cv_.wait_until(lock, next_flush);
+        }
+        writer_sleeping_.store(false, std::memory_order_relaxed);
+    }
+
+    write_buffers(true);
+}
+
+size_t PcapTap::drain() {
+    size_t count = 0;
+    for (;;) {
+        Slot& slot = ring_[head_ & ring_mask_];
+        if (slot.sequence.load(std::memory_order_acquire) != head_ + 1) {
+            break;
+        }
+        append_packet(slot.stage, slot.packet);
+        slot.sequence.store(head_ + ring_mask_ + 1, std::memory_order_release);
+        head_++;
+        count++;
+    }
+    captured_.fetch_add(count, std::memory_order_relaxed);
+    return count;
+}
+
+void PcapTap::append_packet(CaptureStage stage, const PacketDescriptor& packet) {
+    uint8_t block[28 + MAX_FRAME_HEADERS];
+    size_t frame_length;
+    size_t header_length = build_headers(packet, block + 28, frame_length);
+    size_t captured = std::min<size_t>(frame_length, options_.snaplen);
+    size_t padding = ((captured + 3) & ~size_t(3)) - captured;
+    uint32_t block_length = static_cast<uint32_t>(ENHANCED_PACKET_OVERHEAD + captured + padding);
+
+    uint64_t timestamp_ns = (packet.timestamp_ns != 0 ? packet.timestamp_ns : packet_clock_ns()) + wall_offset_ns_;
+    store32(block, PCAPNG_ENHANCED_PACKET);
+    store32(block + 4, block_length);
+    store32(block + 8, static_cast<uint32_t>(stage));
+    store32(block + 12, static_cast<uint32_t>(timestamp_ns >> 32));
+    store32(block + 16, static_cast<uint32_t>(timestamp_ns));
+    store32(block + 20, static_cast<uint32_t>(captured));
+    store32(block + 24, static_cast<uint32_t>(std::min<size_t>(frame_length, UINT32_MAX)));
+
+    size_t copied = std::min(header_length, captured);
+    append(block, 28 + copied);
+    append_zeros(captured - copied + padding);
+    uint8_t trailer[4];
+    store32(trailer, block_length);
+    append(trailer, sizeof(trailer));
+}
+
+void PcapTap::append(const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (length > 0) {
+        Buffer& buffer = buffers_[current_];
+        size_t chunk = std::min(length, BUFFER_SIZE - buffer.used);
+        std::memcpy(buffer.data + buffer.used, bytes, chunk);
+        buffer.used += chunk;
+        bytes += chunk;
+        length -= chunk;
+        if (buffer.used == BUFFER_SIZE && ++current_ == buffers_.size()) {
+            write_buffers(false);
+        }
+    }
+}
+
+void PcapTap::append_zeros(size_t length) {
+    while (length > 0) {
+        Buffer& buffer = buffers_[current_];
+        size_t chunk = std::min(length, BUFFER_SIZE - buffer.used);
+        std::memset(buffer.data + buffer.used, 0, chunk);
+        buffer.used += chunk;
+        length -= chunk;
+        if (buffer.used == BUFFER_SIZE && ++current_ == buffers_.size()) {
+            write_buffers(false);
+        }
+    }
+}
+
+// Writes the full buffers and as much of the one being filled as the file
+// mode allows: whole pages with O_DIRECT, everything otherwise. A final
+// write switches O_DIRECT off first so the last partial page can go out.
+bool PcapTap::write_buffers(bool final) {
+    if (final && direct_io_) {
+        int flags = fcntl(fd_, F_GETFL);
+        fcntl(fd_, F_SETFL, flags & ~O_DIRECT);
+    }
+    bool page_writes = direct_io_ && !final;
+
+    iovec vectors[MAX_BUFFERS];
+    int count = 0;
+    size_t full = std::min(current_, buffers_.size());
+    for (size_t i = 0; i < full; ++i) {
+        vectors[count++] = {buffers_[i].data, buffers_[i].used};
+    }
+    size_t partial = 0;
+    if (current_ < buffers_.size()) {
+        Buffer& buffer = buffers_[current_];
+        partial = page_writes ? buffer.used & ~(IO_ALIGNMENT - 1) : buffer.used;
+        if (partial > 0) {
+            vectors[count++] = {buffer.data, partial};
+        }
+    }
+
+    bool ok = count == 0 || write_all(vectors, count);
+
+    // Whatever was held back moves to the front of the first buffer
+    for (size_t i = 0; i < full; ++i) {
+        buffers_[i].used = 0;
+    }
+    if (current_ < buffers_.size()) {
+        Buffer& buffer = buffers_[current_];
+        size_t rest = buffer.used - partial;
+        std::memmove(buffer.data, buffer.data + partial, rest);
+        buffer.used = rest;
+        std::swap(buffers_[0], buffers_[current_]);
+    }
+    current_ = 0;
+    return ok;
+}
+
+bool PcapTap::write_all(const iovec* vectors, int count) {
+    iovec pending[MAX_BUFFERS];
+    std::copy(vectors, vectors + count, pending);
+    iovec* next = pending;
+    while (count > 0) {
+        ssize_t written = ::writev(fd_, next, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (!write_failed_) {
+                std::cerr << "Capture write failed: " << std::strerror(errno) << std::endl;
+            }
+            write_failed_ = true;
+            return false;
+        }
+        write_calls_.fetch_add(1, std::memory_order_relaxed);
+        bytes_written_.fetch_add(static_cast<uint64_t>(written), std::memory_order_relaxed);
+
+        size_t remaining = static_cast<size_t>(written);
+        while (count > 0 && remaining >= next->iov_len) {
+            remaining -= next->iov_len;
+            next++;
+            count--;
+        }
+        if (count > 0) {
+            next->iov_base = static_cast<uint8_t*>(next->iov_base) + remaining;
+            next->iov_len -= remaining;
+        }
+    }
+    return true;
+}
+
+void PcapTap::release_buffers() {
+    for (auto& buffer : buffers_) {
+        std::free(buffer.data);
+    }
+    buffers_.clear();
+    current_ = 0;
+}
+
+} // namespace RouterSim
@@ -0,0 +1,286 @@
+#include "timer_wheel.h"
+#include <algorithm>
+
+namespace RouterSim {
+
+namespace {
+
+inline uint32_t count_trailing_zeros(uint64_t bits) {
+    return static_cast<uint32_t>(__builtin_ctzll(bits));
+}
+
+} // namespace
+
+TimerWheel::TimerWheel(uint64_t resolution_ns, uint64_t start_ns)
+    : resolution_ns_(std::max<uint64_t>(1, resolution_ns)), start_ns_(start_ns), current_tick_(0),
+      pending_(0) {
+    std::fill(std::begin(heads_), std::end(heads_), NIL);
+    for (auto& level : occupied_) {
+        std::fill(std::begin(level), std::end(level), 0);
+    }
+}
+
+TimerWheel::TimerId TimerWheel::schedule(uint64_t expiry_ns, uint64_t cookie) {
+    uint32_t index;
+    if (!free_nodes_.empty()) {
+        index = free_nodes_.back();
+        free_nodes_.pop_back();
+    } else {
+        index = static_cast<uint32_t>(nodes_.size());
+        nodes_.push_back(Node{0, 0, NIL, NIL, 1, 0, false});
+    }
+
+    Node& node = nodes_[index];
+    node.expiry_tick = std::max(ns_to_tick(expiry_ns), current_tick_ + 1);
+    node.cookie = cookie;
+    node.armed = true;
+    place(index, current_tick_ + 1);
+    pending_++;
+
+    return (static_cast<uint64_t>(node.generation) << 32) | (index + 1);
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    Node* node = lookup(id);
+    if (!node) {
+        return false;
+    }
+
+    uint32_t index = static_cast<uint32_t>(node - nodes_.data());
+    unlink(index);
+    release(index);
+    pending_--;
+    return true;
+}
+
+bool TimerWheel::is_pending(TimerId id) const {
+    return lookup(id) != nullptr;
+}
+
+size_t TimerWheel::advance(uint64_t now_ns, const ExpiryCallback& callback) {
+    uint64_t target = now_ns > start_ns_ ? (now_ns - start_ns_) / resolution_ns_ : 0;
+    size_t fired = 0;
+
+    while (pending_ > 0) {
+        uint64_t tick = next_event_tick(current_tick_ + 1);
+        if (tick > target) {
+            break;
+        }
+        current_tick_ = tick;
+
+        // Higher levels first, so timers they hand down due this very tick
+        // reach level 0 before it fires
+        for (uint32_t level = LEVELS - 1; level >= 1; --level) {
+            uint32_t shift = SLOT_BITS * level;
+            if ((tick & ((1ULL << shift) - 1)) == 0) {
+                uint32_t slot = static_cast<uint32_t>((tick >> shift) & (SLOTS - 1));
+                if (heads_[level * SLOTS + slot] != NIL) {
+                    cascade(level, slot, tick);
+                }
+            }
+        }
+
+        // The callback may schedule timers, so nothing is held across it
+        uint32_t slot = static_cast<uint32_t>(tick & (SLOTS - 1));
+        while (heads_[slot] != NIL) {
+            uint32_t index = heads_[slot];
+            TimerId id = (static_cast<uint64_t>(nodes_[index].generation) << 32) | (index + 1);
+            uint64_t cookie = nodes_[index].cookie;
+            unlink(index);
+            release(index);
+            pending_--;
+            fired++;
+            callback(id, cookie);
+        }
+    }
+
+    current_tick_ = std::max(current_tick_, target);
+    return fired;
+}
+
+uint64_t TimerWheel::next_expiry_ns() const {
+    if (pending_ == 0) {
+        return NO_EXPIRY;
+    }
+
+    uint64_t from = current_tick_ + 1;
+    uint64_t earliest = UINT64_MAX;
+
+    // Level 0 slots hold exactly one tick each
+    uint32_t first = static_cast<uint32_t>(from & (SLOTS - 1));
+    uint32_t slot = find_occupied(0, first);
+    if (slot != SLOTS) {
+        earliest = (from & ~static_cast<uint64_t>(SLOTS - 1)) + slot + (slot < first ? SLOTS : 0);
+    }
+
+    // Higher levels: slots are in expiry order from the current position,
+    // so the first occupied one holds the level's earliest timer. Timers
+    // parked beyond the wheel span count as due when their slot cascades.
+    for (uint32_t level = 1; level < LEVELS; ++level) {
+        uint32_t shift = SLOT_BITS * level;
+        uint64_t base = ((from + (1ULL << shift) - 1) >> shift) << shift;
+        uint32_t base_slot = static_cast<uint32_t>((base >> shift) & (SLOTS - 1));
+        slot = find_occupied(level, base_slot);
+        if (slot == SLOTS) {
+            continue;
+        }
+
+        uint64_t cascade_tick = base + (static_cast<uint64_t>((slot - base_slot) & (SLOTS - 1)) << shift);
+        for (uint32_t index = heads_[level * SLOTS + slot]; index != NIL; index = nodes_[index].next) {
+            uint64_t expiry = nodes_[index].expiry_tick;
+            earliest = std::min(earliest, expiry < cascade_tick + (1ULL << shift) ? expiry : cascade_tick);
+        }
+    }
+
+    return tick_to_ns(earliest);
+}
+
+uint64_t TimerWheel::ns_to_tick(uint64_t time_ns) const {
+    if (time_ns <= start_ns_) {
+        return 0;
+    }
+    uint64_t offset = time_ns - start_ns_;
+    return offset / resolution_ns_ + (offset % resolution_ns_ != 0);
+}
+
+uint64_t TimerWheel::tick_to_ns(uint64_t tick) const {
+    return start_ns_ + tick * resolution_ns_;
+}
+
+TimerWheel::Node* TimerWheel::lookup(TimerId id) {
+    return const_cast<Node*>(static_cast<const TimerWheel*>(this)->lookup(id));
+}
+
+const TimerWheel::Node* TimerWheel::lookup(TimerId id) const {
+    uint64_t slot = id & 0xFFFFFFFFULL;
+    if (slot == 0 || slot > nodes_.size()) {
+        return nullptr;
+    }
+    const Node& node = nodes_[slot - 1];
+    if (!node.armed || node.generation != static_cast<uint32_t>(id >> 32)) {
+        return nullptr;
+    }
+    return &node;
+}
+
+// Picks the finest level whose span covers the delay. The slot index is
+// taken from the absolute expiry tick, so a slot is cascaded exactly when
+// the wheel reaches the start of the block its timers expire in.
+void TimerWheel::place(uint32_t index, uint64_t reference_tick) {
+    uint64_t expiry = std::max(nodes_[index].expiry_tick, reference_tick);
+    uint64_t delta = expiry - reference_tick;
+
+    for (uint32_t level = 0; level < LEVELS; ++level) {
+        uint32_t shift = SLOT_BITS * (level + 1);
+        uint64_t span = 1ULL << shift;
+        if (delta < span || level == LEVELS - 1) {
+            // Beyond the top level's span: park at its far end and re-place
+            // when that slot cascades
+            uint64_t slot_tick = delta < span ? expiry : reference_tick + span - 1;
+            uint32_t slot = static_cast<uint32_t>((slot_tick >> (SLOT_BITS * level)) & (SLOTS - 1));
+            link(index, level, slot);
+            return;
+        }
+    }
+}
+
+void TimerWheel::link(uint32_t index, uint32_t level, uint32_t slot) {
+    uint32_t position = level * SLOTS + slot;
+    Node& node = nodes_[index];
+    node.slot = static_cast<uint16_t>(position);
+    node.prev = NIL;
+    node.next = heads_[position];
+    if (node.next != NIL) {
+        nodes_[node.next].prev = index;
+    }
+    heads_[position] = index;
+    occupied_[level][slot >> 6] |= 1ULL << (slot & 63);
+}
+
+void TimerWheel::unlink(uint32_t index) {
+    Node& node = nodes_[index];
+    if (node.prev != NIL) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        heads_[node.slot] = node.next;
+    }
+    if (node.next != NIL) {
+        nodes_[node.next].prev = node.prev;
+    }
+
+    if (heads_[node.slot] == NIL) {
+        uint32_t level = node.slot / SLOTS;
+        uint32_t slot = node.slot % SLOTS;
+        occupied_[level][slot >> 6] &= ~(1ULL << (slot & 63));
+    }
+}
+
+void TimerWheel::release(uint32_t index) {
+    Node& node = nodes_[index];
+    node.armed = false;
+    node.generation++;
+    free_nodes_.push_back(index);
+}
+
+void TimerWheel::cascade(uint32_t level, uint32_t slot, uint64_t tick) {
+    // Detach the list first: re-placed timers may land in this same slot
+    uint32_t position = level * SLOTS + slot;
+    uint32_t index = heads_[position];
+    heads_[position] = NIL;
+    occupied_[level][slot >> 6] &= ~(1ULL << (slot & 63));
+
+    while (index != NIL) {
+        uint32_t next = nodes_[index].next;
+        place(index, tick);
+        index = next;
+    }
+}
+
+uint32_t TimerWheel::find_occupied(uint32_t level, uint32_t from_slot) const {
+    uint32_t first_word = from_slot >> 6;
+    uint64_t low_mask = (1ULL << (from_slot & 63)) - 1;
+
+    for (uint32_t i = 0; i <= WORDS; ++i) {
+        uint32_t word = (first_word + i) % WORDS;
+        uint64_t bits = occupied_[level][word];
+        if (i == 0) {
+            bits &= ~low_mask;
+        } else if (i == WORDS) {
+            bits &= low_mask;
+        }
+        if (bits) {
+            return word * 64 + count_trailing_zeros(bits);
+        }
+    }
+    return SLOTS;
+}
+
+// Earliest tick at or after from_tick at which a level 0 slot fires or an
+// occupied higher-level slot cascades
+uint64_t TimerWheel::next_event_tick(uint64_t from_tick) const {
+    uint64_t earliest = UINT64_MAX;
+
+    uint32_t first = static_cast<uint32_t>(from_tick & (SLOTS - 1));
+    uint32_t slot = find_occupied(0, first);
+    if (slot != SLOTS) {
+        earliest = (from_tick & ~static_cast<uint64_t>(SLOTS - 1)) + slot + (slot < first ? SLOTS : 0);
+    }
+
+    for (uint32_t level = 1; level < LEVELS; ++level) {
+        uint32_t shift = SLOT_BITS * level;
+        uint64_t base = ((from_tick + (1ULL << shift) - 1) >> shift) << shift;
+        if (base >= earliest) {
+            break;
+        }
+        uint32_t base_slot = static_cast<uint32_t>((base >> shift) & (SLOTS - 1));
+        slot = find_occupied(level, base_slot);
+        if (slot != SLOTS) {
+            earliest = std::min(earliest,
+                                base + (static_cast<uint64_t>((slot - base_slot) & (SLOTS - 1)) << shift));
+        }
+    }
+
+    return earliest;
+}
+
+} // namespace RouterSim
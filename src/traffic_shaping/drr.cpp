@@ -0,0 +1,278 @@
+#include "traffic_shaping/drr.h"
+#include <algorithm>
+
+namespace RouterSim {
+
+DeficitRoundRobin::DeficitRoundRobin() : DeficitRoundRobin(DRRConfig()) {
+}
+
+DeficitRoundRobin::DeficitRoundRobin(const DRRConfig& config)
+    : config_(config), total_queued_(0), sparse_dequeues_(0) {
+    slot_of_.fill(NO_SLOT);
+}
+
+DeficitRoundRobin::~DeficitRoundRobin() = default;
+
+bool DeficitRoundRobin::initialize(const std::vector<WFQClass>& classes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    states_.clear();
+    new_list_.clear();
+    old_list_.clear();
+    slot_of_.fill(NO_SLOT);
+    total_queued_ = 0;
+    sparse_dequeues_ = 0;
+
+    for (const auto& wfq_class : classes) {
+        if (slot_of_[wfq_class.class_id] == NO_SLOT) {
+            insert_class(wfq_class);
+        }
+    }
+
+    return true;
+}
+
+bool DeficitRoundRobin::enqueue_packet(const PacketInfo& packet, uint8_t class_id) {
+    return enqueue_packet(to_packet_descriptor(packet), class_id);
+}
+
+bool DeficitRoundRobin::enqueue_packet(const PacketDescriptor& packet, uint8_t class_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    uint16_t slot = slot_of_[class_id];
+    if (slot == NO_SLOT) {
+        return false;
+    }
+
+    ClassState& state = states_[slot];
+    if (state.queue.size() >= MAX_QUEUE_SIZE) {
+        state.packets_dropped++;
+        return false;
+    }
+
+    state.queue.push_back(packet);
+    state.packets_queued++;
+    total_queued_++;
+
+    // An idle class joins the round with a full quantum
+    if (state.list == ListState::IDLE) {
+        state.deficit = state.quantum;
+        if (config_.sparse_flow_priority) {
+            state.list = ListState::NEW;
+            new_list_.push_back(slot);
+        } else {
+            state.list = ListState::OLD;
+            old_list_.push_back(slot);
+        }
+    }
+
+    return true;
+}
+
+bool DeficitRoundRobin::dequeue_packet(PacketInfo& packet) {
+    PacketDescriptor descriptor;
+    if (!dequeue_packet(descriptor)) {
+        return false;
+    }
+
+    packet = to_packet_info(descriptor);
+    return true;
+}
+
+bool DeficitRoundRobin::dequeue_packet(PacketDescriptor& packet) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return select_next_packet(packet);
+}
+
+size_t DeficitRoundRobin::dequeue_burst(PacketDescriptor* packets, size_t max_count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    size_t dequeued = 0;
+    while (dequeued < max_count && select_next_packet(packets[dequeued])) {
+        dequeued++;
+    }
+
+    return dequeued;
+}
+
+bool DeficitRoundRobin::is_empty() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_queued_ == 0;
+}
+
+size_t DeficitRoundRobin::queue_size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_queued_;
+}
+
+size_t DeficitRoundRobin::queue_size(uint8_t class_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    uint16_t slot = slot_of_[class_id];
+    if (slot != NO_SLOT) {
+        return states_[slot].queue.size();
+    }
+
+    return 0;
+}
+
+bool DeficitRoundRobin::add_class(const WFQClass& wfq_class) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (slot_of_[wfq_class.class_id] != NO_SLOT) {
+        return false;
+    }
+
+    insert_class(wfq_class);
+    return true;
+}
+
+bool DeficitRoundRobin::update_class(const WFQClass& wfq_class) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    uint16_t slot = slot_of_[wfq_class.class_id];
+    if (slot == NO_SLOT) {
+        return false;
+    }
+
+    states_[slot].config = wfq_class;
+    states_[slot].quantum = class_quantum(wfq_class);
+    return true;
+}
+
+std::vector<WFQClass> DeficitRoundRobin::get_classes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<WFQClass> classes;
+    classes.reserve(states_.size());
+    for (const auto& state : states_) {
+        classes.push_back(state.config);
+    }
+    return classes;
+}
+
+void DeficitRoundRobin::set_config(const DRRConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    config_ = config;
+    for (auto& state : states_) {
+        state.quantum = class_quantum(state.config);
+    }
+
+    // Without sparse priority every active class belongs on the old list
+    if (!config_.sparse_flow_priority) {
+        for (uint16_t slot : new_list_) {
+            states_[slot].list = ListState::OLD;
+            old_list_.push_back(slot);
+        }
+        new_list_.clear();
+    }
+}
+
+DRRConfig DeficitRoundRobin::get_config() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_;
+}
+
+DRRStatistics DeficitRoundRobin::get_statistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    DRRStatistics stats{};
+    stats.sparse_dequeues = sparse_dequeues_;
+
+    for (const auto& state : states_) {
+        DRRClassStatistics class_stats{};
+        class_stats.class_id = state.config.class_id;
+        class_stats.quantum = state.quantum;
+        class_stats.deficit = state.deficit;
+        class_stats.packets_queued = state.packets_queued;
+        class_stats.packets_dequeued = state.packets_dequeued;
+        class_stats.packets_dropped = state.packets_dropped;
+        class_stats.bytes_dequeued = state.bytes_dequeued;
+        class_stats.current_queue_length = state.queue.size();
+
+        stats.total_packets_queued += state.packets_queued;
+        stats.total_packets_dequeued += state.packets_dequeued;
+        stats.total_packets_dropped += state.packets_dropped;
+        stats.total_bytes_dequeued += state.bytes_dequeued;
+        stats.current_queue_length += state.queue.size();
+
+        stats.class_statistics[class_stats.class_id] = class_stats;
+    }
+
+    return stats;
+}
+
+void DeficitRoundRobin::reset_statistics() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    sparse_dequeues_ = 0;
+    for (auto& state : states_) {
+        state.packets_queued = 0;
+        state.packets_dequeued = 0;
+        state.packets_dropped = 0;
+        state.bytes_dequeued = 0;
+    }
+}
+
+void DeficitRoundRobin::insert_class(const WFQClass& wfq_class) {
+    slot_of_[wfq_class.class_id] = static_cast<uint16_t>(states_.size());
+    states_.emplace_back();
+    states_.back().config = wfq_class;
+    states_.back().quantum = class_quantum(wfq_class);
+}
+
+uint32_t DeficitRoundRobin::class_quantum(const WFQClass& wfq_class) const {
+    return std::max<uint32_t>(1, config_.quantum) * std::max<uint32_t>(1, wfq_class.weight);
+}
+
+bool DeficitRoundRobin::select_next_packet(PacketDescriptor& packet) {
+    // Each iteration either sends a packet or moves one class along; with a
+    // quantum of at least one MTU a class is topped up at most once before
+    // it sends, so the loop is bounded by the number of active classes
+    while (true) {
+        bool from_new = !new_list_.empty();
+        if (!from_new && old_list_.empty()) {
+            return false;
+        }
+
+        std::deque<uint16_t>& list = from_new ? new_list_ : old_list_;
+        uint16_t slot = list.front();
+        ClassState& state = states_[slot];
+
+        // Deficit used up: top up and go to the back of the old list
+        if (state.deficit <= 0) {
+            state.deficit += state.quantum;
+            list.pop_front();
+            state.list = ListState::OLD;
+            old_list_.push_back(slot);
+            continue;
+        }
+
+        // Emptied classes leave lazily: new -> old once, old -> idle
+        if (state.queue.empty()) {
+            list.pop_front();
+            if (from_new && config_.sparse_flow_priority) {
+                state.list = ListState::OLD;
+                old_list_.push_back(slot);
+            } else {
+                state.list = ListState::IDLE;
+                state.deficit = 0;
+            }
+            continue;
+        }
+
+        packet = state.queue.front();
+        state.queue.pop_front();
+        state.deficit -= packet.size;
+        state.packets_dequeued++;
+        state.bytes_dequeued += packet.size;
+        total_queued_--;
+        if (from_new) {
+            sparse_dequeues_++;
+        }
+        return true;
+    }
+}
+
+} // namespace RouterSim
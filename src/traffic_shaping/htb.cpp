@@ -0,0 +1,502 @@
+#include "traffic_shaping/htb.h"
+#include <algorithm>
+
+namespace RouterSim {
+
+namespace {
+
+// Debt limit for both buckets, as in Linux HTB's mbuffer
+constexpr int64_t MAX_DEBT_NS = 60LL * 1000000000LL;
+
+constexpr int NO_LENDER = -2;
+
+} // namespace
+
+HierarchicalTokenBucket::HierarchicalTokenBucket(uint32_t charge_batch_bytes)
+    : charge_batch_bytes_(charge_batch_bytes), total_queued_(0), packets_queued_(0),
+      packets_dropped_(0), ancestor_flushes_(0) {
+}
+
+HierarchicalTokenBucket::~HierarchicalTokenBucket() = default;
+
+bool HierarchicalTokenBucket::initialize(const std::vector<HTBClassConfig>& classes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    classes_.clear();
+    index_of_.clear();
+    green_.clear();
+    yellow_.clear();
+    waiting_ = decltype(waiting_)();
+    total_queued_ = 0;
+    packets_queued_ = 0;
+    packets_dropped_ = 0;
+    ancestor_flushes_ = 0;
+
+    classes_.reserve(classes.size());
+    for (const auto& config : classes) {
+        if (!add_class_locked(config)) {
+            update_charge_batches();
+            return false;
+        }
+    }
+
+    update_charge_batches();
+    return true;
+}
+
+bool HierarchicalTokenBucket::add_class(const HTBClassConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!add_class_locked(config)) {
+        return false;
+    }
+    update_charge_batches();
+    return true;
+}
+
+bool HierarchicalTokenBucket::add_class_locked(const HTBClassConfig& config) {
+    if (config.class_id == 0 || config.rate == 0 || index_of_.count(config.class_id)) {
+        return false;
+    }
+
+    int32_t parent = NO_CLASS;
+    uint32_t depth = 0;
+    if (config.parent_id != 0) {
+        auto it = index_of_.find(config.parent_id);
+        if (it == index_of_.end()) {
+            return false;
+        }
+        parent = it->second;
+        depth = classes_[parent].depth + 1;
+        if (depth >= MAX_DEPTH || !classes_[parent].queue.empty()) {
+            return false;
+        }
+    }
+
+    // Taking the reference after the checks: emplace_back may reallocate
+    int32_t index = static_cast<int32_t>(classes_.size());
+    classes_.emplace_back();
+    ClassNode& node = classes_.back();
+    node.config = config;
+    node.parent = parent;
+    node.depth = depth;
+    configure_buckets(node);
+    node.tokens = node.buffer;
+    node.ctokens = node.cbuffer;
+
+    if (parent != NO_CLASS) {
+        classes_[parent].children++;
+    }
+    index_of_[config.class_id] = index;
+    return true;
+}
+
+bool HierarchicalTokenBucket::update_class(const HTBClassConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = index_of_.find(config.class_id);
+    if (it == index_of_.end() || config.rate == 0) {
+        return false;
+    }
+
+    // The tree shape is fixed; only rates, bursts, quantum and name change
+    ClassNode& node = classes_[it->second];
+    uint32_t parent_id = node.config.parent_id;
+    node.config = config;
+    node.config.parent_id = parent_id;
+    configure_buckets(node);
+    node.tokens = std::min(node.tokens, node.buffer);
+    node.ctokens = std::min(node.ctokens, node.cbuffer);
+    update_charge_batches();
+    return true;
+}
+
+std::vector<HTBClassConfig> HierarchicalTokenBucket::get_classes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<HTBClassConfig> classes;
+    classes.reserve(classes_.size());
+    for (const auto& node : classes_) {
+        classes.push_back(node.config);
+    }
+    return classes;
+}
+
+void HierarchicalTokenBucket::set_charge_batch_bytes(uint32_t charge_batch_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    charge_batch_bytes_ = charge_batch_bytes;
+    update_charge_batches();
+}
+
+void HierarchicalTokenBucket::set_classifier(std::function<uint32_t(const PacketDescriptor&)> classifier) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    classifier_ = classifier;
+}
+
+uint32_t HierarchicalTokenBucket::classify_packet(const PacketDescriptor& packet) const {
+    if (classifier_) {
+        return classifier_(packet);
+    }
+    return packet.priority;
+}
+
+bool HierarchicalTokenBucket::enqueue_packet(const PacketDescriptor& packet, uint32_t class_id) {
+    return enqueue_packet(packet, class_id, packet_clock_ns());
+}
+
+bool HierarchicalTokenBucket::enqueue_packet(const PacketDescriptor& packet, uint32_t class_id,
+                                             uint64_t now_ns) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = index_of_.find(class_id);
+    if (it == index_of_.end() || classes_[it->second].children > 0) {
+        packets_dropped_++;
+        return false;
+    }
+
+    int32_t index = it->second;
+    ClassNode& node = classes_[index];
+    if (node.queue.size() >= MAX_QUEUE_SIZE) {
+        node.packets_dropped++;
+        packets_dropped_++;
+        return false;
+    }
+
+    node.queue.push_back(packet);
+    total_queued_++;
+    packets_queued_++;
+
+    if (node.state == LeafState::IDLE) {
+        classify_leaf(index, now_ns);
+    }
+    return true;
+}
+
+bool HierarchicalTokenBucket::dequeue_packet(PacketDescriptor& packet) {
+    return dequeue_packet(packet, packet_clock_ns());
+}
+
+bool HierarchicalTokenBucket::dequeue_packet(PacketDescriptor& packet, uint64_t now_ns) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Wake throttled leaves whose tokens may have recovered
+    while (!waiting_.empty() && waiting_.top().wake_ns <= now_ns) {
+        WaitEntry entry = waiting_.top();
+        waiting_.pop();
+        ClassNode& node = classes_[entry.index];
+        if (entry.generation != node.wake_generation) {
+            continue;
+        }
+
+        node.wake_ns = 0;
+        if (node.state == LeafState::WAITING) {
+            classify_leaf(entry.index, now_ns);
+        }
+    }
+
+    while (true) {
+        // Leaves under their own rate go first, round robin by quantum
+        while (!green_.empty()) {
+            ListEntry entry = green_.front();
+            ClassNode& node = classes_[entry.index];
+            if (entry.generation != node.generation) {
+                green_.pop_front();
+                continue;
+            }
+
+            refill(node, now_ns);
+            if (node.tokens <= 0) {
+                green_.pop_front();
+                classify_leaf(entry.index, now_ns);
+                continue;
+            }
+            if (node.deficit <= 0) {
+                node.deficit += node.config.quantum;
+                green_.pop_front();
+                green_.push_back(entry);
+                continue;
+            }
+
+            send(entry.index, OWN_RATE, packet, now_ns);
+            return true;
+        }
+
+        // Then leaves that may borrow from an ancestor
+        if (yellow_.empty()) {
+            return false;
+        }
+
+        ListEntry entry = yellow_.front();
+        ClassNode& node = classes_[entry.index];
+        if (entry.generation != node.generation) {
+            yellow_.pop_front();
+            continue;
+        }
+
+        refill(node, now_ns);
+        if (node.tokens > 0 || node.ctokens <= 0) {
+            yellow_.pop_front();
+            classify_leaf(entry.index, now_ns);
+            continue;
+        }
+        if (node.deficit <= 0) {
+            node.deficit += node.config.quantum;
+            yellow_.pop_front();
+            yellow_.push_back(entry);
+            continue;
+        }
+
+        uint64_t wake_ns = 0;
+        int lender = find_lender(entry.index, now_ns, wake_ns);
+        if (lender == NO_LENDER) {
+            yellow_.pop_front();
+            node.generation++;
+            node.state = LeafState::WAITING;
+            wait_until(entry.index, wake_ns);
+            continue;
+        }
+
+        send(entry.index, lender, packet, now_ns);
+        return true;
+    }
+}
+
+bool HierarchicalTokenBucket::is_empty() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_queued_ == 0;
+}
+
+size_t HierarchicalTokenBucket::queue_size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_queued_;
+}
+
+uint64_t HierarchicalTokenBucket::next_wakeup_ns() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return waiting_.empty() ? 0 : waiting_.top().wake_ns;
+}
+
+HTBStatistics HierarchicalTokenBucket::get_statistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    HTBStatistics stats{};
+    stats.packets_queued = packets_queued_;
+    stats.packets_dropped = packets_dropped_;
+    stats.ancestor_flushes = ancestor_flushes_;
+    stats.queue_length = total_queued_;
+
+    stats.class_statistics.reserve(classes_.size());
+    for (const auto& node : classes_) {
+        HTBClassStatistics class_stats;
+        class_stats.class_id = node.config.class_id;
+        class_stats.parent_id = node.config.parent_id;
+        class_stats.name = node.config.name;
+        class_stats.is_leaf = node.children == 0;
+        class_stats.tokens_ns = node.tokens;
+        class_stats.ctokens_ns = node.ctokens;
+        class_stats.packets_sent = node.packets_sent;
+        class_stats.bytes_sent = node.bytes_sent;
+        class_stats.packets_borrowed = node.packets_borrowed;
+        class_stats.packets_lent = node.packets_lent;
+        class_stats.packets_dropped = node.packets_dropped;
+        class_stats.queue_length = node.queue.size();
+
+        if (class_stats.is_leaf) {
+            stats.packets_sent += node.packets_sent;
+            stats.bytes_sent += node.bytes_sent;
+        }
+        stats.class_statistics.push_back(class_stats);
+    }
+
+    return stats;
+}
+
+void HierarchicalTokenBucket::reset_statistics() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    packets_queued_ = 0;
+    packets_dropped_ = 0;
+    ancestor_flushes_ = 0;
+    for (auto& node : classes_) {
+        node.packets_sent = 0;
+        node.bytes_sent = 0;
+        node.packets_borrowed = 0;
+        node.packets_lent = 0;
+        node.packets_dropped = 0;
+    }
+}
+
+void HierarchicalTokenBucket::configure_buckets(ClassNode& node) {
+    HTBClassConfig& config = node.config;
+    config.ceil = std::max(config.ceil, config.rate);
+    config.quantum = std::max<uint32_t>(1, config.quantum);
+    node.buffer = std::max<int64_t>(1, transmit_ns(config.burst, config.rate));
+    node.cbuffer = std::max<int64_t>(1, transmit_ns(config.cburst, config.ceil));
+}
+
+// Splits each ancestor's smaller burst across the leaves below it, so the
+// uncharged bytes under a class never exceed what its buckets can absorb.
+// Otherwise a late flush could push a small-burst ancestor deep into debt
+// and stall every borrower below it at once.
+void HierarchicalTokenBucket::update_charge_batches() {
+    for (auto& node : classes_) {
+        node.leaves = 0;
+    }
+    for (const auto& node : classes_) {
+        if (node.children == 0) {
+            for (int32_t ancestor = node.parent; ancestor != NO_CLASS; ancestor = classes_[ancestor].parent) {
+                classes_[ancestor].leaves++;
+            }
+        }
+    }
+
+    for (auto& node : classes_) {
+        uint32_t batch = charge_batch_bytes_;
+        for (int32_t ancestor = node.parent; ancestor != NO_CLASS; ancestor = classes_[ancestor].parent) {
+            const HTBClassConfig& config = classes_[ancestor].config;
+            batch = std::min(batch, std::min(config.burst, config.cburst) / classes_[ancestor].leaves);
+        }
+        node.charge_batch_bytes = batch;
+    }
+}
+
+void HierarchicalTokenBucket::refill(ClassNode& node, uint64_t now_ns) {
+    if (now_ns <= node.last_update_ns) {
+        return;
+    }
+
+    int64_t elapsed = static_cast<int64_t>(std::min<uint64_t>(now_ns - node.last_update_ns, MAX_DEBT_NS));
+    node.tokens = std::min(node.buffer, node.tokens + elapsed);
+    node.ctokens = std::min(node.cbuffer, node.ctokens + elapsed);
+    node.last_update_ns = now_ns;
+}
+
+// Puts a leaf on the list matching its buckets; any entry it already has
+// elsewhere becomes stale through the generation bump
+void HierarchicalTokenBucket::classify_leaf(int32_t index, uint64_t now_ns) {
+    ClassNode& node = classes_[index];
+    node.generation++;
+
+    if (node.queue.empty()) {
+        flush_charges(index, now_ns);
+        node.state = LeafState::IDLE;
+        node.deficit = 0;
+        return;
+    }
+
+    refill(node, now_ns);
+    if (node.tokens > 0) {
+        node.state = LeafState::GREEN;
+        green_.push_back({index, node.generation});
+    } else if (node.ctokens > 0) {
+        // Borrow meanwhile; the leaf turns green again at its next yellow
+        // turn once its rate has recovered
+        node.state = LeafState::YELLOW;
+        yellow_.push_back({index, node.generation});
+    } else {
+        node.state = LeafState::WAITING;
+        wait_until(index, now_ns + static_cast<uint64_t>(1 - node.ctokens));
+    }
+}
+
+// Each leaf keeps at most one live wait entry, the earliest requested; a
+// leaf woken early simply re-evaluates and waits again
+void HierarchicalTokenBucket::wait_until(int32_t index, uint64_t wake_ns) {
+    ClassNode& node = classes_[index];
+    if (node.wake_ns != 0 && node.wake_ns <= wake_ns) {
+        return;
+    }
+
+    node.wake_ns = wake_ns;
+    node.wake_generation++;
+    waiting_.push({wake_ns, index, node.wake_generation});
+}
+
+// Returns the ancestor level (0 = parent) that lends to the leaf, or
+// NO_LENDER with wake_ns set to the earliest time one could
+int HierarchicalTokenBucket::find_lender(int32_t index, uint64_t now_ns, uint64_t& wake_ns) {
+    const ClassNode& leaf = classes_[index];
+    uint64_t earliest = static_cast<uint64_t>(1 - leaf.tokens);
+
+    int level = 0;
+    for (int32_t ancestor = leaf.parent; ancestor != NO_CLASS; ancestor = classes_[ancestor].parent, ++level) {
+        ClassNode& node = classes_[ancestor];
+        refill(node, now_ns);
+
+        uint64_t tokens_wait = node.tokens > 0 ? 0 : static_cast<uint64_t>(1 - node.tokens);
+        if (node.ctokens <= 0) {
+            uint64_t ceil_wait = static_cast<uint64_t>(1 - node.ctokens);
+            earliest = std::min(earliest, std::max(ceil_wait, tokens_wait));
+            break;
+        }
+        if (node.tokens > 0) {
+            node.packets_lent++;
+            return level;
+        }
+        earliest = std::min(earliest, tokens_wait);
+    }
+
+    wake_ns = now_ns + std::max<uint64_t>(1, earliest);
+    return NO_LENDER;
+}
+
+void HierarchicalTokenBucket::send(int32_t index, int lender_level, PacketDescriptor& packet, uint64_t now_ns) {
+    ClassNode& node = classes_[index];
+    packet = node.queue.front();
+    node.queue.pop_front();
+    total_queued_--;
+
+    uint32_t size = packet.size;
+    node.deficit -= size;
+    node.ctokens = std::max(-MAX_DEBT_NS, node.ctokens - transmit_ns(size, node.config.ceil));
+    if (lender_level == OWN_RATE) {
+        node.tokens = std::max(-MAX_DEBT_NS, node.tokens - transmit_ns(size, node.config.rate));
+    } else {
+        node.packets_borrowed++;
+    }
+    node.packets_sent++;
+    node.bytes_sent += size;
+
+    // Borrowers between the leaf and the lender are not charged rate tokens
+    node.pending_ceil_bytes += size;
+    node.pending_packets++;
+    for (uint32_t level = std::max(0, lender_level); level < node.depth; ++level) {
+        node.pending_rate_bytes[level] += size;
+    }
+
+    // Borrowed traffic is charged at once so lending decisions see current
+    // tokens; own-rate traffic is covered by the ancestors' rates and batches
+    if (node.queue.empty()) {
+        classify_leaf(index, now_ns);
+    } else if (lender_level != OWN_RATE || node.pending_ceil_bytes >= node.charge_batch_bytes) {
+        flush_charges(index, now_ns);
+    }
+}
+
+void HierarchicalTokenBucket::flush_charges(int32_t index, uint64_t now_ns) {
+    ClassNode& leaf = classes_[index];
+    if (leaf.pending_ceil_bytes == 0) {
+        return;
+    }
+
+    int level = 0;
+    for (int32_t ancestor = leaf.parent; ancestor != NO_CLASS; ancestor = classes_[ancestor].parent, ++level) {
+        ClassNode& node = classes_[ancestor];
+        refill(node, now_ns);
+        node.ctokens = std::max(-MAX_DEBT_NS, node.ctokens - transmit_ns(leaf.pending_ceil_bytes, node.config.ceil));
+        node.tokens = std::max(-MAX_DEBT_NS, node.tokens - transmit_ns(leaf.pending_rate_bytes[level], node.config.rate));
+        node.packets_sent += leaf.pending_packets;
+        node.bytes_sent += leaf.pending_ceil_bytes;
+        leaf.pending_rate_bytes[level] = 0;
+    }
+
+    leaf.pending_ceil_bytes = 0;
+    leaf.pending_packets = 0;
+    ancestor_flushes_++;
+}
+
+int64_t HierarchicalTokenBucket::transmit_ns(uint64_t bytes, uint64_t rate_bps) {
+    // Double avoids overflow of bytes * 8e9 for large bursts and rates
+    return static_cast<int64_t>(static_cast<double>(bytes) * 8e9 / static_cast<double>(rate_bps));
+}
+
+} // namespace RouterSim
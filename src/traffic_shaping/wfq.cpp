@@ -3,10 +3,12 @@
 #include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <functional>
 
 namespace RouterSim {
 
-WeightedFairQueue::WeightedFairQueue() : virtual_time_(0) {
+WeightedFairQueue::WeightedFairQueue() : total_queued_(0), virtual_time_(0) {
+    slot_of_.fill(NO_SLOT);
 }
 
 WeightedFairQueue::~WeightedFairQueue() = default;
@@ -14,39 +16,45 @@ WeightedFairQueue::~WeightedFairQueue() = default;
 bool WeightedFairQueue::initialize(const std::vector<WFQClass>& classes) {
     std::lock_guard<std::mutex> lock(mutex_);
     
-    classes_ = classes;
-    queues_.clear();
+    reset_classes();
     
     // Initialize queues for each class
-    for (const auto& wfq_class : classes_) {
-        queues_[wfq_class.class_id] = std::queue<QueueItem>();
+    for (const auto& wfq_class : classes) {
+        if (slot_of_[wfq_class.class_id] == NO_SLOT) {
+            insert_class(wfq_class);
+        }
     }
     
     return true;
 }
 
 bool WeightedFairQueue::enqueue_packet(const PacketInfo& packet, uint8_t class_id) {
+    return enqueue_packet(to_packet_descriptor(packet), class_id);
+}
+
+bool WeightedFairQueue::enqueue_packet(const PacketDescriptor& packet, uint8_t class_id) {
     std::lock_guard<std::mutex> lock(mutex_);
     
     // Check if class exists
-    if (queues_.find(class_id) == queues_.end()) {
+    uint16_t slot = slot_of_[class_id];
+    if (slot == NO_SLOT) {
         return false;
     }
     
-    // Create queue item
-    QueueItem item;
-    item.packet = packet;
-    item.class_id = class_id;
-    item.enqueue_time = std::chrono::steady_clock::now();
-    item.virtual_finish_time = calculate_virtual_finish_time(packet, class_id);
-    
-    // Add to queue
-    queues_[class_id].push(item);
+    return push_item(packet, slot);
+}
+
+bool WeightedFairQueue::dequeue_packet(PacketInfo& packet) {
+    PacketDescriptor descriptor;
+    if (!dequeue_packet(descriptor)) {
+        return false;
+    }
     
+    packet = to_packet_info(descriptor);
     return true;
 }
 
-bool WeightedFairQueue::dequeue_packet(PacketInfo& packet) {
+bool WeightedFairQueue::dequeue_packet(PacketDescriptor& packet) {
     std::lock_guard<std::mutex> lock(mutex_);
     
     QueueItem item;
@@ -58,35 +66,58 @@ bool WeightedFairQueue::dequeue_packet(PacketInfo& packet) {
     return false;
 }
 
-bool WeightedFairQueue::is_empty() const {
+size_t WeightedFairQueue::enqueue_burst(const PacketDescriptor* packets, size_t count, BurstVerdict& verdicts) {
+    count = std::min(count, MAX_BURST_SIZE);
+    verdicts.reset();
+    
     std::lock_guard<std::mutex> lock(mutex_);
     
-    for (const auto& [class_id, queue] : queues_) {
-        if (!queue.empty()) {
-            return false;
+    // Classify the whole burst, then enqueue
+    uint8_t class_ids[MAX_BURST_SIZE];
+    for (size_t i = 0; i < count; ++i) {
+        class_ids[i] = classify_packet(packets[i]);
+    }
+    
+    size_t enqueued = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint16_t slot = slot_of_[class_ids[i]];
+        if (slot != NO_SLOT && push_item(packets[i], slot)) {
+            verdicts.set(i);
+            enqueued++;
         }
     }
     
-    return true;
+    return enqueued;
 }
 
-size_t WeightedFairQueue::queue_size() const {
+size_t WeightedFairQueue::dequeue_burst(PacketDescriptor* packets, size_t max_count) {
     std::lock_guard<std::mutex> lock(mutex_);
     
-    size_t total_size = 0;
-    for (const auto& [class_id, queue] : queues_) {
-        total_size += queue.size();
+    size_t dequeued = 0;
+    QueueItem item;
+    while (dequeued < max_count && select_next_packet(item)) {
+        packets[dequeued++] = item.packet;
     }
     
-    return total_size;
+    return dequeued;
+}
+
+bool WeightedFairQueue::is_empty() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_queued_ == 0;
+}
+
+size_t WeightedFairQueue::queue_size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_queued_;
 }
 
 size_t WeightedFairQueue::queue_size(uint8_t class_id) const {
     std::lock_guard<std::mutex> lock(mutex_);
     
-    auto it = queues_.find(class_id);
-    if (it != queues_.end()) {
-        return it->second.size();
+    uint16_t slot = slot_of_[class_id];
+    if (slot != NO_SLOT) {
+        return states_[slot].queue.size();
     }
     
     return 0;
@@ -96,31 +127,33 @@ bool WeightedFairQueue::add_class(const WFQClass& wfq_class) {
     std::lock_guard<std::mutex> lock(mutex_);
     
     // Check if class already exists
-    for (const auto& existing_class : classes_) {
-        if (existing_class.class_id == wfq_class.class_id) {
-            return false;
-        }
+    if (slot_of_[wfq_class.class_id] != NO_SLOT) {
+        return false;
     }
     
-    classes_.push_back(wfq_class);
-    queues_[wfq_class.class_id] = std::queue<QueueItem>();
-    
+    insert_class(wfq_class);
     return true;
 }
 
 bool WeightedFairQueue::remove_class(uint8_t class_id) {
     std::lock_guard<std::mutex> lock(mutex_);
     
-    // Remove from classes vector
-    auto it = std::find_if(classes_.begin(), classes_.end(),
-                          [class_id](const WFQClass& c) { return c.class_id == class_id; });
-    
-    if (it != classes_.end()) {
-        classes_.erase(it);
+    uint16_t slot = slot_of_[class_id];
+    if (slot == NO_SLOT) {
+        return true;
     }
     
-    // Remove from queues
-    queues_.erase(class_id);
+    // Queued packets of the class are discarded; the last slot moves into
+    // the hole and the heap is rebuilt since it references slots
+    total_queued_ -= states_[slot].queue.size();
+    uint16_t last = static_cast<uint16_t>(states_.size() - 1);
+    if (slot != last) {
+        states_[slot] = std::move(states_[last]);
+        slot_of_[states_[slot].config.class_id] = slot;
+    }
+    states_.pop_back();
+    slot_of_[class_id] = NO_SLOT;
+    rebuild_heap();
     
     return true;
 }
@@ -129,27 +162,50 @@ bool WeightedFairQueue::update_class(const WFQClass& wfq_class) {
     std::lock_guard<std::mutex> lock(mutex_);
     
     // Find and update class
-    for (auto& existing_class : classes_) {
-        if (existing_class.class_id == wfq_class.class_id) {
-            existing_class = wfq_class;
-            return true;
-        }
+    uint16_t slot = slot_of_[wfq_class.class_id];
+    if (slot == NO_SLOT) {
+        return false;
     }
     
-    return false;
+    states_[slot].config = wfq_class;
+    return true;
 }
 
 std::vector<WFQClass> WeightedFairQueue::get_classes() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    return classes_;
+    
+    std::vector<WFQClass> classes;
+    classes.reserve(states_.size());
+    for (const auto& state : states_) {
+        classes.push_back(state.config);
+    }
+    return classes;
 }
 
 void WeightedFairQueue::set_classifier(std::function<uint8_t(const PacketInfo&)> classifier) {
     std::lock_guard<std::mutex> lock(mutex_);
+    
+    if (!classifier) {
+        classifier_ = nullptr;
+        return;
+    }
+    
+    // Legacy classifiers see a converted PacketInfo; prefer set_descriptor_classifier
+    classifier_ = [classifier](const PacketDescriptor& packet) {
+        return classifier(to_packet_info(packet));
+    };
+}
+
+void WeightedFairQueue::set_descriptor_classifier(std::function<uint8_t(const PacketDescriptor&)> classifier) {
+    std::lock_guard<std::mutex> lock(mutex_);
     classifier_ = classifier;
 }
 
 uint8_t WeightedFairQueue::classify_packet(const PacketInfo& packet) const {
+    return classify_packet(to_packet_descriptor(packet));
+}
+
+uint8_t WeightedFairQueue::classify_packet(const PacketDescriptor& packet) const {
     if (classifier_) {
         return classifier_(packet);
     }
@@ -164,47 +220,92 @@ uint8_t WeightedFairQueue::classify_packet(const PacketInfo& packet) const {
     }
 }
 
-uint64_t WeightedFairQueue::calculate_virtual_finish_time(const PacketInfo& packet, uint8_t class_id) const {
-    // Find class weight
-    uint32_t weight = 1;
-    for (const auto& wfq_class : classes_) {
-        if (wfq_class.class_id == class_id) {
-            weight = wfq_class.weight;
-            break;
+void WeightedFairQueue::reset_classes() {
+    states_.clear();
+    heap_.clear();
+    slot_of_.fill(NO_SLOT);
+    total_queued_ = 0;
+    virtual_time_ = 0;
+}
+
+void WeightedFairQueue::insert_class(const WFQClass& wfq_class) {
+    slot_of_[wfq_class.class_id] = static_cast<uint16_t>(states_.size());
+    states_.emplace_back();
+    states_.back().config = wfq_class;
+}
+
+void WeightedFairQueue::rebuild_heap() {
+    heap_.clear();
+    for (size_t slot = 0; slot < states_.size(); ++slot) {
+        const ClassState& state = states_[slot];
+        if (!state.queue.empty()) {
+            heap_.push_back({state.queue.front().virtual_finish_time,
+                             static_cast<uint16_t>(slot), state.config.class_id});
         }
     }
+    std::make_heap(heap_.begin(), heap_.end(), std::greater<HeapEntry>());
+}
+
+bool WeightedFairQueue::push_item(const PacketDescriptor& packet, uint16_t slot) {
+    ClassState& state = states_[slot];
+    
+    // Create queue item
+    QueueItem item;
+    item.packet = packet;
+    item.class_id = state.config.class_id;
+    item.enqueue_time_ns = packet.timestamp_ns;
+    item.virtual_finish_time = calculate_virtual_finish_time(packet, state);
+    state.last_finish_time = item.virtual_finish_time;
+    
+    // A class becoming backlogged enters the heap with its head finish time
+    if (state.queue.empty()) {
+        heap_.push_back({item.virtual_finish_time, slot, item.class_id});
+        std::push_heap(heap_.begin(), heap_.end(), std::greater<HeapEntry>());
+    }
     
-    // Calculate virtual finish time
-    uint64_t virtual_finish_time = virtual_time_ + (packet.size * 8) / weight;
+    state.queue.push(item);
+    state.packets_queued++;
+    state.bytes_queued += packet.size;
+    total_queued_++;
     
-    return virtual_finish_time;
+    return true;
+}
+
+uint64_t WeightedFairQueue::calculate_virtual_finish_time(const PacketDescriptor& packet,
+                                                          const ClassState& state) const {
+    uint32_t weight = std::max<uint32_t>(1, state.config.weight);
+    
+    // Finish tags within a class are cumulative, starting from the current
+    // virtual time when the class was idle
+    uint64_t start_time = std::max(virtual_time_, state.last_finish_time);
+    return start_time + (static_cast<uint64_t>(packet.size) * 8 * VIRTUAL_TIME_SCALE) / weight;
 }
 
 bool WeightedFairQueue::select_next_packet(QueueItem& item) {
-    // Find the packet with the smallest virtual finish time
-    uint64_t min_finish_time = UINT64_MAX;
-    uint8_t selected_class = 0;
-    bool found = false;
-    
-    for (const auto& [class_id, queue] : queues_) {
-        if (!queue.empty()) {
-            const QueueItem& front_item = queue.front();
-            if (front_item.virtual_finish_time < min_finish_time) {
-                min_finish_time = front_item.virtual_finish_time;
-                selected_class = class_id;
-                found = true;
-            }
-        }
+    if (heap_.empty()) {
+        return false;
     }
     
-    if (found) {
-        item = queues_[selected_class].front();
-        queues_[selected_class].pop();
-        virtual_time_ = std::max(virtual_time_, item.virtual_finish_time);
-        return true;
+    // The heap top holds the smallest head-of-line finish time
+    std::pop_heap(heap_.begin(), heap_.end(), std::greater<HeapEntry>());
+    uint16_t slot = heap_.back().slot;
+    ClassState& state = states_[slot];
+    
+    item = state.queue.front();
+    state.queue.pop();
+    state.packets_dequeued++;
+    state.bytes_dequeued += item.packet.size;
+    total_queued_--;
+    virtual_time_ = std::max(virtual_time_, item.virtual_finish_time);
+    
+    if (state.queue.empty()) {
+        heap_.pop_back();
+    } else {
+        heap_.back().finish_time = state.queue.front().virtual_finish_time;
+        std::push_heap(heap_.begin(), heap_.end(), std::greater<HeapEntry>());
     }
     
-    return false;
+    return true;
 }
 
 // WFQ Statistics
@@ -216,18 +317,24 @@ WFQStatistics WeightedFairQueue::get_statistics() const {
     stats.total_packets_dequeued = 0;
     stats.total_bytes_queued = 0;
     stats.total_bytes_dequeued = 0;
-    stats.current_queue_length = queue_size();
-    
-    for (const auto& [class_id, queue] : queues_) {
-        ClassStatistics class_stats;
-        class_stats.class_id = class_id;
-        class_stats.packets_queued = 0; // Would need to track this
-        class_stats.packets_dequeued = 0; // Would need to track this
-        class_stats.bytes_queued = 0; // Would need to track this
-        class_stats.bytes_dequeued = 0; // Would need to track this
-        class_stats.current_queue_length = queue.size();
+    stats.current_queue_length = 0;
+    
+    for (const auto& state : states_) {
+        ClassStatistics class_stats{};
+        class_stats.class_id = state.config.class_id;
+        class_stats.packets_queued = state.packets_queued;
+        class_stats.packets_dequeued = state.packets_dequeued;
+        class_stats.bytes_queued = state.bytes_queued;
+        class_stats.bytes_dequeued = state.bytes_dequeued;
+        class_stats.current_queue_length = state.queue.size();
+        
+        stats.total_packets_queued += state.packets_queued;
+        stats.total_packets_dequeued += state.packets_dequeued;
+        stats.total_bytes_queued += state.bytes_queued;
+        stats.total_bytes_dequeued += state.bytes_dequeued;
+        stats.current_queue_length += state.queue.size();
         
-        stats.class_statistics[class_id] = class_stats;
+        stats.class_statistics[class_stats.class_id] = class_stats;
     }
     
     return stats;
@@ -235,7 +342,13 @@ WFQStatistics WeightedFairQueue::get_statistics() const {
 
 void WeightedFairQueue::reset_statistics() {
     std::lock_guard<std::mutex> lock(mutex_);
-    // Reset statistics tracking
+    
+    for (auto& state : states_) {
+        state.packets_queued = 0;
+        state.packets_dequeued = 0;
+        state.bytes_queued = 0;
+        state.bytes_dequeued = 0;
+    }
 }
 
 } // namespace RouterSim
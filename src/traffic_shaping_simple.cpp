@@ -1,108 +1,250 @@
 #include "traffic_shaping.h"
 #include "common_types.h"
+#include "testing/pcap_tap.h"
 #include <iostream>
 #include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <limits>
 #include <map>
 #include <functional>
 
 namespace RouterSim {
 
 // TokenBucket implementation
+namespace {
+
+constexpr uint64_t TICKS_PER_SECOND = 16ULL * 1000000000ULL;
+constexpr unsigned COST_FRACTION_BITS = 8;
+constexpr uint64_t MAX_TICKS = std::numeric_limits<uint64_t>::max();
+
+uint64_t saturating_multiply(uint64_t a, uint64_t b) {
+    if (a != 0 && b > std::numeric_limits<uint64_t>::max() / a) {
+        return std::numeric_limits<uint64_t>::max();
+    }
+    return a * b;
+}
+
+// Ticks that tokens cost, rounded down; saturates
+uint64_t token_ticks(uint64_t tokens, uint64_t cost) {
+    uint64_t fixed = saturating_multiply(tokens, cost);
+    return fixed == MAX_TICKS ? MAX_TICKS : fixed >> COST_FRACTION_BITS;
+}
+
+// Whole tokens that ticks pay for
+uint64_t ticks_tokens(uint64_t ticks, uint64_t cost) {
+    if (ticks > (MAX_TICKS >> COST_FRACTION_BITS)) {
+        return saturating_multiply(ticks / cost, 1ULL << COST_FRACTION_BITS);
+    }
+    return (ticks << COST_FRACTION_BITS) / cost;
+}
+
+std::atomic<size_t> next_stat_shard{0};
+
+} // namespace
+
 TokenBucket::TokenBucket(uint64_t capacity, uint64_t refill_rate, uint64_t burst_size)
-    : capacity_(capacity), refill_rate_(refill_rate), burst_size_(burst_size), 
-      tokens_(capacity), last_refill_time_(std::chrono::steady_clock::now()),
-      total_packets_processed_(0), total_bytes_processed_(0), 
-      packets_dropped_(0), bytes_dropped_(0) {
+    : capacity_(capacity), refill_rate_(refill_rate), burst_size_(burst_size),
+      cost_per_token_(0), tolerance_(0), theoretical_arrival_(0),
+      epoch_(std::chrono::steady_clock::now()) {
+    update_derived(capacity);
 }
 
 TokenBucket::~TokenBucket() = default;
 
+uint64_t TokenBucket::now_ticks() const {
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - epoch_);
+    return static_cast<uint64_t>(elapsed.count()) * TICKS_PER_NS;
+}
+
+// Tokens the bucket holds at most: the capacity, or the burst size if smaller
+uint64_t TokenBucket::depth() const {
+    uint64_t capacity = capacity_.load(std::memory_order_relaxed);
+    uint64_t burst_size = burst_size_.load(std::memory_order_relaxed);
+    return burst_size > 0 ? std::min(capacity, burst_size) : capacity;
+}
+
+// Recomputes cost and tolerance from capacity/rate and positions the
+// arrival time so the bucket holds `available` tokens. Caller holds
+// config_mutex_ (or is the constructor).
+void TokenBucket::update_derived(uint64_t available) {
+    uint64_t capacity = depth();
+    uint64_t rate = refill_rate_.load(std::memory_order_relaxed);
+    
+    // A zero rate never refills; model it as one token per second so the
+    // initial capacity stays usable without special-casing the hot path
+    constexpr uint64_t cost_per_second = TICKS_PER_SECOND << COST_FRACTION_BITS;
+    uint64_t cost = rate > 0 ? std::max<uint64_t>(1, cost_per_second / rate) : cost_per_second;
+    uint64_t deficit = capacity > available ? capacity - available : 0;
+    
+    cost_per_token_.store(cost, std::memory_order_relaxed);
+    tolerance_.store(token_ticks(capacity, cost), std::memory_order_relaxed);
+    uint64_t now = now_ticks();
+    theoretical_arrival_.store(now + std::min(token_ticks(deficit, cost), MAX_TICKS - now),
+                               std::memory_order_release);
+}
+
+TokenBucket::StatShard& TokenBucket::local_shard() {
+    thread_local size_t shard = next_stat_shard.fetch_add(1, std::memory_order_relaxed) % STAT_SHARDS;
+    return stats_[shard];
+}
+
+void TokenBucket::record(bool admitted, uint64_t bytes) {
+    StatShard& shard = local_shard();
+    if (admitted) {
+        shard.packets_processed.fetch_add(1, std::memory_order_relaxed);
+        shard.bytes_processed.fetch_add(bytes, std::memory_order_relaxed);
+    } else {
+        shard.packets_dropped.fetch_add(1, std::memory_order_relaxed);
+        shard.bytes_dropped.fetch_add(bytes, std::memory_order_relaxed);
+    }
+}
+
 bool TokenBucket::consume(uint64_t tokens) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    refillTokens();
+    uint64_t cost = token_ticks(tokens, cost_per_token_.load(std::memory_order_relaxed));
+    uint64_t tolerance = tolerance_.load(std::memory_order_relaxed);
+    uint64_t now = now_ticks();
     
-    if (tokens_ >= tokens) {
-        tokens_ -= tokens;
-        return true;
+    uint64_t tat = theoretical_arrival_.load(std::memory_order_relaxed);
+    for (;;) {
+        uint64_t start = std::max(tat, now);
+        uint64_t backlog = start - now;
+        if (cost > tolerance || backlog > tolerance - cost) {
+            record(false, tokens);
+            return false;
+        }
+        if (theoretical_arrival_.compare_exchange_weak(tat, start + cost,
+                                                       std::memory_order_acq_rel,
+                                                       std::memory_order_relaxed)) {
+            record(true, tokens);
+            return true;
+        }
     }
-    return false;
 }
 
 bool TokenBucket::consumePacket(const PacketInfo& packet) {
     return consume(packet.size);
 }
 
-void TokenBucket::refillTokens() {
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_refill_time_);
+bool TokenBucket::consumePacket(const PacketDescriptor& packet) {
+    return consume(packet.size);
+}
+
+size_t TokenBucket::consumeBurst(const PacketDescriptor* packets, size_t count, BurstVerdict& verdicts) {
+    count = std::min(count, MAX_BURST_SIZE);
+    uint64_t cost_per_token = cost_per_token_.load(std::memory_order_relaxed);
+    uint64_t tolerance = tolerance_.load(std::memory_order_relaxed);
+    uint64_t now = now_ticks();
     
-    if (elapsed.count() > 0) {
-        uint64_t tokens_to_add = (refill_rate_ * elapsed.count()) / 1000;
-        tokens_ = std::min(capacity_, tokens_ + tokens_to_add);
-        last_refill_time_ = now;
+    // One clock read and one CAS for the whole burst; packets are admitted
+    // in order and the burst is re-evaluated if another thread got in first
+    size_t admitted = 0;
+    uint64_t tat = theoretical_arrival_.load(std::memory_order_relaxed);
+    for (;;) {
+        uint64_t next = std::max(tat, now);
+        admitted = 0;
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t cost = token_ticks(packets[i].size, cost_per_token);
+            if (cost <= tolerance && next - now <= tolerance - cost) {
+                next += cost;
+                verdicts.set(i);
+                admitted++;
+            } else {
+                verdicts.reset(i);
+            }
+        }
+        if (admitted == 0 ||
+            theoretical_arrival_.compare_exchange_weak(tat, next,
+                                                       std::memory_order_acq_rel,
+                                                       std::memory_order_relaxed)) {
+            break;
+        }
     }
+    
+    for (size_t i = 0; i < count; ++i) {
+        record(verdicts.test(i), packets[i].size);
+    }
+    return admitted;
+}
+
+void TokenBucket::refillTokens() {
+    // Refill is implicit in the arrival-time representation
 }
 
 void TokenBucket::setCapacity(uint64_t capacity) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    capacity_ = capacity;
-    tokens_ = std::min(tokens_, capacity_);
+    std::lock_guard<std::mutex> lock(config_mutex_);
+    uint64_t available = getAvailableTokens();
+    capacity_.store(capacity, std::memory_order_relaxed);
+    update_derived(std::min(available, capacity));
 }
 
 void TokenBucket::setRefillRate(uint64_t refill_rate) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    refill_rate_ = refill_rate;
+    std::lock_guard<std::mutex> lock(config_mutex_);
+    uint64_t available = getAvailableTokens();
+    refill_rate_.store(refill_rate, std::memory_order_relaxed);
+    update_derived(available);
 }
 
 void TokenBucket::setBurstSize(uint64_t burst_size) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    burst_size_ = burst_size;
+    std::lock_guard<std::mutex> lock(config_mutex_);
+    uint64_t available = getAvailableTokens();
+    burst_size_.store(burst_size, std::memory_order_relaxed);
+    update_derived(std::min(available, depth()));
 }
 
 uint64_t TokenBucket::getAvailableTokens() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    const_cast<TokenBucket*>(this)->refillTokens();
-    return tokens_;
+    uint64_t cost = cost_per_token_.load(std::memory_order_relaxed);
+    uint64_t tolerance = tolerance_.load(std::memory_order_relaxed);
+    uint64_t now = now_ticks();
+    uint64_t tat = theoretical_arrival_.load(std::memory_order_acquire);
+    
+    uint64_t backlog = tat > now ? tat - now : 0;
+    if (backlog >= tolerance) {
+        return 0;
+    }
+    return std::min(depth(), ticks_tokens(tolerance - backlog, cost));
 }
 
 void TokenBucket::reset() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    tokens_ = capacity_;
-    last_refill_time_ = std::chrono::steady_clock::now();
-    total_packets_processed_ = 0;
-    total_bytes_processed_ = 0;
-    packets_dropped_ = 0;
-    bytes_dropped_ = 0;
+    std::lock_guard<std::mutex> lock(config_mutex_);
+    theoretical_arrival_.store(now_ticks(), std::memory_order_release);
+    for (auto& shard : stats_) {
+        shard.packets_processed.store(0, std::memory_order_relaxed);
+        shard.bytes_processed.store(0, std::memory_order_relaxed);
+        shard.packets_dropped.store(0, std::memory_order_relaxed);
+        shard.bytes_dropped.store(0, std::memory_order_relaxed);
+    }
 }
 
 TokenBucket::Statistics TokenBucket::getStatistics() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    Statistics stats;
-    stats.capacity = capacity_;
-    stats.refill_rate = refill_rate_;
-    stats.burst_size = burst_size_;
-    stats.available_tokens = tokens_;
-    stats.total_packets_processed = total_packets_processed_;
-    stats.total_bytes_processed = total_bytes_processed_;
-    stats.packets_dropped = packets_dropped_;
-    stats.bytes_dropped = bytes_dropped_;
-    stats.utilization_percentage = capacity_ > 0 ? (double)total_bytes_processed_ / capacity_ * 100.0 : 0.0;
+    Statistics stats{};
+    stats.capacity = capacity_.load(std::memory_order_relaxed);
+    stats.refill_rate = refill_rate_.load(std::memory_order_relaxed);
+    stats.burst_size = burst_size_.load(std::memory_order_relaxed);
+    stats.available_tokens = getAvailableTokens();
+    for (const auto& shard : stats_) {
+        stats.total_packets_processed += shard.packets_processed.load(std::memory_order_relaxed);
+        stats.total_bytes_processed += shard.bytes_processed.load(std::memory_order_relaxed);
+        stats.packets_dropped += shard.packets_dropped.load(std::memory_order_relaxed);
+        stats.bytes_dropped += shard.bytes_dropped.load(std::memory_order_relaxed);
+    }
+    stats.utilization_percentage = stats.capacity > 0 ?
+        (double)stats.total_bytes_processed / stats.capacity * 100.0 : 0.0;
     return stats;
 }
 
 // WFQ implementation
-WFQ::WFQ(uint32_t max_queues) 
-    : max_queues_(max_queues), total_weight_(0), virtual_time_(0.0),
-      last_update_time_(std::chrono::steady_clock::now()),
-      total_packets_processed_(0), total_bytes_processed_(0),
+WFQ::WFQ(uint32_t max_queues, uint64_t link_rate_bps)
+    : max_queues_(max_queues), total_weight_(max_queues), 
+      link_rate_bps_(std::max<uint64_t>(1, link_rate_bps)), virtual_time_(0.0),
+      backlogged_queues_(0), total_packets_processed_(0), total_bytes_processed_(0),
       packets_dropped_(0), bytes_dropped_(0) {
     queues_.resize(max_queues_);
     for (uint32_t i = 0; i < max_queues_; ++i) {
         queues_[i].weight = 1;
-        queues_[i].packets = 0;
         queues_[i].bytes = 0;
+        queues_[i].start_time = 0.0;
         queues_[i].finish_time = 0.0;
     }
 }
@@ -110,21 +252,56 @@ WFQ::WFQ(uint32_t max_queues)
 WFQ::~WFQ() = default;
 
 bool WFQ::enqueue(uint32_t queue_id, const PacketInfo& packet) {
+    return enqueue(queue_id, to_packet_descriptor(packet));
+}
+
+bool WFQ::enqueue(uint32_t queue_id, const PacketDescriptor& packet) {
     if (queue_id >= max_queues_) {
         return false;
     }
     
     std::lock_guard<std::mutex> lock(mutex_);
-    updateVirtualTime();
+    return enqueueLocked(queue_id, packet);
+}
+
+size_t WFQ::enqueueBurst(const PacketDescriptor* packets, size_t count, BurstVerdict& verdicts) {
+    count = std::min(count, MAX_BURST_SIZE);
+    std::lock_guard<std::mutex> lock(mutex_);
     
-    if (queues_[queue_id].packets >= MAX_QUEUE_SIZE) {
+    // Only packets whose verdict bit is already set are enqueued
+    size_t enqueued = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (!verdicts.test(i)) {
+            continue;
+        }
+        
+        if (!enqueueLocked(packets[i].priority % max_queues_, packets[i])) {
+            verdicts.reset(i);
+            continue;
+        }
+        enqueued++;
+    }
+    return enqueued;
+}
+
+bool WFQ::enqueueLocked(uint32_t queue_id, const PacketDescriptor& packet) {
+    Queue& queue = queues_[queue_id];
+    if (queue.packets.size() >= MAX_QUEUE_SIZE) {
         packets_dropped_++;
         bytes_dropped_ += packet.size;
         return false;
     }
     
-    queues_[queue_id].packets++;
-    queues_[queue_id].bytes += packet.size;
+    // A queue becoming backlogged starts no earlier than the system
+    // virtual time and no earlier than its previous packet finished
+    if (queue.packets.empty()) {
+        queue.start_time = std::max(queue.finish_time, virtual_time_);
+        queue.finish_time = queue.start_time + serviceTime(queue, packet.size);
+        backlogged_queues_++;
+    }
+    
+    queue.packets.push_back(packet);
+    queue.bytes += packet.size;
     total_packets_processed_++;
     total_bytes_processed_ += packet.size;
     
@@ -132,31 +309,51 @@ bool WFQ::enqueue(uint32_t queue_id, const PacketInfo& packet) {
 }
 
 bool WFQ::dequeue(PacketInfo& packet) {
+    PacketDescriptor descriptor;
+    if (!dequeue(descriptor)) {
+        return false;
+    }
+    
+    packet = to_packet_info(descriptor);
+    return true;
+}
+
+bool WFQ::dequeue(PacketDescriptor& packet) {
     std::lock_guard<std::mutex> lock(mutex_);
-    updateVirtualTime();
     
-    // Find queue with minimum finish time
-    uint32_t selected_queue = 0;
+    if (backlogged_queues_ == 0) {
+        return false;
+    }
+    
+    // A queue that went idle and refilled may start ahead of virtual time
+    updateVirtualTime(0);
+    
+    // Smallest finish tag among eligible queues (start tag <= virtual time)
+    uint32_t selected_queue = max_queues_;
     double min_finish_time = std::numeric_limits<double>::max();
     
     for (uint32_t i = 0; i < max_queues_; ++i) {
-        if (queues_[i].packets > 0) {
-            double finish_time = queues_[i].finish_time;
-            if (finish_time < min_finish_time) {
-                min_finish_time = finish_time;
-                selected_queue = i;
-            }
+        const Queue& queue = queues_[i];
+        if (!queue.packets.empty() && queue.start_time <= virtual_time_ &&
+            queue.finish_time < min_finish_time) {
+            min_finish_time = queue.finish_time;
+            selected_queue = i;
         }
     }
     
-    if (queues_[selected_queue].packets == 0) {
-        return false;
-    }
+    Queue& queue = queues_[selected_queue];
+    packet = queue.packets.front();
+    queue.packets.pop_front();
+    queue.bytes -= packet.size;
     
-    // Dequeue packet (simplified - just decrement counters)
-    queues_[selected_queue].packets--;
-    queues_[selected_queue].bytes -= packet.size; // This is simplified
+    if (queue.packets.empty()) {
+        backlogged_queues_--;
+    } else {
+        queue.start_time = queue.finish_time;
+        queue.finish_time = queue.start_time + serviceTime(queue, queue.packets.front().size);
+    }
     
+    updateVirtualTime(packet.size);
     return true;
 }
 
@@ -165,15 +362,28 @@ void WFQ::setQueueWeight(uint32_t queue_id, uint32_t weight) {
         return;
     }
     
+    // Tags already assigned keep the old share; new packets use the new one
     std::lock_guard<std::mutex> lock(mutex_);
+    weight = std::max<uint32_t>(1, weight);
     total_weight_ = total_weight_ - queues_[queue_id].weight + weight;
     queues_[queue_id].weight = weight;
 }
 
+void WFQ::setLinkRate(uint64_t link_rate_bps) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    link_rate_bps_ = std::max<uint64_t>(1, link_rate_bps);
+}
+
+uint64_t WFQ::getLinkRate() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return link_rate_bps_;
+}
+
 uint32_t WFQ::getQueueWeight(uint32_t queue_id) const {
     if (queue_id >= max_queues_) {
         return 0;
     }
+    std::lock_guard<std::mutex> lock(mutex_);
     return queues_[queue_id].weight;
 }
 
@@ -181,24 +391,37 @@ uint32_t WFQ::getQueueSize(uint32_t queue_id) const {
     if (queue_id >= max_queues_) {
         return 0;
     }
-    return queues_[queue_id].packets;
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<uint32_t>(queues_[queue_id].packets.size());
 }
 
 uint64_t WFQ::getQueueBytes(uint32_t queue_id) const {
     if (queue_id >= max_queues_) {
         return 0;
     }
+    std::lock_guard<std::mutex> lock(mutex_);
     return queues_[queue_id].bytes;
 }
 
-void WFQ::updateVirtualTime() {
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_update_time_);
+// Time to send `size` bytes at the queue's guaranteed rate, in ns
+double WFQ::serviceTime(const Queue& queue, uint32_t size) const {
+    double guaranteed_rate = (double)link_rate_bps_ * queue.weight / total_weight_;
+    return size * 8.0 * 1e9 / guaranteed_rate;
+}
+
+void WFQ::updateVirtualTime(uint32_t transmitted_size) {
+    // Advance by the packet's transmission time on the link, then catch up
+    // with the earliest start tag so some backlogged queue stays eligible
+    virtual_time_ += transmitted_size * 8.0 * 1e9 / link_rate_bps_;
     
-    if (elapsed.count() > 0) {
-        // Simplified virtual time update
-        virtual_time_ += elapsed.count() / 1000.0;
-        last_update_time_ = now;
+    if (backlogged_queues_ > 0) {
+        double min_start_time = std::numeric_limits<double>::max();
+        for (const auto& queue : queues_) {
+            if (!queue.packets.empty()) {
+                min_start_time = std::min(min_start_time, queue.start_time);
+            }
+        }
+        virtual_time_ = std::max(virtual_time_, min_start_time);
     }
 }
 
@@ -207,6 +430,7 @@ WFQ::Statistics WFQ::getStatistics() const {
     Statistics stats;
     stats.max_queues = max_queues_;
     stats.total_weight = total_weight_;
+    stats.link_rate_bps = link_rate_bps_;
     stats.virtual_time = virtual_time_;
     stats.total_packets_processed = total_packets_processed_;
     stats.total_bytes_processed = total_bytes_processed_;
@@ -218,7 +442,7 @@ WFQ::Statistics WFQ::getStatistics() const {
         QueueStatistics queue_stat;
         queue_stat.queue_id = i;
         queue_stat.weight = queues_[i].weight;
-        queue_stat.packets = queues_[i].packets;
+        queue_stat.packets = static_cast<uint32_t>(queues_[i].packets.size());
         queue_stat.bytes = queues_[i].bytes;
         queue_stat.finish_time = queues_[i].finish_time;
         stats.queue_stats.push_back(queue_stat);
@@ -230,11 +454,13 @@ WFQ::Statistics WFQ::getStatistics() const {
 void WFQ::reset() {
     std::lock_guard<std::mutex> lock(mutex_);
     for (auto& queue : queues_) {
-        queue.packets = 0;
+        queue.packets.clear();
         queue.bytes = 0;
+        queue.start_time = 0.0;
         queue.finish_time = 0.0;
     }
     virtual_time_ = 0.0;
+    backlogged_queues_ = 0;
     total_packets_processed_ = 0;
     total_bytes_processed_ = 0;
     packets_dropped_ = 0;
@@ -243,10 +469,19 @@ void WFQ::reset() {
 
 // TrafficShaper implementation
 TrafficShaper::TrafficShaper() 
-    : enabled_(false), total_packets_processed_(0), total_bytes_processed_(0),
+    : algorithm_(ShapingAlgorithm::WEIGHTED_FAIR_QUEUE), enabled_(false),
+      total_packets_processed_(0), total_bytes_processed_(0),
       packets_dropped_(0), bytes_dropped_(0) {
-    token_bucket_ = std::make_unique<TokenBucket>(1000, 100, 500);
-    wfq_ = std::make_unique<WFQ>(8);
+    token_bucket_ = std::make_unique<TokenBucket>(1000, 100, 1000);
+    wfq_ = std::make_unique<WFQ>(SCHEDULER_QUEUES);
+    
+    // DRR classes mirror the WFQ queues: class_id == queue_id, weight 1
+    std::vector<WFQClass> classes(SCHEDULER_QUEUES);
+    for (uint32_t i = 0; i < SCHEDULER_QUEUES; ++i) {
+        classes[i].class_id = static_cast<uint8_t>(i);
+    }
+    drr_ = std::make_unique<DeficitRoundRobin>();
+    drr_->initialize(classes);
 }
 
 TrafficShaper::~TrafficShaper() = default;
@@ -256,6 +491,10 @@ bool TrafficShaper::initialize() {
 }
 
 bool TrafficShaper::processPacket(const PacketInfo& packet) {
+    return processPacket(to_packet_descriptor(packet));
+}
+
+bool TrafficShaper::processPacket(const PacketDescriptor& packet) {
     if (!enabled_) {
         return true;
     }
@@ -269,8 +508,8 @@ bool TrafficShaper::processPacket(const PacketInfo& packet) {
         return false;
     }
     
-    // WFQ processing
-    if (!wfq_->enqueue(packet.priority % wfq_->getMaxQueues(), packet)) {
+    // Scheduler processing
+    if (!enqueueScheduled(packet)) {
         packets_dropped_++;
         bytes_dropped_ += packet.size;
         return false;
@@ -282,15 +521,76 @@ bool TrafficShaper::processPacket(const PacketInfo& packet) {
     return true;
 }
 
+size_t TrafficShaper::processBurst(const PacketDescriptor* packets, size_t count, BurstVerdict& verdicts) {
+    count = std::min(count, MAX_BURST_SIZE);
+    verdicts.reset();
+    
+    if (!enabled_) {
+        for (size_t i = 0; i < count; ++i) {
+            verdicts.set(i);
+        }
+        return count;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    // Token bucket admits, the scheduler clears the bits of packets it cannot queue
+    token_bucket_->consumeBurst(packets, count, verdicts);
+    if (algorithm_ == ShapingAlgorithm::DEFICIT_ROUND_ROBIN) {
+        for (size_t i = 0; i < count; ++i) {
+            if (verdicts.test(i) && !enqueueScheduled(packets[i])) {
+                verdicts.reset(i);
+            }
+        }
+    } else {
+        wfq_->enqueueBurst(packets, count, verdicts);
+    }
+    
+    for (size_t i = 0; i < count; ++i) {
+        if (verdicts.test(i)) {
+            total_packets_processed_++;
+            total_bytes_processed_ += packets[i].size;
+        } else {
+            packets_dropped_++;
+            bytes_dropped_ += packets[i].size;
+        }
+    }
+    
+    return verdicts.count();
+}
+
 bool TrafficShaper::dequeuePacket(PacketInfo& packet) {
     if (!enabled_) {
         return false;
     }
     
     std::lock_guard<std::mutex> lock(mutex_);
+    if (algorithm_ == ShapingAlgorithm::DEFICIT_ROUND_ROBIN) {
+        return drr_->dequeue_packet(packet);
+    }
+    return wfq_->dequeue(packet);
+}
+
+bool TrafficShaper::dequeuePacket(PacketDescriptor& packet) {
+    if (!enabled_) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (algorithm_ == ShapingAlgorithm::DEFICIT_ROUND_ROBIN) {
+        return drr_->dequeue_packet(packet);
+    }
     return wfq_->dequeue(packet);
 }
 
+bool TrafficShaper::enqueueScheduled(const PacketDescriptor& packet) {
+    uint32_t queue_id = packet.priority % SCHEDULER_QUEUES;
+    if (algorithm_ == ShapingAlgorithm::DEFICIT_ROUND_ROBIN) {
+        return drr_->enqueue_packet(packet, static_cast<uint8_t>(queue_id));
+    }
+    return wfq_->enqueue(queue_id, packet);
+}
+
 void TrafficShaper::setTokenBucketConfig(uint64_t capacity, uint64_t refill_rate, uint64_t burst_size) {
     std::lock_guard<std::mutex> lock(mutex_);
     token_bucket_->setCapacity(capacity);
@@ -301,6 +601,28 @@ void TrafficShaper::setTokenBucketConfig(uint64_t capacity, uint64_t refill_rate
 void TrafficShaper::setQueueWeight(uint32_t queue_id, uint32_t weight) {
     std::lock_guard<std::mutex> lock(mutex_);
     wfq_->setQueueWeight(queue_id, weight);
+    
+    if (queue_id < SCHEDULER_QUEUES) {
+        WFQClass drr_class;
+        drr_class.class_id = static_cast<uint8_t>(queue_id);
+        drr_class.weight = weight;
+        drr_->update_class(drr_class);
+    }
+}
+
+void TrafficShaper::setAlgorithm(ShapingAlgorithm algorithm) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    algorithm_ = algorithm;
+}
+
+ShapingAlgorithm TrafficShaper::getAlgorithm() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return algorithm_;
+}
+
+void TrafficShaper::setDRRConfig(const DRRConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    drr_->set_config(config);
 }
 
 void TrafficShaper::setEnabled(bool enabled) {
@@ -321,8 +643,10 @@ TrafficShaper::Statistics TrafficShaper::getStatistics() const {
     stats.total_bytes_processed = total_bytes_processed_;
     stats.packets_dropped = packets_dropped_;
     stats.bytes_dropped = bytes_dropped_;
+    stats.algorithm = algorithm_;
     stats.token_bucket_stats = token_bucket_->getStatistics();
     stats.wfq_stats = wfq_->getStatistics();
+    stats.drr_stats = drr_->get_statistics();
     return stats;
 }
 
@@ -330,6 +654,7 @@ void TrafficShaper::reset() {
     std::lock_guard<std::mutex> lock(mutex_);
     token_bucket_->reset();
     wfq_->reset();
+    drr_->initialize(drr_->get_classes());
     total_packets_processed_ = 0;
     total_bytes_processed_ = 0;
     packets_dropped_ = 0;
@@ -338,7 +663,8 @@ void TrafficShaper::reset() {
 
 // TrafficShapingManager implementation
 TrafficShapingManager::TrafficShapingManager() 
-    : running_(false), initialized_(false) {
+    : running_(false), initialized_(false),
+      release_timers_(TimerWheel::DEFAULT_RESOLUTION_NS, packet_clock_ns()), capture_tap_(nullptr) {
 }
 
 TrafficShapingManager::~TrafficShapingManager() {
@@ -364,6 +690,7 @@ bool TrafficShapingManager::start() {
     }
     
     running_ = true;
+    processing_thread_ = std::thread(&TrafficShapingManager::processing_loop, this);
     return true;
 }
 
@@ -372,12 +699,21 @@ bool TrafficShapingManager::stop() {
         return true;
     }
     
+    {
+        // Cleared under the release lock so the sleeping thread cannot miss it
+        std::lock_guard<std::mutex> release_lock(release_mutex_);
+        running_ = false;
+    }
+    release_cv_.notify_all();
+    if (processing_thread_.joinable()) {
+        processing_thread_.join();
+    }
+    
     std::lock_guard<std::mutex> lock(interfaces_mutex_);
     for (auto& [interface_name, shaper] : interfaces_) {
         shaper->setEnabled(false);
     }
     
-    running_ = false;
     return true;
 }
 
@@ -410,6 +746,7 @@ bool TrafficShapingManager::remove_interface(const std::string& interface_name)
     }
     
     interfaces_.erase(it);
+    htb_trees_.erase(interface_name);
     return true;
 }
 
@@ -436,6 +773,33 @@ bool TrafficShapingManager::configure_interface(const std::string& interface_nam
         }
     } else if (algorithm == ShapingAlgorithm::WEIGHTED_FAIR_QUEUE) {
         // Configure WFQ weights
+        for (const auto& [key, value] : config) {
+            if (key.find("weight_") == 0) {
+                uint32_t queue_id = std::stoul(key.substr(7));
+                uint32_t weight = std::stoul(value);
+                shaper->setQueueWeight(queue_id, weight);
+            }
+        }
+    } else if (algorithm == ShapingAlgorithm::HIERARCHICAL_TOKEN_BUCKET) {
+        // The class tree itself comes from configure_htb
+        auto tree = htb_trees_.find(interface_name);
+        if (tree == htb_trees_.end()) {
+            return false;
+        }
+        if (config.find("charge_batch_bytes") != config.end()) {
+            tree->second->set_charge_batch_bytes(std::stoul(config.at("charge_batch_bytes")));
+        }
+    } else if (algorithm == ShapingAlgorithm::DEFICIT_ROUND_ROBIN) {
+        // Configure DRR quantum, DRR++ sparse priority and class weights
+        DRRConfig drr_config;
+        if (config.find("quantum") != config.end()) {
+            drr_config.quantum = std::stoul(config.at("quantum"));
+        }
+        if (config.find("sparse_flow_priority") != config.end()) {
+            drr_config.sparse_flow_priority = config.at("sparse_flow_priority") == "true";
+        }
+        shaper->setDRRConfig(drr_config);
+        
         for (const auto& [key, value] : config) {
             if (key.find("weight_") == 0) {
                 uint32_t queue_id = std::stoul(key.substr(7));
@@ -445,19 +809,129 @@ bool TrafficShapingManager::configure_interface(const std::string& interface_nam
         }
     }
     
+    shaper->setAlgorithm(algorithm);
     shaper->setEnabled(true);
     return true;
 }
 
+bool TrafficShapingManager::configure_htb(const std::string& interface_name,
+                                          const std::vector<HTBClassConfig>& classes,
+                                          uint32_t charge_batch_bytes) {
+    std::lock_guard<std::mutex> lock(interfaces_mutex_);
+    
+    if (interfaces_.find(interface_name) == interfaces_.end()) {
+        return false; // Interface not found
+    }
+    
+    auto tree = std::make_unique<HierarchicalTokenBucket>(charge_batch_bytes);
+    if (!tree->initialize(classes)) {
+        std::cerr << "Invalid HTB class tree for interface " << interface_name << std::endl;
+        return false;
+    }
+    
+    htb_trees_[interface_name] = std::move(tree);
+    return true;
+}
+
+std::vector<HTBClassConfig> TrafficShapingManager::get_htb_classes(const std::string& interface_name) const {
+    std::lock_guard<std::mutex> lock(interfaces_mutex_);
+    
+    auto tree = htb_trees_.find(interface_name);
+    if (tree == htb_trees_.end()) {
+        return {};
+    }
+    return tree->second->get_classes();
+}
+
 bool TrafficShapingManager::process_packet(const std::string& interface_name, const PacketInfo& packet) {
+    return process_packet(interface_name, to_packet_descriptor(packet));
+}
+
+bool TrafficShapingManager::process_packet(const std::string& interface_name, const PacketDescriptor& packet) {
+    PcapTap* tap = capture_tap_.load(std::memory_order_acquire);
+    if (tap) {
+        tap->capture(CaptureStage::PRE_SHAPING, packet);
+    }
+    
+    bool accepted;
+    {
+        std::lock_guard<std::mutex> lock(interfaces_mutex_);
+        
+        auto tree = htb_trees_.find(interface_name);
+        auto it = interfaces_.find(interface_name);
+        if (tree != htb_trees_.end()) {
+            accepted = tree->second->enqueue_packet(packet, tree->second->classify_packet(packet));
+        } else if (it != interfaces_.end()) {
+            accepted = it->second->processPacket(packet);
+        } else {
+            accepted = false; // Interface not found
+        }
+    }
+    
+    if (tap && !accepted) {
+        tap->capture(CaptureStage::DROPPED, packet);
+    }
+    if (accepted && running_) {
+        wake_interface(interface_name);
+    }
+    return accepted;
+}
+
+size_t TrafficShapingManager::process_burst(const std::string& interface_name, const PacketDescriptor* packets,
+                                            size_t count, BurstVerdict& verdicts) {
+    count = std::min(count, MAX_BURST_SIZE);
+    PcapTap* tap = capture_tap_.load(std::memory_order_acquire);
+    if (tap) {
+        tap->capture_burst(CaptureStage::PRE_SHAPING, packets, count);
+    }
+    
+    size_t accepted;
+    {
+        std::lock_guard<std::mutex> lock(interfaces_mutex_);
+        
+        auto tree = htb_trees_.find(interface_name);
+        auto it = interfaces_.find(interface_name);
+        if (tree != htb_trees_.end()) {
+            verdicts.reset();
+            uint64_t now_ns = packet_clock_ns();
+            for (size_t i = 0; i < count; ++i) {
+                if (tree->second->enqueue_packet(packets[i], tree->second->classify_packet(packets[i]), now_ns)) {
+                    verdicts.set(i);
+                }
+            }
+            accepted = verdicts.count();
+        } else if (it != interfaces_.end()) {
+            accepted = it->second->processBurst(packets, count, verdicts);
+        } else {
+            verdicts.reset();
+            accepted = 0; // Interface not found
+        }
+    }
+    
+    if (tap && accepted < count) {
+        BurstVerdict dropped = ~verdicts;
+        tap->capture_burst(CaptureStage::DROPPED, packets, count, &dropped);
+    }
+    if (accepted > 0 && running_) {
+        wake_interface(interface_name);
+    }
+    return accepted;
+}
+
+bool TrafficShapingManager::dequeue_packet(const std::string& interface_name, PacketDescriptor& packet) {
     std::lock_guard<std::mutex> lock(interfaces_mutex_);
     
+    auto tree = htb_trees_.find(interface_name);
+    if (tree != htb_trees_.end()) {
+        return tree->second->dequeue_packet(packet);
+    }
+    
     auto it = interfaces_.find(interface_name);
     if (it == interfaces_.end()) {
         return false; // Interface not found
     }
     
-    return it->second->processPacket(packet);
+    return it->second->dequeuePacket(packet);
 }
 
 std::map<std::string, TrafficStats> TrafficShapingManager::get_interface_statistics() const {
@@ -474,6 +948,16 @@ std::map<std::string, TrafficStats> TrafficShapingManager::get_interface_statist
         stats[interface_name] = interface_stats;
     }
     
+    // HTB interfaces report what the tree has sent and dropped
+    for (const auto& [interface_name, tree] : htb_trees_) {
+        auto tree_stats = tree->get_statistics();
+        TrafficStats& interface_stats = stats[interface_name];
+        interface_stats.packets_processed = tree_stats.packets_sent;
+        interface_stats.bytes_processed = tree_stats.bytes_sent;
+        interface_stats.packets_dropped = tree_stats.packets_dropped;
+        interface_stats.bytes_dropped = 0;
+    }
+    
     return stats;
 }
 
@@ -482,12 +966,12 @@ TrafficStats TrafficShapingManager::get_global_statistics() const {
     return global_stats_;
 }
 
-bool TrafficShapingManager::load_config(const std::string& config_file) {
+bool TrafficShapingManager::load_config(const std::string& /*config_file*/) {
     // Simplified implementation
     return true;
 }
 
-bool TrafficShapingManager::save_config(const std::string& config_file) const {
+bool TrafficShapingManager::save_config(const std::string& /*config_file*/) const {
     // Simplified implementation
     return true;
 }
@@ -500,11 +984,129 @@ void TrafficShapingManager::set_drop_callback(DropCallback callback) {
     drop_callback_ = callback;
 }
 
+void TrafficShapingManager::set_capture_tap(PcapTap* tap) {
+    capture_tap_.store(tap, std::memory_order_release);
+}
+
 void TrafficShapingManager::processing_loop() {
-    // Simplified implementation
+    std::vector<std::string> ready;
+    std::vector<PacketDescriptor> released;
+    released.reserve(MAX_BURST_SIZE);
+    
+    std::unique_lock<std::mutex> lock(release_mutex_);
+    while (running_) {
+        // Interfaces whose release time has come join those woken by enqueue
+        release_timers_.advance(packet_clock_ns(), [this](TimerWheel::TimerId id, uint64_t) {
+            auto it = timer_interface_.find(id);
+            if (it != timer_interface_.end()) {
+                ready_interfaces_.insert(it->second);
+                release_timer_of_.erase(it->second);
+                timer_interface_.erase(it);
+            }
+        });
+        
+        if (ready_interfaces_.empty()) {
+            // Sleep until the next release time; with no timers armed only
+            // an enqueue or stop() wakes the thread. Timers are only armed
+            // by this thread, so none can appear while it sleeps.
+            auto woken = [this] { return !running_ || !ready_interfaces_.empty(); };
+            uint64_t next_ns = release_timers_.next_expiry_ns();
+            if (next_ns == TimerWheel::NO_EXPIRY) {
+                release_cv_.wait(lock, woken);
+            } else {
+                release_cv_.wait_until(lock, std::chrono::steady_clock::time_point(
+                    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        std::chrono::nanoseconds(next_ns))), woken);
+            }
+            continue;
+        }
+        
+        ready.assign(ready_interfaces_.begin(), ready_interfaces_.end());
+        ready_interfaces_.clear();
+        lock.unlock();
+        
+        // Callbacks run without locks held so they may feed packets back in
+        for (const auto& interface_name : ready) {
+            released.clear();
+            uint64_t wake_ns = release_packets(interface_name, released);
+            PcapTap* tap = capture_tap_.load(std::memory_order_acquire);
+            if (tap && !released.empty()) {
+                tap->capture_burst(CaptureStage::POST_SHAPING, released.data(), released.size());
+            }
+            for (const auto& packet : released) {
+                notify_packet_processed(to_packet_info(packet));
+            }
+            if (wake_ns != 0) {
+                schedule_release(interface_name, wake_ns);
+            }
+        }
+        
+        lock.lock();
+    }
+}
+
+void TrafficShapingManager::wake_interface(const std::string& interface_name) {
+    {
+        std::lock_guard<std::mutex> lock(release_mutex_);
+        if (!ready_interfaces_.insert(interface_name).second) {
+            return; // Already pending
+        }
+    }
+    release_cv_.notify_one();
+}
+
+// Dequeues up to one burst of eligible packets. Returns when the interface
+// next needs service: 0 when drained, otherwise the time its shaper allows
+// the next packet (now, if the burst limit cut the pass short).
+uint64_t TrafficShapingManager::release_packets(const std::string& interface_name,
+                                                std::vector<PacketDescriptor>& released) {
+    std::lock_guard<std::mutex> lock(interfaces_mutex_);
+    PacketDescriptor packet;
+    
+    auto tree = htb_trees_.find(interface_name);
+    if (tree != htb_trees_.end()) {
+        uint64_t now_ns = packet_clock_ns();
+        while (released.size() < MAX_BURST_SIZE && tree->second->dequeue_packet(packet, now_ns)) {
+            released.push_back(packet);
+        }
+        if (released.size() == MAX_BURST_SIZE) {
+            return now_ns;
+        }
+        return tree->second->is_empty() ? 0 : tree->second->next_wakeup_ns();
+    }
+    
+    // Flat shapers police at enqueue, so queued packets are always eligible
+    auto it = interfaces_.find(interface_name);
+    if (it == interfaces_.end()) {
+        return 0;
+    }
+    while (released.size() < MAX_BURST_SIZE && it->second->dequeuePacket(packet)) {
+        released.push_back(packet);
+    }
+    return released.size() == MAX_BURST_SIZE ? packet_clock_ns() : 0;
+}
+
+void TrafficShapingManager::schedule_release(const std::string& interface_name, uint64_t wake_ns) {
+    std::lock_guard<std::mutex> lock(release_mutex_);
+    
+    if (wake_ns <= packet_clock_ns()) {
+        ready_interfaces_.insert(interface_name);
+        return;
+    }
+    
+    // One timer per interface; the latest computed wake time replaces it
+    auto it = release_timer_of_.find(interface_name);
+    if (it != release_timer_of_.end()) {
+        release_timers_.cancel(it->second);
+        timer_interface_.erase(it->second);
+    }
+    
+    TimerWheel::TimerId id = release_timers_.schedule(wake_ns, 0);
+    release_timer_of_[interface_name] = id;
+    timer_interface_[id] = interface_name;
 }
 
-bool TrafficShapingManager::process_packet_internal(const PacketInfo& packet) {
+bool TrafficShapingManager::process_packet_internal(const PacketInfo& /*packet*/) {
     // Simplified implementation
     return true;
 }
@@ -0,0 +1,403 @@
+#pragma once
+
+// In-memory stand-in for the subset of clickhouse-cpp the analytics client
+// uses, for tests and benchmarks that run without a server. Class names and
+// signatures follow clickhouse-cpp so the same sources build against either.
+//
+// Insert() serializes the block the way the native protocol lays columns
+// out on the wire (fixed-width arrays, length-prefixed strings, dictionary
+// plus indexes for LowCardinality), so the cost of an insert scales with
+// its real encoding. What happens to it afterwards is up to MockServer.
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace clickhouse {
+
+class Column;
+using ColumnRef = std::shared_ptr<Column>;
+
+class Type {
+public:
+    explicit Type(std::string name) : name_(std::move(name)) {}
+    const std::string& GetName() const { return name_; }
+
+private:
+    std::string name_;
+};
+
+using TypeRef = std::shared_ptr<Type>;
+
+class Column : public std::enable_shared_from_this<Column> {
+public:
+    explicit Column(TypeRef type) : type_(std::move(type)) {}
+    virtual ~Column() = default;
+
+    // Appends the rows of a column of the same type
+    virtual void Append(ColumnRef column) = 0;
+    virtual size_t Size() const = 0;
+    virtual void Clear() = 0;
+    virtual void SaveBody(std::string& wire) const = 0;
+
+    TypeRef Type() const { return type_; }
+
+    template <typename T>
+    std::shared_ptr<T> As() {
+        return std::dynamic_pointer_cast<T>(shared_from_this());
+    }
+
+protected:
+    TypeRef type_;
+};
+
+template <typename T> struct TypeName;
+template <> struct TypeName<uint8_t> { static const char* get() { return "UInt8"; } };
+template <> struct TypeName<uint16_t> { static const char* get() { return "UInt16"; } };
+template <> struct TypeName<uint32_t> { static const char* get() { return "UInt32"; } };
+template <> struct TypeName<uint64_t> { static const char* get() { return "UInt64"; } };
+template <> struct TypeName<double> { static const char* get() { return "Float64"; } };
+
+template <typename T>
+class ColumnVector : public Column {
+public:
+    using ValueType = T;
+
+    ColumnVector() : Column(std::make_shared<clickhouse::Type>(TypeName<T>::get())) {}
+
+    void Append(const T& value) { data_.push_back(value); }
+    void Reserve(size_t rows) { data_.reserve(rows); }
+    const T& At(size_t n) const { return data_.at(n); }
+    const T& operator[](size_t n) const { return data_[n]; }
+
+    void Append(ColumnRef column) override {
+        if (auto other = column->As<ColumnVector>()) {
+            data_.insert(data_.end(), other->data_.begin(), other->data_.end());
+        }
+    }
+    size_t Size() const override { return data_.size(); }
+    void Clear() override { data_.clear(); }
+    void SaveBody(std::string& wire) const override {
+        wire.append(reinterpret_cast<const char*>(data_.data()), data_.size() * sizeof(T));
+    }
+
+private:
+    std::vector<T> data_;
+};
+
+using ColumnUInt8 = ColumnVector<uint8_t>;
+using ColumnUInt16 = ColumnVector<uint16_t>;
+using ColumnUInt32 = ColumnVector<uint32_t>;
+using ColumnUInt64 = ColumnVector<uint64_t>;
+using ColumnFloat64 = ColumnVector<double>;
+
+inline void save_varint(std::string& wire, uint64_t value) {
+    while (value >= 0x80) {
+        wire.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    wire.push_back(static_cast<char>(value));
+}
+
+class ColumnString : public Column {
+public:
+    using ValueType = std::string_view;
+
+    ColumnString() : Column(std::make_shared<clickhouse::Type>("String")) {}
+
+    void Append(std::string_view value) {
+        data_.append(value.data(), value.size());
+        ends_.push_back(data_.size());
+    }
+    std::string_view At(size_t n) const {
+        size_t begin = n == 0 ? 0 : ends_.at(n - 1);
+        return std::string_view(data_).substr(begin, ends_.at(n) - begin);
+    }
+    std::string_view operator[](size_t n) const { return At(n); }
+
+    void Append(ColumnRef column) override {
+        if (auto other = column->As<ColumnString>()) {
+            for (size_t i = 0; i < other->Size(); ++i) {
+                Append(other->At(i));
+            }
+        }
+    }
+    size_t Size() const override { return ends_.size(); }
+    void Clear() override {
+        data_.clear();
+        ends_.clear();
+    }
+    void SaveBody(std::string& wire) const override {
+        for (size_t i = 0; i < ends_.size(); ++i) {
+            std::string_view value = At(i);
+            save_varint(wire, value.size());
+            wire.append(value.data(), value.size());
+        }
+    }
+
+private:
+    std::string data_;
+    std::vector<size_t> ends_;
+};
+
+template <typename Nested>
+class ColumnLowCardinalityT : public Column {
+public:
+    using ValueType = typename Nested::ValueType;
+
+    ColumnLowCardinalityT()
+        : Column(std::make_shared<clickhouse::Type>("LowCardinality(" + Nested().Type()->GetName() + ")")) {}
+
+    void Append(const ValueType& value) {
+        auto entry = index_.find(std::string(value));
+        if (entry == index_.end()) {
+            entry = index_.emplace(std::string(value), static_cast<uint32_t>(dictionary_.Size())).first;
+            dictionary_.Append(value);
+        }
+        keys_.push_back(entry->second);
+    }
+    ValueType At(size_t n) const { return dictionary_.At(keys_.at(n)); }
+    ValueType operator[](size_t n) const { return At(n); }
+    size_t GetDictionarySize() const { return dictionary_.Size(); }
+
+    void Append(ColumnRef column) override {
+        if (auto other = column->As<ColumnLowCardinalityT>()) {
+            for (size_t i = 0; i < other->Size(); ++i) {
+                Append(other->At(i));
+            }
+        }
+    }
+    size_t Size() const override { return keys_.size(); }
+    void Clear() override {
+        dictionary_.Clear();
+        index_.clear();
+        keys_.clear();
+    }
+    void SaveBody(std::string& wire) const override {
+        dictionary_.SaveBody(wire);
+        wire.append(reinterpret_cast<const char*>(keys_.data()), keys_.size() * sizeof(uint32_t));
+    }
+
+private:
+    Nested dictionary_;
+    std::unordered_map<std::string, uint32_t> index_;
+    std::vector<uint32_t> keys_;
+};
+
+template <typename Nested>
+class ColumnArrayT : public Column {
+public:
+    ColumnArrayT()
+        : Column(std::make_shared<clickhouse::Type>("Array(" + Nested().Type()->GetName() + ")")),
+          data_(std::make_shared<Nested>()) {}
+
+    template <typename Container>
+    void Append(const Container& values) {
+        for (const auto& value : values) {
+            data_->Append(value);
+        }
+        offsets_.push_back(data_->Size());
+    }
+    size_t GetSize(size_t n) const { return offsets_.at(n) - (n == 0 ? 0 : offsets_.at(n - 1)); }
+    const Nested& GetData() const { return *data_; }
+    // clickhouse-cpp returns a view; iterating it is all callers do
+    std::vector<typename Nested::ValueType> At(size_t n) const {
+        std::vector<typename Nested::ValueType> values;
+        for (size_t i = offsets_.at(n) - GetSize(n); i < offsets_.at(n); ++i) {
+            values.push_back(data_->At(i));
+        }
+        return values;
+    }
+
+    void Append(ColumnRef column) override {
+        if (auto other = column->As<ColumnArrayT>()) {
+            for (size_t i = 0; i < other->Size(); ++i) {
+                Append(other->At(i));
+            }
+        }
+    }
+    size_t Size() const override { return offsets_.size(); }
+    void Clear() override {
+        data_->Clear();
+        offsets_.clear();
+    }
+    void SaveBody(std::string& wire) const override {
+        wire.append(reinterpret_cast<const char*>(offsets_.data()), offsets_.size() * sizeof(uint64_t));
+        data_->SaveBody(wire);
+    }
+
+private:
+    std::shared_ptr<Nested> data_;
+    std::vector<uint64_t> offsets_;
+};
+
+template <typename Key, typename Value>
+class ColumnMapT : public Column {
+public:
+    ColumnMapT(std::shared_ptr<Key> keys, std::shared_ptr<Value> values)
+        : Column(std::make_shared<clickhouse::Type>("Map(" + keys->Type()->GetName() + ", " +
+                                                    values->Type()->GetName() + ")")),
+          keys_(std::move(keys)), values_(std::move(values)) {}
+
+    template <typename Container>
+    void Append(const Container& entries) {
+        for (const auto& entry : entries) {
+            keys_->Append(entry.first);
+            values_->Append(entry.second);
+        }
+        offsets_.push_back(keys_->Size());
+    }
+    size_t GetSize(size_t n) const { return offsets_.at(n) - (n == 0 ? 0 : offsets_.at(n - 1)); }
+    std::vector<std::pair<typename Key::ValueType, typename Value::ValueType>> At(size_t n) const {
+        std::vector<std::pair<typename Key::ValueType, typename Value::ValueType>> entries;
+        for (size_t i = offsets_.at(n) - GetSize(n); i < offsets_.at(n); ++i) {
+            entries.emplace_back(keys_->At(i), values_->At(i));
+        }
+        return entries;
+    }
+
+    void Append(ColumnRef column) override {
+        if (auto other = column->As<ColumnMapT>()) {
+            for (size_t i = 0; i < other->Size(); ++i) {
+                Append(other->At(i));
+            }
+        }
+    }
+    size_t Size() const override { return offsets_.size(); }
+    void Clear() override {
+        keys_->Clear();
+        values_->Clear();
+        offsets_.clear();
+    }
+    void SaveBody(std::string& wire) const override {
+        wire.append(reinterpret_cast<const char*>(offsets_.data()), offsets_.size() * sizeof(uint64_t));
+        keys_->SaveBody(wire);
+        values_->SaveBody(wire);
+    }
+
+private:
+    std::shared_ptr<Key> keys_;
+    std::shared_ptr<Value> values_;
+    std::vector<uint64_t> offsets_;
+};
+
+class Block {
+public:
+    void AppendColumn(const std::string& name, const ColumnRef& column) {
+        if (!columns_.empty() && column->Size() != rows_) {
+            throw std::runtime_error("all columns in block must have same count of rows");
+        }
+        columns_.emplace_back(name, column);
+        rows_ = column->Size();
+    }
+
+    size_t GetColumnCount() const { return columns_.size(); }
+    size_t GetRowCount() const { return rows_; }
+    const std::string& GetColumnName(size_t n) const { return columns_.at(n).first; }
+    ColumnRef operator[](size_t n) const { return columns_.at(n).second; }
+
+    size_t RefreshRowCount() {
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            if (i > 0 && columns_[i].second->Size() != columns_[0].second->Size()) {
+                throw std::runtime_error("all columns in block must have same count of rows");
+            }
+        }
+        rows_ = columns_.empty() ? 0 : columns_[0].second->Size();
+        return rows_;
+    }
+
+private:
+    std::vector<std::pair<std::string, ColumnRef>> columns_;
+    size_t rows_ = 0;
+};
+
+struct ClientOptions {
+    std::string host;
+    unsigned int port = 9000;
+    std::string user;
+    std::string password;
+    std::string default_database;
+
+    ClientOptions& SetHost(const std::string& value) { host = value; return *this; }
+    ClientOptions& SetPort(unsigned int value) { port = value; return *this; }
+    ClientOptions& SetUser(const std::string& value) { user = value; return *this; }
+    ClientOptions& SetPassword(const std::string& value) { password = value; return *this; }
+    ClientOptions& SetDefaultDatabase(const std::string& value) { default_database = value; return *this; }
+};
+
+// What every Client talks to: counters, and hooks for tests to inspect or
+// fail inserts and to answer selects
+class MockServer {
+public:
+    static MockServer& instance() {
+        static MockServer server;
+        return server;
+    }
+
+    std::function<void(const std::string& table, const Block& block)> on_insert;
+    std::function<void(const std::string& query, const std::function<void(const Block&)>& reply)> on_select;
+    bool refuse_connections = false;
+
+    uint64_t inserts = 0;
+    uint64_t rows = 0;
+    uint64_t wire_bytes = 0;
+    std::vector<std::string> executed;
+
+    void reset() { *this = MockServer(); }
+
+private:
+    MockServer() = default;
+};
+
+class Client {
+public:
+    explicit Client(const ClientOptions& options) : options_(options) {
+        if (MockServer::instance().refuse_connections) {
+            throw std::runtime_error("connection refused");
+        }
+    }
+
+    void Execute(const std::string& query) { MockServer::instance().executed.push_back(query); }
+
+    void Insert(const std::string& table, const Block& block) {
+        MockServer& server = MockServer::instance();
+        wire_.clear();
+        for (size_t i = 0; i < block.GetColumnCount(); ++i) {
+            const ColumnRef& column = block[i];
+            if (column->Size() != block.GetRowCount()) {
+                throw std::runtime_error("all columns in block must have same count of rows");
+            }
+            save_varint(wire_, block.GetColumnName(i).size());
+            wire_ += block.GetColumnName(i);
+            wire_ += column->Type()->GetName();
+            column->SaveBody(wire_);
+        }
+        if (server.on_insert) {
+            server.on_insert(table, block);
+        }
+        server.inserts++;
+        server.rows += block.GetRowCount();
+        server.wire_bytes += wire_.size();
+    }
+
+    void Select(const std::string& query, std::function<void(const Block&)> callback) {
+        MockServer& server = MockServer::instance();
+        if (server.on_select) {
+            server.on_select(query, callback);
+        }
+    }
+
+private:
+    ClientOptions options_;
+    std::string wire_;
+};
+
+} // namespace clickhouse
@@ -0,0 +1,314 @@
+#pragma once
+
+// Stand-in for the kernel's rtnetlink, for tests and benchmarks that
+// program netem without root. It parses and builds the wire format itself
+// rather than sharing NetemNetlinkBackend's helpers, so an encoding bug on
+// one side is not mirrored on the other.
+
+#include "netem/netlink.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <linux/gen_stats.h>
+#include <linux/netlink.h>
+#include <linux/pkt_sched.h>
+#include <linux/rtnetlink.h>
+#include <map>
+#include <string>
+#include <sys/socket.h>
+#include <utility>
+#include <vector>
+
+namespace RouterSim {
+
+// Answers rtnetlink link and qdisc requests from an in-memory table. Like
+// the kernel it acknowledges every message of a batch in its own reply and
+// splits dumps across datagrams. Interfaces get ifindex 1, 2, ... in the
+// order given.
+class MockNetlinkSocket : public NetlinkSocket {
+public:
+    static constexpr size_t DUMP_DATAGRAM_BYTES = 16 * 1024;
+    static constexpr uint32_t HANDLE = 0x80010000;    // "8001:", as the kernel picks for handle 0
+
+    explicit MockNetlinkSocket(const std::vector<std::string>& interfaces)
+        : datagrams_received_(0), messages_received_(0) {
+        for (const auto& name : interfaces) {
+            Interface interface;
+            interface.name = name;
+            interfaces_.push_back(interface);
+        }
+    }
+
+    bool send(const std::vector<uint8_t>& datagram) override {
+        datagrams_received_++;
+        size_t offset = 0;
+        while (offset + sizeof(nlmsghdr) <= datagram.size()) {
+            nlmsghdr header;
+            std::memcpy(&header, datagram.data() + offset, sizeof(header));
+            if (header.nlmsg_len < NLMSG_HDRLEN || offset + header.nlmsg_len > datagram.size()) {
+                break;
+            }
+            messages_received_++;
+            handle_message(datagram.data() + offset, header.nlmsg_len);
+            offset += NLMSG_ALIGN(header.nlmsg_len);
+        }
+        return true;
+    }
+
+    bool receive(std::vector<uint8_t>& datagram) override {
+        // The kernel would block here; the mock has nothing more to say
+        if (replies_.empty()) {
+            return false;
+        }
+        datagram = std::move(replies_.front());
+        replies_.pop_front();
+        return true;
+    }
+
+    // Makes every qdisc change on the interface fail with -error
+    void fail_interface(const std::string& interface, int error) {
+        for (auto& entry : interfaces_) {
+            if (entry.name == interface) {
+                entry.error = error;
+            }
+        }
+    }
+
+    uint64_t datagrams_received() const { return datagrams_received_; }
+    uint64_t messages_received() const { return messages_received_; }
+
+    size_t netem_qdisc_count() const {
+        return std::count_if(interfaces_.begin(), interfaces_.end(),
+                             [](const Interface& interface) { return interface.kind == "netem"; });
+    }
+
+private:
+    struct Interface {
+        std::string name;
+        std::string kind = "noqueue";
+        std::vector<uint8_t> options;
+        uint32_t handle = 0;
+        int error = 0;
+    };
+
+    std::vector<Interface> interfaces_;
+    std::deque<std::vector<uint8_t>> replies_;
+    uint64_t datagrams_received_;
+    uint64_t messages_received_;
+
+    // Appends to a datagram, keeping netlink's 4-byte alignment
+    static void append(std::vector<uint8_t>& out, const void* data, size_t length) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        out.insert(out.end(), bytes, bytes + length);
+        out.resize(NLMSG_ALIGN(out.size()), 0);
+    }
+
+    static size_t begin_message(std::vector<uint8_t>& out, uint16_t type, uint16_t flags, uint32_t sequence) {
+        size_t start = out.size();
+        nlmsghdr header{};
+        header.nlmsg_type = type;
+        header.nlmsg_flags = flags;
+        header.nlmsg_seq = sequence;
+        append(out, &header, sizeof(header));
+        return start;
+    }
+
+    static void end_message(std::vector<uint8_t>& out, size_t start) {
+        uint32_t length = static_cast<uint32_t>(out.size() - start);
+        std::memcpy(out.data() + start, &length, sizeof(length));
+    }
+
+    static size_t attribute(std::vector<uint8_t>& out, uint16_t type, const void* data, size_t length) {
+        size_t start = out.size();
+        rtattr header{};
+        header.rta_type = type;
+        header.rta_len = static_cast<unsigned short>(RTA_LENGTH(length));
+        out.insert(out.end(), reinterpret_cast<const uint8_t*>(&header),
+                   reinterpret_cast<const uint8_t*>(&header) + sizeof(header));
+        append(out, data, length);
+        return start;
+    }
+
+    static void end_nested(std::vector<uint8_t>& out, size_t start) {
+        unsigned short length = static_cast<unsigned short>(out.size() - start);
+        std::memcpy(out.data() + start, &length, sizeof(length));
+    }
+
+    static void string_attribute(std::vector<uint8_t>& out, uint16_t type, const std::string& value) {
+        attribute(out, type, value.c_str(), value.size() + 1);
+    }
+
+    // Attribute type to (payload, length)
+    static std::map<uint16_t, std::pair<const uint8_t*, size_t>> parse_attributes(const uint8_t* data, size_t length) {
+        std::map<uint16_t, std::pair<const uint8_t*, size_t>> attributes;
+        while (length >= sizeof(rtattr)) {
+            rtattr header;
+            std::memcpy(&header, data, sizeof(header));
+            if (header.rta_len < sizeof(rtattr) || header.rta_len > length) {
+                break;
+            }
+            attributes[header.rta_type & NLA_TYPE_MASK] = {data + RTA_LENGTH(0), header.rta_len - RTA_LENGTH(0)};
+            size_t step = RTA_ALIGN(header.rta_len);
+            if (step >= length) {
+                break;
+            }
+            data += step;
+            length -= step;
+        }
+        return attributes;
+    }
+
+    void handle_message(const uint8_t* message, size_t length) {
+        nlmsghdr header;
+        std::memcpy(&header, message, sizeof(header));
+        const uint8_t* payload = message + NLMSG_HDRLEN;
+        size_t payload_length = length - NLMSG_HDRLEN;
+        bool dump = (header.nlmsg_flags & NLM_F_DUMP) == NLM_F_DUMP;
+
+        switch (header.nlmsg_type) {
+            case RTM_GETLINK:
+                dump ? dump_links(header.nlmsg_seq) : reply_error(message, -EOPNOTSUPP);
+                return;
+            case RTM_GETQDISC:
+                dump ? dump_qdiscs(header.nlmsg_seq) : reply_error(message, -EOPNOTSUPP);
+                return;
+            case RTM_NEWQDISC:
+            case RTM_DELQDISC:
+                break;
+            default:
+                reply_error(message, -EOPNOTSUPP);
+                return;
+        }
+
+        tcmsg tc;
+        if (payload_length < sizeof(tc)) {
+            reply_error(message, -EINVAL);
+            return;
+        }
+        std::memcpy(&tc, payload, sizeof(tc));
+        if (tc.tcm_ifindex <= 0 || static_cast<size_t>(tc.tcm_ifindex) > interfaces_.size()) {
+            reply_error(message, -ENODEV);
+            return;
+        }
+        if (tc.tcm_parent != TC_H_ROOT) {
+            reply_error(message, -EINVAL);
+            return;
+        }
+
+        Interface& interface = interfaces_[tc.tcm_ifindex - 1];
+        if (interface.error != 0) {
+            reply_error(message, -interface.error);
+            return;
+        }
+
+        if (header.nlmsg_type == RTM_DELQDISC) {
+            if (interface.kind != "netem") {
+                reply_error(message, -ENOENT);
+                return;
+            }
+            interface.kind = "noqueue";
+            interface.options.clear();
+            interface.handle = 0;
+        } else {
+            auto attributes = parse_attributes(payload + NLMSG_ALIGN(sizeof(tc)),
+                                               payload_length - NLMSG_ALIGN(sizeof(tc)));
+            auto kind = attributes.find(TCA_KIND);
+            auto options = attributes.find(TCA_OPTIONS);
+            ImpairmentInfo decoded;
+            if (kind == attributes.end() ||
+                std::string(reinterpret_cast<const char*>(kind->second.first),
+                            strnlen(reinterpret_cast<const char*>(kind->second.first), kind->second.second)) != "netem") {
+                reply_error(message, -ENOENT);
+                return;
+            }
+            if (options == attributes.end() ||
+                !NetemNetlinkBackend::decode_netem_options(options->second.first, options->second.second, decoded)) {
+                reply_error(message, -EINVAL);
+                return;
+            }
+            if (interface.kind == "netem" && !(header.nlmsg_flags & NLM_F_REPLACE)) {
+                reply_error(message, -EEXIST);
+                return;
+            }
+            interface.kind = "netem";
+            interface.options.assign(options->second.first, options->second.first + options->second.second);
+            interface.handle = HANDLE;
+        }
+
+        if (header.nlmsg_flags & NLM_F_ACK) {
+            reply_error(message, 0);
+        }
+    }
+
+    void reply_error(const uint8_t* request, int error) {
+        nlmsgerr body{};
+        body.error = error;
+        std::memcpy(&body.msg, request, sizeof(body.msg));
+
+        std::vector<uint8_t> reply;
+        size_t start = begin_message(reply, NLMSG_ERROR, NLM_F_CAPPED, body.msg.nlmsg_seq);
+        append(reply, &body, sizeof(body));
+        end_message(reply, start);
+        replies_.push_back(std::move(reply));
+    }
+
+    void end_dump(std::vector<uint8_t>& datagram, uint32_t sequence) {
+        int status = 0;
+        size_t start = begin_message(datagram, NLMSG_DONE, NLM_F_MULTI, sequence);
+        append(datagram, &status, sizeof(status));
+        end_message(datagram, start);
+        replies_.push_back(std::move(datagram));
+    }
+
+    void dump_links(uint32_t sequence) {
+        std::vector<uint8_t> datagram;
+        for (size_t i = 0; i < interfaces_.size(); ++i) {
+            if (datagram.size() >= DUMP_DATAGRAM_BYTES) {
+                replies_.push_back(std::move(datagram));
+                datagram.clear();
+            }
+            size_t start = begin_message(datagram, RTM_NEWLINK, NLM_F_MULTI, sequence);
+            ifinfomsg info{};
+            info.ifi_family = AF_UNSPEC;
+            info.ifi_index = static_cast<int>(i + 1);
+            append(datagram, &info, sizeof(info));
+            string_attribute(datagram, IFLA_IFNAME, interfaces_[i].name);
+            end_message(datagram, start);
+        }
+        end_dump(datagram, sequence);
+    }
+
+    void dump_qdiscs(uint32_t sequence) {
+        std::vector<uint8_t> datagram;
+        for (size_t i = 0; i < interfaces_.size(); ++i) {
+            if (datagram.size() >= DUMP_DATAGRAM_BYTES) {
+                replies_.push_back(std::move(datagram));
+                datagram.clear();
+            }
+            const Interface& interface = interfaces_[i];
+            size_t start = begin_message(datagram, RTM_NEWQDISC, NLM_F_MULTI, sequence);
+            tcmsg tc{};
+            tc.tcm_family = AF_UNSPEC;
+            tc.tcm_ifindex = static_cast<int>(i + 1);
+            tc.tcm_handle = interface.handle;
+            tc.tcm_parent = TC_H_ROOT;
+            append(datagram, &tc, sizeof(tc));
+            string_attribute(datagram, TCA_KIND, interface.kind);
+            if (!interface.options.empty()) {
+                attribute(datagram, TCA_OPTIONS, interface.options.data(), interface.options.size());
+            }
+            size_t stats = attribute(datagram, TCA_STATS2, nullptr, 0);
+            uint8_t basic[12] = {};
+            attribute(datagram, TCA_STATS_BASIC, basic, sizeof(basic));
+            gnet_stats_queue queue{};
+            attribute(datagram, TCA_STATS_QUEUE, &queue, sizeof(queue));
+            end_nested(datagram, stats);
+            end_message(datagram, start);
+        }
+        end_dump(datagram, sequence);
+    }
+};
+
+} // namespace RouterSim
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include "protocols/bgp_attributes.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace router_sim;
+using RouterSim::Ipv4Prefix;
+
+namespace {
+
+BGPPathAttributes make_attributes(uint32_t med) {
+    BGPPathAttributes attributes;
+    attributes.as_path = {65001, 65002, 65003};
+    attributes.next_hop = 0xc0000201;
+    attributes.has_med = true;
+    attributes.med = med;
+    attributes.communities = {(65001u << 16) | 100};
+    return attributes;
+}
+
+} // namespace
+
+TEST(BGPAttributeStoreTest, EqualAttributesShareOneSet) {
+    BGPAttributeStore store;
+    BGPAttributeRef a = store.intern(make_attributes(10));
+    BGPAttributeRef b = store.intern(make_attributes(10));
+    BGPAttributeRef c = store.intern(make_attributes(20));
+
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a.get(), b.get());
+    EXPECT_NE(a, c);
+    EXPECT_EQ(a->as_path, (std::vector<uint32_t>{65001, 65002, 65003}));
+    EXPECT_EQ(c->med, 20u);
+    EXPECT_EQ(a.use_count(), 2u);
+    EXPECT_EQ(store.size(), 2u);
+
+    auto stats = store.get_statistics();
+    EXPECT_EQ(stats.sets, 2u);
+    EXPECT_EQ(stats.lookups, 3u);
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_GT(stats.memory_bytes, 0u);
+}
+
+TEST(BGPAttributeStoreTest, AbsentMedDiffersFromZeroMed) {
+    BGPAttributeStore store;
+    BGPPathAttributes without = make_attributes(0);
+    without.has_med = false;
+    EXPECT_NE(store.intern(without), store.intern(make_attributes(0)));
+}
+
+TEST(BGPAttributeStoreTest, ParsedUpdateInternsToTheSameSet) {
+    BGPAttributeStore store;
+    BGPPathAttributes attributes = make_attributes(10);
+    BGPAttributeRef interned = store.intern(attributes);
+
+    BGPUpdateEncoder encoder;
+    std::vector<uint8_t> buffer;
+    Ipv4Prefix prefix(0x0a000000, 8);
+    ASSERT_EQ(encoder.encode_announcements(attributes, &prefix, 1, buffer), 1u);
+    BGPUpdate update;
+    ASSERT_TRUE(update.parse(buffer.data() + BGP_HEADER_SIZE, buffer.size() - BGP_HEADER_SIZE, true));
+
+    BGPAttributeRef parsed = store.intern(update, update.next_hop());
+    EXPECT_EQ(parsed, interned);
+    EXPECT_EQ(store.get_statistics().hits, 1u);
+
+    // A different next hop is a different set, built from the views
+    BGPAttributeRef other = store.intern(update, 0xc0000202);
+    EXPECT_NE(other, interned);
+    EXPECT_EQ(other->as_path, attributes.as_path);
+    EXPECT_EQ(other->communities, attributes.communities);
+    EXPECT_EQ(other->next_hop, 0xc0000202u);
+    EXPECT_EQ(hash_path_attributes(*other), other.hash());
+}
+
+TEST(BGPAttributeStoreTest, LastReferenceFreesTheSet) {
+    BGPAttributeStore store;
+    BGPAttributeRef a = store.intern(make_attributes(10));
+    {
+        BGPAttributeRef copy = a;
+        EXPECT_EQ(a.use_count(), 2u);
+    }
+    EXPECT_EQ(a.use_count(), 1u);
+    a.reset();
+    EXPECT_FALSE(a);
+    EXPECT_EQ(store.size(), 0u);
+
+    // Interned again as a new set
+    BGPAttributeRef b = store.intern(make_attributes(10));
+    EXPECT_EQ(b.use_count(), 1u);
+    EXPECT_EQ(store.get_statistics().hits, 0u);
+}
+
+TEST(BGPAttributeStoreTest, ReferencesOutliveTheStore) {
+    BGPAttributeRef kept;
+    {
+        BGPAttributeStore store;
+        kept = store.intern(make_attributes(10));
+    }
+    ASSERT_TRUE(kept);
+    EXPECT_EQ(kept->med, 10u);
+    kept.reset();
+}
+
+TEST(BGPAttributeStoreTest, ConcurrentInternAndRelease) {
+    BGPAttributeStore store;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&store] {
+            for (uint32_t i = 0; i < 20000; ++i) {
+                BGPAttributeRef ref = store.intern(make_attributes(i % 8));
+                BGPAttributeRef copy = ref;
+                EXPECT_EQ(copy->med, i % 8);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(store.size(), 0u);
+}
@@ -0,0 +1,268 @@
+#include <gtest/gtest.h>
+#include "protocols/bgp_rib.h"
+#include <vector>
+
+using namespace router_sim;
+using RouterSim::Ipv4Prefix;
+
+namespace {
+
+const uint32_t PEER_A = 0x0a000001;
+const uint32_t PEER_B = 0x0a000002;
+const uint32_t PEER_C = 0x0a000003;
+const Ipv4Prefix PREFIX(0xc6336400, 24);
+const Ipv4Prefix OTHER_PREFIX(0xcb007100, 24);
+
+class BGPRibTest : public ::testing::Test {
+protected:
+    BGPAttributeStore store;
+    BGPRib rib;
+
+    BGPAttributeRef path(std::vector<uint32_t> as_path, uint32_t med = 0) {
+        BGPPathAttributes attributes;
+        attributes.as_path = std::move(as_path);
+        attributes.next_hop = 0xc0000201;
+        attributes.has_med = true;
+        attributes.med = med;
+        return store.intern(attributes);
+    }
+
+    // The peer the Loc-RIB's best path to prefix comes from, after a decision run
+    uint32_t best_peer(const Ipv4Prefix& prefix = PREFIX) {
+        std::vector<BGPBestPathChange> changes;
+        rib.run_decisions(changes);
+        for (const auto& route : rib.loc_rib()) {
+            if (route.prefix.address == prefix.address && route.prefix.length == prefix.length) {
+                return route.path.peer;
+            }
+        }
+        return ~0u;
+    }
+};
+
+} // namespace
+
+TEST_F(BGPRibTest, DecisionProcessFollowsRfc4271) {
+    ASSERT_TRUE(rib.add_peer(PEER_A, 3, false));
+    ASSERT_TRUE(rib.add_peer(PEER_B, 2, false));
+    ASSERT_TRUE(rib.add_peer(PEER_C, 1, true));
+
+    // Shortest AS path
+    rib.update(PEER_A, PREFIX, path({65001, 65010}));
+    rib.update(PEER_B, PREFIX, path({65002, 65020, 65010}));
+    EXPECT_EQ(best_peer(), PEER_A);
+
+    // Equal length: eBGP over iBGP, then the lowest router ID
+    rib.update(PEER_C, PREFIX, path({65003, 65010}));
+    EXPECT_EQ(best_peer(), PEER_A);
+    rib.update(PEER_B, PREFIX, path({65002, 65010}));
+    EXPECT_EQ(best_peer(), PEER_B);
+
+    // MED decides between paths from the same neighboring AS only
+    rib.update(PEER_A, PREFIX, path({65002, 65010}, 5));
+    rib.update(PEER_B, PREFIX, path({65002, 65010}, 10));
+    EXPECT_EQ(best_peer(), PEER_A);
+    rib.update(PEER_A, PREFIX, path({65001, 65010}, 5));
+    EXPECT_EQ(best_peer(), PEER_B);
+
+    // LOCAL_PREF counts over iBGP, before anything else
+    BGPPathAttributes preferred = *path({65003, 65030, 65040, 65010});
+    preferred.has_local_pref = true;
+    preferred.local_pref = 200;
+    rib.update(PEER_C, PREFIX, store.intern(preferred));
+    EXPECT_EQ(best_peer(), PEER_C);
+
+    // Our own route wins
+    rib.update(BGPRib::LOCAL_PEER, PREFIX, path({}));
+    EXPECT_EQ(best_peer(), BGPRib::LOCAL_PEER);
+}
+
+TEST_F(BGPRibTest, AsSetCountsAsOneHop) {
+    ASSERT_TRUE(rib.add_peer(PEER_A, 1, false));
+    ASSERT_TRUE(rib.add_peer(PEER_B, 2, false));
+
+    // AS_SEQUENCE 65002 then AS_SET {65010, 65020, 65030}: four ASes, length two
+    const std::vector<uint8_t> body = {
+        0, 0, 0, 34,
+        0x40, 1, 1, 0,
+        0x40, 2, 20, 2, 1, 0, 0, 0xfd, 0xea, 1, 3, 0, 0, 0xfd, 0xf2, 0, 0, 0xfd, 0xfc, 0, 0, 0xfe, 0x06,
+        0x40, 3, 4, 0xc0, 0, 2, 1,
+        24, 0xc6, 0x33, 0x64};
+    BGPUpdate update;
+    ASSERT_TRUE(update.parse(body.data(), body.size(), true)) << update.error_reason();
+    BGPAttributeRef aggregated = store.intern(update, update.next_hop());
+    ASSERT_EQ(aggregated->as_path.size(), 4u);
+    EXPECT_EQ(aggregated.as_path_length(), 2u);
+
+    rib.update(PEER_A, PREFIX, path({65001, 65010, 65020}));
+    rib.update(PEER_B, PREFIX, aggregated);
+    EXPECT_EQ(best_peer(), PEER_B);
+
+    // The same ASes as a plain sequence count in full, so are a different set
+    BGPAttributeRef flat = path({65002, 65010, 65020, 65030});
+    EXPECT_NE(flat, aggregated);
+    EXPECT_EQ(flat.as_path_length(), 4u);
+    rib.update(PEER_B, PREFIX, flat);
+    EXPECT_EQ(best_peer(), PEER_A);
+}
+
+TEST_F(BGPRibTest, DecidesOnlyTouchedPrefixes) {
+    ASSERT_TRUE(rib.add_peer(PEER_A, 1, false));
+    for (uint32_t i = 0; i < 100; ++i) {
+        rib.update(PEER_A, Ipv4Prefix(0x0b000000 + (i << 8), 24), path({65001}));
+    }
+    std::vector<BGPBestPathChange> changes;
+    EXPECT_EQ(rib.run_decisions(changes), 100u);
+    EXPECT_EQ(rib.get_statistics().decisions, 100u);
+
+    // Re-announcing the same path touches nothing; a new one touches one prefix
+    rib.update(PEER_A, Ipv4Prefix(0x0b000000, 24), path({65001}));
+    rib.update(PEER_A, Ipv4Prefix(0x0b000100, 24), path({65001, 65002}));
+    changes.clear();
+    EXPECT_EQ(rib.run_decisions(changes), 1u);
+    EXPECT_EQ(rib.get_statistics().decisions, 101u);
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].prefix.address, 0x0b000100u);
+    EXPECT_EQ(changes[0].previous.attributes->as_path.size(), 1u);
+    EXPECT_EQ(changes[0].best.attributes->as_path.size(), 2u);
+}
+
+TEST_F(BGPRibTest, AdjRibOutSkipsIbgpToIbgp) {
+    ASSERT_TRUE(rib.add_peer(PEER_A, 1, false));
+    ASSERT_TRUE(rib.add_peer(PEER_B, 2, true));
+    ASSERT_TRUE(rib.add_peer(PEER_C, 3, true));
+    rib.update(PEER_A, PREFIX, path({65001}));
+    rib.update(PEER_B, OTHER_PREFIX, path({}));
+    std::vector<BGPBestPathChange> changes;
+    rib.run_decisions(changes);
+
+    // The group's UPDATEs are the same for every member, so PREFIX goes
+    // back to PEER_A too, which drops it on finding its own AS in the path
+    BGPRibOutUpdate update;
+    ASSERT_TRUE(rib.take_updates(rib.group_of(PEER_A), update));
+    EXPECT_EQ(update.peers, std::vector<uint32_t>{PEER_A});
+    ASSERT_EQ(update.announced.size(), 2u);
+
+    // iBGP-learned OTHER_PREFIX is not sent to the iBGP peers, PEER_B included
+    EXPECT_EQ(rib.group_of(PEER_B), rib.group_of(PEER_C));
+    ASSERT_TRUE(rib.take_updates(rib.group_of(PEER_C), update));
+    EXPECT_EQ(update.peers, (std::vector<uint32_t>{PEER_B, PEER_C}));
+    ASSERT_EQ(update.announced.size(), 1u);
+    ASSERT_EQ(update.announced[0].second.size(), 1u);
+    EXPECT_EQ(update.announced[0].second[0].address, PREFIX.address);
+    EXPECT_EQ(rib.adj_rib_out(PEER_C).size(), 1u);
+    EXPECT_FALSE(rib.take_updates(rib.group_of(PEER_C), update));
+}
+
+TEST_F(BGPRibTest, BatchesChangesPerPeer) {
+    ASSERT_TRUE(rib.add_peer(PEER_A, 1, false));
+    ASSERT_TRUE(rib.add_peer(PEER_B, 2, false));
+    BGPAttributeRef first = path({65001});
+    rib.update(PEER_A, PREFIX, first);
+    rib.update(PEER_A, OTHER_PREFIX, first);
+    std::vector<BGPBestPathChange> changes;
+    rib.run_decisions(changes);
+
+    // Both prefixes share an attribute set: one group
+    BGPRibOutUpdate update;
+    ASSERT_TRUE(rib.take_updates(rib.group_of(PEER_B), update));
+    ASSERT_EQ(update.announced.size(), 1u);
+    EXPECT_EQ(update.announced[0].second.size(), 2u);
+
+    // Changed and changed back before the peer is sent anything: nothing to send
+    rib.update(PEER_A, PREFIX, path({65001, 65009}));
+    rib.run_decisions(changes);
+    rib.update(PEER_A, PREFIX, first);
+    rib.run_decisions(changes);
+    EXPECT_FALSE(rib.take_updates(rib.group_of(PEER_B), update));
+
+    // Gone for good: a withdrawal
+    rib.withdraw(PEER_A, PREFIX);
+    rib.run_decisions(changes);
+    ASSERT_TRUE(rib.take_updates(rib.group_of(PEER_B), update));
+    ASSERT_EQ(update.withdrawn.size(), 1u);
+    EXPECT_EQ(update.withdrawn[0].address, PREFIX.address);
+    EXPECT_TRUE(update.announced.empty());
+}
+
+TEST_F(BGPRibTest, PeerDownFallsBackAndPeerUpGetsTheTable) {
+    ASSERT_TRUE(rib.add_peer(PEER_A, 1, false));
+    ASSERT_TRUE(rib.add_peer(PEER_B, 2, false));
+    rib.update(PEER_A, PREFIX, path({65001}));
+    rib.update(PEER_B, PREFIX, path({65002, 65003}));
+    rib.update(PEER_A, OTHER_PREFIX, path({65001}));
+    EXPECT_EQ(best_peer(), PEER_A);
+    uint64_t decisions = rib.get_statistics().decisions;
+
+    ASSERT_TRUE(rib.remove_peer(PEER_A));
+    std::vector<BGPBestPathChange> changes;
+    EXPECT_EQ(rib.run_decisions(changes), 2u);
+    EXPECT_EQ(rib.get_statistics().decisions, decisions + 2);
+    EXPECT_EQ(rib.loc_rib().size(), 1u);
+    EXPECT_EQ(rib.loc_rib()[0].path.peer, PEER_B);
+    EXPECT_EQ(rib.get_statistics().paths, 1u);
+    EXPECT_FALSE(rib.update(PEER_A, PREFIX, path({65001})));
+
+    ASSERT_TRUE(rib.add_peer(PEER_A, 1, false));
+    EXPECT_FALSE(rib.add_peer(PEER_A, 1, false));
+    BGPRibOutUpdate update;
+    ASSERT_TRUE(rib.take_updates(rib.group_of(PEER_A), update));
+    ASSERT_EQ(update.announced.size(), 1u);
+    EXPECT_EQ(update.announced[0].second[0].address, PREFIX.address);
+}
+
+TEST_F(BGPRibTest, PeersOfOnePolicyShareAnUpdateGroup) {
+    ASSERT_TRUE(rib.add_peer(PEER_A, 1, true));
+    ASSERT_TRUE(rib.add_peer(PEER_B, 2, true));
+    ASSERT_TRUE(rib.add_peer(PEER_C, 3, true, 1));
+    EXPECT_NE(rib.group_of(PEER_A), 0u);
+    EXPECT_EQ(rib.group_of(PEER_A), rib.group_of(PEER_B));
+    EXPECT_NE(rib.group_of(PEER_A), rib.group_of(PEER_C));
+    EXPECT_EQ(rib.group_of(BGPRib::LOCAL_PEER), 0u);
+    EXPECT_EQ(rib.get_statistics().update_groups, 2u);
+
+    rib.update(BGPRib::LOCAL_PEER, PREFIX, path({}));
+    std::vector<BGPBestPathChange> changes;
+    rib.run_decisions(changes);
+    BGPRibOutUpdate update;
+    ASSERT_TRUE(rib.take_updates(rib.group_of(PEER_A), update));
+    EXPECT_EQ(update.peers, (std::vector<uint32_t>{PEER_A, PEER_B}));
+    ASSERT_TRUE(rib.take_updates(rib.group_of(PEER_C), update));
+    EXPECT_EQ(update.peers, std::vector<uint32_t>{PEER_C});
+
+    // The last member going frees the group
+    ASSERT_TRUE(rib.remove_peer(PEER_C));
+    EXPECT_EQ(rib.get_statistics().update_groups, 1u);
+}
+
+TEST_F(BGPRibTest, LatePeerCatchesUpThenJoinsTheGroup) {
+    ASSERT_TRUE(rib.add_peer(PEER_A, 1, true));
+    rib.update(BGPRib::LOCAL_PEER, PREFIX, path({}));
+    std::vector<BGPBestPathChange> changes;
+    rib.run_decisions(changes);
+    BGPRibOutUpdate update;
+    uint32_t group = rib.group_of(PEER_A);
+    ASSERT_TRUE(rib.take_updates(group, update));
+
+    // The group has sent PREFIX already: PEER_B starts one of its own
+    ASSERT_TRUE(rib.add_peer(PEER_B, 2, true));
+    uint32_t late = rib.group_of(PEER_B);
+    EXPECT_NE(late, group);
+    rib.update(BGPRib::LOCAL_PEER, OTHER_PREFIX, path({}));
+    rib.run_decisions(changes);
+
+    ASSERT_TRUE(rib.take_updates(group, update));
+    EXPECT_EQ(update.announced[0].second.size(), 1u);
+    ASSERT_TRUE(rib.take_updates(late, update));
+    EXPECT_EQ(update.peers, std::vector<uint32_t>{PEER_B});
+    EXPECT_EQ(update.announced[0].second.size(), 2u);
+
+    // Both up to date: one group again, which both get the next change from
+    EXPECT_EQ(rib.group_of(PEER_B), group);
+    EXPECT_EQ(rib.update_groups(), std::vector<uint32_t>{group});
+    rib.withdraw(BGPRib::LOCAL_PEER, PREFIX);
+    rib.run_decisions(changes);
+    ASSERT_TRUE(rib.take_updates(group, update));
+    EXPECT_EQ(update.peers, (std::vector<uint32_t>{PEER_A, PEER_B}));
+    EXPECT_EQ(update.withdrawn.size(), 1u);
+}
@@ -0,0 +1,350 @@
+#include <gtest/gtest.h>
+#include "protocols/bgp.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+using namespace router_sim;
+
+namespace {
+
+template <typename Predicate>
+bool wait_for(Predicate predicate) {
+    for (int i = 0; i < 5000 && !predicate(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return predicate();
+}
+
+std::map<std::string, std::string> speaker_config(const std::string& local_as, const std::string& router_id) {
+    return {{"local_as", local_as}, {"router_id", router_id}, {"listen_address", "127.0.0.1"},
+            {"listen_port", "0"}, {"connect_retry_time", "1"}};
+}
+
+bool has_route(const BGPProtocol& bgp, const std::string& key) {
+    auto routes = bgp.get_learned_routes();
+    return std::find(routes.begin(), routes.end(), key) != routes.end();
+}
+
+// A hand-driven peer on a blocking socket, connecting from source
+class RawPeer {
+public:
+    explicit RawPeer(uint16_t port, const char* source = "127.0.0.1") {
+        fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        inet_pton(AF_INET, source, &address.sin_addr);
+        bind(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        address.sin_port = htons(port);
+        inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+        connected_ = ::connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+    }
+    ~RawPeer() { close(fd_); }
+
+    bool connected() const { return connected_; }
+
+    void send_message(uint8_t type, const std::vector<uint8_t>& body) {
+        std::vector<uint8_t> message(16, 0xff);
+        size_t length = BGP_HEADER_SIZE + body.size();
+        message.push_back(static_cast<uint8_t>(length >> 8));
+        message.push_back(static_cast<uint8_t>(length));
+        message.push_back(type);
+        message.insert(message.end(), body.begin(), body.end());
+        send_raw(message);
+    }
+
+    void send_raw(const std::vector<uint8_t>& bytes) {
+        ASSERT_EQ(write(fd_, bytes.data(), bytes.size()), ssize_t(bytes.size()));
+    }
+
+    // Up to Established: OPEN and KEEPALIVE both ways
+    void establish(uint16_t as) {
+        std::vector<uint8_t> body;
+        send_open(as, 90);
+        send_message(4, {});
+        ASSERT_EQ(read_message(body), 1);
+        ASSERT_EQ(read_message(body), 4);
+    }
+
+    void send_open(uint16_t as, uint16_t hold_time) {
+        send_message(1, {4, uint8_t(as >> 8), uint8_t(as), uint8_t(hold_time >> 8), uint8_t(hold_time), 9, 9, 9, 9,
+                         0});
+    }
+
+    // Type of the next message, its body in body; 0 on timeout or close
+    uint8_t read_message(std::vector<uint8_t>& body, int timeout_ms = 6000) {
+        uint8_t header[BGP_HEADER_SIZE];
+        if (!read_exactly(header, sizeof(header), timeout_ms)) {
+            return 0;
+        }
+        body.resize(((header[16] << 8) | header[17]) - BGP_HEADER_SIZE);
+        if (!body.empty() && !read_exactly(body.data(), body.size(), timeout_ms)) {
+            return 0;
+        }
+        return header[18];
+    }
+
+private:
+    int fd_;
+    bool connected_;
+
+    bool read_exactly(uint8_t* data, size_t length, int timeout_ms) {
+        while (length > 0) {
+            pollfd poll_fd{fd_, POLLIN, 0};
+            if (poll(&poll_fd, 1, timeout_ms) <= 0) {
+                return false;
+            }
+            ssize_t n = read(fd_, data, length);
+            if (n <= 0) {
+                return false;
+            }
+            data += n;
+            length -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+};
+
+// A listening socket on 127.0.0.1, as BGPProtocol would have
+int listen_on_loopback(uint16_t& port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+    bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    listen(fd, 4);
+    socklen_t length = sizeof(address);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+    port = ntohs(address.sin_port);
+    return fd;
+}
+
+BGPSessionConfig session_config(uint32_t local_as, uint32_t router_id, uint16_t peer_port, uint32_t peer_as) {
+    BGPSessionConfig config;
+    config.local_as = local_as;
+    config.router_id = router_id;
+    config.peer_address = "127.0.0.1";
+    config.peer_port = peer_port;
+    config.peer_as = peer_as;
+    config.connect_retry_time = 1;
+    return config;
+}
+
+} // namespace
+
+TEST(BGPSessionTest, SpeakersEstablishAndExchangeRoutes) {
+    BGPProtocol left, right;
+    ASSERT_TRUE(right.initialize(speaker_config("65002", "2.2.2.2")));
+    ASSERT_TRUE(right.add_neighbor("127.0.0.1", {{"remote_as", "65001"}, {"passive", "true"}}));
+    std::atomic<int> right_updates(0);
+    right.set_route_update_callback([&](const RouteInfo&, bool) { right_updates++; });
+    ASSERT_TRUE(right.start());
+    ASSERT_NE(right.get_listen_port(), 0);
+
+    ASSERT_TRUE(left.initialize(speaker_config("65001", "1.1.1.1")));
+    ASSERT_TRUE(left.add_neighbor("127.0.0.1",
+                                  {{"remote_as", "65002"}, {"port", std::to_string(right.get_listen_port())}}));
+    // Advertised before and after the session comes up
+    ASSERT_TRUE(left.advertise_route("10.1.0.0", 16, 50));
+    ASSERT_TRUE(left.start());
+
+    ASSERT_TRUE(wait_for([&] { return right.get_neighbor("127.0.0.1").state == "Established"; }));
+    ASSERT_TRUE(wait_for([&] { return left.get_neighbor("127.0.0.1").state == "Established"; }));
+    ASSERT_TRUE(wait_for([&] { return has_route(right, "10.1.0.0/16"); }));
+
+    auto routes = right.get_bgp_routes();
+    ASSERT_EQ(routes.size(), 1u);
+    EXPECT_EQ(routes[0].next_hop(), "1.1.1.1");
+    EXPECT_EQ(routes[0].metric(), 50u);
+    EXPECT_EQ(routes[0].as_path(), std::vector<uint32_t>{65001});
+    EXPECT_EQ(right.get_neighbor("127.0.0.1").capabilities["four_octet_as"], "true");
+
+    ASSERT_TRUE(left.advertise_route("10.2.3.0", 24, 7));
+    ASSERT_TRUE(wait_for([&] { return has_route(right, "10.2.3.0/24"); }));
+    ASSERT_TRUE(left.withdraw_route("10.1.0.0", 16));
+    ASSERT_TRUE(wait_for([&] { return !has_route(right, "10.1.0.0/16"); }));
+    EXPECT_EQ(right_updates.load(), 3);
+
+    // A Cease takes the session and what was learned over it down
+    left.stop();
+    ASSERT_TRUE(wait_for([&] { return right.get_neighbor("127.0.0.1").state == "Active"; }));
+    EXPECT_TRUE(right.get_learned_routes().empty());
+    EXPECT_EQ(right.get_neighbor("127.0.0.1").last_error, "NOTIFICATION 6/2");
+    EXPECT_EQ(right.get_statistics().neighbor_down_count, 1u);
+}
+
+TEST(BGPSessionTest, HoldTimerExpiresOnSilentPeer) {
+    BGPProtocol bgp;
+    ASSERT_TRUE(bgp.initialize(speaker_config("65002", "2.2.2.2")));
+    ASSERT_TRUE(bgp.add_neighbor("127.0.0.1", {{"passive", "true"}, {"hold_time", "3"}}));
+    ASSERT_TRUE(bgp.start());
+
+    RawPeer peer(bgp.get_listen_port());
+    ASSERT_TRUE(peer.connected());
+    peer.send_open(65001, 90);
+    peer.send_message(4, {});
+
+    std::vector<uint8_t> body;
+    ASSERT_EQ(peer.read_message(body), 1);          // OPEN
+    EXPECT_EQ((body[3] << 8) | body[4], 3);
+    ASSERT_EQ(peer.read_message(body), 4);          // KEEPALIVE
+    ASSERT_TRUE(wait_for([&] { return bgp.get_neighbor("127.0.0.1").state == "Established"; }));
+
+    // Keepalives every hold_time / 3 or sooner, then the NOTIFICATION once nothing came back
+    auto start = std::chrono::steady_clock::now();
+    uint8_t type;
+    int keepalives = 0;
+    while ((type = peer.read_message(body)) == 4) {
+        keepalives++;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_EQ(type, 3);
+    EXPECT_EQ(body[0], 4);                          // Hold Timer Expired
+    EXPECT_GE(keepalives, 2);
+    EXPECT_GE(elapsed, std::chrono::milliseconds(2900));
+    EXPECT_LT(elapsed, std::chrono::milliseconds(4500));
+    // The NOTIFICATION goes out before the session falls back
+    EXPECT_TRUE(wait_for([&] { return bgp.get_neighbor("127.0.0.1").last_error == "hold timer expired"; }));
+}
+
+TEST(BGPSessionTest, RejectsWrongPeerAsAndMalformedUpdates) {
+    BGPProtocol bgp;
+    ASSERT_TRUE(bgp.initialize(speaker_config("65002", "2.2.2.2")));
+    ASSERT_TRUE(bgp.add_neighbor("127.0.0.1", {{"remote_as", "65001"}, {"passive", "true"}}));
+    ASSERT_TRUE(bgp.start());
+    std::vector<uint8_t> body;
+
+    {
+        RawPeer peer(bgp.get_listen_port());
+        peer.send_open(65009, 90);
+        ASSERT_EQ(peer.read_message(body), 1);
+        ASSERT_EQ(peer.read_message(body), 3);
+        EXPECT_EQ(body[0], 2);                      // OPEN Message Error
+        EXPECT_EQ(body[1], 2);                      // Bad Peer AS
+        EXPECT_EQ(peer.read_message(body, 1000), 0);
+    }
+    ASSERT_TRUE(wait_for([&] { return bgp.get_neighbor("127.0.0.1").state == "Active"; }));
+
+    {
+        RawPeer peer(bgp.get_listen_port());
+        peer.send_open(65001, 90);
+        peer.send_message(4, {});
+        ASSERT_EQ(peer.read_message(body), 1);
+        ASSERT_EQ(peer.read_message(body), 4);
+        // One NLRI but no NEXT_HOP
+        peer.send_message(2, {0, 0, 0, 0, 8, 10});
+        ASSERT_EQ(peer.read_message(body), 3);
+        EXPECT_EQ(body[0], 3);                      // UPDATE Message Error
+    }
+    EXPECT_TRUE(bgp.get_learned_routes().empty());
+    EXPECT_TRUE(wait_for([&] { return bgp.get_neighbor("127.0.0.1").last_error == "malformed UPDATE"; }));
+}
+
+TEST(BGPSessionTest, UpdateGroupMembersAreSentTheSameUpdates) {
+    BGPProtocol bgp;
+    ASSERT_TRUE(bgp.initialize(speaker_config("65002", "2.2.2.2")));
+    ASSERT_TRUE(bgp.add_neighbor("127.0.0.2", {{"remote_as", "65002"}, {"passive", "true"}}));
+    ASSERT_TRUE(bgp.add_neighbor("127.0.0.3", {{"remote_as", "65002"}, {"passive", "true"}}));
+    ASSERT_TRUE(bgp.advertise_route("10.1.0.0", 16, 50));
+    ASSERT_TRUE(bgp.start());
+
+    RawPeer first(bgp.get_listen_port(), "127.0.0.2");
+    RawPeer second(bgp.get_listen_port(), "127.0.0.3");
+    first.establish(65002);
+    second.establish(65002);
+    std::vector<uint8_t> first_body, second_body;
+    ASSERT_EQ(first.read_message(first_body), 2);
+    ASSERT_EQ(second.read_message(second_body), 2);
+    EXPECT_EQ(first_body, second_body);
+
+    // Whichever came up later caught up on its own; now they are one group
+    ASSERT_TRUE(wait_for([&] { return bgp.get_rib_statistics().update_groups == 1; }));
+    ASSERT_TRUE(bgp.advertise_route("10.2.0.0", 16, 50));
+    ASSERT_EQ(first.read_message(first_body), 2);
+    ASSERT_EQ(second.read_message(second_body), 2);
+    EXPECT_EQ(first_body, second_body);
+    ASSERT_GE(first_body.size(), 3u);
+    EXPECT_EQ(std::vector<uint8_t>(first_body.end() - 3, first_body.end()), (std::vector<uint8_t>{16, 10, 2}));
+}
+
+TEST(BGPSessionTest, PathsThroughOurAsAreNotLearned) {
+    BGPProtocol bgp;
+    ASSERT_TRUE(bgp.initialize(speaker_config("65002", "2.2.2.2")));
+    ASSERT_TRUE(bgp.add_neighbor("127.0.0.1", {{"remote_as", "65001"}, {"passive", "true"}}));
+    ASSERT_TRUE(bgp.start());
+    RawPeer peer(bgp.get_listen_port());
+    peer.establish(65001);
+
+    BGPUpdateEncoder encoder;
+    encoder.set_four_octet_as(false);
+    BGPPathAttributes attributes;
+    attributes.next_hop = 0x7f000001;
+    std::vector<uint8_t> messages;
+    RouterSim::Ipv4Prefix looped(0x0a010000, 16);
+    RouterSim::Ipv4Prefix clean(0x0a020000, 16);
+    attributes.as_path = {65001, 65002, 65003};
+    encoder.encode_announcements(attributes, &looped, 1, messages);
+    attributes.as_path = {65001, 65003};
+    encoder.encode_announcements(attributes, &clean, 1, messages);
+    peer.send_raw(messages);
+
+    ASSERT_TRUE(wait_for([&] { return has_route(bgp, "10.2.0.0/16"); }));
+    EXPECT_FALSE(has_route(bgp, "10.1.0.0/16"));
+
+    // Re-announced through our AS: gone, as if withdrawn
+    messages.clear();
+    attributes.as_path = {65001, 65002};
+    encoder.encode_announcements(attributes, &clean, 1, messages);
+    peer.send_raw(messages);
+    ASSERT_TRUE(wait_for([&] { return !has_route(bgp, "10.2.0.0/16"); }));
+}
+
+TEST(BGPSessionTest, SimultaneousConnectsSettleOnOneConnection) {
+    uint16_t left_port = 0, right_port = 0;
+    int left_listener = listen_on_loopback(left_port);
+    int right_listener = listen_on_loopback(right_port);
+    RouterSim::EventLoop left_loop, right_loop;
+    BGPSession left(left_loop, session_config(65001, 0x01010101, right_port, 65002), nullptr, nullptr);
+    BGPSession right(right_loop, session_config(65002, 0x02020202, left_port, 65001), nullptr, nullptr);
+
+    // Both dial out, and each is handed the other's connection before
+    // either has seen an OPEN
+    left.start();
+    right.start();
+    EXPECT_TRUE(left.accept(accept4(left_listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)));
+    EXPECT_TRUE(right.accept(accept4(right_listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)));
+
+    auto run = [&](int iterations) {
+        for (int i = 0; i < iterations; ++i) {
+            left_loop.run_once(1);
+            right_loop.run_once(1);
+        }
+    };
+    for (int i = 0; i < 2000 && (left.state() != BGPState::ESTABLISHED || right.state() != BGPState::ESTABLISHED);
+         ++i) {
+        run(1);
+    }
+    ASSERT_EQ(left.state(), BGPState::ESTABLISHED);
+    ASSERT_EQ(right.state(), BGPState::ESTABLISHED);
+
+    // Both kept right's connection, and it stays up
+    run(100);
+    EXPECT_EQ(left.state(), BGPState::ESTABLISHED);
+    EXPECT_EQ(right.state(), BGPState::ESTABLISHED);
+    EXPECT_EQ(left.get_statistics().established_transitions, 1u);
+    EXPECT_EQ(right.get_statistics().established_transitions, 1u);
+    EXPECT_EQ(left.get_statistics().collisions_resolved, 1u);
+    EXPECT_EQ(right.get_statistics().collisions_resolved, 1u);
+    EXPECT_EQ(left.peer_router_id(), 0x02020202u);
+    EXPECT_EQ(right.peer_router_id(), 0x01010101u);
+
+    left.stop();
+    right.stop();
+    close(left_listener);
+    close(right_listener);
+}
@@ -0,0 +1,297 @@
+#include <gtest/gtest.h>
+#include "protocols/bgp_update.h"
+#include <algorithm>
+#include <vector>
+
+using namespace router_sim;
+using RouterSim::Ipv4Prefix;
+
+namespace {
+
+// Bodies of the framed messages in buffer
+std::vector<std::vector<uint8_t>> split_messages(const std::vector<uint8_t>& buffer) {
+    std::vector<std::vector<uint8_t>> bodies;
+    size_t offset = 0;
+    while (offset + BGP_HEADER_SIZE <= buffer.size()) {
+        size_t length = (buffer[offset + 16] << 8) | buffer[offset + 17];
+        EXPECT_EQ(buffer[offset + 18], static_cast<uint8_t>(BGPMessageType::UPDATE));
+        EXPECT_LE(length, BGP_MAX_MESSAGE_SIZE);
+        bodies.emplace_back(buffer.begin() + offset + BGP_HEADER_SIZE, buffer.begin() + offset + length);
+        offset += length;
+    }
+    EXPECT_EQ(offset, buffer.size());
+    return bodies;
+}
+
+std::vector<std::pair<uint32_t, uint8_t>> prefixes_of(const BGPPrefixRange& range) {
+    std::vector<std::pair<uint32_t, uint8_t>> prefixes;
+    for (BGPPrefix prefix : range) {
+        prefixes.emplace_back(prefix.ipv4(), prefix.length);
+    }
+    return prefixes;
+}
+
+// Withdrawn length 0, the given attributes, then the NLRI
+std::vector<uint8_t> update_body(const std::vector<uint8_t>& attributes, const std::vector<uint8_t>& nlri = {}) {
+    std::vector<uint8_t> body(4 + attributes.size());
+    body[2] = static_cast<uint8_t>(attributes.size() >> 8);
+    body[3] = static_cast<uint8_t>(attributes.size());
+    std::copy(attributes.begin(), attributes.end(), body.begin() + 4);
+    body.insert(body.end(), nlri.begin(), nlri.end());
+    return body;
+}
+
+const std::vector<uint8_t> ORIGIN_IGP = {0x40, 1, 1, 0};
+const std::vector<uint8_t> AS_PATH_65001 = {0x40, 2, 6, 2, 1, 0, 0, 0xfd, 0xe9};
+const std::vector<uint8_t> NEXT_HOP = {0x40, 3, 4, 192, 0, 2, 1};
+
+std::vector<uint8_t> concat(std::initializer_list<std::vector<uint8_t>> parts) {
+    std::vector<uint8_t> out;
+    for (const auto& part : parts) {
+        out.insert(out.end(), part.begin(), part.end());
+    }
+    return out;
+}
+
+} // namespace
+
+TEST(BGPUpdateTest, RoundTripsAnnouncementWithEveryAttribute) {
+    BGPPathAttributes attributes;
+    attributes.origin = BGP_ORIGIN_EGP;
+    attributes.as_path = {65001, 4200000000u, 65003};
+    attributes.next_hop = 0xc0000201;
+    attributes.has_med = true;
+    attributes.med = 50;
+    attributes.has_local_pref = true;
+    attributes.local_pref = 200;
+    attributes.communities = {(65001u << 16) | 100, 0xffffff01};
+    std::vector<Ipv4Prefix> prefixes = {{0x0a000000, 8}, {0xc6336400, 24}, {0x01020304, 32}, {0, 0}};
+
+    BGPUpdateEncoder encoder;
+    std::vector<uint8_t> buffer;
+    ASSERT_EQ(encoder.encode_announcements(attributes, prefixes.data(), prefixes.size(), buffer), 1u);
+    auto bodies = split_messages(buffer);
+    ASSERT_EQ(bodies.size(), 1u);
+
+    BGPUpdate update;
+    ASSERT_TRUE(update.parse(bodies[0].data(), bodies[0].size(), true)) << update.error_reason();
+    EXPECT_TRUE(update.withdrawn().empty());
+    EXPECT_EQ(update.origin(), BGP_ORIGIN_EGP);
+    std::vector<uint32_t> as_path;
+    update.as_path().append_to(as_path);
+    EXPECT_EQ(as_path, attributes.as_path);
+    EXPECT_EQ(update.as_path().length(), 3u);
+    EXPECT_EQ(update.as_path().first(), 65001u);
+    EXPECT_TRUE(update.as_path().contains(4200000000u));
+    EXPECT_EQ(update.next_hop(), 0xc0000201u);
+    EXPECT_TRUE(update.has(BGPAttributeType::MULTI_EXIT_DISC));
+    EXPECT_EQ(update.med(), 50u);
+    EXPECT_EQ(update.local_pref(), 200u);
+    ASSERT_EQ(update.communities().size(), 2u);
+    EXPECT_EQ(update.communities()[0], (65001u << 16) | 100);
+    EXPECT_EQ(update.communities()[1], 0xffffff01u);
+    EXPECT_FALSE(update.has(BGPAttributeType::MP_REACH_NLRI));
+
+    EXPECT_EQ(prefixes_of(update.nlri()), (std::vector<std::pair<uint32_t, uint8_t>>{
+                                              {0x0a000000, 8}, {0xc6336400, 24}, {0x01020304, 32}, {0, 0}}));
+    EXPECT_EQ(update.nlri().count(), 4u);
+
+    // Every attribute is reachable raw too, in the order it was sent
+    std::vector<uint8_t> types;
+    for (BGPAttribute attribute : update.attributes()) {
+        types.push_back(attribute.type);
+    }
+    EXPECT_EQ(types, (std::vector<uint8_t>{1, 2, 3, 4, 5, 8}));
+}
+
+TEST(BGPUpdateTest, PacksPrefixesSharingAttributesIntoFewMessages) {
+    std::vector<Ipv4Prefix> prefixes;
+    for (uint32_t i = 0; i < 10000; ++i) {
+        prefixes.emplace_back(0x0b000000 + (i << 8), 24);
+    }
+    prefixes.emplace_back(0x0c000000, 40);     // skipped
+    BGPPathAttributes attributes;
+    attributes.as_path = {65001};
+    attributes.next_hop = 0x0a000001;
+
+    BGPUpdateEncoder encoder;
+    std::vector<uint8_t> buffer;
+    size_t messages = encoder.encode_announcements(attributes, prefixes.data(), prefixes.size(), buffer);
+    auto bodies = split_messages(buffer);
+    ASSERT_EQ(bodies.size(), messages);
+    // Four octets per /24 and about 4 KB per message
+    EXPECT_EQ(messages, (10000 * 4 + 4000) / 4050);
+
+    BGPUpdate update;
+    uint32_t expected = 0;
+    for (const auto& body : bodies) {
+        ASSERT_TRUE(update.parse(body.data(), body.size(), true)) << update.error_reason();
+        for (BGPPrefix prefix : update.nlri()) {
+            ASSERT_EQ(prefix.ipv4(), 0x0b000000 + (expected << 8));
+            expected++;
+        }
+    }
+    EXPECT_EQ(expected, 10000u);
+
+    // The same again as withdrawals
+    buffer.clear();
+    messages = encoder.encode_withdrawals(prefixes.data(), prefixes.size(), buffer);
+    bodies = split_messages(buffer);
+    ASSERT_EQ(bodies.size(), messages);
+    expected = 0;
+    for (const auto& body : bodies) {
+        ASSERT_TRUE(update.parse(body.data(), body.size(), true)) << update.error_reason();
+        EXPECT_TRUE(update.is_withdraw_only());
+        expected += static_cast<uint32_t>(update.withdrawn().count());
+    }
+    EXPECT_EQ(expected, 10000u);
+
+    // Nothing to announce, nothing appended
+    buffer.clear();
+    EXPECT_EQ(encoder.encode_announcements(attributes, prefixes.data() + 10000, 1, buffer), 0u);
+    EXPECT_TRUE(buffer.empty());
+}
+
+TEST(BGPUpdateTest, AttributesTooLargeForAMessageAreReported) {
+    BGPPathAttributes attributes;
+    attributes.as_path = {65001};
+    attributes.next_hop = 1;
+    attributes.communities.assign(1100, 0xfde80001);    // 4400 bytes
+    std::vector<Ipv4Prefix> prefixes = {Ipv4Prefix(0x0a000000, 8), Ipv4Prefix(0x0b000000, 8)};
+
+    BGPUpdateEncoder encoder;
+    std::vector<uint8_t> buffer;
+    EXPECT_EQ(encoder.encode_announcements(attributes, prefixes.data(), prefixes.size(), buffer), 0u);
+    EXPECT_TRUE(buffer.empty());
+    EXPECT_EQ(encoder.prefixes_dropped(), 2u);
+
+    // Down to a size that fits, nothing more is dropped
+    attributes.communities.resize(100);
+    EXPECT_EQ(encoder.encode_announcements(attributes, prefixes.data(), prefixes.size(), buffer), 1u);
+    EXPECT_EQ(encoder.prefixes_dropped(), 2u);
+}
+
+TEST(BGPUpdateTest, TwoOctetPeersGetAsTransAndLongPathsSplit) {
+    BGPPathAttributes attributes;
+    attributes.as_path = {65001, 4200000000u};
+    attributes.next_hop = 1;
+    Ipv4Prefix prefix(0x0a000000, 8);
+
+    BGPUpdateEncoder encoder(false);
+    std::vector<uint8_t> buffer;
+    ASSERT_EQ(encoder.encode_announcements(attributes, &prefix, 1, buffer), 1u);
+    BGPUpdate update;
+    ASSERT_TRUE(update.parse(buffer.data() + BGP_HEADER_SIZE, buffer.size() - BGP_HEADER_SIZE, false));
+    std::vector<uint32_t> as_path;
+    update.as_path().append_to(as_path);
+    EXPECT_EQ(as_path, (std::vector<uint32_t>{65001, 23456}));
+
+    // 300 AS numbers: two sequences, and an extended-length attribute
+    attributes.as_path.assign(300, 65001);
+    encoder.set_four_octet_as(true);
+    buffer.clear();
+    ASSERT_EQ(encoder.encode_announcements(attributes, &prefix, 1, buffer), 1u);
+    ASSERT_TRUE(update.parse(buffer.data() + BGP_HEADER_SIZE, buffer.size() - BGP_HEADER_SIZE, true));
+    EXPECT_EQ(update.as_path().length(), 300u);
+    EXPECT_EQ(update.as_path().size_bytes(), 2 * 2 + 300 * 4u);
+    auto attribute = *(++update.attributes().begin());
+    EXPECT_EQ(attribute.type, 2);
+    EXPECT_TRUE(attribute.flags & BGP_ATTRIBUTE_EXTENDED_LENGTH);
+
+    // A four-octet path read as two-octet no longer adds up
+    EXPECT_FALSE(update.parse(buffer.data() + BGP_HEADER_SIZE, buffer.size() - BGP_HEADER_SIZE, false));
+    EXPECT_EQ(update.error(), BGPUpdateError::MALFORMED_AS_PATH);
+}
+
+TEST(BGPUpdateTest, ParsesMultiprotocolReachAndUnreach) {
+    // 2001:db8::/32 and 2001:db8:1::/48 via 2001:db8::1, and 2001:db8:ff::/48 withdrawn
+    std::vector<uint8_t> next_hop = {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+    std::vector<uint8_t> reach = {0x80, 14, 0, 0, 2, 1, 16};
+    reach.insert(reach.end(), next_hop.begin(), next_hop.end());
+    reach.insert(reach.end(), {0, 32, 0x20, 0x01, 0x0d, 0xb8, 48, 0x20, 0x01, 0x0d, 0xb8, 0, 1});
+    reach[2] = static_cast<uint8_t>(reach.size() - 3);
+    std::vector<uint8_t> unreach = {0x80, 15, 10, 0, 2, 1, 48, 0x20, 0x01, 0x0d, 0xb8, 0, 0xff};
+    auto body = update_body(concat({ORIGIN_IGP, AS_PATH_65001, reach, unreach}));
+
+    BGPUpdate update;
+    ASSERT_TRUE(update.parse(body.data(), body.size(), true)) << update.error_reason();
+    EXPECT_TRUE(update.nlri().empty());
+    const BGPMpReach& mp_reach = update.mp_reach();
+    EXPECT_EQ(mp_reach.afi, BGP_AFI_IPV6);
+    EXPECT_EQ(mp_reach.safi, BGP_SAFI_UNICAST);
+    ASSERT_EQ(mp_reach.next_hop_length, 16);
+    EXPECT_EQ(std::vector<uint8_t>(mp_reach.next_hop, mp_reach.next_hop + 16), next_hop);
+    std::vector<uint8_t> lengths;
+    for (BGPPrefix prefix : mp_reach.nlri) {
+        lengths.push_back(prefix.length);
+        EXPECT_EQ(prefix.bytes[0], 0x20);
+    }
+    EXPECT_EQ(lengths, (std::vector<uint8_t>{32, 48}));
+    EXPECT_EQ(update.mp_unreach().afi, BGP_AFI_IPV6);
+    EXPECT_EQ(update.mp_unreach().withdrawn.count(), 1u);
+
+    // Without AS_PATH the reachability cannot be used
+    body = update_body(concat({ORIGIN_IGP, reach}));
+    EXPECT_FALSE(update.parse(body.data(), body.size(), true));
+    EXPECT_EQ(update.error(), BGPUpdateError::MISSING_WELL_KNOWN_ATTRIBUTE);
+}
+
+TEST(BGPUpdateTest, RejectsMalformedUpdatesWithTheirSubcode) {
+    const std::vector<uint8_t> nlri = {24, 10, 0, 0};
+    struct Case {
+        const char* name;
+        std::vector<uint8_t> body;
+        BGPUpdateError error;
+    };
+    std::vector<Case> cases = {
+        {"short", {0, 0, 0}, BGPUpdateError::MALFORMED_ATTRIBUTE_LIST},
+        {"withdrawn overrun", {0, 9, 8, 10, 0, 0}, BGPUpdateError::MALFORMED_ATTRIBUTE_LIST},
+        {"attributes overrun", {0, 0, 0, 9, 0x40, 1, 1, 0}, BGPUpdateError::MALFORMED_ATTRIBUTE_LIST},
+        {"withdrawn /33", {0, 6, 33, 1, 2, 3, 4, 5, 0, 0}, BGPUpdateError::INVALID_NETWORK_FIELD},
+        {"NLRI cut short", update_body(concat({ORIGIN_IGP, AS_PATH_65001, NEXT_HOP}), {24, 10, 0}),
+         BGPUpdateError::INVALID_NETWORK_FIELD},
+        {"missing NEXT_HOP", update_body(concat({ORIGIN_IGP, AS_PATH_65001}), nlri),
+         BGPUpdateError::MISSING_WELL_KNOWN_ATTRIBUTE},
+        {"repeated ORIGIN", update_body(concat({ORIGIN_IGP, ORIGIN_IGP, AS_PATH_65001, NEXT_HOP}), nlri),
+         BGPUpdateError::MALFORMED_ATTRIBUTE_LIST},
+        {"optional ORIGIN", update_body(concat({{0xc0, 1, 1, 0}, AS_PATH_65001, NEXT_HOP}), nlri),
+         BGPUpdateError::ATTRIBUTE_FLAGS_ERROR},
+        {"transitive MED", update_body(concat({ORIGIN_IGP, AS_PATH_65001, NEXT_HOP, {0xc0, 4, 4, 0, 0, 0, 1}}), nlri),
+         BGPUpdateError::ATTRIBUTE_FLAGS_ERROR},
+        {"long NEXT_HOP", update_body(concat({ORIGIN_IGP, AS_PATH_65001, {0x40, 3, 5, 1, 2, 3, 4, 5}}), nlri),
+         BGPUpdateError::ATTRIBUTE_LENGTH_ERROR},
+        {"value overrun", update_body({0x40, 1, 9, 0}), BGPUpdateError::ATTRIBUTE_LENGTH_ERROR},
+        {"ORIGIN 3", update_body(concat({{0x40, 1, 1, 3}, AS_PATH_65001, NEXT_HOP}), nlri),
+         BGPUpdateError::INVALID_ORIGIN},
+        {"AS_PATH segment type 9", update_body(concat({ORIGIN_IGP, {0x40, 2, 6, 9, 1, 0, 0, 0xfd, 0xe9}, NEXT_HOP}),
+                                               nlri),
+         BGPUpdateError::MALFORMED_AS_PATH},
+        {"AS_PATH count past end", update_body(concat({ORIGIN_IGP, {0x40, 2, 6, 2, 2, 0, 0, 0xfd, 0xe9}, NEXT_HOP}),
+                                               nlri),
+         BGPUpdateError::MALFORMED_AS_PATH},
+        {"COMMUNITIES of 3 octets", update_body(concat({ORIGIN_IGP, AS_PATH_65001, NEXT_HOP, {0xc0, 8, 3, 1, 2, 3}}),
+                                                nlri),
+         BGPUpdateError::OPTIONAL_ATTRIBUTE_ERROR},
+        {"unknown well-known", update_body(concat({ORIGIN_IGP, AS_PATH_65001, NEXT_HOP, {0x40, 99, 0}}), nlri),
+         BGPUpdateError::UNRECOGNIZED_WELL_KNOWN_ATTRIBUTE},
+        {"IPv4 MP_REACH /40", update_body(concat({ORIGIN_IGP, AS_PATH_65001, {0x80, 14, 11, 0, 1, 1, 4, 1, 2, 3, 4, 0,
+                                                                              40, 1}})),
+         BGPUpdateError::OPTIONAL_ATTRIBUTE_ERROR},
+    };
+
+    BGPUpdate update;
+    for (const auto& test : cases) {
+        EXPECT_FALSE(update.parse(test.body.data(), test.body.size(), true)) << test.name;
+        EXPECT_EQ(update.error(), test.error) << test.name << ": " << update.error_reason();
+    }
+
+    // Unknown optional attributes pass through; an empty UPDATE is End-of-RIB
+    auto body = update_body(concat({ORIGIN_IGP, AS_PATH_65001, NEXT_HOP, {0xc0, 99, 2, 7, 7}}), nlri);
+    ASSERT_TRUE(update.parse(body.data(), body.size(), true)) << update.error_reason();
+    EXPECT_TRUE(update.has_type(99));
+    EXPECT_FALSE(update.is_end_of_rib());
+    body = {0, 0, 0, 0};
+    ASSERT_TRUE(update.parse(body.data(), body.size(), true));
+    EXPECT_TRUE(update.is_end_of_rib());
+    EXPECT_FALSE(update.has_type(99));
+}
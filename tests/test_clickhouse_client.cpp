@@ -0,0 +1,391 @@
+#include <gtest/gtest.h>
+#include "analytics/clickhouse_client.h"
+#include <clickhouse/client.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <dirent.h>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+
+using namespace RouterSim;
+
+namespace {
+
+NetworkMetric make_metric(uint64_t i) {
+    NetworkMetric metric;
+    metric.timestamp = 1700000000000ull + i;
+    metric.router_id = "r" + std::to_string(i % 3);
+    metric.interface = "eth" + std::to_string(i % 2);
+    metric.metric_type = "rx_bytes";
+    metric.value = double(i);
+    metric.tags = {{"site", "lab"}};
+    return metric;
+}
+
+template <typename Predicate>
+bool wait_for(Predicate predicate) {
+    for (int i = 0; i < 5000 && !predicate(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return predicate();
+}
+
+class ClickHouseClientTest : public ::testing::Test {
+protected:
+    std::string journal_directory = "/tmp/clickhouse_journal_" + std::to_string(getpid());
+
+    void SetUp() override {
+        clickhouse::MockServer::instance().reset();
+        remove_journal();
+    }
+    void TearDown() override {
+        clickhouse::MockServer::instance().reset();
+        remove_journal();
+    }
+
+    void remove_journal() {
+        if (DIR* dir = opendir(journal_directory.c_str())) {
+            while (dirent* entry = readdir(dir)) {
+                std::remove((journal_directory + "/" + entry->d_name).c_str());
+            }
+            closedir(dir);
+        }
+        rmdir(journal_directory.c_str());
+    }
+};
+
+} // namespace
+
+TEST_F(ClickHouseClientTest, SendsOneColumnarBlockPerFlush) {
+    auto& server = clickhouse::MockServer::instance();
+    std::vector<size_t> block_rows;
+    server.on_insert = [&](const std::string& table, const clickhouse::Block& block) {
+        EXPECT_EQ(table, "network_metrics");
+        ASSERT_EQ(block.GetColumnCount(), 6u);
+        EXPECT_EQ(block.GetColumnName(1), "router_id");
+        EXPECT_EQ(block[1]->Type()->GetName(), "LowCardinality(String)");
+        auto router_id = block[1]->As<clickhouse::ColumnLowCardinalityT<clickhouse::ColumnString>>();
+        ASSERT_TRUE(router_id);
+        EXPECT_EQ(router_id->GetDictionarySize(), 3u);
+        auto timestamp = block[0]->As<clickhouse::ColumnUInt64>();
+        ASSERT_TRUE(timestamp);
+        EXPECT_EQ(timestamp->At(0), 1700000000000ull + block_rows.size() * ClickHouseClient::METRIC_BATCH_ROWS);
+        EXPECT_EQ(block[5]->Type()->GetName(), "Map(String, String)");
+        block_rows.push_back(block.GetRowCount());
+    };
+
+    ClickHouseClient client;
+    ClickHouseFlushOptions options;
+    options.background = false;
+    ASSERT_TRUE(client.connect(options));
+    // Reaching the batch size flushes from inside insert_metric()
+    for (uint64_t i = 0; i < 2500; ++i) {
+        client.insert_metric(make_metric(i));
+    }
+    EXPECT_EQ(block_rows, (std::vector<size_t>{1000, 1000}));
+    client.flush_all_buffers();
+    EXPECT_EQ(block_rows, (std::vector<size_t>{1000, 1000, 500}));
+
+    auto stats = client.get_statistics();
+    EXPECT_EQ(stats.rows_inserted, 2500u);
+    EXPECT_EQ(stats.blocks_inserted, 3u);
+    EXPECT_EQ(server.rows, 2500u);
+}
+
+TEST_F(ClickHouseClientTest, FailedInsertKeepsRows) {
+    auto& server = clickhouse::MockServer::instance();
+    bool fail = true;
+    size_t rows = 0;
+    server.on_insert = [&](const std::string&, const clickhouse::Block& block) {
+        if (fail) {
+            throw std::runtime_error("server busy");
+        }
+        rows = block.GetRowCount();
+        auto as_path = block[5]->As<clickhouse::ColumnArrayT<clickhouse::ColumnUInt32>>();
+        ASSERT_TRUE(as_path);
+        EXPECT_EQ(as_path->GetSize(0), 3u);
+        EXPECT_EQ(as_path->GetData().Size(), 3u * rows);
+    };
+
+    ClickHouseClient client;
+    ClickHouseFlushOptions options;
+    options.background = false;
+    ASSERT_TRUE(client.connect(options));
+    BGPUpdate update;
+    update.router_id = "r1";
+    update.prefix = "10.0.0.0";
+    update.prefix_length = 8;
+    update.as_path = {65001, 65002, 65003};
+    update.communities = {"65001:100"};
+    update.action = "announce";
+    for (int i = 0; i < 10; ++i) {
+        client.insert_bgp_update(update);
+    }
+
+    client.flush_bgp_updates();
+    EXPECT_EQ(client.get_statistics().insert_failures, 1u);
+    fail = false;
+    client.flush_bgp_updates();
+    EXPECT_EQ(rows, 10u);
+    EXPECT_EQ(client.get_statistics().rows_inserted, 10u);
+}
+
+TEST_F(ClickHouseClientTest, QueryRendersColumns) {
+    auto& server = clickhouse::MockServer::instance();
+    server.on_select = [](const std::string&, const std::function<void(const clickhouse::Block&)>& reply) {
+        auto router_id = std::make_shared<clickhouse::ColumnLowCardinalityT<clickhouse::ColumnString>>();
+        auto packets = std::make_shared<clickhouse::ColumnUInt64>();
+        router_id->Append("r1");
+        router_id->Append("r2");
+        packets->Append(7);
+        packets->Append(9);
+        clickhouse::Block block;
+        block.AppendColumn("router_id", router_id);
+        block.AppendColumn("packets", packets);
+        reply(block);
+    };
+
+    ClickHouseClient client;
+    ASSERT_TRUE(client.connect());
+    auto rows = client.query("SELECT router_id, packets FROM packet_flows");
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_EQ(rows[1]["router_id"], "r2");
+    EXPECT_EQ(rows[1]["packets"], "9");
+}
+
+TEST_F(ClickHouseClientTest, InsertsMetricRollups) {
+    auto& server = clickhouse::MockServer::instance();
+    size_t rows = 0;
+    server.on_insert = [&](const std::string& table, const clickhouse::Block& block) {
+        EXPECT_EQ(table, "metric_rollups");
+        ASSERT_EQ(block.GetColumnCount(), 15u);
+        EXPECT_EQ(block.GetColumnName(1), "window_ms");
+        EXPECT_EQ(block.GetColumnName(11), "p99");
+        auto p99 = block[11]->As<clickhouse::ColumnFloat64>();
+        ASSERT_TRUE(p99);
+        EXPECT_DOUBLE_EQ(p99->At(0), 990.0);
+        auto sketch = block[14]->As<clickhouse::ColumnString>();
+        ASSERT_TRUE(sketch);
+        EXPECT_EQ(sketch->At(0), "sketch");
+        rows += block.GetRowCount();
+    };
+
+    ClickHouseClient client;
+    ClickHouseFlushOptions options;
+    options.background = false;
+    ASSERT_TRUE(client.connect(options));
+    MetricRollup rollup;
+    rollup.timestamp = 1700000000000ull;
+    rollup.window_ms = 10000;
+    rollup.router_id = "r1";
+    rollup.interface = "eth0";
+    rollup.metric_type = "latency_us";
+    rollup.count = 1000;
+    rollup.p99 = 990.0;
+    rollup.quantile_sketch = "sketch";
+    for (int i = 0; i < 3; ++i) {
+        client.insert_metric_rollup(rollup);
+    }
+    client.flush_all_buffers();
+    EXPECT_EQ(rows, 3u);
+}
+
+TEST_F(ClickHouseClientTest, StalledServerDropsInsteadOfBlocking) {
+    auto& server = clickhouse::MockServer::instance();
+    std::atomic<int> entered{0};
+    std::atomic<bool> release{false};
+    server.on_insert = [&](const std::string&, const clickhouse::Block&) {
+        entered++;
+        for (int i = 0; i < 10000 && !release; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+
+    ClickHouseClient client;
+    ClickHouseFlushOptions options;
+    options.max_buffered_batches = 2;
+    ASSERT_TRUE(client.connect(options));
+
+    client.insert_metric(make_metric(0));
+    for (uint64_t i = 1; i < ClickHouseClient::METRIC_BATCH_ROWS; ++i) {
+        client.insert_metric(make_metric(i));
+    }
+    for (int i = 0; i < 2000 && entered == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(entered, 1);
+
+    // The flusher is stuck in the server: these must neither wait for it nor grow without bound
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = ClickHouseClient::METRIC_BATCH_ROWS; i < 5000; ++i) {
+        client.insert_metric(make_metric(i));
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    EXPECT_EQ(client.get_statistics().rows_inserted, 0u);
+    EXPECT_GE(client.get_statistics().rows_dropped, 5000u - 3 * ClickHouseClient::METRIC_BATCH_ROWS);
+
+    release = true;
+    client.disconnect();
+    auto stats = client.get_statistics();
+    EXPECT_EQ(stats.rows_inserted + stats.rows_dropped, 5000u);
+    EXPECT_EQ(server.rows, stats.rows_inserted);
+}
+
+TEST_F(ClickHouseClientTest, PartialBatchesFlushOnInterval) {
+    auto& server = clickhouse::MockServer::instance();
+    ClickHouseClient client;
+    ClickHouseFlushOptions options;
+    options.flush_interval_ms = 10;
+    ASSERT_TRUE(client.connect(options));
+
+    for (uint64_t i = 0; i < 5; ++i) {
+        client.insert_metric(make_metric(i));
+    }
+    PacketFlow flow;
+    flow.router_id = "r1";
+    client.insert_packet_flow(flow);
+
+    for (int i = 0; i < 2000 && client.get_statistics().rows_inserted < 6; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(client.get_statistics().rows_inserted, 6u);
+    EXPECT_EQ(client.get_statistics().blocks_inserted, 2u);
+    client.disconnect();
+    EXPECT_EQ(server.rows, 6u);
+}
+
+TEST_F(ClickHouseClientTest, JournalsWhileServerIsDownAndReplaysAfter) {
+    auto& server = clickhouse::MockServer::instance();
+    server.refuse_connections = true;
+    std::set<uint64_t> timestamps;
+    std::vector<uint32_t> as_path;
+    std::string site;
+    server.on_insert = [&](const std::string& table, const clickhouse::Block& block) {
+        if (table == "network_metrics") {
+            auto timestamp = block[0]->As<clickhouse::ColumnUInt64>();
+            for (size_t i = 0; i < block.GetRowCount(); ++i) {
+                timestamps.insert(timestamp->At(i));
+            }
+            auto tags = block[5]->As<clickhouse::ColumnMapT<clickhouse::ColumnString, clickhouse::ColumnString>>();
+            site = std::string(tags->At(0).at(0).second);
+        } else if (table == "bgp_updates") {
+            as_path = block[5]->As<clickhouse::ColumnArrayT<clickhouse::ColumnUInt32>>()->At(0);
+        }
+    };
+
+    ClickHouseClient client;
+    ClickHouseFlushOptions options;
+    options.flush_interval_ms = 10;
+    options.journal_directory = journal_directory;
+    options.journal.segment_bytes = 1 << 20;
+    // The server being down does not stop collection when there is a journal
+    ASSERT_TRUE(client.connect(options));
+
+    for (uint64_t i = 0; i < 2500; ++i) {
+        client.insert_metric(make_metric(i));
+    }
+    BGPUpdate update;
+    update.router_id = "r1";
+    update.as_path = {65001, 65002, 65003};
+    update.action = "announce";
+    client.insert_bgp_update(update);
+
+    ASSERT_TRUE(wait_for([&] { return client.get_statistics().rows_journaled == 2501; }));
+    EXPECT_EQ(client.get_statistics().rows_inserted, 0u);
+    EXPECT_EQ(client.get_journal_statistics().rows_pending, 2501u);
+
+    server.refuse_connections = false;
+    ASSERT_TRUE(wait_for([&] { return client.get_statistics().rows_replayed == 2501; }));
+    client.disconnect();
+
+    auto stats = client.get_statistics();
+    EXPECT_EQ(stats.rows_inserted, 2501u);
+    EXPECT_EQ(stats.rows_dropped, 0u);
+    EXPECT_EQ(client.get_journal_statistics().rows_pending, 0u);
+    EXPECT_EQ(server.rows, 2501u);
+    EXPECT_EQ(timestamps.size(), 2500u);
+    EXPECT_EQ(*timestamps.rbegin(), 1700000000000ull + 2499);
+    EXPECT_EQ(site, "lab");
+    EXPECT_EQ(as_path, (std::vector<uint32_t>{65001, 65002, 65003}));
+}
+
+TEST_F(ClickHouseClientTest, FailedInsertsSpillAndNothingIsLost) {
+    auto& server = clickhouse::MockServer::instance();
+    std::atomic<bool> fail{true};
+    server.on_insert = [&](const std::string&, const clickhouse::Block&) {
+        if (fail) {
+            throw std::runtime_error("server busy");
+        }
+    };
+
+    ClickHouseClient client;
+    ClickHouseFlushOptions options;
+    options.flush_interval_ms = 10;
+    options.journal_directory = journal_directory;
+    options.replay_batch_rows = 700;
+    ASSERT_TRUE(client.connect(options));
+
+    for (uint64_t i = 0; i < 3000; ++i) {
+        client.insert_metric(make_metric(i));
+    }
+    ASSERT_TRUE(wait_for([&] { return client.get_statistics().rows_journaled == 3000; }));
+    EXPECT_GE(client.get_statistics().insert_failures, 1u);
+
+    fail = false;
+    for (uint64_t i = 3000; i < 4000; ++i) {
+        client.insert_metric(make_metric(i));
+    }
+    ASSERT_TRUE(wait_for([&] { return client.get_statistics().rows_inserted == 4000; }));
+    client.disconnect();
+
+    auto stats = client.get_statistics();
+    EXPECT_EQ(stats.rows_replayed, stats.rows_journaled);
+    EXPECT_EQ(stats.rows_dropped, 0u);
+    EXPECT_EQ(server.rows, 4000u);
+}
+
+TEST_F(ClickHouseClientTest, UndecodableJournalRecordIsSkippedAlone) {
+    auto& server = clickhouse::MockServer::instance();
+    server.refuse_connections = true;
+    ClickHouseFlushOptions options;
+    options.flush_interval_ms = 10;
+    options.journal_directory = journal_directory;
+    options.journal.segment_bytes = 1 << 20;
+    {
+        ClickHouseClient client;
+        ASSERT_TRUE(client.connect(options));
+        for (uint64_t i = 0; i < 1000; ++i) {
+            client.insert_metric(make_metric(i));
+        }
+        ASSERT_TRUE(wait_for([&] { return client.get_statistics().rows_journaled == 1000; }));
+        client.disconnect();
+    }
+    {
+        // Tagged as metrics but not their encoding, between two good records
+        SegmentJournal journal;
+        ASSERT_TRUE(journal.open(journal_directory, options.journal));
+        const char junk[] = "junk";
+        ASSERT_TRUE(journal.append(0, 5, junk, sizeof(junk)));
+    }
+
+    ClickHouseClient client;
+    ASSERT_TRUE(client.connect(options));
+    for (uint64_t i = 1000; i < 1500; ++i) {
+        client.insert_metric(make_metric(i));
+    }
+    ASSERT_TRUE(wait_for([&] { return client.get_statistics().rows_journaled == 500; }));
+
+    // Both good records merge into one block around the bad one
+    server.refuse_connections = false;
+    ASSERT_TRUE(wait_for([&] { return client.get_statistics().rows_replayed == 1500; }));
+    client.disconnect();
+
+    auto stats = client.get_statistics();
+    EXPECT_EQ(stats.records_skipped, 1u);
+    EXPECT_EQ(stats.rows_dropped, 0u);
+    EXPECT_EQ(server.rows, 1500u);
+    EXPECT_EQ(server.inserts, 1u);
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include "traffic_shaping.h"
+#include "traffic_shaping/drr.h"
+#include <map>
+
+using namespace RouterSim;
+
+namespace {
+
+std::vector<WFQClass> make_classes(std::initializer_list<std::pair<uint8_t, uint32_t>> weights) {
+    std::vector<WFQClass> classes;
+    for (const auto& [class_id, weight] : weights) {
+        WFQClass wfq_class;
+        wfq_class.class_id = class_id;
+        wfq_class.weight = weight;
+        classes.push_back(wfq_class);
+    }
+    return classes;
+}
+
+PacketDescriptor make_packet(uint64_t id, uint32_t size) {
+    PacketDescriptor packet{};
+    packet.set_ipv4(0x0A000001, 0x0A000002);
+    packet.id = id;
+    packet.size = size;
+    return packet;
+}
+
+} // namespace
+
+TEST(DeficitRoundRobinTest, SharesBytesByWeightAcrossPacketSizes) {
+    DeficitRoundRobin drr;
+    ASSERT_TRUE(drr.initialize(make_classes({{1, 1}, {2, 1}, {3, 2}})));
+
+    // Class 1 sends small packets, class 2 large ones; DRR shares bytes,
+    // not packets, so both get the same byte count
+    for (int i = 0; i < 900; ++i) {
+        ASSERT_TRUE(drr.enqueue_packet(make_packet(1, 100), 1));
+        if (i < 100) {
+            ASSERT_TRUE(drr.enqueue_packet(make_packet(2, 1500), 2));
+            ASSERT_TRUE(drr.enqueue_packet(make_packet(3, 1500), 3));
+        }
+    }
+
+    std::map<uint64_t, uint64_t> bytes;
+    PacketDescriptor out{};
+    for (int i = 0; i < 400; ++i) {
+        ASSERT_TRUE(drr.dequeue_packet(out));
+        bytes[out.id] += out.size;
+    }
+    EXPECT_NEAR(static_cast<double>(bytes[1]) / bytes[2], 1.0, 0.1);
+    EXPECT_NEAR(static_cast<double>(bytes[3]) / bytes[2], 2.0, 0.2);
+}
+
+TEST(DeficitRoundRobinTest, SparseFlowPriority) {
+    DRRConfig config;
+    config.sparse_flow_priority = true;
+    DeficitRoundRobin drr(config);
+    ASSERT_TRUE(drr.initialize(make_classes({{1, 1}, {2, 1}})));
+
+    // Bulk class 1 is already backlogged and has used its first quantum
+    for (int i = 0; i < 50; ++i) {
+        ASSERT_TRUE(drr.enqueue_packet(make_packet(1, 1500), 1));
+    }
+    PacketDescriptor out{};
+    ASSERT_TRUE(drr.dequeue_packet(out));
+    ASSERT_TRUE(drr.dequeue_packet(out));
+
+    // A newly active sparse class jumps ahead of the bulk class
+    ASSERT_TRUE(drr.enqueue_packet(make_packet(2, 64), 2));
+    ASSERT_TRUE(drr.dequeue_packet(out));
+    EXPECT_EQ(out.id, 2u);
+    EXPECT_EQ(drr.get_statistics().sparse_dequeues, 3u);
+
+    // Without DRR++ it waits behind the bulk class's turn
+    DeficitRoundRobin plain;
+    ASSERT_TRUE(plain.initialize(make_classes({{1, 1}, {2, 1}})));
+    for (int i = 0; i < 50; ++i) {
+        ASSERT_TRUE(plain.enqueue_packet(make_packet(1, 1000), 1));
+    }
+    ASSERT_TRUE(plain.dequeue_packet(out));
+    ASSERT_TRUE(plain.enqueue_packet(make_packet(2, 64), 2));
+    ASSERT_TRUE(plain.dequeue_packet(out));
+    EXPECT_EQ(out.id, 1u);
+}
+
+TEST(DeficitRoundRobinTest, QueueLimitAndUnknownClass) {
+    DeficitRoundRobin drr;
+    ASSERT_TRUE(drr.initialize(make_classes({{1, 1}})));
+    EXPECT_FALSE(drr.enqueue_packet(make_packet(0, 100), 2));
+
+    for (size_t i = 0; i < DeficitRoundRobin::MAX_QUEUE_SIZE; ++i) {
+        ASSERT_TRUE(drr.enqueue_packet(make_packet(i, 100), 1));
+    }
+    EXPECT_FALSE(drr.enqueue_packet(make_packet(0, 100), 1));
+    EXPECT_EQ(drr.get_statistics().total_packets_dropped, 1u);
+
+    PacketDescriptor burst[64];
+    EXPECT_EQ(drr.dequeue_burst(burst, 64), 64u);
+    EXPECT_EQ(burst[63].id, 63u);
+    EXPECT_EQ(drr.queue_size(), DeficitRoundRobin::MAX_QUEUE_SIZE - 64);
+}
+
+TEST(DeficitRoundRobinTest, TrafficShaperUsesDrr) {
+    TrafficShaper shaper;
+    shaper.initialize();
+    shaper.setTokenBucketConfig(1000000, 1000000, 1000000);
+    shaper.setAlgorithm(ShapingAlgorithm::DEFICIT_ROUND_ROBIN);
+    shaper.setEnabled(true);
+
+    PacketDescriptor packet = make_packet(5, 200);
+    packet.priority = 3;
+    ASSERT_TRUE(shaper.processPacket(packet));
+
+    auto stats = shaper.getStatistics();
+    EXPECT_EQ(stats.algorithm, ShapingAlgorithm::DEFICIT_ROUND_ROBIN);
+    EXPECT_EQ(stats.drr_stats.class_statistics.at(3).current_queue_length, 1u);
+    EXPECT_EQ(stats.wfq_stats.queue_stats[3].packets, 0u);
+
+    PacketInfo out;
+    ASSERT_TRUE(shaper.dequeuePacket(out));
+    EXPECT_EQ(out.id, 5u);
+}
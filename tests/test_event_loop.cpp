@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include "event_loop.h"
+#include <chrono>
+#include <thread>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+using namespace RouterSim;
+
+TEST(EventLoopTest, TimersFireInOrderAndNeverEarly) {
+    EventLoop loop;
+    std::vector<int> fired;
+    uint64_t start = loop.now_ns();
+    uint64_t fired_at = 0;
+    loop.schedule(20000000, [&] {
+        fired.push_back(2);
+        fired_at = loop.now_ns();
+        loop.stop();
+    });
+    loop.schedule(5000000, [&] { fired.push_back(1); });
+    auto cancelled = loop.schedule(10000000, [&] { fired.push_back(3); });
+    EXPECT_TRUE(loop.cancel(cancelled));
+    EXPECT_FALSE(loop.cancel(cancelled));
+
+    loop.run();
+    EXPECT_EQ(fired, (std::vector<int>{1, 2}));
+    EXPECT_GE(fired_at - start, 20000000u);
+
+    // Slept through each wait instead of spinning
+    auto stats = loop.get_statistics();
+    EXPECT_EQ(stats.timers_fired, 2u);
+    EXPECT_LE(stats.wakeups, 6u);
+}
+
+TEST(EventLoopTest, DispatchesReadableDescriptors) {
+    EventLoop loop;
+    int pipe_fds[2];
+    ASSERT_EQ(pipe(pipe_fds), 0);
+
+    std::string received;
+    ASSERT_TRUE(loop.add(pipe_fds[0], EPOLLIN, [&](uint32_t events) {
+        EXPECT_TRUE(events & EPOLLIN);
+        char buffer[16];
+        ssize_t n = read(pipe_fds[0], buffer, sizeof(buffer));
+        received.append(buffer, n > 0 ? n : 0);
+        // Removing itself from inside its own callback
+        loop.remove(pipe_fds[0]);
+    }));
+    EXPECT_FALSE(loop.add(pipe_fds[0], EPOLLIN, [](uint32_t) {}));
+
+    ASSERT_EQ(write(pipe_fds[1], "bgp", 3), 3);
+    loop.run_once(1000);
+    EXPECT_EQ(received, "bgp");
+
+    // No longer watched
+    ASSERT_EQ(write(pipe_fds[1], "x", 1), 1);
+    loop.run_once(10);
+    EXPECT_EQ(received, "bgp");
+    EXPECT_EQ(loop.get_statistics().io_events, 1u);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
+
+TEST(EventLoopTest, PostedTasksWakeTheLoop) {
+    EventLoop loop;
+    std::thread runner([&] { loop.run(); });
+
+    std::atomic<int> ran(0);
+    std::atomic<bool> on_loop(false);
+    for (int i = 0; i < 100; ++i) {
+        loop.post([&] {
+            ran++;
+            on_loop = loop.in_loop_thread();
+        });
+    }
+    loop.post([&] { loop.stop(); });
+    runner.join();
+
+    EXPECT_EQ(ran.load(), 100);
+    EXPECT_TRUE(on_loop.load());
+    EXPECT_EQ(loop.get_statistics().tasks_run, 101u);
+}
+
+TEST(EventLoopTest, StopBeforeRunReturnsImmediately) {
+    EventLoop loop;
+    loop.stop();
+    auto start = std::chrono::steady_clock::now();
+    loop.run();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+}
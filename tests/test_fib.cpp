@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include "routing/fib.h"
+#include <random>
+#include <vector>
+
+using namespace RouterSim;
+
+namespace {
+
+struct ReferenceRoute {
+    uint32_t address;
+    uint8_t length;
+    uint32_t next_hop;
+};
+
+uint32_t reference_lookup(const std::vector<ReferenceRoute>& routes, uint32_t address) {
+    int best_length = -1;
+    uint32_t best = Ipv4Fib::INVALID_NEXT_HOP;
+    for (const auto& route : routes) {
+        uint32_t mask = route.length == 0 ? 0 : 0xFFFFFFFFu << (32 - route.length);
+        if ((address & mask) == route.address && route.length > best_length) {
+            best_length = route.length;
+            best = route.next_hop;
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+TEST(Ipv4FibTest, ParsePrefix) {
+    Ipv4Prefix prefix;
+    ASSERT_TRUE(parse_ipv4_prefix("10.1.2.3/8", prefix));
+    EXPECT_EQ(prefix.address, 0x0A000000u);
+    EXPECT_EQ(prefix.length, 8);
+    EXPECT_EQ(format_ipv4_prefix(prefix), "10.0.0.0/8");
+
+    EXPECT_FALSE(parse_ipv4_prefix("10.0.0/8", prefix));
+    EXPECT_FALSE(parse_ipv4_prefix("10.0.0.256/8", prefix));
+    EXPECT_FALSE(parse_ipv4_prefix("10.0.0.0/33", prefix));
+}
+
+TEST(Ipv4FibTest, EmptyTable) {
+    Ipv4Fib fib;
+    fib.build();
+    EXPECT_EQ(fib.lookup(0x08080808), Ipv4Fib::INVALID_NEXT_HOP);
+}
+
+TEST(Ipv4FibTest, LongestPrefixWins) {
+    Ipv4Fib fib;
+    fib.insert(0x00000000, 0, 1);   // default
+    fib.insert(0x0A000000, 8, 2);   // 10.0.0.0/8
+    fib.insert(0x0A010000, 16, 3);  // 10.1.0.0/16
+    fib.insert(0x0A010200, 24, 4);  // 10.1.2.0/24
+    fib.insert(0x0A010203, 32, 5);  // 10.1.2.3/32
+    fib.build();
+
+    EXPECT_EQ(fib.lookup(0x08080808), 1u);
+    EXPECT_EQ(fib.lookup(0x0A020304), 2u);
+    EXPECT_EQ(fib.lookup(0x0A01FF01), 3u);
+    EXPECT_EQ(fib.lookup(0x0A010201), 4u);
+    EXPECT_EQ(fib.lookup(0x0A010203), 5u);
+    EXPECT_EQ(fib.size(), 5u);
+}
+
+TEST(Ipv4FibTest, RemoveFallsBackToShorterPrefix) {
+    Ipv4Fib fib;
+    fib.insert(0x0A000000, 8, 2);
+    fib.insert(0x0A010200, 24, 4);
+    fib.build();
+    EXPECT_EQ(fib.lookup(0x0A010201), 4u);
+
+    EXPECT_TRUE(fib.remove(0x0A010200, 24));
+    EXPECT_FALSE(fib.remove(0x0A010200, 24));
+    EXPECT_TRUE(fib.needs_build());
+    fib.build();
+    EXPECT_EQ(fib.lookup(0x0A010201), 2u);
+    EXPECT_EQ(fib.find_exact(0x0A010200, 24), Ipv4Fib::INVALID_NEXT_HOP);
+    EXPECT_EQ(fib.find_exact(0x0A000000, 8), 2u);
+}
+
+TEST(Ipv4FibTest, MatchesReferenceOnRandomTable) {
+    std::mt19937 rng(7);
+    std::vector<ReferenceRoute> routes;
+    Ipv4Fib fib;
+
+    for (int i = 0; i < 2000; ++i) {
+        uint8_t length = static_cast<uint8_t>(rng() % 33);
+        // Cluster prefixes under a few /8s so strides are exercised deeply
+        uint32_t address = (rng() % 4) << 24 | (rng() & 0x00FFFFFF);
+        address = length == 0 ? 0 : address & (0xFFFFFFFFu << (32 - length));
+        uint32_t next_hop = rng() % 100;
+
+        bool replaced = false;
+        for (auto& route : routes) {
+            if (route.address == address && route.length == length) {
+                route.next_hop = next_hop;
+                replaced = true;
+            }
+        }
+        if (!replaced) {
+            routes.push_back({address, length, next_hop});
+        }
+        fib.insert(address, length, next_hop);
+    }
+    fib.build();
+    EXPECT_EQ(fib.size(), routes.size());
+
+    for (int i = 0; i < 20000; ++i) {
+        uint32_t address = (i % 2) ? rng() : ((rng() % 4) << 24 | (rng() & 0x00FFFFFF));
+        ASSERT_EQ(fib.lookup(address), reference_lookup(routes, address)) << format_ipv4_address(address);
+    }
+    for (const auto& route : routes) {
+        ASSERT_EQ(fib.lookup(route.address), reference_lookup(routes, route.address));
+    }
+}
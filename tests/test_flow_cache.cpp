@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+#include "analytics/flow_cache.h"
+#include "analytics/clickhouse_client.h"
+#include <map>
+#include <vector>
+
+using namespace RouterSim;
+
+namespace {
+
+const uint64_t MS = 1000000;
+
+PacketDescriptor make_packet(uint32_t flow, uint32_t size, uint64_t timestamp_ns) {
+    PacketDescriptor packet{};
+    packet.set_ipv4(0x0a000001, 0x0a100000 + flow);
+    packet.src_port = static_cast<uint16_t>(10000 + flow % 1000);
+    packet.dst_port = 443;
+    packet.protocol = 6;
+    packet.size = size;
+    packet.timestamp_ns = timestamp_ns;
+    return packet;
+}
+
+class FlowCacheTest : public ::testing::Test {
+protected:
+    std::vector<FlowRecord> records;
+
+    FlowCache make_cache(size_t capacity, uint32_t active_ms = 60000, uint32_t idle_ms = 15000) {
+        FlowCacheOptions options;
+        options.capacity = capacity;
+        options.active_timeout_ms = active_ms;
+        options.idle_timeout_ms = idle_ms;
+        return FlowCache(options, [this](const FlowRecord& record) { records.push_back(record); });
+    }
+
+    uint64_t exported_packets() const {
+        uint64_t packets = 0;
+        for (const auto& record : records) {
+            packets += record.packets;
+        }
+        return packets;
+    }
+};
+
+} // namespace
+
+TEST_F(FlowCacheTest, AggregatesPacketsPerFlow) {
+    FlowCache cache = make_cache(1024);
+    for (uint64_t i = 0; i < 10; ++i) {
+        cache.update(make_packet(1, 100, i * MS));
+    }
+    for (uint64_t i = 0; i < 5; ++i) {
+        cache.update(make_packet(2, 1500, 3 * MS + i * MS));
+    }
+    EXPECT_TRUE(records.empty());
+    EXPECT_EQ(cache.size(), 2u);
+
+    cache.flush();
+    ASSERT_EQ(records.size(), 2u);
+    std::map<uint16_t, FlowRecord> by_port;
+    for (const auto& record : records) {
+        EXPECT_EQ(record.reason, FlowExportReason::FLUSHED);
+        by_port[record.key.src_port] = record;
+    }
+    EXPECT_EQ(by_port[10001].packets, 10u);
+    EXPECT_EQ(by_port[10001].bytes, 1000u);
+    EXPECT_EQ(by_port[10001].first_ns, 0u);
+    EXPECT_EQ(by_port[10001].last_ns, 9 * MS);
+    EXPECT_EQ(by_port[10002].packets, 5u);
+    EXPECT_EQ(by_port[10002].bytes, 7500u);
+    EXPECT_EQ(cache.size(), 0u);
+
+    auto stats = cache.get_statistics();
+    EXPECT_EQ(stats.packets, 15u);
+    EXPECT_EQ(stats.hits, 13u);
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_DOUBLE_EQ(stats.hit_rate, 13.0 / 15.0);
+    EXPECT_EQ(stats.records_exported, 2u);
+}
+
+TEST_F(FlowCacheTest, IdleTimeoutExportsQuietFlows) {
+    FlowCache cache = make_cache(1024, 60000, 100);
+    cache.update(make_packet(1, 100, 0));
+    cache.update(make_packet(2, 100, 50 * MS));
+
+    cache.expire(120 * MS);
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_EQ(records[0].key.src_port, 10001);
+    EXPECT_EQ(records[0].reason, FlowExportReason::IDLE_TIMEOUT);
+    EXPECT_EQ(cache.size(), 1u);
+
+    cache.expire(200 * MS);
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(cache.get_statistics().idle_timeouts, 2u);
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST_F(FlowCacheTest, ActiveTimeoutReportsLongFlowsInParts) {
+    FlowCache cache = make_cache(1024, 1000, 60000);
+    // One packet every 100 ms for 3.5 s
+    for (uint64_t i = 0; i < 35; ++i) {
+        cache.update(make_packet(1, 100, i * 100 * MS));
+    }
+    ASSERT_EQ(records.size(), 3u);
+    for (const auto& record : records) {
+        EXPECT_EQ(record.reason, FlowExportReason::ACTIVE_TIMEOUT);
+        EXPECT_EQ(record.packets, 10u);
+    }
+    EXPECT_EQ(records[1].first_ns, 1000 * MS);
+    EXPECT_EQ(cache.size(), 1u);
+
+    cache.flush();
+    EXPECT_EQ(exported_packets(), 35u);
+}
+
+TEST_F(FlowCacheTest, FullCacheEvictsStalestFlow) {
+    FlowCacheOptions options;
+    options.capacity = 16;
+    options.max_probe = 16;
+    FlowCache cache(options, [this](const FlowRecord& record) { records.push_back(record); });
+
+    for (uint32_t flow = 0; flow < 16; ++flow) {
+        cache.update(make_packet(flow, 100, (flow + 1) * MS));
+    }
+    // Flow 0 is seen again, so flow 1 is the stalest
+    cache.update(make_packet(0, 100, 20 * MS));
+    EXPECT_TRUE(records.empty());
+    cache.update(make_packet(16, 100, 21 * MS));
+
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_EQ(records[0].reason, FlowExportReason::EVICTED);
+    EXPECT_EQ(records[0].key.src_port, 10001);
+    auto stats = cache.get_statistics();
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_DOUBLE_EQ(stats.eviction_rate, 1.0 / 17.0);
+    EXPECT_EQ(cache.size(), 16u);
+}
+
+TEST_F(FlowCacheTest, RemovalKeepsOtherFlowsReachable) {
+    FlowCacheOptions options;
+    options.capacity = 256;
+    options.max_probe = 256;
+    options.idle_timeout_ms = 100;
+    FlowCache cache(options, [this](const FlowRecord& record) { records.push_back(record); });
+    // Dense table with long probe runs; odd flows go idle
+    for (uint32_t flow = 0; flow < 200; ++flow) {
+        cache.update(make_packet(flow, 100, flow % 2 ? 0 : 90 * MS));
+    }
+    cache.expire(150 * MS);
+    EXPECT_EQ(records.size(), 100u);
+    EXPECT_EQ(cache.size(), 100u);
+
+    auto before = cache.get_statistics();
+    for (uint32_t flow = 0; flow < 200; flow += 2) {
+        cache.update(make_packet(flow, 100, 160 * MS));
+    }
+    auto after = cache.get_statistics();
+    EXPECT_EQ(after.hits - before.hits, 100u);
+    EXPECT_EQ(after.misses, before.misses);
+
+    cache.flush();
+    EXPECT_EQ(exported_packets(), 300u);
+}
+
+TEST_F(FlowCacheTest, BurstsMatchSinglePacketsAndSweep) {
+    std::vector<PacketDescriptor> packets;
+    for (uint64_t i = 0; i < 20000; ++i) {
+        packets.push_back(make_packet(static_cast<uint32_t>(i * 7919 % 3000), 64, i * MS / 100));
+    }
+    auto run_bursts = [&](FlowCache& cache) {
+        for (size_t i = 0; i < packets.size(); i += MAX_BURST_SIZE) {
+            cache.update_burst(&packets[i], std::min(MAX_BURST_SIZE, packets.size() - i));
+        }
+    };
+
+    FlowCache single = make_cache(4096);
+    FlowCache burst = make_cache(4096);
+    for (const auto& packet : packets) {
+        single.update(packet);
+    }
+    run_bursts(burst);
+    EXPECT_EQ(burst.get_statistics().hits, single.get_statistics().hits);
+    EXPECT_EQ(burst.get_statistics().misses, single.get_statistics().misses);
+    EXPECT_GT(burst.get_statistics().ns_per_packet, 0.0);
+
+    // Time moves 200 ms; with a 10 ms idle timeout the sweep exports flows on its own
+    records.clear();
+    FlowCache swept = make_cache(4096, 60000, 10);
+    run_bursts(swept);
+    EXPECT_GT(swept.get_statistics().idle_timeouts, 0u);
+    swept.flush();
+    EXPECT_EQ(exported_packets(), packets.size());
+}
+
+TEST_F(FlowCacheTest, ConvertsToPacketFlowRows) {
+    FlowCache cache = make_cache(16);
+    uint64_t now = packet_clock_ns();
+    cache.update(make_packet(1, 100, now));
+    cache.update(make_packet(1, 200, now + 250 * MS));
+    cache.flush();
+    ASSERT_EQ(records.size(), 1u);
+
+    PacketFlow flow = to_packet_flow(records[0], "r1");
+    EXPECT_EQ(flow.src_ip, "10.0.0.1");
+    EXPECT_EQ(flow.dst_ip, "10.16.0.1");
+    EXPECT_EQ(flow.src_port, 10001);
+    EXPECT_EQ(flow.dst_port, 443);
+    EXPECT_EQ(flow.protocol, 6);
+    EXPECT_EQ(flow.packets, 2u);
+    EXPECT_EQ(flow.bytes, 300u);
+    EXPECT_EQ(flow.duration_ms, 250u);
+    EXPECT_EQ(flow.router_id, "r1");
+    // Wall clock, in milliseconds
+    EXPECT_GT(flow.timestamp, 1600000000000ull);
+}
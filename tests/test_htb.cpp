@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+#include "traffic_shaping.h"
+#include "traffic_shaping/htb.h"
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <thread>
+
+using namespace RouterSim;
+
+namespace {
+
+const uint64_t MBPS = 1000000;
+
+HTBClassConfig make_class(uint32_t class_id, uint32_t parent_id, uint64_t rate, uint64_t ceil) {
+    HTBClassConfig config;
+    config.class_id = class_id;
+    config.parent_id = parent_id;
+    config.rate = rate;
+    config.ceil = ceil;
+    return config;
+}
+
+// Drains the tree over a simulated link, keeping the listed leaves
+// backlogged, and returns the rate each leaf achieved in bits per second
+std::map<uint32_t, double> run_link(HierarchicalTokenBucket& tree, uint64_t link_rate,
+                                    const std::vector<uint32_t>& backlogged, double seconds) {
+    std::map<uint32_t, uint64_t> queued;
+    std::map<uint32_t, uint64_t> bytes;
+    uint64_t now = 0;
+    uint64_t end = static_cast<uint64_t>(seconds * 1e9);
+
+    while (now < end) {
+        for (uint32_t leaf : backlogged) {
+            while (queued[leaf] < 8) {
+                PacketDescriptor packet{};
+                packet.size = 1500;
+                packet.priority = leaf;
+                EXPECT_TRUE(tree.enqueue_packet(packet, leaf, now));
+                queued[leaf]++;
+            }
+        }
+
+        PacketDescriptor packet;
+        if (tree.dequeue_packet(packet, now)) {
+            queued[packet.priority]--;
+            bytes[packet.priority] += packet.size;
+            now += packet.size * 8 * 1000000000ULL / link_rate;
+        } else {
+            uint64_t wake = tree.next_wakeup_ns();
+            now = wake > now ? wake : now + 1000;
+        }
+    }
+
+    std::map<uint32_t, double> rates;
+    for (const auto& [leaf, sent] : bytes) {
+        rates[leaf] = sent * 8.0 / seconds;
+    }
+    return rates;
+}
+
+} // namespace
+
+TEST(HierarchicalTokenBucketTest, RejectsInvalidTrees) {
+    HierarchicalTokenBucket tree;
+    EXPECT_TRUE(tree.add_class(make_class(1, 0, 100 * MBPS, 0)));
+    EXPECT_FALSE(tree.add_class(make_class(1, 0, 100 * MBPS, 0)));      // duplicate
+    EXPECT_FALSE(tree.add_class(make_class(2, 9, 10 * MBPS, 0)));       // unknown parent
+    EXPECT_FALSE(tree.add_class(make_class(0, 1, 10 * MBPS, 0)));       // reserved id
+    EXPECT_FALSE(tree.add_class(make_class(3, 1, 0, 0)));               // no rate
+    EXPECT_TRUE(tree.add_class(make_class(2, 1, 10 * MBPS, 0)));
+
+    // Only leaves queue packets
+    PacketDescriptor packet{};
+    packet.size = 100;
+    EXPECT_FALSE(tree.enqueue_packet(packet, 1, 0));
+    EXPECT_TRUE(tree.enqueue_packet(packet, 2, 0));
+    EXPECT_FALSE(tree.add_class(make_class(4, 2, 1 * MBPS, 0)));        // leaf has packets
+}
+
+TEST(HierarchicalTokenBucketTest, GuaranteedRatesAndBorrowing) {
+    HierarchicalTokenBucket tree;
+    ASSERT_TRUE(tree.initialize({make_class(1, 0, 100 * MBPS, 100 * MBPS),
+                                 make_class(10, 1, 30 * MBPS, 100 * MBPS),
+                                 make_class(11, 1, 70 * MBPS, 100 * MBPS)}));
+
+    // Both busy: each gets its rate
+    auto rates = run_link(tree, 100 * MBPS, {10, 11}, 1.0);
+    EXPECT_NEAR(rates[10] / MBPS, 30, 2);
+    EXPECT_NEAR(rates[11] / MBPS, 70, 2);
+
+    // Alone, a leaf borrows the idle sibling's bandwidth up to its ceil
+    HierarchicalTokenBucket solo;
+    ASSERT_TRUE(solo.initialize({make_class(1, 0, 100 * MBPS, 100 * MBPS),
+                                 make_class(10, 1, 30 * MBPS, 100 * MBPS),
+                                 make_class(11, 1, 70 * MBPS, 100 * MBPS)}));
+    rates = run_link(solo, 100 * MBPS, {10}, 1.0);
+    EXPECT_NEAR(rates[10] / MBPS, 100, 2);
+    EXPECT_GT(solo.get_statistics().class_statistics[1].packets_borrowed, 0u);
+}
+
+TEST(HierarchicalTokenBucketTest, CeilCapsBorrowing) {
+    HierarchicalTokenBucket tree;
+    ASSERT_TRUE(tree.initialize({make_class(1, 0, 100 * MBPS, 100 * MBPS),
+                                 make_class(10, 1, 10 * MBPS, 20 * MBPS)}));
+
+    auto rates = run_link(tree, 100 * MBPS, {10}, 1.0);
+    EXPECT_NEAR(rates[10] / MBPS, 20, 1);
+}
+
+TEST(HierarchicalTokenBucketTest, TenantHierarchy) {
+    // interface -> two tenants -> classes; tenant 3 is capped at its rate
+    std::vector<HTBClassConfig> classes = {
+        make_class(1, 0, 100 * MBPS, 100 * MBPS),
+        make_class(2, 1, 50 * MBPS, 100 * MBPS),
+        make_class(3, 1, 50 * MBPS, 50 * MBPS),
+        make_class(20, 2, 10 * MBPS, 100 * MBPS),
+        make_class(21, 2, 40 * MBPS, 100 * MBPS),
+        make_class(30, 3, 50 * MBPS, 50 * MBPS),
+    };
+
+    for (uint32_t batch : {0u, HierarchicalTokenBucket::DEFAULT_CHARGE_BATCH_BYTES}) {
+        HierarchicalTokenBucket tree(batch);
+        ASSERT_TRUE(tree.initialize(classes));
+
+        auto rates = run_link(tree, 100 * MBPS, {20, 21, 30}, 1.0);
+        EXPECT_NEAR((rates[20] + rates[21]) / MBPS, 50, 2);
+        EXPECT_NEAR(rates[20] / MBPS, 10, 2);
+        EXPECT_NEAR(rates[30] / MBPS, 50, 2);
+
+        // With tenant 3 idle, tenant 2 borrows the whole link; the spare
+        // is shared equally (same quantum) on top of each class's rate
+        HierarchicalTokenBucket idle_tree(batch);
+        ASSERT_TRUE(idle_tree.initialize(classes));
+        rates = run_link(idle_tree, 100 * MBPS, {20, 21}, 1.0);
+        EXPECT_NEAR((rates[20] + rates[21]) / MBPS, 100, 2);
+        EXPECT_GT(rates[20] / MBPS, 20);
+    }
+}
+
+TEST(HierarchicalTokenBucketTest, InnerClassesCountPacketsSentThrough) {
+    for (uint32_t batch : {0u, HierarchicalTokenBucket::DEFAULT_CHARGE_BATCH_BYTES}) {
+        HierarchicalTokenBucket tree(batch);
+        ASSERT_TRUE(tree.initialize({make_class(1, 0, 100 * MBPS, 100 * MBPS),
+                                     make_class(10, 1, 50 * MBPS, 100 * MBPS),
+                                     make_class(11, 1, 50 * MBPS, 100 * MBPS)}));
+
+        auto rates = run_link(tree, 100 * MBPS, {10, 11}, 0.1);
+        EXPECT_GT(rates[10], 0);
+        EXPECT_GT(rates[11], 0);
+
+        // Drain what is still queued so every charge has reached the parent
+        uint64_t now = 100000000;
+        PacketDescriptor packet;
+        while (tree.get_statistics().queue_length > 0) {
+            if (!tree.dequeue_packet(packet, now)) {
+                now = std::max(now + 1000, tree.next_wakeup_ns());
+            }
+        }
+
+        std::map<uint32_t, HTBClassStatistics> by_class;
+        for (const auto& class_stats : tree.get_statistics().class_statistics) {
+            by_class[class_stats.class_id] = class_stats;
+        }
+        EXPECT_GT(by_class[10].packets_sent, 0u);
+        EXPECT_GT(by_class[11].packets_sent, 0u);
+        EXPECT_EQ(by_class[1].packets_sent, by_class[10].packets_sent + by_class[11].packets_sent);
+        EXPECT_EQ(by_class[1].bytes_sent, by_class[10].bytes_sent + by_class[11].bytes_sent);
+    }
+}
+
+TEST(HierarchicalTokenBucketTest, ManagerShapesInterfaceWithTree) {
+    TrafficShapingManager manager;
+    ASSERT_TRUE(manager.add_interface("eth0"));
+    EXPECT_FALSE(manager.configure_htb("eth1", {make_class(1, 0, 100 * MBPS, 0)}));
+    ASSERT_TRUE(manager.configure_htb("eth0", {make_class(1, 0, 100 * MBPS, 0),
+                                               make_class(7, 1, 10 * MBPS, 0)}));
+
+    PacketDescriptor packet{};
+    packet.size = 500;
+    packet.priority = 7;
+    EXPECT_TRUE(manager.process_packet("eth0", packet));
+    packet.priority = 8;
+    EXPECT_FALSE(manager.process_packet("eth0", packet));
+
+    PacketDescriptor out;
+    ASSERT_TRUE(manager.dequeue_packet("eth0", out));
+    EXPECT_EQ(out.priority, 7u);
+
+    auto stats = manager.get_interface_statistics();
+    EXPECT_EQ(stats["eth0"].packets_processed, 1u);
+    EXPECT_EQ(stats["eth0"].packets_dropped, 1u);
+}
+
+TEST(HierarchicalTokenBucketTest, ManagerReleasesShapedPacketsWhenEligible) {
+    TrafficShapingManager manager;
+    ASSERT_TRUE(manager.initialize());
+    ASSERT_TRUE(manager.add_interface("eth0"));
+
+    // 8 Mb/s with a one-packet burst: 1000-byte packets leave 1 ms apart
+    HTBClassConfig root = make_class(1, 0, 8 * MBPS, 8 * MBPS);
+    HTBClassConfig leaf = make_class(2, 1, 8 * MBPS, 8 * MBPS);
+    root.burst = root.cburst = leaf.burst = leaf.cburst = 1000;
+    ASSERT_TRUE(manager.configure_htb("eth0", {root, leaf}));
+
+    std::mutex mutex;
+    std::vector<uint64_t> released_ns;
+    manager.set_packet_callback([&](const PacketInfo&) {
+        std::lock_guard<std::mutex> lock(mutex);
+        released_ns.push_back(packet_clock_ns());
+    });
+    ASSERT_TRUE(manager.start());
+
+    uint64_t start_ns = packet_clock_ns();
+    PacketDescriptor packet{};
+    packet.size = 1000;
+    packet.priority = 2;
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(manager.process_packet("eth0", packet));
+    }
+
+    for (int i = 0; i < 2000; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (released_ns.size() == 5) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    manager.stop();
+
+    // The shaper, not the release loop, sets the pace: never faster than
+    // the rate allows, and every packet eventually goes out
+    ASSERT_EQ(released_ns.size(), 5u);
+    EXPECT_GE(released_ns.back() - start_ns, 2500000u);
+    EXPECT_EQ(manager.get_interface_statistics()["eth0"].packets_processed, 5u);
+}
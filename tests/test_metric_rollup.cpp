@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "analytics/metric_rollup.h"
+#include "analytics/flow_cache.h"
+#include <vector>
+
+using namespace RouterSim;
+
+namespace {
+
+NetworkMetric make_metric(uint64_t timestamp, const std::string& interface, const std::string& type, double value) {
+    NetworkMetric metric;
+    metric.timestamp = timestamp;
+    metric.router_id = "r1";
+    metric.interface = interface;
+    metric.metric_type = type;
+    metric.value = value;
+    return metric;
+}
+
+class MetricRollupTest : public ::testing::Test {
+protected:
+    std::vector<MetricRollup> rows;
+
+    MetricRollupAggregator make_aggregator(uint32_t window_ms = 1000) {
+        MetricRollupOptions options;
+        options.window_ms = window_ms;
+        return MetricRollupAggregator(options, [this](const MetricRollup& row) { rows.push_back(row); });
+    }
+};
+
+} // namespace
+
+TEST_F(MetricRollupTest, OneRowPerSeriesAndWindow) {
+    MetricRollupAggregator aggregator = make_aggregator();
+    // 1..1000 microseconds of latency on eth0, constant queue depth on eth1
+    for (uint64_t i = 0; i < 1000; ++i) {
+        aggregator.add(make_metric(5000 + i, "eth0", "latency_us", double(i + 1)));
+        aggregator.add(make_metric(5000 + i, "eth1", "queue_depth", 7.0));
+    }
+    EXPECT_TRUE(rows.empty());
+
+    aggregator.advance(6000);
+    ASSERT_EQ(rows.size(), 2u);
+    const MetricRollup& latency = rows[0].interface == "eth0" ? rows[0] : rows[1];
+    EXPECT_EQ(latency.timestamp, 5000u);
+    EXPECT_EQ(latency.window_ms, 1000u);
+    EXPECT_EQ(latency.metric_type, "latency_us");
+    EXPECT_EQ(latency.count, 1000u);
+    EXPECT_DOUBLE_EQ(latency.sum, 500500.0);
+    EXPECT_DOUBLE_EQ(latency.min, 1.0);
+    EXPECT_DOUBLE_EQ(latency.max, 1000.0);
+    EXPECT_NEAR(latency.p50, 500.0, 5.0);
+    EXPECT_NEAR(latency.p99, 990.0, 9.9);
+    EXPECT_NEAR(latency.p999, 999.0, 10.0);
+    EXPECT_EQ(latency.unique_flows, 0u);
+
+    // The stored sketch answers the same quantiles
+    DDSketch sketch;
+    ASSERT_TRUE(sketch.deserialize(latency.quantile_sketch.data(), latency.quantile_sketch.size()));
+    EXPECT_EQ(sketch.count(), 1000u);
+    EXPECT_NEAR(sketch.quantile(0.99), latency.p99, latency.p99 * 0.01);
+
+    const MetricRollup& depth = rows[0].interface == "eth1" ? rows[0] : rows[1];
+    EXPECT_DOUBLE_EQ(depth.p50, 7.0);
+    EXPECT_DOUBLE_EQ(depth.p999, 7.0);
+    EXPECT_EQ(aggregator.get_statistics().rollups_emitted, 2u);
+}
+
+TEST_F(MetricRollupTest, LaterSampleClosesWindowAndLateOnesAreDropped) {
+    MetricRollupAggregator aggregator = make_aggregator();
+    aggregator.add(make_metric(100, "eth0", "rx_bytes", 10.0));
+    aggregator.add(make_metric(900, "eth0", "rx_bytes", 20.0));
+    aggregator.add(make_metric(1500, "eth0", "rx_bytes", 30.0));
+    ASSERT_EQ(rows.size(), 1u);
+    EXPECT_EQ(rows[0].timestamp, 0u);
+    EXPECT_EQ(rows[0].count, 2u);
+    EXPECT_DOUBLE_EQ(rows[0].sum, 30.0);
+
+    // Its window was already emitted
+    aggregator.add(make_metric(950, "eth0", "rx_bytes", 40.0));
+    EXPECT_EQ(aggregator.get_statistics().late_samples, 1u);
+
+    aggregator.flush();
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_EQ(rows[1].timestamp, 1000u);
+    EXPECT_DOUBLE_EQ(rows[1].sum, 30.0);
+}
+
+TEST_F(MetricRollupTest, OutOfOrderSampleBeforeOpenWindowIsDropped) {
+    MetricRollupAggregator aggregator = make_aggregator();
+    aggregator.add(make_metric(1500, "eth0", "rx_bytes", 10.0));
+    // Window 0 was never emitted, but the series has moved on to 1000
+    aggregator.add(make_metric(500, "eth0", "rx_bytes", 20.0));
+    EXPECT_EQ(aggregator.get_statistics().late_samples, 1u);
+
+    aggregator.flush();
+    ASSERT_EQ(rows.size(), 1u);
+    EXPECT_EQ(rows[0].timestamp, 1000u);
+    EXPECT_EQ(rows[0].count, 1u);
+    EXPECT_DOUBLE_EQ(rows[0].sum, 10.0);
+}
+
+TEST_F(MetricRollupTest, LateSampleForForgottenSeriesIsDropped) {
+    MetricRollupAggregator aggregator = make_aggregator();
+    aggregator.add(make_metric(100, "eth0", "rx_bytes", 10.0));
+    aggregator.advance(1000);
+    ASSERT_EQ(rows.size(), 1u);
+    aggregator.advance(2000);
+    EXPECT_EQ(aggregator.get_statistics().series, 0u);
+
+    // Its window was flushed and the series forgotten since
+    aggregator.add(make_metric(500, "eth0", "rx_bytes", 20.0));
+    aggregator.add(make_metric(1500, "eth1", "rx_bytes", 30.0));
+    EXPECT_EQ(aggregator.get_statistics().late_samples, 2u);
+    EXPECT_EQ(aggregator.get_statistics().series, 0u);
+
+    aggregator.add(make_metric(2100, "eth0", "rx_bytes", 40.0));
+    aggregator.flush();
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_EQ(rows[1].timestamp, 2000u);
+    EXPECT_DOUBLE_EQ(rows[1].sum, 40.0);
+}
+
+TEST_F(MetricRollupTest, CountsUniqueFlowsPerInterface) {
+    MetricRollupAggregator aggregator = make_aggregator();
+    for (uint32_t i = 0; i < 30000; ++i) {
+        PacketDescriptor packet{};
+        packet.set_ipv4(0x0a000001, 0x0a100000 + i % 5000);
+        packet.src_port = 1000;
+        packet.dst_port = 443;
+        packet.protocol = 6;
+        aggregator.add_flow("r1", i % 2 ? "eth0" : "eth1", 2000 + i % 1000, hash_flow_key(FlowKey::from_packet(packet)));
+    }
+    aggregator.advance(3000);
+
+    ASSERT_EQ(rows.size(), 2u);
+    for (const auto& row : rows) {
+        EXPECT_EQ(row.metric_type, MetricRollupAggregator::UNIQUE_FLOWS);
+        EXPECT_EQ(row.count, 15000u);
+        // Each interface sees half of the 5000 flows
+        EXPECT_NEAR(double(row.unique_flows), 2500.0, 2500 * 0.05);
+        EXPECT_TRUE(row.quantile_sketch.empty());
+    }
+    EXPECT_EQ(aggregator.get_statistics().flow_samples, 30000u);
+
+    // Quiet series are forgotten on the next advance
+    aggregator.advance(4000);
+    EXPECT_EQ(aggregator.get_statistics().series, 0u);
+}
@@ -0,0 +1,292 @@
+#include <gtest/gtest.h>
+#include "netem/emulator.h"
+#include "netem/impairments.h"
+#include <algorithm>
+
+using namespace RouterSim;
+
+namespace {
+
+const uint64_t MS = 1000000;
+
+PacketInfo make_packet(uint64_t id, uint32_t size = 1000) {
+    PacketInfo packet;
+    packet.id = id;
+    packet.size = size;
+    return packet;
+}
+
+// Feeds count packets spaced gap_ns apart and drains everything
+std::vector<EmulatedPacket> run(NetemEmulator& emulator, uint32_t link, size_t count, uint64_t gap_ns) {
+    std::vector<EmulatedPacket> released;
+    for (size_t i = 0; i < count; ++i) {
+        emulator.enqueue(link, make_packet(i), i * gap_ns);
+        emulator.release(i * gap_ns, released);
+    }
+    emulator.release(UINT64_MAX, released);
+    return released;
+}
+
+} // namespace
+
+TEST(NetemEmulatorTest, SameSeedReproducesRun) {
+    ImpairmentInfo info;
+    info.has_delay = true;
+    info.delay.delay_ms = 10;
+    info.delay.jitter_ms = 5;
+    info.delay.distribution = DelayDistribution::NORMAL;
+    info.has_loss = true;
+    info.loss.loss_percentage = 10;
+    info.has_duplicate = true;
+    info.duplicate.duplicate_percentage = 5;
+
+    auto trace = [&](uint64_t seed, bool extra_link) {
+        NetemEmulator emulator(seed);
+        if (extra_link) {
+            // Other links must not perturb this one's random stream
+            uint32_t other = emulator.add_link("eth9", info);
+            emulator.enqueue(other, make_packet(99), 0);
+        }
+        uint32_t link = emulator.add_link("eth0", info);
+        std::vector<std::pair<uint64_t, uint64_t>> out;
+        for (const auto& packet : run(emulator, link, 2000, 100000)) {
+            if (packet.link_id == link) {
+                out.emplace_back(packet.packet.id, packet.release_ns);
+            }
+        }
+        return out;
+    };
+
+    EXPECT_EQ(trace(7, false), trace(7, false));
+    EXPECT_EQ(trace(7, false), trace(7, true));
+    EXPECT_NE(trace(7, false), trace(8, false));
+}
+
+TEST(NetemEmulatorTest, DelayAndJitterBounds) {
+    NetemEmulator emulator;
+    ImpairmentInfo info;
+    info.has_delay = true;
+    info.delay.delay_ms = 20;
+    info.delay.jitter_ms = 5;
+    uint32_t link = emulator.add_link("eth0", info, SIZE_MAX);
+
+    auto released = run(emulator, link, 5000, 10000);
+    ASSERT_EQ(released.size(), 5000u);
+
+    double sum = 0;
+    uint64_t last = 0;
+    for (const auto& packet : released) {
+        uint64_t delay = packet.release_ns - packet.packet.id * 10000;
+        EXPECT_GE(delay, 15 * MS);
+        EXPECT_LE(delay, 25 * MS);
+        EXPECT_GE(packet.release_ns, last);
+        last = packet.release_ns;
+        sum += delay;
+    }
+    EXPECT_NEAR(sum / released.size(), 20.0 * MS, 0.5 * MS);
+}
+
+TEST(NetemEmulatorTest, RandomLossAndGilbertElliottBursts) {
+    NetemEmulator emulator;
+    ImpairmentInfo random;
+    random.has_loss = true;
+    random.loss.loss_percentage = 4;
+    ImpairmentInfo gilbert;
+    gilbert.has_loss = true;
+    gilbert.loss.loss_type = LossType::GEMODEL;
+    gilbert.loss.p = 1;
+    gilbert.loss.r = 25;
+
+    // Loss rate and mean length of runs of consecutive losses
+    auto measure = [&](const std::string& name, const ImpairmentInfo& info) {
+        uint32_t link = emulator.add_link(name, info, SIZE_MAX);
+        size_t lost = 0, bursts = 0;
+        bool in_burst = false;
+        for (uint64_t i = 0; i < 200000; ++i) {
+            bool dropped = !emulator.enqueue(link, make_packet(i), 0);
+            lost += dropped;
+            bursts += dropped && !in_burst;
+            in_burst = dropped;
+        }
+        EXPECT_EQ(emulator.get_link_statistics(link).dropped_loss, lost);
+        return std::make_pair(lost / 200000.0, static_cast<double>(lost) / bursts);
+    };
+
+    auto [random_rate, random_burst] = measure("random", random);
+    EXPECT_NEAR(random_rate, 0.04, 0.005);
+    EXPECT_LT(random_burst, 1.2);
+
+    // Stationary loss p / (p + r) with bursts of 1 / r packets
+    auto [ge_rate, ge_burst] = measure("gemodel", gilbert);
+    EXPECT_NEAR(ge_rate, 1.0 / 26, 0.008);
+    EXPECT_NEAR(ge_burst, 4.0, 0.5);
+}
+
+TEST(NetemEmulatorTest, FourStateLossModel) {
+    NetemEmulator emulator;
+    ImpairmentInfo info;
+    info.has_loss = true;
+    info.loss.loss_type = LossType::STATE;
+    info.loss.p13 = 2;
+    info.loss.p31 = 50;
+    uint32_t link = emulator.add_link("eth0", info, SIZE_MAX);
+
+    size_t lost = 0;
+    for (uint64_t i = 0; i < 200000; ++i) {
+        lost += !emulator.enqueue(link, make_packet(i), 0);
+    }
+    // Good lasts 1/p13 packets, loss bursts 1/p31
+    EXPECT_NEAR(lost / 200000.0, 2.0 / 52, 0.006);
+}
+
+TEST(NetemEmulatorTest, DuplicateAndCorrupt) {
+    NetemEmulator emulator;
+    ImpairmentInfo info;
+    info.has_duplicate = true;
+    info.duplicate.duplicate_percentage = 10;
+    info.has_corrupt = true;
+    info.corrupt.corrupt_percentage = 5;
+    uint32_t link = emulator.add_link("eth0", info, SIZE_MAX);
+
+    auto released = run(emulator, link, 50000, 1000);
+    size_t duplicates = std::count_if(released.begin(), released.end(),
+                                      [](const EmulatedPacket& p) { return p.duplicate; });
+    size_t corrupted = std::count_if(released.begin(), released.end(),
+                                     [](const EmulatedPacket& p) { return p.corrupted; });
+
+    auto stats = emulator.get_link_statistics(link);
+    EXPECT_EQ(released.size(), 50000u + duplicates);
+    EXPECT_EQ(stats.duplicated, duplicates);
+    EXPECT_EQ(stats.corrupted, corrupted);
+    EXPECT_NEAR(duplicates / 50000.0, 0.10, 0.01);
+    EXPECT_NEAR(corrupted / static_cast<double>(released.size()), 0.05, 0.01);
+}
+
+TEST(NetemEmulatorTest, ReorderGapSendsEveryNthImmediately) {
+    NetemEmulator emulator;
+    ImpairmentInfo info;
+    info.has_delay = true;
+    info.delay.delay_ms = 10;
+    info.has_reorder = true;
+    info.reorder.reorder_type = ReorderType::GAP;
+    info.reorder.gap = 5;
+    uint32_t link = emulator.add_link("eth0", info);
+
+    auto released = run(emulator, link, 100, 1 * MS);
+    ASSERT_EQ(released.size(), 100u);
+    EXPECT_EQ(emulator.get_link_statistics(link).reordered, 20u);
+    for (const auto& packet : released) {
+        uint64_t sent = packet.packet.id * MS;
+        bool immediate = packet.packet.id % 5 == 4;
+        EXPECT_EQ(packet.release_ns, immediate ? sent : sent + 10 * MS) << packet.packet.id;
+    }
+    // Packet 4 overtakes packets 0-3
+    EXPECT_EQ(released[0].packet.id, 4u);
+}
+
+TEST(NetemEmulatorTest, RateLimitPacesAfterBurst) {
+    NetemEmulator emulator;
+    ImpairmentInfo info;
+    info.has_rate_limit = true;
+    info.rate_limit.rate_kbps = 8000;     // 1 ms per 1000-byte packet
+    info.rate_limit.burst_kb = 40;        // five packets
+    uint32_t link = emulator.add_link("eth0", info);
+
+    auto released = run(emulator, link, 20, 0);
+    ASSERT_EQ(released.size(), 20u);
+    for (size_t i = 0; i < released.size(); ++i) {
+        EXPECT_EQ(released[i].packet.id, i);
+        EXPECT_EQ(released[i].release_ns, i < 5 ? 0 : (i - 4) * MS);
+    }
+}
+
+TEST(NetemEmulatorTest, LimitAndLinkRemoval) {
+    NetemEmulator emulator;
+    ImpairmentInfo info;
+    info.has_delay = true;
+    info.delay.delay_ms = 1;
+    uint32_t first = emulator.add_link("eth0", info, 10);
+    uint32_t second = emulator.add_link("eth1", info, 10);
+    EXPECT_EQ(emulator.add_link("eth0", info), NetemEmulator::INVALID_LINK);
+
+    for (uint64_t i = 0; i < 15; ++i) {
+        emulator.enqueue(first, make_packet(i), 0);
+        emulator.enqueue(second, make_packet(i), 0);
+    }
+    EXPECT_EQ(emulator.get_link_statistics(first).dropped_limit, 5u);
+    EXPECT_EQ(emulator.queue_size(), 20u);
+    EXPECT_EQ(emulator.next_release_ns(), 1 * MS);
+
+    EXPECT_TRUE(emulator.remove_link(first));
+    EXPECT_EQ(emulator.find_link("eth0"), NetemEmulator::INVALID_LINK);
+    EXPECT_EQ(emulator.queue_size(), 10u);
+
+    // A new link reusing the slot does not inherit queued packets
+    uint32_t third = emulator.add_link("eth2", info, 10);
+    std::vector<EmulatedPacket> released;
+    EXPECT_EQ(emulator.release(1 * MS, released), 10u);
+    for (const auto& packet : released) {
+        EXPECT_EQ(packet.link_id, second);
+    }
+    EXPECT_EQ(emulator.get_link_statistics(third).packets_out, 0u);
+    EXPECT_EQ(emulator.next_release_ns(), 0u);
+}
+
+TEST(NetemEmulatorTest, ThousandsOfLinksShareOneReleaseOrder) {
+    NetemEmulator emulator;
+    const uint32_t links = 5000;
+    for (uint32_t i = 0; i < links; ++i) {
+        ImpairmentInfo info;
+        info.has_delay = true;
+        info.delay.delay_ms = 1 + i % 50;
+        emulator.add_link("veth" + std::to_string(i), info);
+    }
+    ASSERT_EQ(emulator.link_count(), links);
+
+    for (uint32_t i = 0; i < links; ++i) {
+        emulator.enqueue(i, make_packet(i), 0);
+    }
+
+    std::vector<EmulatedPacket> released;
+    for (uint64_t now = 0; now <= 50 * MS; now += MS) {
+        emulator.release(now, released);
+    }
+    ASSERT_EQ(released.size(), links);
+    for (size_t i = 1; i < released.size(); ++i) {
+        EXPECT_LE(released[i - 1].release_ns, released[i].release_ns);
+    }
+}
+
+TEST(NetemImpairmentsTest, AccumulatesImpairmentsOnInterface) {
+    NetemImpairments impairments(3);
+    EXPECT_FALSE(impairments.add_delay("eth0", DelayConfig{}));
+    ASSERT_TRUE(impairments.start());
+
+    DelayConfig delay;
+    delay.delay_ms = 5;
+    LossConfig loss;
+    loss.loss_percentage = 100;
+    ASSERT_TRUE(impairments.add_delay("eth0", delay));
+    ASSERT_TRUE(impairments.add_delay("eth1", delay));
+    ASSERT_TRUE(impairments.add_loss("eth1", loss));
+
+    ImpairmentInfo info = impairments.get_interface_impairments("eth1");
+    EXPECT_TRUE(info.has_delay);
+    EXPECT_TRUE(info.has_loss);
+    EXPECT_FALSE(impairments.process_packet("eth7", make_packet(0), 0));
+
+    EXPECT_TRUE(impairments.process_packet("eth0", make_packet(1), 0));
+    EXPECT_FALSE(impairments.process_packet("eth1", make_packet(2), 0));
+    EXPECT_EQ(impairments.next_release_ns(), 5 * MS);
+
+    std::vector<EmulatedPacket> released;
+    EXPECT_EQ(impairments.release_packets(5 * MS, released), 1u);
+    EXPECT_EQ(released[0].packet.id, 1u);
+    EXPECT_EQ(impairments.get_interface_statistics("eth1").dropped_loss, 1u);
+
+    EXPECT_TRUE(impairments.remove_impairment("eth0"));
+    EXPECT_FALSE(impairments.process_packet("eth0", make_packet(3), 0));
+    EXPECT_EQ(impairments.get_impaired_interfaces(), std::vector<std::string>({"eth1"}));
+    impairments.stop();
+    EXPECT_TRUE(impairments.get_impaired_interfaces().empty());
+}
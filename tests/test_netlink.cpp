@@ -0,0 +1,240 @@
+#include <gtest/gtest.h>
+#include "netem/mock_netlink_socket.h"
+#include "network_impairments.h"
+#include <cerrno>
+
+using namespace RouterSim;
+
+namespace {
+
+std::vector<std::string> make_interfaces(size_t count) {
+    std::vector<std::string> interfaces;
+    for (size_t i = 0; i < count; ++i) {
+        interfaces.push_back("veth" + std::to_string(i));
+    }
+    return interfaces;
+}
+
+ImpairmentInfo make_full_impairments() {
+    ImpairmentInfo info;
+    info.has_delay = true;
+    info.delay.delay_ms = 40;
+    info.delay.jitter_ms = 8;
+    info.delay.distribution = DelayDistribution::PARETONORMAL;
+    info.has_loss = true;
+    info.loss.loss_type = LossType::GEMODEL;
+    info.loss.p = 1.5;
+    info.loss.r = 30;
+    info.loss.h = 10;
+    info.loss.k = 99.5;
+    info.has_duplicate = true;
+    info.duplicate.duplicate_percentage = 0.5;
+    info.has_corrupt = true;
+    info.corrupt.corrupt_percentage = 0.1;
+    info.has_reorder = true;
+    info.reorder.reorder_type = ReorderType::GAP;
+    info.reorder.reorder_percentage = 25;
+    info.reorder.gap = 5;
+    info.has_rate_limit = true;
+    info.rate_limit.rate_kbps = 100000;
+    return info;
+}
+
+} // namespace
+
+TEST(NetemNetlinkTest, OptionsRoundTrip) {
+    ImpairmentInfo info = make_full_impairments();
+    std::vector<uint8_t> options;
+    NetemNetlinkBackend::encode_netem_options(info, 1000, options);
+
+    ImpairmentInfo decoded;
+    ASSERT_TRUE(NetemNetlinkBackend::decode_netem_options(options.data(), options.size(), decoded));
+    EXPECT_TRUE(decoded.has_delay);
+    EXPECT_EQ(decoded.delay.delay_ms, 40u);
+    EXPECT_EQ(decoded.delay.jitter_ms, 8u);
+    EXPECT_EQ(decoded.delay.distribution, DelayDistribution::PARETONORMAL);
+    EXPECT_EQ(decoded.loss.loss_type, LossType::GEMODEL);
+    EXPECT_NEAR(decoded.loss.p, 1.5, 1e-6);
+    EXPECT_NEAR(decoded.loss.r, 30, 1e-6);
+    EXPECT_NEAR(decoded.loss.h, 10, 1e-6);
+    EXPECT_NEAR(decoded.loss.k, 99.5, 1e-6);
+    EXPECT_NEAR(decoded.duplicate.duplicate_percentage, 0.5, 1e-6);
+    EXPECT_NEAR(decoded.corrupt.corrupt_percentage, 0.1, 1e-6);
+    EXPECT_EQ(decoded.reorder.reorder_type, ReorderType::GAP);
+    EXPECT_EQ(decoded.reorder.gap, 5u);
+    EXPECT_NEAR(decoded.reorder.reorder_percentage, 25, 1e-6);
+    EXPECT_EQ(decoded.rate_limit.rate_kbps, 100000u);
+
+    // Random and 4-state loss, uniform jitter, percentage reordering
+    ImpairmentInfo simple;
+    simple.has_delay = true;
+    simple.delay.delay_ms = 10;
+    simple.delay.jitter_ms = 1;
+    simple.has_loss = true;
+    simple.loss.loss_percentage = 3;
+    simple.has_reorder = true;
+    simple.reorder.reorder_percentage = 10;
+    options.clear();
+    NetemNetlinkBackend::encode_netem_options(simple, 1000, options);
+    ASSERT_TRUE(NetemNetlinkBackend::decode_netem_options(options.data(), options.size(), decoded));
+    EXPECT_EQ(decoded.delay.distribution, DelayDistribution::UNIFORM);
+    EXPECT_EQ(decoded.loss.loss_type, LossType::RANDOM);
+    EXPECT_NEAR(decoded.loss.loss_percentage, 3, 1e-6);
+    EXPECT_EQ(decoded.reorder.reorder_type, ReorderType::PERCENTAGE);
+    EXPECT_FALSE(decoded.has_duplicate);
+    EXPECT_FALSE(decoded.has_rate_limit);
+
+    simple.loss.loss_type = LossType::STATE;
+    simple.loss.p13 = 2;
+    simple.loss.p31 = 60;
+    options.clear();
+    NetemNetlinkBackend::encode_netem_options(simple, 1000, options);
+    ASSERT_TRUE(NetemNetlinkBackend::decode_netem_options(options.data(), options.size(), decoded));
+    EXPECT_EQ(decoded.loss.loss_type, LossType::STATE);
+    EXPECT_NEAR(decoded.loss.p13, 2, 1e-6);
+    EXPECT_NEAR(decoded.loss.p31, 60, 1e-6);
+    EXPECT_NEAR(decoded.loss.p23, 100, 1e-6);
+
+    EXPECT_FALSE(NetemNetlinkBackend::decode_netem_options(options.data(), 8, decoded));
+}
+
+TEST(NetemNetlinkTest, BatchesManyInterfacesAndReadsBack) {
+    auto interfaces = make_interfaces(500);
+    auto socket = std::make_unique<MockNetlinkSocket>(interfaces);
+    MockNetlinkSocket* mock = socket.get();
+    NetemNetlinkBackend backend(std::move(socket));
+    ASSERT_TRUE(backend.refresh_interfaces());
+    EXPECT_EQ(backend.get_interfaces().size(), 500u);
+    EXPECT_EQ(backend.get_ifindex("veth0"), 1);
+
+    ImpairmentInfo info;
+    info.has_delay = true;
+    info.delay.delay_ms = 20;
+    for (const auto& interface : interfaces) {
+        info.delay.jitter_ms = interface.size() % 3;
+        backend.queue_apply(interface, info);
+    }
+    // A later change replaces the queued one
+    info.delay.delay_ms = 99;
+    backend.queue_apply("veth7", info);
+    EXPECT_EQ(backend.pending_changes(), 500u);
+
+    uint64_t datagrams = mock->datagrams_received();
+    ASSERT_TRUE(backend.commit());
+    EXPECT_EQ(mock->netem_qdisc_count(), 500u);
+    EXPECT_LE(mock->datagrams_received() - datagrams, 4u);
+
+    std::vector<QdiscState> qdiscs;
+    ASSERT_TRUE(backend.dump_qdiscs(qdiscs));
+    ASSERT_EQ(qdiscs.size(), 500u);
+    for (const auto& qdisc : qdiscs) {
+        EXPECT_EQ(qdisc.kind, "netem");
+        EXPECT_EQ(qdisc.impairments.delay.delay_ms, qdisc.interface == "veth7" ? 99u : 20u);
+    }
+
+    QdiscState state;
+    ASSERT_TRUE(backend.remove("veth3"));
+    ASSERT_TRUE(backend.get_qdisc("veth3", state));
+    EXPECT_EQ(state.kind, "noqueue");
+    // Removing again is not an error
+    EXPECT_TRUE(backend.remove("veth3"));
+}
+
+TEST(NetemNetlinkTest, ReportsPerInterfaceFailures) {
+    auto socket = std::make_unique<MockNetlinkSocket>(make_interfaces(10));
+    socket->fail_interface("veth4", EPERM);
+    MockNetlinkSocket* mock = socket.get();
+    NetemNetlinkBackend backend(std::move(socket));
+
+    ImpairmentInfo info;
+    info.has_loss = true;
+    info.loss.loss_percentage = 1;
+    for (const auto& interface : make_interfaces(10)) {
+        backend.queue_apply(interface, info);
+    }
+    backend.queue_apply("missing0", info);
+
+    std::vector<std::string> failed;
+    EXPECT_FALSE(backend.commit(&failed));
+    std::sort(failed.begin(), failed.end());
+    EXPECT_EQ(failed, std::vector<std::string>({"missing0", "veth4"}));
+    EXPECT_EQ(mock->netem_qdisc_count(), 9u);
+    EXPECT_EQ(backend.pending_changes(), 0u);
+}
+
+TEST(NetemNetlinkTest, NetemImpairmentsScenarioIsOneBatch) {
+    auto socket = std::make_unique<MockNetlinkSocket>(std::vector<std::string>{"lo", "eth0", "eth1", "eth2"});
+    MockNetlinkSocket* mock = socket.get();
+    NetemImpairments impairments(std::move(socket));
+    ASSERT_TRUE(impairments.start());
+    EXPECT_TRUE(impairments.is_kernel_backed());
+
+    uint64_t datagrams = mock->datagrams_received();
+    ASSERT_TRUE(impairments.apply_scenario("unreliable_network"));
+    EXPECT_EQ(mock->datagrams_received() - datagrams, 1u);
+    EXPECT_EQ(mock->netem_qdisc_count(), 3u);
+    EXPECT_EQ(impairments.get_impaired_interfaces(), std::vector<std::string>({"eth0", "eth1", "eth2"}));
+
+    std::vector<QdiscState> qdiscs;
+    ASSERT_TRUE(impairments.read_kernel_qdiscs(qdiscs));
+    for (const auto& qdisc : qdiscs) {
+        if (qdisc.interface == "lo") {
+            EXPECT_EQ(qdisc.kind, "noqueue");
+            continue;
+        }
+        EXPECT_EQ(qdisc.impairments.delay.delay_ms, 50u);
+        EXPECT_NEAR(qdisc.impairments.loss.loss_percentage, 2.0, 1e-6);
+        EXPECT_NEAR(qdisc.impairments.duplicate.duplicate_percentage, 1.0, 1e-6);
+    }
+
+    // Single changes go out immediately
+    DelayConfig delay;
+    delay.delay_ms = 7;
+    ASSERT_TRUE(impairments.add_delay("eth1", delay));
+    EXPECT_FALSE(impairments.add_delay("eth9", delay));
+    ASSERT_TRUE(impairments.remove_impairment("eth0"));
+    EXPECT_EQ(mock->netem_qdisc_count(), 2u);
+
+    // A removal the kernel refuses leaves the interface tracked
+    mock->fail_interface("eth2", EPERM);
+    EXPECT_FALSE(impairments.remove_impairment("eth2"));
+    EXPECT_EQ(impairments.get_impaired_interfaces(), std::vector<std::string>({"eth1", "eth2"}));
+    mock->fail_interface("eth2", 0);
+    ASSERT_TRUE(impairments.remove_impairment("eth2"));
+    EXPECT_EQ(mock->netem_qdisc_count(), 1u);
+
+    impairments.stop();
+    EXPECT_EQ(mock->netem_qdisc_count(), 0u);
+}
+
+TEST(NetworkImpairmentsTest, AppliesAndReadsBackOverNetlink) {
+    auto socket = std::make_unique<MockNetlinkSocket>(make_interfaces(200));
+    MockNetlinkSocket* mock = socket.get();
+    NetworkImpairments impairments(std::move(socket));
+    EXPECT_FALSE(impairments.applyDelay("veth0", 10));
+    ASSERT_TRUE(impairments.initialize());
+    EXPECT_EQ(impairments.getNetworkInterfaces().size(), 200u);
+
+    ImpairmentConfig config;
+    config.delay_ms = 30;
+    config.jitter_ms = 3;
+    config.loss_percentage = 1.5;
+    uint64_t datagrams = mock->datagrams_received();
+    ASSERT_TRUE(impairments.applyComplexImpairment(make_interfaces(200), config));
+    EXPECT_EQ(mock->datagrams_received() - datagrams, 1u);
+    EXPECT_EQ(mock->netem_qdisc_count(), 200u);
+
+    // Individual calls build on the interface's configuration
+    ASSERT_TRUE(impairments.applyDuplication("veth1", 2));
+    EXPECT_EQ(impairments.getInterfaceStatus("veth1"), "netem delay 30ms 3ms loss 1.5% duplicate 2%");
+    EXPECT_EQ(impairments.getInterfaceStatus("nope"), "unknown");
+
+    auto stats = impairments.getStatistics();
+    EXPECT_TRUE(stats.enabled);
+    EXPECT_EQ(stats.interface_stats.size(), 200u);
+
+    ASSERT_TRUE(impairments.clearImpairments("veth1"));
+    EXPECT_EQ(impairments.getInterfaceStatus("veth1"), "noqueue");
+    ASSERT_TRUE(impairments.clearAllImpairments());
+    EXPECT_EQ(mock->netem_qdisc_count(), 0u);
+}
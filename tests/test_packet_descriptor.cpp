@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include "common_types.h"
+#include "traffic_shaping.h"
+#include "traffic_shaping/wfq.h"
+#include <thread>
+#include <vector>
+
+using namespace RouterSim;
+
+TEST(PacketDescriptorTest, Layout) {
+    EXPECT_EQ(sizeof(PacketDescriptor), 64u);
+    EXPECT_EQ(alignof(PacketDescriptor), 64u);
+    EXPECT_TRUE(std::is_trivially_copyable<PacketDescriptor>::value);
+}
+
+TEST(PacketDescriptorTest, RoundTripIpv4) {
+    PacketInfo packet;
+    packet.id = 42;
+    packet.size = 1500;
+    packet.priority = 3;
+    packet.src_ip = "192.168.1.10";
+    packet.dst_ip = "10.0.0.1";
+    packet.src_port = 12345;
+    packet.dst_port = 443;
+    packet.protocol = 6;
+    packet.dscp = 46;
+
+    PacketDescriptor descriptor = to_packet_descriptor(packet);
+    EXPECT_TRUE(descriptor.is_ipv4());
+    EXPECT_EQ(descriptor.src_ipv4(), 0xC0A8010Au);
+    EXPECT_EQ(descriptor.dst_ipv4(), 0x0A000001u);
+    EXPECT_EQ(descriptor.dst_port, 443);
+
+    PacketInfo back = to_packet_info(descriptor);
+    EXPECT_EQ(back.id, packet.id);
+    EXPECT_EQ(back.size, packet.size);
+    EXPECT_EQ(back.src_ip, packet.src_ip);
+    EXPECT_EQ(back.dst_ip, packet.dst_ip);
+    EXPECT_EQ(back.dst_port, packet.dst_port);
+    EXPECT_EQ(back.dscp, packet.dscp);
+    EXPECT_EQ(back.timestamp, packet.timestamp);
+}
+
+TEST(PacketDescriptorTest, RoundTripIpv6) {
+    PacketInfo packet;
+    packet.src_ip = "2001:db8::1";
+    packet.dst_ip = "2001:db8::2";
+
+    PacketDescriptor descriptor = to_packet_descriptor(packet);
+    EXPECT_EQ(descriptor.ip_version, 6);
+    EXPECT_EQ(to_packet_info(descriptor).dst_ip, "2001:db8::2");
+}
+
+TEST(PacketDescriptorTest, WeightedFairQueueStoresDescriptors) {
+    WeightedFairQueue wfq;
+    WFQClass wfq_class;
+    wfq_class.class_id = 1;
+    wfq_class.weight = 4;
+    ASSERT_TRUE(wfq.initialize({wfq_class}));
+
+    PacketDescriptor descriptor{};
+    descriptor.set_ipv4(0x01020304, 0x05060708);
+    descriptor.id = 7;
+    descriptor.size = 100;
+    ASSERT_TRUE(wfq.enqueue_packet(descriptor, 1));
+
+    PacketDescriptor out{};
+    ASSERT_TRUE(wfq.dequeue_packet(out));
+    EXPECT_EQ(out.id, 7u);
+    EXPECT_EQ(out.dst_ipv4(), 0x05060708u);
+    EXPECT_TRUE(wfq.is_empty());
+}
+
+TEST(PacketDescriptorTest, TrafficShaperBurstVerdicts) {
+    TrafficShaper shaper;
+    shaper.initialize();
+    shaper.setTokenBucketConfig(1000, 0, 1500);
+    shaper.setEnabled(true);
+
+    PacketDescriptor packets[3] = {};
+    for (auto& packet : packets) {
+        packet.set_ipv4(0x0A000001, 0x0A000002);
+        packet.size = 400;
+    }
+
+    BurstVerdict verdicts;
+    EXPECT_EQ(shaper.processBurst(packets, 3, verdicts), 2u);
+    EXPECT_TRUE(verdicts.test(0));
+    EXPECT_TRUE(verdicts.test(1));
+    EXPECT_FALSE(verdicts.test(2));
+
+    auto stats = shaper.getStatistics();
+    EXPECT_EQ(stats.total_packets_processed, 2u);
+    EXPECT_EQ(stats.packets_dropped, 1u);
+}
+
+TEST(PacketDescriptorTest, BurstEntryPointsStopAtMaxBurstSize) {
+    std::vector<PacketDescriptor> packets(MAX_BURST_SIZE + 44);
+    for (auto& packet : packets) {
+        packet.set_ipv4(0x0A000001, 0x0A000002);
+        packet.size = 10;
+    }
+
+    TokenBucket bucket(1000000, 0, 1000000);
+    BurstVerdict verdicts;
+    EXPECT_EQ(bucket.consumeBurst(packets.data(), packets.size(), verdicts), MAX_BURST_SIZE);
+    EXPECT_TRUE(verdicts.all());
+    EXPECT_EQ(bucket.getStatistics().total_packets_processed, MAX_BURST_SIZE);
+
+    WFQ wfq(4);
+    EXPECT_EQ(wfq.enqueueBurst(packets.data(), packets.size(), verdicts), MAX_BURST_SIZE);
+}
+
+TEST(PacketDescriptorTest, TokenBucketBurstSizeBoundsTheDepth) {
+    TokenBucket bucket(1000, 0, 500);
+    EXPECT_EQ(bucket.getAvailableTokens(), 500u);
+    EXPECT_FALSE(bucket.consume(600));
+    EXPECT_TRUE(bucket.consume(400));
+    EXPECT_EQ(bucket.getAvailableTokens(), 100u);
+
+    // Raising it keeps what is left; no burst size is the capacity
+    bucket.setBurstSize(0);
+    EXPECT_EQ(bucket.getAvailableTokens(), 100u);
+    bucket.setBurstSize(50);
+    EXPECT_EQ(bucket.getAvailableTokens(), 50u);
+    EXPECT_FALSE(bucket.consume(60));
+}
+
+TEST(PacketDescriptorTest, TokenBucketChargesFractionalCostsExactly) {
+    // 3 tokens a second: a token costs a third of a second, not a whole number of ticks
+    TokenBucket bucket(3, 3, 3);
+    EXPECT_TRUE(bucket.consume(1));
+    EXPECT_TRUE(bucket.consume(1));
+    EXPECT_TRUE(bucket.consume(1));
+    EXPECT_FALSE(bucket.consume(1));
+}
+
+TEST(PacketDescriptorTest, TokenBucketStatisticsExactUnderContention) {
+    // Rate 0: only the initial capacity is ever available
+    TokenBucket bucket(100000, 0, 100000);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 8; ++t) {
+        workers.emplace_back([&bucket]() {
+            for (int i = 0; i < 5000; ++i) {
+                bucket.consume(10);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    auto stats = bucket.getStatistics();
+    EXPECT_EQ(stats.total_packets_processed + stats.packets_dropped, 40000u);
+    EXPECT_EQ(stats.total_packets_processed, 10000u);
+    EXPECT_EQ(stats.total_bytes_processed, 100000u);
+    EXPECT_EQ(stats.bytes_dropped, 300000u);
+    EXPECT_EQ(bucket.getAvailableTokens(), 0u);
+}
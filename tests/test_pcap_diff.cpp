@@ -0,0 +1,274 @@
+#include <gtest/gtest.h>
+#include "testing/flow_aligner.h"
+#include <algorithm>
+
+using namespace RouterSim;
+
+namespace {
+
+// Packet `sequence` of TCP flow `flow`
+PcapPacketInfo make_packet(uint32_t flow, uint32_t sequence) {
+    PcapPacketInfo packet;
+    packet.src_ip = "10.0." + std::to_string(flow / 256) + "." + std::to_string(flow % 256);
+    packet.dst_ip = "10.1.0.1";
+    packet.protocol = 6;
+    packet.src_port = static_cast<uint16_t>(10000 + flow);
+    packet.dst_port = 443;
+    packet.ip_id = sequence & 0xffff;
+    packet.tcp_seq = sequence * 1448;
+    packet.tcp_ack = 1;
+    packet.size = 1500;
+    packet.timestamp = std::chrono::system_clock::time_point(std::chrono::microseconds(sequence));
+    return packet;
+}
+
+// Interleaves `flows` flows round robin
+PcapData make_capture(uint32_t flows, uint32_t packets) {
+    PcapData data;
+    for (uint32_t i = 0; i < packets; ++i) {
+        data.packets.push_back(make_packet(i % flows, i / flows));
+        data.packets.back().packet_number = i + 1;
+    }
+    data.stats.total_packets = packets;
+    data.stats.total_bytes = uint64_t(packets) * 1500;
+    data.stats.protocol_counts[6] = packets;
+    return data;
+}
+
+void refresh_statistics(PcapData& data) {
+    data.stats = PcapStatistics{};
+    for (const auto& packet : data.packets) {
+        data.stats.total_packets++;
+        data.stats.total_bytes += packet.size;
+        data.stats.protocol_counts[packet.protocol]++;
+    }
+}
+
+PcapDiffOptions flow_options() {
+    PcapDiffOptions options;
+    options.mode = PcapDiffMode::BY_FLOW;
+    options.timestamp_tolerance_us = UINT64_MAX;
+    return options;
+}
+
+size_t count_type(const std::vector<PcapDifference>& differences, const std::string& type) {
+    return std::count_if(differences.begin(), differences.end(),
+                         [&](const PcapDifference& difference) { return difference.type == type; });
+}
+
+} // namespace
+
+TEST(PcapFlowAlignerTest, MatchesIdenticalStreams) {
+    size_t matched = 0, unmatched = 0, reordered = 0;
+    PcapFlowAligner aligner(
+        1024,
+        [&](const PcapPacketInfo& first, uint64_t first_index, const PcapPacketInfo& second, uint64_t second_index,
+            bool is_reordered) {
+            EXPECT_EQ(first_index, second_index);
+            EXPECT_EQ(first.tcp_seq, second.tcp_seq);
+            matched++;
+            reordered += is_reordered;
+        },
+        [&](PcapFlowAligner::Side, const PcapPacketInfo&, uint64_t) { unmatched++; });
+
+    PcapData capture = make_capture(16, 5000);
+    for (const auto& packet : capture.packets) {
+        aligner.add(PcapFlowAligner::FIRST, packet);
+        aligner.add(PcapFlowAligner::SECOND, packet);
+    }
+    aligner.finish();
+    EXPECT_EQ(matched, 5000u);
+    EXPECT_EQ(unmatched, 0u);
+    EXPECT_EQ(reordered, 0u);
+    EXPECT_EQ(aligner.pending(), 0u);
+    EXPECT_EQ(aligner.active_flows(), 0u);
+}
+
+TEST(PcapFlowAlignerTest, MemoryStaysWithinWindow) {
+    const size_t window = 256;
+    size_t missing = 0;
+    PcapFlowAligner aligner(
+        window, [](const PcapPacketInfo&, uint64_t, const PcapPacketInfo&, uint64_t, bool) {},
+        [&](PcapFlowAligner::Side side, const PcapPacketInfo&, uint64_t) {
+            EXPECT_EQ(side, PcapFlowAligner::FIRST);
+            missing++;
+        });
+
+    // The second capture loses every 100th packet
+    for (uint32_t i = 0; i < 200000; ++i) {
+        PcapPacketInfo packet = make_packet(i % 1000, i / 1000);
+        aligner.add(PcapFlowAligner::FIRST, packet);
+        if (i % 100 != 0) {
+            aligner.add(PcapFlowAligner::SECOND, packet);
+        }
+        EXPECT_LE(aligner.active_flows(), 4 * window);
+    }
+    EXPECT_LE(aligner.peak_pending(), 2 * window);
+    aligner.finish();
+    EXPECT_EQ(missing, 2000u);
+}
+
+TEST(PcapDiffFlowTest, SingleLossIsOneDifference) {
+    PcapData first = make_capture(50, 10000);
+    PcapData second = first;
+    second.packets.erase(second.packets.begin() + 123);
+    refresh_statistics(second);
+
+    PcapDiff diff;
+    PcapDiffOptions by_index;
+    by_index.timestamp_tolerance_us = UINT64_MAX;
+    EXPECT_FALSE(diff.compare_pcap_data(first, second, by_index));
+    EXPECT_GT(diff.get_differences().size(), 1000u);
+
+    EXPECT_FALSE(diff.compare_pcap_data(first, second, flow_options()));
+    auto differences = diff.get_differences();
+    EXPECT_EQ(count_type(differences, "Missing Packet"), 1u);
+    EXPECT_EQ(count_type(differences, "Extra Packet"), 0u);
+    EXPECT_EQ(count_type(differences, "Packet Reordered"), 0u);
+    EXPECT_EQ(count_type(differences, "Packet Count Mismatch"), 1u);
+    auto missing = std::find_if(differences.begin(), differences.end(),
+                                [](const PcapDifference& difference) { return difference.type == "Missing Packet"; });
+    EXPECT_EQ(missing->packet_index, 123u);
+
+    auto summary = diff.get_summary();
+    EXPECT_EQ(summary.matched, 9999u);
+    EXPECT_EQ(summary.missing, 1u);
+    EXPECT_EQ(summary.modified, 0u);
+}
+
+TEST(PcapDiffFlowTest, ReportsInsertionsReorderingAndChanges) {
+    PcapData first = make_capture(8, 4000);
+    PcapData second = first;
+
+    // Move one packet of flow 3 behind the next two of the same flow
+    std::swap(second.packets[3 + 8 * 10], second.packets[3 + 8 * 12]);
+    std::swap(second.packets[3 + 8 * 10], second.packets[3 + 8 * 11]);
+    // Swap packets of different flows: not a reordering within either
+    std::swap(second.packets[500], second.packets[501]);
+    // A duplicate and a packet from an unknown flow
+    second.packets.insert(second.packets.begin() + 1000, second.packets[990]);
+    second.packets.insert(second.packets.begin() + 2000, make_packet(99, 0));
+    refresh_statistics(second);
+
+    PcapDiff diff;
+    EXPECT_FALSE(diff.compare_pcap_data(first, second, flow_options()));
+    auto differences = diff.get_differences();
+    EXPECT_EQ(count_type(differences, "Missing Packet"), 0u);
+    EXPECT_EQ(count_type(differences, "Extra Packet"), 2u);
+    EXPECT_EQ(count_type(differences, "Packet Reordered"), 1u);
+    auto summary = diff.get_summary();
+    EXPECT_EQ(summary.matched, 4000u);
+    EXPECT_EQ(summary.extra, 2u);
+    EXPECT_EQ(summary.reordered, 1u);
+    EXPECT_EQ(summary.modified, 0u);
+
+    second.packets[3000].size = 64;
+    EXPECT_FALSE(diff.compare_pcap_data(first, second, flow_options()));
+    EXPECT_EQ(diff.get_summary().modified, 1u);
+    EXPECT_EQ(count_type(diff.get_differences(), "Packet Size Mismatch"), 1u);
+}
+
+TEST(PcapDiffFlowTest, MatchesPacketsWithoutIdentityByShape) {
+    // IPv6 UDP carries neither IP ID nor sequence numbers
+    PcapData first;
+    for (uint32_t i = 0; i < 600; ++i) {
+        PcapPacketInfo packet;
+        packet.src_ip = "2001:db8::" + std::to_string(1 + i % 3);
+        packet.dst_ip = "2001:db8::ff";
+        packet.protocol = 17;
+        packet.src_port = 5000;
+        packet.dst_port = 5001;
+        packet.size = 100 + i % 7;
+        first.packets.push_back(packet);
+    }
+    refresh_statistics(first);
+    PcapData second = first;
+    second.packets.erase(second.packets.begin() + 300);
+    refresh_statistics(second);
+
+    PcapDiff diff;
+    EXPECT_FALSE(diff.compare_pcap_data(first, second, flow_options()));
+    auto summary = diff.get_summary();
+    EXPECT_EQ(summary.missing, 1u);
+    EXPECT_EQ(summary.extra, 0u);
+    EXPECT_EQ(summary.matched, 599u);
+}
+
+TEST(PcapDiffFlowTest, CapsStoredDifferences) {
+    PcapData first = make_capture(4, 2000);
+    PcapData second;
+    refresh_statistics(second);
+
+    PcapDiffOptions options = flow_options();
+    options.max_differences = 100;
+    PcapDiff diff;
+    EXPECT_FALSE(diff.compare_pcap_data(first, second, options));
+    EXPECT_EQ(diff.get_differences().size(), 100u);
+    auto summary = diff.get_summary();
+    EXPECT_EQ(summary.missing, 2000u);
+    EXPECT_GT(summary.differences_dropped, 1900u);
+
+    EXPECT_TRUE(diff.compare_pcap_data(first, first, options));
+    EXPECT_EQ(diff.get_summary().matched, 2000u);
+}
+
+TEST(PcapDiffParallelTest, ResultsDoNotDependOnThreadCount) {
+    PcapData first = make_capture(37, 30000);
+    PcapData second = first;
+    for (size_t i = 29000; i >= 997; i -= 997) {
+        second.packets.erase(second.packets.begin() + i);
+    }
+    std::swap(second.packets[5 + 37 * 100], second.packets[5 + 37 * 102]);
+    second.packets.insert(second.packets.begin() + 20000, second.packets[19990]);
+    second.packets[12345].size = 64;
+    second.packets[25000].dscp = 46;
+    refresh_statistics(second);
+
+    for (PcapDiffMode mode : {PcapDiffMode::BY_INDEX, PcapDiffMode::BY_FLOW}) {
+        for (size_t limit : {size_t(0), size_t(25)}) {
+            PcapDiffOptions options = flow_options();
+            options.mode = mode;
+            options.max_differences = limit;
+            options.alignment_window = 2048;
+
+            PcapDiff reference;
+            reference.compare_pcap_data(first, second, options);
+            auto expected = reference.get_differences();
+            auto expected_summary = reference.get_summary();
+            ASSERT_FALSE(expected.empty());
+
+            for (size_t threads : {2, 4, 8}) {
+                options.threads = threads;
+                PcapDiff diff;
+                EXPECT_FALSE(diff.compare_pcap_data(first, second, options));
+                auto differences = diff.get_differences();
+                ASSERT_EQ(differences.size(), expected.size()) << threads << " threads";
+                for (size_t i = 0; i < expected.size(); ++i) {
+                    EXPECT_EQ(differences[i].type, expected[i].type);
+                    EXPECT_EQ(differences[i].packet_index, expected[i].packet_index);
+                    EXPECT_EQ(differences[i].description, expected[i].description);
+                }
+                auto summary = diff.get_summary();
+                EXPECT_EQ(summary.matched, expected_summary.matched);
+                EXPECT_EQ(summary.modified, expected_summary.modified);
+                EXPECT_EQ(summary.missing, expected_summary.missing);
+                EXPECT_EQ(summary.extra, expected_summary.extra);
+                EXPECT_EQ(summary.reordered, expected_summary.reordered);
+                EXPECT_EQ(summary.differences_dropped, expected_summary.differences_dropped);
+            }
+        }
+    }
+}
+
+TEST(PcapDiffParallelTest, IdenticalCapturesMatchOnEveryWorker) {
+    PcapData capture = make_capture(64, 20000);
+    PcapDiffOptions options = flow_options();
+    options.threads = 4;
+    PcapDiff diff;
+    EXPECT_TRUE(diff.compare_pcap_data(capture, capture, options));
+    EXPECT_EQ(diff.get_summary().matched, 20000u);
+
+    options.mode = PcapDiffMode::BY_INDEX;
+    EXPECT_TRUE(diff.compare_pcap_data(capture, capture, options));
+    EXPECT_EQ(diff.get_summary().matched, 20000u);
+}
@@ -0,0 +1,390 @@
+#include <gtest/gtest.h>
+#include "testing/pcap_reader.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+using namespace RouterSim;
+
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+void put16be(Bytes& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void put32(Bytes& out, uint32_t value, bool big_endian) {
+    for (int i = 0; i < 4; ++i) {
+        int shift = big_endian ? 24 - 8 * i : 8 * i;
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+void put16(Bytes& out, uint16_t value, bool big_endian) {
+    if (big_endian) {
+        put16be(out, value);
+    } else {
+        out.push_back(static_cast<uint8_t>(value));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+    }
+}
+
+void pad4(Bytes& out) {
+    while (out.size() % 4) {
+        out.push_back(0);
+    }
+}
+
+// TCP (6) or UDP (17) header with only the ports filled in
+Bytes transport(uint8_t protocol, uint16_t src_port, uint16_t dst_port) {
+    Bytes out;
+    put16be(out, src_port);
+    put16be(out, dst_port);
+    out.resize(protocol == 6 ? 20 : 8, 0);
+    return out;
+}
+
+Bytes ipv4(const uint8_t src[4], const uint8_t dst[4], uint8_t protocol, const Bytes& payload,
+           uint8_t dscp = 0, uint8_t ttl = 64) {
+    Bytes out = {0x45, static_cast<uint8_t>(dscp << 2)};
+    put16be(out, static_cast<uint16_t>(20 + payload.size()));
+    out.insert(out.end(), {0, 1, 0, 0, ttl, protocol, 0, 0});
+    out.insert(out.end(), src, src + 4);
+    out.insert(out.end(), dst, dst + 4);
+    out.insert(out.end(), payload.begin(), payload.end());
+    return out;
+}
+
+// IPv6 with a hop-by-hop options header in front of the transport header
+Bytes ipv6_with_hop_by_hop(uint8_t protocol, const Bytes& payload, uint8_t dscp, uint8_t hop_limit) {
+    uint8_t traffic_class = static_cast<uint8_t>(dscp << 2);
+    Bytes out = {static_cast<uint8_t>(0x60 | traffic_class >> 4), static_cast<uint8_t>(traffic_class << 4), 0, 0};
+    put16be(out, static_cast<uint16_t>(8 + payload.size()));
+    out.push_back(0);    // hop-by-hop
+    out.push_back(hop_limit);
+    Bytes src(16, 0), dst(16, 0);
+    src[0] = 0x20; src[1] = 0x01; src[2] = 0x0d; src[3] = 0xb8; src[15] = 1;
+    dst[0] = 0x20; dst[1] = 0x01; dst[2] = 0x0d; dst[3] = 0xb8; dst[15] = 2;
+    out.insert(out.end(), src.begin(), src.end());
+    out.insert(out.end(), dst.begin(), dst.end());
+    out.insert(out.end(), {protocol, 0, 1, 4, 0, 0, 0, 0});
+    out.insert(out.end(), payload.begin(), payload.end());
+    return out;
+}
+
+Bytes ethernet(uint16_t ethertype, const Bytes& payload, bool vlan = false) {
+    Bytes out(12, 0x02);
+    if (vlan) {
+        put16be(out, 0x8100);
+        put16be(out, 100);
+    }
+    put16be(out, ethertype);
+    out.insert(out.end(), payload.begin(), payload.end());
+    return out;
+}
+
+struct Frame {
+    uint64_t timestamp_ns;
+    Bytes data;
+    uint32_t original_length;
+};
+
+Bytes pcap_file(const std::vector<Frame>& frames, uint32_t link_type, bool big_endian, bool nanosecond) {
+    Bytes out;
+    put32(out, nanosecond ? 0xa1b23c4d : 0xa1b2c3d4, big_endian);
+    put16(out, 2, big_endian);
+    put16(out, 4, big_endian);
+    put32(out, 0, big_endian);
+    put32(out, 0, big_endian);
+    put32(out, 65535, big_endian);
+    put32(out, link_type, big_endian);
+    for (const auto& frame : frames) {
+        put32(out, static_cast<uint32_t>(frame.timestamp_ns / 1000000000), big_endian);
+        uint64_t fraction = frame.timestamp_ns % 1000000000;
+        put32(out, static_cast<uint32_t>(nanosecond ? fraction : fraction / 1000), big_endian);
+        put32(out, static_cast<uint32_t>(frame.data.size()), big_endian);
+        put32(out, frame.original_length, big_endian);
+        out.insert(out.end(), frame.data.begin(), frame.data.end());
+    }
+    return out;
+}
+
+void pcapng_block(Bytes& out, uint32_t type, const Bytes& body, bool big_endian) {
+    uint32_t length = static_cast<uint32_t>(12 + ((body.size() + 3) & ~size_t(3)));
+    put32(out, type, big_endian);
+    put32(out, length, big_endian);
+    out.insert(out.end(), body.begin(), body.end());
+    pad4(out);
+    put32(out, length, big_endian);
+}
+
+void pcapng_section(Bytes& out, bool big_endian) {
+    Bytes body;
+    put32(body, 0x1a2b3c4d, big_endian);
+    put16(body, 1, big_endian);
+    put16(body, 0, big_endian);
+    put32(body, 0xffffffff, big_endian);
+    put32(body, 0xffffffff, big_endian);
+    pcapng_block(out, 0x0a0d0d0a, body, big_endian);
+}
+
+void pcapng_interface(Bytes& out, uint16_t link_type, uint32_t snap_length, int tsresol, bool big_endian) {
+    Bytes body;
+    put16(body, link_type, big_endian);
+    put16(body, 0, big_endian);
+    put32(body, snap_length, big_endian);
+    if (tsresol >= 0) {
+        put16(body, 9, big_endian);
+        put16(body, 1, big_endian);
+        body.push_back(static_cast<uint8_t>(tsresol));
+        pad4(body);
+    }
+    put16(body, 0, big_endian);
+    put16(body, 0, big_endian);
+    pcapng_block(out, 1, body, big_endian);
+}
+
+void pcapng_enhanced(Bytes& out, uint32_t interface_id, uint64_t units, const Bytes& data, bool big_endian) {
+    Bytes body;
+    put32(body, interface_id, big_endian);
+    put32(body, static_cast<uint32_t>(units >> 32), big_endian);
+    put32(body, static_cast<uint32_t>(units), big_endian);
+    put32(body, static_cast<uint32_t>(data.size()), big_endian);
+    put32(body, static_cast<uint32_t>(data.size()), big_endian);
+    body.insert(body.end(), data.begin(), data.end());
+    pcapng_block(out, 6, body, big_endian);
+}
+
+std::string write_file(const std::string& name, const Bytes& contents) {
+    std::string path = ::testing::TempDir() + name;
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(contents.data()), contents.size());
+    return path;
+}
+
+const uint8_t HOST_A[4] = {10, 0, 0, 1};
+const uint8_t HOST_B[4] = {192, 168, 100, 254};
+
+std::vector<Frame> sample_frames() {
+    return {
+        {1700000000123456000ull, ethernet(0x0800, ipv4(HOST_A, HOST_B, 6, transport(6, 40000, 443), 46, 63)), 0},
+        {1700000000223456000ull, ethernet(0x0800, ipv4(HOST_B, HOST_A, 17, transport(17, 53, 5353)), true), 0},
+        {1700000000323456000ull, ethernet(0x86dd, ipv6_with_hop_by_hop(17, transport(17, 123, 124), 10, 7)), 0},
+        {1700000000423456000ull, ethernet(0x0806, Bytes(28, 0)), 0},
+    };
+}
+
+} // namespace
+
+TEST(PcapReaderTest, ReadsPcapInBothByteOrders) {
+    auto frames = sample_frames();
+    frames[0].original_length = 1500;    // snapped
+    for (bool big_endian : {false, true}) {
+        for (bool nanosecond : {false, true}) {
+            std::string path = write_file("pcap_reader_test.pcap", pcap_file(frames, 1, big_endian, nanosecond));
+            PcapReader reader;
+            ASSERT_TRUE(reader.open(path));
+            EXPECT_EQ(reader.format(), PcapReader::Format::PCAP);
+
+            PcapPacketInfo packet;
+            ASSERT_TRUE(reader.next(packet));
+            EXPECT_EQ(packet.packet_number, 1u);
+            EXPECT_EQ(packet.src_ip, "10.0.0.1");
+            EXPECT_EQ(packet.dst_ip, "192.168.100.254");
+            EXPECT_EQ(packet.protocol, 6);
+            EXPECT_EQ(packet.src_port, 40000);
+            EXPECT_EQ(packet.dst_port, 443);
+            EXPECT_EQ(packet.dscp, 46);
+            EXPECT_EQ(packet.ttl, 63);
+            EXPECT_EQ(packet.size, 1500u);
+            EXPECT_TRUE(packet.data.empty());
+            EXPECT_EQ(std::chrono::duration_cast<std::chrono::microseconds>(
+                          packet.timestamp.time_since_epoch()).count(), 1700000000123456);
+
+            // VLAN-tagged UDP, kept with its bytes
+            ASSERT_TRUE(reader.next(packet, true));
+            EXPECT_EQ(packet.src_ip, "192.168.100.254");
+            EXPECT_EQ(packet.protocol, 17);
+            EXPECT_EQ(packet.src_port, 53);
+            EXPECT_EQ(packet.dst_port, 5353);
+            EXPECT_EQ(packet.data, frames[1].data);
+
+            ASSERT_TRUE(reader.next(packet));
+            EXPECT_EQ(packet.src_ip, "2001:db8::1");
+            EXPECT_EQ(packet.dst_ip, "2001:db8::2");
+            EXPECT_EQ(packet.protocol, 17);
+            EXPECT_EQ(packet.src_port, 123);
+            EXPECT_EQ(packet.dscp, 10);
+            EXPECT_EQ(packet.ttl, 7);
+
+            // ARP: counted, but nothing to decode
+            ASSERT_TRUE(reader.next(packet));
+            EXPECT_TRUE(packet.src_ip.empty());
+            EXPECT_EQ(packet.protocol, 0);
+            EXPECT_EQ(packet.src_port, 0);
+
+            EXPECT_FALSE(reader.next(packet));
+            EXPECT_FALSE(reader.truncated());
+            EXPECT_EQ(reader.records_read(), 4u);
+            EXPECT_EQ(reader.bytes_read(), reader.file_size());
+            std::remove(path.c_str());
+        }
+    }
+}
+
+TEST(PcapReaderTest, ReadsPcapngSectionsAndInterfaces) {
+    auto frames = sample_frames();
+    Bytes file;
+    pcapng_section(file, false);
+    pcapng_interface(file, 1, 0, -1, false);       // Ethernet, microseconds
+    pcapng_interface(file, 101, 0, 9, false);      // raw IP, nanoseconds
+    pcapng_enhanced(file, 0, 1700000000123456ull, frames[0].data, false);
+    pcapng_enhanced(file, 1, 1700000000987654321ull,
+                    ipv4(HOST_A, HOST_B, 17, transport(17, 1000, 2000)), false);
+    pcapng_block(file, 5, Bytes(20, 0), false);    // statistics block, skipped
+
+    // A big-endian section restarts interface numbering
+    pcapng_section(file, true);
+    pcapng_interface(file, 1, 64, 0x80 | 20, true);    // 2^-20 s
+    Bytes simple;
+    put32(simple, static_cast<uint32_t>(frames[2].data.size()), true);
+    simple.insert(simple.end(), frames[2].data.begin(), frames[2].data.end());
+    pcapng_block(file, 3, simple, true);
+    pcapng_enhanced(file, 0, 3ull << 20 | 1ull << 19, frames[1].data, true);
+
+    std::string path = write_file("pcap_reader_test.pcapng", file);
+    PcapReader reader;
+    ASSERT_TRUE(reader.open(path));
+    EXPECT_EQ(reader.format(), PcapReader::Format::PCAPNG);
+
+    PcapRecord record;
+    PcapPacketInfo packet;
+    ASSERT_TRUE(reader.next_record(record));
+    EXPECT_EQ(record.timestamp_ns, 1700000000123456000ull);
+    EXPECT_EQ(record.link_type, 1u);
+    ASSERT_TRUE(PcapReader::decode(record, packet));
+    EXPECT_EQ(packet.dst_port, 443);
+
+    ASSERT_TRUE(reader.next_record(record));
+    EXPECT_EQ(record.interface_id, 1u);
+    EXPECT_EQ(record.timestamp_ns, 1700000000987654321ull);
+    ASSERT_TRUE(PcapReader::decode(record, packet));
+    EXPECT_EQ(packet.src_port, 1000);
+
+    // Simple packet block, cut to the interface's 64-byte snap length
+    ASSERT_TRUE(reader.next_record(record));
+    EXPECT_EQ(record.captured_length, 64u);
+    EXPECT_EQ(record.original_length, frames[2].data.size());
+    ASSERT_TRUE(PcapReader::decode(record, packet));
+    EXPECT_EQ(packet.src_ip, "2001:db8::1");
+
+    ASSERT_TRUE(reader.next_record(record));
+    EXPECT_EQ(record.timestamp_ns, 3500000000ull);
+
+    EXPECT_FALSE(reader.next_record(record));
+    EXPECT_FALSE(reader.truncated());
+
+    reader.rewind();
+    EXPECT_TRUE(reader.next(packet));
+    EXPECT_EQ(packet.packet_number, 1u);
+    std::remove(path.c_str());
+}
+
+TEST(PcapReaderTest, StopsAtTruncatedRecord) {
+    Bytes file = pcap_file(sample_frames(), 1, false, false);
+    file.resize(file.size() - 10);
+    std::string path = write_file("pcap_reader_truncated.pcap", file);
+
+    PcapReader reader;
+    ASSERT_TRUE(reader.open(path));
+    PcapPacketInfo packet;
+    size_t count = 0;
+    while (reader.next(packet)) {
+        count++;
+    }
+    EXPECT_EQ(count, 3u);
+    EXPECT_TRUE(reader.truncated());
+    std::remove(path.c_str());
+
+    path = write_file("pcap_reader_garbage.pcap", Bytes(64, 0x55));
+    EXPECT_FALSE(reader.open(path));
+    EXPECT_FALSE(reader.open(::testing::TempDir() + "does_not_exist.pcap"));
+    std::remove(path.c_str());
+}
+
+TEST(PcapReaderTest, DecodesOtherLinkTypes) {
+    Bytes ip = ipv4(HOST_A, HOST_B, 6, transport(6, 22, 2222));
+    PcapPacketInfo packet;
+    PcapRecord record;
+
+    Bytes cooked(14, 0);
+    put16be(cooked, 0x0800);
+    cooked.insert(cooked.end(), ip.begin(), ip.end());
+    record.data = cooked.data();
+    record.captured_length = static_cast<uint32_t>(cooked.size());
+    record.link_type = static_cast<uint32_t>(LinkType::LINUX_SLL);
+    ASSERT_TRUE(PcapReader::decode(record, packet));
+    EXPECT_EQ(packet.dst_port, 2222);
+
+    Bytes loopback = {2, 0, 0, 0};
+    loopback.insert(loopback.end(), ip.begin(), ip.end());
+    record.data = loopback.data();
+    record.captured_length = static_cast<uint32_t>(loopback.size());
+    record.link_type = static_cast<uint32_t>(LinkType::NULL_LOOPBACK);
+    ASSERT_TRUE(PcapReader::decode(record, packet));
+    EXPECT_EQ(packet.src_port, 22);
+
+    // Cut inside the TCP header: IP fields only
+    record.data = ip.data();
+    record.captured_length = 22;
+    record.link_type = static_cast<uint32_t>(LinkType::RAW);
+    ASSERT_TRUE(PcapReader::decode(record, packet));
+    EXPECT_EQ(packet.src_ip, "10.0.0.1");
+    EXPECT_EQ(packet.src_port, 0);
+
+    record.link_type = 147;    // user-defined
+    EXPECT_FALSE(PcapReader::decode(record, packet));
+}
+
+TEST(PcapReaderTest, PcapDiffComparesFiles) {
+    auto frames = sample_frames();
+    std::string first = write_file("pcap_diff_a.pcap", pcap_file(frames, 1, false, false));
+    std::string same = write_file("pcap_diff_b.pcapng", [&] {
+        Bytes file;
+        pcapng_section(file, false);
+        pcapng_interface(file, 1, 0, -1, false);
+        for (const auto& frame : frames) {
+            pcapng_enhanced(file, 0, frame.timestamp_ns / 1000, frame.data, false);
+        }
+        return file;
+    }());
+
+    PcapDiff diff;
+    EXPECT_TRUE(diff.compare_pcaps(first, same));
+    EXPECT_TRUE(diff.get_differences().empty());
+
+    frames[1].data = ethernet(0x0800, ipv4(HOST_B, HOST_A, 17, transport(17, 53, 5354)), true);
+    frames.pop_back();
+    std::string changed = write_file("pcap_diff_c.pcap", pcap_file(frames, 1, true, true));
+    EXPECT_FALSE(diff.compare_pcaps(first, changed));
+    auto differences = diff.get_differences();
+    ASSERT_FALSE(differences.empty());
+    EXPECT_EQ(differences[0].type, "Packet Count Mismatch");
+    bool port_mismatch = false;
+    for (const auto& difference : differences) {
+        port_mismatch |= difference.type == "Destination Port Mismatch" && difference.packet_index == 1;
+    }
+    EXPECT_TRUE(port_mismatch);
+
+    PcapData data;
+    ASSERT_TRUE(diff.read_pcap_file(first, data));
+    EXPECT_EQ(data.packets.size(), 4u);
+    EXPECT_EQ(data.stats.total_packets, 4u);
+    EXPECT_EQ(data.stats.protocol_counts[17], 2u);
+
+    std::remove(first.c_str());
+    std::remove(same.c_str());
+    std::remove(changed.c_str());
+}
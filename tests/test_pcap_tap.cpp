@@ -0,0 +1,218 @@
+#include <gtest/gtest.h>
+#include "testing/pcap_tap.h"
+#include "testing/pcap_reader.h"
+#include "traffic_shaping.h"
+#include <cstdio>
+#include <map>
+#include <thread>
+#include <unistd.h>
+
+using namespace RouterSim;
+
+namespace {
+
+std::string temp_path(const char* name) {
+    return "/tmp/" + std::string(name) + "_" + std::to_string(getpid()) + ".pcapng";
+}
+
+PacketDescriptor make_packet(uint64_t id, uint32_t size, uint8_t protocol) {
+    PacketDescriptor packet{};
+    packet.set_ipv4(0x0a000001, 0x0a000002 + static_cast<uint32_t>(id % 7));
+    packet.id = id;
+    packet.size = size;
+    packet.protocol = protocol;
+    packet.src_port = 1000;
+    packet.dst_port = static_cast<uint16_t>(2000 + id % 100);
+    packet.dscp = 46;
+    packet.timestamp_ns = packet_clock_ns();
+    return packet;
+}
+
+// Records per pcapng interface
+std::map<uint32_t, uint64_t> count_records(const std::string& path) {
+    std::map<uint32_t, uint64_t> counts;
+    PcapReader reader;
+    if (!reader.open(path)) {
+        return counts;
+    }
+    PcapRecord record;
+    while (reader.next_record(record)) {
+        counts[record.interface_id]++;
+    }
+    EXPECT_FALSE(reader.truncated());
+    return counts;
+}
+
+} // namespace
+
+TEST(PcapTapTest, WritesDecodablePcapng) {
+    std::string path = temp_path("pcap_tap_decode");
+    PcapTap tap;
+    PcapTapOptions options;
+    options.snaplen = 100;
+    ASSERT_TRUE(tap.start(path, options));
+
+    PacketDescriptor tcp = make_packet(0x12345, 1500, 6);
+    PacketDescriptor udp = make_packet(2, 60, 17);
+    PacketDescriptor v6{};
+    IpAddress src, dst;
+    ASSERT_TRUE(parse_ip_address("2001:db8::1", src));
+    ASSERT_TRUE(parse_ip_address("2001:db8::2", dst));
+    v6.src_addr = src;
+    v6.dst_addr = dst;
+    v6.ip_version = 6;
+    v6.protocol = 17;
+    v6.size = 200;
+    v6.src_port = 53;
+    v6.dst_port = 5353;
+
+    EXPECT_TRUE(tap.capture(CaptureStage::PRE_SHAPING, tcp));
+    EXPECT_TRUE(tap.capture(CaptureStage::POST_SHAPING, udp));
+    EXPECT_TRUE(tap.capture(CaptureStage::DROPPED, v6));
+    EXPECT_TRUE(tap.stop());
+    EXPECT_FALSE(tap.capture(CaptureStage::DROPPED, v6));
+    EXPECT_EQ(tap.get_statistics().packets_captured, 3u);
+
+    PcapReader reader;
+    ASSERT_TRUE(reader.open(path));
+    EXPECT_EQ(reader.format(), PcapReader::Format::PCAPNG);
+
+    PcapRecord record;
+    ASSERT_TRUE(reader.next_record(record));
+    EXPECT_EQ(record.interface_id, 0u);
+    EXPECT_EQ(record.captured_length, 100u);
+    EXPECT_EQ(record.original_length, 1500u);
+    PcapPacketInfo info;
+    ASSERT_TRUE(PcapReader::decode(record, info));
+    EXPECT_EQ(info.src_ip, "10.0.0.1");
+    EXPECT_EQ(info.protocol, 6);
+    EXPECT_EQ(info.dst_port, tcp.dst_port);
+    EXPECT_EQ(info.ip_id, 0x2345u);
+    EXPECT_EQ(info.tcp_seq, 0x12345u);
+    EXPECT_EQ(info.dscp, 46);
+    EXPECT_EQ(info.size, 1500u);
+
+    ASSERT_TRUE(reader.next_record(record));
+    EXPECT_EQ(record.interface_id, 1u);
+    EXPECT_EQ(record.captured_length, 60u);
+    ASSERT_TRUE(PcapReader::decode(record, info));
+    EXPECT_EQ(info.protocol, 17);
+    EXPECT_EQ(info.src_port, 1000);
+
+    ASSERT_TRUE(reader.next_record(record));
+    EXPECT_EQ(record.interface_id, 2u);
+    ASSERT_TRUE(PcapReader::decode(record, info));
+    EXPECT_EQ(info.dst_ip, "2001:db8::2");
+    EXPECT_EQ(info.dst_port, 5353);
+
+    EXPECT_FALSE(reader.next_record(record));
+    EXPECT_FALSE(reader.truncated());
+    std::remove(path.c_str());
+}
+
+TEST(PcapTapTest, ConcurrentProducersLoseNothingSilently) {
+    std::string path = temp_path("pcap_tap_threads");
+    PcapTap tap;
+    PcapTapOptions options;
+    options.ring_slots = 1024;
+    options.snaplen = 64;
+    ASSERT_TRUE(tap.start(path, options));
+
+    const int threads = 4;
+    const int per_thread = 50000;
+    std::vector<std::thread> producers;
+    for (int t = 0; t < threads; ++t) {
+        producers.emplace_back([&, t] {
+            PacketDescriptor burst[32];
+            for (int i = 0; i < per_thread; i += 32) {
+                for (int j = 0; j < 32; ++j) {
+                    burst[j] = make_packet(uint64_t(t) << 32 | (i + j), 512, 6);
+                }
+                if (t % 2 == 0) {
+                    tap.capture_burst(CaptureStage::PRE_SHAPING, burst, 32);
+                } else {
+                    for (const auto& packet : burst) {
+                        tap.capture(CaptureStage::POST_SHAPING, packet);
+                    }
+                }
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    ASSERT_TRUE(tap.stop());
+
+    auto stats = tap.get_statistics();
+    uint64_t offered = threads * ((per_thread + 31) / 32 * 32);
+    EXPECT_EQ(stats.packets_captured + stats.packets_dropped, offered);
+    auto counts = count_records(path);
+    EXPECT_EQ(counts[0] + counts[1], stats.packets_captured);
+    std::remove(path.c_str());
+}
+
+TEST(PcapTapTest, CapturesShapingStages) {
+    std::string path = temp_path("pcap_tap_shaper");
+    PcapTap tap;
+    ASSERT_TRUE(tap.start(path));
+
+    TrafficShapingManager manager;
+    ASSERT_TRUE(manager.initialize());
+    ASSERT_TRUE(manager.add_interface("eth0"));
+    // A bucket of at most three 1000-byte packets that hardly refills
+    ASSERT_TRUE(manager.configure_interface("eth0", ShapingAlgorithm::TOKEN_BUCKET,
+                                            {{"capacity", "3000"}, {"rate", "1"}, {"burst_size", "3000"}}));
+    manager.set_capture_tap(&tap);
+
+    std::atomic<int> released{0};
+    manager.set_packet_callback([&](const PacketInfo&) { released++; });
+    ASSERT_TRUE(manager.start());
+
+    PacketDescriptor packets[5];
+    for (int i = 0; i < 5; ++i) {
+        packets[i] = make_packet(i, 1000, 17);
+    }
+    BurstVerdict verdicts;
+    size_t accepted = manager.process_burst("eth0", packets, 5, verdicts);
+    EXPECT_GT(accepted, 0u);
+    EXPECT_LT(accepted, 5u);
+
+    for (int i = 0; i < 2000 && released < int(accepted); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    manager.stop();
+    manager.set_capture_tap(nullptr);
+    ASSERT_TRUE(tap.stop());
+
+    auto counts = count_records(path);
+    EXPECT_EQ(counts[static_cast<uint32_t>(CaptureStage::PRE_SHAPING)], 5u);
+    EXPECT_EQ(counts[static_cast<uint32_t>(CaptureStage::POST_SHAPING)], accepted);
+    EXPECT_EQ(counts[static_cast<uint32_t>(CaptureStage::DROPPED)], 5u - accepted);
+    std::remove(path.c_str());
+}
+
+TEST(PcapTapTest, UnknownInterfaceCapturesDrops) {
+    std::string path = temp_path("pcap_tap_unknown");
+    PcapTap tap;
+    ASSERT_TRUE(tap.start(path));
+
+    TrafficShapingManager manager;
+    ASSERT_TRUE(manager.initialize());
+    manager.set_capture_tap(&tap);
+
+    // Every packet offered to a missing interface is seen entering and dropped
+    PacketDescriptor packets[3];
+    for (int i = 0; i < 3; ++i) {
+        packets[i] = make_packet(i, 500, 17);
+    }
+    BurstVerdict verdicts;
+    EXPECT_EQ(manager.process_burst("eth9", packets, 3, verdicts), 0u);
+    EXPECT_FALSE(manager.process_packet("eth9", packets[0]));
+    manager.set_capture_tap(nullptr);
+    ASSERT_TRUE(tap.stop());
+
+    auto counts = count_records(path);
+    EXPECT_EQ(counts[static_cast<uint32_t>(CaptureStage::PRE_SHAPING)], 4u);
+    EXPECT_EQ(counts[static_cast<uint32_t>(CaptureStage::DROPPED)], 4u);
+    std::remove(path.c_str());
+}
@@ -203,7 +203,7 @@ TEST_F(PcapDiffTest, PacketComparison) {
     PcapData pcap1, pcap2;
     
     // Create identical packets
-    PacketInfo packet1, packet2;
+    PcapPacketInfo packet1, packet2;
     packet1.packet_number = 1;
     packet1.timestamp = std::chrono::system_clock::now();
     packet1.src_ip = "192.168.1.1";
@@ -228,7 +228,7 @@ TEST_F(PcapDiffTest, PacketDifferences) {
     // Create test packet data with differences
     PcapData pcap1, pcap2;
     
-    PacketInfo packet1, packet2;
+    PcapPacketInfo packet1, packet2;
     packet1.packet_number = 1;
     packet1.timestamp = std::chrono::system_clock::now();
     packet1.src_ip = "192.168.1.1";
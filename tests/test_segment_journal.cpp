@@ -0,0 +1,224 @@
+#include <gtest/gtest.h>
+#include "analytics/segment_journal.h"
+#include <cstdio>
+#include <dirent.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace RouterSim;
+
+namespace {
+
+std::vector<uint8_t> make_payload(uint32_t seed, size_t length, bool compressible) {
+    std::vector<uint8_t> data(length);
+    uint32_t state = seed * 2654435761u + 1;
+    for (size_t i = 0; i < length; ++i) {
+        state = state * 1664525u + 1013904223u;
+        data[i] = compressible ? static_cast<uint8_t>("router-metrics"[i % 14] + seed % 3)
+                               : static_cast<uint8_t>(state >> 24);
+    }
+    return data;
+}
+
+class SegmentJournalTest : public ::testing::Test {
+protected:
+    std::string directory;
+
+    void SetUp() override {
+        directory = "/tmp/segment_journal_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()) +
+                    "_" + std::to_string(getpid());
+        remove_directory();
+    }
+    void TearDown() override { remove_directory(); }
+
+    void remove_directory() {
+        if (DIR* dir = opendir(directory.c_str())) {
+            while (dirent* entry = readdir(dir)) {
+                std::remove((directory + "/" + entry->d_name).c_str());
+            }
+            closedir(dir);
+        }
+        rmdir(directory.c_str());
+    }
+
+    SegmentJournalOptions small_segments(JournalCompression compression = JournalCompression::NONE) {
+        SegmentJournalOptions options;
+        options.segment_bytes = 8192;
+        options.max_bytes = 4 * 8192;
+        options.compression = compression;
+        return options;
+    }
+};
+
+} // namespace
+
+TEST_F(SegmentJournalTest, RoundTripsRecordsWithEachCodec) {
+    for (auto codec : {JournalCompression::NONE, JournalCompression::LZ4, JournalCompression::ZSTD}) {
+        remove_directory();
+        SegmentJournalOptions options;
+        options.segment_bytes = 1 << 20;
+        options.compression = codec;
+        SegmentJournal journal;
+        ASSERT_TRUE(journal.open(directory, options));
+
+        for (uint32_t i = 0; i < 20; ++i) {
+            auto data = make_payload(i, 1000 + i * 37, i % 2 == 0);
+            ASSERT_TRUE(journal.append(i % 3, i, data.data(), data.size()));
+        }
+        auto stats = journal.get_statistics();
+        EXPECT_EQ(stats.records_written, 20u);
+        EXPECT_EQ(stats.rows_pending, 190u);
+        if (codec != JournalCompression::NONE && SegmentJournal::supports(codec)) {
+            EXPECT_LT(stats.bytes_stored, stats.bytes_written);
+        }
+
+        SegmentJournal::Record record;
+        for (uint32_t i = 0; i < 20; ++i) {
+            ASSERT_TRUE(journal.read(record));
+            EXPECT_EQ(record.tag, i % 3);
+            EXPECT_EQ(record.rows, i);
+            EXPECT_EQ(record.data, make_payload(i, 1000 + i * 37, i % 2 == 0));
+        }
+        EXPECT_FALSE(journal.read(record));
+        journal.commit();
+        EXPECT_FALSE(journal.has_pending());
+        EXPECT_EQ(journal.get_statistics().rows_pending, 0u);
+        journal.close();
+    }
+}
+
+TEST_F(SegmentJournalTest, RewindRereadsAndCommitDeletesReplayedSegments) {
+    SegmentJournal journal;
+    ASSERT_TRUE(journal.open(directory, small_segments()));
+    auto data = make_payload(1, 1000, false);
+    for (uint32_t i = 0; i < 20; ++i) {
+        ASSERT_TRUE(journal.append(i, 1, data.data(), data.size()));
+    }
+    // 1032 bytes a record, 7 to a segment
+    EXPECT_EQ(journal.get_statistics().segments, 3u);
+
+    SegmentJournal::Record record;
+    for (uint32_t i = 0; i < 10; ++i) {
+        ASSERT_TRUE(journal.read(record));
+        EXPECT_EQ(record.tag, i);
+    }
+    journal.rewind();
+    ASSERT_TRUE(journal.read(record));
+    EXPECT_EQ(record.tag, 0u);
+
+    for (uint32_t i = 1; i < 10; ++i) {
+        ASSERT_TRUE(journal.read(record));
+    }
+    journal.commit();
+    EXPECT_EQ(journal.get_statistics().segments, 2u);
+    EXPECT_EQ(journal.get_statistics().rows_pending, 10u);
+    EXPECT_EQ(journal.get_statistics().records_replayed, 10u);
+    EXPECT_TRUE(journal.has_pending());
+
+    // A failed replay goes back to the commit, not to the start
+    ASSERT_TRUE(journal.read(record));
+    journal.rewind();
+    ASSERT_TRUE(journal.read(record));
+    EXPECT_EQ(record.tag, 10u);
+}
+
+TEST_F(SegmentJournalTest, ReopenResumesAfterLastCommit) {
+    {
+        SegmentJournal journal;
+        ASSERT_TRUE(journal.open(directory, small_segments()));
+        for (uint32_t i = 0; i < 10; ++i) {
+            auto data = make_payload(i, 500, false);
+            ASSERT_TRUE(journal.append(i, 2, data.data(), data.size()));
+        }
+        SegmentJournal::Record record;
+        for (uint32_t i = 0; i < 4; ++i) {
+            ASSERT_TRUE(journal.read(record));
+        }
+        journal.commit();
+        // Read and not committed: replayed again after reopening
+        ASSERT_TRUE(journal.read(record));
+    }
+
+    SegmentJournal journal;
+    ASSERT_TRUE(journal.open(directory, small_segments()));
+    EXPECT_EQ(journal.get_statistics().rows_pending, 12u);
+    auto data = make_payload(10, 500, false);
+    ASSERT_TRUE(journal.append(10, 2, data.data(), data.size()));
+
+    SegmentJournal::Record record;
+    for (uint32_t i = 4; i <= 10; ++i) {
+        ASSERT_TRUE(journal.read(record));
+        EXPECT_EQ(record.tag, i);
+        EXPECT_EQ(record.data, make_payload(i, 500, false));
+    }
+    EXPECT_FALSE(journal.read(record));
+}
+
+TEST_F(SegmentJournalTest, StaysWithinMaxBytes) {
+    SegmentJournal journal;
+    ASSERT_TRUE(journal.open(directory, small_segments()));
+    auto data = make_payload(1, 1000, false);
+    uint32_t accepted = 0;
+    for (uint32_t i = 0; i < 100; ++i) {
+        accepted += journal.append(i, 1, data.data(), data.size());
+    }
+    auto stats = journal.get_statistics();
+    EXPECT_EQ(accepted, 4u * 7u);
+    EXPECT_EQ(stats.records_rejected, 100u - accepted);
+    EXPECT_LE(stats.bytes_on_disk, 4u * 8192u);
+
+    // Too large for any segment
+    auto large = make_payload(2, 10000, false);
+    EXPECT_FALSE(journal.append(0, 1, large.data(), large.size()));
+
+    // Replay makes room again, down to the last segment
+    SegmentJournal::Record record;
+    while (journal.read(record)) {
+    }
+    journal.commit();
+    EXPECT_FALSE(journal.has_pending());
+    for (uint32_t i = 0; i < 4u * 7u; ++i) {
+        ASSERT_TRUE(journal.append(i, 1, data.data(), data.size()));
+    }
+    EXPECT_LE(journal.get_statistics().bytes_on_disk, 4u * 8192u);
+}
+
+TEST_F(SegmentJournalTest, RecoveryStopsAtCorruptRecord) {
+    {
+        SegmentJournal journal;
+        ASSERT_TRUE(journal.open(directory, small_segments()));
+        for (uint32_t i = 0; i < 5; ++i) {
+            auto data = make_payload(i, 100, false);
+            ASSERT_TRUE(journal.append(i, 1, data.data(), data.size()));
+        }
+    }
+
+    // Flip a payload byte of the fourth record: 64 byte segment header, 136 bytes a record
+    std::string path = directory + "/segment-00000000000000000001.journal";
+    FILE* file = std::fopen(path.c_str(), "r+b");
+    ASSERT_NE(file, nullptr);
+    std::fseek(file, 64 + 3 * 136 + 40, SEEK_SET);
+    int byte = std::fgetc(file);
+    std::fseek(file, 64 + 3 * 136 + 40, SEEK_SET);
+    std::fputc(byte ^ 0xff, file);
+    std::fclose(file);
+
+    SegmentJournal journal;
+    ASSERT_TRUE(journal.open(directory, small_segments()));
+    EXPECT_EQ(journal.get_statistics().rows_pending, 3u);
+    auto data = make_payload(9, 100, false);
+    ASSERT_TRUE(journal.append(9, 1, data.data(), data.size()));
+
+    SegmentJournal::Record record;
+    std::vector<uint32_t> tags;
+    while (journal.read(record)) {
+        tags.push_back(record.tag);
+    }
+    EXPECT_EQ(tags, (std::vector<uint32_t>{0, 1, 2, 9}));
+
+    // The records after the corrupt one are gone for good
+    journal.close();
+    ASSERT_TRUE(journal.open(directory, small_segments()));
+    EXPECT_EQ(journal.get_statistics().rows_pending, 4u);
+}
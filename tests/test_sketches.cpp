@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include "analytics/sketches.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace RouterSim;
+
+namespace {
+
+double exact_quantile(std::vector<double> values, double q) {
+    std::sort(values.begin(), values.end());
+    return values[static_cast<size_t>(q * (values.size() - 1))];
+}
+
+uint64_t mix(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdull;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ull;
+    return value ^ (value >> 33);
+}
+
+} // namespace
+
+TEST(DDSketchTest, QuantilesWithinRelativeAccuracy) {
+    DDSketch sketch(0.01);
+    std::mt19937_64 rng(7);
+    // Latencies in microseconds: a lognormal body and a far tail
+    std::lognormal_distribution<double> body(4.0, 0.6);
+    std::vector<double> values;
+    for (int i = 0; i < 100000; ++i) {
+        double value = i % 1000 == 0 ? 50000.0 + i : body(rng);
+        values.push_back(value);
+        sketch.add(value);
+    }
+
+    EXPECT_EQ(sketch.count(), values.size());
+    for (double q : {0.0, 0.1, 0.5, 0.9, 0.99, 0.999, 1.0}) {
+        double exact = exact_quantile(values, q);
+        EXPECT_NEAR(sketch.quantile(q), exact, exact * 0.01) << "q=" << q;
+    }
+    // Six decades of range in a few hundred buckets
+    EXPECT_LT(sketch.bucket_count(), 1000u);
+}
+
+TEST(DDSketchTest, HandlesZeroAndNegativeValues) {
+    DDSketch sketch(0.02);
+    for (int i = -100; i <= 100; ++i) {
+        sketch.add(double(i));
+    }
+    EXPECT_NEAR(sketch.quantile(0.0), -100.0, 2.0);
+    EXPECT_DOUBLE_EQ(sketch.quantile(0.5), 0.0);
+    EXPECT_NEAR(sketch.quantile(0.25), -50.0, 1.0);
+    EXPECT_NEAR(sketch.quantile(1.0), 100.0, 2.0);
+    EXPECT_EQ(sketch.count(), 201u);
+
+    DDSketch empty;
+    EXPECT_DOUBLE_EQ(empty.quantile(0.5), 0.0);
+}
+
+TEST(DDSketchTest, MergeEqualsSketchOfUnion) {
+    DDSketch left(0.01), right(0.01), all(0.01);
+    for (int i = 1; i <= 5000; ++i) {
+        left.add(i * 0.5);
+        right.add(i * 3.0);
+        all.add(i * 0.5);
+        all.add(i * 3.0);
+    }
+    ASSERT_TRUE(left.merge(right));
+    for (double q : {0.01, 0.5, 0.95, 0.999}) {
+        EXPECT_DOUBLE_EQ(left.quantile(q), all.quantile(q));
+    }
+    DDSketch coarse(0.05);
+    EXPECT_FALSE(left.merge(coarse));
+}
+
+TEST(DDSketchTest, SerializeRoundTrips) {
+    DDSketch sketch(0.01);
+    for (int i = 0; i < 1000; ++i) {
+        sketch.add(std::pow(1.01, i % 400) * (i % 7 == 0 ? -1 : 1));
+    }
+    sketch.add(0.0, 5);
+    std::string bytes;
+    sketch.serialize(bytes);
+
+    DDSketch copy;
+    ASSERT_TRUE(copy.deserialize(bytes.data(), bytes.size()));
+    EXPECT_EQ(copy.count(), sketch.count());
+    EXPECT_DOUBLE_EQ(copy.relative_accuracy(), 0.01);
+    for (double q : {0.0, 0.2, 0.5, 0.9, 1.0}) {
+        EXPECT_DOUBLE_EQ(copy.quantile(q), sketch.quantile(q));
+    }
+    EXPECT_FALSE(copy.deserialize(bytes.data(), bytes.size() - 1));
+    EXPECT_EQ(copy.count(), sketch.count());
+}
+
+TEST(DDSketchTest, BoundedBucketsKeepUpperQuantiles) {
+    DDSketch sketch(0.01, 64);
+    std::vector<double> values;
+    for (int i = 0; i < 10000; ++i) {
+        double value = std::pow(10.0, (i % 1000) / 100.0);
+        values.push_back(value);
+        sketch.add(value);
+    }
+    EXPECT_LE(sketch.bucket_count(), 64u);
+    double exact = exact_quantile(values, 0.99);
+    EXPECT_NEAR(sketch.quantile(0.99), exact, exact * 0.01);
+}
+
+TEST(HyperLogLogTest, EstimatesDistinctCounts) {
+    for (uint64_t distinct : {10ull, 1000ull, 100000ull, 1000000ull}) {
+        HyperLogLog sketch(12);
+        for (uint64_t i = 0; i < distinct; ++i) {
+            sketch.add(mix(i));
+            // Repeats do not count
+            sketch.add(mix(i / 2));
+        }
+        // Three standard errors at 2^12 registers
+        EXPECT_NEAR(sketch.estimate(), double(distinct), distinct * 3 * 1.04 / 64.0 + 1) << distinct;
+    }
+}
+
+TEST(HyperLogLogTest, MergeEqualsSketchOfUnion) {
+    HyperLogLog left(10), right(10), all(10);
+    for (uint64_t i = 0; i < 20000; ++i) {
+        left.add(mix(i));
+        right.add(mix(i + 10000));
+        all.add(mix(i));
+        all.add(mix(i + 10000));
+    }
+    ASSERT_TRUE(left.merge(right));
+    EXPECT_DOUBLE_EQ(left.estimate(), all.estimate());
+    HyperLogLog other(12);
+    EXPECT_FALSE(left.merge(other));
+
+    left.clear();
+    EXPECT_DOUBLE_EQ(left.estimate(), 0.0);
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include "timer_wheel.h"
+#include <map>
+#include <random>
+
+using namespace RouterSim;
+
+TEST(TimerWheelTest, FiresInExpiryOrderAndNeverEarly) {
+    TimerWheel wheel(1000);
+    wheel.schedule(5500, 1);       // rounds up to 6000
+    wheel.schedule(300000, 2);     // level 1
+    wheel.schedule(70000000, 3);   // level 2
+    wheel.schedule(2000, 4);
+
+    EXPECT_EQ(wheel.next_expiry_ns(), 2000u);
+
+    std::vector<uint64_t> fired;
+    auto record = [&](TimerWheel::TimerId, uint64_t cookie) { fired.push_back(cookie); };
+
+    EXPECT_EQ(wheel.advance(5999, record), 1u);
+    EXPECT_EQ(fired, std::vector<uint64_t>({4}));
+    EXPECT_EQ(wheel.next_expiry_ns(), 6000u);
+
+    wheel.advance(299999, record);
+    EXPECT_EQ(fired, std::vector<uint64_t>({4, 1}));
+    EXPECT_EQ(wheel.next_expiry_ns(), 300000u);
+
+    wheel.advance(100000000, record);
+    EXPECT_EQ(fired, std::vector<uint64_t>({4, 1, 2, 3}));
+    EXPECT_TRUE(wheel.empty());
+    EXPECT_EQ(wheel.next_expiry_ns(), TimerWheel::NO_EXPIRY);
+}
+
+TEST(TimerWheelTest, CancelAndStaleIds) {
+    TimerWheel wheel(1);
+    auto first = wheel.schedule(100, 1);
+    auto second = wheel.schedule(100, 2);
+    EXPECT_TRUE(wheel.cancel(first));
+    EXPECT_FALSE(wheel.cancel(first));
+    EXPECT_FALSE(wheel.cancel(TimerWheel::INVALID_TIMER));
+
+    std::vector<uint64_t> fired;
+    wheel.advance(100, [&](TimerWheel::TimerId id, uint64_t cookie) {
+        EXPECT_EQ(id, second);
+        fired.push_back(cookie);
+    });
+    EXPECT_EQ(fired, std::vector<uint64_t>({2}));
+    EXPECT_FALSE(wheel.is_pending(second));
+
+    // A recycled node gets a new id; the old one stays dead
+    auto third = wheel.schedule(200, 3);
+    EXPECT_NE(third, second);
+    EXPECT_FALSE(wheel.cancel(second));
+    EXPECT_TRUE(wheel.is_pending(third));
+}
+
+TEST(TimerWheelTest, CallbackMayRearm) {
+    TimerWheel wheel(10);
+    int fired = 0;
+    TimerWheel::ExpiryCallback rearm = [&](TimerWheel::TimerId, uint64_t cookie) {
+        fired++;
+        if (fired < 5) {
+            wheel.schedule(wheel.now_ns() + 100, cookie);
+        }
+    };
+
+    wheel.schedule(100, 7);
+    wheel.advance(10000, rearm);
+    EXPECT_EQ(fired, 5);
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimerWheelTest, BeyondWheelSpan) {
+    TimerWheel wheel(1);
+    uint64_t span = 1ULL << (TimerWheel::SLOT_BITS * TimerWheel::LEVELS);
+    wheel.schedule(3 * span + 17, 1);
+    wheel.schedule(span / 2, 2);
+    EXPECT_EQ(wheel.next_expiry_ns(), span / 2);
+
+    std::vector<uint64_t> fired;
+    auto record = [&](TimerWheel::TimerId, uint64_t cookie) { fired.push_back(cookie); };
+    wheel.advance(span / 2, record);
+    EXPECT_EQ(fired, std::vector<uint64_t>({2}));
+
+    // The far timer may report an early wake while parked, never a late one
+    EXPECT_LE(wheel.next_expiry_ns(), 3 * span + 17);
+    wheel.advance(3 * span + 16, record);
+    EXPECT_EQ(fired.size(), 1u);
+    wheel.advance(3 * span + 17, record);
+    EXPECT_EQ(fired, std::vector<uint64_t>({2, 1}));
+}
+
+TEST(TimerWheelTest, MatchesReferenceUnderRandomLoad) {
+    TimerWheel wheel(1);
+    std::multimap<uint64_t, TimerWheel::TimerId> reference;
+    std::map<TimerWheel::TimerId, uint64_t> expiry_of;
+    std::mt19937_64 rng(42);
+    uint64_t now = 0;
+
+    for (int step = 0; step < 20000; ++step) {
+        int action = rng() % 10;
+        if (action < 5) {
+            // Mix of short, medium and long delays across all levels
+            uint64_t delay = 1 + rng() % (1ULL << (8 * (1 + rng() % 4)));
+            auto id = wheel.schedule(now + delay, now + delay);
+            reference.emplace(now + delay, id);
+            expiry_of[id] = now + delay;
+        } else if (action < 6 && !expiry_of.empty()) {
+            auto it = expiry_of.begin();
+            std::advance(it, rng() % expiry_of.size());
+            ASSERT_TRUE(wheel.cancel(it->first));
+            auto range = reference.equal_range(it->second);
+            for (auto ref = range.first; ref != range.second; ++ref) {
+                if (ref->second == it->first) {
+                    reference.erase(ref);
+                    break;
+                }
+            }
+            expiry_of.erase(it);
+        } else {
+            uint64_t expected_next = reference.empty() ? TimerWheel::NO_EXPIRY : reference.begin()->first;
+            ASSERT_LE(wheel.next_expiry_ns(), expected_next);
+
+            now += rng() % (1ULL << (4 * (1 + rng() % 6)));
+            uint64_t last = 0;
+            wheel.advance(now, [&](TimerWheel::TimerId id, uint64_t cookie) {
+                ASSERT_LE(cookie, now);
+                ASSERT_GE(cookie, last);
+                last = cookie;
+                ASSERT_EQ(expiry_of.erase(id), 1u);
+            });
+            while (!reference.empty() && reference.begin()->first <= now) {
+                ASSERT_EQ(expiry_of.count(reference.begin()->second), 0u);
+                reference.erase(reference.begin());
+            }
+            ASSERT_EQ(wheel.size(), reference.size());
+        }
+    }
+}
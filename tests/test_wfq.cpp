@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include "traffic_shaping/wfq.h"
+#include <map>
+
+using namespace RouterSim;
+
+namespace {
+
+std::vector<WFQClass> make_classes(std::initializer_list<std::pair<uint8_t, uint32_t>> weights) {
+    std::vector<WFQClass> classes;
+    for (const auto& [class_id, weight] : weights) {
+        WFQClass wfq_class;
+        wfq_class.class_id = class_id;
+        wfq_class.weight = weight;
+        classes.push_back(wfq_class);
+    }
+    return classes;
+}
+
+PacketDescriptor make_packet(uint64_t id, uint32_t size) {
+    PacketDescriptor packet{};
+    packet.set_ipv4(0x0A000001, 0x0A000002);
+    packet.id = id;
+    packet.size = size;
+    return packet;
+}
+
+} // namespace
+
+TEST(WeightedFairQueueTest, ServesInFinishTimeOrder) {
+    WeightedFairQueue wfq;
+    ASSERT_TRUE(wfq.initialize(make_classes({{1, 1}, {2, 4}})));
+
+    // Class 2 has four times the weight, so its packets finish earlier
+    ASSERT_TRUE(wfq.enqueue_packet(make_packet(10, 1000), 1));
+    ASSERT_TRUE(wfq.enqueue_packet(make_packet(20, 1000), 2));
+    ASSERT_TRUE(wfq.enqueue_packet(make_packet(21, 1000), 2));
+
+    PacketDescriptor out{};
+    ASSERT_TRUE(wfq.dequeue_packet(out));
+    EXPECT_EQ(out.id, 20u);
+    ASSERT_TRUE(wfq.dequeue_packet(out));
+    EXPECT_EQ(out.id, 21u);
+    ASSERT_TRUE(wfq.dequeue_packet(out));
+    EXPECT_EQ(out.id, 10u);
+    EXPECT_FALSE(wfq.dequeue_packet(out));
+}
+
+TEST(WeightedFairQueueTest, SharesBandwidthByWeight) {
+    WeightedFairQueue wfq;
+    ASSERT_TRUE(wfq.initialize(make_classes({{1, 1}, {2, 2}, {3, 4}})));
+
+    for (uint64_t i = 0; i < 700; ++i) {
+        for (uint8_t class_id = 1; class_id <= 3; ++class_id) {
+            ASSERT_TRUE(wfq.enqueue_packet(make_packet(class_id, 500), class_id));
+        }
+    }
+
+    // While all classes stay backlogged service follows the 1:2:4 weights
+    std::map<uint64_t, int> served;
+    PacketDescriptor out{};
+    for (int i = 0; i < 700; ++i) {
+        ASSERT_TRUE(wfq.dequeue_packet(out));
+        served[out.id]++;
+    }
+    EXPECT_NEAR(served[1], 100, 2);
+    EXPECT_NEAR(served[2], 200, 2);
+    EXPECT_NEAR(served[3], 400, 2);
+}
+
+TEST(WeightedFairQueueTest, LargeWeightsKeepTheirRatio) {
+    WeightedFairQueue wfq;
+    ASSERT_TRUE(wfq.initialize(make_classes({{1, 1000}, {2, 2000}})));
+
+    for (uint64_t i = 0; i < 300; ++i) {
+        ASSERT_TRUE(wfq.enqueue_packet(make_packet(1, 64), 1));
+        ASSERT_TRUE(wfq.enqueue_packet(make_packet(2, 64), 2));
+    }
+
+    // 512 bits over either weight truncates to zero in whole virtual time
+    // units, which would leave every finish tag tied
+    std::map<uint64_t, int> served;
+    PacketDescriptor out{};
+    for (int i = 0; i < 300; ++i) {
+        ASSERT_TRUE(wfq.dequeue_packet(out));
+        served[out.id]++;
+    }
+    EXPECT_NEAR(served[1], 100, 2);
+    EXPECT_NEAR(served[2], 200, 2);
+}
+
+TEST(WeightedFairQueueTest, ClassManagement) {
+    WeightedFairQueue wfq;
+    ASSERT_TRUE(wfq.initialize(make_classes({{1, 1}, {2, 1}, {3, 1}})));
+    EXPECT_FALSE(wfq.add_class(make_classes({{2, 5}})[0]));
+    EXPECT_FALSE(wfq.enqueue_packet(make_packet(0, 100), 9));
+
+    ASSERT_TRUE(wfq.enqueue_packet(make_packet(1, 100), 1));
+    ASSERT_TRUE(wfq.enqueue_packet(make_packet(2, 100), 2));
+    ASSERT_TRUE(wfq.enqueue_packet(make_packet(3, 100), 3));
+    EXPECT_EQ(wfq.queue_size(), 3u);
+
+    // Removing a class drops its backlog and keeps the others schedulable
+    ASSERT_TRUE(wfq.remove_class(1));
+    EXPECT_EQ(wfq.queue_size(), 2u);
+    EXPECT_EQ(wfq.get_classes().size(), 2u);
+
+    PacketDescriptor out{};
+    ASSERT_TRUE(wfq.dequeue_packet(out));
+    EXPECT_EQ(out.id, 2u);
+    ASSERT_TRUE(wfq.dequeue_packet(out));
+    EXPECT_EQ(out.id, 3u);
+    EXPECT_TRUE(wfq.is_empty());
+
+    auto stats = wfq.get_statistics();
+    EXPECT_EQ(stats.total_packets_dequeued, 2u);
+    EXPECT_EQ(stats.class_statistics.at(3).bytes_dequeued, 100u);
+}
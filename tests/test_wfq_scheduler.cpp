@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include "traffic_shaping.h"
+#include <vector>
+#include <algorithm>
+
+using namespace RouterSim;
+
+namespace {
+
+PacketDescriptor make_packet(uint64_t id, uint32_t size, uint32_t queue_id, uint64_t arrival_ns = 0) {
+    PacketDescriptor packet{};
+    packet.set_ipv4(0x0A000001, 0x0A000002);
+    packet.id = id;
+    packet.size = size;
+    packet.priority = queue_id;
+    packet.timestamp_ns = arrival_ns;
+    return packet;
+}
+
+// Saturated mix for the latency harness: every queue except the tagged
+// one is greedy (always backlogged); the tagged queue is (sigma, rho)
+// leaky-bucket constrained with rho below its guaranteed rate
+struct LatencyMix {
+    uint64_t link_rate_bps;
+    std::vector<uint32_t> weights;
+    std::vector<uint32_t> packet_sizes;
+    uint32_t tagged_queue;
+    uint32_t tagged_burst_packets;
+    uint64_t tagged_rate_bps;
+};
+
+struct LatencyResult {
+    double max_delay_ns;
+    double delay_bound_ns;
+    uint64_t tagged_packets;
+    std::vector<uint64_t> bytes_served;
+};
+
+// Discrete-event simulation of one link draining the WFQ at link rate
+LatencyResult run_mix(const LatencyMix& mix, double duration_ns) {
+    uint32_t queues = static_cast<uint32_t>(mix.weights.size());
+    WFQ wfq(queues, mix.link_rate_bps);
+    uint32_t total_weight = 0;
+    for (uint32_t i = 0; i < queues; ++i) {
+        wfq.setQueueWeight(i, mix.weights[i]);
+        total_weight += mix.weights[i];
+    }
+
+    uint32_t tagged_size = mix.packet_sizes[mix.tagged_queue];
+    double tagged_interval_ns = tagged_size * 8.0 * 1e9 / mix.tagged_rate_bps;
+    uint64_t next_tagged = 0;
+    uint64_t next_id = 0;
+
+    LatencyResult result{};
+    result.bytes_served.assign(queues, 0);
+
+    double now = 0;
+    while (now < duration_ns) {
+        // Tagged arrivals: a burst at t=0, then one packet per interval
+        while (true) {
+            double arrival = next_tagged < mix.tagged_burst_packets
+                ? 0.0 : (next_tagged - mix.tagged_burst_packets + 1) * tagged_interval_ns;
+            if (arrival > now) {
+                break;
+            }
+            wfq.enqueue(mix.tagged_queue, make_packet(next_id++, tagged_size, mix.tagged_queue,
+                                                      static_cast<uint64_t>(arrival)));
+            next_tagged++;
+        }
+
+        // Greedy queues are topped up so they never go idle
+        for (uint32_t i = 0; i < queues; ++i) {
+            while (i != mix.tagged_queue && wfq.getQueueSize(i) < 16) {
+                wfq.enqueue(i, make_packet(next_id++, mix.packet_sizes[i], i));
+            }
+        }
+
+        PacketDescriptor packet;
+        if (!wfq.dequeue(packet)) {
+            now += tagged_interval_ns;
+            continue;
+        }
+
+        // Departure is the end of transmission at link rate
+        now += packet.size * 8.0 * 1e9 / mix.link_rate_bps;
+        result.bytes_served[packet.priority] += packet.size;
+        if (packet.priority == mix.tagged_queue) {
+            result.max_delay_ns = std::max(result.max_delay_ns, now - packet.timestamp_ns);
+            result.tagged_packets++;
+        }
+    }
+
+    // WF2Q+ bound for a (sigma, rho) flow with guaranteed rate g:
+    //   sigma / g + L_i / g + L_max / R
+    double guaranteed_rate = (double)mix.link_rate_bps * mix.weights[mix.tagged_queue] / total_weight;
+    double sigma_bits = mix.tagged_burst_packets * tagged_size * 8.0;
+    uint32_t max_size = *std::max_element(mix.packet_sizes.begin(), mix.packet_sizes.end());
+    result.delay_bound_ns = (sigma_bits + tagged_size * 8.0) / guaranteed_rate * 1e9 +
+                            max_size * 8.0 / mix.link_rate_bps * 1e9;
+    return result;
+}
+
+} // namespace
+
+TEST(WFQTest, StoresAndReturnsPackets) {
+    WFQ wfq(4);
+    ASSERT_TRUE(wfq.enqueue(2, make_packet(1, 100, 2)));
+    ASSERT_TRUE(wfq.enqueue(2, make_packet(2, 200, 2)));
+    EXPECT_EQ(wfq.getQueueSize(2), 2u);
+    EXPECT_EQ(wfq.getQueueBytes(2), 300u);
+    EXPECT_FALSE(wfq.enqueue(7, make_packet(3, 100, 7)));
+
+    PacketDescriptor packet;
+    ASSERT_TRUE(wfq.dequeue(packet));
+    EXPECT_EQ(packet.id, 1u);
+    ASSERT_TRUE(wfq.dequeue(packet));
+    EXPECT_EQ(packet.id, 2u);
+    EXPECT_EQ(wfq.getQueueBytes(2), 0u);
+    EXPECT_FALSE(wfq.dequeue(packet));
+}
+
+TEST(WFQTest, VirtualTimeFollowsLinkRate) {
+    WFQ wfq(2, 8000000);   // 1 byte per microsecond
+    wfq.enqueue(0, make_packet(1, 1000, 0));
+
+    PacketDescriptor packet;
+    ASSERT_TRUE(wfq.dequeue(packet));
+    EXPECT_DOUBLE_EQ(wfq.getStatistics().virtual_time, 1000000.0);
+}
+
+TEST(WFQTest, IdleQueueRefillIsServed) {
+    WFQ wfq(2, 8000000);
+    wfq.setQueueWeight(0, 1);
+    wfq.setQueueWeight(1, 9);
+
+    // Queue 0's second packet starts after its first finished, ahead of
+    // virtual time; it must still be served once the link is idle
+    PacketDescriptor packet;
+    wfq.enqueue(0, make_packet(1, 1000, 0));
+    ASSERT_TRUE(wfq.dequeue(packet));
+    wfq.enqueue(0, make_packet(2, 1000, 0));
+    ASSERT_TRUE(wfq.dequeue(packet));
+    EXPECT_EQ(packet.id, 2u);
+}
+
+TEST(WFQTest, LatencyBoundEqualSizes) {
+    LatencyMix mix{100000000, {1, 2, 3, 4}, {1000, 1000, 1000, 1000}, 3, 10, 30000000};
+    auto result = run_mix(mix, 2e9);
+
+    ASSERT_GT(result.tagged_packets, 7000u);
+    EXPECT_LE(result.max_delay_ns, result.delay_bound_ns);
+
+    // Greedy queues split the remaining capacity 1:2:3
+    double unit = result.bytes_served[0];
+    EXPECT_NEAR(result.bytes_served[1] / unit, 2.0, 0.05);
+    EXPECT_NEAR(result.bytes_served[2] / unit, 3.0, 0.05);
+}
+
+TEST(WFQTest, LatencyBoundMixedSizes) {
+    // Small-packet tagged flow competing with large-packet bulk queues
+    LatencyMix mix{1000000000, {1, 1, 4, 2, 8}, {1500, 9000, 1500, 64, 200}, 4, 50, 400000000};
+    auto result = run_mix(mix, 5e8);
+
+    ASSERT_GT(result.tagged_packets, 100000u);
+    EXPECT_LE(result.max_delay_ns, result.delay_bound_ns);
+}
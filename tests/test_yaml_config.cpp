@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include "config/yaml_config.h"
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+
+using namespace RouterSim;
+
+namespace {
+
+std::string temp_path(const char* name) {
+    return "/tmp/" + std::string(name) + "_" + std::to_string(getpid()) + ".yaml";
+}
+
+} // namespace
+
+TEST(YAMLConfigTest, DRRRoundTrips) {
+    std::string in_path = temp_path("yaml_config_drr_in");
+    std::string out_path = temp_path("yaml_config_drr_out");
+    {
+        std::ofstream file(in_path);
+        file << "traffic_shaping:\n"
+                "  algorithm: drr\n"
+                "  drr:\n"
+                "    quantum: 9000\n"
+                "    sparse_flow_priority: true\n";
+    }
+
+    YAMLConfig config;
+    ASSERT_TRUE(config.load_config(in_path));
+    TrafficShapingConfig loaded = config.get_traffic_shaping_config();
+    EXPECT_EQ(loaded.algorithm, ShapingAlgorithm::DEFICIT_ROUND_ROBIN);
+    EXPECT_EQ(loaded.drr_config.quantum, 9000u);
+    EXPECT_TRUE(loaded.drr_config.sparse_flow_priority);
+
+    ASSERT_TRUE(config.save_config(out_path));
+    YAMLConfig reloaded;
+    ASSERT_TRUE(reloaded.load_config(out_path));
+    TrafficShapingConfig saved = reloaded.get_traffic_shaping_config();
+    EXPECT_EQ(saved.algorithm, ShapingAlgorithm::DEFICIT_ROUND_ROBIN);
+    EXPECT_EQ(saved.drr_config.quantum, 9000u);
+    EXPECT_TRUE(saved.drr_config.sparse_flow_priority);
+
+    std::remove(in_path.c_str());
+    std::remove(out_path.c_str());
+}
+
+TEST(YAMLConfigTest, HTBClassesRoundTripAndReachTheShaper) {
+    std::string in_path = temp_path("yaml_config_htb_in");
+    std::string out_path = temp_path("yaml_config_htb_out");
+    {
+        std::ofstream file(in_path);
+        file << "traffic_shaping:\n"
+                "  algorithm: htb\n"
+                "  htb:\n"
+                "    charge_batch_bytes: 0\n"
+                "    classes:\n"
+                "      - name: interface\n"
+                "        rate: 100000000\n"
+                "        children:\n"
+                "          - name: tenant\n"
+                "            rate: 50000000\n"
+                "            ceil: 100000000\n"
+                "            children:\n"
+                "              - class_id: 7\n"
+                "                name: video\n"
+                "                rate: 10000000\n";
+    }
+
+    YAMLConfig config;
+    ASSERT_TRUE(config.load_config(in_path));
+    ASSERT_TRUE(config.save_config(out_path));
+    YAMLConfig reloaded;
+    ASSERT_TRUE(reloaded.load_config(out_path));
+    TrafficShapingConfig saved = reloaded.get_traffic_shaping_config();
+    EXPECT_EQ(saved.algorithm, ShapingAlgorithm::HIERARCHICAL_TOKEN_BUCKET);
+    EXPECT_EQ(saved.htb_charge_batch_bytes, 0u);
+    ASSERT_EQ(saved.htb_classes.size(), 3u);
+
+    TrafficShapingManager manager;
+    ASSERT_TRUE(manager.add_interface("eth0"));
+    EXPECT_FALSE(reloaded.apply_traffic_shaping(manager, "eth1"));
+    ASSERT_TRUE(reloaded.apply_traffic_shaping(manager, "eth0"));
+
+    std::vector<HTBClassConfig> classes = manager.get_htb_classes("eth0");
+    ASSERT_EQ(classes.size(), 3u);
+    EXPECT_EQ(classes[0].class_id, 1u);
+    EXPECT_EQ(classes[0].parent_id, 0u);
+    EXPECT_EQ(classes[0].rate, 100000000u);
+    EXPECT_EQ(classes[1].name, "tenant");
+    EXPECT_EQ(classes[1].parent_id, 1u);
+    EXPECT_EQ(classes[1].ceil, 100000000u);
+    EXPECT_EQ(classes[2].class_id, 7u);
+    EXPECT_EQ(classes[2].parent_id, classes[1].class_id);
+    EXPECT_EQ(classes[2].rate, 10000000u);
+
+    // The leaf takes packets classified to it
+    PacketDescriptor packet{};
+    packet.size = 500;
+    packet.priority = 7;
+    EXPECT_TRUE(manager.process_packet("eth0", packet));
+
+    std::remove(in_path.c_str());
+    std::remove(out_path.c_str());
+}